@@ -48,7 +48,7 @@ public:
   {
 
     AggregateHashTableBenchmark::SetUp(state);
-    AggregateExpr        aggregate_expr(AggregateExpr::Type::SUM, nullptr);
+    AggregateExpr        aggregate_expr(AggregateExpr::Type::SUM, make_unique<ValueExpr>(Value(0)));
     vector<Expression *> aggregate_exprs;
     aggregate_exprs.push_back(&aggregate_expr);
     standard_hash_table_ = make_unique<StandardAggregateHashTable>(aggregate_exprs);
@@ -67,7 +67,6 @@ BENCHMARK_DEFINE_F(DISABLED_StandardAggregateHashTableBenchmark, Aggregate)(benc
 
 BENCHMARK_REGISTER_F(DISABLED_StandardAggregateHashTableBenchmark, Aggregate)->Arg(16)->Arg(1024)->Arg(8192);
 
-#ifdef USE_SIMD
 class DISABLED_LinearProbingAggregateHashTableBenchmark : public AggregateHashTableBenchmark
 {
 public:
@@ -75,10 +74,14 @@ public:
   {
 
     AggregateHashTableBenchmark::SetUp(state);
-    linear_probing_hash_table_ = make_unique<LinearProbingAggregateHashTable<int>>(AggregateExpr::Type::SUM);
+    aggregate_expr_ = make_unique<AggregateExpr>(AggregateExpr::Type::SUM, make_unique<ValueExpr>(Value(0)));
+    vector<Expression *> aggregate_exprs;
+    aggregate_exprs.push_back(aggregate_expr_.get());
+    linear_probing_hash_table_ = make_unique<LinearProbingAggregateHashTable>(aggregate_exprs);
   }
 
 protected:
+  unique_ptr<AggregateExpr>      aggregate_expr_;
   unique_ptr<AggregateHashTable> linear_probing_hash_table_;
 };
 
@@ -90,6 +93,110 @@ BENCHMARK_DEFINE_F(DISABLED_LinearProbingAggregateHashTableBenchmark, Aggregate)
 }
 
 BENCHMARK_REGISTER_F(DISABLED_LinearProbingAggregateHashTableBenchmark, Aggregate)->Arg(16)->Arg(1024)->Arg(8192);
-#endif
+
+/**
+ * @brief 两个分组列（char(4) 和 int）组成8字节的分组键，聚合包括 int 和 float 上的 COUNT/MIN/MAX/AVG
+ */
+class DISABLED_LinearProbingCompositeKeyBenchmark : public benchmark::Fixture
+{
+public:
+  void SetUp(const ::benchmark::State &state) override
+  {
+    unique_ptr<Column> group1 = make_unique<Column>(AttrType::CHARS, 4);
+    unique_ptr<Column> group2 = make_unique<Column>(AttrType::INTS, 4);
+    unique_ptr<Column> ints   = make_unique<Column>(AttrType::INTS, 4);
+    unique_ptr<Column> floats = make_unique<Column>(AttrType::FLOATS, 4);
+    for (int i = 0; i < state.range(0); i++) {
+      char  str[4] = {static_cast<char>('a' + i % 4), 0, 0, 0};
+      int   key    = i % 64;
+      float value  = i * 0.5f;
+      group1->append_one(str);
+      group2->append_one((char *)&key);
+      ints->append_one((char *)&i);
+      floats->append_one((char *)&value);
+    }
+    group_chunk_.add_column(std::move(group1), 0);
+    group_chunk_.add_column(std::move(group2), 1);
+
+    const AggregateExpr::Type types[] = {
+        AggregateExpr::Type::COUNT, AggregateExpr::Type::MIN, AggregateExpr::Type::MAX, AggregateExpr::Type::AVG};
+    vector<Expression *> aggregate_exprs;
+    for (AggregateExpr::Type type : types) {
+      aggregate_exprs_.push_back(make_unique<AggregateExpr>(type, make_unique<ValueExpr>(Value(0))));
+      aggregate_exprs.push_back(aggregate_exprs_.back().get());
+      aggr_chunk_.add_column(make_unique<Column>(*ints), aggr_chunk_.column_num());
+    }
+    for (AggregateExpr::Type type : types) {
+      aggregate_exprs_.push_back(make_unique<AggregateExpr>(type, make_unique<ValueExpr>(Value(0.0f))));
+      aggregate_exprs.push_back(aggregate_exprs_.back().get());
+      aggr_chunk_.add_column(make_unique<Column>(*floats), aggr_chunk_.column_num());
+    }
+    linear_probing_hash_table_ = make_unique<LinearProbingAggregateHashTable>(aggregate_exprs);
+  }
+
+  void TearDown(const ::benchmark::State &state) override
+  {
+    group_chunk_.reset();
+    aggr_chunk_.reset();
+  }
+
+protected:
+  Chunk                             group_chunk_;
+  Chunk                             aggr_chunk_;
+  vector<unique_ptr<AggregateExpr>> aggregate_exprs_;
+  unique_ptr<AggregateHashTable>    linear_probing_hash_table_;
+};
+
+BENCHMARK_DEFINE_F(DISABLED_LinearProbingCompositeKeyBenchmark, Aggregate)(benchmark::State &state)
+{
+  for (auto _ : state) {
+    linear_probing_hash_table_->add_chunk(group_chunk_, aggr_chunk_);
+  }
+}
+
+BENCHMARK_REGISTER_F(DISABLED_LinearProbingCompositeKeyBenchmark, Aggregate)->Arg(16)->Arg(1024)->Arg(8192);
+
+/**
+ * @brief 每一行都是一个新的分组，从很小的容量开始，不断扩容
+ */
+class DISABLED_LinearProbingResizeBenchmark : public benchmark::Fixture
+{
+public:
+  void SetUp(const ::benchmark::State &state) override
+  {
+    unique_ptr<Column> column1 = make_unique<Column>(AttrType::INTS, 4);
+    unique_ptr<Column> column2 = make_unique<Column>(AttrType::INTS, 4);
+    for (int i = 0; i < state.range(0); i++) {
+      column1->append_one((char *)&i);
+      column2->append_one((char *)&i);
+    }
+    group_chunk_.add_column(std::move(column1), 0);
+    aggr_chunk_.add_column(std::move(column2), 0);
+    aggregate_expr_ = make_unique<AggregateExpr>(AggregateExpr::Type::SUM, make_unique<ValueExpr>(Value(0)));
+  }
+
+  void TearDown(const ::benchmark::State &state) override
+  {
+    group_chunk_.reset();
+    aggr_chunk_.reset();
+  }
+
+protected:
+  Chunk                     group_chunk_;
+  Chunk                     aggr_chunk_;
+  unique_ptr<AggregateExpr> aggregate_expr_;
+};
+
+BENCHMARK_DEFINE_F(DISABLED_LinearProbingResizeBenchmark, Aggregate)(benchmark::State &state)
+{
+  vector<Expression *> aggregate_exprs;
+  aggregate_exprs.push_back(aggregate_expr_.get());
+  for (auto _ : state) {
+    LinearProbingAggregateHashTable hash_table(aggregate_exprs, 16);
+    hash_table.add_chunk(group_chunk_, aggr_chunk_);
+  }
+}
+
+BENCHMARK_REGISTER_F(DISABLED_LinearProbingResizeBenchmark, Aggregate)->Arg(1024)->Arg(8192)->Arg(65536);
 
 BENCHMARK_MAIN();
\ No newline at end of file
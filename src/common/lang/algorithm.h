@@ -12,7 +12,13 @@ See the Mulan PSL v2 for more details. */
 
 #include <algorithm>
 
+using std::any_of;
+using std::find;
 using std::max;
 using std::min;
+using std::partial_sort;
+using std::pop_heap;
+using std::push_heap;
+using std::sort_heap;
 using std::swap;
 using std::transform;
@@ -271,16 +271,25 @@ char *substr(const char *s, int n1, int n2)
 string double_to_str(double v)
 {
   char buf[256];
+  int  len = double_to_str(v, buf, sizeof(buf));
+  return string(buf, len);
+}
+
+int double_to_str(double v, char *buf, int size)
+{
+  char   tmp[256];
   double rounded_v = round(v * 100.0) / 100.0;
-  snprintf(buf, sizeof(buf), "%.2f", rounded_v);
-  size_t len = strlen(buf);
-  while (buf[len - 1] == '0') {
+  int    len       = snprintf(tmp, sizeof(tmp), "%.2f", rounded_v);
+  len              = min(len, static_cast<int>(sizeof(tmp)) - 1);
+  while (tmp[len - 1] == '0') {
     len--;
   }
-  if (buf[len - 1] == '.') {
+  if (tmp[len - 1] == '.') {
     len--;
   }
 
-  return string(buf, len);
+  len = min(len, size);
+  memcpy(buf, tmp, len);
+  return len;
 }
 }  // namespace common
@@ -125,6 +125,14 @@ void val_to_str(const T &val, string &str, ios_base &(*radix)(ios_base &) = std:
  */
 string double_to_str(double v);
 
+/**
+ * @brief 与 double_to_str 的格式相同，直接写到缓存中，不会构造临时的 string
+ * @param buf 缓存，内容不会以 '\0' 结尾
+ * @param size 缓存的大小，超出的部分会被截断
+ * @return 写入的字节数
+ */
+int double_to_str(double v, char *buf, int size);
+
 bool is_blank(const char *s);
 
 /**
@@ -19,7 +19,11 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/string.h"
 #include "common/lang/functional.h"
 #include "common/lang/iostream.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/chrono.h"
+#include "common/lang/mutex.h"
 #include "common/lang/new.h"
+#include "common/lang/utility.h"
 #include "common/log/log.h"
 #include "common/log/backtrace.h"
 
@@ -27,7 +31,146 @@ namespace common {
 
 Log *g_log = nullptr;
 
-Log::Log(const string &log_file_name, const LOG_LEVEL log_level, const LOG_LEVEL console_level)
+/**
+ * @brief 每个线程自己的日志缓存
+ * @details 单生产者单消费者的环形缓存，只有所属的线程写入，只有后台线程读取，所以不需要加锁。
+ * 读写位置都是单调递增的，对容量取模得到在缓存中的偏移。
+ * 每条日志是一个 LogRecordHeader 加上日志内容，按照头的大小对齐。缓存尾部放不下一条完整的日志时，
+ * 写一个长度为 -1 的头，表示剩下的空间不用，从缓存开头继续。
+ */
+class LogBuffer
+{
+public:
+  static constexpr size_t CAPACITY = 256 * ONE_KILO;
+
+  /// 一条日志最大的长度，超过的部分会被截断
+  static constexpr size_t MAX_RECORD_LENGTH = CAPACITY / 4;
+
+  LogBuffer() : data_(new char[CAPACITY]) {}
+
+  /**
+   * @brief 写入一条日志
+   * @return 缓存空间不够时返回 false
+   */
+  bool append(time_t log_time, const char *prefix, size_t prefix_len, const char *msg, size_t msg_len)
+  {
+    if (prefix_len + msg_len > MAX_RECORD_LENGTH) {
+      prefix_len = min(prefix_len, MAX_RECORD_LENGTH);
+      msg_len    = MAX_RECORD_LENGTH - prefix_len;
+    }
+
+    const size_t   record_size = align(sizeof(LogRecordHeader) + prefix_len + msg_len);
+    const uint64_t head        = head_.load(memory_order_relaxed);
+    const uint64_t tail        = tail_.load(memory_order_acquire);
+    size_t         offset      = head % CAPACITY;
+    const size_t   contiguous  = CAPACITY - offset;
+    const size_t   skip        = contiguous < record_size ? contiguous : 0;
+    if (CAPACITY - (head - tail) < skip + record_size) {
+      return false;
+    }
+
+    if (skip > 0) {
+      reinterpret_cast<LogRecordHeader *>(data_.get() + offset)->length = -1;
+      offset                                                            = 0;
+    }
+
+    auto *header     = reinterpret_cast<LogRecordHeader *>(data_.get() + offset);
+    header->length   = static_cast<int32_t>(prefix_len + msg_len);
+    header->log_time = log_time;
+    memcpy(data_.get() + offset + sizeof(LogRecordHeader), prefix, prefix_len);
+    memcpy(data_.get() + offset + sizeof(LogRecordHeader) + prefix_len, msg, msg_len);
+
+    head_.store(head + skip + record_size, memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief 读出所有已经写入的日志
+   * @param consumer 处理一条日志，参数是日志的时间和内容
+   */
+  template <typename Consumer>
+  void consume(Consumer consumer)
+  {
+    uint64_t       tail = tail_.load(memory_order_relaxed);
+    const uint64_t head = head_.load(memory_order_acquire);
+    while (tail < head) {
+      const size_t offset = tail % CAPACITY;
+      const auto  *header = reinterpret_cast<const LogRecordHeader *>(data_.get() + offset);
+      if (header->length < 0) {
+        tail += CAPACITY - offset;
+        continue;
+      }
+
+      consumer(header->log_time, data_.get() + offset + sizeof(LogRecordHeader), header->length);
+      tail += align(sizeof(LogRecordHeader) + header->length);
+    }
+    tail_.store(tail, memory_order_release);
+  }
+
+  /// 已经使用的空间超过一半
+  bool half_full() const
+  {
+    return head_.load(memory_order_relaxed) - tail_.load(memory_order_relaxed) > CAPACITY / 2;
+  }
+
+  /// 所属的线程退出后就不会再有新的日志
+  void close() { closed_.store(true, memory_order_release); }
+  bool closed() const { return closed_.load(memory_order_acquire); }
+
+private:
+  struct LogRecordHeader
+  {
+    int32_t length;  ///< 日志内容的长度，-1 表示跳到缓存开头
+    int32_t reserved;
+    time_t  log_time;
+  };
+
+  static size_t align(size_t size)
+  {
+    return (size + sizeof(LogRecordHeader) - 1) / sizeof(LogRecordHeader) * sizeof(LogRecordHeader);
+  }
+
+private:
+  unique_ptr<char[]> data_;
+  atomic<uint64_t>   head_{0};  ///< 写入位置，只有所属的线程修改
+  atomic<uint64_t>   tail_{0};  ///< 读取位置，只有后台线程修改
+  atomic<bool>       closed_{false};
+};
+
+/**
+ * @brief 线程在各个日志对象上的缓存
+ * @details 线程退出时标记缓存已经关闭，缓存中剩下的日志仍然由后台线程写出，之后再释放。
+ * 线程变量析构之后还可能打印日志(比如主线程退出时静态对象的析构函数)，所以缓存列表用指针保存，
+ * 析构后置空，这时日志直接写到文件中。
+ */
+struct ThreadLogBuffers
+{
+  vector<pair<int, shared_ptr<LogBuffer>>> buffers;
+};
+
+static thread_local ThreadLogBuffers *thread_log_buffers = nullptr;
+static thread_local bool              thread_log_exited  = false;
+
+struct ThreadLogBuffersGuard
+{
+  ~ThreadLogBuffersGuard()
+  {
+    if (thread_log_buffers != nullptr) {
+      for (auto &[log_id, buffer] : thread_log_buffers->buffers) {
+        buffer->close();
+      }
+      delete thread_log_buffers;
+      thread_log_buffers = nullptr;
+    }
+    thread_log_exited = true;
+  }
+};
+
+static thread_local ThreadLogBuffersGuard thread_log_buffers_guard;
+static atomic<int>                        next_log_id{0};
+
+Log::Log(const string &log_file_name, const LOG_LEVEL log_level, const LOG_LEVEL console_level,
+    const LOG_ROTATE rotate_type)
     : log_name_(log_file_name), log_level_(log_level), console_level_(console_level)
 {
   prefix_map_[LOG_LEVEL_PANIC] = "PANIC:";
@@ -45,14 +188,25 @@ Log::Log(const string &log_file_name, const LOG_LEVEL log_level, const LOG_LEVEL
   log_max_line_   = LOG_MAX_LINE;
   log_line_       = -1;
   rotate_type_    = LOG_ROTATE_BYDAY;
+  set_rotate_type(rotate_type);
 
   check_param_valid();
 
   context_getter_ = []() { return 0; };
+
+  id_     = ++next_log_id;
+  writer_ = thread(&Log::write_loop, this);
 }
 
 Log::~Log(void)
 {
+  {
+    lock_guard<mutex> guard(writer_lock_);
+    running_.store(false);
+  }
+  writer_cond_.notify_one();
+  writer_.join();
+
   pthread_mutex_lock(&lock_);
   if (ofs_.is_open()) {
     ofs_.close();
@@ -86,15 +240,14 @@ bool Log::check_output(const LOG_LEVEL level, const char *module)
   return false;
 }
 
-int Log::output(const LOG_LEVEL level, const char *module, const char *prefix, const char *f, ...)
+int Log::output(const LOG_LEVEL level, const char *module, const char *prefix, time_t log_time, const char *f, ...)
 {
-  bool locked = false;
   try {
     va_list args;
-    char    msg[ONE_KILO];
+    char    msg[ONE_KILO + 1];
 
     va_start(args, f);
-    vsnprintf(msg, sizeof(msg), f, args);
+    int len = vsnprintf(msg, ONE_KILO, f, args);
     va_end(args);
 
     if (LOG_LEVEL_PANIC <= level && level <= console_level_) {
@@ -103,32 +256,15 @@ int Log::output(const LOG_LEVEL level, const char *module, const char *prefix, c
       cout << msg << endl;
     }
 
-    if (LOG_LEVEL_PANIC <= level && level <= log_level_) {
-      pthread_mutex_lock(&lock_);
-      locked = true;
-      ofs_ << prefix;
-      ofs_ << msg;
-      ofs_ << "\n";
-      ofs_.flush();
-      log_line_++;
-      pthread_mutex_unlock(&lock_);
-      locked = false;
-    } else if (default_set_.find(module) != default_set_.end()) {
-      pthread_mutex_lock(&lock_);
-      locked = true;
-      ofs_ << prefix;
-      ofs_ << msg;
-      ofs_ << "\n";
-      ofs_.flush();
-      log_line_++;
-      pthread_mutex_unlock(&lock_);
-      locked = false;
+    if ((LOG_LEVEL_PANIC <= level && level <= log_level_) || default_set_.find(module) != default_set_.end()) {
+      // vsnprintf 返回的是完整格式化需要的长度，日志被截断时要按照实际写入的长度追加换行
+      len          = min(max(len, 0), static_cast<int>(ONE_KILO) - 1);
+      msg[len]     = '\n';
+      msg[len + 1] = '\0';
+      append(level, log_time, prefix, msg);
     }
 
   } catch (exception &e) {
-    if (locked) {
-      pthread_mutex_unlock(&lock_);
-    }
     cerr << e.what() << endl;
     return LOG_STATUS_ERR;
   }
@@ -136,6 +272,169 @@ int Log::output(const LOG_LEVEL level, const char *module, const char *prefix, c
   return LOG_STATUS_OK;
 }
 
+LogBuffer *Log::thread_buffer()
+{
+  if (thread_log_exited) {
+    return nullptr;
+  }
+
+  if (thread_log_buffers == nullptr) {
+    static_cast<void>(&thread_log_buffers_guard);  // 使用一次才会注册线程退出时的析构函数
+    thread_log_buffers = new ThreadLogBuffers;
+  }
+
+  for (auto &[log_id, buffer] : thread_log_buffers->buffers) {
+    if (log_id == id_) {
+      return buffer.get();
+    }
+  }
+
+  auto buffer = make_shared<LogBuffer>();
+  thread_log_buffers->buffers.emplace_back(id_, buffer);
+
+  lock_guard<mutex> guard(buffers_lock_);
+  buffers_.push_back(buffer);
+  return buffer.get();
+}
+
+void Log::append(LOG_LEVEL level, time_t log_time, const char *prefix, const char *msg)
+{
+  LogBuffer *buffer = thread_buffer();
+  if (nullptr == buffer) {
+    string batch;
+    pthread_mutex_lock(&lock_);
+    rotate_if_needed(log_time, batch);
+    batch.append(prefix).append(msg);
+    log_line_++;
+    write_batch(batch);
+    pthread_mutex_unlock(&lock_);
+    return;
+  }
+
+  const size_t prefix_len = strlen(prefix);
+  const size_t msg_len    = strlen(msg);
+  while (!buffer->append(log_time, prefix, prefix_len, msg, msg_len)) {
+    // 缓存满了，等后台线程腾出空间
+    writer_cond_.notify_one();
+    this_thread::yield();
+  }
+
+  if (level == LOG_LEVEL_PANIC) {
+    flush();
+  } else if (buffer->half_full()) {
+    writer_cond_.notify_one();
+  }
+}
+
+void Log::flush()
+{
+  if (this_thread::get_id() == writer_.get_id()) {
+    return;
+  }
+
+  unique_lock<mutex> lock(writer_lock_);
+  if (!running_.load()) {
+    return;
+  }
+  const uint64_t flush_seq = ++flush_requested_;
+  writer_cond_.notify_one();
+  flushed_cond_.wait(lock, [this, flush_seq]() { return flush_done_ >= flush_seq || !running_.load(); });
+}
+
+void Log::write_loop()
+{
+  string batch;
+  while (true) {
+    uint64_t flush_seq = 0;
+    bool     running   = true;
+    {
+      unique_lock<mutex> lock(writer_lock_);
+      if (flush_done_ == flush_requested_ && running_.load()) {
+        // 没有日志要写时也不会等太久，避免打印日志的线程每次都要唤醒后台线程
+        writer_cond_.wait_for(lock, chrono::milliseconds(50));
+      }
+      flush_seq = flush_requested_;
+      running   = running_.load();
+    }
+
+    pthread_mutex_lock(&lock_);
+    drain(batch);
+    pthread_mutex_unlock(&lock_);
+
+    {
+      lock_guard<mutex> guard(writer_lock_);
+      flush_done_ = flush_seq;
+    }
+    flushed_cond_.notify_all();
+
+    if (!running) {
+      break;
+    }
+  }
+}
+
+void Log::drain(string &batch)
+{
+  vector<shared_ptr<LogBuffer>> buffers;
+  {
+    lock_guard<mutex> guard(buffers_lock_);
+    buffers = buffers_;
+  }
+
+  for (shared_ptr<LogBuffer> &buffer : buffers) {
+    // 先检查是否关闭再读取，关闭之后不会再有新的日志，读完就可以释放了
+    const bool closed = buffer->closed();
+    buffer->consume([this, &batch](time_t log_time, const char *data, int len) {
+      rotate_if_needed(log_time, batch);
+      batch.append(data, len);
+      log_line_++;
+    });
+
+    if (closed) {
+      lock_guard<mutex> guard(buffers_lock_);
+      buffers_.erase(find(buffers_.begin(), buffers_.end(), buffer));
+    }
+  }
+
+  write_batch(batch);
+}
+
+void Log::rotate_if_needed(time_t log_time, string &batch)
+{
+  if (rotate_type_ == LOG_ROTATE_BYDAY) {
+    if (log_time != cached_time_) {
+      struct tm curr_time;
+      if (localtime_r(&log_time, &curr_time) == nullptr) {
+        return;
+      }
+      cached_time_       = log_time;
+      cached_date_.year_ = curr_time.tm_year + 1900;
+      cached_date_.mon_  = curr_time.tm_mon + 1;
+      cached_date_.day_  = curr_time.tm_mday;
+    }
+
+    if (log_date_.year_ != cached_date_.year_ || log_date_.mon_ != cached_date_.mon_ ||
+        log_date_.day_ != cached_date_.day_) {
+      write_batch(batch);
+      rotate_by_day(cached_date_.year_, cached_date_.mon_, cached_date_.day_);
+    }
+  } else if (log_line_ < 0 || log_line_ >= log_max_line_) {
+    write_batch(batch);
+    rotate_by_size();
+  }
+}
+
+void Log::write_batch(string &batch)
+{
+  if (batch.empty()) {
+    return;
+  }
+
+  ofs_.write(batch.data(), batch.size());
+  ofs_.flush();
+  batch.clear();
+}
+
 int Log::set_console_level(LOG_LEVEL console_level)
 {
   if (LOG_LEVEL_PANIC <= console_level && console_level < LOG_LEVEL_LAST) {
@@ -174,12 +473,20 @@ void Log::set_default_module(const string &modules) { split_string(modules, ",",
 int Log::set_rotate_type(LOG_ROTATE rotate_type)
 {
   if (LOG_ROTATE_BYDAY <= rotate_type && rotate_type < LOG_ROTATE_LAST) {
+    pthread_mutex_lock(&lock_);
     rotate_type_ = rotate_type;
+    pthread_mutex_unlock(&lock_);
   }
   return LOG_STATUS_OK;
 }
 
-LOG_ROTATE Log::get_rotate_type() { return rotate_type_; }
+LOG_ROTATE Log::get_rotate_type()
+{
+  pthread_mutex_lock(&lock_);
+  LOG_ROTATE rotate_type = rotate_type_;
+  pthread_mutex_unlock(&lock_);
+  return rotate_type;
+}
 
 int Log::rotate_by_day(const int year, const int month, const int day)
 {
@@ -328,12 +635,12 @@ LoggerFactory::~LoggerFactory()
 int LoggerFactory::init(
     const string &log_file, Log **logger, LOG_LEVEL log_level, LOG_LEVEL console_level, LOG_ROTATE rotate_type)
 {
-  Log *log = new (nothrow) Log(log_file, log_level, console_level);
+  // 在构造时指定切换方式，后台线程启动之后就不再修改
+  Log *log = new (nothrow) Log(log_file, log_level, console_level, rotate_type);
   if (log == nullptr) {
     cout << "Error: fail to construct a log object!" << endl;
     return -1;
   }
-  log->set_rotate_type(rotate_type);
 
   *logger = log;
 
@@ -349,7 +656,16 @@ int LoggerFactory::init_default(
   }
 
   backtrace_init();
-  return init(log_file, &g_log, log_level, console_level, rotate_type);
+  int ret = init(log_file, &g_log, log_level, console_level, rotate_type);
+  if (ret == 0) {
+    // 日志是后台线程写的，进程退出前要把缓存中的日志写完
+    atexit([]() {
+      if (g_log != nullptr) {
+        g_log->flush();
+      }
+    });
+  }
+  return ret;
 }
 
 }  // namespace common
@@ -20,13 +20,21 @@ See the Mulan PSL v2 for more details. */
 #include <string.h>
 #include <sys/time.h>
 
+#include <mutex>
+
 #include "common/defs.h"
+#include "common/lang/atomic.h"
+#include "common/lang/condition_variable.h"
 #include "common/lang/string.h"
 #include "common/lang/map.h"
+#include "common/lang/memory.h"
 #include "common/lang/set.h"
 #include "common/lang/functional.h"
 #include "common/lang/iostream.h"
 #include "common/lang/fstream.h"
+#include "common/lang/sstream.h"
+#include "common/lang/thread.h"
+#include "common/lang/vector.h"
 
 namespace common {
 
@@ -48,6 +56,15 @@ typedef enum
   LOG_LEVEL_LAST
 } LOG_LEVEL;
 
+/**
+ * @brief 编译时保留的最高日志级别
+ * @details 级别比它高的日志语句在编译时就会被去掉，不会有任何运行时开销。
+ * 可以在编译时通过 -DLOG_COMPILE_LEVEL=3 这样的方式指定，默认保留所有级别
+ */
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_TRACE
+#endif
+
 typedef enum
 {
   LOG_ROTATE_BYDAY = 0,
@@ -55,11 +72,19 @@ typedef enum
   LOG_ROTATE_LAST
 } LOG_ROTATE;
 
+class LogBuffer;
+
+/**
+ * @brief 日志
+ * @details 打印日志的线程只是把日志放到自己线程的缓存(LogBuffer)中，不需要加锁。
+ * 一个后台线程负责把所有线程缓存中的日志批量写到文件中，日志文件的切换(rotate)也由后台线程完成。
+ * PANIC 级别的日志会等待后台线程写完再返回，以免进程退出时丢失。
+ */
 class Log
 {
 public:
   Log(const string &log_name, const LOG_LEVEL log_level = LOG_LEVEL_INFO,
-      const LOG_LEVEL console_level = LOG_LEVEL_WARN);
+      const LOG_LEVEL console_level = LOG_LEVEL_WARN, const LOG_ROTATE rotate_type = LOG_ROTATE_BYDAY);
   ~Log(void);
 
   static int init(const string &log_file);
@@ -91,7 +116,12 @@ public:
   template <class T>
   int trace(T message);
 
-  int output(const LOG_LEVEL level, const char *module, const char *prefix, const char *f, ...);
+  int output(const LOG_LEVEL level, const char *module, const char *prefix, time_t log_time, const char *f, ...);
+
+  /**
+   * @brief 等待后台线程把调用之前打印的日志都写到文件中
+   */
+  void flush();
 
   int       set_console_level(const LOG_LEVEL console_level);
   LOG_LEVEL get_console_level();
@@ -99,6 +129,7 @@ public:
   int       set_log_level(const LOG_LEVEL log_level);
   LOG_LEVEL get_log_level();
 
+  /// 后台线程切换日志文件时会读取 rotate_type_，修改时需要加锁。最好在构造时指定
   int        set_rotate_type(LOG_ROTATE rotate_type);
   LOG_ROTATE get_rotate_type();
 
@@ -132,8 +163,27 @@ private:
   template <class T>
   int out(const LOG_LEVEL console_level, const LOG_LEVEL log_level, T &message);
 
+  /**
+   * @brief 把一条日志放到当前线程的缓存中
+   */
+  void append(LOG_LEVEL level, time_t log_time, const char *prefix, const char *msg);
+
+  /// 当前线程在这个日志对象上的缓存，第一次使用时创建
+  LogBuffer *thread_buffer();
+
+  /// 后台线程的主循环
+  void write_loop();
+
+  /// 把所有线程缓存中的日志写到文件中，需要持有 lock_
+  void drain(string &batch);
+
+  /// 按照日志的时间检查是否需要切换日志文件，需要时先把攒下的日志写到旧文件中，需要持有 lock_
+  void rotate_if_needed(time_t log_time, string &batch);
+
+  void write_batch(string &batch);
+
 private:
-  pthread_mutex_t lock_;
+  pthread_mutex_t lock_;  ///< 保护日志文件，只有后台线程和 rotate 会使用
   ofstream        ofs_;
   string          log_name_;
   LOG_LEVEL       log_level_;
@@ -157,6 +207,24 @@ private:
   DefaultSet          default_set_;
 
   function<intptr_t()> context_getter_;
+
+  /// 区分不同的日志对象，线程缓存按照这个编号查找，不使用指针是因为日志对象的地址可能被复用
+  int id_ = 0;
+
+  std::mutex                    buffers_lock_;  ///< 只在线程第一次打印日志和后台线程遍历时使用
+  vector<shared_ptr<LogBuffer>> buffers_;
+
+  thread             writer_;
+  atomic<bool>       running_{true};
+  std::mutex         writer_lock_;
+  condition_variable writer_cond_;   ///< 唤醒后台线程
+  condition_variable flushed_cond_;  ///< 后台线程写完一轮之后通知等待 flush 的线程
+  uint64_t           flush_requested_ = 0;
+  uint64_t           flush_done_      = 0;
+
+  /// 后台线程中缓存的最近一条日志的时间，避免每条日志都计算日期
+  time_t  cached_time_ = -1;
+  LogDate cached_date_{};
 };
 
 class LoggerFactory
@@ -180,10 +248,11 @@ extern Log *g_log;
 
 #define LOG_HEAD_SIZE 128
 
-#define LOG_HEAD(prefix, level)                                            \
+#define LOG_HEAD(prefix, level, log_time)                                  \
   if (common::g_log) {                                                     \
     struct timeval tv;                                                     \
     gettimeofday(&tv, NULL);                                               \
+    log_time = tv.tv_sec;                                                  \
     struct tm  curr_time;                                                  \
     struct tm *p = localtime_r(&tv.tv_sec, &curr_time);                    \
                                                                            \
@@ -203,7 +272,6 @@ extern Log *g_log;
           (int32_t)getpid(),                                               \
           gettid(),                                                        \
           common::g_log->context_id());                                    \
-      common::g_log->rotate(p->tm_year + 1900, p->tm_mon + 1, p->tm_mday); \
     }                                                                      \
     snprintf(prefix,                                                       \
         sizeof(prefix),                                                    \
@@ -215,14 +283,15 @@ extern Log *g_log;
         (int32_t)__LINE__);                                                \
   }
 
-#define LOG_OUTPUT(level, fmt, ...)                                    \
-  do {                                                                 \
-    using namespace common;                                            \
-    if (g_log && g_log->check_output(level, __FILE_NAME__)) {          \
-      char prefix[ONE_KILO] = {0};                                     \
-      LOG_HEAD(prefix, level);                                         \
-      g_log->output(level, __FILE_NAME__, prefix, fmt, ##__VA_ARGS__); \
-    }                                                                  \
+#define LOG_OUTPUT(level, fmt, ...)                                                         \
+  do {                                                                                      \
+    using namespace common;                                                                 \
+    if ((level) <= LOG_COMPILE_LEVEL && g_log && g_log->check_output(level, __FILE_NAME__)) { \
+      char   prefix[ONE_KILO] = {0};                                                        \
+      time_t log_time         = 0;                                                          \
+      LOG_HEAD(prefix, level, log_time);                                                    \
+      g_log->output(level, __FILE_NAME__, prefix, log_time, fmt, ##__VA_ARGS__);            \
+    }                                                                                       \
   } while (0)
 
 #define LOG_DEFAULT(fmt, ...) LOG_OUTPUT(common::g_log->get_log_level(), fmt, ##__VA_ARGS__)
@@ -280,32 +349,24 @@ int Log::trace(T message)
 template <class T>
 int Log::out(const LOG_LEVEL console_level, const LOG_LEVEL log_level, T &msg)
 {
-  bool locked = false;
   if (console_level < LOG_LEVEL_PANIC || console_level > console_level_ || log_level < LOG_LEVEL_PANIC ||
       log_level > log_level_) {
     return LOG_STATUS_OK;
   }
   try {
-    char prefix[ONE_KILO] = {0};
-    LOG_HEAD(prefix, log_level);
+    char   prefix[ONE_KILO] = {0};
+    time_t log_time         = 0;
+    LOG_HEAD(prefix, log_level, log_time);
     if (LOG_LEVEL_PANIC <= console_level && console_level <= console_level_) {
       cout << prefix_map_[console_level] << msg;
     }
 
     if (LOG_LEVEL_PANIC <= log_level && log_level <= log_level_) {
-      pthread_mutex_lock(&lock_);
-      locked = true;
-      ofs_ << prefix;
-      ofs_ << msg;
-      ofs_.flush();
-      log_line_++;
-      pthread_mutex_unlock(&lock_);
-      locked = false;
+      ostringstream oss;
+      oss << msg;
+      append(log_level, log_time, prefix, oss.str().c_str());
     }
   } catch (exception &e) {
-    if (locked) {
-      pthread_mutex_unlock(&lock_);
-    }
     cerr << e.what() << endl;
     return LOG_STATUS_ERR;
   }
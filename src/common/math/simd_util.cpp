@@ -40,6 +40,76 @@ float mm256_sum_ps(const float *values, int size)
   return sum;
 }
 
+/// @brief 把 8 个 float 水平相加
+static inline float mm256_hsum_ps(__m256 vec)
+{
+  __m128 low  = _mm256_castps256_ps128(vec);
+  __m128 high = _mm256_extractf128_ps(vec, 1);
+  low         = _mm_add_ps(low, high);
+  low         = _mm_hadd_ps(low, low);
+  low         = _mm_hadd_ps(low, low);
+  return _mm_cvtss_f32(low);
+}
+
+float mm256_inner_product_ps(const float *left, const float *right, int size)
+{
+  __m256 sum = _mm256_setzero_ps();
+  int    i   = 0;
+  for (; i + SIMD_WIDTH <= size; i += SIMD_WIDTH) {
+    __m256 l = _mm256_loadu_ps(left + i);
+    __m256 r = _mm256_loadu_ps(right + i);
+    sum      = _mm256_add_ps(sum, _mm256_mul_ps(l, r));
+  }
+
+  float result = mm256_hsum_ps(sum);
+  for (; i < size; i++) {
+    result += left[i] * right[i];
+  }
+  return result;
+}
+
+float mm256_l2_square_ps(const float *left, const float *right, int size)
+{
+  __m256 sum = _mm256_setzero_ps();
+  int    i   = 0;
+  for (; i + SIMD_WIDTH <= size; i += SIMD_WIDTH) {
+    __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(left + i), _mm256_loadu_ps(right + i));
+    sum         = _mm256_add_ps(sum, _mm256_mul_ps(diff, diff));
+  }
+
+  float result = mm256_hsum_ps(sum);
+  for (; i < size; i++) {
+    float diff = left[i] - right[i];
+    result += diff * diff;
+  }
+  return result;
+}
+
+void mm256_inner_product_norm_ps(
+    const float *left, const float *right, int size, float &product, float &left_norm, float &right_norm)
+{
+  __m256 product_sum = _mm256_setzero_ps();
+  __m256 left_sum    = _mm256_setzero_ps();
+  __m256 right_sum   = _mm256_setzero_ps();
+  int    i           = 0;
+  for (; i + SIMD_WIDTH <= size; i += SIMD_WIDTH) {
+    __m256 l    = _mm256_loadu_ps(left + i);
+    __m256 r    = _mm256_loadu_ps(right + i);
+    product_sum = _mm256_add_ps(product_sum, _mm256_mul_ps(l, r));
+    left_sum    = _mm256_add_ps(left_sum, _mm256_mul_ps(l, l));
+    right_sum   = _mm256_add_ps(right_sum, _mm256_mul_ps(r, r));
+  }
+
+  product    = mm256_hsum_ps(product_sum);
+  left_norm  = mm256_hsum_ps(left_sum);
+  right_norm = mm256_hsum_ps(right_sum);
+  for (; i < size; i++) {
+    product += left[i] * right[i];
+    left_norm += left[i] * left[i];
+    right_norm += right[i] * right[i];
+  }
+}
+
 template <typename V>
 void selective_load(V *memory, int offset, V *vec, __m256i &inv)
 {
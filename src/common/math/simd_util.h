@@ -22,6 +22,19 @@ int mm256_extract_epi32_var_indx(const __m256i vec, const unsigned int i);
 int   mm256_sum_epi32(const int *values, int size);
 float mm256_sum_ps(const float *values, int size);
 
+/// @brief 两个 float 数组的内积
+float mm256_inner_product_ps(const float *left, const float *right, int size);
+
+/// @brief 两个 float 数组对应元素差值的平方和，即欧氏距离的平方
+float mm256_l2_square_ps(const float *left, const float *right, int size);
+
+/**
+ * @brief 一次遍历同时计算内积和两个数组各自的平方和
+ * @details 余弦距离需要这三个值，合并计算可以只读一遍数据。
+ */
+void mm256_inner_product_norm_ps(
+    const float *left, const float *right, int size, float &product, float &left_norm, float &right_norm);
+
 /// @brief selective load 的标量实现
 template <typename V>
 void selective_load(V *memory, int offset, V *vec, __m256i &inv);
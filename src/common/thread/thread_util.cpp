@@ -14,6 +14,10 @@ See the Mulan PSL v2 for more details. */
 
 #include <pthread.h>
 #include <stdio.h>
+#include <thread>
+
+#include "common/thread/thread_util.h"
+#include "common/lang/vector.h"
 
 namespace common {
 
@@ -30,4 +34,41 @@ int thread_set_name(const char *name)
 #endif
 }
 
+int thread_set_cpu_affinity(int cpu)
+{
+#ifdef __linux__
+  int cpu_num = static_cast<int>(std::thread::hardware_concurrency());
+  if (cpu_num <= 0 || cpu < 0) {
+    return -1;
+  }
+
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu % cpu_num, &cpu_set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+#else
+  return 0;
+#endif
+}
+
+void thread_run_parallel(const char *name, int thread_num, const function<void(int)> &task)
+{
+  if (thread_num <= 1) {
+    task(0);
+    return;
+  }
+
+  vector<std::thread> threads;
+  threads.reserve(thread_num);
+  for (int i = 0; i < thread_num; i++) {
+    threads.emplace_back([name, i, &task]() {
+      thread_set_name(name);
+      task(i);
+    });
+  }
+  for (std::thread &t : threads) {
+    t.join();
+  }
+}
+
 }  // namespace common
\ No newline at end of file
@@ -14,6 +14,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/lang/functional.h"
+
 namespace common {
 
 /**
@@ -25,4 +27,20 @@ namespace common {
  */
 int thread_set_name(const char *name);
 
+/**
+ * @brief 把当前线程绑定到指定的CPU上
+ * @details 只在Linux上生效，其它平台直接返回0。
+ * @param cpu CPU编号，超过CPU个数时会按照CPU个数取模
+ * @return int 设置成功返回0
+ */
+int thread_set_cpu_affinity(int cpu);
+
+/**
+ * @brief 启动 thread_num 个线程执行 task，等待所有线程结束后返回
+ * @details 用于执行一个查询时的并行计算，线程只在这次计算中使用。task 的参数是线程编号，从0开始。
+ * thread_num 小于等于1时直接在当前线程中执行。
+ * @param name 线程的名字
+ */
+void thread_run_parallel(const char *name, int thread_num, const function<void(int)> &task);
+
 }  // namespace common
\ No newline at end of file
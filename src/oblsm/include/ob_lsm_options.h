@@ -28,6 +28,15 @@ struct ObLsmOptions
   // sstable size
   size_t table_size = 16 * 1024;
 
+  // approximate size of the user data packed per block in sstable
+  size_t block_size = 4 * 1024;
+  // number of keys between restart points for prefix compression of keys in a block
+  size_t block_restart_interval = 16;
+  // codec used to compress sstable blocks, a block is stored uncompressed if compression saves less than 1/8
+  CompressionType compression = CompressionType::NONE;
+  // compression level from 1(fastest) to 9(best compression)
+  int compression_level = 1;
+
   // leveled compaction
   size_t default_levels        = 7;
   size_t default_l1_level_size = 128 * 1024;
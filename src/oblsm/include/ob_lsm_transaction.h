@@ -51,8 +51,12 @@ public:
   /*
    * @brief Retrieves the value associated with a given key.
    *
+   * The changes of this transaction are visible, other changes are visible only if they
+   * were committed before the transaction began.
+   *
    * @param key The key to look up within the database.
    * @param value A pointer to a string where the associated value will be stored, if found.
+   * @return RC::NOT_EXIST if the key does not exist or has been removed.
    */
   RC get(const string_view &key, string *value);
 
@@ -81,6 +85,7 @@ public:
   /**
    * @brief Commits the transaction, persisting all transaction changes to the database.
    *
+   * All changes are written by a single `ObLsm::batch_put`, so they are applied atomically.
    */
   RC commit();
 
@@ -109,7 +114,8 @@ private:
    *
    * This map holds key-value pairs that have been inserted or removed within the
    * transaction scope but not yet committed to the database. It's used to track changes
-   * and ensure atomicity during commit operations.
+   * and ensure atomicity during commit operations. A removed key is stored with an empty
+   * value, the same as a deletion in oblsm.
    */
   map<string, string> inner_store_;
 };
@@ -119,5 +125,22 @@ private:
  * @brief An iterator for traversing the transaction's in-memory store
  */
 class TrxInnerMapIterator : public ObLsmIterator
-{};
+{
+public:
+  explicit TrxInnerMapIterator(const map<string, string> &store) : store_(store), iter_(store.end()) {}
+  ~TrxInnerMapIterator() override = default;
+
+  bool valid() const override { return iter_ != store_.end(); }
+  void seek_to_first() override { iter_ = store_.begin(); }
+  void seek_to_last() override { iter_ = store_.empty() ? store_.end() : std::prev(store_.end()); }
+  void seek(const string_view &key) override { iter_ = store_.lower_bound(string(key)); }
+  void next() override { ++iter_; }
+
+  string_view key() const override { return iter_->first; }
+  string_view value() const override { return iter_->second; }
+
+private:
+  const map<string, string>          &store_;
+  map<string, string>::const_iterator iter_;
+};
 }  // namespace oceanbase
\ No newline at end of file
@@ -9,6 +9,9 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #pragma once
+
+#include <cstdint>
+
 namespace oceanbase {
 
 static constexpr const char *SSTABLE_SUFFIX  = ".sst";
@@ -26,4 +29,15 @@ enum class CompactionType
   UNKNOWN,
 };
 
+/**
+ * @enum CompressionType
+ * @brief Defines the codecs used to compress the blocks of SSTable.
+ */
+enum class CompressionType : uint8_t
+{
+  NONE = 0,
+  LZ,
+  UNKNOWN,
+};
+
 }  // namespace oceanbase
\ No newline at end of file
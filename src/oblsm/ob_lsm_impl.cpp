@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #include "oblsm/ob_lsm_impl.h"
 
+#include "common/lang/algorithm.h"
+#include "common/lang/filesystem.h"
 #include "common/log/log.h"
 #include "common/sys/rc.h"
 #include "oblsm/include/ob_lsm.h"
@@ -26,6 +28,12 @@ See the Mulan PSL v2 for more details. */
 #include "oblsm/ob_lsm_define.h"
 
 namespace oceanbase {
+
+// the max size of WAL records written by a group commit
+static constexpr size_t MAX_GROUP_COMMIT_SIZE = 1 << 20;
+// the group of a small write is limited to avoid slowing down the small write too much
+static constexpr size_t SMALL_WRITE_SIZE = 128 << 10;
+
 ObLsmImpl::ObLsmImpl(const ObLsmOptions &options, const string &path)
     : options_(options), path_(path), mu_(), mem_table_(nullptr), imem_tables_(), manifest_(path)
 {
@@ -77,7 +85,14 @@ RC ObLsmImpl::recover()
   }
 
   // Recover memtable from WAL file.
-  wal_ = std::make_unique<WAL>();
+  if (new_memtable_record) {
+    memtable_id_ = new_memtable_record->memtable_id;
+  }
+  rc = recover_from_wal();
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to recover memtable from wal, rc=%s", strrc(rc));
+    return rc;
+  }
 
   // After recover from the old manifest file, write the snapshot into a new manifest file.
   if (!compaction_records.empty()) {
@@ -101,57 +116,148 @@ RC ObLsm::open(const ObLsmOptions &options, const string &path, ObLsm **dbptr)
 }
 
 RC ObLsmImpl::put(const string_view &key, const string_view &value)
+{
+  LOG_TRACE("begin to put key=%s, value=%s", key.data(), value.data());
+  WalBatch batch{{key, value}};
+  return write(batch);
+}
+
+RC ObLsmImpl::batch_put(const vector<pair<string, string>> &kvs)
+{
+  if (kvs.empty()) {
+    return RC::SUCCESS;
+  }
+
+  WalBatch batch;
+  batch.reserve(kvs.size());
+  for (const auto &[key, value] : kvs) {
+    batch.emplace_back(key, value);
+  }
+  return write(batch);
+}
+
+RC ObLsmImpl::remove(const string_view &key)
+{
+  // an empty value is a tombstone of the key
+  WalBatch batch{{key, string_view()}};
+  return write(batch);
+}
+
+RC ObLsmImpl::write(const WalBatch &batch)
 {
   // TODO: if put rate is too high, slow down writes is needed.
   // currently, the writes is stopped when the memtable is full.
-  LOG_TRACE("begin to put key=%s, value=%s", key.data(), value.data());
-  RC rc = RC::SUCCESS;
-  // TODO: currenttly the memtable use skiplist as the underlying data structure,
-  // and the skiplist concurently write is not thread safe, so we use mutex here,
-  // if the skiplist support `insert_concurrently()` interface, can we remove the mutex?
+  ObLsmWriter        writer(&batch);
   unique_lock<mutex> lock(mu_);
-  uint64_t           seq = seq_.fetch_add(1);
-  // Write WAL
-  rc = wal_->put(seq, key, value);
-  if (rc != RC::SUCCESS) {
-    return rc;
+  writers_.push_back(&writer);
+  while (!writer.done && &writer != writers_.front()) {
+    writer.cv.wait(lock);
+  }
+  if (writer.done) {
+    // committed by another leader
+    return writer.rc;
   }
 
-  if (options_.force_sync_new_log) {
-    rc = wal_->sync();
-    if (rc != RC::SUCCESS) {
-      LOG_ERROR("Failed to sync wal logs, rc=%s", strrc(rc));
-      return rc;
+  RC                    rc          = make_room_for_write(lock);
+  ObLsmWriter          *last_writer = &writer;
+  const uint64_t        last_seq    = seq_.load();
+  size_t                entry_count = 0;
+  vector<ObLsmWriter *> group;
+  if (OB_SUCC(rc)) {
+    // Allow the group to grow up to a maximum size, but if the leader's write is small,
+    // limit the growth so we do not slow down the small write too much.
+    size_t leader_size = 0;
+    for (const auto &[key, value] : batch) {
+      leader_size += key.size() + value.size();
+    }
+    size_t max_group_size = MAX_GROUP_COMMIT_SIZE;
+    if (leader_size <= SMALL_WRITE_SIZE) {
+      max_group_size = leader_size + SMALL_WRITE_SIZE;
+    }
+
+    // every batch is encoded as one WAL record, and the records of the group are written at once
+    string records;
+    for (ObLsmWriter *w : writers_) {
+      if (w != &writer && records.size() >= max_group_size) {
+        break;
+      }
+      WAL::encode_batch(last_seq + entry_count + 1, *w->batch, &records);
+      entry_count += w->batch->size();
+      group.push_back(w);
+      last_writer = w;
+    }
+
+    // Only the leader touches WAL and memtable, so the lock can be released while writing. The
+    // writers arriving meanwhile will wait in the queue and be committed by the next leader.
+    shared_ptr<WAL>        wal = wal_;
+    shared_ptr<ObMemTable> mem = mem_table_;
+    lock.unlock();
+
+    rc = wal->append(records);
+    if (OB_SUCC(rc) && options_.force_sync_new_log) {
+      // one sync for the whole group
+      rc = wal->sync();
+      if (OB_FAIL(rc)) {
+        LOG_ERROR("Failed to sync wal logs, rc=%s", strrc(rc));
+      }
+    }
+
+    if (OB_SUCC(rc)) {
+      uint64_t seq = last_seq;
+      for (ObLsmWriter *w : group) {
+        for (const auto &[key, value] : *w->batch) {
+          mem->put(++seq, key, value);
+        }
+      }
+    }
+
+    lock.lock();
+    if (OB_SUCC(rc)) {
+      // publish the whole group at once, so readers never see a partial batch
+      seq_.store(last_seq + entry_count);
+    }
+  }
+
+  while (true) {
+    ObLsmWriter *ready = writers_.front();
+    writers_.pop_front();
+    if (ready != &writer) {
+      ready->rc   = rc;
+      ready->done = true;
+      ready->cv.notify_one();
+    }
+    if (ready == last_writer) {
+      break;
     }
   }
-  // write memtable
-  mem_table_->put(seq, key, value);
-  size_t mem_size = mem_table_->appro_memory_usage();
-  if (mem_size > options_.memtable_size) {
+
+  // notify the new head of the write queue
+  if (!writers_.empty()) {
+    writers_.front()->cv.notify_one();
+  }
+  return rc;
+}
+
+RC ObLsmImpl::make_room_for_write(unique_lock<mutex> &lock)
+{
+  RC rc = RC::SUCCESS;
+  while (mem_table_->appro_memory_usage() > options_.memtable_size) {
     // Thinking point: here vector is used to store imems,
     // but only one imem is stored at most. Is it possible
     // to store more than one imem and what are the implications
     // of storing more than one imem.
     if (imem_tables_.size() >= 1) {
+      // wait for the background thread to build the frozen memtable
       cv_.wait(lock);
-    }
-    // check again after get lock(maybe freeze memtable by another thread)
-    if (mem_table_->appro_memory_usage() > options_.memtable_size) {
-      manifest_.latest_seq = seq;
-      try_freeze_memtable();
     } else {
-      // if there are multi put threads waiting here, need to notify one thread to
-      // continue to write to memtable.
-      cv_.notify_one();
+      manifest_.latest_seq = seq_.load();
+      rc                   = try_freeze_memtable();
+      break;
     }
   }
   return rc;
 }
 
-RC ObLsmImpl::batch_put(const vector<pair<string, string>> &kvs) { return RC::UNIMPLEMENTED; }
-
-RC ObLsmImpl::remove(const string_view &key) { return RC::UNIMPLEMENTED; }
-
 RC ObLsmImpl::try_freeze_memtable()
 {
   RC rc = RC::SUCCESS;
@@ -169,7 +275,11 @@ RC ObLsmImpl::try_freeze_memtable()
   frozen_wals_.emplace_back(std::move(wal_));
   wal_                     = std::make_unique<WAL>();
   uint64_t new_memtable_id = memtable_id_.fetch_add(1) + 1;
-  wal_->open(get_wal_path(new_memtable_id));
+  rc                       = wal_->open(get_wal_path(new_memtable_id));
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to open wal of new memtable, rc=%s", strrc(rc));
+    return rc;
+  }
   std::shared_ptr<ObLsmBgCompactCtx> background_compaction_ctx = make_shared<ObLsmBgCompactCtx>(new_memtable_id);
   auto bg_task = [this, background_compaction_ctx]() { this->background_compaction(background_compaction_ctx); };
   int  ret     = executor_.execute(bg_task);
@@ -214,8 +324,12 @@ void ObLsmImpl::try_major_compaction()
 {
   unique_lock<mutex>             lock(mu_);
   unique_ptr<ObCompactionPicker> picker(ObCompactionPicker::create(options_.type, &options_));
-  unique_ptr<ObCompaction>       picked = picker->pick(sstables_);
-  ObManifestCompaction           mf_record;
+  if (picker == nullptr) {
+    // no picker for this compaction type yet, the sstables are kept in level 0
+    return;
+  }
+  unique_ptr<ObCompaction> picked = picker->pick(sstables_);
+  ObManifestCompaction     mf_record;
   lock.unlock();
   if (picked == nullptr || picked->size() == 0) {
     return;
@@ -279,7 +393,7 @@ vector<shared_ptr<ObSSTable>> ObLsmImpl::do_compaction(ObCompaction *picked) { r
 
 void ObLsmImpl::build_sstable(shared_ptr<ObMemTable> imem)
 {
-  unique_ptr<ObSSTableBuilder> tb = make_unique<ObSSTableBuilder>(&default_comparator_, block_cache_.get());
+  unique_ptr<ObSSTableBuilder> tb = make_unique<ObSSTableBuilder>(&default_comparator_, block_cache_.get(), options_);
 
   uint64_t sstable_id = sstable_id_.fetch_add(1);
   tb->build(imem, get_sstable_path(sstable_id), sstable_id);
@@ -314,9 +428,8 @@ string ObLsmImpl::get_wal_path(uint64_t memtable_id)
 
 RC ObLsmImpl::get(const string_view &key, string *value)
 {
-  RC                 rc = RC::SUCCESS;
-  unique_lock<mutex> lock(mu_);
-  auto               iter = unique_ptr<ObLsmIterator>(new_iterator(ObLsmReadOptions{}));
+  RC   rc   = RC::SUCCESS;
+  auto iter = unique_ptr<ObLsmIterator>(new_iterator(ObLsmReadOptions{}));
   iter->seek(key);
   if (iter->valid() && iter->key() == key) {
     if (iter->value().empty()) {
@@ -374,6 +487,65 @@ void ObLsmImpl::dump_sstables()
   }
 }
 
+RC ObLsmImpl::recover_from_wal()
+{
+  // The WAL files of memtables which have not been built into sstables, the ids of
+  // them are not less than the id of the latest memtable recorded in the manifest.
+  vector<uint64_t> memtable_ids;
+  for (const auto &entry : filesystem::directory_iterator(path_)) {
+    const filesystem::path &file = entry.path();
+    if (!entry.is_regular_file() || file.extension() != WAL_SUFFIX) {
+      continue;
+    }
+    uint64_t memtable_id = std::stoull(file.stem().string());
+    if (memtable_id >= memtable_id_.load()) {
+      memtable_ids.push_back(memtable_id);
+    }
+  }
+  std::sort(memtable_ids.begin(), memtable_ids.end());
+
+  RC rc = RC::SUCCESS;
+  for (uint64_t memtable_id : memtable_ids) {
+    vector<WalRecord> records;
+    rc = WAL().recover(get_wal_path(memtable_id), records);
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("Failed to recover records from wal %lu, rc=%s", memtable_id, strrc(rc));
+      return rc;
+    }
+    for (const WalRecord &record : records) {
+      mem_table_->put(record.seq, record.key, record.val);
+      if (record.seq > seq_.load()) {
+        seq_.store(record.seq);
+      }
+    }
+    LOG_INFO("recover %lu records from wal %lu", records.size(), memtable_id);
+  }
+
+  if (memtable_ids.size() > 1) {
+    // The process crashed before the frozen memtable was built into sstable. The records of
+    // all WALs are in the memtable now, so build it and start a new memtable with a new WAL.
+    uint64_t new_memtable_id = memtable_ids.back() + 1;
+    manifest_.latest_seq     = seq_.load();
+    build_sstable(mem_table_);
+    manifest_.push(ObManifestNewMemtable{new_memtable_id});
+    for (uint64_t memtable_id : memtable_ids) {
+      ::remove(get_wal_path(memtable_id).c_str());
+    }
+    mem_table_   = make_shared<ObMemTable>();
+    memtable_id_ = new_memtable_id;
+  } else if (memtable_ids.size() == 1) {
+    memtable_id_ = memtable_ids.back();
+  }
+
+  wal_ = std::make_shared<WAL>();
+  rc   = wal_->open(get_wal_path(memtable_id_.load()));
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to open wal, rc=%s", strrc(rc));
+    return rc;
+  }
+  return rc;
+}
+
 RC ObLsmImpl::recover_from_manifest_records(const std::vector<ObManifestCompaction> &records)
 {
   std::vector<std::vector<uint64_t>> tmp_sstables;
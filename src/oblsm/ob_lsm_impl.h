@@ -16,6 +16,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/atomic.h"
 #include "common/lang/memory.h"
 #include "common/lang/condition_variable.h"
+#include "common/lang/deque.h"
 #include "common/lang/utility.h"
 #include "common/thread/thread_pool_executor.h"
 #include "oblsm/include/ob_lsm_transaction.h"
@@ -35,13 +36,30 @@ struct ObLsmBgCompactCtx
   uint64_t new_memtable_id;
 };
 
+/**
+ * @brief A writer waiting in the write queue of ObLsmImpl.
+ * @details The writer at the front of the queue becomes the leader. The leader
+ * merges the batches of the writers behind it into one group, appends them to the
+ * WAL with a single write, syncs once for the whole group, applies the group to
+ * the memtable and then wakes up the followers whose batches were committed.
+ */
+struct ObLsmWriter
+{
+  explicit ObLsmWriter(const WalBatch *b) : batch(b) {}
+
+  const WalBatch    *batch;
+  bool               done = false;
+  RC                 rc   = RC::SUCCESS;
+  condition_variable cv;
+};
+
 class ObLsmImpl : public ObLsm
 {
 public:
   ObLsmImpl(const ObLsmOptions &options, const string &path);
   ~ObLsmImpl() override
   {
-    if (!options_.force_sync_new_log) {
+    if (!options_.force_sync_new_log && wal_ != nullptr) {
       wal_->sync();
     }
     executor_.shutdown();
@@ -67,6 +85,19 @@ public:
   void dump_sstables() override;
 
 private:
+  /**
+   * @brief Writes a batch to WAL and memtable atomically.
+   * @details Concurrent writers are group committed: only the leader of the write queue
+   * writes the WAL, and only one sync is issued for the whole group.
+   */
+  RC write(const WalBatch &batch);
+
+  /**
+   * @brief Makes sure the active memtable has room for the next write group.
+   * @note The caller must hold `mu_` and must be the leader of the write queue.
+   */
+  RC make_room_for_write(unique_lock<mutex> &lock);
+
   RC recover_from_wal();
   RC recover_from_manifest_records(const std::vector<ObManifestCompaction> &records);
   RC load_manifest_snapshot(const ObManifestSnapshot &snapshot);
@@ -163,6 +194,7 @@ private:
   mutex                             mu_;
   std::shared_ptr<WAL>              wal_;
   std::vector<std::shared_ptr<WAL>> frozen_wals_;
+  deque<ObLsmWriter *>              writers_;
   shared_ptr<ObMemTable>            mem_table_;
   vector<shared_ptr<ObMemTable>>    imem_tables_;
   SSTablesPtr                       sstables_;
@@ -15,10 +15,9 @@ See the Mulan PSL v2 for more details. */
 namespace oceanbase {
 
 /**
- * @brief merge TrxInnerMapIterator and ObUserIterator
- * @details Merges two iterators of different types into one.
- * If the two iterators have the same key, only
- * produce the key once and prefer the entry from left.
+ * @brief Merges the transaction's in-memory store (left) with the snapshot of the database (right).
+ * @details Both iterators are ordered by user key. If a key exists in both, the one in the
+ * transaction store wins. An empty value in the transaction store means the key has been removed.
  */
 class TrxIterator : public ObLsmIterator
 {
@@ -26,36 +25,141 @@ public:
   TrxIterator(ObLsmIterator *left, ObLsmIterator *right) : left_(left), right_(right) {}
   ~TrxIterator() override = default;
 
-  bool valid() const override { return false; }
-  void seek_to_first() override {}
-  void seek_to_last() override {}
-  void seek(const string_view &key) override {}
-  void next() override {}
+  bool valid() const override { return current_ != nullptr; }
+  void seek_to_first() override
+  {
+    left_->seek_to_first();
+    right_->seek_to_first();
+    find_next_entry();
+  }
+  /**
+   * @details The snapshot iterator of oblsm can only move forward, so the last visible key is
+   * found by a forward pass and then positioned with seek. This costs O(N).
+   */
+  void seek_to_last() override
+  {
+    string last_key;
+    bool   found = false;
+    for (seek_to_first(); valid(); next()) {
+      last_key.assign(key());
+      found = true;
+    }
+    if (found) {
+      seek(last_key);
+    }
+  }
+  void seek(const string_view &key) override
+  {
+    left_->seek(key);
+    right_->seek(key);
+    find_next_entry();
+  }
+  void next() override
+  {
+    current_->next();
+    find_next_entry();
+  }
 
-  string_view key() const override { return ""; }
-  string_view value() const override { return ""; }
+  string_view key() const override { return current_->key(); }
+  string_view value() const override { return current_->value(); }
 
 private:
+  void find_next_entry()
+  {
+    while (true) {
+      bool left_valid  = left_->valid();
+      bool right_valid = right_->valid();
+      if (!left_valid && !right_valid) {
+        current_ = nullptr;
+        return;
+      }
+
+      if (left_valid && right_valid) {
+        int cmp = comparator_.compare(left_->key(), right_->key());
+        if (cmp == 0) {
+          // shadowed by the transaction's change
+          right_->next();
+          continue;
+        }
+        current_ = cmp < 0 ? left_.get() : right_.get();
+      } else {
+        current_ = left_valid ? left_.get() : right_.get();
+      }
+
+      if (current_ == left_.get() && left_->value().empty()) {
+        left_->next();
+        continue;
+      }
+      return;
+    }
+  }
+
+private:
+  ObDefaultComparator       comparator_;
   unique_ptr<ObLsmIterator> left_;
   unique_ptr<ObLsmIterator> right_;
+  ObLsmIterator            *current_ = nullptr;
 };
 
-ObLsmTransaction::ObLsmTransaction(ObLsm *db, uint64_t ts) : db_(db), ts_(ts)
+ObLsmTransaction::ObLsmTransaction(ObLsm *db, uint64_t ts) : db_(db), ts_(ts) {}
+
+RC ObLsmTransaction::get(const string_view &key, string *value)
 {
-  (void)db_;
-  (void)ts_;
+  auto iter = inner_store_.find(string(key));
+  if (iter != inner_store_.end()) {
+    if (iter->second.empty()) {
+      return RC::NOT_EXIST;
+    }
+    value->assign(iter->second);
+    return RC::SUCCESS;
+  }
+
+  ObLsmReadOptions options;
+  options.seq = ts_;
+  unique_ptr<ObLsmIterator> db_iter(db_->new_iterator(options));
+  db_iter->seek(key);
+  if (!db_iter->valid() || db_iter->key() != key) {
+    return RC::NOT_EXIST;
+  }
+  value->assign(db_iter->value());
+  return RC::SUCCESS;
 }
 
-RC ObLsmTransaction::get(const string_view &key, string *value) { return RC::UNIMPLEMENTED; }
+RC ObLsmTransaction::put(const string_view &key, const string_view &value)
+{
+  inner_store_[string(key)] = string(value);
+  return RC::SUCCESS;
+}
 
-RC ObLsmTransaction::put(const string_view &key, const string_view &value) { return RC::UNIMPLEMENTED; }
+RC ObLsmTransaction::remove(const string_view &key)
+{
+  inner_store_[string(key)] = "";
+  return RC::SUCCESS;
+}
 
-RC ObLsmTransaction::remove(const string_view &key) { return RC::UNIMPLEMENTED; }
+ObLsmIterator *ObLsmTransaction::new_iterator(ObLsmReadOptions options)
+{
+  if (options.seq == -1) {
+    options.seq = ts_;
+  }
+  return new TrxIterator(new TrxInnerMapIterator(inner_store_), db_->new_iterator(options));
+}
 
-ObLsmIterator *ObLsmTransaction::new_iterator(ObLsmReadOptions options) { return nullptr; }
+RC ObLsmTransaction::commit()
+{
+  if (inner_store_.empty()) {
+    return RC::SUCCESS;
+  }
 
-RC ObLsmTransaction::commit() { return RC::UNIMPLEMENTED; }
+  vector<pair<string, string>> kvs(std::make_move_iterator(inner_store_.begin()), std::make_move_iterator(inner_store_.end()));
+  inner_store_.clear();
+  return db_->batch_put(kvs);
+}
 
-RC ObLsmTransaction::rollback() { return RC::UNIMPLEMENTED; }
+RC ObLsmTransaction::rollback()
+{
+  inner_store_.clear();
+  return RC::SUCCESS;
+}
 
 }  // namespace oceanbase
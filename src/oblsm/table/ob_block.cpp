@@ -11,31 +11,187 @@ See the Mulan PSL v2 for more details. */
 #include "oblsm/table/ob_block.h"
 #include "oblsm/util/ob_coding.h"
 #include "common/lang/memory.h"
+#include "common/log/log.h"
 
 namespace oceanbase {
 
 RC ObBlock::decode(const string &data)
 {
-  return RC::UNIMPLEMENTED;
+  static const uint32_t TRAILER_SIZE = 2 * sizeof(uint32_t);
+  if (data.size() < TRAILER_SIZE) {
+    LOG_WARN("block is too small to decode. size=%lu", data.size());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  data_                     = data;
+  num_restarts_             = get_numeric<uint32_t>(data_.data() + data_.size() - TRAILER_SIZE);
+  num_entries_              = get_numeric<uint32_t>(data_.data() + data_.size() - sizeof(uint32_t));
+  const size_t max_restarts = (data_.size() - TRAILER_SIZE) / sizeof(uint32_t);
+  if (num_restarts_ == 0 || num_restarts_ > max_restarts) {
+    LOG_WARN("bad restart count in block. num_restarts=%u, size=%lu", num_restarts_, data_.size());
+    return RC::INVALID_ARGUMENT;
+  }
+  restarts_offset_ = data_.size() - TRAILER_SIZE - num_restarts_ * sizeof(uint32_t);
+  return RC::SUCCESS;
+}
+
+uint32_t ObBlock::restart_point(uint32_t index) const
+{
+  return get_numeric<uint32_t>(data_.data() + restarts_offset_ + index * sizeof(uint32_t));
+}
+
+ObLsmIterator *ObBlock::new_iterator() const { return new BlockIterator(comparator_, this); }
+
+// Helper routine: decode the next block entry starting at "p",
+// storing the number of shared key bytes, non_shared key bytes,
+// and the length of the value in "*shared", "*non_shared", and
+// "*value_length", respectively.  Will not dereference past "limit".
+//
+// If any errors are detected, returns nullptr.  Otherwise, returns a
+// pointer to the key delta (just past the three decoded values).
+static inline const char *decode_entry(
+    const char *p, const char *limit, uint32_t *shared, uint32_t *non_shared, uint32_t *value_length)
+{
+  if ((p = get_varint32(p, limit, shared)) == nullptr) {
+    return nullptr;
+  }
+  if ((p = get_varint32(p, limit, non_shared)) == nullptr) {
+    return nullptr;
+  }
+  if ((p = get_varint32(p, limit, value_length)) == nullptr) {
+    return nullptr;
+  }
+
+  if (static_cast<uint32_t>(limit - p) < (*non_shared + *value_length)) {
+    return nullptr;
+  }
+  return p;
+}
+
+uint32_t BlockIterator::next_entry_offset() const
+{
+  return static_cast<uint32_t>((value_.data() + value_.size()) - data_->data_.data());
+}
+
+void BlockIterator::seek_to_restart_point(uint32_t index)
+{
+  key_.clear();
+  restart_index_ = index;
+  // current_ will be fixed by parse_next_entry();
+
+  // parse_next_entry() starts at the end of value_, so set value_ accordingly
+  uint32_t offset = data_->restart_point(index);
+  value_          = string_view(data_->data_.data() + offset, 0);
+}
+
+void BlockIterator::seek_to_first()
+{
+  if (num_restarts_ == 0) {
+    current_ = restarts_;
+    return;
+  }
+  seek_to_restart_point(0);
+  parse_next_entry();
+}
+
+void BlockIterator::seek_to_last()
+{
+  if (num_restarts_ == 0) {
+    current_ = restarts_;
+    return;
+  }
+  seek_to_restart_point(num_restarts_ - 1);
+  while (parse_next_entry() && next_entry_offset() < restarts_) {
+    // Keep skipping
+  }
 }
 
-string_view ObBlock::get_entry(uint32_t offset) const
+void BlockIterator::seek(const string_view &lookup_key)
 {
-  uint32_t    curr_begin = offsets_[offset];
-  uint32_t    curr_end   = offset == offsets_.size() - 1 ? data_.size() : offsets_[offset + 1];
-  string_view curr       = string_view(data_.data() + curr_begin, curr_end - curr_begin);
-  return curr;
+  if (num_restarts_ == 0) {
+    current_ = restarts_;
+    return;
+  }
+
+  const string_view target = extract_user_key_from_lookup_key(lookup_key);
+
+  // Binary search in restart array to find the last restart point
+  // with a key < target
+  uint32_t left  = 0;
+  uint32_t right = num_restarts_ - 1;
+  while (left < right) {
+    uint32_t    mid           = (left + right + 1) / 2;
+    uint32_t    region_offset = data_->restart_point(mid);
+    uint32_t    shared, non_shared, value_length;
+    const char *key_ptr = decode_entry(data_->data_.data() + region_offset,
+        data_->data_.data() + restarts_,
+        &shared,
+        &non_shared,
+        &value_length);
+    if (key_ptr == nullptr || (shared != 0)) {
+      corruption();
+      return;
+    }
+    string_view mid_key(key_ptr, non_shared);
+    if (comparator_->compare(extract_user_key(mid_key), target) < 0) {
+      // Key at "mid" is smaller than "target".  Therefore all
+      // blocks before "mid" are uninteresting.
+      left = mid;
+    } else {
+      // Key at "mid" is >= "target".  Therefore all blocks at or
+      // after "mid" are uninteresting.
+      right = mid - 1;
+    }
+  }
+
+  // Linear search (within restart block) for first key >= target
+  seek_to_restart_point(left);
+  while (true) {
+    if (!parse_next_entry()) {
+      return;
+    }
+    if (comparator_->compare(extract_user_key(key_), target) >= 0) {
+      return;
+    }
+  }
 }
 
-ObLsmIterator *ObBlock::new_iterator() const { return new BlockIterator(comparator_, this, size()); }
+bool BlockIterator::parse_next_entry()
+{
+  current_          = next_entry_offset();
+  const char *p     = data_->data_.data() + current_;
+  const char *limit = data_->data_.data() + restarts_;  // Restarts come right after data
+  if (p >= limit) {
+    // No more entries to return.  Mark as invalid.
+    current_       = restarts_;
+    restart_index_ = num_restarts_;
+    return false;
+  }
 
-void BlockIterator::parse_entry()
+  // Decode next entry
+  uint32_t shared, non_shared, value_length;
+  p = decode_entry(p, limit, &shared, &non_shared, &value_length);
+  if (p == nullptr || key_.size() < shared) {
+    corruption();
+    return false;
+  } else {
+    key_.resize(shared);
+    key_.append(p, non_shared);
+    value_ = string_view(p + non_shared, value_length);
+    while (restart_index_ + 1 < num_restarts_ && data_->restart_point(restart_index_ + 1) < current_) {
+      ++restart_index_;
+    }
+    return true;
+  }
+}
+
+void BlockIterator::corruption()
 {
-  curr_entry_         = data_->get_entry(index_);
-  uint32_t key_size   = get_numeric<uint32_t>(curr_entry_.data());
-  key_                = string_view(curr_entry_.data() + sizeof(uint32_t), key_size);
-  uint32_t value_size = get_numeric<uint32_t>(curr_entry_.data() + sizeof(uint32_t) + key_size);
-  value_              = string_view(curr_entry_.data() + 2 * sizeof(uint32_t) + key_size, value_size);
+  LOG_WARN("corrupted block entry. offset=%u", current_);
+  current_       = restarts_;
+  restart_index_ = num_restarts_;
+  key_.clear();
+  value_ = string_view();
 }
 
 string BlockMeta::encode() const
@@ -47,6 +203,7 @@ string BlockMeta::encode() const
   ret.append(last_key_);
   put_numeric<uint32_t>(&ret, offset_);
   put_numeric<uint32_t>(&ret, size_);
+  put_numeric<uint8_t>(&ret, static_cast<uint8_t>(compression_));
   return ret;
 }
 
@@ -65,18 +222,8 @@ RC BlockMeta::decode(const string &data)
   offset_ = get_numeric<uint32_t>(data_ptr);
   data_ptr += sizeof(uint32_t);
   size_ = get_numeric<uint32_t>(data_ptr);
+  data_ptr += sizeof(uint32_t);
+  compression_ = static_cast<CompressionType>(get_numeric<uint8_t>(data_ptr));
   return rc;
 }
-
-void BlockIterator::seek(const string_view &lookup_key)
-{
-   index_ = 0;
-   while(valid()) {
-    parse_entry();
-    if (comparator_->compare(extract_user_key(key_), extract_user_key_from_lookup_key(lookup_key)) >= 0) {
-      break;
-    }
-    index_++;
-   }
-}
 }  // namespace oceanbase
@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/string.h"
 #include "common/lang/vector.h"
 #include "oblsm/include/ob_lsm_iterator.h"
+#include "oblsm/ob_lsm_define.h"
 #include "oblsm/util/ob_comparator.h"
 
 namespace oceanbase {
@@ -25,26 +26,28 @@ namespace oceanbase {
 //      ├─────────────────┤    │
 //      │      ..         │    │
 //      ├─────────────────┤    │
-//      │    entry n      │◄─┐ │
-//      ├─────────────────┤  │ │
-// ┌───►│  offset size(n) │  │ │
-// │    ├─────────────────┤  │ │
-// │    │    offset 1     ├──┼─┘
-// │    ├─────────────────┤  │
-// │    │      ..         │  │
-// │    ├─────────────────┤  │
-// │    │    offset n     ├──┘
-// │    ├─────────────────┤
-// └────┤  offset start   │
+//      │    entry n      │    │
+//      ├─────────────────┤    │
+//      │   restart 1     ├────┘
+//      ├─────────────────┤
+//      │      ..         │
+//      ├─────────────────┤
+//      │   restart m     │
+//      ├─────────────────┤
+//      │ restart count(m)│
+//      ├─────────────────┤
+//      │ entry count(n)  │
 //      └─────────────────┘
+// entry: | shared(varint32) | non_shared(varint32) | value_size(varint32) | key_delta | value |
+// The key of an entry shares `shared` bytes with the key of the previous entry, and only the
+// remaining `key_delta` is stored. The key of a restart point is stored in full (shared == 0).
 /**
  * @class ObBlock
  * @brief Represents a data block in the LSM-Tree.
  *
- * The `ObBlock` class manages a block of serialized key-value pairs, along with
- * their offsets, for efficient storage and retrieval. It provides methods to decode
- * serialized data, access individual entries, and create iterators for traversing
- * the block contents.
+ * The `ObBlock` class manages a block of serialized key-value pairs with prefix compressed keys,
+ * along with the offsets of restart points for efficient retrieval. It provides methods to decode
+ * serialized data and create iterators for traversing the block contents.
  */
 class ObBlock
 {
@@ -52,19 +55,15 @@ class ObBlock
 public:
   ObBlock(const ObComparator *comparator) : comparator_(comparator) {}
 
-  void add_offset(uint32_t offset) { offsets_.push_back(offset); }
-
-  uint32_t get_offset(int index) const { return offsets_[index]; }
-
-  string_view get_entry(uint32_t offset) const;
-
-  int size() const { return offsets_.size(); }
+  /**
+   * @brief The number of entries in the block.
+   */
+  int size() const { return num_entries_; }
 
   /**
    * @brief Decodes serialized block data.
    *
-   * This function parses and decodes the serialized string data to reconstruct
-   * the block's structure, including all key-value offsets and entries.
+   * This function parses the trailer of the serialized data to locate the restart points.
    * The decoded data format can reference ObBlockBuilder.
    * @param data The serialized block data as a string.
    * @return RC The result code indicating the success or failure of the decode operation.
@@ -74,8 +73,15 @@ public:
   ObLsmIterator *new_iterator() const;
 
 private:
-  string           data_;
-  vector<uint32_t> offsets_;
+  friend class BlockIterator;
+
+  uint32_t restart_point(uint32_t index) const;
+
+  string data_;
+  // Offset of restart array, that is also the end of entries
+  uint32_t restarts_offset_ = 0;
+  uint32_t num_restarts_    = 0;
+  uint32_t num_entries_     = 0;
   // TODO: remove
   const ObComparator *comparator_;
 };
@@ -83,56 +89,63 @@ private:
 class BlockIterator : public ObLsmIterator
 {
 public:
-  BlockIterator(const ObComparator *comparator, const ObBlock *data, uint32_t count)
-      : comparator_(comparator), data_(data), count_(count)
+  BlockIterator(const ObComparator *comparator, const ObBlock *data)
+      : comparator_(comparator),
+        data_(data),
+        restarts_(data->restarts_offset_),
+        num_restarts_(data->num_restarts_),
+        current_(restarts_),
+        restart_index_(num_restarts_)
   {}
   BlockIterator(const BlockIterator &)            = delete;
   BlockIterator &operator=(const BlockIterator &) = delete;
 
   ~BlockIterator() override = default;
 
+  /**
+   * @brief Seeks to the first entry whose user key is not less than the user key of `lookup_key`.
+   * @details Binary search in the restart array to find the last restart point with a key
+   * smaller than the target, and then scan linearly from the restart point.
+   */
   void seek(const string_view &lookup_key) override;
-  void seek_to_first() override
-  {
-    index_ = 0;
-    parse_entry();
-  }
-  void seek_to_last() override
-  {
-    index_ = count_ - 1;
-    parse_entry();
-  }
-
-  bool valid() const override { return index_ < count_; }
-  void next() override
-  {
-    index_++;
-    if (valid()) {
-      parse_entry();
-    }
-  }
+  void seek_to_first() override;
+  void seek_to_last() override;
+
+  bool        valid() const override { return current_ < restarts_; }
+  void        next() override { parse_next_entry(); }
   string_view key() const override { return key_; };
   string_view value() const override { return value_; }
 
 private:
-  void parse_entry();
+  // Return the offset in data_ just past the end of the current entry.
+  uint32_t next_entry_offset() const;
+
+  void seek_to_restart_point(uint32_t index);
+
+  bool parse_next_entry();
+
+  void corruption();
 
 private:
   const ObComparator  *comparator_;
   const ObBlock *const data_;
-  string_view          curr_entry_;
-  string_view          key_;
-  string_view          value_;
-  uint32_t             count_ = 0;
-  uint32_t             index_ = 0;
+  uint32_t const       restarts_;      // Offset of restart array
+  uint32_t const       num_restarts_;  // Number of uint32_t entries in restart array
+
+  // current_ is offset in data_ of current entry.  >= restarts_ if !valid
+  uint32_t    current_;
+  uint32_t    restart_index_;  // Index of restart block in which current_ falls
+  string      key_;
+  string_view value_;
 };
 
 class BlockMeta
 {
 public:
   BlockMeta() {}
-  BlockMeta(const string &first_key, const string &last_key, uint32_t offset, uint32_t size)
-      : first_key_(first_key), last_key_(last_key), offset_(offset), size_(size)
+  BlockMeta(const string &first_key, const string &last_key, uint32_t offset, uint32_t size,
+      CompressionType compression = CompressionType::NONE)
+      : first_key_(first_key), last_key_(last_key), offset_(offset), size_(size), compression_(compression)
   {}
   string encode() const;
   RC     decode(const string &data);
@@ -142,6 +155,9 @@ public:
 
   // Offset of ObBlock in SSTable
   uint32_t offset_;
+  // Size of the block on disk, i.e. the compressed size if the block is compressed
   uint32_t size_;
+  // Codec used to compress the block
+  CompressionType compression_ = CompressionType::NONE;
 };
 }  // namespace oceanbase
@@ -10,53 +10,83 @@ See the Mulan PSL v2 for more details. */
 
 #include "oblsm/table/ob_block_builder.h"
 #include "oblsm/util/ob_coding.h"
+#include "common/lang/algorithm.h"
 #include "common/log/log.h"
 
 namespace oceanbase {
 
+ObBlockBuilder::ObBlockBuilder(const ObLsmOptions &options)
+    : block_size_(options.block_size), restart_interval_(options.block_restart_interval)
+{
+  ASSERT(restart_interval_ >= 1, "block restart interval must be positive");
+  restarts_.push_back(0);  // First restart point is at offset 0
+}
+
 void ObBlockBuilder::reset()
 {
-  offsets_.clear();
+  restarts_.clear();
+  restarts_.push_back(0);
+  counter_     = 0;
+  num_entries_ = 0;
   data_.clear();
-  // first_key_.clear();
+  last_key_.clear();
 }
 
 RC ObBlockBuilder::add(const string_view &key, const string_view &value)
 {
-  RC rc = RC::SUCCESS;
-  if (appro_size() + key.size() + value.size() + 2 * sizeof(uint32_t) > BLOCK_SIZE) {
+  RC     rc     = RC::SUCCESS;
+  size_t shared = 0;
+  if (counter_ < restart_interval_) {
+    // See how much sharing to do with previous string
+    const size_t min_length = std::min(last_key_.size(), key.size());
+    while ((shared < min_length) && (last_key_[shared] == key[shared])) {
+      shared++;
+    }
+  }
+  const size_t non_shared = key.size() - shared;
+  // three varint32 use 15 bytes at most
+  const size_t entry_size   = 3 * 5 + non_shared + value.size();
+  const size_t restart_size = counter_ >= restart_interval_ ? sizeof(uint32_t) : 0;
+
+  if (appro_size() + entry_size + restart_size > block_size_) {
     // TODO: support large kv pair.
-    if (offsets_.empty()) {
+    if (empty()) {
       LOG_ERROR("block is empty, but kv pair is too large, key size: %lu, value size: %lu", key.size(), value.size());
       return RC::UNIMPLEMENTED;
     }
     LOG_TRACE("block is full, can't add more kv pair");
     rc = RC::FULL;
   } else {
-    offsets_.push_back(data_.size());
-    put_numeric<uint32_t>(&data_, key.size());
-    data_.append(key.data(), key.size());
-    put_numeric<uint32_t>(&data_, value.size());
+    if (counter_ >= restart_interval_) {
+      // Restart compression
+      restarts_.push_back(data_.size());
+      counter_ = 0;
+    }
+
+    // Add "<shared><non_shared><value_size>" to buffer
+    put_varint32(&data_, shared);
+    put_varint32(&data_, non_shared);
+    put_varint32(&data_, value.size());
+
+    // Add string delta to buffer followed by value
+    data_.append(key.data() + shared, non_shared);
     data_.append(value.data(), value.size());
+
+    last_key_.resize(shared);
+    last_key_.append(key.data() + shared, non_shared);
+    counter_++;
+    num_entries_++;
   }
   return rc;
 }
 
-string ObBlockBuilder::last_key() const
-{
-  string_view last_kv(data_.data() + offsets_.back(), data_.size() - offsets_.back());
-  uint32_t    key_length = get_numeric<uint32_t>(last_kv.data());
-  return string(last_kv.data() + sizeof(uint32_t), key_length);
-}
-
 string_view ObBlockBuilder::finish()
 {
-  uint32_t data_size = data_.size();
-  put_numeric<uint32_t>(&data_, offsets_.size());
-  for (size_t i = 0; i < offsets_.size(); i++) {
-    put_numeric<uint32_t>(&data_, offsets_[i]);
+  for (size_t i = 0; i < restarts_.size(); i++) {
+    put_numeric<uint32_t>(&data_, restarts_[i]);
   }
-  put_numeric<uint32_t>(&data_, data_size);
+  put_numeric<uint32_t>(&data_, restarts_.size());
+  put_numeric<uint32_t>(&data_, num_entries_);
   return string_view(data_.data(), data_.size());
 }
 
@@ -14,36 +14,48 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/string_view.h"
 #include "common/lang/vector.h"
 #include "common/sys/rc.h"
+#include "oblsm/include/ob_lsm_options.h"
 
 namespace oceanbase {
 
 /**
  * @brief Build a ObBlock in SSTable
+ * @details Keys are prefix compressed: every entry only stores the suffix that differs from the
+ * previous key. Every `block_restart_interval` entries the key is stored in full, this entry is
+ * called a restart point, and the offsets of all restart points are stored at the end of block
+ * so a reader can binary search them. See ObBlock for the block format.
  */
 class ObBlockBuilder
 {
 
 public:
+  explicit ObBlockBuilder(const ObLsmOptions &options = ObLsmOptions());
+
   RC add(const string_view &key, const string_view &value);
 
   string_view finish();
 
   void reset();
 
-  string last_key() const;
+  string last_key() const { return last_key_; }
+
+  bool empty() const { return num_entries_ == 0; }
 
-  uint32_t appro_size() { return data_.size() + offsets_.size() * sizeof(uint32_t); }
+  uint32_t appro_size() { return data_.size() + restarts_.size() * sizeof(uint32_t) + 2 * sizeof(uint32_t); }
 
 private:
-  static const uint32_t BLOCK_SIZE = 4 * 1024;  // 4KB
-  // Offsets of key-value pairs.
-  vector<uint32_t> offsets_;
+  uint32_t block_size_;
+  uint32_t restart_interval_;
+  // Offsets of restart points.
+  vector<uint32_t> restarts_;
+  // Number of entries emitted since the last restart point.
+  uint32_t counter_     = 0;
+  uint32_t num_entries_ = 0;
   // key-value pairs
   // TODO: use block as data container
   // TODO: add checksum
   string data_;
-
-  // string first_key_;
+  string last_key_;
 };
 
 }  // namespace oceanbase
@@ -10,25 +10,104 @@ See the Mulan PSL v2 for more details. */
 
 #include "oblsm/table/ob_sstable.h"
 #include "oblsm/util/ob_coding.h"
+#include "oblsm/util/ob_compression.h"
 #include "common/log/log.h"
 #include "common/lang/filesystem.h"
 namespace oceanbase {
 
 void ObSSTable::init()
 {
-  // your code here
+  file_reader_ = ObFileReader::create_file_reader(file_name_);
+  if (file_reader_ == nullptr) {
+    LOG_WARN("failed to open sstable. file=%s", file_name_.c_str());
+    return;
+  }
+
+  uint32_t file_size = file_reader_->file_size();
+  if (file_size < 2 * sizeof(uint32_t)) {
+    LOG_WARN("sstable is too small. file=%s, size=%u", file_name_.c_str(), file_size);
+    return;
+  }
+
+  string meta_offset_buf = file_reader_->read_pos(file_size - sizeof(uint32_t), sizeof(uint32_t));
+  if (meta_offset_buf.size() != sizeof(uint32_t)) {
+    LOG_WARN("failed to read sstable meta offset. file=%s", file_name_.c_str());
+    return;
+  }
+  uint32_t meta_offset = get_numeric<uint32_t>(meta_offset_buf.data());
+  if (meta_offset + 2 * sizeof(uint32_t) > file_size) {
+    LOG_WARN("invalid sstable meta offset. file=%s, offset=%u, size=%u", file_name_.c_str(), meta_offset, file_size);
+    return;
+  }
+
+  string      metas = file_reader_->read_pos(meta_offset, file_size - sizeof(uint32_t) - meta_offset);
+  const char *p     = metas.data();
+  const char *limit = metas.data() + metas.size();
+  uint32_t    count = get_numeric<uint32_t>(p);
+  p += sizeof(uint32_t);
+  block_metas_.reserve(count);
+  for (uint32_t i = 0; i < count; i++) {
+    if (p + sizeof(uint32_t) > limit) {
+      LOG_WARN("corrupted sstable meta. file=%s", file_name_.c_str());
+      block_metas_.clear();
+      return;
+    }
+    uint32_t meta_size = get_numeric<uint32_t>(p);
+    p += sizeof(uint32_t);
+    if (p + meta_size > limit) {
+      LOG_WARN("corrupted sstable meta. file=%s", file_name_.c_str());
+      block_metas_.clear();
+      return;
+    }
+    BlockMeta meta;
+    meta.decode(string(p, meta_size));
+    block_metas_.emplace_back(std::move(meta));
+    p += meta_size;
+  }
 }
 
 shared_ptr<ObBlock> ObSSTable::read_block_with_cache(uint32_t block_idx) const
 {
-  // your code here
-  return nullptr;
+  if (block_cache_ == nullptr) {
+    return read_block(block_idx);
+  }
+
+  uint64_t            cache_key = (static_cast<uint64_t>(sst_id_) << 32) | block_idx;
+  shared_ptr<ObBlock> block;
+  if (block_cache_->get(cache_key, block)) {
+    return block;
+  }
+  block = read_block(block_idx);
+  if (block != nullptr) {
+    block_cache_->put(cache_key, block);
+  }
+  return block;
 }
 
 shared_ptr<ObBlock> ObSSTable::read_block(uint32_t block_idx) const
 {
-  // your code here
-  return nullptr;
+  if (file_reader_ == nullptr || block_idx >= block_metas_.size()) {
+    return nullptr;
+  }
+
+  const BlockMeta &meta = block_metas_[block_idx];
+  string           data = file_reader_->read_pos(meta.offset_, meta.size_);
+  RC               rc   = RC::SUCCESS;
+  if (meta.compression_ != CompressionType::NONE) {
+    string raw;
+    if (OB_FAIL(rc = ob_uncompress(meta.compression_, data, &raw))) {
+      LOG_WARN("failed to uncompress block. file=%s, block=%u, rc=%s", file_name_.c_str(), block_idx, strrc(rc));
+      return nullptr;
+    }
+    data.swap(raw);
+  }
+
+  shared_ptr<ObBlock> block = make_shared<ObBlock>(comparator_);
+  if (OB_FAIL(rc = block->decode(data))) {
+    LOG_WARN("failed to decode block. file=%s, block=%u, rc=%s", file_name_.c_str(), block_idx, strrc(rc));
+    return nullptr;
+  }
+  return block;
 }
 
 void ObSSTable::remove() { filesystem::remove(file_name_); }
@@ -38,21 +117,37 @@ ObLsmIterator *ObSSTable::new_iterator() { return new TableIterator(get_shared_p
 void TableIterator::read_block_with_cache()
 {
   block_ = sst_->read_block_with_cache(curr_block_idx_);
+  if (block_ == nullptr) {
+    block_iterator_ = nullptr;
+    return;
+  }
   block_iterator_.reset(block_->new_iterator());
 }
 
 void TableIterator::seek_to_first()
 {
+  if (block_cnt_ == 0) {
+    block_iterator_ = nullptr;
+    return;
+  }
   curr_block_idx_ = 0;
   read_block_with_cache();
-  block_iterator_->seek_to_first();
+  if (block_iterator_ != nullptr) {
+    block_iterator_->seek_to_first();
+  }
 }
 
 void TableIterator::seek_to_last()
 {
+  if (block_cnt_ == 0) {
+    block_iterator_ = nullptr;
+    return;
+  }
   curr_block_idx_ = block_cnt_ - 1;
   read_block_with_cache();
-  block_iterator_->seek_to_last();
+  if (block_iterator_ != nullptr) {
+    block_iterator_->seek_to_last();
+  }
 }
 
 void TableIterator::next()
@@ -62,26 +157,36 @@ void TableIterator::next()
   } else if (curr_block_idx_ < block_cnt_ - 1) {
     curr_block_idx_++;
     read_block_with_cache();
-    block_iterator_->seek_to_first();
+    if (block_iterator_ != nullptr) {
+      block_iterator_->seek_to_first();
+    }
   }
 }
 
 void TableIterator::seek(const string_view &lookup_key)
 {
-  curr_block_idx_ = 0;
-  // TODO: use binary search
-  for (; curr_block_idx_ < block_cnt_; curr_block_idx_++) {
-    const auto &block_meta = sst_->block_meta(curr_block_idx_);
-    if (sst_->comparator()->compare(extract_user_key(block_meta.last_key_), extract_user_key_from_lookup_key(lookup_key)) >= 0) {
-      break;
+  // binary search the first block whose last user key is not less than the target user key
+  string_view user_key = extract_user_key_from_lookup_key(lookup_key);
+  uint32_t    left     = 0;
+  uint32_t    right    = block_cnt_;
+  while (left < right) {
+    uint32_t    mid        = left + (right - left) / 2;
+    const auto &block_meta = sst_->block_meta(mid);
+    if (sst_->comparator()->compare(extract_user_key(block_meta.last_key_), user_key) < 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
     }
   }
+  curr_block_idx_ = left;
   if (curr_block_idx_ == block_cnt_) {
     block_iterator_ = nullptr;
     return;
   }
   read_block_with_cache();
-  block_iterator_->seek(lookup_key);
+  if (block_iterator_ != nullptr) {
+    block_iterator_->seek(lookup_key);
+  }
 };
 
 }  // namespace oceanbase
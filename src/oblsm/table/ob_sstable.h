@@ -72,9 +72,7 @@ public:
         comparator_(comparator),
         file_reader_(nullptr),
         block_cache_(block_cache)
-  {
-    (void)block_cache_;
-  }
+  {}
 
   ~ObSSTable() = default;
 
@@ -99,6 +97,7 @@ public:
    *
    * Attempts to read the specified block using the block cache. If the block is not
    * in the cache, it will load the block from the SSTable file and update the cache.
+   * The cache holds uncompressed blocks, so a compressed block is uncompressed only once.
    *
    * @param block_idx The index of the block to read.
    *
@@ -110,7 +109,7 @@ public:
    * @brief Reads a block directly from the SSTable file.
    *
    * This function bypasses the block cache and directly reads the requested block
-   * from the SSTable file.
+   * from the SSTable file, uncompressing it if needed.
    *
    * @param block_idx The index of the block to read.
    *
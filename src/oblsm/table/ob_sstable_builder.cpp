@@ -10,24 +10,95 @@ See the Mulan PSL v2 for more details. */
 
 #include "oblsm/table/ob_sstable_builder.h"
 #include "oblsm/util/ob_coding.h"
+#include "common/log/log.h"
+#include "oblsm/util/ob_compression.h"
 
 namespace oceanbase {
 
 // TODO: refactor build with mem_table/iterator logic.
 RC ObSSTableBuilder::build(shared_ptr<ObMemTable> mem_table, const std::string &file_name, uint32_t sst_id)
 {
-  return RC::UNIMPLEMENTED;
+  RC rc   = RC::SUCCESS;
+  sst_id_ = sst_id;
+  file_writer_ = ObFileWriter::create_file_writer(file_name, false);
+  if (file_writer_ == nullptr) {
+    LOG_WARN("failed to create sstable file. file=%s", file_name.c_str());
+    return RC::IOERR_OPEN;
+  }
+
+  unique_ptr<ObLsmIterator> iter(mem_table->new_iterator());
+  for (iter->seek_to_first(); iter->valid(); iter->next()) {
+    string_view key = iter->key();
+    string_view val = iter->value();
+    if (block_builder_.empty()) {
+      curr_blk_first_key_.assign(key.data(), key.size());
+    }
+    rc = block_builder_.add(key, val);
+    if (rc == RC::FULL) {
+      if (OB_FAIL(rc = finish_build_block())) {
+        return rc;
+      }
+      curr_blk_first_key_.assign(key.data(), key.size());
+      rc = block_builder_.add(key, val);
+    }
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to add kv pair into block. key size=%lu, value size=%lu, rc=%s",
+          key.size(), val.size(), strrc(rc));
+      return rc;
+    }
+  }
+  if (!block_builder_.empty() && OB_FAIL(rc = finish_build_block())) {
+    return rc;
+  }
+
+  // meta section: | meta count | meta 1 size | meta 1 | ... | meta n size | meta n | meta section offset |
+  string meta_section;
+  put_numeric<uint32_t>(&meta_section, block_metas_.size());
+  for (const BlockMeta &meta : block_metas_) {
+    string encoded = meta.encode();
+    put_numeric<uint32_t>(&meta_section, encoded.size());
+    meta_section.append(encoded);
+  }
+  put_numeric<uint32_t>(&meta_section, curr_offset_);
+  if (OB_FAIL(rc = file_writer_->write(meta_section))) {
+    LOG_WARN("failed to write sstable meta. file=%s, rc=%s", file_name.c_str(), strrc(rc));
+    return rc;
+  }
+  if (OB_FAIL(rc = file_writer_->flush())) {
+    LOG_WARN("failed to flush sstable. file=%s, rc=%s", file_name.c_str(), strrc(rc));
+    return rc;
+  }
+  file_size_ = curr_offset_ + meta_section.size();
+  return rc;
 }
 
-void ObSSTableBuilder::finish_build_block()
+RC ObSSTableBuilder::finish_build_block()
 {
-  string      last_key       = block_builder_.last_key();
-  string_view block_contents = block_builder_.finish();
-  file_writer_->write(block_contents);
-  block_metas_.push_back(BlockMeta(curr_blk_first_key_, last_key, curr_offset_, block_contents.size()));
+  string          last_key       = block_builder_.last_key();
+  string_view     block_contents = block_builder_.finish();
+  CompressionType compression    = CompressionType::NONE;
+  RC              rc             = RC::SUCCESS;
+  if (compression_ != CompressionType::NONE) {
+    if (OB_FAIL(rc = ob_compress(compression_, compression_level_, block_contents, &compressed_))) {
+      LOG_WARN("failed to compress block. rc=%s", strrc(rc));
+      return rc;
+    }
+    // store the raw block if compression does not save enough space
+    if (compressed_.size() < block_contents.size() - block_contents.size() / 8) {
+      block_contents = compressed_;
+      compression    = compression_;
+    }
+  }
+  rc = file_writer_->write(block_contents);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to write block. file=%s, rc=%s", file_writer_->file_name().c_str(), strrc(rc));
+    return rc;
+  }
+  block_metas_.push_back(BlockMeta(curr_blk_first_key_, last_key, curr_offset_, block_contents.size(), compression));
   // TODO: block aligned to BLOCK_SIZE
   curr_offset_ += block_contents.size();
   block_builder_.reset();
+  return rc;
 }
 
 shared_ptr<ObSSTable> ObSSTableBuilder::get_built_table()
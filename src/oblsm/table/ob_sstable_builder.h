@@ -27,8 +27,13 @@ namespace oceanbase {
 class ObSSTableBuilder
 {
 public:
-  ObSSTableBuilder(const ObComparator *comparator, ObLRUCache<uint64_t, shared_ptr<ObBlock>> *block_cache)
-      : comparator_(comparator), block_cache_(block_cache)
+  ObSSTableBuilder(const ObComparator *comparator, ObLRUCache<uint64_t, shared_ptr<ObBlock>> *block_cache,
+      const ObLsmOptions &options = ObLsmOptions())
+      : comparator_(comparator),
+        block_builder_(options),
+        compression_(options.compression),
+        compression_level_(options.compression_level),
+        block_cache_(block_cache)
   {}
   ~ObSSTableBuilder() = default;
 
@@ -51,10 +56,13 @@ public:
   void                  reset();
 
 private:
-  void finish_build_block();
+  RC finish_build_block();
 
   const ObComparator      *comparator_ = nullptr;
   ObBlockBuilder           block_builder_;
+  CompressionType          compression_       = CompressionType::NONE;
+  int                      compression_level_ = 1;
+  string                   compressed_;  // buffer of the compressed block
   string                   curr_blk_first_key_;
   unique_ptr<ObFileWriter> file_writer_;
   vector<BlockMeta>        block_metas_;
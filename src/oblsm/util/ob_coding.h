@@ -51,6 +51,51 @@ T get_numeric(const char *src)
   return value;
 }
 
+/**
+ * @brief Appends a 32-bit unsigned integer to a string in varint format.
+ *
+ * Every byte holds 7 bits of the value, the highest bit of a byte indicates
+ * whether more bytes follow. Small values (e.g. key lengths) take only one byte.
+ *
+ * @param dst A pointer to the string to which the value will be appended.
+ * @param v The value to append.
+ */
+inline void put_varint32(string *dst, uint32_t v)
+{
+  static const uint32_t B = 128;
+  while (v >= B) {
+    dst->push_back(static_cast<char>(v | B));
+    v >>= 7;
+  }
+  dst->push_back(static_cast<char>(v));
+}
+
+/**
+ * @brief Decodes a varint32 value written by `put_varint32`.
+ *
+ * @param p The start of the encoded value.
+ * @param limit The end of the readable data.
+ * @param value The decoded value.
+ * @return The position following the encoded value, or nullptr if the data is corrupted.
+ */
+inline const char *get_varint32(const char *p, const char *limit, uint32_t *value)
+{
+  uint32_t result = 0;
+  for (uint32_t shift = 0; shift <= 28 && p < limit; shift += 7) {
+    uint32_t byte = *(reinterpret_cast<const unsigned char *>(p));
+    p++;
+    if (byte & 128) {
+      // More bytes are present
+      result |= ((byte & 127) << shift);
+    } else {
+      result |= (byte << shift);
+      *value = result;
+      return p;
+    }
+  }
+  return nullptr;
+}
+
 /**
  * @brief Extracts the user key portion from an internal key.
  *
@@ -0,0 +1,207 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "oblsm/util/ob_compression.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/vector.h"
+#include "common/log/log.h"
+#include "oblsm/util/ob_coding.h"
+
+namespace oceanbase {
+
+static constexpr size_t   LZ_MIN_MATCH  = 4;
+static constexpr size_t   LZ_MAX_OFFSET = 65535;
+static constexpr uint32_t LZ_HASH_BITS  = 14;
+static constexpr int      LZ_MAX_LEVEL  = 9;
+
+static inline uint32_t lz_hash(const char *p) { return (get_numeric<uint32_t>(p) * 2654435761U) >> (32 - LZ_HASH_BITS); }
+
+static void lz_put_length(string *dst, size_t len)
+{
+  while (len >= 255) {
+    dst->push_back(static_cast<char>(255));
+    len -= 255;
+  }
+  dst->push_back(static_cast<char>(len));
+}
+
+static bool lz_get_length(const char *&p, const char *limit, size_t &len)
+{
+  uint8_t byte = 0;
+  do {
+    if (p >= limit) {
+      return false;
+    }
+    byte = static_cast<uint8_t>(*p++);
+    len += byte;
+  } while (byte == 255);
+  return true;
+}
+
+/**
+ * @brief Appends a sequence. `match_len` is 0 for the last sequence which has literals only.
+ */
+static void lz_put_sequence(string *dst, const char *literals, size_t literal_len, size_t offset, size_t match_len)
+{
+  size_t  match_code = match_len == 0 ? 0 : match_len - LZ_MIN_MATCH;
+  uint8_t token      = static_cast<uint8_t>((std::min<size_t>(literal_len, 15) << 4) | std::min<size_t>(match_code, 15));
+  dst->push_back(static_cast<char>(token));
+  if (literal_len >= 15) {
+    lz_put_length(dst, literal_len - 15);
+  }
+  dst->append(literals, literal_len);
+  if (match_len == 0) {
+    return;
+  }
+  dst->push_back(static_cast<char>(offset & 0xff));
+  dst->push_back(static_cast<char>(offset >> 8));
+  if (match_code >= 15) {
+    lz_put_length(dst, match_code - 15);
+  }
+}
+
+static RC lz_compress(int level, string_view input, string *output)
+{
+  const char  *base  = input.data();
+  const size_t n     = input.size();
+  const int    depth = 1 << (std::clamp(level, 1, LZ_MAX_LEVEL) - 1);
+
+  output->clear();
+  output->reserve(n / 2 + 16);
+  put_varint32(output, static_cast<uint32_t>(n));
+
+  // head holds the latest position of every hash bucket, chain links the previous position with
+  // the same hash. The chain is only needed when more than one candidate is searched.
+  vector<int32_t> head(1 << LZ_HASH_BITS, -1);
+  vector<int32_t> chain(depth > 1 ? n : 0, -1);
+  auto            insert = [&](size_t pos) {
+    uint32_t h = lz_hash(base + pos);
+    if (depth > 1) {
+      chain[pos] = head[h];
+    }
+    head[h] = static_cast<int32_t>(pos);
+  };
+
+  size_t anchor = 0;
+  size_t pos    = 0;
+  while (pos + LZ_MIN_MATCH <= n) {
+    size_t  best_len = 0;
+    size_t  best_off = 0;
+    int32_t cand     = head[lz_hash(base + pos)];
+    for (int i = 0; i < depth && cand >= 0 && pos - cand <= LZ_MAX_OFFSET; i++) {
+      size_t len = 0;
+      while (pos + len < n && base[cand + len] == base[pos + len]) {
+        len++;
+      }
+      if (len > best_len) {
+        best_len = len;
+        best_off = pos - cand;
+      }
+      cand = depth > 1 ? chain[cand] : -1;
+    }
+    insert(pos);
+
+    if (best_len < LZ_MIN_MATCH) {
+      pos++;
+      continue;
+    }
+
+    lz_put_sequence(output, base + anchor, pos - anchor, best_off, best_len);
+    for (size_t p = pos + 1; p < pos + best_len && p + LZ_MIN_MATCH <= n; p++) {
+      insert(p);
+    }
+    pos += best_len;
+    anchor = pos;
+  }
+  lz_put_sequence(output, base + anchor, n - anchor, 0, 0);
+  return RC::SUCCESS;
+}
+
+static RC lz_uncompress(string_view input, string *output)
+{
+  const char *p     = input.data();
+  const char *limit = input.data() + input.size();
+  uint32_t    raw_size;
+  p = get_varint32(p, limit, &raw_size);
+  if (p == nullptr) {
+    return RC::INVALID_ARGUMENT;
+  }
+
+  output->resize(raw_size);
+  char  *dst = output->data();
+  size_t out = 0;
+  while (p < limit) {
+    uint8_t token       = static_cast<uint8_t>(*p++);
+    size_t  literal_len = token >> 4;
+    if (literal_len == 15 && !lz_get_length(p, limit, literal_len)) {
+      return RC::INVALID_ARGUMENT;
+    }
+    if (literal_len > static_cast<size_t>(limit - p) || literal_len > raw_size - out) {
+      return RC::INVALID_ARGUMENT;
+    }
+    memcpy(dst + out, p, literal_len);
+    out += literal_len;
+    p += literal_len;
+    if (p == limit) {
+      break;
+    }
+
+    if (limit - p < 2) {
+      return RC::INVALID_ARGUMENT;
+    }
+    size_t offset = static_cast<uint8_t>(p[0]) | (static_cast<size_t>(static_cast<uint8_t>(p[1])) << 8);
+    p += 2;
+    size_t match_len = token & 0x0f;
+    if (match_len == 15 && !lz_get_length(p, limit, match_len)) {
+      return RC::INVALID_ARGUMENT;
+    }
+    match_len += LZ_MIN_MATCH;
+    if (offset == 0 || offset > out || match_len > raw_size - out) {
+      return RC::INVALID_ARGUMENT;
+    }
+    // the match may overlap with the bytes being produced, so copy byte by byte
+    const char *src = dst + out - offset;
+    for (size_t i = 0; i < match_len; i++) {
+      dst[out + i] = src[i];
+    }
+    out += match_len;
+  }
+
+  if (out != raw_size) {
+    return RC::INVALID_ARGUMENT;
+  }
+  return RC::SUCCESS;
+}
+
+RC ob_compress(CompressionType type, int level, string_view input, string *output)
+{
+  switch (type) {
+    case CompressionType::NONE: output->assign(input.data(), input.size()); return RC::SUCCESS;
+    case CompressionType::LZ: return lz_compress(level, input, output);
+    default: {
+      LOG_WARN("unsupported compression type: %d", static_cast<int>(type));
+      return RC::UNSUPPORTED;
+    }
+  }
+}
+
+RC ob_uncompress(CompressionType type, string_view input, string *output)
+{
+  switch (type) {
+    case CompressionType::NONE: output->assign(input.data(), input.size()); return RC::SUCCESS;
+    case CompressionType::LZ: return lz_uncompress(input, output);
+    default: {
+      LOG_WARN("unsupported compression type: %d", static_cast<int>(type));
+      return RC::UNSUPPORTED;
+    }
+  }
+}
+
+}  // namespace oceanbase
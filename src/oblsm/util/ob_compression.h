@@ -0,0 +1,47 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/string.h"
+#include "common/lang/string_view.h"
+#include "common/sys/rc.h"
+#include "oblsm/ob_lsm_define.h"
+
+namespace oceanbase {
+
+/**
+ * @brief Compresses `input` with the specified codec.
+ *
+ * `CompressionType::LZ` is a built-in byte oriented LZ77 codec in the spirit of LZ4. The output
+ * is the varint32 encoded uncompressed size followed by a list of sequences:
+ * | token | literal length ext | literals | match offset(2 bytes) | match length ext |
+ * The high 4 bits of the token hold the literal length and the low 4 bits hold the match length
+ * minus 4. A value of 15 means more length bytes follow (each 255 means keep reading). The last
+ * sequence has no match part.
+ *
+ * @param type The compression codec.
+ * @param level Compression level from 1(fastest) to 9(best compression). A higher level
+ * searches more candidate matches.
+ * @param input The data to compress.
+ * @param output The compressed data.
+ * @return RC::SUCCESS, or RC::UNSUPPORTED if the codec is unknown.
+ */
+RC ob_compress(CompressionType type, int level, string_view input, string *output);
+
+/**
+ * @brief Uncompresses data written by `ob_compress`.
+ *
+ * @return RC::SUCCESS, RC::UNSUPPORTED if the codec is unknown, or RC::INVALID_ARGUMENT if
+ * the data is corrupted.
+ */
+RC ob_uncompress(CompressionType type, string_view input, string *output);
+
+}  // namespace oceanbase
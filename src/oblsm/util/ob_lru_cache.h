@@ -13,6 +13,11 @@ See the Mulan PSL v2 for more details. */
 #include <stdint.h>
 #include <cstddef>
 
+#include "common/lang/list.h"
+#include "common/lang/mutex.h"
+#include "common/lang/unordered_map.h"
+#include "common/lang/utility.h"
+
 namespace oceanbase {
 
 /**
@@ -48,7 +53,17 @@ public:
    * @param value A reference to store the value associated with the key.
    * @return `true` if the key is found and the value is retrieved; `false` otherwise.
    */
-  bool get(const KeyType &key, ValueType &value) { return false; }
+  bool get(const KeyType &key, ValueType &value)
+  {
+    lock_guard<mutex> lock(mutex_);
+    auto              iter = index_.find(key);
+    if (iter == index_.end()) {
+      return false;
+    }
+    entries_.splice(entries_.begin(), entries_, iter->second);
+    value = iter->second->second;
+    return true;
+  }
 
   /**
    * @brief Inserts a key-value pair into the cache.
@@ -60,7 +75,25 @@ public:
    * @param key The key to insert into the cache.
    * @param value The value to associate with the specified key.
    */
-  void put(const KeyType &key, const ValueType &value) {}
+  void put(const KeyType &key, const ValueType &value)
+  {
+    if (capacity_ == 0) {
+      return;
+    }
+    lock_guard<mutex> lock(mutex_);
+    auto              iter = index_.find(key);
+    if (iter != index_.end()) {
+      iter->second->second = value;
+      entries_.splice(entries_.begin(), entries_, iter->second);
+      return;
+    }
+    entries_.emplace_front(key, value);
+    index_.emplace(key, entries_.begin());
+    if (entries_.size() > capacity_) {
+      index_.erase(entries_.back().first);
+      entries_.pop_back();
+    }
+  }
 
   /**
    * @brief Checks whether the specified key exists in the cache.
@@ -68,13 +101,28 @@ public:
    * @param key The key to check in the cache.
    * @return `true` if the key exists; `false` otherwise.
    */
-  bool contains(const KeyType &key) const { return false; }
+  bool contains(const KeyType &key) const
+  {
+    lock_guard<mutex> lock(mutex_);
+    return index_.find(key) != index_.end();
+  }
 
 private:
+  using Entry = pair<KeyType, ValueType>;
+
   /**
    * @brief The maximum number of elements the cache can hold.
    */
   size_t capacity_;
+
+  /**
+   * @brief Cache entries ordered from the most recently used to the least recently used.
+   */
+  list<Entry> entries_;
+
+  unordered_map<KeyType, typename list<Entry>::iterator> index_;
+
+  mutable mutex mutex_;
 };
 
 /**
@@ -91,7 +139,7 @@ private:
 template <typename Key, typename Value>
 ObLRUCache<Key, Value> *new_lru_cache(uint32_t capacity)
 {
-  return nullptr;
+  return new ObLRUCache<Key, Value>(capacity);
 }
 
 }  // namespace oceanbase
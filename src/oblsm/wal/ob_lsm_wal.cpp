@@ -8,18 +8,180 @@
    MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
    See the Mulan PSL v2 for more details. */
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include "oblsm/wal/ob_lsm_wal.h"
+#include "common/io/io.h"
+#include "common/lang/filesystem.h"
 #include "common/log/log.h"
+#include "common/math/crc.h"
+#include "oblsm/util/ob_coding.h"
 #include "oblsm/util/ob_file_reader.h"
 
 namespace oceanbase {
+
+static constexpr size_t WAL_RECORD_HEADER_SIZE  = 2 * sizeof(uint32_t);
+static constexpr size_t WAL_PAYLOAD_HEADER_SIZE = sizeof(uint64_t) + sizeof(uint32_t);
+
+WAL::~WAL()
+{
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+RC WAL::open(const std::string &filename)
+{
+  if (fd_ >= 0) {
+    LOG_WARN("wal has already been opened. file=%s", filename_.c_str());
+    return RC::INTERNAL;
+  }
+
+  int fd = ::open(filename.c_str(), O_CREAT | O_WRONLY | O_APPEND, 0644);
+  if (fd < 0) {
+    LOG_WARN("failed to open wal file. file=%s, error=%s", filename.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+
+  fd_       = fd;
+  filename_ = filename;
+  return RC::SUCCESS;
+}
+
 RC WAL::recover(const std::string &wal_file, std::vector<WalRecord> &wal_records)
 {
-  return RC::UNIMPLEMENTED;
+  if (!filesystem::exists(wal_file)) {
+    return RC::SUCCESS;
+  }
+
+  unique_ptr<ObFileReader> reader = ObFileReader::create_file_reader(wal_file);
+  if (reader == nullptr) {
+    LOG_WARN("failed to open wal file for recovery. file=%s", wal_file.c_str());
+    return RC::IOERR_OPEN;
+  }
+
+  uint32_t file_size = reader->file_size();
+  if (file_size == 0) {
+    return RC::SUCCESS;
+  }
+
+  string data = reader->read_pos(0, file_size);
+  if (data.size() != file_size) {
+    LOG_WARN("failed to read wal file. file=%s, size=%u", wal_file.c_str(), file_size);
+    return RC::IOERR_READ;
+  }
+
+  size_t pos = 0;
+  while (pos + WAL_RECORD_HEADER_SIZE <= data.size()) {
+    uint32_t record_size = get_numeric<uint32_t>(data.data() + pos);
+    uint32_t checksum    = get_numeric<uint32_t>(data.data() + pos + sizeof(uint32_t));
+    if (record_size < WAL_PAYLOAD_HEADER_SIZE || pos + WAL_RECORD_HEADER_SIZE + record_size > data.size()) {
+      break;
+    }
+
+    const char *payload = data.data() + pos + WAL_RECORD_HEADER_SIZE;
+    if (crc32(payload, record_size) != checksum) {
+      LOG_WARN("wal record checksum mismatch, stop recovering. file=%s, offset=%lu", wal_file.c_str(), pos);
+      break;
+    }
+
+    const char *p     = payload;
+    const char *limit = payload + record_size;
+    uint64_t    seq   = get_numeric<uint64_t>(p);
+    p += sizeof(uint64_t);
+    uint32_t count = get_numeric<uint32_t>(p);
+    p += sizeof(uint32_t);
+    for (uint32_t i = 0; i < count; i++) {
+      if (p + sizeof(uint32_t) > limit) {
+        LOG_WARN("corrupted wal record. file=%s, offset=%lu", wal_file.c_str(), pos);
+        return RC::IOERR_READ;
+      }
+      uint32_t key_size = get_numeric<uint32_t>(p);
+      p += sizeof(uint32_t);
+      string_view key(p, key_size);
+      p += key_size;
+      if (p + sizeof(uint32_t) > limit) {
+        LOG_WARN("corrupted wal record. file=%s, offset=%lu", wal_file.c_str(), pos);
+        return RC::IOERR_READ;
+      }
+      uint32_t val_size = get_numeric<uint32_t>(p);
+      p += sizeof(uint32_t);
+      string_view val(p, val_size);
+      p += val_size;
+      if (p > limit) {
+        LOG_WARN("corrupted wal record. file=%s, offset=%lu", wal_file.c_str(), pos);
+        return RC::IOERR_READ;
+      }
+      wal_records.emplace_back(seq + i, string(key), string(val));
+    }
+
+    pos += WAL_RECORD_HEADER_SIZE + record_size;
+  }
+
+  if (pos != data.size()) {
+    LOG_WARN("ignore the torn tail of wal file. file=%s, valid size=%lu, file size=%u", wal_file.c_str(), pos, file_size);
+  }
+  return RC::SUCCESS;
+}
+
+void WAL::encode_batch(uint64_t seq, const WalBatch &batch, string *dst)
+{
+  size_t header_pos = dst->size();
+  put_numeric<uint32_t>(dst, 0);  // record size, filled later
+  put_numeric<uint32_t>(dst, 0);  // checksum, filled later
+
+  size_t payload_pos = dst->size();
+  put_numeric<uint64_t>(dst, seq);
+  put_numeric<uint32_t>(dst, static_cast<uint32_t>(batch.size()));
+  for (const auto &[key, val] : batch) {
+    put_numeric<uint32_t>(dst, static_cast<uint32_t>(key.size()));
+    dst->append(key.data(), key.size());
+    put_numeric<uint32_t>(dst, static_cast<uint32_t>(val.size()));
+    dst->append(val.data(), val.size());
+  }
+
+  uint32_t record_size = static_cast<uint32_t>(dst->size() - payload_pos);
+  uint32_t checksum    = crc32(dst->data() + payload_pos, record_size);
+  memcpy(dst->data() + header_pos, &record_size, sizeof(record_size));
+  memcpy(dst->data() + header_pos + sizeof(uint32_t), &checksum, sizeof(checksum));
+}
+
+RC WAL::put(uint64_t seq, string_view key, string_view val) { return put_batch(seq, WalBatch{{key, val}}); }
+
+RC WAL::put_batch(uint64_t seq, const WalBatch &batch)
+{
+  string buf;
+  encode_batch(seq, batch, &buf);
+  return append(buf);
+}
+
+RC WAL::append(string_view records)
+{
+  if (fd_ < 0) {
+    LOG_WARN("wal is not opened");
+    return RC::INTERNAL;
+  }
+
+  int ret = common::writen(fd_, records.data(), static_cast<int>(records.size()));
+  if (ret != 0) {
+    LOG_WARN("failed to write wal file. file=%s, size=%lu, error=%s", filename_.c_str(), records.size(), strerror(errno));
+    return RC::IOERR_WRITE;
+  }
+  return RC::SUCCESS;
 }
 
-RC WAL::put(uint64_t seq, string_view key, string_view val)
+RC WAL::sync()
 {
-  return RC::UNIMPLEMENTED;
+  if (fd_ < 0) {
+    return RC::SUCCESS;
+  }
+
+  if (::fdatasync(fd_) != 0) {
+    LOG_WARN("failed to sync wal file. file=%s, error=%s", filename_.c_str(), strerror(errno));
+    return RC::IOERR_SYNC;
+  }
+  return RC::SUCCESS;
 }
-}  // namespace oceanbase
\ No newline at end of file
+}  // namespace oceanbase
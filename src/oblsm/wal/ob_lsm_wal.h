@@ -13,9 +13,11 @@
 //
 #pragma once
 
-#include "common/lang/mutex.h"
+#include "common/lang/string.h"
+#include "common/lang/string_view.h"
+#include "common/lang/utility.h"
+#include "common/lang/vector.h"
 #include "common/sys/rc.h"
-#include "oblsm/util/ob_file_writer.h"
 
 namespace oceanbase {
 
@@ -43,6 +45,12 @@ struct WalRecord
   WalRecord(uint64_t s, std::string k, std::string v) : seq(s), key(std::move(k)), val(std::move(v)) {}
 };
 
+/**
+ * @brief A group of key-value pairs that is logged as a single WAL record.
+ * An empty value stands for a deletion of the key.
+ */
+using WalBatch = vector<pair<string_view, string_view>>;
+
 /**
  * @class Wal
  * @brief A class responsible for memtable recovery and Write-Ahead Log (WAL) operations.
@@ -51,17 +59,16 @@ struct WalRecord
  * providing durability in case of system failures.
  *
  * ### Data Serialization Format:
- * The data is serialized as follows:
- * - Each entry in the WAL consists of a key-value pair.
- * - The data format is:
- *   - **Sequence Number (uint64_t)**: A 8-byte value representing the sequence of logs.
- *   - **Key Length (size_t)**: A value representing the length of the key.
- *   - **Key (string)**: The actual key, as a string.
- *   - **Value Length (size_t)**: A value representing the length of the value.
- *   - **Value (string)**: The actual value, as a string.
+ * A write batch is serialized as one record, so a batch is either recovered as a whole or not at all:
+ * - **Record Size (uint32_t)**: The size of the payload that follows the record header.
+ * - **Checksum (uint32_t)**: The crc32 of the payload.
+ * - Payload:
+ *   - **Sequence Number (uint64_t)**: The sequence of the first entry, the i-th entry uses `seq + i`.
+ *   - **Entry Count (uint32_t)**: The number of key-value pairs in the batch.
+ *   - For every entry: **Key Length (uint32_t)**, **Key**, **Value Length (uint32_t)**, **Value**.
  *
- * The data is written to the file in the order: key length, key, value length, value.
- * After writing the data, the system performs a `flush()` operation to ensure the data is persisted.
+ * The WAL itself is not thread safe. Concurrent writers are grouped by `ObLsmImpl`: the leader of a group encodes
+ * all batches of the group with `encode_batch`, appends them with one `append` and calls `sync` once for the group.
  */
 class WAL
 {
@@ -73,25 +80,25 @@ public:
 
   /**
    * @brief Destructor for the Wal class.
-   * Ensures that the file writer is closed when the Wal object is destroyed.
+   * Ensures that the file is closed when the Wal object is destroyed.
    */
-  ~WAL() = default;
+  ~WAL();
 
   /**
    * @brief Opens the WAL file for writing.
-   * This function initializes the file writer and prepares the WAL file for appending data.
-   * If the file cannot be opened, an error code is returned.
+   * This function opens (or creates) the WAL file in append mode. If the file cannot be opened, an error code is
+   * returned.
    *
    * @param filename The name of the WAL file to write logs.
    * @return `RC::SUCCESS` if the file was successfully opened, or an error code if it failed.
    */
-  RC open(const std::string &filename) { return RC::UNIMPLEMENTED; }
+  RC open(const std::string &filename);
 
   /**
    * @brief Recovers data from a specified WAL file.
    *
    * This function reads the given WAL file, extracts key-value pairs, and stores them in the provided vector.
-   * It also returns the total number of records read from the WAL.
+   * A torn record at the tail of the file (e.g. the process crashed while appending) is ignored.
    *
    * @param wal_file The name of the WAL file to recover from.
    * @param wal_records A reference to a vector where the WalRecord objects will be stored.
@@ -102,7 +109,7 @@ public:
   /**
    * @brief Writes a key-value pair to the WAL.
    *
-   * This function serializes the key-value pair and appends it to the WAL file.
+   * This function serializes the key-value pair as a batch of one entry and appends it to the WAL file.
    *
    * @param seq The sequence number of the record.
    * @param key The key to write.
@@ -111,17 +118,41 @@ public:
    */
   RC put(uint64_t seq, std::string_view key, std::string_view val);
 
+  /**
+   * @brief Writes a batch of key-value pairs to the WAL as one record.
+   *
+   * @param seq The sequence number of the first entry in the batch.
+   * @param batch The key-value pairs to write.
+   */
+  RC put_batch(uint64_t seq, const WalBatch &batch);
+
+  /**
+   * @brief Appends already encoded records to the WAL file.
+   * @param records One or more records produced by `encode_batch`.
+   */
+  RC append(std::string_view records);
+
+  /**
+   * @brief Serializes a batch into one WAL record and appends it to `dst`.
+   *
+   * @param seq The sequence number of the first entry in the batch.
+   * @param batch The key-value pairs to serialize.
+   * @param dst The buffer the record is appended to.
+   */
+  static void encode_batch(uint64_t seq, const WalBatch &batch, string *dst);
+
   /**
    * @brief Synchronizes the WAL to disk.
-   * Forces any buffered data in the WAL to be written to the underlying storage.
+   * Forces any written data in the WAL to be persisted to the underlying storage.
    *
    * @return `RC::SUCCESS` if the sync operation is successful, or an error code if it fails.
    */
-  RC sync() { return RC::UNIMPLEMENTED; }
+  RC sync();
 
   const string &filename() const { return filename_; }
 
 private:
   string filename_;
+  int    fd_ = -1;
 };
 }  // namespace oceanbase
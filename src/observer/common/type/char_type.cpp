@@ -29,6 +29,9 @@ RC CharType::set_value_from_str(Value &val, const string &data) const
 RC CharType::cast_to(const Value &val, AttrType type, Value &result) const
 {
   switch (type) {
+    case AttrType::VECTORS: {
+      return DataType::type_instance(AttrType::VECTORS)->set_value_from_str(result, val.get_string());
+    }
     default: return RC::UNIMPLEMENTED;
   }
   return RC::SUCCESS;
@@ -0,0 +1,106 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "common/type/vector_distance.h"
+#include "common/lang/cmath.h"
+#include "common/lang/string.h"
+#include "common/math/simd_util.h"
+
+static const char *VECTOR_DISTANCE_TYPE_NAME[] = {"l2_distance", "cosine_distance", "inner_product"};
+
+const char *vector_distance_type_to_string(VectorDistanceType type)
+{
+  return VECTOR_DISTANCE_TYPE_NAME[static_cast<int>(type)];
+}
+
+RC vector_distance_type_from_string(const char *s, VectorDistanceType &type)
+{
+  for (size_t i = 0; i < sizeof(VECTOR_DISTANCE_TYPE_NAME) / sizeof(VECTOR_DISTANCE_TYPE_NAME[0]); i++) {
+    if (0 == strcasecmp(VECTOR_DISTANCE_TYPE_NAME[i], s)) {
+      type = static_cast<VectorDistanceType>(i);
+      return RC::SUCCESS;
+    }
+  }
+  return RC::INVALID_ARGUMENT;
+}
+
+#if defined(USE_SIMD)
+
+static float l2_square(const float *left, const float *right, int dim)
+{
+  return mm256_l2_square_ps(left, right, dim);
+}
+
+static float inner_product(const float *left, const float *right, int dim)
+{
+  return mm256_inner_product_ps(left, right, dim);
+}
+
+static void inner_product_norm(
+    const float *left, const float *right, int dim, float &product, float &left_norm, float &right_norm)
+{
+  mm256_inner_product_norm_ps(left, right, dim, product, left_norm, right_norm);
+}
+
+#else
+
+static float l2_square(const float *left, const float *right, int dim)
+{
+  float sum = 0;
+  for (int i = 0; i < dim; i++) {
+    float diff = left[i] - right[i];
+    sum += diff * diff;
+  }
+  return sum;
+}
+
+static float inner_product(const float *left, const float *right, int dim)
+{
+  float sum = 0;
+  for (int i = 0; i < dim; i++) {
+    sum += left[i] * right[i];
+  }
+  return sum;
+}
+
+static void inner_product_norm(
+    const float *left, const float *right, int dim, float &product, float &left_norm, float &right_norm)
+{
+  product = left_norm = right_norm = 0;
+  for (int i = 0; i < dim; i++) {
+    product += left[i] * right[i];
+    left_norm += left[i] * left[i];
+    right_norm += right[i] * right[i];
+  }
+}
+
+#endif
+
+float vector_distance(VectorDistanceType type, const float *left, const float *right, int dim)
+{
+  switch (type) {
+    case VectorDistanceType::L2: {
+      return sqrtf(l2_square(left, right, dim));
+    }
+    case VectorDistanceType::COSINE: {
+      float product = 0, left_norm = 0, right_norm = 0;
+      inner_product_norm(left, right, dim, product, left_norm, right_norm);
+      if (left_norm == 0 || right_norm == 0) {
+        // 零向量没有方向，按照完全不相关处理
+        return 1.0f;
+      }
+      return 1.0f - product / sqrtf(left_norm * right_norm);
+    }
+    case VectorDistanceType::INNER_PRODUCT: {
+      return inner_product(left, right, dim);
+    }
+  }
+  return 0;
+}
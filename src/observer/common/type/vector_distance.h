@@ -0,0 +1,41 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/sys/rc.h"
+
+/**
+ * @brief 向量距离的度量方式
+ * @ingroup DataType
+ */
+enum class VectorDistanceType
+{
+  L2,             ///< 欧氏距离 sqrt(sum((a-b)^2))
+  COSINE,         ///< 余弦距离 1 - a·b / (|a| * |b|)
+  INNER_PRODUCT,  ///< 内积 a·b，与另外两种距离相反，值越大越相近
+};
+
+/**
+ * @brief 距离类型的名字，同时也是 SQL 中的函数名，比如 l2_distance
+ */
+const char *vector_distance_type_to_string(VectorDistanceType type);
+RC          vector_distance_type_from_string(const char *s, VectorDistanceType &type);
+
+/**
+ * @brief 按照距离排序时，升序是否表示由近及远
+ */
+inline bool vector_distance_ascending(VectorDistanceType type) { return type != VectorDistanceType::INNER_PRODUCT; }
+
+/**
+ * @brief 计算两个 dim 维向量的距离
+ * @details 开启 USE_SIMD 时使用 AVX2 实现，否则使用标量实现。
+ */
+float vector_distance(VectorDistanceType type, const float *left, const float *right, int dim);
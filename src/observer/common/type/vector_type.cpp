@@ -0,0 +1,157 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "common/lang/comparator.h"
+#include "common/lang/sstream.h"
+#include "common/log/log.h"
+#include "common/type/vector_type.h"
+#include "common/value.h"
+
+int VectorType::compare(const Value &left, const Value &right) const
+{
+  ASSERT(left.attr_type() == AttrType::VECTORS, "left type is not vector");
+  if (right.attr_type() != AttrType::VECTORS) {
+    return INT32_MAX;
+  }
+
+  // 按分量逐个比较，前缀相同时维度小的更小
+  const float *left_values  = left.get_vector();
+  const float *right_values = right.get_vector();
+  const int    left_dim     = left.vector_dim();
+  const int    right_dim    = right.vector_dim();
+  for (int i = 0; i < left_dim && i < right_dim; i++) {
+    int result = common::compare_float((void *)&left_values[i], (void *)&right_values[i]);
+    if (result != 0) {
+      return result;
+    }
+  }
+  return left_dim < right_dim ? -1 : (left_dim > right_dim ? 1 : 0);
+}
+
+/**
+ * @brief 逐个分量计算 left op right
+ */
+template <typename Op>
+static RC vector_arithmetic(const Value &left, const Value &right, Value &result, Op op)
+{
+  if (left.attr_type() != AttrType::VECTORS || right.attr_type() != AttrType::VECTORS ||
+      left.vector_dim() != right.vector_dim()) {
+    LOG_WARN("vector arithmetic requires two vectors with the same dimension. left=%s, right=%s",
+        attr_type_to_string(left.attr_type()), attr_type_to_string(right.attr_type()));
+    return RC::INVALID_ARGUMENT;
+  }
+
+  const int     dim = left.vector_dim();
+  vector<float> values(dim);
+  for (int i = 0; i < dim; i++) {
+    values[i] = op(left.get_vector()[i], right.get_vector()[i]);
+  }
+  result.set_vector(values.data(), dim);
+  return RC::SUCCESS;
+}
+
+RC VectorType::add(const Value &left, const Value &right, Value &result) const
+{
+  return vector_arithmetic(left, right, result, [](float a, float b) { return a + b; });
+}
+
+RC VectorType::subtract(const Value &left, const Value &right, Value &result) const
+{
+  return vector_arithmetic(left, right, result, [](float a, float b) { return a - b; });
+}
+
+RC VectorType::multiply(const Value &left, const Value &right, Value &result) const
+{
+  return vector_arithmetic(left, right, result, [](float a, float b) { return a * b; });
+}
+
+RC VectorType::cast_to(const Value &val, AttrType type, Value &result) const
+{
+  switch (type) {
+    case AttrType::CHARS: {
+      string str;
+      RC     rc = to_string(val, str);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+      result.set_string(str.c_str());
+    } break;
+    default: return RC::UNIMPLEMENTED;
+  }
+  return RC::SUCCESS;
+}
+
+RC VectorType::parse(const char *s, int len, vector<float> &values)
+{
+  values.clear();
+  const char *end = s + len;
+  while (s < end && isspace(*s)) {
+    s++;
+  }
+  while (end > s && isspace(*(end - 1))) {
+    end--;
+  }
+  if (end - s < 2 || *s != '[' || *(end - 1) != ']') {
+    return RC::SCHEMA_FIELD_TYPE_MISMATCH;
+  }
+
+  s++;
+  end--;
+  string       body(s, end - s);
+  stringstream ss(body);
+  string       item;
+  while (getline(ss, item, ',')) {
+    char *parse_end = nullptr;
+    float value     = strtof(item.c_str(), &parse_end);
+    if (parse_end == item.c_str()) {
+      return RC::SCHEMA_FIELD_TYPE_MISMATCH;
+    }
+    while (*parse_end != '\0' && isspace(*parse_end)) {
+      parse_end++;
+    }
+    if (*parse_end != '\0') {
+      return RC::SCHEMA_FIELD_TYPE_MISMATCH;
+    }
+    values.push_back(value);
+  }
+
+  if (values.empty()) {
+    return RC::SCHEMA_FIELD_TYPE_MISMATCH;
+  }
+  return RC::SUCCESS;
+}
+
+RC VectorType::set_value_from_str(Value &val, const string &data) const
+{
+  vector<float> values;
+  RC            rc = parse(data.c_str(), static_cast<int>(data.size()), values);
+  if (OB_FAIL(rc)) {
+    LOG_TRACE("failed to parse vector. s=%s", data.c_str());
+    return rc;
+  }
+  val.set_vector(values.data(), static_cast<int>(values.size()));
+  return RC::SUCCESS;
+}
+
+RC VectorType::to_string(const Value &val, string &result) const
+{
+  stringstream ss;
+  ss << "[";
+  const float *values = val.get_vector();
+  for (int i = 0; i < val.vector_dim(); i++) {
+    if (i != 0) {
+      ss << ",";
+    }
+    ss << common::double_to_str(values[i]);
+  }
+  ss << "]";
+  result = ss.str();
+  return RC::SUCCESS;
+}
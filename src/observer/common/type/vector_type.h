@@ -10,11 +10,14 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/lang/vector.h"
 #include "common/type/data_type.h"
 
 /**
  * @brief 向量类型
  * @ingroup DataType
+ * @details 向量的每个分量都是 float，Value 中的长度是字节数，分量个数即维度为 length / sizeof(float)。
+ * 字符串形式为 "[1,2,3]"。
  */
 class VectorType : public DataType
 {
@@ -22,11 +25,21 @@ public:
   VectorType() : DataType(AttrType::VECTORS) {}
   virtual ~VectorType() {}
 
-  int compare(const Value &left, const Value &right) const override { return INT32_MAX; }
+  int compare(const Value &left, const Value &right) const override;
 
-  RC add(const Value &left, const Value &right, Value &result) const override { return RC::UNIMPLEMENTED; }
-  RC subtract(const Value &left, const Value &right, Value &result) const override { return RC::UNIMPLEMENTED; }
-  RC multiply(const Value &left, const Value &right, Value &result) const override { return RC::UNIMPLEMENTED; }
+  RC add(const Value &left, const Value &right, Value &result) const override;
+  RC subtract(const Value &left, const Value &right, Value &result) const override;
+  RC multiply(const Value &left, const Value &right, Value &result) const override;
 
-  RC to_string(const Value &val, string &result) const override { return RC::UNIMPLEMENTED; }
-};
\ No newline at end of file
+  RC cast_to(const Value &val, AttrType type, Value &result) const override;
+
+  RC set_value_from_str(Value &val, const string &data) const override;
+
+  RC to_string(const Value &val, string &result) const override;
+
+  /**
+   * @brief 解析 "[1,2,3]" 形式的字符串
+   * @details 字符串与向量的转换（插入数据、查询常量）都走这里。
+   */
+  static RC parse(const char *s, int len, vector<float> &values);
+};
@@ -42,13 +42,15 @@ enum class ReadWriteMode
 
 /**
  * @brief 存储格式，仅支持 Heap 存储引擎设置。
- * @details 当前仅支持行存格式（ROW_FORMAT）以及 PAX 存储格式(PAX_FORMAT)。
+ * @details 当前仅支持行存格式（ROW_FORMAT）、PAX 存储格式(PAX_FORMAT)以及压缩的 PAX 存储格式(PAX_COMPRESSED_FORMAT)。
+ * 压缩的 PAX 格式在页面写满时对列数据做轻量级的编码，腾出的空间继续写入新的记录。
  */
 enum class StorageFormat
 {
   UNKNOWN_FORMAT = 0,
   ROW_FORMAT,
-  PAX_FORMAT
+  PAX_FORMAT,
+  PAX_COMPRESSED_FORMAT
 };
 
 /**
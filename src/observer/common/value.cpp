@@ -35,9 +35,10 @@ Value::Value(const string_t& s) { set_string(s.data(), s.size()); }
 
 Value::Value(const Value &other)
 {
-  this->attr_type_ = other.attr_type_;
-  this->length_    = other.length_;
-  this->own_data_  = other.own_data_;
+  this->attr_type_   = other.attr_type_;
+  this->length_      = other.length_;
+  this->own_data_    = other.own_data_;
+  this->param_index_ = other.param_index_;
   switch (this->attr_type_) {
     case AttrType::CHARS: {
       set_string_from_other(other);
@@ -45,6 +46,9 @@ Value::Value(const Value &other)
     case AttrType::DATES: {
       set_date_from_other(other);
     } break;
+    case AttrType::VECTORS: {
+      set_vector_from_other(other);
+    } break;
 
     default: {
       this->value_ = other.value_;
@@ -54,12 +58,13 @@ Value::Value(const Value &other)
 
 Value::Value(Value &&other)
 {
-  this->attr_type_ = other.attr_type_;
-  this->length_    = other.length_;
-  this->own_data_  = other.own_data_;
-  this->value_     = other.value_;
-  other.own_data_  = false;
-  other.length_    = 0;
+  this->attr_type_   = other.attr_type_;
+  this->length_      = other.length_;
+  this->own_data_    = other.own_data_;
+  this->param_index_ = other.param_index_;
+  this->value_       = other.value_;
+  other.own_data_    = false;
+  other.length_      = 0;
 }
 
 Value &Value::operator=(const Value &other)
@@ -68,13 +73,17 @@ Value &Value::operator=(const Value &other)
     return *this;
   }
   reset();
-  this->attr_type_ = other.attr_type_;
-  this->length_    = other.length_;
-  this->own_data_  = other.own_data_;
+  this->attr_type_   = other.attr_type_;
+  this->length_      = other.length_;
+  this->own_data_    = other.own_data_;
+  this->param_index_ = other.param_index_;
   switch (this->attr_type_) {
     case AttrType::CHARS: {
       set_string_from_other(other);
     } break;
+    case AttrType::VECTORS: {
+      set_vector_from_other(other);
+    } break;
 
     default: {
       this->value_ = other.value_;
@@ -89,12 +98,13 @@ Value &Value::operator=(Value &&other)
     return *this;
   }
   reset();
-  this->attr_type_ = other.attr_type_;
-  this->length_    = other.length_;
-  this->own_data_  = other.own_data_;
-  this->value_     = other.value_;
-  other.own_data_  = false;
-  other.length_    = 0;
+  this->attr_type_   = other.attr_type_;
+  this->length_      = other.length_;
+  this->own_data_    = other.own_data_;
+  this->param_index_ = other.param_index_;
+  this->value_       = other.value_;
+  other.own_data_    = false;
+  other.length_      = 0;
   return *this;
 }
 
@@ -102,6 +112,7 @@ void Value::reset()
 {
   switch (attr_type_) {
     case AttrType::CHARS:
+    case AttrType::VECTORS:
       if (own_data_ && value_.pointer_value_ != nullptr) {
         delete[] value_.pointer_value_;
         value_.pointer_value_ = nullptr;
@@ -110,9 +121,10 @@ void Value::reset()
     default: break;
   }
 
-  attr_type_ = AttrType::UNDEFINED;
-  length_    = 0;
-  own_data_  = false;
+  attr_type_   = AttrType::UNDEFINED;
+  length_      = 0;
+  own_data_    = false;
+  param_index_ = -1;
 }
 
 void Value::set_data(char *data, int length)
@@ -137,6 +149,9 @@ void Value::set_data(char *data, int length)
       value_.int_value_ = *(int32_t *)data;  // 存储为天数
       length_           = length;
     } break;
+    case AttrType::VECTORS: {
+      set_vector((const float *)data, length / static_cast<int>(sizeof(float)));
+    } break;
     default: {
       LOG_WARN("unknown data type: %d", attr_type_);
     } break;
@@ -219,6 +234,9 @@ void Value::set_value(const Value &value)
       set_int(value.get_int());  // 复制天数值
       attr_type_ = AttrType::DATES;  // 确保类型正确
     } break;
+    case AttrType::VECTORS: {
+      set_vector(value.get_vector(), value.vector_dim());
+    } break;
     default: {
       ASSERT(false, "got an invalid value type");
     } break;
@@ -235,10 +253,38 @@ void Value::set_string_from_other(const Value &other)
   }
 }
 
+void Value::set_vector(const float *values, int dim)
+{
+  reset();
+  attr_type_ = AttrType::VECTORS;
+  own_data_  = true;
+  length_    = dim * static_cast<int>(sizeof(float));
+  value_.pointer_value_ = new char[length_];
+  memcpy(value_.pointer_value_, values, length_);
+}
+
+void Value::set_vector_from_other(const Value &other)
+{
+  ASSERT(attr_type_ == AttrType::VECTORS, "attr type is not VECTORS");
+  if (own_data_ && other.value_.pointer_value_ != nullptr && length_ != 0) {
+    this->value_.pointer_value_ = new char[this->length_];
+    memcpy(this->value_.pointer_value_, other.value_.pointer_value_, this->length_);
+  } else {
+    this->value_ = other.value_;
+  }
+}
+
+const float *Value::get_vector() const
+{
+  ASSERT(attr_type_ == AttrType::VECTORS, "attr type is not VECTORS");
+  return reinterpret_cast<const float *>(value_.pointer_value_);
+}
+
 char *Value::data() const
 {
   switch (attr_type_) {
-    case AttrType::CHARS: {
+    case AttrType::CHARS:
+    case AttrType::VECTORS: {
       return value_.pointer_value_;
     } break;
     default: {
@@ -56,6 +56,18 @@ public:
     return v;
   }
 
+  /**
+   * @brief 预处理语句中的参数占位符，即SQL中的问号
+   * @details 占位符没有类型，执行时才会替换成客户端传入的参数值
+   * @param index 参数的编号，从0开始
+   */
+  static Value param(int index)
+  {
+    Value v;
+    v.param_index_ = index;
+    return v;
+  }
+
   Value(const Value &other);
   Value(Value &&other);
 
@@ -109,6 +121,9 @@ public:
   int      length() const { return length_; }
   AttrType attr_type() const { return attr_type_; }
 
+  bool is_param() const { return param_index_ >= 0; }
+  int  param_index() const { return param_index_; }
+
 public:
   /**
    * 获取对应的值
@@ -121,6 +136,10 @@ public:
   bool     get_boolean() const;
   int32_t  get_date() const;
 
+  /// 向量类型的分量，只有 VECTORS 类型可以调用
+  const float *get_vector() const;
+  int          vector_dim() const { return length_ / static_cast<int>(sizeof(float)); }
+
 public:
   void set_int(int val);
   void set_float(float val);
@@ -128,7 +147,9 @@ public:
   void set_empty_string(int len);
   void set_string_from_other(const Value &other);
   void set_date_from_other(const Value &other);
+  void set_vector_from_other(const Value &other);
   void set_date(int32_t val);
+  void set_vector(const float *values, int dim);
 
 public:
   static Value* try_set_date_from_string(const char *s, int len);
@@ -146,6 +167,9 @@ private:
     char   *pointer_value_;
   } value_ = {.int_value_ = 0};
 
-  /// 是否申请并占有内存, 目前对于 CHARS 类型 own_data_ 为true, 其余类型 own_data_ 为false
+  /// 是否申请并占有内存, 目前对于 CHARS 和 VECTORS 类型 own_data_ 为true, 其余类型 own_data_ 为false
   bool own_data_ = false;
+
+  /// 参数占位符的编号，不是占位符时为-1
+  int param_index_ = -1;
 };
@@ -15,11 +15,14 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include "common/lang/string.h"
+#include "common/lang/vector.h"
+#include "common/value.h"
 #include "event/sql_debug.h"
 #include "sql/executor/sql_result.h"
 
 class Session;
 class Communicator;
+class PreparedStatement;
 
 /**
  * @brief 表示一个SQL请求
@@ -27,6 +30,18 @@ class Communicator;
  */
 class SessionEvent
 {
+public:
+  /**
+   * @brief 请求的类型
+   * @details 普通的SQL请求要经过全部的处理阶段。预处理时只做到生成执行计划，执行时直接使用保存的执行计划
+   */
+  enum class Type
+  {
+    QUERY,    ///< 普通的SQL请求
+    PREPARE,  ///< 创建预处理语句
+    EXECUTE,  ///< 执行预处理语句
+  };
+
 public:
   SessionEvent(Communicator *client);
   virtual ~SessionEvent();
@@ -35,14 +50,26 @@ public:
   Session      *session() const;
 
   void set_query(const string &query) { query_ = query; }
+  void set_type(Type type) { type_ = type; }
+  void set_prepared_statement(PreparedStatement *statement) { prepared_statement_ = statement; }
 
   const string &query() const { return query_; }
   SqlResult    *sql_result() { return &sql_result_; }
   SqlDebug     &sql_debug() { return sql_debug_; }
+  Type          type() const { return type_; }
+
+  /// 预处理时是新创建的语句，执行时是要执行的语句
+  PreparedStatement *prepared_statement() const { return prepared_statement_; }
+
+  /// 执行预处理语句时客户端传入的参数
+  vector<Value> &params() { return params_; }
 
 private:
-  Communicator *communicator_ = nullptr;  ///< 与客户端通讯的对象
-  SqlResult     sql_result_;              ///< SQL执行结果
-  SqlDebug      sql_debug_;               ///< SQL调试信息
-  string        query_;                   ///< SQL语句
+  Communicator      *communicator_ = nullptr;  ///< 与客户端通讯的对象
+  SqlResult          sql_result_;              ///< SQL执行结果
+  SqlDebug           sql_debug_;               ///< SQL调试信息
+  string             query_;                   ///< SQL语句
+  Type               type_               = Type::QUERY;
+  PreparedStatement *prepared_statement_ = nullptr;
+  vector<Value>      params_;
 };
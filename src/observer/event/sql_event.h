@@ -34,6 +34,7 @@ public:
   SessionEvent *session_event() const { return session_event_; }
 
   const string                       &sql() const { return sql_; }
+  unique_ptr<ParsedSqlNode>          &sql_node() { return sql_node_; }
   const unique_ptr<ParsedSqlNode>    &sql_node() const { return sql_node_; }
   Stmt                               *stmt() const { return stmt_; }
   unique_ptr<PhysicalOperator>       &physical_operator() { return operator_; }
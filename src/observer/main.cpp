@@ -43,7 +43,7 @@ void usage()
   cout << "-s: use unix socket and the argument is socket address" << endl;
   cout << "-P: protocol. {plain(default), mysql, cli}." << endl;
   cout << "-t: transaction model. {vacuous(default), mvcc}." << endl;
-  cout << "-T: thread handling model. {one-thread-per-connection(default),java-thread-pool}." << endl;
+  cout << "-T: thread handling model. {one-thread-per-connection(default),java-thread-pool,epoll}." << endl;
   cout << "-n: buffer pool memory size in byte" << endl;
   cout << "-d: durbility mode. {vacuous(default), disk}" << endl;
   // TODO: support multi dbs(storage/db/db.h) and remove this options
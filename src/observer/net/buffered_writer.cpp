@@ -17,6 +17,7 @@ See the Mulan PSL v2 for more details. */
 #else
 #include <sys/errno.h>
 #endif
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "net/buffered_writer.h"
@@ -93,6 +94,25 @@ RC BufferedWriter::flush()
   return rc;
 }
 
+RC BufferedWriter::reserve(int32_t size, char *&buf)
+{
+  if (fd_ < 0 || size > buffer_.capacity()) {
+    return RC::INVALID_ARGUMENT;
+  }
+
+  RC rc = buffer_.reserve(size, buf);
+  if (rc != RC::FULL) {
+    return rc;
+  }
+
+  // 缓存清空之后写指针回到开头，一定有足够的连续空间
+  rc = flush();
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  return buffer_.reserve(size, buf);
+}
+
 RC BufferedWriter::flush_internal(int32_t size)
 {
   if (fd_ < 0) {
@@ -101,18 +121,23 @@ RC BufferedWriter::flush_internal(int32_t size)
 
   RC rc = RC::SUCCESS;
 
+  // 数据在环形缓存中可能分成两段，使用 writev 一次写出去
   int32_t write_size = 0;
   while (OB_SUCC(rc) && buffer_.size() > 0 && size > write_size) {
-    const char *buf       = nullptr;
-    int32_t     read_size = 0;
-    rc                    = buffer_.buffer(buf, read_size);
-    if (OB_FAIL(rc)) {
-      return rc;
-    }
+    struct iovec iov[2];
+    const char  *first       = nullptr;
+    const char  *second      = nullptr;
+    int32_t      first_size  = 0;
+    int32_t      second_size = 0;
+    buffer_.buffers(first, first_size, second, second_size);
+    iov[0].iov_base = const_cast<char *>(first);
+    iov[0].iov_len  = first_size;
+    iov[1].iov_base = const_cast<char *>(second);
+    iov[1].iov_len  = second_size;
 
     ssize_t tmp_write_size = 0;
     while (tmp_write_size == 0) {
-      tmp_write_size = ::write(fd_, buf, read_size);
+      tmp_write_size = ::writev(fd_, iov, second_size > 0 ? 2 : 1);
       if (tmp_write_size < 0) {
         if (errno == EAGAIN || errno == EINTR) {
           tmp_write_size = 0;
@@ -124,7 +149,7 @@ RC BufferedWriter::flush_internal(int32_t size)
     }
 
     write_size += tmp_write_size;
-    buffer_.forward(tmp_write_size);
+    rc = buffer_.forward(tmp_write_size);
   }
 
   return rc;
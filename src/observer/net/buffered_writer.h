@@ -51,6 +51,20 @@ public:
    */
   RC writen(const char *data, int32_t size);
 
+  /**
+   * @brief 在缓存中预留一段连续的空间，调用者直接把数据编码到缓存中，省去一次拷贝
+   * @details 空间不够时会先刷新缓存。写完之后调用 commit 提交实际写入的数据，
+   * 在 commit 之前不能再调用其它写函数。
+   * @param size 需要预留的空间大小，超过缓存容量时返回 RC::INVALID_ARGUMENT，调用者需要改用 writen
+   * @param buf 预留的空间
+   */
+  RC reserve(int32_t size, char *&buf);
+
+  /**
+   * @brief 提交通过 reserve 写入的数据
+   */
+  RC commit(int32_t size) { return buffer_.commit(size); }
+
   /**
    * @brief 刷新缓存
    * @details 将缓存中的数据全部写入文件/socket
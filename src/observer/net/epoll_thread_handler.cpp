@@ -0,0 +1,457 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+// epoll 只在 Linux 上可用，其它平台不编译这个线程模型
+#ifdef __linux__
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "net/epoll_thread_handler.h"
+#include "net/communicator.h"
+#include "common/log/log.h"
+#include "common/lang/chrono.h"
+#include "common/lang/deque.h"
+#include "common/thread/thread_util.h"
+
+using namespace common;
+
+/// 一次 epoll_wait 最多返回的事件个数
+static constexpr int MAX_EVENTS = 64;
+/// reactor 执行一个请求超过这个时间，它积压的请求才会被辅助线程偷走
+static constexpr int64_t LONG_REQUEST_US = 2000;
+/// 有 reactor 在执行请求时，辅助线程检查的间隔
+static constexpr auto STEAL_CHECK_INTERVAL = chrono::microseconds(500);
+
+static int64_t now_us()
+{
+  return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief 一个连接关联的数据，注册 epoll 事件时作为事件的参数
+ */
+struct EpollConnection
+{
+  Communicator *communicator = nullptr;
+  EpollReactor *reactor      = nullptr;  ///< 监听这个连接的 reactor
+};
+
+/**
+ * @brief 一个 reactor 线程，使用自己的 epoll 监听分配给它的连接，并在当前线程中处理请求
+ * @details 连接使用 EPOLLONESHOT 注册，事件触发后自动停止监听，处理完请求后再重新注册，
+ * 这样同一个连接上的请求不会被多个线程同时处理。
+ * 就绪的连接先放到就绪队列中，reactor 从队列头部取出处理，辅助线程从尾部偷取。
+ */
+class EpollReactor
+{
+public:
+  EpollReactor(EpollThreadHandler &host, int index) : host_(host), index_(index) {}
+  ~EpollReactor()
+  {
+    if (event_fd_ >= 0) {
+      ::close(event_fd_);
+    }
+    if (epoll_fd_ >= 0) {
+      ::close(epoll_fd_);
+    }
+  }
+
+  RC init()
+  {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+      LOG_ERROR("failed to create epoll. error=%s", strerror(errno));
+      return RC::INTERNAL;
+    }
+
+    // eventfd 用来唤醒阻塞在 epoll_wait 上的 reactor 线程，它的事件参数是空指针
+    event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (event_fd_ < 0) {
+      LOG_ERROR("failed to create eventfd. error=%s", strerror(errno));
+      return RC::INTERNAL;
+    }
+
+    struct epoll_event event;
+    event.events   = EPOLLIN;
+    event.data.ptr = nullptr;
+    if (0 != epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, event_fd_, &event)) {
+      LOG_ERROR("failed to add eventfd to epoll. error=%s", strerror(errno));
+      return RC::INTERNAL;
+    }
+    return RC::SUCCESS;
+  }
+
+  void start() { thread_ = thread(&EpollReactor::loop, this); }
+
+  /**
+   * @brief 唤醒 reactor 线程，让它检查是否需要退出
+   * @details eventfd 不会被读取，一直是可读状态，之后每次 epoll_wait 都会立即返回
+   */
+  void wakeup()
+  {
+    uint64_t value = 1;
+    if (write(event_fd_, &value, sizeof(value)) < 0) {
+      LOG_WARN("failed to wakeup reactor %d. error=%s", index_, strerror(errno));
+    }
+  }
+
+  void join()
+  {
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  RC add(EpollConnection *connection) { return control(EPOLL_CTL_ADD, connection); }
+  RC rearm(EpollConnection *connection) { return control(EPOLL_CTL_MOD, connection); }
+  RC remove(EpollConnection *connection) { return control(EPOLL_CTL_DEL, connection); }
+
+  /**
+   * @brief 辅助线程从就绪队列的尾部偷取一个连接
+   * @details 只有 reactor 正在执行的请求已经超过 LONG_REQUEST_US 时才偷取，短请求还是由 reactor 自己处理。
+   * reactor 执行请求时不会调用 epoll_wait，所以就绪队列为空时辅助线程先替它收集一次就绪的连接。
+   * 连接使用 EPOLLONESHOT 注册，一个事件只会被一个线程拿到。
+   * @param[out] busy reactor 是否正在执行请求
+   */
+  EpollConnection *steal(int64_t now, bool &busy)
+  {
+    lock_guard guard(lock_);
+    if (0 == busy_since_) {
+      return nullptr;
+    }
+
+    busy = true;
+    if (now - busy_since_ < LONG_REQUEST_US) {
+      return nullptr;
+    }
+
+    if (ready_.empty()) {
+      collect_ready(0 /*timeout*/);
+    }
+    if (ready_.empty()) {
+      return nullptr;
+    }
+
+    EpollConnection *connection = ready_.back();
+    ready_.pop_back();
+    return connection;
+  }
+
+private:
+  RC control(int op, EpollConnection *connection)
+  {
+    struct epoll_event event;
+    event.events   = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    event.data.ptr = connection;
+
+    int fd = connection->communicator->fd();
+    if (0 != epoll_ctl(epoll_fd_, op, fd, &event)) {
+      LOG_WARN("failed to control epoll. reactor=%d, op=%d, fd=%d, error=%s", index_, op, fd, strerror(errno));
+      return RC::INTERNAL;
+    }
+    return RC::SUCCESS;
+  }
+
+  /**
+   * @brief 把 epoll 中就绪的连接放到就绪队列中，需要持有 lock_
+   * @return int epoll_wait 的返回值
+   */
+  int collect_ready(int timeout_ms)
+  {
+    struct epoll_event events[MAX_EVENTS];
+    int                event_num = epoll_wait(epoll_fd_, events, MAX_EVENTS, timeout_ms);
+    for (int i = 0; i < event_num; i++) {
+      if (events[i].data.ptr != nullptr) {
+        ready_.push_back(static_cast<EpollConnection *>(events[i].data.ptr));
+      }
+    }
+    return event_num;
+  }
+
+  /**
+   * @brief 从就绪队列头部取出一个连接，并记录开始处理的时间
+   */
+  EpollConnection *pop_ready()
+  {
+    lock_guard guard(lock_);
+    if (ready_.empty()) {
+      busy_since_ = 0;
+      return nullptr;
+    }
+
+    EpollConnection *connection = ready_.front();
+    ready_.pop_front();
+    busy_since_ = now_us();
+    return connection;
+  }
+
+  void loop();
+
+private:
+  EpollThreadHandler &host_;
+  int                 index_    = 0;
+  int                 epoll_fd_ = -1;
+  int                 event_fd_ = -1;
+  thread              thread_;
+
+  mutex                    lock_;            ///< 保护 ready_ 和 busy_since_
+  deque<EpollConnection *> ready_;           ///< 已经就绪等待处理的连接
+  int64_t                  busy_since_ = 0;  ///< 当前请求开始处理的时间，0表示空闲
+};
+
+void EpollReactor::loop()
+{
+  LOG_INFO("reactor thread start. index=%d", index_);
+  int ret = thread_set_name("Reactor");
+  if (ret != 0) {
+    LOG_WARN("failed to set thread name. ret = %d", ret);
+  }
+  ret = thread_set_cpu_affinity(index_);
+  if (ret != 0) {
+    LOG_WARN("failed to set cpu affinity. reactor=%d, ret=%d", index_, ret);
+  }
+
+  while (host_.running()) {
+    // 阻塞等待时不能持有锁，否则辅助线程会被卡住。这里只等待一个事件，其它就绪的连接加锁后再收集
+    struct epoll_event event;
+    int                event_num = epoll_wait(epoll_fd_, &event, 1, -1 /*timeout*/);
+    if (event_num < 0) {
+      if (EINTR == errno) {
+        continue;
+      }
+      LOG_ERROR("epoll wait failed. reactor=%d, error=%s", index_, strerror(errno));
+      break;
+    }
+
+    {
+      lock_guard guard(lock_);
+      if (event_num > 0 && event.data.ptr != nullptr) {
+        ready_.push_back(static_cast<EpollConnection *>(event.data.ptr));
+      }
+      collect_ready(0 /*timeout*/);
+    }
+
+    EpollConnection *connection = nullptr;
+    while (host_.running() && (connection = pop_ready()) != nullptr) {
+      host_.notify_stealers();
+      host_.handle_request(connection);
+    }
+  }
+  LOG_INFO("reactor thread stop. index=%d", index_);
+}
+
+EpollThreadHandler::EpollThreadHandler() = default;
+
+EpollThreadHandler::~EpollThreadHandler()
+{
+  stop();
+  await_stop();
+}
+
+RC EpollThreadHandler::start()
+{
+  if (!reactors_.empty()) {
+    LOG_ERROR("epoll thread handler has been started");
+    return RC::INTERNAL;
+  }
+
+  // 这里写死了 reactor 和辅助线程的个数，实际上可以从配置文件中读取
+  int reactor_num = static_cast<int>(thread::hardware_concurrency());
+  if (reactor_num <= 0) {
+    reactor_num = 1;
+  }
+
+  running_ = true;
+  for (int i = 0; i < reactor_num; i++) {
+    auto reactor = make_unique<EpollReactor>(*this, i);
+    RC   rc      = reactor->init();
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("failed to init reactor. rc=%s", strrc(rc));
+      running_ = false;
+      reactors_.clear();
+      return rc;
+    }
+    reactors_.push_back(std::move(reactor));
+  }
+
+  for (auto &reactor : reactors_) {
+    reactor->start();
+  }
+
+  for (int i = 0; i < reactor_num; i++) {
+    stealers_.emplace_back(&EpollThreadHandler::steal_loop, this);
+  }
+
+  LOG_INFO("epoll thread handler started. reactor num=%d", reactor_num);
+  return RC::SUCCESS;
+}
+
+RC EpollThreadHandler::new_connection(Communicator *communicator)
+{
+  if (reactors_.empty()) {
+    LOG_ERROR("epoll thread handler is not started");
+    return RC::INTERNAL;
+  }
+
+  EpollConnection *connection = new EpollConnection;
+  connection->communicator    = communicator;
+  connection->reactor = reactors_[next_reactor_.fetch_add(1, memory_order_relaxed) % reactors_.size()].get();
+
+  {
+    lock_guard guard(lock_);
+    if (connections_.count(communicator) != 0) {
+      LOG_WARN("connection already exists. communicator = %p", communicator);
+      delete connection;
+      return RC::FILE_EXIST;
+    }
+    connections_[communicator] = connection;
+  }
+
+  RC rc = connection->reactor->add(connection);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("failed to add connection to epoll. fd=%d, rc=%s", communicator->fd(), strrc(rc));
+    lock_guard guard(lock_);
+    connections_.erase(communicator);
+    delete connection;
+    return rc;
+  }
+
+  LOG_INFO("new connection. fd=%d", communicator->fd());
+  return RC::SUCCESS;
+}
+
+RC EpollThreadHandler::close_connection(Communicator *communicator)
+{
+  EpollConnection *connection = nullptr;
+  {
+    lock_guard guard(lock_);
+    auto       iter = connections_.find(communicator);
+    if (iter == connections_.end()) {
+      LOG_ERROR("cannot find connection for communicator %p", communicator);
+      return RC::INTERNAL;
+    }
+
+    connection = iter->second;
+    connections_.erase(iter);
+  }
+
+  // 连接关闭之前先从 epoll 中删除，否则 fd 被复用时会收到旧连接的事件
+  connection->reactor->remove(connection);
+  delete connection;
+  delete communicator;
+
+  LOG_INFO("close connection. communicator = %p", communicator);
+  return RC::SUCCESS;
+}
+
+void EpollThreadHandler::handle_request(EpollConnection *connection)
+{
+  RC rc = sql_task_handler_.handle_event(connection->communicator);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to handle sql task. rc=%s", strrc(rc));
+    close_connection(connection->communicator);
+  } else if (OB_FAIL(rc = connection->reactor->rearm(connection))) {
+    LOG_ERROR("failed to rearm connection. rc=%s", strrc(rc));
+    close_connection(connection->communicator);
+  }
+  // 重新监听之后就不能再访问 connection 了，可能已经有其它线程在处理它
+}
+
+void EpollThreadHandler::notify_stealers()
+{
+  lock_guard guard(steal_lock_);
+  if (!steal_pending_) {
+    steal_pending_ = true;
+    steal_cond_.notify_one();
+  }
+}
+
+void EpollThreadHandler::steal_loop()
+{
+  int ret = thread_set_name("Stealer");
+  if (ret != 0) {
+    LOG_WARN("failed to set thread name. ret = %d", ret);
+  }
+
+  size_t start = 0;
+  while (running_) {
+    {
+      unique_lock<mutex> guard(steal_lock_);
+      steal_cond_.wait(guard, [this]() { return steal_pending_ || !running_; });
+      steal_pending_ = false;
+    }
+
+    // 一直检查到所有 reactor 都空闲为止。每次从不同的 reactor 开始，避免总是偷取同一个 reactor
+    while (running_) {
+      bool             busy       = false;
+      EpollConnection *connection = nullptr;
+      int64_t          now        = now_us();
+      for (size_t i = 0; i < reactors_.size() && connection == nullptr; i++) {
+        connection = reactors_[(start + i) % reactors_.size()]->steal(now, busy);
+      }
+      start++;
+
+      if (connection != nullptr) {
+        // 当前线程要去执行请求了，让另一个辅助线程继续检查
+        notify_stealers();
+        handle_request(connection);
+      } else if (busy) {
+        this_thread::sleep_for(STEAL_CHECK_INTERVAL);
+      } else {
+        break;
+      }
+    }
+  }
+}
+
+RC EpollThreadHandler::stop()
+{
+  LOG_INFO("begin to stop epoll thread handler");
+  running_ = false;
+  for (auto &reactor : reactors_) {
+    reactor->wakeup();
+  }
+
+  {
+    lock_guard guard(steal_lock_);
+    steal_cond_.notify_all();
+  }
+  LOG_INFO("end to stop epoll thread handler");
+  return RC::SUCCESS;
+}
+
+RC EpollThreadHandler::await_stop()
+{
+  LOG_INFO("begin to await epoll thread handler stopped");
+  for (auto &reactor : reactors_) {
+    reactor->join();
+  }
+  for (thread &stealer : stealers_) {
+    if (stealer.joinable()) {
+      stealer.join();
+    }
+  }
+  stealers_.clear();
+
+  // 所有线程都退出了，剩下的连接不会再被访问
+  for (auto &kv : connections_) {
+    delete kv.second;
+    delete kv.first;
+  }
+  connections_.clear();
+  reactors_.clear();
+
+  LOG_INFO("end to await epoll thread handler stopped");
+  return RC::SUCCESS;
+}
+
+#endif  // __linux__
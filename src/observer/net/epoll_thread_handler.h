@@ -0,0 +1,97 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+// epoll 只在 Linux 上可用，其它平台不编译这个线程模型
+#ifdef __linux__
+
+#include "net/thread_handler.h"
+#include "net/sql_task_handler.h"
+#include "common/lang/atomic.h"
+#include "common/lang/condition_variable.h"
+#include "common/lang/memory.h"
+#include "common/lang/mutex.h"
+#include "common/lang/thread.h"
+#include "common/lang/unordered_map.h"
+#include "common/lang/vector.h"
+
+class EpollReactor;
+struct EpollConnection;
+
+/**
+ * @brief 基于 epoll 的事件驱动线程模型
+ * @ingroup ThreadHandler
+ * @details 启动若干个 reactor 线程（默认与CPU核数相同），每个线程绑定到一个CPU上，并且有自己的 epoll 实例。
+ * 新连接按照轮询的方式分配给某个 reactor，之后这个连接上的请求都由这个 reactor 在自己的线程中
+ * 接收、执行并返回结果，请求不需要在线程之间传递。空闲的连接只占用一个 epoll 注册项，不占用线程，
+ * 所以可以支持大量的连接。
+ * 如果某个 reactor 执行一个请求的时间比较长，它的其它连接上就绪的请求就会被辅助线程偷走执行，
+ * 避免一个慢查询拖慢同一个 reactor 上的所有连接。被偷走的连接执行完请求后仍然由原来的 reactor 监听。
+ * 只支持 Linux。
+ */
+class EpollThreadHandler : public ThreadHandler
+{
+public:
+  EpollThreadHandler();
+  virtual ~EpollThreadHandler();
+
+  //! @copydoc ThreadHandler::start
+  virtual RC start() override;
+  //! @copydoc ThreadHandler::stop
+  virtual RC stop() override;
+  //! @copydoc ThreadHandler::await_stop
+  virtual RC await_stop() override;
+
+  //! @copydoc ThreadHandler::new_connection
+  virtual RC new_connection(Communicator *communicator) override;
+  //! @copydoc ThreadHandler::close_connection
+  virtual RC close_connection(Communicator *communicator) override;
+
+public:
+  /**
+   * @brief 处理连接上的一个请求，reactor 线程和辅助线程都会调用
+   * @details 处理完成后重新在 epoll 中监听这个连接，之后就不能再访问这个连接了，
+   * 因为它可能已经被另一个线程处理。
+   */
+  void handle_request(EpollConnection *connection);
+
+  /**
+   * @brief reactor 开始执行一个请求，通知辅助线程关注
+   * @details 辅助线程已经在检查时不会重复唤醒
+   */
+  void notify_stealers();
+
+  bool running() const { return running_; }
+
+private:
+  /**
+   * @brief 辅助线程的主循环
+   * @details 有 reactor 当前请求执行的时间超过阈值时，就从它的就绪连接中偷取一个来处理。
+   */
+  void steal_loop();
+
+private:
+  vector<unique_ptr<EpollReactor>> reactors_;
+  vector<thread>                   stealers_;              ///< 辅助线程
+  atomic<size_t>                   next_reactor_{0};       ///< 轮询分配连接时下一个 reactor
+  volatile bool                    running_ = false;
+
+  mutex              steal_lock_;
+  condition_variable steal_cond_;
+  bool               steal_pending_ = false;  ///< 有 reactor 开始执行请求，还没有被辅助线程看到
+
+  mutex                                            lock_;         ///< 保护 connections_
+  unordered_map<Communicator *, EpollConnection *> connections_;  ///< 每个连接与它关联的数据
+
+  SqlTaskHandler sql_task_handler_;  ///< SQL请求处理器
+};
+
+#endif  // __linux__
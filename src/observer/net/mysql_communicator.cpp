@@ -15,12 +15,16 @@ See the Mulan PSL v2 for more details. */
 #include <string.h>
 
 #include "common/io/io.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/charconv.h"
 #include "common/log/log.h"
+#include "common/type/date_type.h"
 #include "event/session_event.h"
 #include "session/session.h"
 #include "net/buffered_writer.h"
 #include "net/mysql_communicator.h"
 #include "sql/operator/string_list_physical_operator.h"
+#include "sql/plan_cache/prepared_statement.h"
 
 /**
  * @brief MySQL协议相关实现
@@ -60,46 +64,18 @@ enum ResultSetMetaData
 };
 
 /**
- * @brief Column types for MySQL
- * @details 枚举值类型是从MySQL的协议中抄过来的
+ * @brief 客户端请求的命令类型
+ * @details [MySQL Command Phase](https://dev.mysql.com/doc/dev/mysql-server/latest/page_protocol_command_phase.html)
+ * 只列出了当前处理的命令
  * @ingroup MySQLProtocol
  */
-enum enum_field_types
+enum MysqlCommand
 {
-  MYSQL_TYPE_DECIMAL,
-  MYSQL_TYPE_TINY,
-  MYSQL_TYPE_SHORT,
-  MYSQL_TYPE_LONG,
-  MYSQL_TYPE_FLOAT,
-  MYSQL_TYPE_DOUBLE,
-  MYSQL_TYPE_NULL,
-  MYSQL_TYPE_TIMESTAMP,
-  MYSQL_TYPE_LONGLONG,
-  MYSQL_TYPE_INT24,
-  MYSQL_TYPE_DATE,
-  MYSQL_TYPE_TIME,
-  MYSQL_TYPE_DATETIME,
-  MYSQL_TYPE_YEAR,
-  MYSQL_TYPE_NEWDATE, /**< Internal to MySQL. Not used in protocol */
-  MYSQL_TYPE_VARCHAR,
-  MYSQL_TYPE_BIT,
-  MYSQL_TYPE_TIMESTAMP2,
-  MYSQL_TYPE_DATETIME2,   /**< Internal to MySQL. Not used in protocol */
-  MYSQL_TYPE_TIME2,       /**< Internal to MySQL. Not used in protocol */
-  MYSQL_TYPE_TYPED_ARRAY, /**< Used for replication only */
-  MYSQL_TYPE_INVALID     = 243,
-  MYSQL_TYPE_BOOL        = 244, /**< Currently just a placeholder */
-  MYSQL_TYPE_JSON        = 245,
-  MYSQL_TYPE_NEWDECIMAL  = 246,
-  MYSQL_TYPE_ENUM        = 247,
-  MYSQL_TYPE_SET         = 248,
-  MYSQL_TYPE_TINY_BLOB   = 249,
-  MYSQL_TYPE_MEDIUM_BLOB = 250,
-  MYSQL_TYPE_LONG_BLOB   = 251,
-  MYSQL_TYPE_BLOB        = 252,
-  MYSQL_TYPE_VAR_STRING  = 253,
-  MYSQL_TYPE_STRING      = 254,
-  MYSQL_TYPE_GEOMETRY    = 255
+  COM_QUERY        = 0x03,  ///< 普通的文本请求
+  COM_STMT_PREPARE = 0x16,  ///< 创建预处理语句
+  COM_STMT_EXECUTE = 0x17,  ///< 执行预处理语句，参数和结果都使用二进制协议
+  COM_STMT_CLOSE   = 0x19,  ///< 释放预处理语句，不需要回复
+  COM_STMT_RESET   = 0x1a,  ///< 重置预处理语句
 };
 
 /**
@@ -207,13 +183,13 @@ int store_lenenc_int(char *buf, uint64_t value)
     return 1;
   }
 
-  if (value < (2UL << 16)) {
+  if (value < (1UL << 16)) {
     *buf = 0xFC;
     memcpy(buf + 1, &value, 2);
     return 3;
   }
 
-  if (value < (2UL << 24)) {
+  if (value < (1UL << 24)) {
     *buf = 0xFD;
     memcpy(buf + 1, &value, 3);
     return 4;
@@ -278,6 +254,76 @@ int store_lenenc_string(char *buf, const char *s)
   return pos + len;
 }
 
+/**
+ * @brief 文本协议结果中的一个值，引用值的原始内存
+ * @ingroup MySQLProtocol
+ * @details 行数据可能来自 Value，也可能直接来自 Column 的内存
+ */
+struct TextCell
+{
+  AttrType     type  = AttrType::UNDEFINED;
+  const char  *data  = nullptr;
+  int          len   = 0;
+  const Value *value = nullptr;  ///< 值来自 Value 时不为空，不能直接编码的类型使用它转换成字符串
+};
+
+/// 浮点数按照 common::double_to_str 格式化之后的最大长度
+static constexpr int FLOAT_TEXT_MAX_LENGTH = 64;
+
+/**
+ * @brief 一个值编码成带有长度标识的字符串之后最多占用的空间
+ * @return 不能直接从原始内存编码的类型返回 -1
+ * @ingroup MySQLProtocolStore
+ */
+int lenenc_cell_max_length(const TextCell &cell)
+{
+  switch (cell.type) {
+    case AttrType::CHARS: return 9 + cell.len;
+    case AttrType::INTS: return 1 + 11;
+    case AttrType::FLOATS: return 1 + FLOAT_TEXT_MAX_LENGTH;
+    default: return -1;
+  }
+}
+
+/**
+ * @brief 将一个值按照 Value::to_string 的格式，以带有长度标识的字符串写入到缓存
+ * @details 直接从原始内存格式化，不会构造临时的 string。只能处理 lenenc_cell_max_length 支持的类型
+ * @param buf  数据缓存，至少需要 lenenc_cell_max_length 的空间
+ * @param cell 要写入的值
+ * @return int 写入的字节数
+ * @ingroup MySQLProtocolStore
+ */
+int store_lenenc_cell(char *buf, const TextCell &cell)
+{
+  switch (cell.type) {
+    case AttrType::CHARS: {
+      // 记录中的字符串占满字段时不以'\0'结尾
+      const int len = static_cast<int>(strnlen(cell.data, cell.len));
+      const int pos = store_lenenc_int(buf, len);
+      return pos + store_fix_length_string(buf + pos, cell.data, len);
+    }
+    case AttrType::INTS: {
+      // 文本长度小于251，长度标识只占一个字节
+      int32_t value = 0;
+      memcpy(&value, cell.data, sizeof(value));
+      char *end = to_chars(buf + 1, buf + 12, value).ptr;
+      store_int1(buf, static_cast<int8_t>(end - buf - 1));
+      return static_cast<int>(end - buf);
+    }
+    case AttrType::FLOATS: {
+      float value = 0;
+      memcpy(&value, cell.data, sizeof(value));
+      const int len = common::double_to_str(value, buf + 1, FLOAT_TEXT_MAX_LENGTH);
+      store_int1(buf, static_cast<int8_t>(len));
+      return 1 + len;
+    }
+    default: {
+      ASSERT(false, "cannot store cell directly. type=%s", attr_type_to_string(cell.type));
+      return 0;
+    }
+  }
+}
+
 /**
  * @brief 每个包都有一个包头
  * @details [MySQL Basic Packet](https://dev.mysql.com/doc/dev/mysql-server/latest/page_protocol_basic_packets.html)
@@ -535,6 +581,102 @@ RC decode_query_packet(vector<char> &net_packet, QueryPacket &query_packet)
   return RC::SUCCESS;
 }
 
+RC decode_binary_param(PacketReader &reader, uint16_t type, Value &value)
+{
+  const bool is_unsigned = (type & 0x8000) != 0;
+
+  RC rc = RC::SUCCESS;
+  switch (type & 0xFF) {
+    case MYSQL_TYPE_TINY: {
+      int8_t v = 0;
+      if (OB_SUCC(rc = reader.fetch_int(v))) {
+        value.set_int(is_unsigned ? static_cast<uint8_t>(v) : v);
+      }
+    } break;
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_YEAR: {
+      int16_t v = 0;
+      if (OB_SUCC(rc = reader.fetch_int(v))) {
+        value.set_int(is_unsigned ? static_cast<uint16_t>(v) : v);
+      }
+    } break;
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_INT24: {
+      int32_t v = 0;
+      if (OB_SUCC(rc = reader.fetch_int(v))) {
+        value.set_int(v);
+      }
+    } break;
+    case MYSQL_TYPE_LONGLONG: {
+      int64_t v = 0;
+      if (OB_SUCC(rc = reader.fetch_int(v))) {
+        value.set_int(static_cast<int>(v));
+      }
+    } break;
+    case MYSQL_TYPE_FLOAT: {
+      float v = 0;
+      if (OB_SUCC(rc = reader.fetch_int(v))) {
+        value.set_float(v);
+      }
+    } break;
+    case MYSQL_TYPE_DOUBLE: {
+      double v = 0;
+      if (OB_SUCC(rc = reader.fetch_int(v))) {
+        value.set_float(static_cast<float>(v));
+      }
+    } break;
+    case MYSQL_TYPE_DATE:
+    case MYSQL_TYPE_DATETIME:
+    case MYSQL_TYPE_TIMESTAMP: {
+      // 长度后面依次是年月日，datetime 后面还有时分秒等，这里只保留日期
+      uint8_t     len   = 0;
+      uint16_t    year  = 0;
+      uint8_t     month = 0;
+      uint8_t     day   = 0;
+      const char *rest  = nullptr;
+      if (OB_FAIL(rc = reader.fetch_int(len))) {
+        break;
+      }
+      if (len < 4) {
+        rc = RC::INVALID_ARGUMENT;
+        break;
+      }
+      if (OB_SUCC(rc = reader.fetch_int(year)) && OB_SUCC(rc = reader.fetch_int(month)) &&
+          OB_SUCC(rc = reader.fetch_int(day)) && OB_SUCC(rc = reader.fetch_fix_length(len - 4, rest))) {
+        if (!DateType::is_valid_date(year, month, day)) {
+          rc = RC::INVALID_ARGUMENT;
+          break;
+        }
+        value.set_date(DateType::date_to_days(year, month, day));
+      }
+    } break;
+    case MYSQL_TYPE_VARCHAR:
+    case MYSQL_TYPE_VAR_STRING:
+    case MYSQL_TYPE_STRING:
+    case MYSQL_TYPE_DECIMAL:
+    case MYSQL_TYPE_NEWDECIMAL:
+    case MYSQL_TYPE_TINY_BLOB:
+    case MYSQL_TYPE_MEDIUM_BLOB:
+    case MYSQL_TYPE_LONG_BLOB:
+    case MYSQL_TYPE_BLOB:
+    case MYSQL_TYPE_JSON:
+    case MYSQL_TYPE_ENUM:
+    case MYSQL_TYPE_SET: {
+      const char *data = nullptr;
+      int         len  = 0;
+      if (OB_SUCC(rc = reader.fetch_lenenc_string(data, len))) {
+        // 空字符串不能传长度0，set_string 会把它当作以'\0'结尾的字符串
+        value.set_string(len > 0 ? data : "", len);
+      }
+    } break;
+    default: {
+      LOG_WARN("unsupported parameter type. type=%d", type & 0xFF);
+      rc = RC::UNSUPPORTED;
+    } break;
+  }
+  return rc;
+}
+
 /**
  * @brief MySQL客户端连接时会发起一个"select @@version_comment"的查询，这里对这个查询进行特殊处理
  * @param[out] sql_result 生成的结果
@@ -662,7 +804,7 @@ RC MysqlCommunicator::read_event(SessionEvent *&event)
   LOG_TRACE("recv command from client =%d", command_type);
 
   /// 已经做过握手，接收普通的消息包
-  if (command_type == 0x03) {  // COM_QUERY，这是一个普通的文本请求
+  if (command_type == COM_QUERY) {  // 这是一个普通的文本请求
     QueryPacket query_packet;
     rc = decode_query_packet(buf, query_packet);
     if (rc != RC::SUCCESS) {
@@ -678,8 +820,32 @@ RC MysqlCommunicator::read_event(SessionEvent *&event)
 
     event = new SessionEvent(this);
     event->set_query(query_packet.query);
+  } else if (command_type == COM_STMT_PREPARE) {
+    // 与 COM_QUERY 一样，命令后面就是SQL语句
+    QueryPacket query_packet;
+    rc = decode_query_packet(buf, query_packet);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to decode prepare packet. packet length=%ld, addr=%s, error=%s", buf.size(), addr(), strrc(rc));
+      return rc;
+    }
+
+    LOG_TRACE("prepare command: %s", query_packet.query.c_str());
+    event = new SessionEvent(this);
+    event->set_type(SessionEvent::Type::PREPARE);
+    event->set_query(query_packet.query);
+  } else if (command_type == COM_STMT_EXECUTE) {
+    rc = read_execute_event(buf, event);
+  } else if (command_type == COM_STMT_CLOSE) {
+    // 按照协议，释放预处理语句不需要回复
+    int32_t      statement_id = 0;
+    PacketReader reader(buf, 1);
+    if (OB_SUCC(reader.fetch_int(statement_id))) {
+      LOG_TRACE("close prepared statement. id=%d", statement_id);
+      session()->remove_prepared_statement(statement_id);
+      param_types_.erase(statement_id);
+    }
   } else {
-    /// 其它的非文本请求，暂时不支持
+    /// 其它的请求，暂时不支持。COM_STMT_RESET 也只需要回复一个 OkPacket
     OkPacket ok_packet(sequence_id_);
     rc = send_packet(ok_packet);
     if (rc != RC::SUCCESS) {
@@ -691,6 +857,100 @@ RC MysqlCommunicator::read_event(SessionEvent *&event)
   return rc;
 }
 
+/**
+ * @brief 解析执行预处理语句的请求
+ * @details [MySQL COM_STMT_EXECUTE](https://dev.mysql.com/doc/dev/mysql-server/latest/page_protocol_com_stmt_execute.html)
+ * 参数的类型只在第一次执行(或者客户端重新绑定参数)时发送，需要保存下来给后面的执行使用。
+ * 服务端没有声明 CLIENT_QUERY_ATTRIBUTES，所以请求中没有参数个数和参数名字。
+ * 请求有问题时直接给客户端回复错误，不生成 SessionEvent。
+ */
+RC MysqlCommunicator::read_execute_event(const vector<char> &packet, SessionEvent *&event)
+{
+  PacketReader reader(packet, 1);
+
+  int32_t statement_id    = 0;
+  int8_t  flags           = 0;  // cursor type，不支持游标，忽略
+  int32_t iteration_count = 0;  // 总是1
+
+  RC rc = reader.fetch_int(statement_id);
+  if (OB_SUCC(rc)) {
+    rc = reader.fetch_int(flags);
+  }
+  if (OB_SUCC(rc)) {
+    rc = reader.fetch_int(iteration_count);
+  }
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to decode execute packet. packet length=%ld, addr=%s", packet.size(), addr());
+    return send_error(rc, "malformed COM_STMT_EXECUTE packet");
+  }
+
+  PreparedStatement *statement = session()->find_prepared_statement(statement_id);
+  if (nullptr == statement) {
+    LOG_WARN("no such prepared statement. id=%d, addr=%s", statement_id, addr());
+    return send_error(RC::NOTFOUND, "unknown prepared statement");
+  }
+
+  const int     param_count = statement->param_count();
+  vector<Value> params(param_count);
+  if (param_count > 0) {
+    const char *null_bitmap      = nullptr;
+    int8_t      new_params_bound = 0;
+
+    rc = reader.fetch_fix_length((param_count + 7) / 8, null_bitmap);
+    if (OB_SUCC(rc)) {
+      rc = reader.fetch_int(new_params_bound);
+    }
+
+    vector<uint16_t> &param_types = param_types_[statement_id];
+    if (OB_SUCC(rc) && new_params_bound == 1) {
+      param_types.resize(param_count);
+      for (int i = 0; OB_SUCC(rc) && i < param_count; i++) {
+        rc = reader.fetch_int(param_types[i]);
+      }
+    }
+    if (OB_SUCC(rc) && static_cast<int>(param_types.size()) != param_count) {
+      LOG_WARN("parameter types are not bound. statement id=%d", statement_id);
+      rc = RC::INVALID_ARGUMENT;
+    }
+
+    for (int i = 0; OB_SUCC(rc) && i < param_count; i++) {
+      if (null_bitmap[i / 8] & (1 << (i % 8))) {
+        LOG_WARN("null parameter is not supported. statement id=%d, index=%d", statement_id, i);
+        rc = RC::UNSUPPORTED;
+      } else {
+        rc = decode_binary_param(reader, param_types[i], params[i]);
+      }
+    }
+
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to decode parameters. statement id=%d, rc=%s", statement_id, strrc(rc));
+      return send_error(rc, "failed to decode parameters");
+    }
+  }
+
+  event = new SessionEvent(this);
+  event->set_type(SessionEvent::Type::EXECUTE);
+  event->set_prepared_statement(statement);
+  event->set_query("execute prepared statement " + to_string(statement_id));
+  event->params() = std::move(params);
+  return RC::SUCCESS;
+}
+
+RC MysqlCommunicator::send_error(RC code, const char *message)
+{
+  ErrPacket err_packet;
+  err_packet.packet_header.sequence_id = sequence_id_++;
+  err_packet.error_code                = static_cast<int>(code);
+  err_packet.error_message             = string(strrc(code)) + " > " + message;
+
+  RC rc = send_packet(err_packet);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to send error packet to client. addr=%s, error=%s", addr(), strrc(rc));
+    return rc;
+  }
+  return writer_->flush();
+}
+
 RC MysqlCommunicator::write_state(SessionEvent *event, bool &need_disconnect)
 {
   SqlResult *sql_result = event->sql_result();
@@ -751,6 +1011,10 @@ RC MysqlCommunicator::write_result(SessionEvent *event, bool &need_disconnect)
 
     need_disconnect = false;
   } else {
+    if (event->type() == SessionEvent::Type::PREPARE && RC::SUCCESS == sql_result->return_code()) {
+      return write_prepare_result(event, need_disconnect);
+    }
+
     if (RC::SUCCESS != sql_result->return_code() || !sql_result->has_operator()) {
       return write_state(event, need_disconnect);
     }
@@ -858,72 +1122,18 @@ RC MysqlCommunicator::send_column_definition(SqlResult *sql_result, bool &need_d
   }
 
   for (int i = 0; i < cell_num; i++) {
-    net_packet.resize(1024);
-    buf = net_packet.data();
-    pos = 0;
-
-    pos += 3;
-    store_int1(buf + pos, sequence_id_++);
-    pos += 1;
-
-    const TupleCellSpec &spec      = tuple_schema.cell_at(i);
-    const char          *catalog   = "def";  // The catalog used. Currently always "def"
-    const char          *schema    = "sys";  // schema name
-    const char          *table     = spec.table_name();
-    const char          *org_table = spec.table_name();
-    const char          *name      = spec.alias();
-    // const char *org_name = spec.field_name();
-    const char *org_name         = spec.alias();
-    int         fixed_len_fields = 0x0c;
-    int         character_set    = 33;
-    int         column_length    = 16384;
-    int         type             = MYSQL_TYPE_VAR_STRING;
-    int16_t     flags            = 0;
-    int8_t      decimals         = 0x1f;
-
-    pos += store_lenenc_string(buf + pos, catalog);
-    pos += store_lenenc_string(buf + pos, schema);
-    pos += store_lenenc_string(buf + pos, table);
-    pos += store_lenenc_string(buf + pos, org_table);
-    pos += store_lenenc_string(buf + pos, name);
-    pos += store_lenenc_string(buf + pos, org_name);
-    pos += store_lenenc_int(buf + pos, fixed_len_fields);
-    store_int2(buf + pos, character_set);
-    pos += 2;
-    store_int4(buf + pos, column_length);
-    pos += 4;
-    store_int1(buf + pos, type);
-    pos += 1;
-    store_int2(buf + pos, flags);
-    pos += 2;
-    store_int1(buf + pos, decimals);
-    pos += 1;
-    store_int2(buf + pos, 0);  // 按照mariadb的文档描述，最后还有一个unused字段int<2>，不过mysql的文档没有给出这样的描述
-    pos += 2;
-
-    payload_length = pos - 4;
-    store_int3(buf, payload_length);
-    net_packet.resize(pos);
-
-    rc = writer_->writen(net_packet.data(), net_packet.size());
+    const TupleCellSpec &spec = tuple_schema.cell_at(i);
+    rc                        = send_column_definition_packet(spec.table_name(), spec.alias());
     if (OB_FAIL(rc)) {
-      LOG_WARN("failed to write column definition to client. addr=%s, error=%s", addr(), strerror(errno));
       need_disconnect = true;
       return rc;
     }
   }
 
-  if (!(client_capabilities_flag_ & CLIENT_DEPRECATE_EOF)) {
-    EofPacket eof_packet;
-    eof_packet.packet_header.sequence_id = sequence_id_++;
-    eof_packet.status_flags              = 0x02;
-    rc                                   = send_packet(eof_packet);
-    if (rc != RC::SUCCESS) {
-      need_disconnect = true;
-      LOG_WARN("failed to send eof packet to client. addr=%s, error=%s", addr(), strerror(errno));
-    }
-  } else {
-    LOG_TRACE("client use CLIENT_DEPRECATE_EOF");
+  rc = send_column_definition_eof();
+  if (OB_FAIL(rc)) {
+    need_disconnect = true;
+    return rc;
   }
 
   LOG_TRACE("send column definition to client done");
@@ -931,6 +1141,144 @@ RC MysqlCommunicator::send_column_definition(SqlResult *sql_result, bool &need_d
   return RC::SUCCESS;
 }
 
+/**
+ * @brief 发送一个列的定义
+ * @details 所有的列都声明为 MYSQL_TYPE_VAR_STRING，文本协议和二进制协议的值都按照字符串发送
+ */
+RC MysqlCommunicator::send_column_definition_packet(const char *table, const char *name)
+{
+  vector<char> net_packet(1024);
+  char        *buf = net_packet.data();
+  int          pos = 0;
+
+  pos += 3;
+  store_int1(buf + pos, sequence_id_++);
+  pos += 1;
+
+  const char *catalog   = "def";  // The catalog used. Currently always "def"
+  const char *schema    = "sys";  // schema name
+  const char *org_table = table;
+  // const char *org_name = spec.field_name();
+  const char *org_name         = name;
+  int         fixed_len_fields = 0x0c;
+  int         character_set    = 33;
+  int         column_length    = 16384;
+  int         type             = MYSQL_TYPE_VAR_STRING;
+  int16_t     flags            = 0;
+  int8_t      decimals         = 0x1f;
+
+  pos += store_lenenc_string(buf + pos, catalog);
+  pos += store_lenenc_string(buf + pos, schema);
+  pos += store_lenenc_string(buf + pos, table);
+  pos += store_lenenc_string(buf + pos, org_table);
+  pos += store_lenenc_string(buf + pos, name);
+  pos += store_lenenc_string(buf + pos, org_name);
+  pos += store_lenenc_int(buf + pos, fixed_len_fields);
+  store_int2(buf + pos, character_set);
+  pos += 2;
+  store_int4(buf + pos, column_length);
+  pos += 4;
+  store_int1(buf + pos, type);
+  pos += 1;
+  store_int2(buf + pos, flags);
+  pos += 2;
+  store_int1(buf + pos, decimals);
+  pos += 1;
+  store_int2(buf + pos, 0);  // 按照mariadb的文档描述，最后还有一个unused字段int<2>，不过mysql的文档没有给出这样的描述
+  pos += 2;
+
+  int payload_length = pos - 4;
+  store_int3(buf, payload_length);
+  net_packet.resize(pos);
+
+  RC rc = writer_->writen(net_packet.data(), net_packet.size());
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to write column definition to client. addr=%s, error=%s", addr(), strerror(errno));
+  }
+  return rc;
+}
+
+RC MysqlCommunicator::send_column_definition_eof()
+{
+  if (client_capabilities_flag_ & CLIENT_DEPRECATE_EOF) {
+    LOG_TRACE("client use CLIENT_DEPRECATE_EOF");
+    return RC::SUCCESS;
+  }
+
+  EofPacket eof_packet;
+  eof_packet.packet_header.sequence_id = sequence_id_++;
+  eof_packet.status_flags              = 0x02;
+  RC rc                                = send_packet(eof_packet);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to send eof packet to client. addr=%s, error=%s", addr(), strerror(errno));
+  }
+  return rc;
+}
+
+/**
+ * 回复预处理请求
+ * [MySQL COM_STMT_PREPARE Response](https://dev.mysql.com/doc/dev/mysql-server/latest/page_protocol_com_stmt_prepare.html#sect_protocol_com_stmt_prepare_response)
+ *
+ * 先发送 COM_STMT_PREPARE_OK，然后是每个参数的定义和每个结果列的定义
+ */
+RC MysqlCommunicator::write_prepare_result(SessionEvent *event, bool &need_disconnect)
+{
+  need_disconnect = true;
+
+  PreparedStatement *statement    = event->prepared_statement();
+  const TupleSchema &tuple_schema = statement->tuple_schema();
+  const int          param_count  = statement->param_count();
+  const int          column_count = tuple_schema.cell_num();
+
+  vector<char> net_packet(32);
+  char        *buf = net_packet.data();
+  int          pos = 4;
+
+  pos += store_int1(buf + pos, 0);  // status: OK
+  pos += store_int4(buf + pos, statement->id());
+  pos += store_int2(buf + pos, column_count);
+  pos += store_int2(buf + pos, param_count);
+  pos += store_int1(buf + pos, 0);  // reserved
+  pos += store_int2(buf + pos, 0);  // warning count
+  if (client_capabilities_flag_ & CLIENT_OPTIONAL_RESULTSET_METADATA) {
+    pos += store_int1(buf + pos, static_cast<int>(ResultSetMetaData::RESULTSET_METADATA_FULL));
+  }
+
+  store_int3(buf, pos - 4);
+  store_int1(buf + 3, sequence_id_++);
+  RC rc = writer_->writen(buf, pos);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to send prepare ok packet to client. addr=%s, error=%s", addr(), strerror(errno));
+    return rc;
+  }
+
+  // 参数没有类型信息，名字都是 "?"
+  for (int i = 0; i < param_count; i++) {
+    if (OB_FAIL(rc = send_column_definition_packet("", "?"))) {
+      return rc;
+    }
+  }
+  if (param_count > 0 && OB_FAIL(rc = send_column_definition_eof())) {
+    return rc;
+  }
+
+  for (int i = 0; i < column_count; i++) {
+    const TupleCellSpec &spec = tuple_schema.cell_at(i);
+    if (OB_FAIL(rc = send_column_definition_packet(spec.table_name(), spec.alias()))) {
+      return rc;
+    }
+  }
+  if (column_count > 0 && OB_FAIL(rc = send_column_definition_eof())) {
+    return rc;
+  }
+
+  rc = writer_->flush();
+  if (OB_SUCC(rc)) {
+    need_disconnect = false;
+  }
+  return rc;
+}
+
 /**
  * 发送每行数据
  * 一行一个包
@@ -941,15 +1289,18 @@ RC MysqlCommunicator::send_result_rows(SessionEvent *event, SqlResult *sql_resul
 {
   RC rc = RC::SUCCESS;
 
+  // 只有不能直接编码到发送缓存中的行才会用到，需要时会自动扩容
   vector<char> packet;
-  packet.resize(4 * 1024 * 1024);  // TODO warning: length cannot be fix
+
+  // 执行预处理语句时按照二进制协议返回行数据
+  const bool binary = event->type() == SessionEvent::Type::EXECUTE;
 
   int    affected_rows = 0;
   if (event->session()->get_execution_mode() == ExecutionMode::CHUNK_ITERATOR
       && event->session()->used_chunk_mode()) {
-    rc = write_chunk_result(sql_result, packet, affected_rows, need_disconnect);
+    rc = write_chunk_result(sql_result, binary, packet, affected_rows, need_disconnect);
   } else {
-    rc = write_tuple_result(sql_result, packet, affected_rows, need_disconnect);
+    rc = write_tuple_result(sql_result, binary, packet, affected_rows, need_disconnect);
   }
 
   // 所有行发送完成后，发送一个EOF或OK包
@@ -971,10 +1322,75 @@ RC MysqlCommunicator::send_result_rows(SessionEvent *event, SqlResult *sql_resul
   return rc;
 }
 
-RC MysqlCommunicator::write_tuple_result(SqlResult *sql_result, vector<char> &packet, int &affected_rows, bool &need_disconnect)
+RC MysqlCommunicator::send_row(const vector<TextCell> &cells, bool binary, vector<char> &packet)
 {
-  Tuple *tuple         = nullptr;
-  RC rc = RC::SUCCESS;
+  // 二进制协议的行以0x00开头，后面是 NULL bitmap，前两个bit保留不用。没有NULL值，bitmap全是0
+  // https://dev.mysql.com/doc/dev/mysql-server/latest/page_protocol_binary_resultset.html#sect_protocol_binary_resultset_row
+  const int row_header_length = binary ? 1 + static_cast<int>((cells.size() + 7 + 2) / 8) : 0;
+
+  // 4个字节的包头
+  int  max_length = 4 + row_header_length;
+  bool direct     = true;
+  for (const TextCell &cell : cells) {
+    const int cell_length = lenenc_cell_max_length(cell);
+    if (cell_length < 0) {
+      direct = false;
+      break;
+    }
+    max_length += cell_length;
+  }
+
+  // 大部分行可以直接编码到发送缓存中，不需要中间的拷贝
+  char *buf = nullptr;
+  if (direct && OB_SUCC(writer_->reserve(max_length, buf))) {
+    memset(buf + 4, 0, row_header_length);
+    int pos = 4 + row_header_length;
+    for (const TextCell &cell : cells) {
+      pos += store_lenenc_cell(buf + pos, cell);
+    }
+    store_int3(buf, pos - 4);
+    store_int1(buf + 3, sequence_id_++);
+    return writer_->commit(pos);
+  }
+
+  // 有其它类型的值或者一行放不进发送缓存时，先编码到 packet 中
+  if (packet.size() < static_cast<size_t>(4 + row_header_length)) {
+    packet.resize(4 + row_header_length);
+  }
+  memset(packet.data() + 4, 0, row_header_length);
+  int pos = 4 + row_header_length;
+  for (const TextCell &cell : cells) {
+    const int cell_length = lenenc_cell_max_length(cell);
+    string    text;
+    if (cell_length < 0) {
+      text = cell.value != nullptr ? cell.value->to_string()
+                                   : Value(cell.type, const_cast<char *>(cell.data), cell.len).to_string();
+    }
+
+    const size_t need_size = pos + (cell_length < 0 ? 9 + text.size() : cell_length);
+    if (packet.size() < need_size) {
+      packet.resize(max(need_size, packet.size() * 2));
+    }
+
+    if (cell_length < 0) {
+      pos += store_lenenc_int(packet.data() + pos, text.size());
+      pos += store_fix_length_string(packet.data() + pos, text.data(), text.size());
+    } else {
+      pos += store_lenenc_cell(packet.data() + pos, cell);
+    }
+  }
+
+  store_int3(packet.data(), pos - 4);
+  store_int1(packet.data() + 3, sequence_id_++);
+  return writer_->writen(packet.data(), pos);
+}
+
+RC MysqlCommunicator::write_tuple_result(SqlResult *sql_result, bool binary, vector<char> &packet, int &affected_rows, bool &need_disconnect)
+{
+  Tuple           *tuple = nullptr;
+  RC               rc    = RC::SUCCESS;
+  vector<Value>    values;
+  vector<TextCell> cells;
   while (RC::SUCCESS == (rc = sql_result->next_tuple(tuple))) {
     assert(tuple != nullptr);
 
@@ -988,26 +1404,20 @@ RC MysqlCommunicator::write_tuple_result(SqlResult *sql_result, vector<char> &pa
     // https://dev.mysql.com/doc/dev/mysql-server/latest/page_protocol_com_query_response_text_resultset.html
     // https://dev.mysql.com/doc/dev/mysql-server/latest/page_protocol_com_query_response_text_resultset_row.html
     // note: if some field is null, send a 0xFB
-    char *buf = packet.data();
-    int   pos = 0;
-
-    pos += 3;
-    pos += store_int1(buf + pos, sequence_id_++);
-
-    Value value;
+    values.resize(cell_num);
+    cells.resize(cell_num);
     for (int i = 0; i < cell_num; i++) {
-      rc = tuple->cell_at(i, value);
+      rc = tuple->cell_at(i, values[i]);
       if (rc != RC::SUCCESS) {
         sql_result->set_return_code(rc);
-        break;  // TODO send error packet
+        return rc;  // TODO send error packet
       }
 
-      pos += store_lenenc_string(buf + pos, value.to_string().c_str());
+      const Value &value = values[i];
+      cells[i]           = TextCell{value.attr_type(), value.data(), value.length(), &value};
     }
 
-    int payload_length = pos - 4;
-    store_int3(buf, payload_length);
-    rc = writer_->writen(buf, pos);
+    rc = send_row(cells, binary, packet);
     if (OB_FAIL(rc)) {
       LOG_WARN("failed to send row packet to client. addr=%s, error=%s", addr(), strerror(errno));
       need_disconnect = true;
@@ -1016,34 +1426,37 @@ RC MysqlCommunicator::write_tuple_result(SqlResult *sql_result, vector<char> &pa
   }
   return rc;
 }
-RC MysqlCommunicator::write_chunk_result(SqlResult *sql_result, vector<char> &packet, int &affected_rows, bool &need_disconnect)
+
+RC MysqlCommunicator::write_chunk_result(SqlResult *sql_result, bool binary, vector<char> &packet, int &affected_rows, bool &need_disconnect)
 {
-  Chunk chunk;
-  RC rc = RC::SUCCESS;
+  Chunk            chunk;
+  RC               rc = RC::SUCCESS;
+  vector<TextCell> cells;
   while (RC::SUCCESS == (rc = sql_result->next_chunk(chunk))) {
     int column_num = chunk.column_num();
     if (column_num == 0) {
       continue;
     }
+
+    // 值直接从列的内存中编码，不需要为每个值构造 Value
+    cells.resize(column_num);
+    for (int col_idx = 0; col_idx < column_num; col_idx++) {
+      const Column &column = chunk.column(col_idx);
+      cells[col_idx]       = TextCell{column.attr_type(), column.data(), column.attr_len(), nullptr};
+    }
+
     for (int i = 0; i < chunk.rows(); i++) {
       affected_rows++;
       // https://dev.mysql.com/doc/dev/mysql-server/latest/page_protocol_com_query_response_text_resultset.html
       // https://dev.mysql.com/doc/dev/mysql-server/latest/page_protocol_com_query_response_text_resultset_row.html
       // note: if some field is null, send a 0xFB
-      char *buf = packet.data();
-      int   pos = 0;
-
-      pos += 3;
-      pos += store_int1(buf + pos, sequence_id_++);
-
       for (int col_idx = 0; col_idx < column_num; col_idx++) {
-        Value value = chunk.get_value(col_idx, i);
-        pos += store_lenenc_string(buf + pos, value.to_string().c_str());
+        const Column &column = chunk.column(col_idx);
+        const int     row    = column.column_type() == Column::Type::CONSTANT_COLUMN ? 0 : i;
+        cells[col_idx].data  = column.data() + static_cast<size_t>(row) * column.attr_len();
       }
 
-      int payload_length = pos - 4;
-      store_int3(buf, payload_length);
-      rc = writer_->writen(buf, pos);
+      rc = send_row(cells, binary, packet);
       if (OB_FAIL(rc)) {
         LOG_WARN("failed to send row packet to client. addr=%s, error=%s", addr(), strerror(errno));
         need_disconnect = true;
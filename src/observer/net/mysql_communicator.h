@@ -16,9 +16,152 @@ See the Mulan PSL v2 for more details. */
 
 #include "net/communicator.h"
 #include "common/lang/string.h"
+#include "common/lang/unordered_map.h"
+#include "common/lang/vector.h"
 
 class SqlResult;
 class BasePacket;
+class Value;
+struct TextCell;
+
+/**
+ * @brief Column types for MySQL
+ * @details 枚举值类型是从MySQL的协议中抄过来的
+ * @ingroup MySQLProtocol
+ */
+enum enum_field_types
+{
+  MYSQL_TYPE_DECIMAL,
+  MYSQL_TYPE_TINY,
+  MYSQL_TYPE_SHORT,
+  MYSQL_TYPE_LONG,
+  MYSQL_TYPE_FLOAT,
+  MYSQL_TYPE_DOUBLE,
+  MYSQL_TYPE_NULL,
+  MYSQL_TYPE_TIMESTAMP,
+  MYSQL_TYPE_LONGLONG,
+  MYSQL_TYPE_INT24,
+  MYSQL_TYPE_DATE,
+  MYSQL_TYPE_TIME,
+  MYSQL_TYPE_DATETIME,
+  MYSQL_TYPE_YEAR,
+  MYSQL_TYPE_NEWDATE, /**< Internal to MySQL. Not used in protocol */
+  MYSQL_TYPE_VARCHAR,
+  MYSQL_TYPE_BIT,
+  MYSQL_TYPE_TIMESTAMP2,
+  MYSQL_TYPE_DATETIME2,   /**< Internal to MySQL. Not used in protocol */
+  MYSQL_TYPE_TIME2,       /**< Internal to MySQL. Not used in protocol */
+  MYSQL_TYPE_TYPED_ARRAY, /**< Used for replication only */
+  MYSQL_TYPE_INVALID     = 243,
+  MYSQL_TYPE_BOOL        = 244, /**< Currently just a placeholder */
+  MYSQL_TYPE_JSON        = 245,
+  MYSQL_TYPE_NEWDECIMAL  = 246,
+  MYSQL_TYPE_ENUM        = 247,
+  MYSQL_TYPE_SET         = 248,
+  MYSQL_TYPE_TINY_BLOB   = 249,
+  MYSQL_TYPE_MEDIUM_BLOB = 250,
+  MYSQL_TYPE_LONG_BLOB   = 251,
+  MYSQL_TYPE_BLOB        = 252,
+  MYSQL_TYPE_VAR_STRING  = 253,
+  MYSQL_TYPE_STRING      = 254,
+  MYSQL_TYPE_GEOMETRY    = 255
+};
+
+/**
+ * @brief 按照MySQL协议的描述从客户端的请求包中读取数据
+ * @ingroup MySQLProtocol
+ * @details 与 MySQLProtocolStore 中的函数对应，读取时会检查包的剩余长度，数据不完整时返回 RC::INVALID_ARGUMENT。
+ * 与写入一样，仅考虑小端模式。
+ */
+class PacketReader
+{
+public:
+  PacketReader(const vector<char> &packet, int pos) : packet_(packet), pos_(pos) {}
+
+  RC fetch_fix_length(int len, const char *&data)
+  {
+    if (len < 0 || pos_ + len > static_cast<int>(packet_.size())) {
+      return RC::INVALID_ARGUMENT;
+    }
+    data = packet_.data() + pos_;
+    pos_ += len;
+    return RC::SUCCESS;
+  }
+
+  template <typename T>
+  RC fetch_int(T &value)
+  {
+    const char *data = nullptr;
+    RC          rc   = fetch_fix_length(sizeof(T), data);
+    if (OB_SUCC(rc)) {
+      memcpy(&value, data, sizeof(T));
+    }
+    return rc;
+  }
+
+  /**
+   * @brief 读取变长编码的整数，参考 store_lenenc_int
+   */
+  RC fetch_lenenc_int(uint64_t &value)
+  {
+    uint8_t first = 0;
+    RC      rc    = fetch_int(first);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    int len = 0;
+    switch (first) {
+      case 0xFC: len = 2; break;
+      case 0xFD: len = 3; break;
+      case 0xFE: len = 8; break;
+      case 0xFB:
+      case 0xFF: return RC::INVALID_ARGUMENT;
+      default: value = first; return RC::SUCCESS;
+    }
+
+    const char *data = nullptr;
+    rc               = fetch_fix_length(len, data);
+    if (OB_SUCC(rc)) {
+      value = 0;
+      memcpy(&value, data, len);
+    }
+    return rc;
+  }
+
+  /**
+   * @brief 读取带有长度标识的字符串，参考 store_lenenc_string
+   */
+  RC fetch_lenenc_string(const char *&data, int &len)
+  {
+    uint64_t length = 0;
+    RC       rc     = fetch_lenenc_int(length);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    if (length > packet_.size()) {
+      return RC::INVALID_ARGUMENT;
+    }
+
+    len = static_cast<int>(length);
+    return fetch_fix_length(len, data);
+  }
+
+private:
+  const vector<char> &packet_;
+  int                 pos_ = 0;
+};
+
+/**
+ * @brief 按照二进制协议解码预处理语句的一个参数
+ * @details [MySQL Binary Protocol Value](https://dev.mysql.com/doc/dev/mysql-server/latest/page_protocol_binary_resultset.html#sect_protocol_binary_resultset_row_value)
+ * MiniOB 中的整数和浮点数都是4个字节，8个字节的参数会被截断。
+ * @param reader 指向参数值的位置
+ * @param type 客户端发送的参数类型，低字节是 enum_field_types，高字节的最高位表示无符号数
+ * @param[out] value 解码后的值
+ * @ingroup MySQLProtocol
+ */
+RC decode_binary_param(PacketReader &reader, uint16_t type, Value &value);
 
 /**
  * @brief 与客户端通讯
@@ -91,8 +234,44 @@ private:
    */
   RC handle_version_comment(bool &need_disconnect);
 
-  RC write_tuple_result(SqlResult *sql_result, vector<char> &packet, int &affected_rows, bool &need_disconnect);
-  RC write_chunk_result(SqlResult *sql_result, vector<char> &packet, int &affected_rows, bool &need_disconnect);
+  /**
+   * @brief 发送一行数据
+   * @details 整行都是可以直接编码的类型时，直接编码到发送缓存中，否则先编码到 packet 中
+   * @param cells 这一行中每个值的类型和原始内存
+   * @param binary 是否按照二进制协议的行格式发送。列都声明为字符串类型，所以值的编码与文本协议相同
+   * @param packet 编码时使用的临时缓存
+   */
+  RC send_row(const vector<TextCell> &cells, bool binary, vector<char> &packet);
+
+  RC write_tuple_result(
+      SqlResult *sql_result, bool binary, vector<char> &packet, int &affected_rows, bool &need_disconnect);
+  RC write_chunk_result(
+      SqlResult *sql_result, bool binary, vector<char> &packet, int &affected_rows, bool &need_disconnect);
+
+  /**
+   * @brief 发送一个列定义的包
+   */
+  RC send_column_definition_packet(const char *table, const char *name);
+
+  /**
+   * @brief 列定义发送完成后，客户端没有设置 CLIENT_DEPRECATE_EOF 时需要发送一个EOF包
+   */
+  RC send_column_definition_eof();
+
+  /**
+   * @brief 回复预处理请求，告诉客户端语句的编号、参数和结果列
+   */
+  RC write_prepare_result(SessionEvent *event, bool &need_disconnect);
+
+  /**
+   * @brief 解析 COM_STMT_EXECUTE 请求，按照二进制协议解码参数
+   */
+  RC read_execute_event(const vector<char> &packet, SessionEvent *&event);
+
+  /**
+   * @brief 还没有生成 SessionEvent 时，直接给客户端回复一个错误包
+   */
+  RC send_error(RC code, const char *message);
 
 private:
   //! 握手阶段(鉴权)，需要做一些特殊处理，所以加个字段单独标记
@@ -104,4 +283,7 @@ private:
   //! 在一次通讯过程中(一个任务的请求与处理)，每个包(packet)都有一个sequence id
   //! 这个sequence id是递增的
   int8_t sequence_id_ = 0;
+
+  //! 预处理语句的参数类型，客户端只在第一次执行时发送，key 是语句编号
+  unordered_map<int, vector<uint16_t>> param_types_;
 };
@@ -16,7 +16,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/log/log.h"
 #include "net/ring_buffer.h"
 
-const int32_t DEFAULT_BUFFER_SIZE = 16 * 1024;
+const int32_t DEFAULT_BUFFER_SIZE = 64 * 1024;
 
 RingBuffer::RingBuffer() : RingBuffer(DEFAULT_BUFFER_SIZE) {}
 
@@ -104,3 +104,49 @@ RC RingBuffer::write(const char *data, int32_t size, int32_t &write_size)
 
   return rc;
 }
+
+RC RingBuffer::reserve(int32_t size, char *&buf)
+{
+  if (size < 0) {
+    return RC::INVALID_ARGUMENT;
+  }
+
+  if (this->size() == 0) {
+    write_pos_ = 0;
+  }
+
+  const int32_t read_pos = this->read_pos();
+  const int32_t continuous_size =
+      (read_pos <= write_pos_ && remain() > 0) ? (capacity() - write_pos_) : (read_pos - write_pos_);
+  if (continuous_size < size) {
+    return RC::FULL;
+  }
+
+  buf = buffer_.data() + write_pos_;
+  return RC::SUCCESS;
+}
+
+RC RingBuffer::commit(int32_t size)
+{
+  if (size < 0 || size > remain()) {
+    return RC::INVALID_ARGUMENT;
+  }
+
+  write_pos_ = (write_pos_ + size) % capacity();
+  data_size_ += size;
+  return RC::SUCCESS;
+}
+
+void RingBuffer::buffers(const char *&first, int32_t &first_size, const char *&second, int32_t &second_size) const
+{
+  const int32_t read_pos = this->read_pos();
+  first                  = buffer_.data() + read_pos;
+  second                 = buffer_.data();
+  if (read_pos + size() <= capacity()) {
+    first_size  = size();
+    second_size = 0;
+  } else {
+    first_size  = capacity() - read_pos;
+    second_size = size() - first_size;
+  }
+}
@@ -27,7 +27,7 @@ class RingBuffer
 {
 public:
   /**
-   * @brief 使用默认缓存大小的构造函数，默认大小16K
+   * @brief 使用默认缓存大小的构造函数，默认大小64K
    */
   RingBuffer();
 
@@ -70,6 +70,28 @@ public:
    */
   RC write(const char *buf, int32_t size, int32_t &write_size);
 
+  /**
+   * @brief 在缓存中预留一段连续的空间，调用者直接在这段空间中写数据
+   * @details 写完之后调用 commit 提交实际写入的数据。缓存为空时写指针会回到开头，
+   * 所以空缓存总能预留不超过容量的空间。
+   * @param size 需要预留的空间大小
+   * @param buf 预留的空间
+   * @return 没有足够的连续空间时返回 RC::FULL
+   */
+  RC reserve(int32_t size, char *&buf);
+
+  /**
+   * @brief 提交通过 reserve 写入的数据
+   * @param size 实际写入的数据大小，不能超过预留的大小
+   */
+  RC commit(int32_t size);
+
+  /**
+   * @brief 返回缓存中的全部数据，不会移动读指针
+   * @details 数据跨过缓存末尾时分成两段，第二段从缓存的开头开始，否则第二段为空
+   */
+  void buffers(const char *&first, int32_t &first_size, const char *&second, int32_t &second_size) const;
+
   /**
    * @brief 缓存的总容量
    */
@@ -47,5 +47,5 @@ public:
 
   CommunicateProtocol protocol;  ///< 通讯协议，目前支持文本协议和mysql协议
 
-  string thread_handling;  ///< 线程池模型
+  string thread_handling;  ///< 线程池模型。one-thread-per-connection(默认)、java-thread-pool 或 epoll(仅Linux)
 };
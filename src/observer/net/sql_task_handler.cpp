@@ -17,6 +17,7 @@ See the Mulan PSL v2 for more details. */
 #include "event/session_event.h"
 #include "event/sql_event.h"
 #include "session/session.h"
+#include "sql/plan_cache/prepared_statement.h"
 
 RC SqlTaskHandler::handle_event(Communicator *communicator)
 {
@@ -34,7 +35,11 @@ RC SqlTaskHandler::handle_event(Communicator *communicator)
 
   SQLStageEvent sql_event(event, event->query());
 
-  rc = handle_sql(&sql_event);
+  switch (event->type()) {
+    case SessionEvent::Type::PREPARE: rc = handle_prepare(&sql_event); break;
+    case SessionEvent::Type::EXECUTE: rc = handle_execute(&sql_event); break;
+    default: rc = handle_sql(&sql_event); break;
+  }
   if (OB_FAIL(rc)) {
     LOG_TRACE("failed to handle sql. rc=%s", strrc(rc));
     event->sql_result()->set_return_code(rc);
@@ -88,4 +93,53 @@ RC SqlTaskHandler::handle_sql(SQLStageEvent *sql_event)
   }
 
   return rc;
-}
\ No newline at end of file
+}
+
+RC SqlTaskHandler::handle_prepare(SQLStageEvent *sql_event)
+{
+  RC rc = parse_stage_.handle_request(sql_event);
+  if (OB_FAIL(rc)) {
+    LOG_TRACE("failed to do parse. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  rc = resolve_stage_.handle_request(sql_event);
+  if (OB_FAIL(rc)) {
+    LOG_TRACE("failed to do resolve. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  rc = optimize_stage_.handle_request(sql_event);
+  if (rc != RC::UNIMPLEMENTED && rc != RC::SUCCESS) {
+    LOG_TRACE("failed to do optimize. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  SessionEvent *session_event = sql_event->session_event();
+  Session      *session       = session_event->session();
+
+  auto statement = make_unique<PreparedStatement>(session->next_statement_id(),
+      std::move(sql_event->sql_node()),
+      sql_event->stmt(),
+      std::move(sql_event->physical_operator()),
+      session->used_chunk_mode());
+  sql_event->set_stmt(nullptr);  // stmt 由预处理语句释放
+
+  LOG_INFO("prepared statement created. id=%d, param count=%d, sql=%s",
+      statement->id(), statement->param_count(), sql_event->sql().c_str());
+  session_event->set_prepared_statement(statement.get());
+  session->add_prepared_statement(std::move(statement));
+  return RC::SUCCESS;
+}
+
+RC SqlTaskHandler::handle_execute(SQLStageEvent *sql_event)
+{
+  PreparedStatement *statement = sql_event->session_event()->prepared_statement();
+  ASSERT(statement != nullptr, "prepared statement should not be null");
+
+  RC rc = execute_stage_.handle_prepared_request(sql_event, *statement);
+  if (OB_FAIL(rc)) {
+    LOG_TRACE("failed to execute prepared statement. id=%d, rc=%s", statement->id(), strrc(rc));
+  }
+  return rc;
+}
@@ -45,6 +45,17 @@ public:
 
   RC handle_sql(SQLStageEvent *sql_event);
 
+  /**
+   * @brief 创建预处理语句
+   * @details 只做到生成执行计划，执行计划保存到会话中
+   */
+  RC handle_prepare(SQLStageEvent *sql_event);
+
+  /**
+   * @brief 执行预处理语句，不再经过解析和优化
+   */
+  RC handle_execute(SQLStageEvent *sql_event);
+
 private:
   SessionStage    session_stage_;      /// 会话阶段
   QueryCacheStage query_cache_stage_;  /// 查询缓存阶段
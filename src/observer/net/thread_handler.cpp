@@ -17,6 +17,9 @@ See the Mulan PSL v2 for more details. */
 #include "net/thread_handler.h"
 #include "net/one_thread_per_connection_thread_handler.h"
 #include "net/java_thread_pool_thread_handler.h"
+#ifdef __linux__
+#include "net/epoll_thread_handler.h"
+#endif
 #include "common/log/log.h"
 #include "common/lang/string.h"
 
@@ -31,6 +34,10 @@ ThreadHandler * ThreadHandler::create(const char *name)
     return new OneThreadPerConnectionThreadHandler();
   } else if (0 == strcasecmp(name, "java-thread-pool")) {
     return new JavaThreadPoolThreadHandler();
+#ifdef __linux__
+  } else if (0 == strcasecmp(name, "epoll")) {
+    return new EpollThreadHandler();
+#endif
   } else {
     LOG_ERROR("unknown thread handler: %s", name);
     return nullptr;
@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "session/session.h"
 #include "common/global_context.h"
+#include "sql/plan_cache/prepared_statement.h"
 #include "storage/db/db.h"
 #include "storage/default/default_handler.h"
 #include "storage/trx/trx.h"
@@ -93,3 +94,20 @@ Session *Session::current_session() { return thread_session; }
 void Session::set_current_request(SessionEvent *request) { current_request_ = request; }
 
 SessionEvent *Session::current_request() const { return current_request_; }
+
+void Session::add_prepared_statement(unique_ptr<PreparedStatement> statement)
+{
+  const int id = statement->id();
+  prepared_statements_[id] = std::move(statement);
+}
+
+PreparedStatement *Session::find_prepared_statement(int id) const
+{
+  auto iter = prepared_statements_.find(id);
+  if (iter == prepared_statements_.end()) {
+    return nullptr;
+  }
+  return iter->second.get();
+}
+
+void Session::remove_prepared_statement(int id) { prepared_statements_.erase(id); }
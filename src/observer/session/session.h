@@ -15,11 +15,14 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include "common/types.h"
+#include "common/lang/memory.h"
 #include "common/lang/string.h"
+#include "common/lang/unordered_map.h"
 
 class Trx;
 class Db;
 class SessionEvent;
+class PreparedStatement;
 
 /**
  * @brief 表示会话
@@ -88,6 +91,19 @@ public:
   void set_use_cascade(bool use_cascade) { use_cascade_ = use_cascade; }
   bool use_cascade() const { return use_cascade_; }
 
+  /// 创建B+树索引时，批量构建的节点填充比例（百分比）
+  static constexpr int DEFAULT_INDEX_FILL_FACTOR = 90;
+
+  void set_index_fill_factor(int fill_factor) { index_fill_factor_ = fill_factor; }
+  int  index_fill_factor() const { return index_fill_factor_; }
+
+  /// 并行执行的线程数，1表示不并行。当前只有向量化执行的聚合会并行执行
+  static constexpr int DEFAULT_PARALLEL_DEGREE = 1;
+  static constexpr int MAX_PARALLEL_DEGREE     = 256;
+
+  void set_parallel_degree(int parallel_degree) { parallel_degree_ = parallel_degree; }
+  int  parallel_degree() const { return parallel_degree_; }
+
   void          set_execution_mode(const ExecutionMode mode) { execution_mode_ = mode; }
   ExecutionMode get_execution_mode() const { return execution_mode_; }
 
@@ -95,6 +111,22 @@ public:
 
   void set_used_chunk_mode(bool used_chunk_mode) { used_chunk_mode_ = used_chunk_mode; }
 
+  /**
+   * @brief 保存一个预处理语句
+   * @details 预处理语句属于会话，会话结束时释放
+   */
+  void add_prepared_statement(unique_ptr<PreparedStatement> statement);
+
+  /**
+   * @brief 根据编号查找预处理语句，找不到时返回 nullptr
+   */
+  PreparedStatement *find_prepared_statement(int id) const;
+
+  void remove_prepared_statement(int id);
+
+  /// 为新的预处理语句分配编号
+  int next_statement_id() { return ++last_statement_id_; }
+
   /**
    * @brief 将指定会话设置到线程变量中
    *
@@ -118,9 +150,15 @@ private:
   bool hash_join_   = false;  ///< 是否使用hash join
   bool use_cascade_ = false;  ///< 是否使用 cascade 优化器
 
+  int index_fill_factor_ = DEFAULT_INDEX_FILL_FACTOR;  ///< 批量构建索引时节点的填充比例
+  int parallel_degree_   = DEFAULT_PARALLEL_DEGREE;    ///< 并行执行的线程数
+
   // 是否使用了 `chunk_iterator` 模式。 只有在设置了 `chunk_iterator`
   // 并且可以生成相关物理执行计划时才会使用 `chunk_iterator` 模式。
   bool used_chunk_mode_ = false;
 
   ExecutionMode execution_mode_ = ExecutionMode::TUPLE_ITERATOR;
+
+  unordered_map<int, unique_ptr<PreparedStatement>> prepared_statements_;  ///< 当前会话的预处理语句
+  int                                               last_statement_id_ = 0;
 };
@@ -32,5 +32,11 @@ RC CreateIndexExecutor::execute(SQLStageEvent *sql_event)
 
   Trx   *trx   = session->current_trx();
   Table *table = create_index_stmt->table();
-  return table->create_index(trx, create_index_stmt->field_meta(), create_index_stmt->index_name().c_str());
+  if (create_index_stmt->is_vector()) {
+    return table->create_vector_index(trx,
+        create_index_stmt->field_metas()[0],
+        create_index_stmt->index_name().c_str(),
+        create_index_stmt->ivfflat_options());
+  }
+  return table->create_index(trx, create_index_stmt->field_metas(), create_index_stmt->index_name().c_str());
 }
\ No newline at end of file
@@ -17,8 +17,10 @@ See the Mulan PSL v2 for more details. */
 #include "common/log/log.h"
 #include "event/session_event.h"
 #include "event/sql_event.h"
+#include "session/session.h"
 #include "sql/executor/command_executor.h"
 #include "sql/operator/calc_physical_operator.h"
+#include "sql/plan_cache/prepared_statement.h"
 #include "sql/stmt/select_stmt.h"
 #include "sql/stmt/stmt.h"
 #include "storage/default/default_handler.h"
@@ -58,3 +60,24 @@ RC ExecuteStage::handle_request_with_physical_operator(SQLStageEvent *sql_event)
   sql_result->set_operator(std::move(physical_operator));
   return rc;
 }
+
+RC ExecuteStage::handle_prepared_request(SQLStageEvent *sql_event, PreparedStatement &statement)
+{
+  SessionEvent *session_event = sql_event->session_event();
+  SqlResult    *sql_result    = session_event->sql_result();
+
+  if (statement.physical_operator() != nullptr) {
+    session_event->session()->set_used_chunk_mode(statement.chunk_mode());
+    sql_result->set_operator(statement.physical_operator());
+    return RC::SUCCESS;
+  }
+
+  // 没有执行计划的语句，每次执行都交给 CommandExecutor
+  sql_event->set_stmt(statement.stmt());
+  CommandExecutor command_executor;
+  RC              rc = command_executor.execute(sql_event);
+  sql_event->set_stmt(nullptr);  // stmt 属于预处理语句，不能由 SQLStageEvent 释放
+
+  sql_result->set_return_code(rc);
+  return rc;
+}
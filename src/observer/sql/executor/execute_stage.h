@@ -19,6 +19,7 @@ See the Mulan PSL v2 for more details. */
 class SQLStageEvent;
 class SessionEvent;
 class SelectStmt;
+class PreparedStatement;
 
 /**
  * @brief 执行SQL语句的Stage，包括DML和DDL
@@ -31,4 +32,10 @@ class ExecuteStage
 public:
   RC handle_request(SQLStageEvent *event);
   RC handle_request_with_physical_operator(SQLStageEvent *sql_event);
+
+  /**
+   * @brief 执行预处理语句
+   * @details 复用预处理时生成的执行计划，参数从请求中获取
+   */
+  RC handle_prepared_request(SQLStageEvent *sql_event, PreparedStatement &statement);
 };
@@ -128,7 +128,8 @@ void LoadDataExecutor::load_data(Table *table, const char *file_name, char termi
       } else {
         insertion_count++;
       }
-    } else if (table->table_meta().storage_format() == StorageFormat::PAX_FORMAT) {
+    } else if (table->table_meta().storage_format() == StorageFormat::PAX_FORMAT ||
+               table->table_meta().storage_format() == StorageFormat::PAX_COMPRESSED_FORMAT) {
       // your code here
       // Todo: 参照insert_record_from_file实现
       rc = RC::UNIMPLEMENTED;
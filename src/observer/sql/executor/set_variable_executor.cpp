@@ -50,6 +50,21 @@ RC SetVariableExecutor::execute(SQLStageEvent *sql_event)
           session->set_use_cascade(bool_value);
           LOG_TRACE("set use_cascade to %d", bool_value);
         }
+      } else if (strcasecmp(var_name, "index_fill_factor") == 0) {
+        if (var_value.attr_type() != AttrType::INTS || var_value.get_int() < 10 || var_value.get_int() > 100) {
+          rc = RC::INVALID_ARGUMENT;
+        } else {
+          session->set_index_fill_factor(var_value.get_int());
+          LOG_TRACE("set index_fill_factor to %d", var_value.get_int());
+        }
+      } else if (strcasecmp(var_name, "parallel_degree") == 0) {
+        if (var_value.attr_type() != AttrType::INTS || var_value.get_int() < 1 ||
+            var_value.get_int() > Session::MAX_PARALLEL_DEGREE) {
+          rc = RC::INVALID_ARGUMENT;
+        } else {
+          session->set_parallel_degree(var_value.get_int());
+          LOG_TRACE("set parallel_degree to %d", var_value.get_int());
+        }
       } else {
       rc = RC::VARIABLE_NOT_EXISTS;
     }
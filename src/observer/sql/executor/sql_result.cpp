@@ -76,7 +76,7 @@ RC SqlResult::next_chunk(Chunk &chunk)
   return rc;
 }
 
-void SqlResult::set_operator(unique_ptr<PhysicalOperator> oper)
+void SqlResult::set_operator(shared_ptr<PhysicalOperator> oper)
 {
   ASSERT(operator_ == nullptr, "current operator is not null. Result is not closed?");
   operator_ = std::move(oper);
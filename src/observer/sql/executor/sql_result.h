@@ -38,7 +38,11 @@ public:
   void set_return_code(RC rc) { return_code_ = rc; }
   void set_state_string(const string &state_string) { state_string_ = state_string; }
 
-  void set_operator(unique_ptr<PhysicalOperator> oper);
+  /**
+   * @brief 设置执行计划
+   * @details 预处理语句的执行计划会被多次执行，所以执行计划是共享的
+   */
+  void set_operator(shared_ptr<PhysicalOperator> oper);
 
   bool               has_operator() const { return operator_ != nullptr; }
   const TupleSchema &tuple_schema() const { return tuple_schema_; }
@@ -52,7 +56,7 @@ public:
 
 private:
   Session                     *session_ = nullptr;  ///< 当前所属会话
-  unique_ptr<PhysicalOperator> operator_;           ///< 执行计划
+  shared_ptr<PhysicalOperator> operator_;           ///< 执行计划
   TupleSchema                  tuple_schema_;       ///< 返回的表头信息。可能有也可能没有
   RC                           return_code_ = RC::SUCCESS;
   string                       state_string_;
@@ -10,280 +10,768 @@ See the Mulan PSL v2 for more details. */
 
 #include "sql/expr/aggregate_hash_table.h"
 #include "sql/expr/aggregate_state.h"
+#include "common/lang/limits.h"
 
 // ----------------------------------StandardAggregateHashTable------------------
 
+static inline uint64_t hash_mix(uint64_t h)
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+static inline uint64_t hash_bytes(const char *data, int len)
+{
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (int i = 0; i < len; i++) {
+    h = (h ^ static_cast<uint8_t>(data[i])) * 0x100000001b3ULL;
+  }
+  return hash_mix(h);
+}
+
+/**
+ * @brief 把一个分组列序列化到定长的行中，每行 key_size 个字节
+ * @details 字符串结束符后面的内容不确定，序列化时补0，保证相同的字符串序列化之后也相同
+ */
+static void serialize_group_key(const Column &column, int rows, int len, int key_size, char *dst)
+{
+  if (column.column_type() == Column::Type::DICTIONARY_COLUMN) {
+    const int32_t *codes = column.codes();
+    for (int row = 0; row < rows; row++, dst += key_size) {
+      string_view str     = column.dictionary()->get(codes[row]);
+      int         str_len = min(static_cast<int>(str.size()), len);
+      memcpy(dst, str.data(), str_len);
+      memset(dst + str_len, 0, len - str_len);
+    }
+    return;
+  }
+
+  const bool  constant = column.column_type() == Column::Type::CONSTANT_COLUMN;
+  const bool  is_chars = column.attr_type() == AttrType::CHARS;
+  const char *src      = column.data();
+  for (int row = 0; row < rows; row++, dst += key_size) {
+    const char *value = constant ? src : src + static_cast<size_t>(row) * len;
+    if (is_chars) {
+      int str_len = static_cast<int>(strnlen(value, len));
+      memcpy(dst, value, str_len);
+      memset(dst + str_len, 0, len - str_len);
+    } else {
+      memcpy(dst, value, len);
+    }
+  }
+}
+
+StandardAggregateHashTable::StandardAggregateHashTable(const vector<Expression *> aggregations)
+{
+  for (auto &expr : aggregations) {
+    ASSERT(expr->type() == ExprType::AGGREGATION, "expect aggregate expression");
+    auto *aggregation_expr = static_cast<AggregateExpr *>(expr);
+    aggr_types_.push_back(aggregation_expr->aggregate_type());
+    // 聚合状态按照参数的类型累加，比如 avg(int) 的结果是 float，但是状态中累加的是 int
+    aggr_child_types_.push_back(aggregation_expr->child()->value_type());
+  }
+}
+
+RC StandardAggregateHashTable::init_layout(const Chunk &groups_chunk)
+{
+  key_size_ = 0;
+  for (int i = 0; i < groups_chunk.column_num(); i++) {
+    const Column &column = groups_chunk.column(i);
+    KeyDictionary key_dict;
+    int           len = column.attr_len();
+    if (column.column_type() == Column::Type::DICTIONARY_COLUMN) {
+      key_dict.dictionary = make_shared<StringDictionary>();
+      len                 = sizeof(int32_t);
+    }
+    key_offsets_.push_back(key_size_);
+    key_lens_.push_back(len);
+    key_dicts_.push_back(std::move(key_dict));
+    key_size_ += len;
+  }
+
+  group_size_ = key_size_;
+  for (size_t i = 0; i < aggr_types_.size(); i++) {
+    int state_size = aggregate_state_size(aggr_types_[i], aggr_child_types_[i]);
+    if (state_size == 0) {
+      LOG_WARN("unsupported aggregate. aggr type=%d, value type=%s",
+               static_cast<int>(aggr_types_[i]), attr_type_to_string(aggr_child_types_[i]));
+      return RC::UNIMPLEMENTED;
+    }
+
+    // arena 按照指针的大小对齐分配内存，聚合状态也按照这个大小对齐
+    group_size_ = (group_size_ + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *);
+    state_offsets_.push_back(group_size_);
+    group_size_ += state_size;
+  }
+  if (group_size_ == 0) {
+    group_size_ = 1;  // 没有分组列也没有聚合列时，所有行属于同一个分组
+  }
+
+  buckets_.resize(DEFAULT_CAPACITY);
+  layout_inited_ = true;
+  return RC::SUCCESS;
+}
+
+void StandardAggregateHashTable::copy_layout(const StandardAggregateHashTable &other)
+{
+  key_offsets_   = other.key_offsets_;
+  key_lens_      = other.key_lens_;
+  state_offsets_ = other.state_offsets_;
+  key_dicts_.clear();
+  for (const KeyDictionary &other_dict : other.key_dicts_) {
+    // 字典中的编号只在一个哈希表中有效，合并时重新编码
+    KeyDictionary key_dict;
+    if (other_dict.dictionary != nullptr) {
+      key_dict.dictionary = make_shared<StringDictionary>();
+    }
+    key_dicts_.push_back(std::move(key_dict));
+  }
+  key_size_      = other.key_size_;
+  group_size_    = other.group_size_;
+
+  buckets_.resize(DEFAULT_CAPACITY);
+  layout_inited_ = true;
+}
+
+void StandardAggregateHashTable::serialize_and_hash(const Chunk &groups_chunk, int rows)
+{
+  keys_.resize(static_cast<size_t>(rows) * key_size_);
+  hashes_.assign(rows, 0);
+
+  for (int col_idx = 0; col_idx < groups_chunk.column_num(); col_idx++) {
+    const Column &column = groups_chunk.column(col_idx);
+    if (key_dicts_[col_idx].dictionary != nullptr) {
+      encode_dictionary_keys(col_idx, column, rows);
+    } else {
+      serialize_group_key(column, rows, key_lens_[col_idx], key_size_, keys_.data() + key_offsets_[col_idx]);
+    }
+  }
+
+  for (int col_idx = 0; col_idx < groups_chunk.column_num(); col_idx++) {
+    const int len    = key_lens_[col_idx];
+    const int offset = key_offsets_[col_idx];
+
+    // 按列计算哈希值，与前面列的哈希值合并。字典编码的列使用字符串的哈希值；
+    // 定长4字节的列是最常见的情况，单独处理
+    const char *key = keys_.data() + offset;
+    if (key_dicts_[col_idx].dictionary != nullptr) {
+      const vector<uint64_t> &str_hashes = key_dicts_[col_idx].hashes;
+      for (int row = 0; row < rows; row++, key += key_size_) {
+        int32_t code;
+        memcpy(&code, key, sizeof(code));
+        hashes_[row] = hash_mix(hashes_[row] * 31 + str_hashes[code]);
+      }
+    } else if (len == 4) {
+      for (int row = 0; row < rows; row++, key += key_size_) {
+        uint32_t value;
+        memcpy(&value, key, sizeof(value));
+        hashes_[row] = hash_mix(hashes_[row] * 31 + value);
+      }
+    } else {
+      for (int row = 0; row < rows; row++, key += key_size_) {
+        hashes_[row] = hash_mix(hashes_[row] * 31 + hash_bytes(key, len));
+      }
+    }
+  }
+}
+
+int32_t StandardAggregateHashTable::add_to_dictionary(KeyDictionary &key_dict, const char *data, int len)
+{
+  int32_t code = key_dict.dictionary->add(data, len);
+  if (code == static_cast<int32_t>(key_dict.hashes.size())) {
+    key_dict.hashes.push_back(hash_bytes(data, len));
+  }
+  return code;
+}
+
+void StandardAggregateHashTable::encode_dictionary_keys(int col_idx, const Column &column, int rows)
+{
+  KeyDictionary &key_dict = key_dicts_[col_idx];
+  char          *dst      = keys_.data() + key_offsets_[col_idx];
+
+  if (column.column_type() != Column::Type::DICTIONARY_COLUMN) {
+    // 没有字典编码的 chunk 逐行查找字典
+    const bool  constant = column.column_type() == Column::Type::CONSTANT_COLUMN;
+    const int   len      = column.attr_len();
+    const char *src      = column.data();
+    for (int row = 0; row < rows; row++, dst += key_size_) {
+      const char   *value = constant ? src : src + static_cast<size_t>(row) * len;
+      const int32_t code  = add_to_dictionary(key_dict, value, static_cast<int>(strnlen(value, len)));
+      memcpy(dst, &code, sizeof(code));
+    }
+    return;
+  }
+
+  // chunk 的字典只会增加字符串，同一个字典只需要转换新增加的部分
+  if (key_dict.source != column.dictionary()) {
+    key_dict.source = column.dictionary();
+    key_dict.translation.clear();
+  }
+  for (int32_t code = static_cast<int32_t>(key_dict.translation.size()); code < key_dict.source->size(); code++) {
+    string_view str = key_dict.source->get(code);
+    key_dict.translation.push_back(add_to_dictionary(key_dict, str.data(), static_cast<int>(str.size())));
+  }
+
+  const int32_t *codes       = column.codes();
+  const int32_t *translation = key_dict.translation.data();
+  for (int row = 0; row < rows; row++, dst += key_size_) {
+    memcpy(dst, &translation[codes[row]], sizeof(int32_t));
+  }
+}
+
+char *StandardAggregateHashTable::find_or_create_group(uint64_t hash, const char *key)
+{
+  size_t mask  = buckets_.size() - 1;
+  size_t index = hash & mask;
+  while (true) {
+    Bucket &bucket = buckets_[index];
+    if (bucket.group == nullptr) {
+      break;
+    }
+    if (bucket.hash == hash && memcmp(bucket.group, key, key_size_) == 0) {
+      return bucket.group;
+    }
+    index = (index + 1) & mask;
+  }
+
+  char *group = arena_.AllocateAligned(group_size_);
+  memcpy(group, key, key_size_);
+  for (size_t i = 0; i < aggr_types_.size(); i++) {
+    init_aggregate_state(group + state_offsets_[i], aggr_types_[i], aggr_child_types_[i]);
+  }
+
+  buckets_[index].hash  = hash;
+  buckets_[index].group = group;
+  groups_.push_back(group);
+
+  if (groups_.size() * 2 > buckets_.size()) {
+    resize();
+  }
+  return group;
+}
+
+void StandardAggregateHashTable::resize()
+{
+  vector<Bucket> new_buckets(buckets_.size() * 2);
+  size_t         mask = new_buckets.size() - 1;
+  for (const Bucket &bucket : buckets_) {
+    if (bucket.group == nullptr) {
+      continue;
+    }
+    size_t index = bucket.hash & mask;
+    while (new_buckets[index].group != nullptr) {
+      index = (index + 1) & mask;
+    }
+    new_buckets[index] = bucket;
+  }
+  buckets_ = std::move(new_buckets);
+}
+
 RC StandardAggregateHashTable::add_chunk(Chunk &groups_chunk, Chunk &aggrs_chunk)
 {
-    if (groups_chunk.rows() != aggrs_chunk.rows()) {
+  if (groups_chunk.rows() != aggrs_chunk.rows()) {
     LOG_WARN("groups_chunk and aggrs_chunk have different rows: %d, %d", groups_chunk.rows(), aggrs_chunk.rows());
     return RC::INVALID_ARGUMENT;
   }
-  for (int i = 0; i < groups_chunk.rows(); i++) {
-    vector<Value> group_by_values;
-    vector<void*> aggr_values;
+  if (aggrs_chunk.column_num() != static_cast<int>(aggr_types_.size())) {
+    LOG_WARN("aggrs_chunk column number mismatch: %d, %d", aggrs_chunk.column_num(), static_cast<int>(aggr_types_.size()));
+    return RC::INVALID_ARGUMENT;
+  }
+
+  RC rc = RC::SUCCESS;
+  if (!layout_inited_ && OB_FAIL(rc = init_layout(groups_chunk))) {
+    return rc;
+  }
 
-    for (int j = 0; j < groups_chunk.column_num(); j++) {
-      group_by_values.emplace_back(groups_chunk.get_value(j, i));
+  const int rows = groups_chunk.rows();
+  if (rows == 0) {
+    return RC::SUCCESS;
+  }
+
+  serialize_and_hash(groups_chunk, rows);
+
+  row_groups_.resize(rows);
+  const char *key = keys_.data();
+  for (int row = 0; row < rows; row++, key += key_size_) {
+    row_groups_[row] = find_or_create_group(hashes_[row], key);
+  }
+
+  for (size_t aggr_idx = 0; aggr_idx < aggr_types_.size(); aggr_idx++) {
+    rc = aggregate_state_update_by_groups(row_groups_.data(), state_offsets_[aggr_idx], aggr_types_[aggr_idx],
+        aggr_child_types_[aggr_idx], aggrs_chunk.column(aggr_idx), rows);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("update aggregate state failed. rc=%s", strrc(rc));
+      return rc;
     }
+  }
+  return RC::SUCCESS;
+}
 
-    auto it = aggr_values_.find(group_by_values);
-    if (it == aggr_values_.end()) {
-      for (size_t j = 0; j < aggr_types_.size(); j++) {
-        void * state_ptr = create_aggregate_state(aggr_types_[j], aggr_child_types_[j]);
-        if (state_ptr == nullptr) {
-          LOG_WARN("create aggregate state failed");
-          return RC::INTERNAL;
-        }   
-        aggr_values.emplace_back(state_ptr);
-      }
-      aggr_values_.emplace(group_by_values, aggr_values);
+RC StandardAggregateHashTable::merge(const StandardAggregateHashTable &other, int partition, int partition_num)
+{
+  if (other.aggr_types_ != aggr_types_ || other.aggr_child_types_ != aggr_child_types_) {
+    LOG_WARN("cannot merge aggregate hash tables with different aggregations");
+    return RC::INVALID_ARGUMENT;
+  }
+  if (!other.layout_inited_) {
+    return RC::SUCCESS;  // other 中没有任何数据
+  }
+  if (!layout_inited_) {
+    copy_layout(other);
+  }
+  if (other.key_lens_ != key_lens_) {
+    LOG_WARN("cannot merge aggregate hash tables with different group keys");
+    return RC::INVALID_ARGUMENT;
+  }
+
+  vector<int> dict_cols;
+  for (size_t i = 0; i < key_dicts_.size(); i++) {
+    if ((key_dicts_[i].dictionary != nullptr) != (other.key_dicts_[i].dictionary != nullptr)) {
+      LOG_WARN("cannot merge aggregate hash tables with different group keys");
+      return RC::INVALID_ARGUMENT;
     }
-    auto &aggr = aggr_values_.find(group_by_values)->second;
-    for (size_t aggr_idx = 0; aggr_idx < aggr.size(); aggr_idx++) {
-      RC rc = aggregate_state_update_by_value(aggr[aggr_idx], aggr_types_[aggr_idx], aggr_child_types_[aggr_idx], aggrs_chunk.get_value(aggr_idx, i));
-      if (rc != RC::SUCCESS) {
-        LOG_WARN("update aggregate state failed");
+    if (key_dicts_[i].dictionary != nullptr) {
+      dict_cols.push_back(static_cast<int>(i));
+    }
+  }
+
+  RC           rc = RC::SUCCESS;
+  vector<char> key(key_size_);
+  for (const Bucket &bucket : other.buckets_) {
+    // 桶的位置用的是哈希值的低位，分区使用高位，避免每个分区中的分组集中在哈希表的一部分桶中
+    if (bucket.group == nullptr || static_cast<int>((bucket.hash >> 32) % partition_num) != partition) {
+      continue;
+    }
+
+    // 字典编码的分组列换成当前哈希表字典中的编号。哈希值只与字符串有关，不需要重新计算
+    memcpy(key.data(), bucket.group, key_size_);
+    for (int col_idx : dict_cols) {
+      int32_t code;
+      memcpy(&code, key.data() + key_offsets_[col_idx], sizeof(code));
+      string_view str = other.key_dicts_[col_idx].dictionary->get(code);
+      code            = add_to_dictionary(key_dicts_[col_idx], str.data(), static_cast<int>(str.size()));
+      memcpy(key.data() + key_offsets_[col_idx], &code, sizeof(code));
+    }
+
+    char *group = find_or_create_group(bucket.hash, key.data());
+    for (size_t i = 0; i < aggr_types_.size(); i++) {
+      rc = aggregate_state_merge(
+          group + state_offsets_[i], bucket.group + other.state_offsets_[i], aggr_types_[i], aggr_child_types_[i]);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to merge aggregate state. rc=%s", strrc(rc));
         return rc;
       }
     }
   }
-  return RC::SUCCESS;
+  return rc;
 }
 
-void StandardAggregateHashTable::Scanner::open_scan()
-{
-  it_  = static_cast<StandardAggregateHashTable *>(hash_table_)->begin();
-  end_ = static_cast<StandardAggregateHashTable *>(hash_table_)->end();
-}
+void StandardAggregateHashTable::Scanner::open_scan() { pos_ = 0; }
 
 RC StandardAggregateHashTable::Scanner::next(Chunk &output_chunk)
 {
-  RC rc = RC::SUCCESS;
-  if (it_ == end_) {
+  auto  *table  = static_cast<StandardAggregateHashTable *>(hash_table_);
+  size_t groups = table->groups_.size();
+  if (pos_ >= groups) {
     return RC::RECORD_EOF;
   }
-  while (it_ != end_ && output_chunk.rows() < output_chunk.capacity()) {
-    auto &group_by_values = it_->first;
-    auto &aggrs           = it_->second;
+
+  const int    key_num = static_cast<int>(table->key_offsets_.size());
+  RC           rc      = RC::SUCCESS;
+  vector<char> buffer;
+  while (pos_ < groups && output_chunk.rows() < output_chunk.capacity()) {
+    char *group = table->groups_[pos_];
     for (int i = 0; i < output_chunk.column_num(); i++) {
-      auto col_idx = output_chunk.column_ids(i);
-      if (col_idx >= static_cast<int>(group_by_values.size())) {
-        int aggr_real_idx = col_idx - group_by_values.size();
-        rc = finialize_aggregate_state(aggrs[aggr_real_idx], hash_table_->aggr_types_[aggr_real_idx],
-                                       hash_table_->aggr_child_types_[aggr_real_idx], output_chunk.column(i));
-        if (rc != RC::SUCCESS) {
-          LOG_WARN("finialize aggregate state failed");
-          return rc;
-        }
+      int col_idx = output_chunk.column_ids(i);
+      if (col_idx >= key_num) {
+        int aggr_idx = col_idx - key_num;
+        rc = finialize_aggregate_state(group + table->state_offsets_[aggr_idx], table->aggr_types_[aggr_idx],
+                                       table->aggr_child_types_[aggr_idx], output_chunk.column(i));
+      } else if (table->key_dicts_[col_idx].dictionary != nullptr) {
+        // 字典编码的分组列输出字符串
+        Column &column = output_chunk.column(i);
+        int32_t code;
+        memcpy(&code, group + table->key_offsets_[col_idx], sizeof(code));
+        string_view str = table->key_dicts_[col_idx].dictionary->get(code);
+        int         len = min(static_cast<int>(str.size()), column.attr_len());
+        buffer.assign(column.attr_len(), 0);
+        memcpy(buffer.data(), str.data(), len);
+        rc = column.append_one(buffer.data());
       } else {
-        if (OB_FAIL(output_chunk.column(i).append_value(group_by_values[col_idx]))) {
-          LOG_WARN("append value failed");
-          return rc;
-        }
+        rc = output_chunk.column(i).append_one(group + table->key_offsets_[col_idx]);
+      }
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to output group. rc=%s", strrc(rc));
+        return rc;
       }
     }
-    it_++;
+    pos_++;
   }
-  if (it_ == end_) {
-    return RC::SUCCESS;
+
+  return RC::SUCCESS;
+}
+
+// ----------------------------------LinearProbingAggregateHashTable------------------
+
+static inline uint32_t hash_int_key(uint32_t key)
+{
+  uint32_t h = key * 0x9E3779B1U;
+  return h ^ (h >> 16);
+}
+
+template <typename T, typename OP>
+static void update_values(char *values, const int *slots, const Column &column, int rows, OP op)
+{
+  T       *typed = reinterpret_cast<T *>(values);
+  const T *data  = reinterpret_cast<const T *>(column.data());
+  if (column.column_type() == Column::Type::CONSTANT_COLUMN) {
+    for (int i = 0; i < rows; i++) {
+      op(typed[slots[i]], data[0]);
+    }
+  } else {
+    for (int i = 0; i < rows; i++) {
+      op(typed[slots[i]], data[i]);
+    }
   }
+}
 
+template <typename T>
+static RC update_values_by_type(AggregateExpr::Type type, char *values, const int *slots, const Column &column, int rows)
+{
+  switch (type) {
+    case AggregateExpr::Type::COUNT: break;  // 使用公共的行数
+    case AggregateExpr::Type::SUM:
+    case AggregateExpr::Type::AVG: {
+      update_values<T>(values, slots, column, rows, [](T &value, T input) { value += input; });
+    } break;
+    case AggregateExpr::Type::MIN: {
+      update_values<T>(values, slots, column, rows, [](T &value, T input) { value = input < value ? input : value; });
+    } break;
+    case AggregateExpr::Type::MAX: {
+      update_values<T>(values, slots, column, rows, [](T &value, T input) { value = input > value ? input : value; });
+    } break;
+    default: {
+      LOG_WARN("unsupported aggregate type: %d", static_cast<int>(type));
+      return RC::UNIMPLEMENTED;
+    }
+  }
   return RC::SUCCESS;
 }
 
-size_t StandardAggregateHashTable::VectorHash::operator()(const vector<Value> &vec) const
+template <typename T>
+static void init_value(AggregateExpr::Type type, char *value)
 {
-  size_t hash_val = 0;
-  for (const auto &elem : vec) {
-    hash_val ^= hash<string>()(elem.to_string());
+  T init = 0;
+  if (type == AggregateExpr::Type::MIN) {
+    init = numeric_limits<T>::max();
+  } else if (type == AggregateExpr::Type::MAX) {
+    init = numeric_limits<T>::lowest();
   }
-  return hash_val;
+  memcpy(value, &init, sizeof(T));
 }
 
-bool StandardAggregateHashTable::VectorEqual::operator()(const vector<Value> &lhs, const vector<Value> &rhs) const
+const int LinearProbingAggregateHashTable::DEFAULT_CAPACITY = 16384;
+
+LinearProbingAggregateHashTable::LinearProbingAggregateHashTable(const vector<Expression *> &aggregations, int capacity)
 {
-  if (lhs.size() != rhs.size()) {
-    return false;
+  for (auto &expr : aggregations) {
+    ASSERT(expr->type() == ExprType::AGGREGATION, "expect aggregate expression");
+    auto *aggregation_expr = static_cast<AggregateExpr *>(expr);
+    aggr_types_.push_back(aggregation_expr->aggregate_type());
+    aggr_child_types_.push_back(aggregation_expr->child()->value_type());
   }
-  for (size_t i = 0; i < lhs.size(); ++i) {
-    if (rhs[i].compare(lhs[i]) != 0) {
-      return false;
-    }
+
+  capacity_ = 1;
+  while (capacity_ < capacity) {
+    capacity_ <<= 1;
   }
-  return true;
 }
 
-// ----------------------------------LinearProbingAggregateHashTable------------------
-#ifdef USE_SIMD
-template <typename V>
-RC LinearProbingAggregateHashTable<V>::add_chunk(Chunk &group_chunk, Chunk &aggr_chunk)
+RC LinearProbingAggregateHashTable::init_layout(const Chunk &group_chunk)
 {
-  if (group_chunk.column_num() != 1 || aggr_chunk.column_num() != 1) {
-    LOG_WARN("group_chunk and aggr_chunk size must be 1.");
-    return RC::INVALID_ARGUMENT;
+  for (size_t i = 0; i < aggr_types_.size(); i++) {
+    bool supported_value = aggr_child_types_[i] == AttrType::INTS || aggr_child_types_[i] == AttrType::FLOATS;
+    if (aggr_types_[i] != AggregateExpr::Type::COUNT && !supported_value) {
+      LOG_WARN("unsupported aggregate value type: %s", attr_type_to_string(aggr_child_types_[i]));
+      return RC::UNIMPLEMENTED;
+    }
   }
-  if (group_chunk.rows() != aggr_chunk.rows()) {
-    LOG_WARN("group_chunk and aggr _chunk rows must be equal.");
-    return RC::INVALID_ARGUMENT;
+
+  key_size_ = 0;
+  for (int i = 0; i < group_chunk.column_num(); i++) {
+    key_offsets_.push_back(key_size_);
+    key_lens_.push_back(group_chunk.column(i).attr_len());
+    key_size_ += group_chunk.column(i).attr_len();
   }
-  add_batch((int *)group_chunk.column(0).data(), (V *)aggr_chunk.column(0).data(), group_chunk.rows());
+
+  keys_.resize(static_cast<size_t>(capacity_) * key_size_);
+  occupied_.assign(capacity_, 0);
+  counts_.assign(capacity_, 0);
+  values_.assign(aggr_types_.size(), vector<char>(static_cast<size_t>(capacity_) * VALUE_SIZE));
+  layout_inited_ = true;
   return RC::SUCCESS;
 }
 
-template <typename V>
-void LinearProbingAggregateHashTable<V>::Scanner::open_scan()
+uint32_t LinearProbingAggregateHashTable::hash_key(const char *key) const
 {
-  capacity_   = static_cast<LinearProbingAggregateHashTable *>(hash_table_)->capacity();
-  size_       = static_cast<LinearProbingAggregateHashTable *>(hash_table_)->size();
-  scan_pos_   = 0;
-  scan_count_ = 0;
+  if (key_size_ == 4) {
+    uint32_t value;
+    memcpy(&value, key, sizeof(value));
+    return hash_int_key(value);
+  }
+  return static_cast<uint32_t>(hash_bytes(key, key_size_));
 }
 
-template <typename V>
-RC LinearProbingAggregateHashTable<V>::Scanner::next(Chunk &output_chunk)
+void LinearProbingAggregateHashTable::serialize_and_hash(const Chunk &group_chunk, int rows)
 {
-  if (scan_pos_ >= capacity_ || scan_count_ >= size_) {
-    return RC::RECORD_EOF;
+  chunk_keys_.resize(static_cast<size_t>(rows) * key_size_);
+  for (int col_idx = 0; col_idx < group_chunk.column_num(); col_idx++) {
+    serialize_group_key(
+        group_chunk.column(col_idx), rows, key_lens_[col_idx], key_size_, chunk_keys_.data() + key_offsets_[col_idx]);
   }
-  auto linear_probing_hash_table = static_cast<LinearProbingAggregateHashTable *>(hash_table_);
-  while (scan_pos_ < capacity_ && scan_count_ < size_ && output_chunk.rows() <= output_chunk.capacity()) {
-    int key;
-    V   value;
-    RC  rc = linear_probing_hash_table->iter_get(scan_pos_, key, value);
-    if (rc == RC::SUCCESS) {
-      output_chunk.column(0).append_one((char *)&key);
-      output_chunk.column(1).append_one((char *)&value);
-      scan_count_++;
+
+  hashes_.resize(rows);
+  const char *key = chunk_keys_.data();
+  for (int row = 0; row < rows; row++, key += key_size_) {
+    hashes_[row] = hash_key(key);
+  }
+}
+
+void LinearProbingAggregateHashTable::init_values(int slot)
+{
+  counts_[slot] = 0;
+  for (size_t i = 0; i < aggr_types_.size(); i++) {
+    char *value = values_[i].data() + slot * VALUE_SIZE;
+    if (aggr_child_types_[i] == AttrType::FLOATS) {
+      init_value<float>(aggr_types_[i], value);
+    } else {
+      init_value<int>(aggr_types_[i], value);
     }
-    scan_pos_++;
   }
-  return RC::SUCCESS;
 }
 
-template <typename V>
-void LinearProbingAggregateHashTable<V>::Scanner::close_scan()
+int LinearProbingAggregateHashTable::find_or_insert(uint32_t index, const char *key)
 {
-  capacity_   = -1;
-  size_       = -1;
-  scan_pos_   = -1;
-  scan_count_ = 0;
+  const uint32_t mask = capacity_ - 1;
+  while (occupied_[index]) {
+    if (memcmp(slot_key(index), key, key_size_) == 0) {
+      return index;
+    }
+    index = (index + 1) & mask;
+  }
+
+  occupied_[index] = 1;
+  memcpy(slot_key(index), key, key_size_);
+  init_values(index);
+  size_++;
+  return index;
 }
 
-template <typename V>
-RC LinearProbingAggregateHashTable<V>::get(int key, V &value)
+#ifdef USE_SIMD
+int LinearProbingAggregateHashTable::probe_batch(int rows)
 {
-  RC  rc          = RC::SUCCESS;
-  int index       = (key % capacity_ + capacity_) % capacity_;
-  int iterate_cnt = 0;
-  while (true) {
-    if (keys_[index] == EMPTY_KEY) {
-      rc = RC::NOT_EXIST;
-      break;
-    } else if (keys_[index] == key) {
-      value = values_[index];
-      break;
-    } else {
-      index += 1;
-      index %= capacity_;
-      iterate_cnt++;
-      if (iterate_cnt > capacity_) {
-        rc = RC::NOT_EXIST;
-        break;
+  const __m256i mask       = _mm256_set1_epi32(capacity_ - 1);
+  const __m256i one        = _mm256_set1_epi32(1);
+  const int    *input_keys = reinterpret_cast<const int *>(chunk_keys_.data());
+  const int    *table_keys = reinterpret_cast<const int *>(keys_.data());
+
+  int row = 0;
+  for (; row + SIMD_WIDTH <= rows; row += SIMD_WIDTH) {
+    // 一次计算 SIMD_WIDTH 个槽位，并 gather 槽位上的分组键和占用标记
+    __m256i keys  = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input_keys + row));
+    __m256i index = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(hashes_.data() + row)), mask);
+    __m256i table_key = _mm256_i32gather_epi32(table_keys, index, 4);
+    __m256i used      = _mm256_i32gather_epi32(occupied_.data(), index, 4);
+    __m256i hit       = _mm256_and_si256(_mm256_cmpeq_epi32(table_key, keys), _mm256_cmpeq_epi32(used, one));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(slots_.data() + row), index);
+
+    // 大部分行在已有分组的第一个槽位上命中。没有命中的行可能是新分组，也可能发生了冲突，从这个槽位开始标量探测
+    int hit_mask = _mm256_movemask_ps(_mm256_castsi256_ps(hit));
+    if (hit_mask != 0xff) {
+      for (int lane = 0; lane < SIMD_WIDTH; lane++) {
+        if ((hit_mask & (1 << lane)) == 0) {
+          slots_[row + lane] =
+              find_or_insert(slots_[row + lane], reinterpret_cast<const char *>(input_keys + row + lane));
+        }
       }
     }
   }
-  return rc;
+  return row;
 }
+#endif
 
-template <typename V>
-RC LinearProbingAggregateHashTable<V>::iter_get(int pos, int &key, V &value)
+void LinearProbingAggregateHashTable::probe(int rows)
 {
+  slots_.resize(rows);
+
+  int row = 0;
+#ifdef USE_SIMD
+  if (key_size_ == 4) {
+    row = probe_batch(rows);
+  }
+#endif
+
+  const uint32_t mask = capacity_ - 1;
+  for (; row < rows; row++) {
+    slots_[row] = find_or_insert(hashes_[row] & mask, chunk_keys_.data() + static_cast<size_t>(row) * key_size_);
+  }
+}
+
+RC LinearProbingAggregateHashTable::update_aggregates(const Chunk &aggr_chunk, int rows)
+{
+  for (int i = 0; i < rows; i++) {
+    counts_[slots_[i]]++;
+  }
+
   RC rc = RC::SUCCESS;
-  if (keys_[pos] == LinearProbingAggregateHashTable<V>::EMPTY_KEY) {
-    rc = RC::NOT_EXIST;
-  } else {
-    key   = keys_[pos];
-    value = values_[pos];
+  for (size_t aggr_idx = 0; aggr_idx < aggr_types_.size(); aggr_idx++) {
+    char         *values = values_[aggr_idx].data();
+    const Column &column = aggr_chunk.column(aggr_idx);
+    if (aggr_child_types_[aggr_idx] == AttrType::FLOATS) {
+      rc = update_values_by_type<float>(aggr_types_[aggr_idx], values, slots_.data(), column, rows);
+    } else {
+      rc = update_values_by_type<int>(aggr_types_[aggr_idx], values, slots_.data(), column, rows);
+    }
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
   }
   return rc;
 }
 
-template <typename V>
-void LinearProbingAggregateHashTable<V>::aggregate(V *value, V value_to_aggregate)
+void LinearProbingAggregateHashTable::reserve(int rows)
 {
-  if (aggregate_type_ == AggregateExpr::Type::SUM) {
-    *value += value_to_aggregate;
-  } else {
-    ASSERT(false, "unsupported aggregate type");
+  int new_capacity = capacity_;
+  while (static_cast<int64_t>(size_ + rows) * 2 > new_capacity) {
+    new_capacity <<= 1;
+  }
+  if (new_capacity != capacity_) {
+    resize(new_capacity);
   }
 }
 
-template <typename V>
-void LinearProbingAggregateHashTable<V>::resize()
+void LinearProbingAggregateHashTable::resize(int new_capacity)
 {
-  capacity_ *= 2;
-  vector<int> new_keys(capacity_);
-  vector<V>   new_values(capacity_);
-
-  for (size_t i = 0; i < keys_.size(); i++) {
-    auto &key   = keys_[i];
-    auto &value = values_[i];
-    if (key != EMPTY_KEY) {
-      int index = (key % capacity_ + capacity_) % capacity_;
-      while (new_keys[index] != EMPTY_KEY) {
-        index = (index + 1) % capacity_;
-      }
-      new_keys[index]   = key;
-      new_values[index] = value;
+  const int            old_capacity = capacity_;
+  vector<char>         old_keys     = std::move(keys_);
+  vector<int>          old_occupied = std::move(occupied_);
+  vector<int>          old_counts   = std::move(counts_);
+  vector<vector<char>> old_values   = std::move(values_);
+
+  capacity_ = new_capacity;
+  keys_.resize(static_cast<size_t>(capacity_) * key_size_);
+  occupied_.assign(capacity_, 0);
+  counts_.assign(capacity_, 0);
+  values_.assign(aggr_types_.size(), vector<char>(static_cast<size_t>(capacity_) * VALUE_SIZE));
+
+  const uint32_t mask = capacity_ - 1;
+  for (int old_slot = 0; old_slot < old_capacity; old_slot++) {
+    if (!old_occupied[old_slot]) {
+      continue;
     }
-  }
 
-  keys_   = std::move(new_keys);
-  values_ = std::move(new_values);
+    // 分组键各不相同，只需要找到空槽位
+    const char *key   = old_keys.data() + static_cast<size_t>(old_slot) * key_size_;
+    uint32_t    index = hash_key(key) & mask;
+    while (occupied_[index]) {
+      index = (index + 1) & mask;
+    }
+
+    occupied_[index] = 1;
+    memcpy(slot_key(index), key, key_size_);
+    counts_[index] = old_counts[old_slot];
+    for (size_t i = 0; i < values_.size(); i++) {
+      memcpy(values_[i].data() + index * VALUE_SIZE, old_values[i].data() + old_slot * VALUE_SIZE, VALUE_SIZE);
+    }
+  }
 }
 
-template <typename V>
-void LinearProbingAggregateHashTable<V>::resize_if_need()
+RC LinearProbingAggregateHashTable::add_chunk(Chunk &group_chunk, Chunk &aggr_chunk)
 {
-  if (size_ >= capacity_ / 2) {
-    resize();
+  if (group_chunk.rows() != aggr_chunk.rows()) {
+    LOG_WARN("group_chunk and aggr_chunk rows must be equal. %d, %d", group_chunk.rows(), aggr_chunk.rows());
+    return RC::INVALID_ARGUMENT;
+  }
+  if (aggr_chunk.column_num() != static_cast<int>(aggr_types_.size())) {
+    LOG_WARN("aggr_chunk column number mismatch: %d, %d", aggr_chunk.column_num(), static_cast<int>(aggr_types_.size()));
+    return RC::INVALID_ARGUMENT;
+  }
+
+  RC rc = RC::SUCCESS;
+  if (!layout_inited_ && OB_FAIL(rc = init_layout(group_chunk))) {
+    return rc;
   }
+
+  const int rows = group_chunk.rows();
+  if (rows == 0) {
+    return RC::SUCCESS;
+  }
+
+  reserve(rows);
+  serialize_and_hash(group_chunk, rows);
+  probe(rows);
+  return update_aggregates(aggr_chunk, rows);
 }
 
-template <typename V>
-void LinearProbingAggregateHashTable<V>::add_batch(int *input_keys, V *input_values, int len)
+void LinearProbingAggregateHashTable::Scanner::open_scan() { scan_pos_ = 0; }
+
+RC LinearProbingAggregateHashTable::Scanner::next(Chunk &output_chunk)
 {
-  // your code here
-  exit(-1);
-
-  // inv (invalid) 表示是否有效，inv[i] = -1 表示有效，inv[i] = 0 表示无效。
-  // key[SIMD_WIDTH],value[SIMD_WIDTH] 表示当前循环中处理的键值对。
-  // off (offset) 表示线性探测冲突时的偏移量，key[i] 每次遇到冲突键，则off[i]++，如果key[i] 已经完成聚合，则off[i] = 0，
-  // i = 0 表示selective load 的起始位置。
-  // inv 全部初始化为 -1
-  // off 全部初始化为 0
-
-  // for (; i + SIMD_WIDTH <= len;) {
-    // 1: 根据 `inv` 变量的值，从 `input_keys` 中 `selective load` `SIMD_WIDTH` 个不同的输入键值对。
-    // 2. 计算 i += |inv|, `|inv|` 表示 `inv` 中有效的个数 
-    // 3. 计算 hash 值，
-    // 4. 根据聚合类型（目前只支持 sum），在哈希表中更新聚合结果。如果本次循环，没有找到key[i] 在哈希表中的位置，则不更新聚合结果。
-    // 5. gather 操作，根据 hash 值将 keys_ 的 gather 结果写入 table_key 中。
-    // 6. 更新 inv 和 off。如果本次循环key[i] 聚合完成，则inv[i]=-1，表示该位置在下次循环中读取新的键值对。
-    // 如果本次循环 key[i] 未在哈希表中聚合完成（table_key[i] != key[i]），则inv[i] = 0，表示该位置在下次循环中不需要读取新的键值对。
-    // 如果本次循环中，key[i]聚合完成，则off[i] 更新为 0，表示线性探测偏移量为 0，key[i] 未完成聚合，则off[i]++,表示线性探测偏移量加 1。
-  // }
-  //7. 通过标量线性探测，处理剩余键值对
-
-  // resize_if_need();
-}
+  auto *table = static_cast<LinearProbingAggregateHashTable *>(hash_table_);
+  if (!table->layout_inited_ || scan_pos_ < 0 || scan_pos_ >= table->capacity_) {
+    return RC::RECORD_EOF;
+  }
 
-template <typename V>
-const int LinearProbingAggregateHashTable<V>::EMPTY_KEY = 0xffffffff;
-template <typename V>
-const int LinearProbingAggregateHashTable<V>::DEFAULT_CAPACITY = 16384;
+  const int key_num = static_cast<int>(table->key_offsets_.size());
+  int       rows    = 0;
+  RC        rc      = RC::SUCCESS;
+  for (; scan_pos_ < table->capacity_ && output_chunk.rows() < output_chunk.capacity(); scan_pos_++) {
+    const int slot = scan_pos_;
+    if (!table->occupied_[slot]) {
+      continue;
+    }
 
-template class LinearProbingAggregateHashTable<int>;
-template class LinearProbingAggregateHashTable<float>;
-#endif
+    for (int i = 0; i < output_chunk.column_num() && OB_SUCC(rc); i++) {
+      int     col_idx = output_chunk.column_ids(i);
+      Column &column  = output_chunk.column(i);
+      if (col_idx < key_num) {
+        rc = column.append_one(table->slot_key(slot) + table->key_offsets_[col_idx]);
+        continue;
+      }
+
+      int aggr_idx = col_idx - key_num;
+      switch (table->aggr_types_[aggr_idx]) {
+        case AggregateExpr::Type::COUNT: {
+          rc = column.append_one(reinterpret_cast<const char *>(&table->counts_[slot]));
+        } break;
+        case AggregateExpr::Type::AVG: {
+          const char *value = table->slot_value(aggr_idx, slot);
+          float       sum   = 0;
+          if (table->aggr_child_types_[aggr_idx] == AttrType::FLOATS) {
+            sum = *reinterpret_cast<const float *>(value);
+          } else {
+            sum = static_cast<float>(*reinterpret_cast<const int *>(value));
+          }
+          float avg = sum / table->counts_[slot];
+          rc        = column.append_one(reinterpret_cast<const char *>(&avg));
+        } break;
+        default: {
+          rc = column.append_one(table->slot_value(aggr_idx, slot));
+        } break;
+      }
+    }
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to output group. rc=%s", strrc(rc));
+      return rc;
+    }
+    rows++;
+  }
+
+  return rows == 0 ? RC::RECORD_EOF : RC::SUCCESS;
+}
+
+void LinearProbingAggregateHashTable::Scanner::close_scan() { scan_pos_ = -1; }
@@ -15,6 +15,8 @@ See the Mulan PSL v2 for more details. */
 #include "common/math/simd_util.h"
 #include "common/sys/rc.h"
 #include "sql/expr/expression.h"
+#include "storage/common/arena_allocator.h"
+#include "storage/common/string_dictionary.h"
 
 /**
  * @brief 用于hash group by 的哈希表实现，不支持并发访问。
@@ -51,21 +53,18 @@ public:
   vector<AttrType>            aggr_child_types_;
 };
 
+/**
+ * @brief 通用的聚合哈希表，支持多个定长的分组列和多个聚合列
+ * @details 使用开放地址法（线性探测）。每个分组在 arena 中占用一段连续的内存，前面是序列化的分组键，
+ * 后面是各个聚合状态。哈希桶中只保存分组的哈希值和地址。
+ * add_chunk 一次处理一个 chunk：先按列批量序列化分组键并计算哈希值，再为每一行查找或创建分组，
+ * 最后按列批量更新聚合状态。处理过程中不会为每一行创建 Value 或者单独申请内存。
+ * 字典编码的字符串分组列在分组键中只保存一个4字节的编号。编号来自哈希表自己的字典，chunk 中的编号通过一个映射表转换，
+ * 字符串的哈希值也只在加入字典时计算一次。哈希值只与字符串的内容有关，不同哈希表中相同分组的哈希值相同，可以按分区合并。
+ */
 class StandardAggregateHashTable : public AggregateHashTable
 {
-private:
-  struct VectorHash
-  {
-    size_t operator()(const vector<Value> &vec) const;
-  };
-
-  struct VectorEqual
-  {
-    bool operator()(const vector<Value> &lhs, const vector<Value> &rhs) const;
-  };
-
 public:
-  using StandardHashTable = unordered_map<vector<Value>, vector<void *>, VectorHash, VectorEqual>;
   class Scanner : public AggregateHashTable::Scanner
   {
   public:
@@ -77,42 +76,95 @@ public:
     RC next(Chunk &chunk) override;
 
   private:
-    StandardHashTable::iterator end_;
-    StandardHashTable::iterator it_;
+    size_t pos_ = 0;  ///< 下一个要输出的分组
   };
-  StandardAggregateHashTable(const vector<Expression *> aggregations)
+
+  StandardAggregateHashTable(const vector<Expression *> aggregations);
+  virtual ~StandardAggregateHashTable() = default;
+
+  RC add_chunk(Chunk &groups_chunk, Chunk &aggrs_chunk) override;
+
+  /**
+   * @brief 把 other 中属于第 partition 个分区的分组合并到当前哈希表中
+   * @details 并行聚合时，每个线程先把自己扫描到的数据聚合到一个线程私有的哈希表中，然后按照分组的哈希值把
+   * 所有分组分成 partition_num 个分区，每个分区由一个线程合并到一个单独的哈希表中，合并时不需要加锁。
+   * other 的分组列和聚合必须与当前哈希表相同。
+   */
+  RC merge(const StandardAggregateHashTable &other, int partition, int partition_num);
+
+  /// 分组的个数
+  size_t size() const { return groups_.size(); }
+
+private:
+  struct Bucket
   {
-    for (auto &expr : aggregations) {
-      ASSERT(expr->type() == ExprType::AGGREGATION, "expect aggregate expression");
-      auto *aggregation_expr = static_cast<AggregateExpr *>(expr);
-      aggr_types_.push_back(aggregation_expr->aggregate_type());
-      aggr_child_types_.push_back(aggregation_expr->value_type());
-    }
-  }
-  virtual ~StandardAggregateHashTable()
+    uint64_t hash  = 0;
+    char    *group = nullptr;  ///< 空指针表示空桶
+  };
+
+  /// 一个分组列使用的字典。列没有使用字典编码时 dictionary 为空
+  struct KeyDictionary
   {
-    for (auto &aggr : aggr_values_) {
-      for (auto &state : aggr.second) {
-        free(state);
-      }
-    }
-  }
+    shared_ptr<StringDictionary>       dictionary;   ///< 分组键中的编号对应的字典
+    vector<uint64_t>                   hashes;       ///< dictionary 中每个字符串的哈希值
+    shared_ptr<const StringDictionary> source;       ///< 最近处理的 chunk 使用的字典
+    vector<int32_t>                    translation;  ///< source 中的编号对应的 dictionary 中的编号
+  };
 
-  RC add_chunk(Chunk &groups_chunk, Chunk &aggrs_chunk) override;
+  /**
+   * @brief 第一次写入数据时，根据分组列确定分组在内存中的布局
+   */
+  RC init_layout(const Chunk &groups_chunk);
+  void copy_layout(const StandardAggregateHashTable &other);
 
-  StandardHashTable::iterator begin() { return aggr_values_.begin(); }
-  StandardHashTable::iterator end() { return aggr_values_.end(); }
+  /**
+   * @brief 把 rows 行分组键序列化到 keys_ 中，并计算每一行的哈希值
+   */
+  void serialize_and_hash(const Chunk &groups_chunk, int rows);
 
-  /// group by values -> aggregate values
-  StandardHashTable aggr_values_;
+  /**
+   * @brief 把一个字典编码的分组列转换成哈希表字典中的编号，写入 keys_
+   */
+  void encode_dictionary_keys(int col_idx, const Column &column, int rows);
+
+  /// 把字符串加入分组列的字典，返回编号
+  int32_t add_to_dictionary(KeyDictionary &key_dict, const char *data, int len);
+
+  char *find_or_create_group(uint64_t hash, const char *key);
+
+  void resize();
+
+private:
+  static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+  bool                  layout_inited_ = false;
+  vector<int>           key_offsets_;     ///< 每个分组列在分组键中的偏移
+  vector<int>           key_lens_;        ///< 每个分组列的长度
+  vector<KeyDictionary> key_dicts_;       ///< 每个分组列的字典
+  vector<int>           state_offsets_;   ///< 每个聚合状态在分组中的偏移
+  int                   key_size_   = 0;  ///< 序列化之后分组键的长度
+  int                   group_size_ = 0;  ///< 一个分组占用的内存
+
+  vector<Bucket> buckets_;
+  vector<char *> groups_;  ///< 按照创建顺序记录所有的分组，用于输出结果
+  Arena          arena_;   ///< 分组和聚合状态的内存
+
+  /// 处理一个 chunk 时使用的临时空间，每次 add_chunk 复用
+  vector<char>     keys_;
+  vector<uint64_t> hashes_;
+  vector<char *>   row_groups_;
 };
 
 /**
  * @brief 线性探测哈希表实现
- * @note 当前只支持group by 列为 char/char(4) 类型，且聚合列为单列。
+ * @details 分组键是若干个定长分组列拼接成的定长键，直接保存在哈希表的槽位中；每个聚合的值按列保存在单独的数组中，
+ * 同一个槽位下标对应同一个分组。支持 COUNT、SUM、MIN、MAX 和 AVG，聚合参数是 int 或 float。
+ * 处理一个 chunk 之前先按照所有行都是新分组的情况扩容，保证负载因子不超过 1/2，
+ * 这样一个 chunk 中计算出来的槽位在更新聚合值之前不会失效。
+ * 分组键是4个字节时（比如单个 int 列），使用 SIMD 的 gather 指令批量探测，参考了论文
+ * `Rethinking SIMD Vectorization for In-Memory Databases` 中的 `Algorithm 5`。没有一次命中的行、其它长度的分组键
+ * 以及没有定义 USE_SIMD 时，使用标量探测。
  */
-#ifdef USE_SIMD
-template <typename V>
 class LinearProbingAggregateHashTable : public AggregateHashTable
 {
 public:
@@ -129,50 +181,78 @@ public:
     void close_scan() override;
 
   private:
-    int capacity_   = -1;
-    int size_       = -1;
-    int scan_pos_   = -1;
-    int scan_count_ = 0;
+    int scan_pos_ = -1;
   };
 
-  LinearProbingAggregateHashTable(AggregateExpr::Type aggregate_type, int capacity = DEFAULT_CAPACITY)
-      : keys_(capacity, EMPTY_KEY), values_(capacity, 0), capacity_(capacity), aggregate_type_(aggregate_type)
-  {}
-  virtual ~LinearProbingAggregateHashTable() {}
-
-  RC get(int key, V &value);
+  static const int DEFAULT_CAPACITY;
 
-  RC iter_get(int pos, int &key, V &value);
+  /**
+   * @param capacity 初始的槽位个数，会向上取整到2的幂
+   */
+  LinearProbingAggregateHashTable(const vector<Expression *> &aggregations, int capacity = DEFAULT_CAPACITY);
+  virtual ~LinearProbingAggregateHashTable() = default;
 
   RC add_chunk(Chunk &group_chunk, Chunk &aggr_chunk) override;
 
-  int capacity() { return capacity_; }
-  int size() { return size_; }
+  int capacity() const { return capacity_; }
+  int size() const { return size_; }
 
 private:
+  RC init_layout(const Chunk &group_chunk);
+
   /**
-   * @brief 将键值对以批量的形式写入哈希表中，这里参考了论文
-   * `Rethinking SIMD Vectorization for In-Memory Databases` 中的 `Algorithm 5`。
-   * @param input_keys 输入的键数组
-   * @param input_values 输入的值数组，与键数组一一对应。
-   * @param len 键值对数组的长度
+   * @brief 把 rows 行分组键序列化到 chunk_keys_ 中，并计算每一行的哈希值
    */
-  void add_batch(int *input_keys, V *input_values, int len);
+  void serialize_and_hash(const Chunk &group_chunk, int rows);
 
-  void aggregate(V *value, V value_to_aggregate);
+  /**
+   * @brief 为每一行找到分组所在的槽位，分组不存在时插入，结果保存在 slots_ 中
+   */
+  void probe(int rows);
 
-  void resize();
+#ifdef USE_SIMD
+  /**
+   * @brief 分组键是4个字节时批量探测
+   * @return int 处理了多少行，剩余不足 SIMD_WIDTH 的行由调用者处理
+   */
+  int probe_batch(int rows);
+#endif
+
+  uint32_t hash_key(const char *key) const;
+
+  /// 从 index 开始线性探测，找到或者插入分组键
+  int find_or_insert(uint32_t index, const char *key);
+
+  RC update_aggregates(const Chunk &aggr_chunk, int rows);
 
-  void resize_if_need();
+  /// 保证再插入 rows 个分组后负载因子不超过 1/2
+  void reserve(int rows);
+  void resize(int new_capacity);
+
+  /// 新分组的聚合值初始化
+  void init_values(int slot);
+
+  char       *slot_key(int slot) { return keys_.data() + static_cast<size_t>(slot) * key_size_; }
+  const char *slot_value(size_t aggr_idx, int slot) const { return values_[aggr_idx].data() + slot * VALUE_SIZE; }
 
 private:
-  static const int EMPTY_KEY;
-  static const int DEFAULT_CAPACITY;
+  static constexpr int VALUE_SIZE = 4;  ///< 聚合值都是 int 或 float
+
+  bool        layout_inited_ = false;
+  vector<int> key_offsets_;  ///< 每个分组列在分组键中的偏移
+  vector<int> key_lens_;     ///< 每个分组列的长度
+  int         key_size_ = 0;
+
+  int capacity_ = 0;
+  int size_     = 0;
+
+  vector<char>         keys_;      ///< 每个槽位的分组键
+  vector<int>          occupied_;  ///< 槽位是否被使用，使用 int 方便 SIMD gather
+  vector<int>          counts_;    ///< 每个分组的行数，COUNT 和 AVG 使用
+  vector<vector<char>> values_;    ///< 每个聚合的值，SUM/MIN/MAX 是聚合结果，AVG 是累加值
 
-  vector<int>         keys_;
-  vector<V>           values_;
-  int                 size_     = 0;
-  int                 capacity_ = 0;
-  AggregateExpr::Type aggregate_type_;
+  /// 处理一个 chunk 时使用的临时空间，每次 add_chunk 复用
+  vector<char>     chunk_keys_;
+  vector<uint32_t> hashes_;
+  vector<int>      slots_;
 };
-#endif  // USE_SIMD
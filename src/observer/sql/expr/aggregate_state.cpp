@@ -45,35 +45,65 @@ void CountState<T>::update(const T *values, int size)
   value += size;
 }
 
-void* create_aggregate_state(AggregateExpr::Type aggr_type, AttrType attr_type)
+int aggregate_state_size(AggregateExpr::Type aggr_type, AttrType attr_type)
 {
-  void* state_ptr = nullptr;
   if (aggr_type == AggregateExpr::Type::SUM) {
     if (attr_type == AttrType::INTS) {
-      state_ptr = malloc(sizeof(SumState<int>));
-      new (state_ptr) SumState<int>();
+      return sizeof(SumState<int>);
+    } else if (attr_type == AttrType::FLOATS) {
+      return sizeof(SumState<float>);
+    }
+  } else if (aggr_type == AggregateExpr::Type::COUNT) {
+    return sizeof(CountState<int>);
+  } else if (aggr_type == AggregateExpr::Type::AVG) {
+    if (attr_type == AttrType::INTS) {
+      return sizeof(AvgState<int>);
     } else if (attr_type == AttrType::FLOATS) {
-      state_ptr = malloc(sizeof(SumState<float>));
-      new (state_ptr) SumState<float>();
+      return sizeof(AvgState<float>);
+    }
+  }
+  return 0;
+}
+
+RC init_aggregate_state(void *state, AggregateExpr::Type aggr_type, AttrType attr_type)
+{
+  if (aggr_type == AggregateExpr::Type::SUM) {
+    if (attr_type == AttrType::INTS) {
+      new (state) SumState<int>();
+    } else if (attr_type == AttrType::FLOATS) {
+      new (state) SumState<float>();
     } else {
       LOG_WARN("unsupported aggregate value type");
+      return RC::UNIMPLEMENTED;
     }
   } else if (aggr_type == AggregateExpr::Type::COUNT) {
-    state_ptr = malloc(sizeof(CountState<int>));
-    new (state_ptr) CountState<int>();
+    new (state) CountState<int>();
   } else if (aggr_type == AggregateExpr::Type::AVG) {
     if (attr_type == AttrType::INTS) {
-      state_ptr = malloc(sizeof(AvgState<int>));
-      new (state_ptr) AvgState<int>();
+      new (state) AvgState<int>();
     } else if (attr_type == AttrType::FLOATS) {
-      state_ptr = malloc(sizeof(AvgState<float>));
-      new (state_ptr) AvgState<float>();
+      new (state) AvgState<float>();
     } else {
       LOG_WARN("unsupported aggregate value type");
+      return RC::UNIMPLEMENTED;
     }
   } else {
     LOG_WARN("unsupported aggregator type");
+    return RC::UNIMPLEMENTED;
+  }
+  return RC::SUCCESS;
+}
+
+void* create_aggregate_state(AggregateExpr::Type aggr_type, AttrType attr_type)
+{
+  int size = aggregate_state_size(aggr_type, attr_type);
+  if (size == 0) {
+    LOG_WARN("unsupported aggregate. aggr type=%d, value type=%s", static_cast<int>(aggr_type), attr_type_to_string(attr_type));
+    return nullptr;
   }
+
+  void *state_ptr = malloc(size);
+  init_aggregate_state(state_ptr, aggr_type, attr_type);
   return state_ptr;
 }
 
@@ -183,6 +213,90 @@ RC aggregate_state_update_by_column(void *state, AggregateExpr::Type aggr_type,
   return rc;
 }
 
+template <class STATE, typename T>
+void update_group_states(char *const *groups, int state_offset, const Column &column, int rows)
+{
+  const T *data = reinterpret_cast<const T *>(column.data());
+  if (column.column_type() == Column::Type::CONSTANT_COLUMN) {
+    for (int i = 0; i < rows; i++) {
+      reinterpret_cast<STATE *>(groups[i] + state_offset)->update(data[0]);
+    }
+  } else {
+    for (int i = 0; i < rows; i++) {
+      reinterpret_cast<STATE *>(groups[i] + state_offset)->update(data[i]);
+    }
+  }
+}
+
+RC aggregate_state_update_by_groups(char *const *groups, int state_offset, AggregateExpr::Type aggr_type,
+    AttrType attr_type, const Column &col, int rows)
+{
+  RC rc = RC::SUCCESS;
+  if (aggr_type == AggregateExpr::Type::SUM) {
+    if (attr_type == AttrType::INTS) {
+      update_group_states<SumState<int>, int>(groups, state_offset, col, rows);
+    } else if (attr_type == AttrType::FLOATS) {
+      update_group_states<SumState<float>, float>(groups, state_offset, col, rows);
+    } else {
+      LOG_WARN("unsupported aggregate value type");
+      rc = RC::UNIMPLEMENTED;
+    }
+  } else if (aggr_type == AggregateExpr::Type::COUNT) {
+    for (int i = 0; i < rows; i++) {
+      reinterpret_cast<CountState<int> *>(groups[i] + state_offset)->value++;
+    }
+  } else if (aggr_type == AggregateExpr::Type::AVG) {
+    if (attr_type == AttrType::INTS) {
+      update_group_states<AvgState<int>, int>(groups, state_offset, col, rows);
+    } else if (attr_type == AttrType::FLOATS) {
+      update_group_states<AvgState<float>, float>(groups, state_offset, col, rows);
+    } else {
+      LOG_WARN("unsupported aggregate value type");
+      rc = RC::UNIMPLEMENTED;
+    }
+  } else {
+    LOG_WARN("unsupported aggregator type");
+    rc = RC::UNIMPLEMENTED;
+  }
+  return rc;
+}
+
+template <class STATE>
+void merge_state(void *state, const void *other)
+{
+  reinterpret_cast<STATE *>(state)->merge(*reinterpret_cast<const STATE *>(other));
+}
+
+RC aggregate_state_merge(void *state, const void *other, AggregateExpr::Type aggr_type, AttrType attr_type)
+{
+  RC rc = RC::SUCCESS;
+  if (aggr_type == AggregateExpr::Type::SUM) {
+    if (attr_type == AttrType::INTS) {
+      merge_state<SumState<int>>(state, other);
+    } else if (attr_type == AttrType::FLOATS) {
+      merge_state<SumState<float>>(state, other);
+    } else {
+      LOG_WARN("unsupported aggregate value type");
+      rc = RC::UNIMPLEMENTED;
+    }
+  } else if (aggr_type == AggregateExpr::Type::COUNT) {
+    merge_state<CountState<int>>(state, other);
+  } else if (aggr_type == AggregateExpr::Type::AVG) {
+    if (attr_type == AttrType::INTS) {
+      merge_state<AvgState<int>>(state, other);
+    } else if (attr_type == AttrType::FLOATS) {
+      merge_state<AvgState<float>>(state, other);
+    } else {
+      LOG_WARN("unsupported aggregate value type");
+      rc = RC::UNIMPLEMENTED;
+    }
+  } else {
+    LOG_WARN("unsupported aggregator type");
+    rc = RC::UNIMPLEMENTED;
+  }
+  return rc;
+}
+
 template class SumState<int>;
 template class SumState<float>;
 
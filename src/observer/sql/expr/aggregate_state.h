@@ -8,6 +8,8 @@ EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
 MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
+#pragma once
+
 #include "sql/expr/expression.h"
 #include "common/type/attr_type.h"
 template <class T>
@@ -18,6 +20,7 @@ public:
   T    value;
   void update(const T *values, int size);
   void update(const T &value) { this->value += value; }
+  void merge(const SumState &other) { value += other.value; }
   template <class U>
   U finalize()
   {
@@ -33,6 +36,7 @@ public:
   int  value;
   void update(const T *values, int size);
   void update(const T &value) { this->value++; }
+  void merge(const CountState &other) { value += other.value; }
   template <class U>
   U finalize()
   {
@@ -53,6 +57,11 @@ public:
     this->value += value;
     this->count++;
   }
+  void merge(const AvgState &other)
+  {
+    value += other.value;
+    count += other.count;
+  }
   template <class U>
   U finalize()
   {
@@ -60,9 +69,36 @@ public:
   }
 };
 
+/**
+ * @brief 聚合状态占用的内存大小
+ * @return int 不支持的聚合类型返回0
+ */
+int aggregate_state_size(AggregateExpr::Type aggr_type, AttrType attr_type);
+
+/**
+ * @brief 在调用者提供的内存上初始化聚合状态，内存大小至少是 aggregate_state_size
+ * @details 聚合状态都不需要析构，内存可以直接释放
+ */
+RC init_aggregate_state(void *state, AggregateExpr::Type aggr_type, AttrType attr_type);
+
 void *create_aggregate_state(AggregateExpr::Type aggr_type, AttrType attr_type);
 
 RC aggregate_state_update_by_value(void *state, AggregateExpr::Type aggr_type, AttrType attr_type, const Value &val);
 RC aggregate_state_update_by_column(void *state, AggregateExpr::Type aggr_type, AttrType attr_type, Column &col);
 
+/**
+ * @brief 使用一列数据批量更新多个分组的聚合状态
+ * @details 类型只在进入循环前判断一次，循环中直接按照类型读取列数据更新状态
+ * @param groups 每一行所属的分组，groups[i] + state_offset 是第 i 行对应的聚合状态
+ * @param rows 行数。COUNT 不读取列数据
+ */
+RC aggregate_state_update_by_groups(char *const *groups, int state_offset, AggregateExpr::Type aggr_type,
+    AttrType attr_type, const Column &col, int rows);
+
+/**
+ * @brief 把 other 的聚合结果合并到 state 中，两个状态的聚合类型和参数类型必须相同
+ * @details 并行聚合时，每个线程先在自己的状态上聚合，最后再合并到一起
+ */
+RC aggregate_state_merge(void *state, const void *other, AggregateExpr::Type aggr_type, AttrType attr_type);
+
 RC finialize_aggregate_state(void *state, AggregateExpr::Type aggr_type, AttrType attr_type, Column &col);
\ No newline at end of file
@@ -35,3 +35,22 @@ public:
   RC accumulate(const Value &value) override;
   RC evaluate(Value &result) override;
 };
+
+/**
+ * @brief 聚合器的删除器
+ * @details 聚合器可能在 Arena 中分配（比如 hash group by 中每个分组的聚合器），这时只调用析构函数，
+ * 内存随 Arena 一起释放；否则按照普通的堆内存释放。
+ */
+struct AggregatorDeleter
+{
+  bool in_arena = false;  ///< 聚合器是否在 Arena 中分配
+
+  void operator()(Aggregator *aggregator) const
+  {
+    if (in_arena) {
+      aggregator->~Aggregator();
+    } else {
+      delete aggregator;
+    }
+  }
+};
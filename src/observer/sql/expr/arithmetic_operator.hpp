@@ -14,6 +14,8 @@ See the Mulan PSL v2 for more details. */
 #include "common/math/simd_util.h"
 #endif
 
+#include "common/defs.h"
+#include "common/lang/limits.h"
 #include "storage/common/column.h"
 
 struct Equal
@@ -149,11 +151,11 @@ struct SubtractOperator
   {
     return left - right;
   }
-  // your code here
+
 #if defined(USE_SIMD)
-  static inline __m256 operation(__m256 left, __m256 right) { exit(-1); }
+  static inline __m256 operation(__m256 left, __m256 right) { return _mm256_sub_ps(left, right); }
 
-  static inline __m256i operation(__m256i left, __m256i right) { exit(-1); }
+  static inline __m256i operation(__m256i left, __m256i right) { return _mm256_sub_epi32(left, right); }
 #endif
 };
 
@@ -164,11 +166,11 @@ struct MultiplyOperator
   {
     return left * right;
   }
-// your code here
+
 #if defined(USE_SIMD)
-  static inline __m256 operation(__m256 left, __m256 right) { exit(-1); }
+  static inline __m256 operation(__m256 left, __m256 right) { return _mm256_mul_ps(left, right); }
 
-  static inline __m256i operation(__m256i left, __m256i right) { exit(-1); }
+  static inline __m256i operation(__m256i left, __m256i right) { return _mm256_mullo_epi32(left, right); }
 #endif
 };
 
@@ -177,12 +179,24 @@ struct DivideOperator
   template <class T>
   static inline T operation(T left, T right)
   {
-    // TODO: `right = 0` is invalid
+    // 与 FloatType::divide 一致，除数为 0 时结果为最大值（miniob 没有 NULL）
+    if constexpr (is_floating_point<T>::value) {
+      if (right > -EPSILON && right < EPSILON) {
+        return numeric_limits<T>::max();
+      }
+    } else if (right == 0) {
+      return numeric_limits<T>::max();
+    }
     return left / right;
   }
 
 #if defined(USE_SIMD)
-  static inline __m256  operation(__m256 left, __m256 right) { return _mm256_div_ps(left, right); }
+  static inline __m256 operation(__m256 left, __m256 right)
+  {
+    const __m256 abs_right = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), right);
+    const __m256 zero_mask = _mm256_cmp_ps(abs_right, _mm256_set1_ps(static_cast<float>(EPSILON)), _CMP_LT_OQ);
+    return _mm256_blendv_ps(_mm256_div_ps(left, right), _mm256_set1_ps(numeric_limits<float>::max()), zero_mask);
+  }
   static inline __m256i operation(__m256i left, __m256i right)
   {
 
@@ -271,7 +285,7 @@ void compare_operation(T *left, T *right, int n, vector<uint8_t> &result)
 }
 
 template <bool LEFT_CONSTANT, bool RIGHT_CONSTANT, typename T, class OP>
-void binary_operator(T *left_data, T *right_data, T *result_data, int size)
+void binary_operator(const T *left_data, const T *right_data, T *result_data, int size)
 {
 #if defined(USE_SIMD)
   int i = 0;
@@ -332,7 +346,7 @@ void binary_operator(T *left_data, T *right_data, T *result_data, int size)
 }
 
 template <bool CONSTANT, typename T, class OP>
-void unary_operator(T *input, T *result_data, int size)
+void unary_operator(const T *input, T *result_data, int size)
 {
   for (int i = 0; i < size; i++) {
     auto &value    = input[CONSTANT ? 0 : i];
@@ -340,6 +354,44 @@ void unary_operator(T *input, T *result_data, int size)
   }
 }
 
+/**
+ * @brief 只计算 rows 中列出的行，用于过滤之后只剩少量记录的情况，其它行的结果不会被修改
+ */
+template <bool LEFT_CONSTANT, bool RIGHT_CONSTANT, typename T, class OP>
+void selected_binary_operator(const T *left_data, const T *right_data, T *result_data, const int *rows, int count)
+{
+  for (int j = 0; j < count; j++) {
+    const int i    = rows[j];
+    result_data[i] = OP::template operation<T>(left_data[LEFT_CONSTANT ? 0 : i], right_data[RIGHT_CONSTANT ? 0 : i]);
+  }
+}
+
+template <bool CONSTANT, typename T, class OP>
+void selected_unary_operator(const T *input, T *result_data, const int *rows, int count)
+{
+  for (int j = 0; j < count; j++) {
+    const int i    = rows[j];
+    result_data[i] = OP::template operation<T>(input[CONSTANT ? 0 : i]);
+  }
+}
+
+/**
+ * @brief 数值类型之间的转换，比如 INTS 转换成 FLOATS。rows 不为空时只转换列出的行
+ */
+template <typename FROM, typename TO>
+void cast_operator(const FROM *input, TO *result_data, int size, const int *rows = nullptr)
+{
+  if (rows == nullptr) {
+    for (int i = 0; i < size; i++) {
+      result_data[i] = static_cast<TO>(input[i]);
+    }
+  } else {
+    for (int j = 0; j < size; j++) {
+      result_data[rows[j]] = static_cast<TO>(input[rows[j]]);
+    }
+  }
+}
+
 // TODO: optimized with simd
 template <typename T, bool LEFT_CONSTANT, bool RIGHT_CONSTANT>
 void compare_result(T *left, T *right, int n, vector<uint8_t> &result, CompOp op)
@@ -15,9 +15,82 @@ See the Mulan PSL v2 for more details. */
 #include "sql/expr/expression.h"
 #include "sql/expr/tuple.h"
 #include "sql/expr/arithmetic_operator.hpp"
+#include "event/session_event.h"
+#include "session/session.h"
+#include "storage/common/arena_allocator.h"
 
 using namespace std;
 
+/// 选中的行少于 1/SPARSE_SELECT_RATIO 时只计算选中的行，否则计算所有的行，可以使用 SIMD
+static constexpr int SPARSE_SELECT_RATIO = 4;
+
+/**
+ * @brief 选中的行比较少时返回这些行的下标
+ * @return 返回空指针表示需要计算所有的行
+ */
+static const vector<int> *selected_rows(const vector<uint8_t> *select, int size, vector<int> &rows)
+{
+  if (select == nullptr) {
+    return nullptr;
+  }
+  rows.clear();
+  for (int i = 0; i < size; i++) {
+    if ((*select)[i]) {
+      rows.push_back(i);
+    }
+  }
+  return static_cast<int>(rows.size()) * SPARSE_SELECT_RATIO < size ? &rows : nullptr;
+}
+
+/// 可以直接使用 arithmetic_operator.hpp 中的函数计算的列
+static bool is_numeric_column(const Column &column)
+{
+  return column.column_type() != Column::Type::DICTIONARY_COLUMN && column.attr_len() == sizeof(int32_t) &&
+         (column.attr_type() == AttrType::INTS || column.attr_type() == AttrType::DATES ||
+             column.attr_type() == AttrType::FLOATS);
+}
+
+/**
+ * @brief 逐行计算表达式的值写到 column 中，用于没有向量化实现的类型
+ * @details 结果是 INTS/FLOATS 时只计算 rows 中列出的行（rows 为空时计算所有的行）；
+ * 其它类型的结果长度不固定，需要计算所有的行之后才能确定列的长度。
+ */
+static RC calc_column_by_row(
+    AttrType type, int size, const vector<int> *rows, const function<RC(int, Value &)> &calc_row, Column &column)
+{
+  RC    rc = RC::SUCCESS;
+  Value value;
+  if (type == AttrType::INTS || type == AttrType::FLOATS) {
+    column.init(type, sizeof(int32_t), size);
+    column.set_count(size);
+    const int count = rows != nullptr ? static_cast<int>(rows->size()) : size;
+    for (int j = 0; j < count; j++) {
+      const int i = rows != nullptr ? (*rows)[j] : j;
+      if (OB_FAIL(rc = calc_row(i, value))) {
+        return rc;
+      }
+      memcpy(column.data() + static_cast<size_t>(i) * sizeof(int32_t), value.data(), sizeof(int32_t));
+    }
+    return rc;
+  }
+
+  vector<Value> values(size);
+  int           attr_len = 1;
+  for (int i = 0; i < size; i++) {
+    if (OB_FAIL(rc = calc_row(i, values[i]))) {
+      return rc;
+    }
+    attr_len = max(attr_len, values[i].length());
+  }
+  column.init(type, attr_len, size);
+  for (const Value &value : values) {
+    if (OB_FAIL(rc = column.append_value(value))) {
+      return rc;
+    }
+  }
+  return rc;
+}
+
 RC FieldExpr::get_value(const Tuple &tuple, Value &value) const
 {
   return tuple.find_cell(TupleCellSpec(table_name(), field_name()), value);
@@ -71,6 +144,60 @@ RC ValueExpr::get_column(Chunk &chunk, Column &column)
   return RC::SUCCESS;
 }
 
+/////////////////////////////////////////////////////////////////////////////////
+bool ParamExpr::equal(const Expression &other) const
+{
+  if (this == &other) {
+    return true;
+  }
+  if (other.type() != ExprType::PARAM) {
+    return false;
+  }
+  const auto &other_param_expr = static_cast<const ParamExpr &>(other);
+  return index_ == other_param_expr.index_ && value_type_ == other_param_expr.value_type_;
+}
+
+RC ParamExpr::bound_value(int index, Value &value)
+{
+  Session      *session = Session::current_session();
+  SessionEvent *request = session != nullptr ? session->current_request() : nullptr;
+  if (nullptr == request || index < 0 || index >= static_cast<int>(request->params().size())) {
+    LOG_WARN("parameter is not bound. index=%d", index);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  value = request->params()[index];
+  return RC::SUCCESS;
+}
+
+RC ParamExpr::get_value(const Tuple &tuple, Value &value) const { return param_value(value); }
+
+RC ParamExpr::get_column(Chunk &chunk, Column &column)
+{
+  Value value;
+  RC    rc = param_value(value);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  column.init(value, chunk.rows());
+  return RC::SUCCESS;
+}
+
+RC ParamExpr::param_value(Value &value) const
+{
+  Value param;
+  RC    rc = bound_value(index_, param);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  if (value_type_ == AttrType::UNDEFINED || param.attr_type() == value_type_) {
+    value = std::move(param);
+    return RC::SUCCESS;
+  }
+  return Value::cast_to(param, value_type_, value);
+}
+
 /////////////////////////////////////////////////////////////////////////////////
 CastExpr::CastExpr(unique_ptr<Expression> child, AttrType cast_type) : child_(std::move(child)), cast_type_(cast_type)
 {}
@@ -99,24 +226,55 @@ RC CastExpr::get_value(const Tuple &tuple, Value &result) const
   return cast(value, result);
 }
 
-RC CastExpr::get_column(Chunk &chunk, Column &column)
+RC CastExpr::get_column(Chunk &chunk, Column &column) { return cast_column(chunk, nullptr, column); }
+
+RC CastExpr::get_selected_column(Chunk &chunk, const vector<uint8_t> &select, Column &column)
 {
+  return cast_column(chunk, &select, column);
+}
+
+RC CastExpr::cast_column(Chunk &chunk, const vector<uint8_t> *select, Column &column)
+{
+  if (child_->value_type() == cast_type_) {
+    return select != nullptr ? child_->get_selected_column(chunk, *select, column) : child_->get_column(chunk, column);
+  }
+
   Column child_column;
-  RC rc = child_->get_column(chunk, child_column);
+  RC     rc = select != nullptr ? child_->get_selected_column(chunk, *select, child_column)
+                                : child_->get_column(chunk, child_column);
   if (rc != RC::SUCCESS) {
     return rc;
   }
-  column.init(cast_type_, child_column.attr_len());
-  for (int i = 0; i < child_column.count(); ++i) {
-    Value value = child_column.get_value(i);
+
+  const int size = child_column.count();
+  if (child_column.column_type() == Column::Type::CONSTANT_COLUMN) {
     Value cast_value;
-    rc = cast(value, cast_value);
-    if (rc != RC::SUCCESS) {
+    if (OB_FAIL(rc = cast(child_column.get_value(0), cast_value))) {
       return rc;
     }
-    column.append_value(cast_value);
+    column.init(cast_value, size);
+    return rc;
   }
-  return rc;
+
+  vector<int>        rows;
+  const vector<int> *selected = selected_rows(select, size, rows);
+  if (child_column.attr_type() == AttrType::INTS && cast_type_ == AttrType::FLOATS && is_numeric_column(child_column)) {
+    column.init(AttrType::FLOATS, sizeof(float), size);
+    column.set_count(size);
+    const int *input  = reinterpret_cast<const int *>(child_column.data());
+    float     *result = reinterpret_cast<float *>(column.data());
+    if (selected == nullptr) {
+      cast_operator(input, result, size);
+    } else {
+      cast_operator(input, result, static_cast<int>(selected->size()), selected->data());
+    }
+    return rc;
+  }
+
+  return calc_column_by_row(
+      cast_type_, size, selected,
+      [&](int i, Value &cast_value) { return cast(child_column.get_value(i), cast_value); },
+      column);
 }
 
 RC CastExpr::try_get_value(Value &result) const
@@ -224,12 +382,13 @@ RC ComparisonExpr::eval(Chunk &chunk, vector<uint8_t> &select)
   Column left_column;
   Column right_column;
 
-  rc = left_->get_column(chunk, left_column);
+  // 前面的过滤条件已经排除的行不需要再计算
+  rc = left_->get_selected_column(chunk, select, left_column);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to get value of left expression. rc=%s", strrc(rc));
     return rc;
   }
-  rc = right_->get_column(chunk, right_column);
+  rc = right_->get_selected_column(chunk, select, right_column);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to get value of right expression. rc=%s", strrc(rc));
     return rc;
@@ -243,6 +402,30 @@ RC ComparisonExpr::eval(Chunk &chunk, vector<uint8_t> &select)
   } else if (left_column.attr_type() == AttrType::FLOATS) {
     rc = compare_column<float>(left_column, right_column, select);
   } else if (left_column.attr_type() == AttrType::CHARS) {
+    const bool left_const    = left_column.column_type() == Column::Type::CONSTANT_COLUMN;
+    const bool right_const   = right_column.column_type() == Column::Type::CONSTANT_COLUMN;
+    const bool left_encoded  = left_column.column_type() == Column::Type::DICTIONARY_COLUMN;
+    const bool right_encoded = right_column.column_type() == Column::Type::DICTIONARY_COLUMN;
+    rc                       = RC::UNSUPPORTED;
+    if (left_encoded && right_const) {
+      rc = compare_dictionary_column(left_column, right_column.get_value(0), false, select);
+    } else if (left_const && right_encoded) {
+      rc = compare_dictionary_column(right_column, left_column.get_value(0), true, select);
+    } else if (left_encoded && right_encoded && left_column.dictionary() == right_column.dictionary() &&
+               (comp_ == EQUAL_TO || comp_ == NOT_EQUAL)) {
+      // 使用同一个字典的两列直接比较编号
+      const int32_t *left_codes  = left_column.codes();
+      const int32_t *right_codes = right_column.codes();
+      const bool     equal       = comp_ == EQUAL_TO;
+      for (int i = 0; i < left_column.count(); i++) {
+        select[i] &= ((left_codes[i] == right_codes[i]) == equal) ? 1 : 0;
+      }
+      rc = RC::SUCCESS;
+    }
+    if (rc != RC::UNSUPPORTED) {
+      return rc;
+    }
+
     int rows = 0;
     if (left_column.column_type() == Column::Type::CONSTANT_COLUMN) {
       rows = right_column.count();
@@ -268,6 +451,49 @@ RC ComparisonExpr::eval(Chunk &chunk, vector<uint8_t> &select)
   return rc;
 }
 
+RC ComparisonExpr::compare_dictionary_column(
+    const Column &column, const Value &constant, bool constant_left, vector<uint8_t> &result) const
+{
+  const StringDictionary &dictionary = *column.dictionary();
+  const int32_t          *codes      = column.codes();
+  const int               rows       = column.count();
+
+  if (comp_ == EQUAL_TO || comp_ == NOT_EQUAL) {
+    // 字典中没有的字符串与所有行都不相等
+    const int32_t code  = dictionary.find(constant.data(), strnlen(constant.data(), constant.length()));
+    const bool    equal = comp_ == EQUAL_TO;
+    for (int i = 0; i < rows; i++) {
+      result[i] &= ((codes[i] == code) == equal) ? 1 : 0;
+    }
+    return RC::SUCCESS;
+  }
+
+  if (dictionary.size() > rows) {
+    return RC::UNSUPPORTED;
+  }
+
+  vector<uint8_t> code_results(dictionary.size());
+  for (int32_t code = 0; code < dictionary.size(); code++) {
+    string_view str = dictionary.get(code);
+    Value       value;
+    value.set_string(str.data(), static_cast<int>(str.size()));
+
+    bool compare_result = false;
+    RC   rc             = constant_left ? compare_value(constant, value, compare_result)
+                                        : compare_value(value, constant, compare_result);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to compare dictionary entry. rc=%s", strrc(rc));
+      return rc;
+    }
+    code_results[code] = compare_result ? 1 : 0;
+  }
+
+  for (int i = 0; i < rows; i++) {
+    result[i] &= code_results[codes[i]];
+  }
+  return RC::SUCCESS;
+}
+
 template <typename T>
 RC ComparisonExpr::compare_column(const Column &left, const Column &right, vector<uint8_t> &result) const
 {
@@ -319,6 +545,37 @@ RC ConjunctionExpr::get_value(const Tuple &tuple, Value &value) const
   return rc;
 }
 
+RC ConjunctionExpr::eval(Chunk &chunk, vector<uint8_t> &select)
+{
+  RC rc = RC::SUCCESS;
+  if (conjunction_type_ == Type::AND) {
+    for (unique_ptr<Expression> &expr : children_) {
+      if (OB_FAIL(rc = expr->eval(chunk, select))) {
+        LOG_WARN("failed to eval child expression. rc=%s", strrc(rc));
+        return rc;
+      }
+    }
+    return rc;
+  }
+
+  vector<uint8_t> matched(select.size(), 0);
+  vector<uint8_t> child_select(select.size());
+  for (unique_ptr<Expression> &expr : children_) {
+    for (size_t i = 0; i < select.size(); i++) {
+      child_select[i] = select[i] & (matched[i] ^ 1);
+    }
+    if (OB_FAIL(rc = expr->eval(chunk, child_select))) {
+      LOG_WARN("failed to eval child expression. rc=%s", strrc(rc));
+      return rc;
+    }
+    for (size_t i = 0; i < select.size(); i++) {
+      matched[i] |= child_select[i];
+    }
+  }
+  select.swap(matched);
+  return rc;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 ArithmeticExpr::ArithmeticExpr(ArithmeticExpr::Type type, Expression *left, Expression *right)
@@ -337,8 +594,13 @@ bool ArithmeticExpr::equal(const Expression &other) const
     return false;
   }
   auto &other_arith_expr = static_cast<const ArithmeticExpr &>(other);
-  return arithmetic_type_ == other_arith_expr.arithmetic_type() && left_->equal(*other_arith_expr.left_) &&
-         right_->equal(*other_arith_expr.right_);
+  if (arithmetic_type_ != other_arith_expr.arithmetic_type() || !left_->equal(*other_arith_expr.left_)) {
+    return false;
+  }
+  if (!right_ || !other_arith_expr.right_) {
+    return !right_ && !other_arith_expr.right_;
+  }
+  return right_->equal(*other_arith_expr.right_);
 }
 AttrType ArithmeticExpr::value_type() const
 {
@@ -391,72 +653,82 @@ RC ArithmeticExpr::calc_value(const Value &left_value, const Value &right_value,
   return rc;
 }
 
-template <bool LEFT_CONSTANT, bool RIGHT_CONSTANT>
-RC ArithmeticExpr::execute_calc(
-    const Column &left, const Column &right, Column &result, Type type, AttrType attr_type) const
+template <bool LEFT_CONSTANT, bool RIGHT_CONSTANT, typename T, class OP>
+static void binary_calc(const T *left, const T *right, T *result, int size, const vector<int> *rows)
+{
+  if (rows == nullptr) {
+    binary_operator<LEFT_CONSTANT, RIGHT_CONSTANT, T, OP>(left, right, result, size);
+  } else {
+    selected_binary_operator<LEFT_CONSTANT, RIGHT_CONSTANT, T, OP>(
+        left, right, result, rows->data(), static_cast<int>(rows->size()));
+  }
+}
+
+/**
+ * @brief 左右两边已经是结果的类型 T 之后计算
+ * @param rows 不为空时只计算其中列出的行
+ */
+template <bool LEFT_CONSTANT, bool RIGHT_CONSTANT, typename T>
+static void execute_calc(
+    ArithmeticExpr::Type type, const T *left, const T *right, T *result, int size, const vector<int> *rows)
 {
-  RC rc = RC::SUCCESS;
   switch (type) {
-    case Type::ADD: {
-      if (attr_type == AttrType::INTS) {
-        binary_operator<LEFT_CONSTANT, RIGHT_CONSTANT, int, AddOperator>(
-            (int *)left.data(), (int *)right.data(), (int *)result.data(), result.capacity());
-      } else if (attr_type == AttrType::FLOATS) {
-        binary_operator<LEFT_CONSTANT, RIGHT_CONSTANT, float, AddOperator>(
-            (float *)left.data(), (float *)right.data(), (float *)result.data(), result.capacity());
-      } else {
-        rc = RC::UNIMPLEMENTED;
-      }
+    case ArithmeticExpr::Type::ADD: {
+      binary_calc<LEFT_CONSTANT, RIGHT_CONSTANT, T, AddOperator>(left, right, result, size, rows);
     } break;
-    case Type::SUB:
-      if (attr_type == AttrType::INTS) {
-        binary_operator<LEFT_CONSTANT, RIGHT_CONSTANT, int, SubtractOperator>(
-            (int *)left.data(), (int *)right.data(), (int *)result.data(), result.capacity());
-      } else if (attr_type == AttrType::FLOATS) {
-        binary_operator<LEFT_CONSTANT, RIGHT_CONSTANT, float, SubtractOperator>(
-            (float *)left.data(), (float *)right.data(), (float *)result.data(), result.capacity());
-      } else {
-        rc = RC::UNIMPLEMENTED;
-      }
-      break;
-    case Type::MUL:
-      if (attr_type == AttrType::INTS) {
-        binary_operator<LEFT_CONSTANT, RIGHT_CONSTANT, int, MultiplyOperator>(
-            (int *)left.data(), (int *)right.data(), (int *)result.data(), result.capacity());
-      } else if (attr_type == AttrType::FLOATS) {
-        binary_operator<LEFT_CONSTANT, RIGHT_CONSTANT, float, MultiplyOperator>(
-            (float *)left.data(), (float *)right.data(), (float *)result.data(), result.capacity());
-      } else {
-        rc = RC::UNIMPLEMENTED;
-      }
-      break;
-    case Type::DIV:
-      if (attr_type == AttrType::INTS) {
-        binary_operator<LEFT_CONSTANT, RIGHT_CONSTANT, int, DivideOperator>(
-            (int *)left.data(), (int *)right.data(), (int *)result.data(), result.capacity());
-      } else if (attr_type == AttrType::FLOATS) {
-        binary_operator<LEFT_CONSTANT, RIGHT_CONSTANT, float, DivideOperator>(
-            (float *)left.data(), (float *)right.data(), (float *)result.data(), result.capacity());
-      } else {
-        rc = RC::UNIMPLEMENTED;
-      }
-      break;
-    case Type::NEGATIVE:
-      if (attr_type == AttrType::INTS) {
-        unary_operator<LEFT_CONSTANT, int, NegateOperator>((int *)left.data(), (int *)result.data(), result.capacity());
-      } else if (attr_type == AttrType::FLOATS) {
-        unary_operator<LEFT_CONSTANT, float, NegateOperator>(
-            (float *)left.data(), (float *)result.data(), result.capacity());
+    case ArithmeticExpr::Type::SUB: {
+      binary_calc<LEFT_CONSTANT, RIGHT_CONSTANT, T, SubtractOperator>(left, right, result, size, rows);
+    } break;
+    case ArithmeticExpr::Type::MUL: {
+      binary_calc<LEFT_CONSTANT, RIGHT_CONSTANT, T, MultiplyOperator>(left, right, result, size, rows);
+    } break;
+    case ArithmeticExpr::Type::DIV: {
+      binary_calc<LEFT_CONSTANT, RIGHT_CONSTANT, T, DivideOperator>(left, right, result, size, rows);
+    } break;
+    case ArithmeticExpr::Type::NEGATIVE: {
+      if (rows == nullptr) {
+        unary_operator<LEFT_CONSTANT, T, NegateOperator>(left, result, size);
       } else {
-        rc = RC::UNIMPLEMENTED;
+        selected_unary_operator<LEFT_CONSTANT, T, NegateOperator>(
+            left, result, rows->data(), static_cast<int>(rows->size()));
       }
-      break;
-    default: rc = RC::UNIMPLEMENTED; break;
+    } break;
   }
-  if (rc == RC::SUCCESS) {
-    result.set_count(result.capacity());
+}
+
+template <typename T>
+static void execute_calc(ArithmeticExpr::Type type, const T *left, const T *right, bool left_const, bool right_const,
+    T *result, int size, const vector<int> *rows)
+{
+  if (left_const) {
+    execute_calc<true, false, T>(type, left, right, result, size, rows);
+  } else if (right_const) {
+    execute_calc<false, true, T>(type, left, right, result, size, rows);
+  } else {
+    execute_calc<false, false, T>(type, left, right, result, size, rows);
   }
-  return rc;
+}
+
+/**
+ * @brief 获取数值列中的数据，INTS/DATES 转换成 FLOATS。常量列只有一个值
+ */
+static const float *float_data(const Column &column, int size, const vector<int> *rows, vector<float> &buffer)
+{
+  if (column.attr_type() == AttrType::FLOATS) {
+    return reinterpret_cast<const float *>(column.data());
+  }
+
+  const int *input = reinterpret_cast<const int *>(column.data());
+  if (column.column_type() == Column::Type::CONSTANT_COLUMN) {
+    buffer.assign(1, static_cast<float>(input[0]));
+  } else if (rows == nullptr) {
+    buffer.resize(size);
+    cast_operator(input, buffer.data(), size);
+  } else {
+    buffer.resize(size);
+    cast_operator(input, buffer.data(), static_cast<int>(rows->size()), rows->data());
+  }
+  return buffer.data();
 }
 
 RC ArithmeticExpr::get_value(const Tuple &tuple, Value &value) const
@@ -471,15 +743,24 @@ RC ArithmeticExpr::get_value(const Tuple &tuple, Value &value) const
     LOG_WARN("failed to get value of left expression. rc=%s", strrc(rc));
     return rc;
   }
-  rc = right_->get_value(tuple, right_value);
-  if (rc != RC::SUCCESS) {
-    LOG_WARN("failed to get value of right expression. rc=%s", strrc(rc));
-    return rc;
+  if (right_) {
+    rc = right_->get_value(tuple, right_value);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to get value of right expression. rc=%s", strrc(rc));
+      return rc;
+    }
   }
   return calc_value(left_value, right_value, value);
 }
 
-RC ArithmeticExpr::get_column(Chunk &chunk, Column &column)
+RC ArithmeticExpr::get_column(Chunk &chunk, Column &column) { return eval_column(chunk, nullptr, column); }
+
+RC ArithmeticExpr::get_selected_column(Chunk &chunk, const vector<uint8_t> &select, Column &column)
+{
+  return eval_column(chunk, &select, column);
+}
+
+RC ArithmeticExpr::eval_column(Chunk &chunk, const vector<uint8_t> *select, Column &column)
 {
   RC rc = RC::SUCCESS;
   if (pos_ != -1) {
@@ -489,39 +770,69 @@ RC ArithmeticExpr::get_column(Chunk &chunk, Column &column)
   Column left_column;
   Column right_column;
 
-  rc = left_->get_column(chunk, left_column);
+  rc = select != nullptr ? left_->get_selected_column(chunk, *select, left_column)
+                         : left_->get_column(chunk, left_column);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to get column of left expression. rc=%s", strrc(rc));
     return rc;
   }
-  rc = right_->get_column(chunk, right_column);
-  if (rc != RC::SUCCESS) {
-    LOG_WARN("failed to get column of right expression. rc=%s", strrc(rc));
-    return rc;
+  if (right_) {
+    rc = select != nullptr ? right_->get_selected_column(chunk, *select, right_column)
+                           : right_->get_column(chunk, right_column);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to get column of right expression. rc=%s", strrc(rc));
+      return rc;
+    }
   }
-  return calc_column(left_column, right_column, column);
+  return calc_column(left_column, right_column, select, column);
 }
 
-RC ArithmeticExpr::calc_column(const Column &left_column, const Column &right_column, Column &column) const
+RC ArithmeticExpr::calc_column(
+    const Column &left_column, const Column &right_column, const vector<uint8_t> *select, Column &column) const
 {
   RC rc = RC::SUCCESS;
 
   const AttrType target_type = value_type();
-  column.init(target_type, left_column.attr_len(), max(left_column.count(), right_column.count()));
-  bool left_const  = left_column.column_type() == Column::Type::CONSTANT_COLUMN;
-  bool right_const = right_column.column_type() == Column::Type::CONSTANT_COLUMN;
+  const int      size        = max(left_column.count(), right_column.count());
+  const bool     left_const  = left_column.column_type() == Column::Type::CONSTANT_COLUMN;
+  const bool     right_const = !right_ || right_column.column_type() == Column::Type::CONSTANT_COLUMN;
   if (left_const && right_const) {
-    column.set_column_type(Column::Type::CONSTANT_COLUMN);
-    rc = execute_calc<true, true>(left_column, right_column, column, arithmetic_type_, target_type);
-  } else if (left_const && !right_const) {
-    column.set_column_type(Column::Type::NORMAL_COLUMN);
-    rc = execute_calc<true, false>(left_column, right_column, column, arithmetic_type_, target_type);
-  } else if (!left_const && right_const) {
-    column.set_column_type(Column::Type::NORMAL_COLUMN);
-    rc = execute_calc<false, true>(left_column, right_column, column, arithmetic_type_, target_type);
+    Value value;
+    rc = calc_value(left_column.get_value(0), right_ ? right_column.get_value(0) : Value(), value);
+    if (OB_SUCC(rc)) {
+      column.init(value, size);
+    }
+    return rc;
+  }
+
+  vector<int>        rows;
+  const vector<int> *selected = selected_rows(select, size, rows);
+
+  const bool numeric = (target_type == AttrType::INTS || target_type == AttrType::FLOATS) &&
+                       is_numeric_column(left_column) && (!right_ || is_numeric_column(right_column));
+  if (!numeric) {
+    return calc_column_by_row(
+        target_type, size, selected,
+        [&](int i, Value &value) {
+          return calc_value(left_column.get_value(i), right_ ? right_column.get_value(i) : Value(), value);
+        },
+        column);
+  }
+
+  column.init(target_type, sizeof(int32_t), size);
+  column.set_count(size);
+  if (target_type == AttrType::INTS) {
+    // 只有两边都是 INTS 时结果才是 INTS
+    execute_calc<int>(arithmetic_type_, reinterpret_cast<const int *>(left_column.data()),
+        reinterpret_cast<const int *>(right_column.data()), left_const, right_const,
+        reinterpret_cast<int *>(column.data()), size, selected);
   } else {
-    column.set_column_type(Column::Type::NORMAL_COLUMN);
-    rc = execute_calc<false, false>(left_column, right_column, column, arithmetic_type_, target_type);
+    vector<float> left_buffer;
+    vector<float> right_buffer;
+    const float  *left_data  = float_data(left_column, size, selected, left_buffer);
+    const float  *right_data = right_ ? float_data(right_column, size, selected, right_buffer) : nullptr;
+    execute_calc<float>(arithmetic_type_, left_data, right_data, left_const, right_const,
+        reinterpret_cast<float *>(column.data()), size, selected);
   }
   return rc;
 }
@@ -533,16 +844,17 @@ RC ArithmeticExpr::try_get_value(Value &value) const
   Value left_value;
   Value right_value;
 
+  // 生成执行计划时会对所有的算术表达式尝试常量折叠，不是常量是正常的情况
   rc = left_->try_get_value(left_value);
   if (rc != RC::SUCCESS) {
-    LOG_WARN("failed to get value of left expression. rc=%s", strrc(rc));
+    LOG_TRACE("failed to get value of left expression. rc=%s", strrc(rc));
     return rc;
   }
 
   if (right_) {
     rc = right_->try_get_value(right_value);
     if (rc != RC::SUCCESS) {
-      LOG_WARN("failed to get value of right expression. rc=%s", strrc(rc));
+      LOG_TRACE("failed to get value of right expression. rc=%s", strrc(rc));
       return rc;
     }
   }
@@ -589,12 +901,12 @@ bool AggregateExpr::equal(const Expression &other) const
   return aggregate_type_ == other_aggr_expr.aggregate_type() && child_->equal(*other_aggr_expr.child());
 }
 
-unique_ptr<Aggregator> AggregateExpr::create_aggregator() const
+Aggregator *AggregateExpr::create_aggregator(const function<void *(size_t)> &allocate) const
 {
-  unique_ptr<Aggregator> aggregator;
+  Aggregator *aggregator = nullptr;
   switch (aggregate_type_) {
     case Type::SUM: {
-      aggregator = make_unique<SumAggregator>();
+      aggregator = new (allocate(sizeof(SumAggregator))) SumAggregator();
       break;
     }
     default: {
@@ -605,6 +917,17 @@ unique_ptr<Aggregator> AggregateExpr::create_aggregator() const
   return aggregator;
 }
 
+unique_ptr<Aggregator> AggregateExpr::create_aggregator() const
+{
+  // 使用 operator new 分配的内存，可以直接用 delete 释放
+  return unique_ptr<Aggregator>(create_aggregator([](size_t size) { return ::operator new(size); }));
+}
+
+Aggregator *AggregateExpr::create_aggregator(Arena &arena) const
+{
+  return create_aggregator([&arena](size_t size) -> void * { return arena.AllocateAligned(size); });
+}
+
 RC AggregateExpr::get_value(const Tuple &tuple, Value &value) const
 {
   return tuple.find_cell(TupleCellSpec(name()), value);
@@ -628,3 +951,78 @@ RC AggregateExpr::type_from_string(const char *type_str, AggregateExpr::Type &ty
   }
   return rc;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+
+VectorDistanceExpr::VectorDistanceExpr(VectorDistanceType distance_type, Expression *left, Expression *right)
+    : distance_type_(distance_type), left_(left), right_(right)
+{}
+
+VectorDistanceExpr::VectorDistanceExpr(
+    VectorDistanceType distance_type, unique_ptr<Expression> left, unique_ptr<Expression> right)
+    : distance_type_(distance_type), left_(std::move(left)), right_(std::move(right))
+{}
+
+bool VectorDistanceExpr::equal(const Expression &other) const
+{
+  if (this == &other) {
+    return true;
+  }
+  if (type() != other.type()) {
+    return false;
+  }
+  auto &other_expr = static_cast<const VectorDistanceExpr &>(other);
+  return distance_type_ == other_expr.distance_type_ && left_->equal(*other_expr.left_) &&
+         right_->equal(*other_expr.right_);
+}
+
+RC VectorDistanceExpr::calc_value(const Value &left_value, const Value &right_value, Value &value) const
+{
+  if (left_value.attr_type() != AttrType::VECTORS || right_value.attr_type() != AttrType::VECTORS) {
+    LOG_WARN("vector distance requires vector arguments. left=%s, right=%s",
+        attr_type_to_string(left_value.attr_type()), attr_type_to_string(right_value.attr_type()));
+    return RC::INVALID_ARGUMENT;
+  }
+  if (left_value.vector_dim() != right_value.vector_dim()) {
+    LOG_WARN("vector dimensions mismatch. left=%d, right=%d", left_value.vector_dim(), right_value.vector_dim());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  value.set_float(
+      vector_distance(distance_type_, left_value.get_vector(), right_value.get_vector(), left_value.vector_dim()));
+  return RC::SUCCESS;
+}
+
+RC VectorDistanceExpr::get_value(const Tuple &tuple, Value &value) const
+{
+  Value left_value;
+  Value right_value;
+
+  RC rc = left_->get_value(tuple, left_value);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get value of left expression. rc=%s", strrc(rc));
+    return rc;
+  }
+  rc = right_->get_value(tuple, right_value);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get value of right expression. rc=%s", strrc(rc));
+    return rc;
+  }
+  return calc_value(left_value, right_value, value);
+}
+
+RC VectorDistanceExpr::try_get_value(Value &value) const
+{
+  Value left_value;
+  Value right_value;
+
+  RC rc = left_->try_get_value(left_value);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  rc = right_->try_get_value(right_value);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  return calc_value(left_value, right_value, value);
+}
@@ -16,13 +16,16 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/lang/string.h"
 #include "common/lang/memory.h"
+#include "common/lang/functional.h"
 #include "common/lang/unordered_set.h"
 #include "common/value.h"
+#include "common/type/vector_distance.h"
 #include "storage/field/field.h"
 #include "sql/expr/aggregator.h"
 #include "storage/common/chunk.h"
 
 class Tuple;
+class Arena;
 
 /**
  * @defgroup Expression
@@ -40,13 +43,15 @@ enum class ExprType
   UNBOUND_FIELD,        ///< 未绑定的字段，需要在resolver阶段解析为FieldExpr
   UNBOUND_AGGREGATION,  ///< 未绑定的聚合函数，需要在resolver阶段解析为AggregateExpr
 
-  FIELD,        ///< 字段。在实际执行时，根据行数据内容提取对应字段的值
-  VALUE,        ///< 常量值
-  CAST,         ///< 需要做类型转换的表达式
-  COMPARISON,   ///< 需要做比较的表达式
-  CONJUNCTION,  ///< 多个表达式使用同一种关系(AND或OR)来联结
-  ARITHMETIC,   ///< 算术运算
-  AGGREGATION,  ///< 聚合运算
+  FIELD,            ///< 字段。在实际执行时，根据行数据内容提取对应字段的值
+  VALUE,            ///< 常量值
+  CAST,             ///< 需要做类型转换的表达式
+  COMPARISON,       ///< 需要做比较的表达式
+  CONJUNCTION,      ///< 多个表达式使用同一种关系(AND或OR)来联结
+  ARITHMETIC,       ///< 算术运算
+  AGGREGATION,      ///< 聚合运算
+  VECTOR_DISTANCE,  ///< 向量距离函数，比如 l2_distance(a, b)
+  PARAM,            ///< 预处理语句的参数，即SQL中的问号
 };
 
 /**
@@ -94,6 +99,16 @@ public:
    */
   virtual RC get_column(Chunk &chunk, Column &column) { return RC::UNIMPLEMENTED; }
 
+  /**
+   * @brief 从 `chunk` 中获取表达式的计算结果 `column`，只需要计算 `select[i]` 不为 0 的行
+   * @details 其它行的结果没有意义。过滤条件依次计算时，后面的条件只需要计算前面的条件留下来的行。
+   * 默认忽略 `select`，计算所有的行。
+   */
+  virtual RC get_selected_column(Chunk &chunk, const vector<uint8_t> &select, Column &column)
+  {
+    return get_column(chunk, column);
+  }
+
   /**
    * @brief 表达式的类型
    * 可以根据表达式类型来转换为具体的子类
@@ -256,6 +271,44 @@ private:
   Value value_;
 };
 
+/**
+ * @brief 预处理语句的参数
+ * @ingroup Expression
+ * @details 执行时从当前请求中获取客户端绑定的参数值。参数本身没有类型，生成执行计划时
+ * 按照与它比较的字段确定类型，取值时转换成这个类型。
+ */
+class ParamExpr : public Expression
+{
+public:
+  ParamExpr(int index, AttrType value_type) : index_(index), value_type_(value_type) {}
+  virtual ~ParamExpr() = default;
+
+  bool equal(const Expression &other) const override;
+
+  unique_ptr<Expression> copy() const override { return make_unique<ParamExpr>(index_, value_type_); }
+
+  RC get_value(const Tuple &tuple, Value &value) const override;
+  RC get_column(Chunk &chunk, Column &column) override;
+
+  ExprType type() const override { return ExprType::PARAM; }
+  AttrType value_type() const override { return value_type_; }
+
+  int index() const { return index_; }
+
+  /**
+   * @brief 获取当前请求绑定的第 index 个参数
+   */
+  static RC bound_value(int index, Value &value);
+
+private:
+  /// 取出绑定的参数并转换成 value_type_
+  RC param_value(Value &value) const;
+
+private:
+  int      index_;
+  AttrType value_type_;  ///< UNDEFINED 表示直接使用客户端传入的类型
+};
+
 /**
  * @brief 类型转换表达式
  * @ingroup Expression
@@ -272,6 +325,7 @@ public:
 
   RC get_value(const Tuple &tuple, Value &value) const override;
   RC get_column(Chunk &chunk, Column &column) override;
+  RC get_selected_column(Chunk &chunk, const vector<uint8_t> &select, Column &column) override;
 
   RC try_get_value(Value &value) const override;
 
@@ -282,6 +336,9 @@ public:
 private:
   RC cast(const Value &value, Value &cast_value) const;
 
+  /// select 为空时计算所有的行
+  RC cast_column(Chunk &chunk, const vector<uint8_t> *select, Column &column);
+
 private:
   unique_ptr<Expression> child_;      ///< 从这个表达式转换
   AttrType               cast_type_;  ///< 想要转换成这个类型
@@ -331,6 +388,15 @@ public:
   template <typename T>
   RC compare_column(const Column &left, const Column &right, vector<uint8_t> &result) const;
 
+  /**
+   * @brief 比较字典编码的字符串列与常量
+   * @details 等值比较只需要在字典中查找一次常量，然后比较编号；其它比较在字典比 chunk 小的时候，
+   * 每个字典项只与常量比较一次。无法使用字典时返回 RC::UNSUPPORTED
+   * @param constant_left 常量是否在比较运算符的左边
+   */
+  RC compare_dictionary_column(
+      const Column &column, const Value &constant, bool constant_left, vector<uint8_t> &result) const;
+
 private:
   CompOp                 comp_;
   unique_ptr<Expression> left_;
@@ -369,6 +435,11 @@ public:
   AttrType value_type() const override { return AttrType::BOOLEANS; }
   RC       get_value(const Tuple &tuple, Value &value) const override;
 
+  /**
+   * @brief AND 的子表达式依次缩小 `select`，OR 的子表达式只需要计算还没有满足条件的行
+   */
+  RC eval(Chunk &chunk, vector<uint8_t> &select) override;
+
   Type conjunction_type() const { return conjunction_type_; }
 
   vector<unique_ptr<Expression>> &children() { return children_; }
@@ -417,6 +488,7 @@ public:
   RC get_value(const Tuple &tuple, Value &value) const override;
 
   RC get_column(Chunk &chunk, Column &column) override;
+  RC get_selected_column(Chunk &chunk, const vector<uint8_t> &select, Column &column) override;
 
   RC try_get_value(Value &value) const override;
 
@@ -428,10 +500,11 @@ public:
 private:
   RC calc_value(const Value &left_value, const Value &right_value, Value &value) const;
 
-  RC calc_column(const Column &left_column, const Column &right_column, Column &column) const;
+  /// select 为空时计算所有的行
+  RC eval_column(Chunk &chunk, const vector<uint8_t> *select, Column &column);
 
-  template <bool LEFT_CONSTANT, bool RIGHT_CONSTANT>
-  RC execute_calc(const Column &left, const Column &right, Column &result, Type type, AttrType attr_type) const;
+  RC calc_column(
+      const Column &left_column, const Column &right_column, const vector<uint8_t> *select, Column &column) const;
 
 private:
   Type                   arithmetic_type_;
@@ -521,10 +594,60 @@ public:
 
   unique_ptr<Aggregator> create_aggregator() const;
 
+  /**
+   * @brief 在 arena 中创建聚合器
+   * @details 返回的聚合器内存属于 arena，释放时只能调用析构函数，参考 AggregatorDeleter
+   */
+  Aggregator *create_aggregator(Arena &arena) const;
+
 public:
   static RC type_from_string(const char *type_str, Type &type);
 
+private:
+  /// 根据聚合类型创建聚合器，内存由 allocate 分配。堆上和 arena 中创建聚合器都通过这个函数
+  Aggregator *create_aggregator(const function<void *(size_t)> &allocate) const;
+
 private:
   Type                   aggregate_type_;
   unique_ptr<Expression> child_;
 };
+
+/**
+ * @brief 向量距离函数
+ * @ingroup Expression
+ * @details l2_distance、cosine_distance 和 inner_product 三个函数，参数是两个向量，结果是 float。
+ * 参数可以是字符串形式的向量常量，比如 '[1,2,3]'，在绑定阶段会转换成向量。
+ */
+class VectorDistanceExpr : public Expression
+{
+public:
+  VectorDistanceExpr(VectorDistanceType distance_type, Expression *left, Expression *right);
+  VectorDistanceExpr(VectorDistanceType distance_type, unique_ptr<Expression> left, unique_ptr<Expression> right);
+  virtual ~VectorDistanceExpr() = default;
+
+  unique_ptr<Expression> copy() const override
+  {
+    return make_unique<VectorDistanceExpr>(distance_type_, left_->copy(), right_->copy());
+  }
+
+  bool     equal(const Expression &other) const override;
+  ExprType type() const override { return ExprType::VECTOR_DISTANCE; }
+  AttrType value_type() const override { return AttrType::FLOATS; }
+  int      value_length() const override { return sizeof(float); }
+
+  RC get_value(const Tuple &tuple, Value &value) const override;
+  RC try_get_value(Value &value) const override;
+
+  VectorDistanceType distance_type() const { return distance_type_; }
+
+  unique_ptr<Expression> &left() { return left_; }
+  unique_ptr<Expression> &right() { return right_; }
+
+private:
+  RC calc_value(const Value &left_value, const Value &right_value, Value &value) const;
+
+private:
+  VectorDistanceType     distance_type_;
+  unique_ptr<Expression> left_;
+  unique_ptr<Expression> right_;
+};
@@ -63,11 +63,20 @@ RC ExpressionIterator::iterate_child_expr(Expression &expr, function<RC(unique_p
       rc = callback(aggregate_expr.child());
     } break;
 
+    case ExprType::VECTOR_DISTANCE: {
+      auto &distance_expr = static_cast<VectorDistanceExpr &>(expr);
+      rc = callback(distance_expr.left());
+      if (OB_SUCC(rc)) {
+        rc = callback(distance_expr.right());
+      }
+    } break;
+
     case ExprType::NONE:
     case ExprType::STAR:
     case ExprType::UNBOUND_FIELD:
     case ExprType::FIELD:
-    case ExprType::VALUE: {
+    case ExprType::VALUE:
+    case ExprType::PARAM: {
       // Do nothing
     } break;
 
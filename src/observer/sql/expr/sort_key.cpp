@@ -0,0 +1,150 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/expr/sort_key.h"
+#include "common/log/log.h"
+#include "common/value.h"
+
+#include <cstring>
+
+static uint32_t int_key(int32_t value) { return static_cast<uint32_t>(value) ^ 0x80000000u; }
+
+static uint32_t float_key(float value)
+{
+  // -0.0 和 0.0 相等，编码也要相同
+  if (value == 0.0f) {
+    value = 0.0f;
+  }
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return (bits & 0x80000000u) ? ~bits : (bits ^ 0x80000000u);
+}
+
+static void store_key(uint32_t key, char *dest)
+{
+  dest[0] = static_cast<char>(key >> 24);
+  dest[1] = static_cast<char>(key >> 16);
+  dest[2] = static_cast<char>(key >> 8);
+  dest[3] = static_cast<char>(key);
+}
+
+static void append_key(uint32_t key, string &dest)
+{
+  char buf[sizeof(key)];
+  store_key(key, buf);
+  dest.append(buf, sizeof(buf));
+}
+
+static void invert(char *data, size_t len)
+{
+  for (size_t i = 0; i < len; i++) {
+    data[i] = static_cast<char>(~data[i]);
+  }
+}
+
+int SortKeyEncoder::fixed_length(AttrType type, int attr_len)
+{
+  switch (type) {
+    case AttrType::INTS:
+    case AttrType::DATES:
+    case AttrType::FLOATS: return 4;
+    case AttrType::BOOLEANS: return 1;
+    case AttrType::CHARS:
+    case AttrType::VECTORS: return attr_len;
+    default: return -1;
+  }
+}
+
+void SortKeyEncoder::encode_fixed(AttrType type, const char *data, int attr_len, bool ascending, char *dest)
+{
+  int length = fixed_length(type, attr_len);
+  switch (type) {
+    case AttrType::INTS:
+    case AttrType::DATES: {
+      int32_t value;
+      memcpy(&value, data, sizeof(value));
+      store_key(int_key(value), dest);
+    } break;
+    case AttrType::FLOATS: {
+      float value;
+      memcpy(&value, data, sizeof(value));
+      store_key(float_key(value), dest);
+    } break;
+    case AttrType::BOOLEANS: {
+      // 布尔值在不同的地方可能用不同长度的整数存储，非0就是 true
+      char value = 0;
+      for (int i = 0; i < attr_len; i++) {
+        value |= data[i];
+      }
+      dest[0] = value != 0 ? 1 : 0;
+    } break;
+    case AttrType::CHARS: {
+      size_t len = strnlen(data, attr_len);
+      memcpy(dest, data, len);
+      memset(dest + len, 0, attr_len - len);
+    } break;
+    case AttrType::VECTORS: {
+      for (int offset = 0; offset + static_cast<int>(sizeof(float)) <= attr_len; offset += sizeof(float)) {
+        float value;
+        memcpy(&value, data + offset, sizeof(value));
+        store_key(float_key(value), dest + offset);
+      }
+    } break;
+    default: {
+      ASSERT(false, "unsupported sort key type: %s", attr_type_to_string(type));
+    } break;
+  }
+
+  if (!ascending) {
+    invert(dest, length);
+  }
+}
+
+RC SortKeyEncoder::append(const Value &value, bool ascending, string &key)
+{
+  const size_t start = key.size();
+  switch (value.attr_type()) {
+    case AttrType::INTS: {
+      append_key(int_key(value.get_int()), key);
+    } break;
+    case AttrType::DATES: {
+      append_key(int_key(value.get_date()), key);
+    } break;
+    case AttrType::FLOATS: {
+      append_key(float_key(value.get_float()), key);
+    } break;
+    case AttrType::BOOLEANS: {
+      key.push_back(value.get_boolean() ? 1 : 0);
+    } break;
+    case AttrType::CHARS: {
+      const char *data = value.data();
+      key.append(data, strnlen(data, value.length()));
+      key.push_back(0);
+    } break;
+    case AttrType::VECTORS: {
+      // 每个分量前面加一个非0的字节，以0结尾，前缀相同时维度小的更小
+      const float *values = value.get_vector();
+      for (int i = 0; i < value.vector_dim(); i++) {
+        key.push_back(1);
+        append_key(float_key(values[i]), key);
+      }
+      key.push_back(0);
+    } break;
+    default: {
+      LOG_WARN("unsupported sort key type: %s", attr_type_to_string(value.attr_type()));
+      return RC::UNSUPPORTED;
+    }
+  }
+
+  if (!ascending) {
+    invert(key.data() + start, key.size() - start);
+  }
+  return RC::SUCCESS;
+}
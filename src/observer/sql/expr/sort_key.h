@@ -0,0 +1,51 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/string.h"
+#include "common/sys/rc.h"
+#include "common/type/attr_type.h"
+
+class Value;
+
+/**
+ * @brief 排序键编码（normalized key）
+ * @details 把排序键编码成一段二进制数据，两个排序键的大小关系与编码之后 memcmp 的结果一致，
+ * 多个排序键的编码直接拼接起来就是多列排序的键。排序时只需要比较字节串，不需要按照类型逐列比较。
+ * - 整数和日期按大端序存储，并翻转符号位；
+ * - 浮点数按 IEEE 754 的位模式转换，负数翻转所有位，正数翻转符号位；
+ * - 字符串按字节存储，定长编码在后面补0，变长编码以0结尾；
+ * - 降序的键把编码之后的所有字节取反。
+ * 浮点数按照精确值排序，不考虑比较浮点数时使用的误差。
+ */
+class SortKeyEncoder
+{
+public:
+  /**
+   * @brief 定长编码的长度
+   * @details 向量化排序时同一列的值长度相同，每个排序键都可以使用定长编码
+   * @param attr_len 列中每个值的长度
+   * @return 不支持排序的类型返回 -1
+   */
+  static int fixed_length(AttrType type, int attr_len);
+
+  /**
+   * @brief 定长编码，结果写入 dest，长度为 fixed_length(type, attr_len)
+   * @param data 列中的一个值
+   */
+  static void encode_fixed(AttrType type, const char *data, int attr_len, bool ascending, char *dest);
+
+  /**
+   * @brief 变长编码，结果追加到 key 的后面
+   * @details 用于按行排序时长度不固定的值，字符串和向量的编码不会是另一个值编码的前缀
+   */
+  static RC append(const Value &value, bool ascending, string &key);
+};
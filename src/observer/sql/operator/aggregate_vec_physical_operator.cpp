@@ -32,11 +32,26 @@ AggregateVecPhysicalOperator::AggregateVecPhysicalOperator(vector<Expression *>
   for (size_t i = 0; i < aggregate_expressions_.size(); i++) {
     auto &expr = aggregate_expressions_[i];
     ASSERT(expr->type() == ExprType::AGGREGATION, "expected an aggregation expression");
+    auto *aggregate_expr = static_cast<AggregateExpr *>(expr);
+    output_chunk_.add_column(make_unique<Column>(aggregate_expr->value_type(), aggregate_expr->value_length()), i);
+  }
+}
+
+void AggregateVecPhysicalOperator::create_aggregate_states()
+{
+  create_aggregate_states(aggr_values_);
+  output_chunk_.reset_data();
+  outputed_ = false;
+}
+
+void AggregateVecPhysicalOperator::create_aggregate_states(AggregateValues &values) const
+{
+  values.clear();
+  for (Expression *expr : aggregate_expressions_) {
     auto *aggregate_expr = static_cast<AggregateExpr *>(expr);
     void *state_ptr = create_aggregate_state(aggregate_expr->aggregate_type(), aggregate_expr->child()->value_type());
     ASSERT(state_ptr != nullptr, "failed to create aggregate state");
-    aggr_values_.insert(state_ptr);
-    output_chunk_.add_column(make_unique<Column>(aggregate_expr->value_type(), aggregate_expr->value_length()), i);
+    values.insert(state_ptr);
   }
 }
 
@@ -44,24 +59,26 @@ RC AggregateVecPhysicalOperator::open(Trx *trx)
 {
   ASSERT(children_.size() == 1, "group by operator only support one child, but got %d", children_.size());
 
+  create_aggregate_states();
+
   PhysicalOperator &child = *children_[0];
-  RC                rc    = child.open(trx);
+  RC                rc    = RC::UNSUPPORTED;
+  if (parallel_degree_ > 1 && child.type() == PhysicalOperatorType::TABLE_SCAN_VEC) {
+    rc = parallel_aggregate(trx, static_cast<TableScanVecPhysicalOperator &>(child));
+    if (rc != RC::UNSUPPORTED) {
+      return rc;
+    }
+  }
+
+  rc = child.open(trx);
   if (OB_FAIL(rc)) {
     LOG_INFO("failed to open child operator. rc=%s", strrc(rc));
     return rc;
   }
 
   while (OB_SUCC(rc = child.next(chunk_))) {
-    for (size_t aggr_idx = 0; aggr_idx < aggregate_expressions_.size(); aggr_idx++) {
-      Column column;
-      value_expressions_[aggr_idx]->get_column(chunk_, column);
-      ASSERT(aggregate_expressions_[aggr_idx]->type() == ExprType::AGGREGATION, "expect aggregate expression");
-      auto *aggregate_expr = static_cast<AggregateExpr *>(aggregate_expressions_[aggr_idx]);
-      rc = aggregate_state_update_by_column(aggr_values_.at(aggr_idx), aggregate_expr->aggregate_type(), aggregate_expr->child()->value_type(), column);
-      if (OB_FAIL(rc)) {
-        LOG_INFO("failed to update aggregate state. rc=%s", strrc(rc));
-        return rc;
-      }
+    if (OB_FAIL(rc = update_aggregate_states(aggr_values_, chunk_))) {
+      return rc;
     }
   }
 
@@ -72,6 +89,51 @@ RC AggregateVecPhysicalOperator::open(Trx *trx)
   return rc;
 }
 
+RC AggregateVecPhysicalOperator::update_aggregate_states(AggregateValues &values, Chunk &chunk) const
+{
+  for (size_t aggr_idx = 0; aggr_idx < aggregate_expressions_.size(); aggr_idx++) {
+    Column column;
+    value_expressions_[aggr_idx]->get_column(chunk, column);
+    ASSERT(aggregate_expressions_[aggr_idx]->type() == ExprType::AGGREGATION, "expect aggregate expression");
+    auto *aggregate_expr = static_cast<AggregateExpr *>(aggregate_expressions_[aggr_idx]);
+    RC rc = aggregate_state_update_by_column(values.at(aggr_idx), aggregate_expr->aggregate_type(), aggregate_expr->child()->value_type(), column);
+    if (OB_FAIL(rc)) {
+      LOG_INFO("failed to update aggregate state. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC AggregateVecPhysicalOperator::parallel_aggregate(Trx *trx, TableScanVecPhysicalOperator &scan_oper)
+{
+  vector<AggregateValues> worker_values(parallel_degree_);
+  for (AggregateValues &values : worker_values) {
+    create_aggregate_states(values);
+  }
+
+  RC rc = scan_oper.parallel_scan(trx, parallel_degree_, [this, &worker_values](int worker_id, Chunk &chunk) {
+    return update_aggregate_states(worker_values[worker_id], chunk);
+  });
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  // 只有一个分组，聚合状态很少，直接在当前线程中合并
+  for (AggregateValues &values : worker_values) {
+    for (size_t aggr_idx = 0; aggr_idx < aggregate_expressions_.size(); aggr_idx++) {
+      auto *aggregate_expr = static_cast<AggregateExpr *>(aggregate_expressions_[aggr_idx]);
+      rc = aggregate_state_merge(aggr_values_.at(aggr_idx), values.at(aggr_idx), aggregate_expr->aggregate_type(),
+          aggregate_expr->child()->value_type());
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to merge aggregate state. rc=%s", strrc(rc));
+        return rc;
+      }
+    }
+  }
+  return RC::SUCCESS;
+}
+
 template <class STATE, typename T>
 void AggregateVecPhysicalOperator::update_aggregate_state(void *state, const Column &column)
 {
@@ -11,10 +11,12 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include "sql/operator/physical_operator.h"
+#include "sql/operator/table_scan_vec_physical_operator.h"
 
 /**
  * @brief 聚合物理算子 (Vectorized)
  * @ingroup PhysicalOperator
+ * @details 并行执行时，每个线程扫描一部分数据并聚合到自己的聚合状态中，最后把所有线程的聚合状态合并到一起。
  */
 class AggregateVecPhysicalOperator : public PhysicalOperator
 {
@@ -29,10 +31,31 @@ public:
   RC next(Chunk &chunk) override;
   RC close() override;
 
+  /**
+   * @brief 设置并行执行的线程数
+   * @details 只有子算子是表扫描并且存储引擎支持并行扫描时才会并行执行，否则还是单线程执行
+   */
+  void set_parallel_degree(int parallel_degree) { parallel_degree_ = parallel_degree; }
+
 private:
+  class AggregateValues;
+
   template <class STATE, typename T>
   void update_aggregate_state(void *state, const Column &column);
 
+  /// 每次 open 时重新创建聚合状态，执行计划可能被多次执行
+  void create_aggregate_states();
+  void create_aggregate_states(AggregateValues &values) const;
+
+  /// 使用 chunk 更新聚合状态。可以被多个线程同时调用，每个线程使用不同的聚合状态
+  RC update_aggregate_states(AggregateValues &values, Chunk &chunk) const;
+
+  /**
+   * @brief 并行聚合，结果合并到 aggr_values_ 中
+   * @return RC::UNSUPPORTED 表示不能并行扫描，需要单线程执行
+   */
+  RC parallel_aggregate(Trx *trx, TableScanVecPhysicalOperator &scan_oper);
+
 private:
   class AggregateValues
   {
@@ -48,12 +71,15 @@ private:
     }
 
     size_t size() { return data_.size(); }
-    ~AggregateValues()
+    ~AggregateValues() { clear(); }
+
+    void clear()
     {
       for (auto &aggr_value : data_) {
         free(aggr_value);
         aggr_value = nullptr;
       }
+      data_.clear();
     }
 
   private:
@@ -64,5 +90,6 @@ private:
   Chunk                chunk_;
   Chunk                output_chunk_;
   AggregateValues      aggr_values_;
-  bool                 outputed_ = false;
+  bool                 outputed_        = false;
+  int                  parallel_degree_ = 1;
 };
@@ -32,6 +32,7 @@ RC DeletePhysicalOperator::open(Trx *trx)
   }
 
   trx_ = trx;
+  records_.clear();
 
   while (OB_SUCC(rc = child->next())) {
     Tuple *tuple = child->current_tuple();
@@ -21,6 +21,7 @@ using namespace std;
 RC ExplainPhysicalOperator::open(Trx *)
 {
   ASSERT(children_.size() == 1, "explain must has 1 child");
+  physical_plan_.clear();
   return RC::SUCCESS;
 }
 
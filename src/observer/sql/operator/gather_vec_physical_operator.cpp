@@ -0,0 +1,231 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/gather_vec_physical_operator.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/thread.h"
+#include "common/log/log.h"
+#include "common/thread/thread_pool_executor.h"
+#include "session/session.h"
+
+using namespace std;
+using namespace common;
+
+GatherVecPhysicalOperator::GatherVecPhysicalOperator(vector<unique_ptr<Expression>> &&expressions, int parallel_degree)
+    : expressions_(std::move(expressions)), parallel_degree_(parallel_degree)
+{}
+
+string GatherVecPhysicalOperator::param() const { return "parallel_degree=" + to_string(parallel_degree_); }
+
+ThreadPoolExecutor &GatherVecPhysicalOperator::executor()
+{
+  // worker 大部分时间在做计算，线程个数不需要超过 CPU 个数。线程不够时任务会排队，
+  // 后启动的 worker 领取不到 morsel 就直接结束，不影响结果的正确性
+  static ThreadPoolExecutor *executor = []() {
+    const int cpu_num  = max(static_cast<int>(thread::hardware_concurrency()), 1);
+    auto     *executor = new ThreadPoolExecutor();
+    executor->init("QueryWorker", 0 /*core_size*/, cpu_num, 60 * 1000 /*keep_alive_time_ms*/);
+    return executor;
+  }();
+  return *executor;
+}
+
+RC GatherVecPhysicalOperator::open(Trx *trx)
+{
+  ASSERT(children_.size() == 1, "gather operator only support one child, but got %d", children_.size());
+  ASSERT(children_[0]->type() == PhysicalOperatorType::TABLE_SCAN_VEC,
+      "gather operator only support table scan child, but got %s",
+      children_[0]->name().c_str());
+
+  auto &scan_oper = static_cast<TableScanVecPhysicalOperator &>(*children_[0]);
+
+  parallel_ = false;
+  RC rc     = RC::UNSUPPORTED;
+  if (parallel_degree_ > 1) {
+    rc = scan_oper.init_morsels(morsels_);
+  }
+  if (rc == RC::UNSUPPORTED) {
+    LOG_TRACE("run gather operator in current thread");
+    return scan_oper.open(trx);
+  }
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to init page morsels. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  workers_.clear();
+  worker_expressions_.clear();
+  worker_expressions_.resize(parallel_degree_);
+  for (int i = 0; i < parallel_degree_; i++) {
+    workers_.emplace_back(scan_oper.create_morsel_worker(morsels_));
+    for (const unique_ptr<Expression> &expr : expressions_) {
+      worker_expressions_[i].emplace_back(expr->copy());
+    }
+  }
+
+  ready_chunks_.clear();
+  max_ready_chunks_ = static_cast<size_t>(parallel_degree_) * 2;
+  running_workers_  = parallel_degree_;
+  cancelled_        = false;
+  first_error_      = RC::SUCCESS;
+  parallel_         = true;
+
+  // 表达式计算时可能需要访问会话，比如预处理语句的参数
+  Session *session = Session::current_session();
+  for (int i = 0; i < parallel_degree_; i++) {
+    int ret = executor().execute([this, i, trx, session]() { run_worker(i, trx, session); });
+    if (ret != 0) {
+      LOG_WARN("failed to submit gather worker. worker=%d", i);
+      finish_worker(RC::INTERNAL);
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC GatherVecPhysicalOperator::next(Chunk &chunk)
+{
+  if (!parallel_) {
+    RC rc = children_[0]->next(scan_chunk_);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    if (expressions_.empty()) {
+      return chunk.reference(scan_chunk_);
+    }
+    if (current_chunk_ == nullptr) {
+      current_chunk_ = make_unique<Chunk>();
+    }
+    rc = project(expressions_, scan_chunk_, *current_chunk_);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    return chunk.reference(*current_chunk_);
+  }
+
+  unique_lock guard(lock_);
+  not_empty_.wait(guard, [this]() { return !ready_chunks_.empty() || running_workers_ == 0 || OB_FAIL(first_error_); });
+  if (OB_FAIL(first_error_)) {
+    return first_error_;
+  }
+  if (ready_chunks_.empty()) {
+    return RC::RECORD_EOF;
+  }
+
+  current_chunk_ = std::move(ready_chunks_.front());
+  ready_chunks_.pop_front();
+  not_full_.notify_one();
+  guard.unlock();
+
+  return chunk.reference(*current_chunk_);
+}
+
+RC GatherVecPhysicalOperator::close()
+{
+  if (!parallel_) {
+    return children_[0]->close();
+  }
+
+  // 通知还在运行的 worker 尽快结束，等待所有 worker 退出之后才能释放它们使用的资源
+  unique_lock guard(lock_);
+  cancelled_ = true;
+  not_full_.notify_all();
+  not_empty_.wait(guard, [this]() { return running_workers_ == 0; });
+  guard.unlock();
+
+  ready_chunks_.clear();
+  workers_.clear();
+  worker_expressions_.clear();
+  current_chunk_.reset();
+  parallel_ = false;
+  return RC::SUCCESS;
+}
+
+void GatherVecPhysicalOperator::run_worker(int worker_id, Trx *trx, Session *session)
+{
+  Session::set_current_session(session);
+
+  TableScanVecPhysicalOperator &scan_oper = *workers_[worker_id];
+  Chunk                         chunk;
+  RC                            rc = scan_oper.open(trx);
+  if (OB_SUCC(rc)) {
+    while (OB_SUCC(rc = scan_oper.next(chunk))) {
+      if (chunk.rows() == 0) {
+        continue;
+      }
+
+      unique_ptr<Chunk> result;
+      if (worker_expressions_[worker_id].empty()) {
+        result = make_unique<Chunk>(chunk);
+      } else {
+        result = make_unique<Chunk>();
+        if (OB_FAIL(rc = project(worker_expressions_[worker_id], chunk, *result))) {
+          break;
+        }
+      }
+
+      if (!push_chunk(std::move(result))) {
+        break;
+      }
+    }
+    scan_oper.close();
+  }
+
+  if (rc == RC::RECORD_EOF) {
+    rc = RC::SUCCESS;
+  }
+  if (OB_FAIL(rc)) {
+    LOG_WARN("gather worker failed. worker=%d, rc=%s", worker_id, strrc(rc));
+  }
+
+  Session::set_current_session(nullptr);
+  finish_worker(rc);
+}
+
+bool GatherVecPhysicalOperator::push_chunk(unique_ptr<Chunk> chunk)
+{
+  unique_lock guard(lock_);
+  not_full_.wait(guard, [this]() { return cancelled_ || ready_chunks_.size() < max_ready_chunks_; });
+  if (cancelled_) {
+    return false;
+  }
+
+  ready_chunks_.emplace_back(std::move(chunk));
+  not_empty_.notify_one();
+  return true;
+}
+
+void GatherVecPhysicalOperator::finish_worker(RC rc)
+{
+  // 唤醒等待者之后 close 可能马上释放当前算子，解锁之后不能再访问任何成员
+  lock_guard guard(lock_);
+  if (OB_FAIL(rc) && first_error_ == RC::SUCCESS) {
+    first_error_ = rc;
+    cancelled_   = true;
+    not_full_.notify_all();
+  }
+  running_workers_--;
+  not_empty_.notify_all();
+}
+
+RC GatherVecPhysicalOperator::project(vector<unique_ptr<Expression>> &expressions, Chunk &chunk, Chunk &result)
+{
+  result.reset();
+  for (size_t i = 0; i < expressions.size(); i++) {
+    Column column;
+    RC     rc = expressions[i]->get_column(chunk, column);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get column of expression. rc=%s", strrc(rc));
+      return rc;
+    }
+    result.add_column(column.clone(), i);
+  }
+  return RC::SUCCESS;
+}
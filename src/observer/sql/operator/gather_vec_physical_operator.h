@@ -0,0 +1,87 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/condition_variable.h"
+#include "common/lang/deque.h"
+#include "common/lang/mutex.h"
+#include "sql/operator/physical_operator.h"
+#include "sql/operator/table_scan_vec_physical_operator.h"
+
+class Session;
+
+namespace common {
+class ThreadPoolExecutor;
+}
+
+/**
+ * @brief 并行扫描的汇集物理算子(vectorized)
+ * @ingroup PhysicalOperator
+ * @details 子算子必须是 TableScanVecPhysicalOperator。表的页面被切分成 morsel，由线程池中的
+ * parallel_degree 个 worker 领取。每个 worker 使用自己的扫描算子过滤数据，再计算投影表达式，
+ * 结果 chunk 放到一个有界队列中，由调用 next 的线程依次取出。chunk 之间的顺序是不确定的。
+ * 存储引擎不支持并行扫描时，退回到在当前线程中直接执行子算子。
+ */
+class GatherVecPhysicalOperator : public PhysicalOperator
+{
+public:
+  /**
+   * @param expressions 每个 worker 计算的投影表达式。为空时直接输出扫描到的所有列
+   */
+  GatherVecPhysicalOperator(vector<unique_ptr<Expression>> &&expressions, int parallel_degree);
+
+  virtual ~GatherVecPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::GATHER_VEC; }
+
+  string param() const override;
+
+  RC open(Trx *trx) override;
+  RC next(Chunk &chunk) override;
+  RC close() override;
+
+private:
+  /// 所有查询共享的 worker 线程池
+  static common::ThreadPoolExecutor &executor();
+
+  /// 在线程池中执行的一个 worker
+  void run_worker(int worker_id, Trx *trx, Session *session);
+
+  /// 把一个结果 chunk 交给消费者。队列满时等待，算子被关闭或者出错时返回 false
+  bool push_chunk(unique_ptr<Chunk> chunk);
+
+  /// worker 结束时调用，记录第一个错误
+  void finish_worker(RC rc);
+
+  /// 计算投影表达式，结果复制到 result 中，不再引用 chunk 的内存
+  static RC project(vector<unique_ptr<Expression>> &expressions, Chunk &chunk, Chunk &result);
+
+private:
+  vector<unique_ptr<Expression>> expressions_;
+  int                            parallel_degree_ = 1;
+  bool                           parallel_        = false;  ///< 是否在并行执行
+
+  PageMorselQueue                                  morsels_;
+  vector<unique_ptr<TableScanVecPhysicalOperator>> workers_;
+  vector<vector<unique_ptr<Expression>>>           worker_expressions_;
+
+  mutex                     lock_;
+  condition_variable        not_empty_;  ///< 有新的结果，或者 worker 结束
+  condition_variable        not_full_;   ///< 队列有空位，或者算子被关闭
+  deque<unique_ptr<Chunk>>  ready_chunks_;
+  size_t                    max_ready_chunks_ = 0;
+  int                       running_workers_  = 0;
+  bool                      cancelled_        = false;
+  RC                        first_error_      = RC::SUCCESS;
+
+  unique_ptr<Chunk> current_chunk_;  ///< next 返回的 chunk 引用的数据
+  Chunk             scan_chunk_;     ///< 单线程执行时子算子返回的数据
+};
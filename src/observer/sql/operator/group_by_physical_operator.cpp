@@ -33,13 +33,17 @@ GroupByPhysicalOperator::GroupByPhysicalOperator(vector<Expression *> &&expressi
   });
 }
 
-void GroupByPhysicalOperator::create_aggregator_list(AggregatorList &aggregator_list)
+void GroupByPhysicalOperator::create_aggregator_list(AggregatorList &aggregator_list, Arena *arena)
 {
   aggregator_list.clear();
   aggregator_list.reserve(aggregate_expressions_.size());
-  std::ranges::for_each(aggregate_expressions_, [&aggregator_list](Expression *expr) {
+  std::ranges::for_each(aggregate_expressions_, [&aggregator_list, arena](Expression *expr) {
     auto *aggregate_expr = static_cast<AggregateExpr *>(expr);
-    aggregator_list.emplace_back(aggregate_expr->create_aggregator());
+    if (arena != nullptr) {
+      aggregator_list.emplace_back(aggregate_expr->create_aggregator(*arena), AggregatorDeleter{true});
+    } else {
+      aggregator_list.emplace_back(aggregate_expr->create_aggregator().release(), AggregatorDeleter{false});
+    }
   });
 }
 
@@ -85,7 +89,7 @@ RC GroupByPhysicalOperator::evaluate(GroupValueType &group_value)
 
   ValueListTuple evaluated_tuple;
   vector<Value>  values;
-  for (unique_ptr<Aggregator> &aggregator : aggregators) {
+  for (auto &aggregator : aggregators) {
     Value value;
     rc = aggregator->evaluate(value);
     if (OB_FAIL(rc)) {
@@ -17,6 +17,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/tuple.h"
 #include "sql/operator/physical_operator.h"
 #include "sql/expr/composite_tuple.h"
+#include "storage/common/arena_allocator.h"
 
 /**
  * @brief Group By 物理算子基类
@@ -29,7 +30,7 @@ public:
   virtual ~GroupByPhysicalOperator() = default;
 
 protected:
-  using AggregatorList = vector<unique_ptr<Aggregator>>;
+  using AggregatorList = vector<unique_ptr<Aggregator, AggregatorDeleter>>;
   /**
    * @brief 聚合出来的一组数据
    * @details
@@ -42,7 +43,9 @@ protected:
   using GroupValueType = tuple<AggregatorList, CompositeTuple>;
 
 protected:
-  void create_aggregator_list(AggregatorList &aggregator_list);
+  /// @brief 创建聚合器列表
+  /// @param arena 不为空时在 arena 中分配聚合器，否则在堆上分配
+  void create_aggregator_list(AggregatorList &aggregator_list, Arena *arena = nullptr);
 
   /// @brief 聚合一条记录
   /// @param aggregator_list 需要执行聚合运算的列表
@@ -8,4 +8,176 @@ EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
 MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
-#include "sql/operator/group_by_vec_physical_operator.h"
\ No newline at end of file
+#include "common/log/log.h"
+#include "common/thread/thread_util.h"
+#include "sql/operator/group_by_vec_physical_operator.h"
+
+using namespace common;
+
+GroupByVecPhysicalOperator::GroupByVecPhysicalOperator(
+    vector<unique_ptr<Expression>> &&group_by_exprs, vector<Expression *> &&expressions)
+    : group_by_exprs_(std::move(group_by_exprs)), aggregate_expressions_(std::move(expressions))
+{
+  value_expressions_.reserve(aggregate_expressions_.size());
+  for (Expression *expr : aggregate_expressions_) {
+    ASSERT(expr->type() == ExprType::AGGREGATION, "expected an aggregation expression");
+    auto       *aggregate_expr = static_cast<AggregateExpr *>(expr);
+    Expression *child_expr     = aggregate_expr->child().get();
+    ASSERT(child_expr != nullptr, "aggregation expression must have a child expression");
+    value_expressions_.emplace_back(child_expr);
+  }
+
+  int col_id = 0;
+  for (auto &expr : group_by_exprs_) {
+    output_chunk_.add_column(make_unique<Column>(expr->value_type(), expr->value_length()), col_id++);
+  }
+  for (Expression *expr : aggregate_expressions_) {
+    output_chunk_.add_column(make_unique<Column>(expr->value_type(), expr->value_length()), col_id++);
+  }
+}
+
+RC GroupByVecPhysicalOperator::open(Trx *trx)
+{
+  ASSERT(children_.size() == 1, "group by operator only support one child, but got %d", children_.size());
+
+  PhysicalOperator &child = *children_[0];
+  RC                rc    = RC::UNSUPPORTED;
+
+  hash_tables_.clear();
+  current_table_ = 0;
+  if (parallel_degree_ > 1 && child.type() == PhysicalOperatorType::TABLE_SCAN_VEC) {
+    rc = parallel_aggregate(trx, static_cast<TableScanVecPhysicalOperator &>(child));
+    if (OB_FAIL(rc) && rc != RC::UNSUPPORTED) {
+      LOG_WARN("failed to aggregate in parallel. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  if (rc == RC::UNSUPPORTED) {
+    if (OB_FAIL(rc = child.open(trx))) {
+      LOG_INFO("failed to open child operator. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    hash_tables_.emplace_back(make_unique<StandardAggregateHashTable>(aggregate_expressions_));
+    while (OB_SUCC(rc = child.next(chunk_))) {
+      if (OB_FAIL(rc = add_chunk(*hash_tables_[0], chunk_))) {
+        return rc;
+      }
+    }
+
+    if (rc != RC::RECORD_EOF) {
+      LOG_WARN("failed to get next chunk from child. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  scanner_ = make_unique<StandardAggregateHashTable::Scanner>(hash_tables_[0].get());
+  scanner_->open_scan();
+  return RC::SUCCESS;
+}
+
+RC GroupByVecPhysicalOperator::add_chunk(StandardAggregateHashTable &hash_table, Chunk &chunk) const
+{
+  RC    rc = RC::SUCCESS;
+  Chunk groups_chunk;
+  Chunk aggrs_chunk;
+  for (size_t i = 0; i < group_by_exprs_.size(); i++) {
+    auto column = make_unique<Column>();
+    if (OB_FAIL(rc = group_by_exprs_[i]->get_column(chunk, *column))) {
+      LOG_WARN("failed to get group by column. rc=%s", strrc(rc));
+      return rc;
+    }
+    groups_chunk.add_column(std::move(column), i);
+  }
+  for (size_t i = 0; i < value_expressions_.size(); i++) {
+    auto column = make_unique<Column>();
+    if (OB_FAIL(rc = value_expressions_[i]->get_column(chunk, *column))) {
+      LOG_WARN("failed to get aggregate column. rc=%s", strrc(rc));
+      return rc;
+    }
+    aggrs_chunk.add_column(std::move(column), i);
+  }
+
+  if (OB_FAIL(rc = hash_table.add_chunk(groups_chunk, aggrs_chunk))) {
+    LOG_WARN("failed to add chunk to aggregate hash table. rc=%s", strrc(rc));
+    return rc;
+  }
+  return rc;
+}
+
+RC GroupByVecPhysicalOperator::parallel_aggregate(Trx *trx, TableScanVecPhysicalOperator &scan_oper)
+{
+  // 第一阶段：每个线程把扫描到的数据聚合到自己的哈希表中
+  vector<unique_ptr<StandardAggregateHashTable>> local_tables;
+  for (int i = 0; i < parallel_degree_; i++) {
+    local_tables.emplace_back(make_unique<StandardAggregateHashTable>(aggregate_expressions_));
+  }
+
+  RC rc = scan_oper.parallel_scan(trx, parallel_degree_, [this, &local_tables](int worker_id, Chunk &chunk) {
+    return add_chunk(*local_tables[worker_id], chunk);
+  });
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  // 第二阶段：每个线程负责一个分区，把所有线程私有哈希表中属于这个分区的分组合并到一起。
+  // 分区之间没有重复的分组，不需要再合并
+  for (int i = 0; i < parallel_degree_; i++) {
+    hash_tables_.emplace_back(make_unique<StandardAggregateHashTable>(aggregate_expressions_));
+  }
+
+  vector<RC> merge_rcs(parallel_degree_, RC::SUCCESS);
+  thread_run_parallel("ParallelAggMrg", parallel_degree_, [this, &local_tables, &merge_rcs](int partition) {
+    for (const unique_ptr<StandardAggregateHashTable> &local_table : local_tables) {
+      RC rc = hash_tables_[partition]->merge(*local_table, partition, parallel_degree_);
+      if (OB_FAIL(rc)) {
+        merge_rcs[partition] = rc;
+        return;
+      }
+    }
+  });
+
+  for (RC merge_rc : merge_rcs) {
+    if (OB_FAIL(merge_rc)) {
+      LOG_WARN("failed to merge aggregate hash tables. rc=%s", strrc(merge_rc));
+      return merge_rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC GroupByVecPhysicalOperator::next(Chunk &chunk)
+{
+  output_chunk_.reset_data();
+  while (current_table_ < hash_tables_.size()) {
+    RC rc = scanner_->next(output_chunk_);
+    if (rc == RC::RECORD_EOF) {
+      // 当前哈希表输出完了，继续输出下一个分区的哈希表
+      if (++current_table_ < hash_tables_.size()) {
+        scanner_ = make_unique<StandardAggregateHashTable::Scanner>(hash_tables_[current_table_].get());
+        scanner_->open_scan();
+      }
+      continue;
+    }
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    chunk.reference(output_chunk_);
+    return RC::SUCCESS;
+  }
+  return RC::RECORD_EOF;
+}
+
+RC GroupByVecPhysicalOperator::close()
+{
+  if (scanner_ != nullptr) {
+    scanner_->close_scan();
+    scanner_.reset();
+  }
+  hash_tables_.clear();
+  children_[0]->close();
+  LOG_INFO("close group by operator");
+  return RC::SUCCESS;
+}
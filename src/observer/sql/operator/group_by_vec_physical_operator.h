@@ -12,23 +12,56 @@ See the Mulan PSL v2 for more details. */
 
 #include "sql/expr/aggregate_hash_table.h"
 #include "sql/operator/physical_operator.h"
+#include "sql/operator/table_scan_vec_physical_operator.h"
 
 /**
  * @brief Group By 物理算子(vectorized)
  * @ingroup PhysicalOperator
+ * @details open 时把子算子的所有数据按块写入聚合哈希表，next 时从哈希表中按块输出结果。
+ * 输出的列依次是分组表达式和聚合表达式，与 LogicalPlanGenerator 中设置的表达式位置一致。
+ * 并行执行时，多个线程并行扫描子算子（表扫描），各自聚合到线程私有的哈希表中；然后按照分组的哈希值分区，
+ * 每个线程把所有私有哈希表中属于一个分区的分组合并到这个分区的哈希表中，最后依次输出每个分区的结果。
  */
 class GroupByVecPhysicalOperator : public PhysicalOperator
 {
 public:
-  GroupByVecPhysicalOperator(vector<unique_ptr<Expression>> &&group_by_exprs, vector<Expression *> &&expressions){};
+  GroupByVecPhysicalOperator(vector<unique_ptr<Expression>> &&group_by_exprs, vector<Expression *> &&expressions);
 
   virtual ~GroupByVecPhysicalOperator() = default;
 
   PhysicalOperatorType type() const override { return PhysicalOperatorType::GROUP_BY_VEC; }
 
-  RC open(Trx *trx) override { return RC::UNIMPLEMENTED; }
-  RC next(Chunk &chunk) override { return RC::UNIMPLEMENTED; }
-  RC close() override { return RC::UNIMPLEMENTED; }
+  RC open(Trx *trx) override;
+  RC next(Chunk &chunk) override;
+  RC close() override;
+
+  /**
+   * @brief 设置并行执行的线程数
+   * @details 只有子算子是表扫描并且存储引擎支持并行扫描时才会并行执行，否则还是单线程执行
+   */
+  void set_parallel_degree(int parallel_degree) { parallel_degree_ = parallel_degree; }
+
+private:
+  /// 计算 chunk 的分组列和聚合参数，写入哈希表。可以被多个线程同时调用，每个线程使用不同的哈希表
+  RC add_chunk(StandardAggregateHashTable &hash_table, Chunk &chunk) const;
+
+  /**
+   * @brief 并行聚合，结果保存在 hash_tables_ 中，每个分区一个哈希表
+   * @return RC::UNSUPPORTED 表示不能并行扫描，需要单线程执行
+   */
+  RC parallel_aggregate(Trx *trx, TableScanVecPhysicalOperator &scan_oper);
 
 private:
+  vector<unique_ptr<Expression>> group_by_exprs_;
+  vector<Expression *>           aggregate_expressions_;  /// 聚合表达式
+  vector<Expression *>           value_expressions_;      /// 聚合表达式的参数
+  int                            parallel_degree_ = 1;
+
+  /// 每次 open 时重新创建，执行计划可能被多次执行。单线程执行时只有一个哈希表
+  vector<unique_ptr<StandardAggregateHashTable>>  hash_tables_;
+  size_t                                          current_table_ = 0;  /// 正在输出的哈希表
+  unique_ptr<StandardAggregateHashTable::Scanner> scanner_;
+
+  Chunk chunk_;
+  Chunk output_chunk_;
 };
@@ -16,16 +16,68 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/hash_group_by_physical_operator.h"
 #include "sql/expr/expression_tuple.h"
 #include "sql/expr/composite_tuple.h"
+#include "common/lang/string_view.h"
 
 using namespace std;
 using namespace common;
 
+/**
+ * @brief 计算分组键中一个值的哈希值
+ * @details 相等（compare 返回0）的值需要有相同的哈希值。int 和 float 比较时会转换成 float，所以都按照 float 计算；
+ * 字符串比较时长度不同就不相等，结束符之后的内容不参与比较。
+ * 分组时 float 按照精确值比较（见 group_key_equal），而不是 Value::compare 的误差比较，
+ * 所以这里按照精确值计算哈希值即可。误差比较不满足传递性，不能用于划分分组。
+ */
+static uint64_t hash_value(const Value &value)
+{
+  switch (value.attr_type()) {
+    case AttrType::INTS:
+    case AttrType::FLOATS: {
+      float float_value = value.get_float();
+      if (float_value == 0) {
+        float_value = 0;  // -0.0 与 0.0 相等
+      }
+      uint32_t bits;
+      memcpy(&bits, &float_value, sizeof(bits));
+      return std::hash<uint32_t>()(bits);
+    }
+    case AttrType::CHARS: {
+      const char *data = value.data();
+      size_t      len  = strnlen(data, value.length());
+      return std::hash<string_view>()(string_view(data, len)) ^ static_cast<uint64_t>(value.length());
+    }
+    default: {
+      return std::hash<string_view>()(string_view(value.data(), value.length()));
+    }
+  }
+}
+
+/**
+ * @brief 比较分组键中的两个值是否属于同一个分组
+ * @details 与 hash_value 保持一致：只要有一个是 float 就按照精确值比较（与向量化的 hash group by 按字节比较的行为相同），
+ * 其它情况使用 Value::compare。NaN 和自身的比特相同时也认为相等，否则每个 NaN 都会单独成为一个分组。
+ */
+static bool group_key_equal(const Value &left, const Value &right)
+{
+  const bool left_numeric  = left.attr_type() == AttrType::INTS || left.attr_type() == AttrType::FLOATS;
+  const bool right_numeric = right.attr_type() == AttrType::INTS || right.attr_type() == AttrType::FLOATS;
+  if (left_numeric && right_numeric &&
+      (left.attr_type() == AttrType::FLOATS || right.attr_type() == AttrType::FLOATS)) {
+    float left_value  = left.get_float();
+    float right_value = right.get_float();
+    return left_value == right_value || memcmp(&left_value, &right_value, sizeof(float)) == 0;
+  }
+  return left.compare(right) == 0;
+}
+
 HashGroupByPhysicalOperator::HashGroupByPhysicalOperator(
     vector<unique_ptr<Expression>> &&group_by_exprs, vector<Expression *> &&expressions)
     : GroupByPhysicalOperator(std::move(expressions)), group_by_exprs_(std::move(group_by_exprs))
 {
 }
 
+HashGroupByPhysicalOperator::~HashGroupByPhysicalOperator() { destroy_groups(); }
+
 RC HashGroupByPhysicalOperator::open(Trx *trx)
 {
   ASSERT(children_.size() == 1, "group by operator only support one child, but got %d", children_.size());
@@ -39,7 +91,10 @@ RC HashGroupByPhysicalOperator::open(Trx *trx)
 
   ExpressionTuple<Expression *> group_value_expression_tuple(value_expressions_);
 
-  ValueListTuple group_by_evaluated_tuple;
+  destroy_groups();
+  arena_ = make_unique<Arena>();
+  buckets_.assign(DEFAULT_CAPACITY, Bucket());
+  group_by_values_.resize(group_by_exprs_.size());
 
   while (OB_SUCC(rc = child.next())) {
     Tuple *child_tuple = child.current_tuple();
@@ -49,8 +104,8 @@ RC HashGroupByPhysicalOperator::open(Trx *trx)
     }
 
     // 找到对应的group
-    GroupType *found_group = nullptr;
-    rc                     = find_group(*child_tuple, found_group);
+    Group *found_group = nullptr;
+    rc                 = find_group(*child_tuple, found_group);
     if (OB_FAIL(rc)) {
       LOG_WARN("failed to find group. rc=%s", strrc(rc));
       return rc;
@@ -60,8 +115,7 @@ RC HashGroupByPhysicalOperator::open(Trx *trx)
     group_value_expression_tuple.set_tuple(child_tuple);
 
     // 计算聚合值
-    GroupValueType &group_value = get<1>(*found_group);
-    rc = aggregate(get<0>(group_value), group_value_expression_tuple);
+    rc = aggregate(get<0>(found_group->group_value), group_value_expression_tuple);
     if (OB_FAIL(rc)) {
       LOG_WARN("failed to aggregate values. rc=%s", strrc(rc));
       return rc;
@@ -78,23 +132,22 @@ RC HashGroupByPhysicalOperator::open(Trx *trx)
   }
 
   // 得到最终聚合后的值
-  for (GroupType &group : groups_) {
-    GroupValueType &group_value = get<1>(group);
-    rc = evaluate(group_value);
+  for (Group *group : groups_) {
+    rc = evaluate(group->group_value);
     if (OB_FAIL(rc)) {
       LOG_WARN("failed to evaluate group value. rc=%s", strrc(rc));
       return rc;
     }
   }
 
-  current_group_ = groups_.begin();
+  current_group_ = 0;
   first_emited_  = false;
   return rc;
 }
 
 RC HashGroupByPhysicalOperator::next()
 {
-  if (current_group_ == groups_.end()) {
+  if (current_group_ >= groups_.size()) {
     return RC::RECORD_EOF;
   }
 
@@ -103,7 +156,7 @@ RC HashGroupByPhysicalOperator::next()
   } else {
     first_emited_ = true;
   }
-  if (current_group_ == groups_.end()) {
+  if (current_group_ >= groups_.size()) {
     return RC::RECORD_EOF;
   }
 
@@ -113,67 +166,118 @@ RC HashGroupByPhysicalOperator::next()
 RC HashGroupByPhysicalOperator::close()
 {
   children_[0]->close();
+  destroy_groups();
   LOG_INFO("close group by operator");
   return RC::SUCCESS;
 }
 
 Tuple *HashGroupByPhysicalOperator::current_tuple()
 {
-  if (current_group_ != groups_.end()) {
-    GroupValueType &group_value = get<1>(*current_group_);
-    return &get<1>(group_value);
+  if (current_group_ < groups_.size()) {
+    return &get<1>(groups_[current_group_]->group_value);
   }
   return nullptr;
 }
 
-RC HashGroupByPhysicalOperator::find_group(const Tuple &child_tuple, GroupType *&found_group)
+RC HashGroupByPhysicalOperator::find_group(const Tuple &child_tuple, Group *&found_group)
 {
   found_group = nullptr;
 
   RC rc = RC::SUCCESS;
 
-  ExpressionTuple<unique_ptr<Expression>> group_by_expression_tuple(group_by_exprs_);
-  ValueListTuple                          group_by_evaluated_tuple;
-  group_by_expression_tuple.set_tuple(&child_tuple);
-  rc = ValueListTuple::make(group_by_expression_tuple, group_by_evaluated_tuple);
-  if (OB_FAIL(rc)) {
-    LOG_WARN("failed to get values from expression tuple. rc=%s", strrc(rc));
-    return rc;
-  }
-
-  // 找到对应的group
-  for (GroupType &group : groups_) {
-    int compare_result = 0;
-    rc                 = group_by_evaluated_tuple.compare(get<0>(group), compare_result);
+  uint64_t hash = 0;
+  for (size_t i = 0; i < group_by_exprs_.size(); i++) {
+    rc = group_by_exprs_[i]->get_value(child_tuple, group_by_values_[i]);
     if (OB_FAIL(rc)) {
-      LOG_WARN("failed to compare group by values. rc=%s", strrc(rc));
+      LOG_WARN("failed to get values from expression tuple. rc=%s", strrc(rc));
       return rc;
     }
+    hash = hash * 31 + hash_value(group_by_values_[i]);
+  }
 
-    if (compare_result == 0) {
-      found_group = &group;
-      break;
+  // 找到对应的group
+  size_t mask  = buckets_.size() - 1;
+  size_t index = hash & mask;
+  while (buckets_[index].group != nullptr) {
+    const Bucket &bucket = buckets_[index];
+    if (bucket.hash == hash && group_by_values_equal(*bucket.group)) {
+      found_group = bucket.group;
+      return rc;
     }
+    index = (index + 1) & mask;
   }
 
   // 如果没有找到对应的group，创建一个新的group
-  if (nullptr == found_group) {
-    AggregatorList aggregator_list;
-    create_aggregator_list(aggregator_list);
+  rc = create_group(hash, child_tuple, found_group);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
 
-    ValueListTuple child_tuple_to_value;
-    rc = ValueListTuple::make(child_tuple, child_tuple_to_value);
-    if (OB_FAIL(rc)) {
-      LOG_WARN("failed to make tuple to value list. rc=%s", strrc(rc));
-      return rc;
-    }
+  buckets_[index].hash  = hash;
+  buckets_[index].group = found_group;
+  if (groups_.size() * 2 > buckets_.size()) {
+    resize();
+  }
+  return rc;
+}
 
-    CompositeTuple composite_tuple;
-    composite_tuple.add_tuple(make_unique<ValueListTuple>(std::move(child_tuple_to_value)));
-    groups_.emplace_back(std::move(group_by_evaluated_tuple), 
-                         GroupValueType(std::move(aggregator_list), std::move(composite_tuple)));
-    found_group = &groups_.back();
+RC HashGroupByPhysicalOperator::create_group(uint64_t hash, const Tuple &child_tuple, Group *&group)
+{
+  // 聚合器和分组一样在 arena 中分配，随分组一起析构
+  AggregatorList aggregator_list;
+  create_aggregator_list(aggregator_list, arena_.get());
+
+  ValueListTuple child_tuple_to_value;
+  RC             rc = ValueListTuple::make(child_tuple, child_tuple_to_value);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to make tuple to value list. rc=%s", strrc(rc));
+    return rc;
   }
 
+  CompositeTuple composite_tuple;
+  composite_tuple.add_tuple(make_unique<ValueListTuple>(std::move(child_tuple_to_value)));
+
+  group = new (arena_->AllocateAligned(sizeof(Group)))
+      Group{hash, group_by_values_, GroupValueType(std::move(aggregator_list), std::move(composite_tuple))};
+  groups_.push_back(group);
   return rc;
-}
\ No newline at end of file
+}
+
+bool HashGroupByPhysicalOperator::group_by_values_equal(const Group &group) const
+{
+  for (size_t i = 0; i < group_by_values_.size(); i++) {
+    if (!group_key_equal(group_by_values_[i], group.group_by_values[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void HashGroupByPhysicalOperator::resize()
+{
+  vector<Bucket> new_buckets(buckets_.size() * 2);
+  size_t         mask = new_buckets.size() - 1;
+  for (const Bucket &bucket : buckets_) {
+    if (bucket.group == nullptr) {
+      continue;
+    }
+    size_t index = bucket.hash & mask;
+    while (new_buckets[index].group != nullptr) {
+      index = (index + 1) & mask;
+    }
+    new_buckets[index] = bucket;
+  }
+  buckets_ = std::move(new_buckets);
+}
+
+void HashGroupByPhysicalOperator::destroy_groups()
+{
+  // 分组中的 Value、聚合器等需要析构，内存随 arena 一起释放
+  for (Group *group : groups_) {
+    group->~Group();
+  }
+  groups_.clear();
+  buckets_.clear();
+  arena_.reset();
+  current_group_ = 0;
+}
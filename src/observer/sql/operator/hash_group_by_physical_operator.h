@@ -16,20 +16,22 @@ See the Mulan PSL v2 for more details. */
 
 #include "sql/operator/group_by_physical_operator.h"
 #include "sql/expr/composite_tuple.h"
+#include "storage/common/arena_allocator.h"
 
 /**
  * @brief Group By Hash 方式物理算子
  * @ingroup PhysicalOperator
  * @details 通过 hash 的方式进行 group by 操作。当聚合函数存在 group by
- * 表达式时，默认采用这个物理算子（当前也只有这个物理算子）。 NOTE:
- * 当前并没有使用hash方式实现，而是每次使用线性查找的方式。
+ * 表达式时，默认采用这个物理算子（当前也只有这个物理算子）。
+ * 使用开放地址法（线性探测）的哈希表查找分组。每个分组在 arena 中分配，分组键的哈希值在创建分组时计算并保存下来，
+ * 探测时先比较哈希值，相同时再比较分组键，扩容时也不需要重新计算哈希值。
  */
 class HashGroupByPhysicalOperator : public GroupByPhysicalOperator
 {
 public:
   HashGroupByPhysicalOperator(vector<unique_ptr<Expression>> &&group_by_exprs, vector<Expression *> &&expressions);
 
-  virtual ~HashGroupByPhysicalOperator() = default;
+  virtual ~HashGroupByPhysicalOperator();
 
   PhysicalOperatorType type() const override { return PhysicalOperatorType::HASH_GROUP_BY; }
   OpType               get_op_type() const override { return OpType::HASHGROUPBY; }
@@ -43,20 +45,47 @@ public:
 private:
   using AggregatorList = GroupByPhysicalOperator::AggregatorList;
   using GroupValueType = GroupByPhysicalOperator::GroupValueType;
+
   /// 聚合出来的一组数据
-  using GroupType = tuple<ValueListTuple, GroupValueType>;
+  struct Group
+  {
+    uint64_t       hash;             ///< 分组键的哈希值
+    vector<Value>  group_by_values;  ///< 分组键，即 group by 表达式的值
+    GroupValueType group_value;
+  };
+
+  struct Bucket
+  {
+    uint64_t hash  = 0;
+    Group   *group = nullptr;  ///< 空指针表示空桶
+  };
 
 private:
-  RC find_group(const Tuple &child_tuple, GroupType *&found_group);
+  /**
+   * @brief 根据 group_by_values_ 找到对应的分组，不存在时创建
+   */
+  RC find_group(const Tuple &child_tuple, Group *&found_group);
+
+  RC create_group(uint64_t hash, const Tuple &child_tuple, Group *&group);
+
+  bool group_by_values_equal(const Group &group) const;
+
+  void resize();
+
+  /// 释放所有分组
+  void destroy_groups();
 
 private:
+  static constexpr size_t DEFAULT_CAPACITY = 1024;
+
   vector<unique_ptr<Expression>> group_by_exprs_;
 
-  /// 一组一条数据
-  /// pair的first是group by 的值列表，second是计算出来的表达式值列表
-  /// TODO 改成hash/unordered_map
-  vector<GroupType> groups_;
+  vector<Bucket>    buckets_;
+  vector<Group *>   groups_;  ///< 按照创建顺序记录所有的分组，用于输出结果
+  unique_ptr<Arena> arena_;   ///< 分组的内存，Arena 不能重置，每次 open 重新创建
+
+  vector<Value> group_by_values_;  ///< 当前元组的分组键，每个元组复用
 
-  vector<GroupType>::iterator current_group_;
-  bool                        first_emited_ = false;  /// 第一条数据是否已经输出
+  size_t current_group_ = 0;
+  bool   first_emited_  = false;  /// 第一条数据是否已经输出
 };
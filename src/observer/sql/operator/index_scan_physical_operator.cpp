@@ -16,19 +16,21 @@ See the Mulan PSL v2 for more details. */
 #include "storage/index/index.h"
 #include "storage/trx/trx.h"
 
-IndexScanPhysicalOperator::IndexScanPhysicalOperator(Table *table, Index *index, ReadWriteMode mode, const Value *left_value,
-    bool left_inclusive, const Value *right_value, bool right_inclusive)
+IndexScanPhysicalOperator::IndexScanPhysicalOperator(Table *table, Index *index, ReadWriteMode mode,
+    const char *left_key, int left_len, bool left_inclusive, const char *right_key, int right_len, bool right_inclusive)
     : table_(table),
       index_(index),
       mode_(mode),
+      has_left_key_(left_key != nullptr),
+      has_right_key_(right_key != nullptr),
       left_inclusive_(left_inclusive),
       right_inclusive_(right_inclusive)
 {
-  if (left_value) {
-    left_value_ = *left_value;
+  if (left_key) {
+    left_key_.assign(left_key, left_len);
   }
-  if (right_value) {
-    right_value_ = *right_value;
+  if (right_key) {
+    right_key_.assign(right_key, right_len);
   }
 }
 
@@ -38,11 +40,13 @@ RC IndexScanPhysicalOperator::open(Trx *trx)
     return RC::INTERNAL;
   }
 
-  IndexScanner *index_scanner = index_->create_scanner(left_value_.data(),
-      left_value_.length(),
+  // 没有设置边界的一侧表示不限制
+  IndexScanner *index_scanner = index_->create_scanner_with_trx(trx,
+      has_left_key_ ? left_key_.data() : nullptr,
+      static_cast<int>(left_key_.size()),
       left_inclusive_,
-      right_value_.data(),
-      right_value_.length(),
+      has_right_key_ ? right_key_.data() : nullptr,
+      static_cast<int>(right_key_.size()),
       right_inclusive_);
   if (nullptr == index_scanner) {
     LOG_WARN("failed to create index scanner");
@@ -50,7 +54,27 @@ RC IndexScanPhysicalOperator::open(Trx *trx)
   }
   index_scanner_ = index_scanner;
 
-  tuple_.set_schema(table_, table_->table_meta().field_metas());
+  if (index_only_) {
+    // 索引键是各个字段的值依次拼接起来的，按照字段在索引键中的位置构造一份字段元数据，
+    // 把索引键当作一条只包含这些字段的记录
+    key_field_metas_.clear();
+    int offset = 0;
+    for (const string &field_name : index_->index_meta().fields()) {
+      const FieldMeta *field_meta = table_->table_meta().field(field_name.c_str());
+      key_field_metas_.emplace_back(field_meta->name(),
+          field_meta->type(),
+          offset,
+          field_meta->len(),
+          field_meta->visible(),
+          field_meta->field_id());
+      offset += field_meta->len();
+    }
+    key_buffer_.resize(offset);
+    current_record_.set_data(key_buffer_.data(), offset);
+    tuple_.set_schema(table_, &key_field_metas_);
+  } else {
+    tuple_.set_schema(table_, table_->table_meta().field_metas());
+  }
 
   trx_ = trx;
   return RC::SUCCESS;
@@ -58,13 +82,16 @@ RC IndexScanPhysicalOperator::open(Trx *trx)
 
 RC IndexScanPhysicalOperator::next()
 {
-  // TODO: 需要适配 lsm-tree 引擎
+  if (index_only_) {
+    return next_index_only();
+  }
+
   RID rid;
   RC  rc = RC::SUCCESS;
 
   bool filter_result = false;
   while (RC::SUCCESS == (rc = index_scanner_->next_entry(&rid))) {
-    rc = table_->get_record(rid, current_record_);
+    rc = table_->get_record_with_trx(rid, current_record_, trx_);
     if (OB_FAIL(rc)) {
       LOG_TRACE("failed to get record. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
       return rc;
@@ -96,6 +123,33 @@ RC IndexScanPhysicalOperator::next()
   return rc;
 }
 
+RC IndexScanPhysicalOperator::next_index_only()
+{
+  RID         rid;
+  const char *key = nullptr;
+  RC          rc  = RC::SUCCESS;
+
+  bool filter_result = false;
+  while (RC::SUCCESS == (rc = index_scanner_->next_entry(&rid, key))) {
+    memcpy(key_buffer_.data(), key, key_buffer_.size());
+    current_record_.set_rid(rid);
+
+    tuple_.set_record(&current_record_);
+    rc = filter(tuple_, filter_result);
+    if (OB_FAIL(rc)) {
+      LOG_TRACE("failed to filter record. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    if (filter_result) {
+      return RC::SUCCESS;
+    }
+    LOG_TRACE("record filtered");
+  }
+
+  return rc;
+}
+
 RC IndexScanPhysicalOperator::close()
 {
   index_scanner_->destroy();
@@ -137,5 +191,9 @@ RC IndexScanPhysicalOperator::filter(RowTuple &tuple, bool &result)
 
 string IndexScanPhysicalOperator::param() const
 {
-  return string(index_->index_meta().name()) + " ON " + table_->name();
+  string param = string(index_->index_meta().name()) + " ON " + table_->name();
+  if (index_only_) {
+    param += " INDEX ONLY";
+  }
+  return param;
 }
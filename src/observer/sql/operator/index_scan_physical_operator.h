@@ -21,12 +21,18 @@ See the Mulan PSL v2 for more details. */
 /**
  * @brief 索引扫描物理算子
  * @ingroup PhysicalOperator
+ * @details 扫描区间的边界是索引键的原始数据。多字段索引的边界可以只包含前面几个字段，
+ * 比如索引 (a, b) 上 a=1 and b>5 的左边界是 (1, 5)，右边界是 (1)
  */
 class IndexScanPhysicalOperator : public PhysicalOperator
 {
 public:
-  IndexScanPhysicalOperator(Table *table, Index *index, ReadWriteMode mode, const Value *left_value,
-      bool left_inclusive, const Value *right_value, bool right_inclusive);
+  /**
+   * @param left_key 左边界，为 nullptr 时表示不限制
+   * @param right_key 右边界，为 nullptr 时表示不限制
+   */
+  IndexScanPhysicalOperator(Table *table, Index *index, ReadWriteMode mode, const char *left_key, int left_len,
+      bool left_inclusive, const char *right_key, int right_len, bool right_inclusive);
 
   virtual ~IndexScanPhysicalOperator() = default;
 
@@ -40,12 +46,23 @@ public:
 
   Tuple *current_tuple() override;
 
+  Index *index() const { return index_; }
+
   void set_predicates(vector<unique_ptr<Expression>> &&exprs);
 
+  /**
+   * @brief 设置为覆盖索引扫描
+   * @details 上层算子和过滤条件只用到了索引中的字段时，直接从索引键中取数据，不再回表读取记录。
+   * 记录的可见性需要从记录中判断，所以只能在不需要判断可见性的事务中使用
+   */
+  void set_index_only(bool index_only) { index_only_ = index_only; }
+
 private:
   // 与TableScanPhysicalOperator代码相同，可以优化
   RC filter(RowTuple &tuple, bool &result);
 
+  RC next_index_only();
+
 private:
   Trx          *trx_           = nullptr;
   Table        *table_         = nullptr;
@@ -56,10 +73,16 @@ private:
   Record   current_record_;
   RowTuple tuple_;
 
-  Value left_value_;
-  Value right_value_;
-  bool  left_inclusive_  = false;
-  bool  right_inclusive_ = false;
+  string left_key_;
+  string right_key_;
+  bool   has_left_key_    = false;
+  bool   has_right_key_   = false;
+  bool   left_inclusive_  = false;
+  bool   right_inclusive_ = false;
+
+  bool              index_only_ = false;
+  vector<FieldMeta> key_field_metas_;  ///< 覆盖索引扫描时，索引字段在索引键中的位置
+  vector<char>      key_buffer_;
 
   vector<unique_ptr<Expression>> predicates_;
 };
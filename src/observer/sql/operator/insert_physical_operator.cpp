@@ -13,6 +13,8 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "sql/operator/insert_physical_operator.h"
+#include "common/lang/algorithm.h"
+#include "sql/expr/expression.h"
 #include "sql/stmt/insert_stmt.h"
 #include "storage/table/table.h"
 #include "storage/trx/trx.h"
@@ -25,8 +27,24 @@ InsertPhysicalOperator::InsertPhysicalOperator(Table *table, vector<Value> &&val
 
 RC InsertPhysicalOperator::open(Trx *trx)
 {
+  // 预处理语句每次执行时，用客户端传入的参数替换占位符
+  const vector<Value> *values = &values_;
+  vector<Value>        bound_values;
+  if (any_of(values_.begin(), values_.end(), [](const Value &value) { return value.is_param(); })) {
+    bound_values = values_;
+    for (Value &value : bound_values) {
+      if (value.is_param()) {
+        RC rc = ParamExpr::bound_value(value.param_index(), value);
+        if (OB_FAIL(rc)) {
+          return rc;
+        }
+      }
+    }
+    values = &bound_values;
+  }
+
   Record record;
-  RC     rc = table_->make_record(static_cast<int>(values_.size()), values_.data(), record);
+  RC     rc = table_->make_record(static_cast<int>(values->size()), values->data(), record);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to make record. rc=%s", strrc(rc));
     return rc;
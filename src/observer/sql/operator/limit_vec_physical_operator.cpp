@@ -0,0 +1,52 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/limit_vec_physical_operator.h"
+#include "common/log/log.h"
+
+RC LimitVecPhysicalOperator::open(Trx *trx)
+{
+  if (children_.size() != 1) {
+    LOG_WARN("limit operator must has one child");
+    return RC::INTERNAL;
+  }
+
+  count_ = 0;
+  return children_.front()->open(trx);
+}
+
+RC LimitVecPhysicalOperator::next(Chunk &chunk)
+{
+  // 够数之后就不再从下层算子取数据了
+  if (count_ >= limit_) {
+    return RC::RECORD_EOF;
+  }
+
+  RC rc = children_.front()->next(chunk_);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  // 引用下层算子的数据，只修改引用的行数，不拷贝数据
+  rc = chunk.reference(chunk_);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  if (count_ + chunk.rows() > limit_) {
+    const int rows = limit_ - count_;
+    for (int i = 0; i < chunk.column_num(); i++) {
+      chunk.column(i).set_count(rows);
+    }
+  }
+  count_ += chunk.rows();
+  return rc;
+}
+
+RC LimitVecPhysicalOperator::close() { return children_.front()->close(); }
@@ -0,0 +1,38 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "sql/operator/physical_operator.h"
+
+/**
+ * @brief limit 物理算子(vectorized)，只输出下层算子的前 limit 行
+ * @ingroup PhysicalOperator
+ */
+class LimitVecPhysicalOperator : public PhysicalOperator
+{
+public:
+  LimitVecPhysicalOperator(int limit) : limit_(limit) {}
+
+  virtual ~LimitVecPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::LIMIT_VEC; }
+
+  string param() const override { return std::to_string(limit_); }
+
+  RC open(Trx *trx) override;
+  RC next(Chunk &chunk) override;
+  RC close() override;
+
+private:
+  int   limit_ = 0;
+  int   count_ = 0;  ///< 已经输出的行数
+  Chunk chunk_;
+};
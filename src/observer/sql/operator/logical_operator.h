@@ -40,6 +40,8 @@ enum class LogicalOperatorType
   DELETE,      ///< 删除，删除可能会有子查询
   EXPLAIN,     ///< 查看执行计划
   GROUP_BY,    ///< 分组
+  ORDER_BY,    ///< 排序
+  LIMIT,       ///< 限制输出的行数
 };
 
 /**
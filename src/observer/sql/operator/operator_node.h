@@ -35,6 +35,7 @@ enum class OpType
   LOGICALINSERT,
   LOGICALDELETE,
   LOGICALUPDATE,
+  LOGICALORDERBY,
   LOGICALLIMIT,
   LOGICALANALYZE,
   LOGICALEXPLAIN,
@@ -46,6 +47,7 @@ enum class OpType
   CALCULATE,
   SEQSCAN,
   INDEXSCAN,
+  VECTORINDEXSCAN,
   ORDERBY,
   LIMIT,
   INNERINDEXJOIN,
@@ -0,0 +1,146 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/order_by_physical_operator.h"
+#include "common/lang/algorithm.h"
+#include "common/log/log.h"
+#include "sql/expr/sort_key.h"
+
+OrderByPhysicalOperator::OrderByPhysicalOperator(
+    vector<unique_ptr<Expression>> &&expressions, const vector<bool> &ascending)
+    : expressions_(std::move(expressions)), ascending_(ascending)
+{
+  ASSERT(expressions_.size() == ascending_.size(), "order by expressions and directions mismatch");
+}
+
+string OrderByPhysicalOperator::param() const { return limit_ >= 0 ? "limit=" + to_string(limit_) : ""; }
+
+RC OrderByPhysicalOperator::open(Trx *trx)
+{
+  if (children_.size() != 1) {
+    LOG_WARN("order by operator must has one child");
+    return RC::INTERNAL;
+  }
+
+  PhysicalOperator *child = children_.front().get();
+  RC                rc    = child->open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open child operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  rows_.clear();
+  order_.clear();
+  current_ = 0;
+
+  const bool top_n = limit_ >= 0;
+  auto       cmp   = [this](size_t left, size_t right) { return less(left, right); };
+  size_t     seq   = 0;
+  Value      value;
+  while (limit_ != 0 && OB_SUCC(rc = child->next())) {
+    Tuple *tuple = child->current_tuple();
+    if (nullptr == tuple) {
+      LOG_WARN("failed to get tuple from child operator");
+      return RC::INTERNAL;
+    }
+
+    string key;
+    for (size_t i = 0; i < expressions_.size(); i++) {
+      rc = expressions_[i]->get_value(*tuple, value);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to get order by value. rc=%s", strrc(rc));
+        return rc;
+      }
+      rc = SortKeyEncoder::append(value, ascending_[i], key);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to encode order by value. value=%s, rc=%s", value.to_string().c_str(), strrc(rc));
+        return rc;
+      }
+    }
+
+    size_t slot = rows_.size();
+    if (top_n && order_.size() >= static_cast<size_t>(limit_)) {
+      // 后来的元组排序键相同时排在后面，不比堆顶小的元组不会出现在结果中
+      if (key >= rows_[order_.front()].key) {
+        seq++;
+        continue;
+      }
+      pop_heap(order_.begin(), order_.end(), cmp);
+      slot = order_.back();
+    } else {
+      rows_.emplace_back();
+      order_.push_back(slot);
+    }
+
+    // 下层算子的元组在调用 next 之后就失效了，需要把值拷贝出来
+    SortRow &row = rows_[slot];
+    row.key      = std::move(key);
+    row.seq      = seq++;
+    row.tuple    = ValueListTuple();  // 堆中被替换的位置上还有之前的值
+    rc           = ValueListTuple::make(*tuple, row.tuple);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to copy tuple. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    if (top_n) {
+      push_heap(order_.begin(), order_.end(), cmp);
+    }
+  }
+
+  if (limit_ != 0 && rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to fetch tuple from child operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  sort(order_.begin(), order_.end(), cmp);
+  return RC::SUCCESS;
+}
+
+bool OrderByPhysicalOperator::less(size_t left, size_t right) const
+{
+  const SortRow &left_row  = rows_[left];
+  const SortRow &right_row = rows_[right];
+  int            result    = left_row.key.compare(right_row.key);
+  if (result != 0) {
+    return result < 0;
+  }
+  return left_row.seq < right_row.seq;
+}
+
+RC OrderByPhysicalOperator::next()
+{
+  if (current_ >= order_.size()) {
+    return RC::RECORD_EOF;
+  }
+
+  current_++;
+  return RC::SUCCESS;
+}
+
+RC OrderByPhysicalOperator::close()
+{
+  rows_.clear();
+  order_.clear();
+  return children_.front()->close();
+}
+
+Tuple *OrderByPhysicalOperator::current_tuple()
+{
+  if (current_ == 0 || current_ > order_.size()) {
+    return nullptr;
+  }
+  return &rows_[order_[current_ - 1]].tuple;
+}
+
+RC OrderByPhysicalOperator::tuple_schema(TupleSchema &schema) const
+{
+  return children_.front()->tuple_schema(schema);
+}
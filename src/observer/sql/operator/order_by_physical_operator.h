@@ -0,0 +1,68 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "sql/expr/expression.h"
+#include "sql/operator/physical_operator.h"
+
+/**
+ * @brief 排序物理算子
+ * @ingroup PhysicalOperator
+ * @details 在 open 时把下层算子的所有元组读到内存中排序，排序键相同的元组保持原来的顺序。
+ * 排序键编码成可以直接比较的二进制串（参考 SortKeyEncoder）。
+ * 设置了 limit 时只保留排在最前面的 limit 行（Top-N），使用一个大小为 limit 的大顶堆，
+ * 比堆顶大的元组不需要拷贝。
+ */
+class OrderByPhysicalOperator : public PhysicalOperator
+{
+public:
+  OrderByPhysicalOperator(vector<unique_ptr<Expression>> &&expressions, const vector<bool> &ascending);
+
+  virtual ~OrderByPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::ORDER_BY; }
+  OpType               get_op_type() const override { return OpType::ORDERBY; }
+
+  string param() const override;
+
+  /**
+   * @brief 只输出排序之后的前 limit 行
+   */
+  void set_limit(int limit) { limit_ = limit; }
+
+  RC open(Trx *trx) override;
+  RC next() override;
+  RC close() override;
+
+  Tuple *current_tuple() override;
+
+  RC tuple_schema(TupleSchema &schema) const override;
+
+private:
+  struct SortRow
+  {
+    string         key;  ///< 编码之后的排序键
+    size_t         seq;  ///< 元组在输入中的顺序，排序键相同时保持原来的顺序
+    ValueListTuple tuple;
+  };
+
+  /// 返回 true 表示 left 排在 right 前面
+  bool less(size_t left, size_t right) const;
+
+private:
+  vector<unique_ptr<Expression>> expressions_;
+  vector<bool>                   ascending_;
+  int                            limit_ = -1;  ///< 小于0表示输出所有的元组
+
+  vector<SortRow> rows_;
+  vector<size_t>  order_;  ///< 排序之后元组在 rows_ 中的下标。Top-N 时在读取数据的过程中是一个大顶堆
+  size_t          current_ = 0;
+};
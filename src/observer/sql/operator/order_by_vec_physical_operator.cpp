@@ -0,0 +1,283 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/order_by_vec_physical_operator.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/atomic.h"
+#include "common/lang/filesystem.h"
+#include "common/log/log.h"
+#include "sql/expr/sort_key.h"
+
+#include <unistd.h>
+
+using namespace std;
+
+OrderByVecPhysicalOperator::OrderByVecPhysicalOperator(
+    vector<unique_ptr<Expression>> &&expressions, const vector<bool> &ascending, size_t sort_memory)
+    : expressions_(std::move(expressions)), ascending_(ascending), sort_memory_(sort_memory)
+{
+  ASSERT(expressions_.size() == ascending_.size(), "order by expressions and directions mismatch");
+}
+
+string OrderByVecPhysicalOperator::param() const { return limit_ >= 0 ? "limit=" + to_string(limit_) : ""; }
+
+RC OrderByVecPhysicalOperator::open(Trx *trx)
+{
+  ASSERT(children_.size() == 1, "order by operator only support one child, but got %d", children_.size());
+
+  PhysicalOperator &child = *children_[0];
+  RC                rc    = child.open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open child operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  initialized_ = false;
+  seq_         = 0;
+  output_rows_ = 0;
+  heap_items_.clear();
+  heap_.clear();
+  heap_pos_ = 0;
+  sorter_.reset();
+
+  Chunk chunk;
+  while (limit_ != 0 && OB_SUCC(rc = child.next(chunk))) {
+    if (chunk.rows() == 0) {
+      continue;
+    }
+    if (OB_FAIL(rc = add_chunk(chunk))) {
+      LOG_WARN("failed to add chunk into sorter. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+  if (limit_ != 0 && rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to fetch chunk from child operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  if (!initialized_) {
+    return RC::SUCCESS;
+  }
+
+  if (top_n_) {
+    sort(heap_.begin(), heap_.end(), [this](int left, int right) {
+      return memcmp(&heap_items_[static_cast<size_t>(left) * item_size_],
+                 &heap_items_[static_cast<size_t>(right) * item_size_],
+                 key_size_) < 0;
+    });
+  } else if (OB_FAIL(rc = sorter_->finish())) {
+    LOG_WARN("failed to finish external sort. rc=%s", strrc(rc));
+    return rc;
+  } else if (sorter_->run_num() > 0) {
+    LOG_INFO("order by spilled to disk. rows=%ld, runs=%d", sorter_->count(), sorter_->run_num());
+  }
+  return RC::SUCCESS;
+}
+
+RC OrderByVecPhysicalOperator::init_layout(Chunk &chunk, vector<unique_ptr<Column>> &key_columns)
+{
+  key_layouts_.clear();
+  column_layouts_.clear();
+
+  key_size_ = 0;
+  for (size_t i = 0; i < key_columns.size(); i++) {
+    const Column &column = *key_columns[i];
+    int           length = SortKeyEncoder::fixed_length(column.attr_type(), column.attr_len());
+    if (length < 0) {
+      LOG_WARN("unsupported order by type: %s", attr_type_to_string(column.attr_type()));
+      return RC::UNSUPPORTED;
+    }
+    key_layouts_.push_back({column.attr_type(), column.attr_len(), static_cast<int>(i)});
+    key_size_ += length;
+  }
+  key_size_ += sizeof(seq_);
+
+  item_size_ = key_size_;
+  for (int i = 0; i < chunk.column_num(); i++) {
+    const Column &column = chunk.column(i);
+    column_layouts_.push_back({column.attr_type(), column.attr_len(), chunk.column_ids(i)});
+    item_size_ += column.attr_len();
+  }
+  item_.resize(item_size_);
+
+  output_.reset();
+  for (const ColumnLayout &layout : column_layouts_) {
+    output_.add_column(make_unique<Column>(layout.type, layout.attr_len), layout.column_id);
+  }
+
+  // limit 行数据可以放到内存中时使用堆，否则退化成完整的外部排序
+  top_n_ = limit_ > 0 && static_cast<size_t>(limit_) * (item_size_ + sizeof(int)) <= sort_memory_;
+  if (!top_n_) {
+    static atomic<int64_t> sort_sequence(0);
+    string temp_file_prefix = (filesystem::temp_directory_path() /
+                                  ("miniob_sort_" + to_string(getpid()) + "_" + to_string(sort_sequence++)))
+                                  .string();
+    sorter_ = make_unique<ExternalSorter>(
+        item_size_,
+        [this](const char *left, const char *right) { return memcmp(left, right, key_size_); },
+        sort_memory_,
+        std::move(temp_file_prefix));
+  }
+
+  initialized_ = true;
+  return RC::SUCCESS;
+}
+
+RC OrderByVecPhysicalOperator::add_chunk(Chunk &chunk)
+{
+  RC                         rc = RC::SUCCESS;
+  vector<unique_ptr<Column>> key_columns;
+  for (unique_ptr<Expression> &expr : expressions_) {
+    auto column = make_unique<Column>();
+    if (OB_FAIL(rc = expr->get_column(chunk, *column))) {
+      LOG_WARN("failed to get column of order by expression. rc=%s", strrc(rc));
+      return rc;
+    }
+    key_columns.emplace_back(std::move(column));
+  }
+
+  if (!initialized_ && OB_FAIL(rc = init_layout(chunk, key_columns))) {
+    return rc;
+  }
+
+  if (chunk.column_num() != static_cast<int>(column_layouts_.size())) {
+    LOG_WARN("column number of chunks mismatch. expect=%d, actual=%d", column_layouts_.size(), chunk.column_num());
+    return RC::INTERNAL;
+  }
+  for (size_t i = 0; i < key_columns.size(); i++) {
+    if (key_columns[i]->attr_len() != key_layouts_[i].attr_len) {
+      LOG_WARN("length of order by column mismatch. expect=%d, actual=%d",
+          key_layouts_[i].attr_len, key_columns[i]->attr_len());
+      return RC::INTERNAL;
+    }
+  }
+
+  auto value_at = [](const Column &column, int row) {
+    // 常量列只有一个值
+    const int index = column.column_type() == Column::Type::CONSTANT_COLUMN ? 0 : row;
+    return column.data() + static_cast<size_t>(index) * column.attr_len();
+  };
+
+  char *item = item_.data();
+  for (int row = 0; row < chunk.rows(); row++) {
+    char *dest = item;
+    for (size_t i = 0; i < key_columns.size(); i++) {
+      const ColumnLayout &layout = key_layouts_[i];
+      SortKeyEncoder::encode_fixed(layout.type, value_at(*key_columns[i], row), layout.attr_len, ascending_[i], dest);
+      dest += SortKeyEncoder::fixed_length(layout.type, layout.attr_len);
+    }
+    // 序号按大端序存储，memcmp 时先出现的行更小
+    for (int shift = (sizeof(seq_) - 1) * 8; shift >= 0; shift -= 8) {
+      *dest++ = static_cast<char>(seq_ >> shift);
+    }
+    seq_++;
+
+    // 比堆顶大的行不需要再拷贝列的值
+    if (top_n_ && heap_.size() >= static_cast<size_t>(limit_) &&
+        memcmp(item, &heap_items_[static_cast<size_t>(heap_.front()) * item_size_], key_size_) >= 0) {
+      continue;
+    }
+
+    for (int i = 0; i < chunk.column_num(); i++) {
+      const Column &column = chunk.column(i);
+      memcpy(dest, value_at(column, row), column.attr_len());
+      dest += column.attr_len();
+    }
+
+    if (top_n_) {
+      add_to_heap();
+    } else if (OB_FAIL(rc = sorter_->add(item))) {
+      LOG_WARN("failed to add row into external sorter. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+  return rc;
+}
+
+void OrderByVecPhysicalOperator::add_to_heap()
+{
+  auto cmp = [this](int left, int right) {
+    return memcmp(&heap_items_[static_cast<size_t>(left) * item_size_],
+               &heap_items_[static_cast<size_t>(right) * item_size_],
+               key_size_) < 0;
+  };
+
+  int slot = static_cast<int>(heap_.size());
+  if (heap_.size() >= static_cast<size_t>(limit_)) {
+    pop_heap(heap_.begin(), heap_.end(), cmp);
+    slot = heap_.back();
+  } else {
+    heap_items_.resize(heap_items_.size() + item_size_);
+    heap_.push_back(slot);
+  }
+
+  memcpy(&heap_items_[static_cast<size_t>(slot) * item_size_], item_.data(), item_size_);
+  push_heap(heap_.begin(), heap_.end(), cmp);
+}
+
+RC OrderByVecPhysicalOperator::next_item(const char *&item)
+{
+  if (limit_ >= 0 && output_rows_ >= limit_) {
+    return RC::RECORD_EOF;
+  }
+
+  if (top_n_) {
+    if (heap_pos_ >= heap_.size()) {
+      return RC::RECORD_EOF;
+    }
+    item = &heap_items_[static_cast<size_t>(heap_[heap_pos_++]) * item_size_];
+    output_rows_++;
+    return RC::SUCCESS;
+  }
+
+  RC rc = sorter_->next(item);
+  if (OB_SUCC(rc)) {
+    output_rows_++;
+  }
+  return rc;
+}
+
+RC OrderByVecPhysicalOperator::next(Chunk &chunk)
+{
+  if (!initialized_) {
+    return RC::RECORD_EOF;
+  }
+
+  RC rc = RC::SUCCESS;
+  output_.reset_data();
+  const char *item = nullptr;
+  while (output_.rows() < output_.capacity() && OB_SUCC(rc = next_item(item))) {
+    const char *src = item + key_size_;
+    for (int i = 0; i < output_.column_num(); i++) {
+      Column &column = output_.column(i);
+      column.append_one(src);
+      src += column.attr_len();
+    }
+  }
+
+  if (rc != RC::SUCCESS && rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to fetch sorted row. rc=%s", strrc(rc));
+    return rc;
+  }
+  if (output_.rows() == 0) {
+    return RC::RECORD_EOF;
+  }
+  return chunk.reference(output_);
+}
+
+RC OrderByVecPhysicalOperator::close()
+{
+  sorter_.reset();
+  heap_items_.clear();
+  heap_.clear();
+  output_.reset();
+  initialized_ = false;
+  return children_[0]->close();
+}
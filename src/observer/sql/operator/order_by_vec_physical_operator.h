@@ -0,0 +1,94 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "sql/expr/expression.h"
+#include "sql/operator/physical_operator.h"
+#include "storage/common/external_sorter.h"
+
+/**
+ * @brief 排序物理算子(vectorized)
+ * @ingroup PhysicalOperator
+ * @details 输出的 chunk 与下层算子的 chunk 有相同的列。下层算子的每一行被编码成一条定长的数据：
+ * 排序键 | 序号 | 每一列的值。排序键使用 SortKeyEncoder 的定长编码，序号保证排序键相同的行保持原来的顺序，
+ * 所以整条数据的前半部分可以直接用 memcmp 比较。
+ * - 没有设置 limit，或者 limit 行数据超过了内存预算时，使用 ExternalSorter 做外部排序，
+ *   超过内存预算的数据会排好序写到临时文件中，最后多路归并；
+ * - 设置了 limit 并且 limit 行数据可以放到内存中时（Top-N），使用一个大小为 limit 的大顶堆。
+ */
+class OrderByVecPhysicalOperator : public PhysicalOperator
+{
+public:
+  static constexpr size_t DEFAULT_SORT_MEMORY = 64 * 1024 * 1024;  /// 排序可以使用的内存
+
+  OrderByVecPhysicalOperator(vector<unique_ptr<Expression>> &&expressions, const vector<bool> &ascending,
+      size_t sort_memory = DEFAULT_SORT_MEMORY);
+
+  virtual ~OrderByVecPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::ORDER_BY_VEC; }
+
+  string param() const override;
+
+  /**
+   * @brief 只输出排序之后的前 limit 行
+   */
+  void set_limit(int limit) { limit_ = limit; }
+
+  RC open(Trx *trx) override;
+  RC next(Chunk &chunk) override;
+  RC close() override;
+
+private:
+  /// 数据中一列的格式
+  struct ColumnLayout
+  {
+    AttrType type;
+    int      attr_len;
+    int      column_id;  ///< 下层算子 chunk 中的列编号，输出时保持不变
+  };
+
+  /// 根据下层算子的第一个 chunk 确定数据的格式，选择排序的方式
+  RC init_layout(Chunk &chunk, vector<unique_ptr<Column>> &key_columns);
+
+  /// 把一个 chunk 中的所有行编码之后加入排序
+  RC add_chunk(Chunk &chunk);
+
+  /// Top-N 时把 item_ 放到堆中。排序键不比堆顶小的数据直接丢弃
+  void add_to_heap();
+
+  /// 按照顺序返回下一条数据
+  RC next_item(const char *&item);
+
+private:
+  vector<unique_ptr<Expression>> expressions_;
+  vector<bool>                   ascending_;
+  int                            limit_       = -1;  ///< 小于0表示输出所有行
+  size_t                         sort_memory_ = DEFAULT_SORT_MEMORY;
+
+  bool                 initialized_ = false;
+  vector<ColumnLayout> key_layouts_;     ///< 排序键的每一列
+  vector<ColumnLayout> column_layouts_;  ///< 下层算子 chunk 的每一列
+  int                  key_size_  = 0;   ///< 排序键加上序号的长度
+  int                  item_size_ = 0;
+  int64_t              seq_       = 0;
+  vector<char>         item_;  ///< 正在编码的一行数据
+
+  unique_ptr<ExternalSorter> sorter_;
+
+  bool         top_n_ = false;
+  vector<char> heap_items_;  ///< Top-N 时保存的数据
+  vector<int>  heap_;        ///< heap_items_ 中数据的下标。读取数据的过程中是一个大顶堆，之后按顺序排列
+  size_t       heap_pos_ = 0;
+
+  int64_t output_rows_ = 0;
+  Chunk   output_;
+};
@@ -37,6 +37,7 @@ enum class PhysicalOperatorType
   TABLE_SCAN,
   TABLE_SCAN_VEC,
   INDEX_SCAN,
+  VECTOR_INDEX_SCAN,
   NESTED_LOOP_JOIN,
   HASH_JOIN,
   EXPLAIN,
@@ -53,6 +54,11 @@ enum class PhysicalOperatorType
   GROUP_BY_VEC,
   AGGREGATE_VEC,
   EXPR_VEC,
+  GATHER_VEC,
+  ORDER_BY,
+  ORDER_BY_VEC,
+  LIMIT,
+  LIMIT_VEC,
 };
 
 /**
@@ -9,32 +9,153 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #include "sql/operator/table_scan_vec_physical_operator.h"
+#include "common/lang/mutex.h"
+#include "common/thread/thread_util.h"
 #include "event/sql_debug.h"
+#include "session/session.h"
 #include "storage/table/table.h"
 
 using namespace std;
+using namespace common;
+
+/**
+ * @brief 找出过滤条件中与常量比较的字符串字段
+ * @details 这些字段在扫描时做字典编码，比较时每个字典项只需要与常量比较一次
+ */
+static void collect_compared_fields(Expression &expr, vector<int> &field_ids)
+{
+  if (expr.type() == ExprType::CONJUNCTION) {
+    for (unique_ptr<Expression> &child : static_cast<ConjunctionExpr &>(expr).children()) {
+      collect_compared_fields(*child, field_ids);
+    }
+    return;
+  }
+  if (expr.type() != ExprType::COMPARISON) {
+    return;
+  }
+
+  auto &comparison_expr = static_cast<ComparisonExpr &>(expr);
+  for (auto [field_expr, other_expr] : {pair(comparison_expr.left().get(), comparison_expr.right().get()),
+           pair(comparison_expr.right().get(), comparison_expr.left().get())}) {
+    if (field_expr->type() == ExprType::FIELD && other_expr->type() == ExprType::VALUE &&
+        field_expr->value_type() == AttrType::CHARS) {
+      field_ids.push_back(static_cast<FieldExpr *>(field_expr)->field().meta()->field_id());
+    }
+  }
+}
+
+/**
+ * @brief 找出过滤条件中可以用 zone map 判断的 字段 op 常量 条件
+ * @details 只处理 AND 连接的条件，OR 连接的条件无法单独用来跳过页面
+ */
+static void collect_zone_map_predicates(Expression &expr, vector<ZoneMapPredicate> &predicates)
+{
+  if (expr.type() == ExprType::CONJUNCTION) {
+    auto &conjunction_expr = static_cast<ConjunctionExpr &>(expr);
+    if (conjunction_expr.conjunction_type() == ConjunctionExpr::Type::AND) {
+      for (unique_ptr<Expression> &child : conjunction_expr.children()) {
+        collect_zone_map_predicates(*child, predicates);
+      }
+    }
+    return;
+  }
+  if (expr.type() != ExprType::COMPARISON) {
+    return;
+  }
+
+  auto       &comparison_expr = static_cast<ComparisonExpr &>(expr);
+  Expression *left            = comparison_expr.left().get();
+  Expression *right           = comparison_expr.right().get();
+  CompOp      comp            = comparison_expr.comp();
+  if (left->type() == ExprType::VALUE && right->type() == ExprType::FIELD) {
+    // 常量 op 字段 转换成 字段 op' 常量
+    swap(left, right);
+    switch (comp) {
+      case LESS_THAN: comp = GREAT_THAN; break;
+      case LESS_EQUAL: comp = GREAT_EQUAL; break;
+      case GREAT_THAN: comp = LESS_THAN; break;
+      case GREAT_EQUAL: comp = LESS_EQUAL; break;
+      default: break;
+    }
+  }
+  if (left->type() != ExprType::FIELD || right->type() != ExprType::VALUE) {
+    return;
+  }
+
+  const FieldMeta *field_meta = static_cast<FieldExpr *>(left)->field().meta();
+  if (!ZoneMap::support(field_meta->type(), field_meta->len())) {
+    return;
+  }
+  ZoneMapPredicate predicate;
+  predicate.field_id = field_meta->field_id();
+  predicate.comp     = comp;
+  predicate.value    = static_cast<ValueExpr *>(right)->get_value();
+  predicates.push_back(std::move(predicate));
+}
 
 RC TableScanVecPhysicalOperator::open(Trx *trx)
 {
-  RC rc = table_->get_chunk_scanner(chunk_scanner_, trx, mode_);
+  RC rc = morsels_ == nullptr ? table_->get_chunk_scanner(chunk_scanner_, trx, mode_)
+                              : table_->get_chunk_scanner(chunk_scanner_, trx, mode_, *morsels_);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to get chunk scanner", strrc(rc));
     return rc;
   }
+
+  vector<ZoneMapPredicate> zone_map_predicates;
+  for (unique_ptr<Expression> &predicate : predicates_) {
+    collect_zone_map_predicates(*predicate, zone_map_predicates);
+  }
+  chunk_scanner_.set_zone_map_predicates(std::move(zone_map_predicates));
   // TODO: don't need to fetch all columns from record manager
+  all_columns_.reset();
+  filterd_columns_.reset();
   for (int i = 0; i < table_->table_meta().field_num(); ++i) {
     all_columns_.add_column(
         make_unique<Column>(*table_->table_meta().field(i)), table_->table_meta().field(i)->field_id());
     filterd_columns_.add_column(
         make_unique<Column>(*table_->table_meta().field(i)), table_->table_meta().field(i)->field_id());
   }
+  reset_dictionaries();
   return rc;
 }
 
+void TableScanVecPhysicalOperator::reset_dictionaries()
+{
+  vector<int> encoded_fields = dictionary_fields_;
+  for (unique_ptr<Expression> &predicate : predicates_) {
+    collect_compared_fields(*predicate, encoded_fields);
+  }
+
+  for (int i = 0; i < all_columns_.column_num(); i++) {
+    const int field_id = all_columns_.column_ids(i);
+    Column   &column   = all_columns_.column(i);
+    if (column.attr_type() != AttrType::CHARS ||
+        find(encoded_fields.begin(), encoded_fields.end(), field_id) == encoded_fields.end()) {
+      continue;
+    }
+
+    auto dictionary = make_shared<StringDictionary>();
+    column.init_dictionary(column.attr_len(), dictionary);
+    // 过滤之后的列只有在上层算子需要时才保持字典编码，否则复制时解码
+    if (find(dictionary_fields_.begin(), dictionary_fields_.end(), field_id) != dictionary_fields_.end()) {
+      filterd_columns_.column(i).init_dictionary(column.attr_len(), dictionary);
+    }
+  }
+}
+
 RC TableScanVecPhysicalOperator::next(Chunk &chunk)
 {
   RC rc = RC::SUCCESS;
 
+  for (int i = 0; i < all_columns_.column_num(); i++) {
+    const Column &column = all_columns_.column(i);
+    if (column.column_type() == Column::Type::DICTIONARY_COLUMN && column.dictionary()->size() > MAX_DICTIONARY_SIZE) {
+      reset_dictionaries();
+      break;
+    }
+  }
+
   all_columns_.reset_data();
   filterd_columns_.reset_data();
   if (OB_SUCC(rc = chunk_scanner_.next_chunk(all_columns_))) {
@@ -47,14 +168,11 @@ RC TableScanVecPhysicalOperator::next(Chunk &chunk)
         LOG_TRACE("filtered failed=%s", strrc(rc));
         return rc;
       }
-      // TODO: if all setted, it doesn't need to set one by one
-      for (int i = 0; i < all_columns_.rows(); i++) {
-        if (select_[i] == 0) {
-          continue;
-        }
-        for (int j = 0; j < all_columns_.column_num(); j++) {
-          filterd_columns_.column(j).append_value(
-              all_columns_.column(filterd_columns_.column_ids(j)).get_value(i));
+      for (int j = 0; j < all_columns_.column_num(); j++) {
+        rc = filterd_columns_.column(j).append_selected(all_columns_.column(j), select_);
+        if (OB_FAIL(rc)) {
+          LOG_WARN("failed to copy selected rows. rc=%s", strrc(rc));
+          return rc;
         }
       }
       chunk.reference(filterd_columns_);
@@ -72,6 +190,68 @@ void TableScanVecPhysicalOperator::set_predicates(vector<unique_ptr<Expression>>
   predicates_ = std::move(exprs);
 }
 
+RC TableScanVecPhysicalOperator::init_morsels(PageMorselQueue &morsels) { return table_->init_page_morsels(morsels); }
+
+unique_ptr<TableScanVecPhysicalOperator> TableScanVecPhysicalOperator::create_morsel_worker(
+    PageMorselQueue &morsels) const
+{
+  auto worker = make_unique<TableScanVecPhysicalOperator>(table_, mode_);
+  for (const unique_ptr<Expression> &predicate : predicates_) {
+    worker->predicates_.emplace_back(predicate->copy());
+  }
+  worker->dictionary_fields_ = dictionary_fields_;
+  worker->morsels_           = &morsels;
+  return worker;
+}
+
+RC TableScanVecPhysicalOperator::parallel_scan(
+    Trx *trx, int parallel_degree, const function<RC(int, Chunk &)> &consumer)
+{
+  PageMorselQueue morsels;
+  RC              rc = init_morsels(morsels);
+  if (OB_FAIL(rc)) {
+    LOG_TRACE("table does not support parallel scan. table=%s, rc=%s", table_->name(), strrc(rc));
+    return rc;
+  }
+
+  vector<unique_ptr<TableScanVecPhysicalOperator>> workers;
+  for (int i = 0; i < parallel_degree; i++) {
+    workers.emplace_back(create_morsel_worker(morsels));
+  }
+
+  // 表达式计算时可能需要访问会话，比如预处理语句的参数
+  Session     *session = Session::current_session();
+  atomic<bool> failed(false);
+  mutex        lock;
+  RC           first_error = RC::SUCCESS;
+  thread_run_parallel("ParallelScan", parallel_degree, [&](int worker_id) {
+    Session::set_current_session(session);
+
+    TableScanVecPhysicalOperator &worker = *workers[worker_id];
+    Chunk                         chunk;
+    RC                            rc = worker.open(trx);
+    if (OB_SUCC(rc)) {
+      while (!failed.load() && OB_SUCC(rc = worker.next(chunk))) {
+        if (OB_FAIL(rc = consumer(worker_id, chunk))) {
+          break;
+        }
+      }
+      worker.close();
+    }
+
+    if (rc != RC::RECORD_EOF && OB_FAIL(rc)) {
+      LOG_WARN("parallel scan worker failed. table=%s, worker=%d, rc=%s", table_->name(), worker_id, strrc(rc));
+      lock_guard guard(lock);
+      if (first_error == RC::SUCCESS) {
+        first_error = rc;
+      }
+      failed.store(true);
+    }
+  });
+
+  return first_error;
+}
+
 RC TableScanVecPhysicalOperator::filter(Chunk &chunk)
 {
   RC rc = RC::SUCCESS;
@@ -38,15 +38,52 @@ public:
 
   void set_predicates(vector<unique_ptr<Expression>> &&exprs);
 
+  /**
+   * @brief 以字典编码的方式输出这些字符串字段
+   * @details 输出的列是 Column::Type::DICTIONARY_COLUMN，上层算子需要能够处理字典编码的列。
+   * 一个算子输出的 chunk 共享同一个字典，字典中的字符串过多时会换成一个新的字典。
+   */
+  void set_dictionary_fields(const vector<int> &field_ids) { dictionary_fields_ = field_ids; }
+
+  /**
+   * @brief 把表的页面切分成 morsel，放到 morsels 中
+   * @details 存储引擎不支持并行扫描时返回 RC::UNSUPPORTED
+   */
+  RC init_morsels(PageMorselQueue &morsels);
+
+  /**
+   * @brief 创建一个并行扫描的 worker 算子
+   * @details worker 只扫描从 morsels 中领取到的页面，使用当前算子过滤条件的副本，可以在其它线程中独立执行
+   */
+  unique_ptr<TableScanVecPhysicalOperator> create_morsel_worker(PageMorselQueue &morsels) const;
+
+  /**
+   * @brief 使用 parallel_degree 个线程并行扫描表，代替 open/next/close
+   * @details 表的页面被切分成 morsel，每个线程使用自己的 scanner 和过滤条件的副本领取 morsel 扫描，
+   * 过滤之后的每个 chunk 交给 consumer 处理。consumer 的第一个参数是线程编号，一个编号只会在一个线程中使用，
+   * 可以用来访问线程私有的数据。某个线程出错后，其它线程会尽快结束，返回第一个错误。
+   * 存储引擎不支持并行扫描时返回 RC::UNSUPPORTED，不会调用 consumer，调用者应该退回到单线程执行。
+   */
+  RC parallel_scan(Trx *trx, int parallel_degree, const function<RC(int, Chunk &)> &consumer);
+
 private:
   RC filter(Chunk &chunk);
 
+  /// 为需要字典编码的列创建新的字典
+  void reset_dictionaries();
+
+private:
+  /// 字典中最多保存的字符串个数，超过之后后面的 chunk 使用新的字典，避免不同值很多时占用过多的内存
+  static constexpr int32_t MAX_DICTIONARY_SIZE = 64 * 1024;
+
 private:
-  Table                         *table_ = nullptr;
-  ReadWriteMode                  mode_  = ReadWriteMode::READ_WRITE;
+  Table                         *table_   = nullptr;
+  ReadWriteMode                  mode_    = ReadWriteMode::READ_WRITE;
+  PageMorselQueue               *morsels_ = nullptr;  ///< 并行扫描的一个线程只扫描从这里领取到的页面
   ChunkFileScanner               chunk_scanner_;
   Chunk                          all_columns_;
   Chunk                          filterd_columns_;
   vector<uint8_t>                select_;
   vector<unique_ptr<Expression>> predicates_;
+  vector<int>                    dictionary_fields_;  ///< 以字典编码的方式输出的字段
 };
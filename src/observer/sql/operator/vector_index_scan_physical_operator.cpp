@@ -0,0 +1,77 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/vector_index_scan_physical_operator.h"
+#include "storage/index/ivfflat_index.h"
+#include "storage/table/table.h"
+#include "storage/trx/trx.h"
+
+VectorIndexScanPhysicalOperator::VectorIndexScanPhysicalOperator(
+    Table *table, IvfflatIndex *index, ReadWriteMode mode, vector<float> &&base_vector, int limit)
+    : table_(table), index_(index), mode_(mode), base_vector_(std::move(base_vector)), limit_(limit)
+{}
+
+RC VectorIndexScanPhysicalOperator::open(Trx *trx)
+{
+  if (nullptr == table_ || nullptr == index_) {
+    return RC::INTERNAL;
+  }
+
+  rids_.clear();
+  RC rc = index_->ann_search(base_vector_, static_cast<size_t>(limit_), rids_);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to search vector index. index=%s, rc=%s", index_->index_meta().name(), strrc(rc));
+    return rc;
+  }
+
+  current_ = 0;
+  tuple_.set_schema(table_, table_->table_meta().field_metas());
+  trx_ = trx;
+  return RC::SUCCESS;
+}
+
+RC VectorIndexScanPhysicalOperator::next()
+{
+  RC rc = RC::SUCCESS;
+  while (current_ < rids_.size()) {
+    const RID &rid = rids_[current_++];
+    rc             = table_->get_record(rid, current_record_);
+    if (OB_FAIL(rc)) {
+      LOG_TRACE("failed to get record. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+      return rc;
+    }
+
+    rc = trx_->visit_record(table_, current_record_, mode_);
+    if (rc == RC::RECORD_INVISIBLE) {
+      LOG_TRACE("record invisible");
+      continue;
+    }
+    return rc;
+  }
+
+  return RC::RECORD_EOF;
+}
+
+RC VectorIndexScanPhysicalOperator::close()
+{
+  rids_.clear();
+  return RC::SUCCESS;
+}
+
+Tuple *VectorIndexScanPhysicalOperator::current_tuple()
+{
+  tuple_.set_record(&current_record_);
+  return &tuple_;
+}
+
+string VectorIndexScanPhysicalOperator::param() const
+{
+  return string(index_->index_meta().name()) + " ON " + table_->name() + " LIMIT " + std::to_string(limit_);
+}
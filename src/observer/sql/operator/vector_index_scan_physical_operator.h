@@ -0,0 +1,58 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "sql/expr/tuple.h"
+#include "sql/operator/physical_operator.h"
+#include "storage/record/record_manager.h"
+
+class IvfflatIndex;
+
+/**
+ * @brief 向量索引扫描物理算子
+ * @ingroup PhysicalOperator
+ * @details 用来执行 order by vector_distance(field, const) limit k 这样的近似最近邻查询。
+ * 按照距离由近及远输出索引找到的 k 条记录，结果是近似的，并且不可见的记录会让输出少于 k 条。
+ */
+class VectorIndexScanPhysicalOperator : public PhysicalOperator
+{
+public:
+  VectorIndexScanPhysicalOperator(
+      Table *table, IvfflatIndex *index, ReadWriteMode mode, vector<float> &&base_vector, int limit);
+
+  virtual ~VectorIndexScanPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::VECTOR_INDEX_SCAN; }
+  OpType               get_op_type() const override { return OpType::VECTORINDEXSCAN; }
+
+  string param() const override;
+
+  RC open(Trx *trx) override;
+  RC next() override;
+  RC close() override;
+
+  Tuple *current_tuple() override;
+
+private:
+  Trx          *trx_   = nullptr;
+  Table        *table_ = nullptr;
+  IvfflatIndex *index_ = nullptr;
+  ReadWriteMode mode_  = ReadWriteMode::READ_ONLY;
+
+  vector<float> base_vector_;
+  int           limit_ = 0;
+
+  vector<RID> rids_;
+  size_t      current_ = 0;
+
+  Record   current_record_;
+  RowTuple tuple_;
+};
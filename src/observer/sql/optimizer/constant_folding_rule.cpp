@@ -0,0 +1,39 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/optimizer/constant_folding_rule.h"
+#include "common/log/log.h"
+#include "sql/expr/expression.h"
+
+RC ConstantFoldingRule::rewrite(unique_ptr<Expression> &expr, bool &change_made)
+{
+  change_made = false;
+  if (expr->type() != ExprType::ARITHMETIC && expr->type() != ExprType::CAST) {
+    return RC::SUCCESS;
+  }
+
+  // 下层算子已经计算出结果的表达式（比如聚合之后的算术运算）不需要折叠
+  if (expr->pos() != -1) {
+    return RC::SUCCESS;
+  }
+
+  Value value;
+  if (OB_FAIL(expr->try_get_value(value))) {
+    return RC::SUCCESS;
+  }
+
+  // 保留原来的名字，投影时的列名不变
+  auto value_expr = make_unique<ValueExpr>(value);
+  value_expr->set_name(expr->name());
+  expr        = std::move(value_expr);
+  change_made = true;
+  LOG_TRACE("constant expression is folded. value=%s", value.to_string().c_str());
+  return RC::SUCCESS;
+}
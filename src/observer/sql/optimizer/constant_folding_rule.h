@@ -0,0 +1,30 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/sys/rc.h"
+#include "sql/optimizer/rewrite_rule.h"
+
+/**
+ * @brief 常量折叠
+ * @ingroup Rewriter
+ * @details 算术运算和类型转换的参数都是常量时（通过 try_get_value 可以得到值），在生成执行计划之前就计算出结果，
+ * 替换成 ValueExpr，执行时不需要对每一行（向量化执行时对每个 chunk）重复计算。
+ * 参数占位符（ParamExpr）每次执行时的值不同，不会被折叠。
+ */
+class ConstantFoldingRule : public ExpressionRewriteRule
+{
+public:
+  ConstantFoldingRule()          = default;
+  virtual ~ConstantFoldingRule() = default;
+
+  RC rewrite(unique_ptr<Expression> &expr, bool &change_made) override;
+};
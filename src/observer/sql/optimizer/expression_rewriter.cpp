@@ -16,11 +16,13 @@ See the Mulan PSL v2 for more details. */
 #include "common/log/log.h"
 #include "sql/optimizer/comparison_simplification_rule.h"
 #include "sql/optimizer/conjunction_simplification_rule.h"
+#include "sql/optimizer/constant_folding_rule.h"
 
 using namespace std;
 
 ExpressionRewriter::ExpressionRewriter()
 {
+  expr_rewrite_rules_.emplace_back(new ConstantFoldingRule);
   expr_rewrite_rules_.emplace_back(new ComparisonSimplificationRule);
   expr_rewrite_rules_.emplace_back(new ConjunctionSimplificationRule);
 }
@@ -94,6 +96,27 @@ RC ExpressionRewriter::rewrite_expression(unique_ptr<Expression> &expr, bool &ch
       rc                                      = rewrite_expression(child_expr, change_made);
     } break;
 
+    case ExprType::ARITHMETIC: {
+      // 整个表达式不是常量时，其中的常量子表达式仍然可以折叠，比如 a + 2 * 3
+      auto arithmetic_expr = static_cast<ArithmeticExpr *>(expr.get());
+
+      bool left_change_made = false;
+      rc                    = rewrite_expression(arithmetic_expr->left(), left_change_made);
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+
+      bool right_change_made = false;
+      if (arithmetic_expr->right()) {
+        rc = rewrite_expression(arithmetic_expr->right(), right_change_made);
+        if (rc != RC::SUCCESS) {
+          return rc;
+        }
+      }
+
+      change_made = left_change_made || right_change_made;
+    } break;
+
     case ExprType::COMPARISON: {
       auto                         comparison_expr = static_cast<ComparisonExpr *>(expr.get());
 
@@ -26,6 +26,8 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/project_logical_operator.h"
 #include "sql/operator/table_get_logical_operator.h"
 #include "sql/operator/group_by_logical_operator.h"
+#include "sql/operator/limit_logical_operator.h"
+#include "sql/operator/order_by_logical_operator.h"
 
 #include "sql/stmt/calc_stmt.h"
 #include "sql/stmt/delete_stmt.h"
@@ -138,6 +140,27 @@ RC LogicalPlanGenerator::create_plan(SelectStmt *select_stmt, unique_ptr<Logical
     last_oper = &group_by_oper;
   }
 
+  // 排序和 limit 在投影之前做，这样排序键可以使用没有出现在 select 列表中的字段
+  unique_ptr<LogicalOperator> order_by_oper;
+  if (!select_stmt->order_by().empty()) {
+    order_by_oper = make_unique<OrderByLogicalOperator>(std::move(select_stmt->order_by()), select_stmt->order_by_asc());
+    if (*last_oper) {
+      order_by_oper->add_child(std::move(*last_oper));
+    }
+
+    last_oper = &order_by_oper;
+  }
+
+  unique_ptr<LogicalOperator> limit_oper;
+  if (select_stmt->limit() >= 0) {
+    limit_oper = make_unique<LimitLogicalOperator>(select_stmt->limit());
+    if (*last_oper) {
+      limit_oper->add_child(std::move(*last_oper));
+    }
+
+    last_oper = &limit_oper;
+  }
+
   unique_ptr<LogicalOperator> project_oper = make_unique<ProjectLogicalOperator>(std::move(select_stmt->query_expressions()));
   if (*last_oper) {
     project_oper->add_child(std::move(*last_oper));
@@ -166,6 +189,14 @@ RC LogicalPlanGenerator::create_plan(FilterStmt *filter_stmt, unique_ptr<Logical
                                      ? static_cast<Expression *>(new FieldExpr(filter_obj_right.field))
                                      : static_cast<Expression *>(new ValueExpr(filter_obj_right.value)));
 
+    // 参数占位符在执行时按照另一边的类型取值，不需要类型转换
+    if (!filter_obj_left.is_attr && filter_obj_left.value.is_param()) {
+      left = make_unique<ParamExpr>(filter_obj_left.value.param_index(), right->value_type());
+    }
+    if (!filter_obj_right.is_attr && filter_obj_right.value.is_param()) {
+      right = make_unique<ParamExpr>(filter_obj_right.value.param_index(), left->value_type());
+    }
+
     if (left->value_type() != right->value_type()) {
       auto left_to_right_cost = implicit_cast_cost(left->value_type(), right->value_type());
       auto right_to_left_cost = implicit_cast_cost(right->value_type(), left->value_type());
@@ -327,17 +358,25 @@ RC LogicalPlanGenerator::create_group_by_plan(SelectStmt *select_stmt, unique_pt
   };
   
 
-  for (unique_ptr<Expression> &expression : query_expressions) {
-    bind_group_by_expr(expression);
+  // order by 在 group by 之后执行，排序键和 select 列表一样只能使用分组字段和聚合函数
+  vector<unique_ptr<Expression>> &order_by_expressions = select_stmt->order_by();
+  for (auto *expressions : {&query_expressions, &order_by_expressions}) {
+    for (unique_ptr<Expression> &expression : *expressions) {
+      bind_group_by_expr(expression);
+    }
   }
 
-  for (unique_ptr<Expression> &expression : query_expressions) {
-    find_unbound_column(expression);
+  for (auto *expressions : {&query_expressions, &order_by_expressions}) {
+    for (unique_ptr<Expression> &expression : *expressions) {
+      find_unbound_column(expression);
+    }
   }
 
   // collect all aggregate expressions
-  for (unique_ptr<Expression> &expression : query_expressions) {
-    collector(expression);
+  for (auto *expressions : {&query_expressions, &order_by_expressions}) {
+    for (unique_ptr<Expression> &expression : *expressions) {
+      collector(expression);
+    }
   }
 
   if (group_by_expressions.empty() && aggregate_expressions.empty()) {
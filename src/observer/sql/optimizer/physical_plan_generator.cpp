@@ -12,6 +12,9 @@ See the Mulan PSL v2 for more details. */
 // Created by Wangyunlai on 2022/12/14.
 //
 
+#include "common/lang/algorithm.h"
+#include "common/lang/unordered_map.h"
+#include "common/lang/unordered_set.h"
 #include "common/log/log.h"
 #include "sql/expr/expression.h"
 #include "session/session.h"
@@ -23,13 +26,20 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/explain_logical_operator.h"
 #include "sql/operator/explain_physical_operator.h"
 #include "sql/operator/expr_vec_physical_operator.h"
+#include "sql/operator/gather_vec_physical_operator.h"
 #include "sql/operator/group_by_vec_physical_operator.h"
 #include "sql/operator/hash_join_physical_operator.h"
 #include "sql/operator/index_scan_physical_operator.h"
 #include "sql/operator/insert_logical_operator.h"
 #include "sql/operator/insert_physical_operator.h"
 #include "sql/operator/join_logical_operator.h"
+#include "sql/operator/limit_logical_operator.h"
+#include "sql/operator/limit_physical_operator.h"
+#include "sql/operator/limit_vec_physical_operator.h"
 #include "sql/operator/nested_loop_join_physical_operator.h"
+#include "sql/operator/order_by_logical_operator.h"
+#include "sql/operator/order_by_physical_operator.h"
+#include "sql/operator/order_by_vec_physical_operator.h"
 #include "sql/operator/predicate_logical_operator.h"
 #include "sql/operator/predicate_physical_operator.h"
 #include "sql/operator/project_logical_operator.h"
@@ -42,7 +52,11 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/hash_group_by_physical_operator.h"
 #include "sql/operator/scalar_group_by_physical_operator.h"
 #include "sql/operator/table_scan_vec_physical_operator.h"
+#include "sql/operator/vector_index_scan_physical_operator.h"
 #include "sql/optimizer/physical_plan_generator.h"
+#include "storage/index/index.h"
+#include "storage/index/ivfflat_index.h"
+#include "storage/trx/trx.h"
 
 using namespace std;
 
@@ -87,6 +101,14 @@ RC PhysicalPlanGenerator::create(LogicalOperator &logical_operator, unique_ptr<P
       return create_plan(static_cast<GroupByLogicalOperator &>(logical_operator), oper, session);
     } break;
 
+    case LogicalOperatorType::ORDER_BY: {
+      return create_plan(static_cast<OrderByLogicalOperator &>(logical_operator), oper, session);
+    } break;
+
+    case LogicalOperatorType::LIMIT: {
+      return create_plan(static_cast<LimitLogicalOperator &>(logical_operator), oper, session);
+    } break;
+
     default: {
       ASSERT(false, "unknown logical operator type");
       return RC::INVALID_ARGUMENT;
@@ -112,6 +134,12 @@ RC PhysicalPlanGenerator::create_vec(LogicalOperator &logical_operator, unique_p
     case LogicalOperatorType::EXPLAIN: {
       return create_vec_plan(static_cast<ExplainLogicalOperator &>(logical_operator), oper, session);
     } break;
+    case LogicalOperatorType::ORDER_BY: {
+      return create_vec_plan(static_cast<OrderByLogicalOperator &>(logical_operator), oper, session);
+    } break;
+    case LogicalOperatorType::LIMIT: {
+      return create_vec_plan(static_cast<LimitLogicalOperator &>(logical_operator), oper, session);
+    } break;
     default: {
       LOG_WARN("unknown logical operator type: %d", logical_operator.type());
       return RC::INVALID_ARGUMENT;
@@ -120,63 +148,397 @@ RC PhysicalPlanGenerator::create_vec(LogicalOperator &logical_operator, unique_p
   return rc;
 }
 
+namespace {
+
+/**
+ * @brief 一个字段上可以用于索引扫描的条件
+ */
+struct FieldScanRange
+{
+  const Value *equal_value     = nullptr;
+  const Value *left_value      = nullptr;
+  const Value *right_value     = nullptr;
+  bool         left_inclusive  = true;
+  bool         right_inclusive = true;
+};
+
+/**
+ * @brief 把一个字段的值追加到多字段索引的键值中
+ * @details 多字段索引的键值中每个字段都占用字段定义的长度。字符串比字段长时会被截断，
+ * 返回 false 表示截断后的边界不再精确，调用者需要包含边界本身，多出来的记录由谓词过滤
+ */
+bool append_key_value(string &key, const FieldMeta &field_meta, const Value &value)
+{
+  const int length = min(value.length(), field_meta.len());
+  key.append(value.data(), length);
+  key.append(field_meta.len() - length, '\0');
+  return value.length() <= field_meta.len();
+}
+
+/**
+ * @brief 收集表达式中用到的字段
+ * @return 表达式中有无法识别的部分时返回 false
+ */
+bool collect_field_names(Expression *expr, unordered_set<string> &field_names)
+{
+  if (nullptr == expr) {
+    return true;
+  }
+
+  switch (expr->type()) {
+    case ExprType::FIELD: {
+      field_names.insert(static_cast<FieldExpr *>(expr)->field_name());
+      return true;
+    }
+    case ExprType::VALUE:
+    case ExprType::PARAM: {
+      return true;
+    }
+    case ExprType::CAST: {
+      return collect_field_names(static_cast<CastExpr *>(expr)->child().get(), field_names);
+    }
+    case ExprType::COMPARISON: {
+      auto comparison_expr = static_cast<ComparisonExpr *>(expr);
+      return collect_field_names(comparison_expr->left().get(), field_names) &&
+             collect_field_names(comparison_expr->right().get(), field_names);
+    }
+    case ExprType::CONJUNCTION: {
+      for (unique_ptr<Expression> &child : static_cast<ConjunctionExpr *>(expr)->children()) {
+        if (!collect_field_names(child.get(), field_names)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    case ExprType::ARITHMETIC: {
+      auto arithmetic_expr = static_cast<ArithmeticExpr *>(expr);
+      return collect_field_names(arithmetic_expr->left().get(), field_names) &&
+             collect_field_names(arithmetic_expr->right().get(), field_names);
+    }
+    case ExprType::AGGREGATION: {
+      return collect_field_names(static_cast<AggregateExpr *>(expr)->child().get(), field_names);
+    }
+    case ExprType::VECTOR_DISTANCE: {
+      auto distance_expr = static_cast<VectorDistanceExpr *>(expr);
+      return collect_field_names(distance_expr->left().get(), field_names) &&
+             collect_field_names(distance_expr->right().get(), field_names);
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+/**
+ * @brief 收集单表查询中用到的字段
+ * @details 只处理 过滤、分组 和 取表数据 组成的单链计划，其它情况返回 false
+ */
+bool collect_field_names(LogicalOperator &oper, unordered_set<string> &field_names)
+{
+  for (unique_ptr<Expression> &expr : oper.expressions()) {
+    if (!collect_field_names(expr.get(), field_names)) {
+      return false;
+    }
+  }
+
+  switch (oper.type()) {
+    case LogicalOperatorType::TABLE_GET: {
+      auto &table_get_oper = static_cast<TableGetLogicalOperator &>(oper);
+      if (table_get_oper.read_write_mode() != ReadWriteMode::READ_ONLY) {
+        return false;
+      }
+      for (unique_ptr<Expression> &expr : table_get_oper.predicates()) {
+        if (!collect_field_names(expr.get(), field_names)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    case LogicalOperatorType::GROUP_BY: {
+      auto &group_by_oper = static_cast<GroupByLogicalOperator &>(oper);
+      for (unique_ptr<Expression> &expr : group_by_oper.group_by_expressions()) {
+        if (!collect_field_names(expr.get(), field_names)) {
+          return false;
+        }
+      }
+      for (Expression *expr : group_by_oper.aggregate_expressions()) {
+        if (!collect_field_names(expr, field_names)) {
+          return false;
+        }
+      }
+    } break;
+    case LogicalOperatorType::PREDICATE:
+    case LogicalOperatorType::ORDER_BY:
+    case LogicalOperatorType::LIMIT: break;
+    default: {
+      return false;
+    }
+  }
+
+  if (oper.children().size() != 1) {
+    return false;
+  }
+  return collect_field_names(*oper.children().front(), field_names);
+}
+
+/**
+ * @brief 计划最底层的索引扫描包含了所有用到的字段时，设置为覆盖索引扫描
+ */
+void try_index_only_scan(PhysicalOperator &oper, const unordered_set<string> &field_names, Session *session)
+{
+  PhysicalOperator *leaf = &oper;
+  while (leaf->children().size() == 1) {
+    leaf = leaf->children().front().get();
+  }
+  if (!leaf->children().empty() || leaf->type() != PhysicalOperatorType::INDEX_SCAN) {
+    return;
+  }
+
+  // 记录的可见性保存在记录中，需要判断可见性的事务必须回表
+  if (nullptr == session || session->current_trx()->type() != TrxKit::Type::VACUOUS) {
+    return;
+  }
+
+  auto  *index_scan_oper = static_cast<IndexScanPhysicalOperator *>(leaf);
+  Index *index           = index_scan_oper->index();
+  if (!index->support_index_only_scan()) {
+    return;
+  }
+
+  const vector<string> &index_fields = index->index_meta().fields();
+  for (const string &field_name : field_names) {
+    if (find(index_fields.begin(), index_fields.end(), field_name) == index_fields.end()) {
+      return;
+    }
+  }
+
+  index_scan_oper->set_index_only(true);
+  LOG_TRACE("use index only scan. index=%s", index->index_meta().name());
+}
+
+/**
+ * @brief 查找可以执行 limit 的向量索引
+ * @details 只处理 limit 下面是按照一个向量距离排序、再下面是没有过滤条件的单表扫描的计划，
+ * 距离的一边是表中的字段，另一边是常量，排序方向与距离的含义一致，并且字段上有相同距离类型的向量索引
+ * @param[out] base_vector 查询向量
+ */
+IvfflatIndex *find_ann_index(LimitLogicalOperator &limit_oper, vector<float> &base_vector)
+{
+  if (limit_oper.children().size() != 1 || limit_oper.children().front()->type() != LogicalOperatorType::ORDER_BY) {
+    return nullptr;
+  }
+
+  auto &order_by_oper = static_cast<OrderByLogicalOperator &>(*limit_oper.children().front());
+  if (order_by_oper.expressions().size() != 1 || order_by_oper.children().size() != 1 ||
+      order_by_oper.expressions().front()->type() != ExprType::VECTOR_DISTANCE ||
+      order_by_oper.children().front()->type() != LogicalOperatorType::TABLE_GET) {
+    return nullptr;
+  }
+
+  auto &distance_expr  = static_cast<VectorDistanceExpr &>(*order_by_oper.expressions().front());
+  auto &table_get_oper = static_cast<TableGetLogicalOperator &>(*order_by_oper.children().front());
+  if (!table_get_oper.predicates().empty() ||
+      vector_distance_ascending(distance_expr.distance_type()) != order_by_oper.ascending().front()) {
+    return nullptr;
+  }
+
+  Expression *field_expr = distance_expr.left().get();
+  Expression *value_expr = distance_expr.right().get();
+  if (field_expr->type() != ExprType::FIELD) {
+    swap(field_expr, value_expr);
+  }
+  if (field_expr->type() != ExprType::FIELD || value_expr->type() != ExprType::VALUE) {
+    return nullptr;
+  }
+
+  const Value &value = static_cast<ValueExpr *>(value_expr)->get_value();
+  const Field &field = static_cast<FieldExpr *>(field_expr)->field();
+  Table       *table = table_get_oper.table();
+  if (value.attr_type() != AttrType::VECTORS || field.table() != table) {
+    return nullptr;
+  }
+
+  const TableMeta &table_meta = table->table_meta();
+  for (int i = 0; i < table_meta.index_num(); i++) {
+    const IndexMeta *index_meta = table_meta.index(i);
+    if (index_meta->type() != IndexType::IVFFLAT || index_meta->fields().front() != field.field_name() ||
+        index_meta->ivfflat_options().distance != distance_expr.distance_type()) {
+      continue;
+    }
+
+    auto *index = static_cast<IvfflatIndex *>(table->find_index(index_meta->name()));
+    if (nullptr == index || index->dim() != value.vector_dim()) {
+      continue;
+    }
+
+    base_vector.assign(value.get_vector(), value.get_vector() + value.vector_dim());
+    return index;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
 RC PhysicalPlanGenerator::create_plan(TableGetLogicalOperator &table_get_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
 {
   vector<unique_ptr<Expression>> &predicates = table_get_oper.predicates();
   // 看看是否有可以用于索引查找的表达式
   Table *table = table_get_oper.table();
 
-  Index     *index      = nullptr;
-  ValueExpr *value_expr = nullptr;
+  // 先收集每个字段上的等值条件和范围条件，同一个字段上的多个范围条件只取第一个
+  unordered_map<string, FieldScanRange> field_ranges;
   for (auto &expr : predicates) {
-    if (expr->type() == ExprType::COMPARISON) {
-      auto comparison_expr = static_cast<ComparisonExpr *>(expr.get());
-      // 简单处理，就找等值查询
-      if (comparison_expr->comp() != EQUAL_TO && comparison_expr->comp() != NOT_EQUAL) {
-        continue;
-      }
+    if (expr->type() != ExprType::COMPARISON) {
+      continue;
+    }
 
-      unique_ptr<Expression> &left_expr  = comparison_expr->left();
-      unique_ptr<Expression> &right_expr = comparison_expr->right();
-      // 左右比较的一边最少是一个值
-      if (left_expr->type() != ExprType::VALUE && right_expr->type() != ExprType::VALUE) {
-        continue;
-      }
+    auto   comparison_expr = static_cast<ComparisonExpr *>(expr.get());
+    CompOp comp            = comparison_expr->comp();
+    if (comp == NOT_EQUAL || comp == NO_OP) {
+      continue;
+    }
 
-      FieldExpr *field_expr = nullptr;
-      if (left_expr->type() == ExprType::FIELD) {
-        ASSERT(right_expr->type() == ExprType::VALUE, "right expr should be a value expr while left is field expr");
-        field_expr = static_cast<FieldExpr *>(left_expr.get());
-        value_expr = static_cast<ValueExpr *>(right_expr.get());
-      } else if (right_expr->type() == ExprType::FIELD) {
-        ASSERT(left_expr->type() == ExprType::VALUE, "left expr should be a value expr while right is a field expr");
-        field_expr = static_cast<FieldExpr *>(right_expr.get());
-        value_expr = static_cast<ValueExpr *>(left_expr.get());
+    unique_ptr<Expression> &left_expr  = comparison_expr->left();
+    unique_ptr<Expression> &right_expr = comparison_expr->right();
+
+    // 一边是字段，另一边是值。值在左边时，把比较符反过来，统一成 field comp value 的形式
+    FieldExpr *field_expr = nullptr;
+    ValueExpr *value_expr = nullptr;
+    if (left_expr->type() == ExprType::FIELD && right_expr->type() == ExprType::VALUE) {
+      field_expr = static_cast<FieldExpr *>(left_expr.get());
+      value_expr = static_cast<ValueExpr *>(right_expr.get());
+    } else if (right_expr->type() == ExprType::FIELD && left_expr->type() == ExprType::VALUE) {
+      field_expr = static_cast<FieldExpr *>(right_expr.get());
+      value_expr = static_cast<ValueExpr *>(left_expr.get());
+      switch (comp) {
+        case LESS_THAN: comp = GREAT_THAN; break;
+        case LESS_EQUAL: comp = GREAT_EQUAL; break;
+        case GREAT_THAN: comp = LESS_THAN; break;
+        case GREAT_EQUAL: comp = LESS_EQUAL; break;
+        default: break;
       }
+    } else {
+      continue;
+    }
 
-      if (field_expr == nullptr) {
-        continue;
+    // 索引按照字段类型的原始数据比较，类型不同时需要先做类型转换，这里不使用索引
+    const Field &field = field_expr->field();
+    const Value &value = value_expr->get_value();
+    if (field.attr_type() != value.attr_type()) {
+      continue;
+    }
+
+    FieldScanRange &range = field_ranges[field.field_name()];
+    if (comp == EQUAL_TO) {
+      if (range.equal_value == nullptr) {
+        range.equal_value = &value;
       }
+    } else if ((comp == GREAT_THAN || comp == GREAT_EQUAL) && range.left_value == nullptr) {
+      range.left_value     = &value;
+      range.left_inclusive = (comp == GREAT_EQUAL);
+    } else if ((comp == LESS_THAN || comp == LESS_EQUAL) && range.right_value == nullptr) {
+      range.right_value     = &value;
+      range.right_inclusive = (comp == LESS_EQUAL);
+    }
+  }
 
-      const Field &field = field_expr->field();
-      index              = table->find_index_by_field(field.field_name());
-      if (nullptr != index) {
+  // 索引字段的一个前缀上都是等值条件，再加上下一个字段上的范围条件，可以转换成一个扫描区间。
+  // 比如索引 (a, b, c) 上的 a=1 and b>5。等值前缀越长的索引越优先，其次是带有范围条件的索引
+  const TableMeta      &table_meta  = table->table_meta();
+  Index                *index       = nullptr;
+  const IndexMeta      *index_meta  = nullptr;
+  int                   equal_num   = 0;
+  const FieldScanRange *range_field = nullptr;
+  for (int i = 0; i < table_meta.index_num(); i++) {
+    const IndexMeta      *candidate_meta  = table_meta.index(i);
+    if (candidate_meta->type() != IndexType::BPLUS_TREE) {
+      continue;
+    }
+    int                   candidate_equal = 0;
+    const FieldScanRange *candidate_range = nullptr;
+    for (const string &field_name : candidate_meta->fields()) {
+      auto iter = field_ranges.find(field_name);
+      if (iter == field_ranges.end()) {
         break;
       }
+      if (iter->second.equal_value != nullptr) {
+        candidate_equal++;
+        continue;
+      }
+      if (iter->second.left_value != nullptr || iter->second.right_value != nullptr) {
+        candidate_range = &iter->second;
+      }
+      break;
+    }
+
+    if (candidate_equal == 0 && candidate_range == nullptr) {
+      continue;
     }
+    if (index_meta != nullptr &&
+        (candidate_equal < equal_num ||
+            (candidate_equal == equal_num && (range_field != nullptr || candidate_range == nullptr)))) {
+      continue;
+    }
+
+    Index *candidate_index = table->find_index(candidate_meta->name());
+    if (nullptr == candidate_index) {
+      continue;
+    }
+    index       = candidate_index;
+    index_meta  = candidate_meta;
+    equal_num   = candidate_equal;
+    range_field = candidate_range;
   }
 
   if (index != nullptr) {
-    ASSERT(value_expr != nullptr, "got an index but value expr is null ?");
+    // 单字段索引直接使用值作为边界，字符串的补齐由索引自己处理；
+    // 多字段索引的边界是前缀字段的值依次拼接，没有给出的字段由索引按照边界的开闭填充
+    const vector<string> &fields          = index_meta->fields();
+    const bool            single_field    = fields.size() == 1;
+    string                left_key;
+    string                right_key;
+    bool                  has_left        = true;
+    bool                  has_right       = true;
+    bool                  left_inclusive  = true;
+    bool                  right_inclusive = true;
+
+    auto append_value = [&](string &key, int field_index, const Value &value) -> bool {
+      if (single_field) {
+        key.append(value.data(), value.length());
+        return true;
+      }
+      return append_key_value(key, *table_meta.field(fields[field_index].c_str()), value);
+    };
+
+    for (int i = 0; i < equal_num; i++) {
+      const Value &value = *field_ranges[fields[i]].equal_value;
+      append_value(left_key, i, value);
+      append_value(right_key, i, value);
+    }
+
+    if (range_field != nullptr && range_field->left_value != nullptr) {
+      bool exact     = append_value(left_key, equal_num, *range_field->left_value);
+      left_inclusive = range_field->left_inclusive || !exact;
+    } else if (equal_num == 0) {
+      has_left = false;
+    }
+
+    if (range_field != nullptr && range_field->right_value != nullptr) {
+      bool exact      = append_value(right_key, equal_num, *range_field->right_value);
+      right_inclusive = range_field->right_inclusive || !exact;
+    } else if (equal_num == 0) {
+      has_right = false;
+    }
 
-    const Value               &value           = value_expr->get_value();
     IndexScanPhysicalOperator *index_scan_oper = new IndexScanPhysicalOperator(table,
         index,
         table_get_oper.read_write_mode(),
-        &value,
-        true /*left_inclusive*/,
-        &value,
-        true /*right_inclusive*/);
+        has_left ? left_key.data() : nullptr,
+        static_cast<int>(left_key.size()),
+        left_inclusive,
+        has_right ? right_key.data() : nullptr,
+        static_cast<int>(right_key.size()),
+        right_inclusive);
 
     index_scan_oper->set_predicates(std::move(predicates));
     oper = unique_ptr<PhysicalOperator>(index_scan_oper);
@@ -218,6 +580,18 @@ RC PhysicalPlanGenerator::create_plan(ProjectLogicalOperator &project_oper, uniq
 {
   vector<unique_ptr<LogicalOperator>> &child_opers = project_oper.children();
 
+  // 查询只用到了某个索引中的字段时，可以直接从索引中取数据，不需要回表。
+  // 需要在子算子生成物理计划之前收集字段，因为生成物理计划时会把表达式转移走
+  unordered_set<string> field_names;
+  bool                  fields_collected = false;
+  if (!child_opers.empty()) {
+    fields_collected = true;
+    for (unique_ptr<Expression> &expr : project_oper.expressions()) {
+      fields_collected = fields_collected && collect_field_names(expr.get(), field_names);
+    }
+    fields_collected = fields_collected && collect_field_names(*child_opers.front(), field_names);
+  }
+
   unique_ptr<PhysicalOperator> child_phy_oper;
 
   RC rc = RC::SUCCESS;
@@ -231,6 +605,10 @@ RC PhysicalPlanGenerator::create_plan(ProjectLogicalOperator &project_oper, uniq
     }
   }
 
+  if (fields_collected && child_phy_oper) {
+    try_index_only_scan(*child_phy_oper, field_names, session);
+  }
+
   auto project_operator = make_unique<ProjectPhysicalOperator>(std::move(project_oper.expressions()));
   if (child_phy_oper) {
     project_operator->add_child(std::move(child_phy_oper));
@@ -371,6 +749,61 @@ RC PhysicalPlanGenerator::create_plan(GroupByLogicalOperator &logical_oper, uniq
   return rc;
 }
 
+RC PhysicalPlanGenerator::create_plan(OrderByLogicalOperator &logical_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
+{
+  ASSERT(logical_oper.children().size() == 1, "order by operator should have 1 child");
+
+  LogicalOperator             &child_oper = *logical_oper.children().front();
+  unique_ptr<PhysicalOperator> child_physical_oper;
+  RC                           rc = create(child_oper, child_physical_oper, session);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to create child physical operator of order by operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  oper = make_unique<OrderByPhysicalOperator>(std::move(logical_oper.expressions()), logical_oper.ascending());
+  oper->add_child(std::move(child_physical_oper));
+  return rc;
+}
+
+RC PhysicalPlanGenerator::create_plan(LimitLogicalOperator &logical_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
+{
+  ASSERT(logical_oper.children().size() == 1, "limit operator should have 1 child");
+
+  // order by 向量距离 limit k 可以直接用向量索引找到最近的 k 条记录，不需要排序
+  unique_ptr<PhysicalOperator> child_physical_oper;
+  vector<float>                base_vector;
+  IvfflatIndex                *ann_index = find_ann_index(logical_oper, base_vector);
+  RC                           rc        = RC::SUCCESS;
+  if (ann_index != nullptr) {
+    auto &table_get_oper = static_cast<TableGetLogicalOperator &>(
+        *logical_oper.children().front()->children().front());
+    child_physical_oper = make_unique<VectorIndexScanPhysicalOperator>(table_get_oper.table(),
+        ann_index,
+        table_get_oper.read_write_mode(),
+        std::move(base_vector),
+        logical_oper.limit());
+    LOG_TRACE("use vector index scan. index=%s", ann_index->index_meta().name());
+  } else {
+    rc = create(*logical_oper.children().front(), child_physical_oper, session);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to create child physical operator of limit operator. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    // order by ... limit n 由排序算子只保留前 n 行（Top-N），不需要完整排序
+    if (child_physical_oper->type() == PhysicalOperatorType::ORDER_BY) {
+      static_cast<OrderByPhysicalOperator &>(*child_physical_oper).set_limit(logical_oper.limit());
+      oper = std::move(child_physical_oper);
+      return rc;
+    }
+  }
+
+  oper = make_unique<LimitPhysicalOperator>(logical_oper.limit());
+  oper->add_child(std::move(child_physical_oper));
+  return rc;
+}
+
 RC PhysicalPlanGenerator::create_vec_plan(TableGetLogicalOperator &table_get_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
 {
   vector<unique_ptr<Expression>> &predicates = table_get_oper.predicates();
@@ -387,12 +820,25 @@ RC PhysicalPlanGenerator::create_vec_plan(GroupByLogicalOperator &logical_oper,
 {
   RC rc = RC::SUCCESS;
   unique_ptr<PhysicalOperator> physical_oper = nullptr;
+  const int parallel_degree = session != nullptr ? session->parallel_degree() : Session::DEFAULT_PARALLEL_DEGREE;
+
+  // 分组哈希表可以直接使用字典编码的字符串列，分组时只需要处理编号
+  vector<int> dictionary_fields;
+  for (const unique_ptr<Expression> &expr : logical_oper.group_by_expressions()) {
+    if (expr->type() == ExprType::FIELD && expr->value_type() == AttrType::CHARS) {
+      dictionary_fields.push_back(static_cast<FieldExpr *>(expr.get())->field().meta()->field_id());
+    }
+  }
+
   if (logical_oper.group_by_expressions().empty()) {
-    physical_oper = make_unique<AggregateVecPhysicalOperator>(std::move(logical_oper.aggregate_expressions()));
+    auto aggregate_oper = make_unique<AggregateVecPhysicalOperator>(std::move(logical_oper.aggregate_expressions()));
+    aggregate_oper->set_parallel_degree(parallel_degree);
+    physical_oper = std::move(aggregate_oper);
   } else {
-    physical_oper = make_unique<GroupByVecPhysicalOperator>(
+    auto group_by_oper = make_unique<GroupByVecPhysicalOperator>(
       std::move(logical_oper.group_by_expressions()), std::move(logical_oper.aggregate_expressions()));
-
+    group_by_oper->set_parallel_degree(parallel_degree);
+    physical_oper = std::move(group_by_oper);
   }
 
   ASSERT(logical_oper.children().size() == 1, "group by operator should have 1 child");
@@ -404,6 +850,9 @@ RC PhysicalPlanGenerator::create_vec_plan(GroupByLogicalOperator &logical_oper,
     LOG_WARN("failed to create child physical operator of group by(vec) operator. rc=%s", strrc(rc));
     return rc;
   }
+  if (child_physical_oper->type() == PhysicalOperatorType::TABLE_SCAN_VEC) {
+    static_cast<TableScanVecPhysicalOperator &>(*child_physical_oper).set_dictionary_fields(dictionary_fields);
+  }
 
   physical_oper->add_child(std::move(child_physical_oper));
 
@@ -431,7 +880,18 @@ RC PhysicalPlanGenerator::create_vec_plan(ProjectLogicalOperator &project_oper,
 
   auto project_operator = make_unique<ProjectVecPhysicalOperator>(std::move(project_oper.expressions()));
 
-  if (child_phy_oper != nullptr) {
+  const int parallel_degree = session != nullptr ? session->parallel_degree() : Session::DEFAULT_PARALLEL_DEGREE;
+  if (child_phy_oper != nullptr && parallel_degree > 1 &&
+      child_phy_oper->type() == PhysicalOperatorType::TABLE_SCAN_VEC) {
+    // 表扫描和投影表达式的计算都交给并行的 worker，投影算子只负责输出结果
+    vector<unique_ptr<Expression>> expressions;
+    for (auto &expr : project_operator->expressions()) {
+      expressions.emplace_back(expr->copy());
+    }
+    auto gather_operator = make_unique<GatherVecPhysicalOperator>(std::move(expressions), parallel_degree);
+    gather_operator->add_child(std::move(child_phy_oper));
+    project_operator->add_child(std::move(gather_operator));
+  } else if (child_phy_oper != nullptr) {
     vector<Expression *> expressions;
     for (auto &expr : project_operator->expressions()) {
       expressions.push_back(expr.get());
@@ -448,6 +908,46 @@ RC PhysicalPlanGenerator::create_vec_plan(ProjectLogicalOperator &project_oper,
 }
 
 
+RC PhysicalPlanGenerator::create_vec_plan(OrderByLogicalOperator &logical_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
+{
+  ASSERT(logical_oper.children().size() == 1, "order by operator should have 1 child");
+
+  LogicalOperator             &child_oper = *logical_oper.children().front();
+  unique_ptr<PhysicalOperator> child_physical_oper;
+  RC                           rc = create_vec(child_oper, child_physical_oper, session);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to create child physical operator of order by(vec) operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  oper = make_unique<OrderByVecPhysicalOperator>(std::move(logical_oper.expressions()), logical_oper.ascending());
+  oper->add_child(std::move(child_physical_oper));
+  return rc;
+}
+
+RC PhysicalPlanGenerator::create_vec_plan(LimitLogicalOperator &logical_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
+{
+  ASSERT(logical_oper.children().size() == 1, "limit operator should have 1 child");
+
+  unique_ptr<PhysicalOperator> child_physical_oper;
+  RC                           rc = create_vec(*logical_oper.children().front(), child_physical_oper, session);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to create child physical operator of limit(vec) operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  // order by ... limit n 由排序算子只保留前 n 行（Top-N）
+  if (child_physical_oper->type() == PhysicalOperatorType::ORDER_BY_VEC) {
+    static_cast<OrderByVecPhysicalOperator &>(*child_physical_oper).set_limit(logical_oper.limit());
+    oper = std::move(child_physical_oper);
+    return rc;
+  }
+
+  oper = make_unique<LimitVecPhysicalOperator>(logical_oper.limit());
+  oper->add_child(std::move(child_physical_oper));
+  return rc;
+}
+
 RC PhysicalPlanGenerator::create_vec_plan(ExplainLogicalOperator &explain_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
 {
   vector<unique_ptr<LogicalOperator>> &child_opers = explain_oper.children();
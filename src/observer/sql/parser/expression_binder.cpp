@@ -90,6 +90,10 @@ RC ExpressionBinder::bind_expression(unique_ptr<Expression> &expr, vector<unique
       ASSERT(false, "shouldn't be here");
     } break;
 
+    case ExprType::VECTOR_DISTANCE: {
+      return bind_vector_distance_expression(expr, bound_expressions);
+    } break;
+
     default: {
       LOG_WARN("unknown expression type: %d", static_cast<int>(expr->type()));
       return RC::INTERNAL;
@@ -186,6 +190,12 @@ RC ExpressionBinder::bind_field_expression(
 RC ExpressionBinder::bind_value_expression(
     unique_ptr<Expression> &value_expr, vector<unique_ptr<Expression>> &bound_expressions)
 {
+  // 参数占位符只能出现在过滤条件和插入的值中
+  if (static_cast<ValueExpr *>(value_expr.get())->get_value().is_param()) {
+    LOG_WARN("parameter placeholder is not supported here. expr=%s", value_expr->name());
+    return RC::UNSUPPORTED;
+  }
+
   bound_expressions.emplace_back(std::move(value_expr));
   return RC::SUCCESS;
 }
@@ -447,3 +457,56 @@ RC ExpressionBinder::bind_aggregate_expression(
   bound_expressions.emplace_back(std::move(aggregate_expr));
   return RC::SUCCESS;
 }
+
+RC ExpressionBinder::bind_vector_distance_expression(
+    unique_ptr<Expression> &expr, vector<unique_ptr<Expression>> &bound_expressions)
+{
+  if (nullptr == expr) {
+    return RC::SUCCESS;
+  }
+
+  auto distance_expr = static_cast<VectorDistanceExpr *>(expr.get());
+  for (unique_ptr<Expression> *child_expr : {&distance_expr->left(), &distance_expr->right()}) {
+    vector<unique_ptr<Expression>> child_bound_expressions;
+
+    RC rc = bind_expression(*child_expr, child_bound_expressions);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    if (child_bound_expressions.size() != 1) {
+      LOG_WARN("invalid children number of vector distance expression: %d", child_bound_expressions.size());
+      return RC::INVALID_ARGUMENT;
+    }
+
+    if (child_bound_expressions[0].get() != child_expr->get()) {
+      child_expr->reset(child_bound_expressions[0].release());
+    }
+
+    // 字符串常量 '[1,2,3]' 在这里转换成向量常量，执行时就不需要每行都解析一次
+    if ((*child_expr)->type() == ExprType::VALUE && (*child_expr)->value_type() == AttrType::CHARS) {
+      Value string_value;
+      Value vector_value;
+      rc = (*child_expr)->try_get_value(string_value);
+      if (OB_SUCC(rc)) {
+        rc = Value::cast_to(string_value, AttrType::VECTORS, vector_value);
+      }
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to convert string to vector. s=%s", string_value.to_string().c_str());
+        return RC::INVALID_ARGUMENT;
+      }
+      string name = (*child_expr)->name();
+      child_expr->reset(new ValueExpr(vector_value));
+      (*child_expr)->set_name(name);
+    }
+
+    if ((*child_expr)->value_type() != AttrType::VECTORS) {
+      LOG_WARN("invalid argument type of vector distance expression: %s",
+          attr_type_to_string((*child_expr)->value_type()));
+      return RC::INVALID_ARGUMENT;
+    }
+  }
+
+  bound_expressions.emplace_back(std::move(expr));
+  return RC::SUCCESS;
+}
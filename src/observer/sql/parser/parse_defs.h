@@ -75,6 +75,16 @@ struct ConditionSqlNode
   Value          right_value;    ///< right-hand side value if right_is_attr = FALSE
 };
 
+/**
+ * @brief 描述 order by 中的一项
+ * @ingroup SQLParser
+ */
+struct OrderBySqlNode
+{
+  unique_ptr<Expression> expression;  ///< 排序的表达式
+  bool                   asc = true;  ///< 是否升序
+};
+
 /**
  * @brief 描述一个select语句
  * @ingroup SQLParser
@@ -92,6 +102,8 @@ struct SelectSqlNode
   vector<string>                 relations;    ///< 查询的表
   vector<ConditionSqlNode>       conditions;   ///< 查询条件，使用AND串联起来多个条件
   vector<unique_ptr<Expression>> group_by;     ///< group by clause
+  vector<OrderBySqlNode>         order_by;     ///< order by clause
+  int                            limit = -1;   ///< limit clause，小于0表示没有限制
 };
 
 /**
@@ -186,12 +198,16 @@ struct AnalyzeTableSqlNode
  * @ingroup SQLParser
  * @details 创建索引时，需要指定索引名，表名，字段名。
  * 正常的SQL语句中，一个索引可能包含了多个字段，这里仅支持一个字段。
+ * 向量索引使用 create vector index ... with (distance=l2_distance, type=ivfflat, lists=16, probes=4)，
+ * with 中的参数原样记录在 params 中，由 CreateIndexStmt 校验。
  */
 struct CreateIndexSqlNode
 {
-  string index_name;      ///< Index name
-  string relation_name;   ///< Relation name
-  string attribute_name;  ///< Attribute name
+  string                       index_name;         ///< Index name
+  string                       relation_name;      ///< Relation name
+  vector<string>               attribute_names;    ///< Attribute names, 多字段索引按照字段的顺序比较
+  bool                         is_vector = false;  ///< 是否为向量索引
+  vector<pair<string, string>> params;             ///< 向量索引的参数
 };
 
 /**
@@ -318,6 +334,8 @@ public:
   ExplainSqlNode      explain;
   SetVariableSqlNode  set_variable;
 
+  int param_count = 0;  ///< 参数占位符(?)的个数，只有预处理语句可以带参数
+
 public:
   ParsedSqlNode();
   explicit ParsedSqlNode(SqlCommandFlag flag);
@@ -334,6 +352,13 @@ public:
 
   vector<unique_ptr<ParsedSqlNode>> &sql_nodes() { return sql_nodes_; }
 
+  /**
+   * @brief 遇到一个参数占位符，返回它的编号
+   */
+  int add_param() { return param_count_++; }
+  int param_count() const { return param_count_; }
+
 private:
   vector<unique_ptr<ParsedSqlNode>> sql_nodes_;  ///< 这里记录SQL命令。虽然看起来支持多个，但是当前仅处理一个
+  int                               param_count_ = 0;
 };
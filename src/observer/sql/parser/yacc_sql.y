@@ -50,6 +50,23 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
   return expr;
 }
 
+VectorDistanceExpr *create_vector_distance_expression(const char *function_name,
+                                                      Expression *left,
+                                                      Expression *right,
+                                                      const char *sql_string,
+                                                      YYLTYPE *llocp)
+{
+  VectorDistanceType distance_type;
+  if (OB_FAIL(vector_distance_type_from_string(function_name, distance_type))) {
+    delete left;
+    delete right;
+    return nullptr;
+  }
+  VectorDistanceExpr *expr = new VectorDistanceExpr(distance_type, left, right);
+  expr->set_name(token_name(sql_string, llocp));
+  return expr;
+}
+
 %}
 
 %define api.pure full
@@ -112,6 +129,10 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
         FIELDS
         TERMINATED
         ENCLOSED
+        ORDER
+        ASC
+        LIMIT
+        WITH
         /* DATE_STR */
         EQ
         LT
@@ -136,6 +157,9 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
   vector<RelAttrSqlNode> *                   rel_attr_list;
   vector<string> *                           relation_list;
   vector<string> *                           key_list;
+  vector<OrderBySqlNode> *                   order_by_list;
+  OrderBySqlNode *                           order_by_item;
+  vector<pair<string, string>> *             index_params;
   char *                                     cstring;
   int                                        number;
   float                                      floats;
@@ -152,6 +176,9 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
 // %destructor { delete $$; } <rel_attr_list>
 %destructor { delete $$; } <relation_list>
 %destructor { delete $$; } <key_list>
+%destructor { delete $$; } <order_by_list>
+%destructor { delete $$; } <order_by_item>
+%destructor { delete $$; } <index_params>
 
 %token <number> NUMBER
 %token <floats> FLOAT
@@ -179,8 +206,14 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
 %type <relation_list>       rel_list
 %type <expression>          expression
 %type <expression>          aggregate_expression
+%type <expression>          function_expression
 %type <expression_list>     expression_list
 %type <expression_list>     group_by
+%type <order_by_list>       order_by
+%type <order_by_list>       order_by_list
+%type <order_by_item>       order_by_item
+%type <number>              limit
+%type <index_params>        index_param_list
 %type <cstring>             fields_terminated_by
 %type <cstring>             enclosed_by
 %type <sql_node>            calc_stmt
@@ -216,6 +249,7 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
 commands: command_wrapper opt_semicolon  //commands or sqls. parser starts here.
   {
     unique_ptr<ParsedSqlNode> sql_node = unique_ptr<ParsedSqlNode>($1);
+    sql_node->param_count = sql_result->param_count();
     sql_result->add_sql_node(std::move(sql_node));
   }
   ;
@@ -306,13 +340,48 @@ desc_table_stmt:
     ;
 
 create_index_stmt:    /*create index 语句的语法解析树*/
-    CREATE INDEX ID ON ID LBRACE ID RBRACE
+    CREATE INDEX ID ON ID LBRACE attr_list RBRACE
     {
       $$ = new ParsedSqlNode(SCF_CREATE_INDEX);
       CreateIndexSqlNode &create_index = $$->create_index;
       create_index.index_name = $3;
       create_index.relation_name = $5;
-      create_index.attribute_name = $7;
+      create_index.attribute_names.swap(*$7);
+      delete $7;
+    }
+    | CREATE VECTOR_T INDEX ID ON ID LBRACE ID RBRACE WITH LBRACE index_param_list RBRACE
+    {
+      $$ = new ParsedSqlNode(SCF_CREATE_INDEX);
+      CreateIndexSqlNode &create_index = $$->create_index;
+      create_index.index_name = $4;
+      create_index.relation_name = $6;
+      create_index.attribute_names.push_back($8);
+      create_index.is_vector = true;
+      create_index.params.swap(*$12);
+      delete $12;
+    }
+    ;
+
+index_param_list:
+    ID EQ ID
+    {
+      $$ = new vector<pair<string, string>>;
+      $$->emplace_back($1, $3);
+    }
+    | ID EQ NUMBER
+    {
+      $$ = new vector<pair<string, string>>;
+      $$->emplace_back($1, std::to_string($3));
+    }
+    | index_param_list COMMA ID EQ ID
+    {
+      $$ = $1;
+      $$->emplace_back($3, $5);
+    }
+    | index_param_list COMMA ID EQ NUMBER
+    {
+      $$ = $1;
+      $$->emplace_back($3, std::to_string($5));
     }
     ;
 
@@ -367,6 +436,10 @@ attr_def:
       $$->type = (AttrType)$2;
       $$->name = $1;
       $$->length = $4;
+      if ($$->type == AttrType::VECTORS) {
+        // 向量类型括号中是维度，记录的长度是字节数
+        $$->length = $4 * sizeof(float);
+      }
     }
     | ID type
     {
@@ -457,6 +530,10 @@ value:
       $$ = Value::try_set_date_from_string(str, n);
       free(str);  // 释放 substr 分配的内存
     }
+    |'?' {
+      // 预处理语句的参数占位符，按照出现的顺序编号
+      $$ = new Value(Value::param(sql_result->add_param()));
+    }
     ;
 storage_format:
     /* empty */
@@ -494,7 +571,7 @@ update_stmt:      /*  update 语句的语法解析树*/
     }
     ;
 select_stmt:        /*  select 语句的语法解析树*/
-    SELECT expression_list FROM rel_list where group_by
+    SELECT expression_list FROM rel_list where group_by order_by limit
     {
       $$ = new ParsedSqlNode(SCF_SELECT);
       if ($2 != nullptr) {
@@ -516,6 +593,13 @@ select_stmt:        /*  select 语句的语法解析树*/
         $$->selection.group_by.swap(*$6);
         delete $6;
       }
+
+      if ($7 != nullptr) {
+        $$->selection.order_by.swap(*$7);
+        delete $7;
+      }
+
+      $$->selection.limit = $8;
     }
     ;
 calc_stmt:
@@ -580,6 +664,9 @@ expression:
     | aggregate_expression {
       $$ = $1;
     }
+    | function_expression {
+      $$ = $1;
+    }
     ;
 
 aggregate_expression:
@@ -588,6 +675,16 @@ aggregate_expression:
     }
     ;
 
+function_expression:
+    ID LBRACE expression COMMA expression RBRACE {
+      $$ = create_vector_distance_expression($1, $3, $5, sql_string, &@$);
+      if ($$ == nullptr) {
+        yyerror(&@$, sql_string, sql_result, scanner, "unknown function");
+        YYERROR;
+      }
+    }
+    ;
+
 rel_attr:
     ID {
       $$ = new RelAttrSqlNode;
@@ -719,6 +816,63 @@ group_by:
       $$ = $3;
     }
     ;
+
+order_by:
+    /* empty */
+    {
+      $$ = nullptr;
+    }
+    | ORDER BY order_by_list
+    {
+      $$ = $3;
+    }
+    ;
+
+order_by_list:
+    order_by_item
+    {
+      $$ = new vector<OrderBySqlNode>;
+      $$->emplace_back(std::move(*$1));
+      delete $1;
+    }
+    | order_by_item COMMA order_by_list
+    {
+      $$ = $3;
+      $$->emplace($$->begin(), std::move(*$1));
+      delete $1;
+    }
+    ;
+
+order_by_item:
+    expression
+    {
+      $$ = new OrderBySqlNode;
+      $$->expression.reset($1);
+    }
+    | expression ASC
+    {
+      $$ = new OrderBySqlNode;
+      $$->expression.reset($1);
+    }
+    | expression DESC
+    {
+      $$ = new OrderBySqlNode;
+      $$->expression.reset($1);
+      $$->asc = false;
+    }
+    ;
+
+limit:
+    /* empty */
+    {
+      $$ = -1;
+    }
+    | LIMIT NUMBER
+    {
+      $$ = $2;
+    }
+    ;
+
 load_data_stmt:
     LOAD DATA INFILE SSS INTO TABLE ID fields_terminated_by enclosed_by
     {
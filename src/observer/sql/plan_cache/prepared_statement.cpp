@@ -0,0 +1,39 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/plan_cache/prepared_statement.h"
+#include "sql/parser/parse_defs.h"
+#include "sql/stmt/stmt.h"
+
+PreparedStatement::PreparedStatement(int id, unique_ptr<ParsedSqlNode> sql_node, Stmt *stmt,
+    unique_ptr<PhysicalOperator> physical_operator, bool chunk_mode)
+    : id_(id),
+      sql_node_(std::move(sql_node)),
+      stmt_(stmt),
+      physical_operator_(std::move(physical_operator)),
+      chunk_mode_(chunk_mode)
+{
+  if (physical_operator_ != nullptr) {
+    physical_operator_->tuple_schema(tuple_schema_);
+  }
+}
+
+PreparedStatement::~PreparedStatement()
+{
+  // 执行计划中可能引用了 Stmt 中的数据，先释放执行计划
+  physical_operator_.reset();
+
+  if (stmt_ != nullptr) {
+    delete stmt_;
+    stmt_ = nullptr;
+  }
+}
+
+int PreparedStatement::param_count() const { return sql_node_->param_count; }
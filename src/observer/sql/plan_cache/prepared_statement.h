@@ -0,0 +1,55 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/memory.h"
+#include "sql/expr/tuple.h"
+#include "sql/operator/physical_operator.h"
+
+class ParsedSqlNode;
+class Stmt;
+
+/**
+ * @brief 服务端的预处理语句
+ * @ingroup SQLStage
+ * @details 语法解析、语义解析和生成执行计划只在预处理时做一次，每次执行都复用保存下来的执行计划，
+ * 计划中的参数占位符在执行时从请求中取值。
+ * 没有执行计划的语句（比如DDL）保存的是 Stmt，每次执行时交给 CommandExecutor。
+ */
+class PreparedStatement
+{
+public:
+  PreparedStatement(int id, unique_ptr<ParsedSqlNode> sql_node, Stmt *stmt,
+      unique_ptr<PhysicalOperator> physical_operator, bool chunk_mode);
+  ~PreparedStatement();
+
+  int id() const { return id_; }
+
+  /// 参数占位符的个数
+  int param_count() const;
+
+  Stmt                               *stmt() const { return stmt_; }
+  const shared_ptr<PhysicalOperator> &physical_operator() const { return physical_operator_; }
+
+  /// 执行计划是否按照 chunk 的方式执行
+  bool chunk_mode() const { return chunk_mode_; }
+
+  /// 执行结果的表头，没有执行计划时为空
+  const TupleSchema &tuple_schema() const { return tuple_schema_; }
+
+private:
+  int                          id_;
+  unique_ptr<ParsedSqlNode>    sql_node_;  ///< Stmt 中可能引用了语法树中的数据，需要一起保留
+  Stmt                        *stmt_ = nullptr;
+  shared_ptr<PhysicalOperator> physical_operator_;
+  bool                         chunk_mode_ = false;
+  TupleSchema                  tuple_schema_;
+};
@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "sql/stmt/create_index_stmt.h"
+#include "common/lang/algorithm.h"
 #include "common/lang/string.h"
 #include "common/log/log.h"
 #include "storage/db/db.h"
@@ -26,10 +27,9 @@ RC CreateIndexStmt::create(Db *db, const CreateIndexSqlNode &create_index, Stmt
   stmt = nullptr;
 
   const char *table_name = create_index.relation_name.c_str();
-  if (is_blank(table_name) || is_blank(create_index.index_name.c_str()) ||
-      is_blank(create_index.attribute_name.c_str())) {
-    LOG_WARN("invalid argument. db=%p, table_name=%p, index name=%s, attribute name=%s",
-        db, table_name, create_index.index_name.c_str(), create_index.attribute_name.c_str());
+  if (is_blank(table_name) || is_blank(create_index.index_name.c_str()) || create_index.attribute_names.empty()) {
+    LOG_WARN("invalid argument. db=%p, table_name=%p, index name=%s, attribute num=%d",
+        db, table_name, create_index.index_name.c_str(), static_cast<int>(create_index.attribute_names.size()));
     return RC::INVALID_ARGUMENT;
   }
 
@@ -40,11 +40,42 @@ RC CreateIndexStmt::create(Db *db, const CreateIndexSqlNode &create_index, Stmt
     return RC::SCHEMA_TABLE_NOT_EXIST;
   }
 
-  const FieldMeta *field_meta = table->table_meta().field(create_index.attribute_name.c_str());
-  if (nullptr == field_meta) {
-    LOG_WARN("no such field in table. db=%s, table=%s, field name=%s", 
-             db->name(), table_name, create_index.attribute_name.c_str());
-    return RC::SCHEMA_FIELD_NOT_EXIST;
+  vector<const FieldMeta *> field_metas;
+  for (const string &attribute_name : create_index.attribute_names) {
+    const FieldMeta *field_meta = table->table_meta().field(attribute_name.c_str());
+    if (nullptr == field_meta) {
+      LOG_WARN("no such field in table. db=%s, table=%s, field name=%s", 
+               db->name(), table_name, attribute_name.c_str());
+      return RC::SCHEMA_FIELD_NOT_EXIST;
+    }
+
+    // 向量只能使用向量索引，向量索引也只能建在向量字段上
+    if ((field_meta->type() == AttrType::VECTORS) != create_index.is_vector) {
+      LOG_WARN("index type doesn't match field type. table=%s, field name=%s, type=%s, vector index=%d",
+               table_name, attribute_name.c_str(), attr_type_to_string(field_meta->type()), create_index.is_vector);
+      return RC::UNSUPPORTED;
+    }
+
+    if (find(field_metas.begin(), field_metas.end(), field_meta) != field_metas.end()) {
+      LOG_WARN("duplicate field in index. table=%s, field name=%s", table_name, attribute_name.c_str());
+      return RC::INVALID_ARGUMENT;
+    }
+
+    // 多字段索引在前缀扫描时需要用每个字段类型的最小值和最大值填充边界
+    if (create_index.attribute_names.size() > 1) {
+      switch (field_meta->type()) {
+        case AttrType::INTS:
+        case AttrType::FLOATS:
+        case AttrType::CHARS:
+        case AttrType::DATES: break;
+        default: {
+          LOG_WARN("unsupported field type in multi-field index. table=%s, field name=%s, type=%s",
+                   table_name, attribute_name.c_str(), attr_type_to_string(field_meta->type()));
+          return RC::UNSUPPORTED;
+        }
+      }
+    }
+    field_metas.push_back(field_meta);
   }
 
   Index *index = table->find_index(create_index.index_name.c_str());
@@ -53,6 +84,60 @@ RC CreateIndexStmt::create(Db *db, const CreateIndexSqlNode &create_index, Stmt
     return RC::SCHEMA_INDEX_NAME_REPEAT;
   }
 
-  stmt = new CreateIndexStmt(table, field_meta, create_index.index_name);
+  if (create_index.is_vector) {
+    IvfflatOptions options;
+    RC             rc = parse_ivfflat_options(create_index, options);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    stmt = new CreateIndexStmt(table, field_metas[0], create_index.index_name, options);
+    return RC::SUCCESS;
+  }
+
+  stmt = new CreateIndexStmt(table, std::move(field_metas), create_index.index_name);
+  return RC::SUCCESS;
+}
+
+RC CreateIndexStmt::parse_ivfflat_options(const CreateIndexSqlNode &create_index, IvfflatOptions &options)
+{
+  if (create_index.attribute_names.size() != 1) {
+    LOG_WARN("vector index can only be created on one field. index=%s", create_index.index_name.c_str());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  bool has_type = false;
+  for (const auto &[name, value] : create_index.params) {
+    RC rc = RC::SUCCESS;
+    if (0 == strcasecmp(name.c_str(), "type")) {
+      has_type = true;
+      if (0 != strcasecmp(value.c_str(), "ivfflat")) {
+        rc = RC::UNSUPPORTED;
+      }
+    } else if (0 == strcasecmp(name.c_str(), "distance")) {
+      rc = vector_distance_type_from_string(value.c_str(), options.distance);
+    } else if (0 == strcasecmp(name.c_str(), "lists")) {
+      options.lists = atoi(value.c_str());
+      rc            = options.lists > 0 ? RC::SUCCESS : RC::INVALID_ARGUMENT;
+    } else if (0 == strcasecmp(name.c_str(), "probes")) {
+      options.probes = atoi(value.c_str());
+      rc             = options.probes > 0 ? RC::SUCCESS : RC::INVALID_ARGUMENT;
+    } else {
+      rc = RC::INVALID_ARGUMENT;
+    }
+
+    if (OB_FAIL(rc)) {
+      LOG_WARN("invalid vector index option. index=%s, %s=%s, rc=%s",
+               create_index.index_name.c_str(), name.c_str(), value.c_str(), strrc(rc));
+      return rc;
+    }
+  }
+
+  if (!has_type) {
+    LOG_WARN("vector index type is required. index=%s", create_index.index_name.c_str());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  // 扫描的链表个数不会超过链表总数
+  options.probes = min(options.probes, options.lists);
   return RC::SUCCESS;
 }
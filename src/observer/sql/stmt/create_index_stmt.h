@@ -15,6 +15,7 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include "sql/stmt/stmt.h"
+#include "storage/index/index_meta.h"
 
 struct CreateIndexSqlNode;
 class Table;
@@ -27,23 +28,33 @@ class FieldMeta;
 class CreateIndexStmt : public Stmt
 {
 public:
-  CreateIndexStmt(Table *table, const FieldMeta *field_meta, const string &index_name)
-      : table_(table), field_meta_(field_meta), index_name_(index_name)
+  CreateIndexStmt(Table *table, vector<const FieldMeta *> field_metas, const string &index_name)
+      : table_(table), field_metas_(std::move(field_metas)), index_name_(index_name)
+  {}
+  CreateIndexStmt(Table *table, const FieldMeta *field_meta, const string &index_name, const IvfflatOptions &options)
+      : table_(table), field_metas_{field_meta}, index_name_(index_name), is_vector_(true), ivfflat_options_(options)
   {}
 
   virtual ~CreateIndexStmt() = default;
 
   StmtType type() const override { return StmtType::CREATE_INDEX; }
 
-  Table           *table() const { return table_; }
-  const FieldMeta *field_meta() const { return field_meta_; }
-  const string    &index_name() const { return index_name_; }
+  Table                           *table() const { return table_; }
+  const vector<const FieldMeta *> &field_metas() const { return field_metas_; }
+  const string                    &index_name() const { return index_name_; }
+  bool                             is_vector() const { return is_vector_; }
+  const IvfflatOptions            &ivfflat_options() const { return ivfflat_options_; }
 
 public:
   static RC create(Db *db, const CreateIndexSqlNode &create_index, Stmt *&stmt);
 
 private:
-  Table           *table_      = nullptr;
-  const FieldMeta *field_meta_ = nullptr;
-  string           index_name_;
+  static RC parse_ivfflat_options(const CreateIndexSqlNode &create_index, IvfflatOptions &options);
+
+private:
+  Table                    *table_ = nullptr;
+  vector<const FieldMeta *> field_metas_;  ///< 索引的字段，按照索引键中的顺序
+  string                    index_name_;
+  bool                      is_vector_ = false;  ///< 是否为向量索引
+  IvfflatOptions            ivfflat_options_;    ///< 向量索引的参数
 };
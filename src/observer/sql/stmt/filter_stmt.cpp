@@ -146,8 +146,10 @@ RC FilterStmt::create_filter_unit(Db *db, Table *default_table, unordered_map<st
     right_type = right_obj.value.attr_type();
   }
   
-  // 检查类型是否匹配
-  if (left_type != right_type) {
+  // 检查类型是否匹配。参数在执行时才有值，会转换成另一边的类型
+  const bool has_param = (!left_obj.is_attr && left_obj.value.is_param()) ||
+                         (!right_obj.is_attr && right_obj.value.is_param());
+  if (!has_param && left_type != right_type) {
     LOG_WARN("Type mismatch in filter condition: left_type=%s, right_type=%s", 
              attr_type_to_string(left_type), attr_type_to_string(right_type));
     delete filter_unit;
@@ -82,6 +82,18 @@ RC SelectStmt::create(Db *db, SelectSqlNode &select_sql, Stmt *&stmt)
     }
   }
 
+  vector<unique_ptr<Expression>> order_by_expressions;
+  vector<bool>                   order_by_asc;
+  for (OrderBySqlNode &order_by : select_sql.order_by) {
+    RC rc = expression_binder.bind_expression(order_by.expression, order_by_expressions);
+    if (OB_FAIL(rc)) {
+      LOG_INFO("bind expression failed. rc=%s", strrc(rc));
+      return rc;
+    }
+    // order by * 会展开成多个字段，都使用相同的排序方向
+    order_by_asc.resize(order_by_expressions.size(), order_by.asc);
+  }
+
   Table *default_table = nullptr;
   if (tables.size() == 1) {
     default_table = tables[0];
@@ -108,6 +120,9 @@ RC SelectStmt::create(Db *db, SelectSqlNode &select_sql, Stmt *&stmt)
   select_stmt->query_expressions_.swap(bound_expressions);
   select_stmt->filter_stmt_ = filter_stmt;
   select_stmt->group_by_.swap(group_by_expressions);
+  select_stmt->order_by_.swap(order_by_expressions);
+  select_stmt->order_by_asc_.swap(order_by_asc);
+  select_stmt->limit_       = select_sql.limit;
   stmt                      = select_stmt;
   return RC::SUCCESS;
 }
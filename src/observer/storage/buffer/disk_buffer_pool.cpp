@@ -17,6 +17,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/io/io.h"
 #include "common/lang/mutex.h"
 #include "common/lang/algorithm.h"
+#include "common/lang/chrono.h"
 #include "common/log/log.h"
 #include "common/math/crc.h"
 #include "storage/buffer/disk_buffer_pool.h"
@@ -152,6 +153,17 @@ RC BPFrameManager::free(int buffer_pool_id, PageNum page_num, Frame *frame)
   return free_internal(frame_id, frame);
 }
 
+RC BPFrameManager::try_free(int buffer_pool_id, PageNum page_num, Frame *frame)
+{
+  FrameId frame_id(buffer_pool_id, page_num);
+
+  lock_guard<mutex> lock_guard(lock_);
+  if (frame->pin_count() != 1) {
+    return RC::LOCKED_NEED_WAIT;
+  }
+  return free_internal(frame_id, frame);
+}
+
 RC BPFrameManager::free_internal(const FrameId &frame_id, Frame *frame)
 {
   Frame                *frame_source = nullptr;
@@ -186,7 +198,7 @@ list<Frame *> BPFrameManager::find_list(int buffer_pool_id)
 ////////////////////////////////////////////////////////////////////////////////
 BufferPoolIterator::BufferPoolIterator() {}
 BufferPoolIterator::~BufferPoolIterator() {}
-RC BufferPoolIterator::init(DiskBufferPool &bp, PageNum start_page /* = 0 */)
+RC BufferPoolIterator::init(DiskBufferPool &bp, PageNum start_page /* = 0 */, PageNum end_page /* = -1 */)
 {
   bitmap_.init(bp.file_header_->bitmap, bp.file_header_->page_count);
   if (start_page <= 0) {
@@ -194,14 +206,22 @@ RC BufferPoolIterator::init(DiskBufferPool &bp, PageNum start_page /* = 0 */)
   } else {
     current_page_num_ = start_page - 1;
   }
+  end_page_num_ = end_page;
   return RC::SUCCESS;
 }
 
-bool BufferPoolIterator::has_next() { return bitmap_.next_setted_bit(current_page_num_ + 1) != -1; }
+bool BufferPoolIterator::has_next()
+{
+  PageNum next_page = bitmap_.next_setted_bit(current_page_num_ + 1);
+  return next_page != -1 && (end_page_num_ < 0 || next_page < end_page_num_);
+}
 
 PageNum BufferPoolIterator::next()
 {
   PageNum next_page = bitmap_.next_setted_bit(current_page_num_ + 1);
+  if (end_page_num_ >= 0 && next_page >= end_page_num_) {
+    next_page = -1;
+  }
   if (next_page != -1) {
     current_page_num_ = next_page;
   }
@@ -441,13 +461,41 @@ RC DiskBufferPool::dispose_page(PageNum page_num)
     return RC::INTERNAL;
   }
   
-  scoped_lock lock_guard(lock_);
-  Frame           *used_frame = frame_manager_.get(id(), page_num);
-  if (used_frame != nullptr) {
-    ASSERT("the page try to dispose is in use. frame:%s", used_frame->to_string().c_str());
-    frame_manager_.free(id(), page_num, used_frame);
-  } else {
-    LOG_DEBUG("page not found in memory while disposing it. pageNum=%d", page_num);
+#ifdef CONCURRENCY
+  // 其他线程的 pin 很快就会释放，等待这么久还释放不掉，说明是调用者自己还 pin 着这个页面
+  const auto deadline = chrono::steady_clock::now() + chrono::milliseconds(1000);
+#endif
+
+  unique_lock<common::Mutex> lock_guard(lock_);
+  while (true) {
+    Frame *used_frame = frame_manager_.get(id(), page_num);
+    if (used_frame == nullptr) {
+      LOG_DEBUG("page not found in memory while disposing it. pageNum=%d", page_num);
+      break;
+    }
+
+    if (frame_manager_.try_free(id(), page_num, used_frame) == RC::SUCCESS) {
+      break;
+    }
+
+    used_frame->unpin();
+#ifdef CONCURRENCY
+    if (chrono::steady_clock::now() >= deadline) {
+      LOG_ERROR("Failed to dispose page %d, because it is still pinned. frame=%s",
+                page_num, used_frame->to_string().c_str());
+      return RC::INTERNAL;
+    }
+
+    // 其他线程还 pin 着这个页面，它们可能在等待 buffer pool 的锁来加载别的页面，所以先把锁放开
+    lock_guard.unlock();
+    this_thread::yield();
+    lock_guard.lock();
+#else
+    // 没有其他线程会 unpin 这个页面，只能是调用者自己还 pin 着
+    LOG_ERROR("Failed to dispose page %d, because it is still pinned. frame=%s",
+              page_num, used_frame->to_string().c_str());
+    return RC::INTERNAL;
+#endif
   }
 
   LSN lsn = 0;
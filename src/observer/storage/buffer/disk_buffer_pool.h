@@ -125,6 +125,12 @@ public:
    */
   RC free(int buffer_pool_id, PageNum page_num, Frame *frame);
 
+  /**
+   * @brief 与 free 相同，但是页面还被其他人 pin 着时不释放，返回 RC::LOCKED_NEED_WAIT
+   * @details 调用者自己需要持有一个 pin
+   */
+  RC try_free(int buffer_pool_id, PageNum page_num, Frame *frame);
+
   /**
    * 如果不能从空闲链表中分配新的页面，就使用这个接口，
    * 尝试从pin count=0的页面中淘汰一些
@@ -170,7 +176,11 @@ public:
   BufferPoolIterator();
   ~BufferPoolIterator();
 
-  RC      init(DiskBufferPool &bp, PageNum start_page = 0);
+  /**
+   * @param start_page 从哪个页面开始遍历
+   * @param end_page 遍历到哪个页面为止（不包含），小于0表示遍历到文件末尾
+   */
+  RC      init(DiskBufferPool &bp, PageNum start_page = 0, PageNum end_page = -1);
   bool    has_next();
   PageNum next();
   RC      reset();
@@ -178,6 +188,7 @@ public:
 private:
   common::Bitmap bitmap_;
   PageNum        current_page_num_ = -1;
+  PageNum        end_page_num_     = -1;
 };
 
 /**
@@ -217,6 +228,8 @@ public:
 
   /**
    * @brief 释放某个页面，将此页面设置为未分配状态
+   * @details B+树乐观地读取页面时只 pin 页面不加锁，被释放的页面可能还被这样的读者 pin 着，
+   * 这时会等待它们校验失败后放开页面
    *
    * @param page_num 待释放的页面
    */
@@ -272,6 +285,9 @@ public:
 public:
   int32_t id() const { return buffer_pool_id_; }
 
+  /// 文件中一共有多少个页面，包括文件头页面和没有分配的页面
+  PageNum page_count() const { return file_header_->page_count; }
+
   const char *filename() const { return file_name_.c_str(); }
 
 protected:
@@ -76,6 +76,12 @@ void Frame::write_latch(intptr_t xid)
 
   lock_.lock();
 
+  if (write_latch_depth_++ == 0) {
+    // 先让版本号变成奇数，再修改页面，不加锁的读者就能发现页面正在被修改
+    version_.store(version_.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+  }
+
 #ifdef DEBUG
   write_locker_ = xid;
   ++write_recursive_count_;
@@ -110,6 +116,10 @@ void Frame::write_unlatch(intptr_t xid)
   }
   debug_lock_.unlock();
 
+  if (--write_latch_depth_ == 0) {
+    version_.store(version_.load(memory_order_relaxed) + 1, memory_order_release);
+  }
+
   lock_.unlock();
 }
 
@@ -166,6 +166,19 @@ public:
   void read_unlatch();
   void read_unlatch(intptr_t xid);
 
+  /**
+   * @brief 页面的版本号，用于不加锁地读取页面
+   * @details 加写锁时版本号加一变成奇数，释放写锁时再加一变成偶数（递归加锁只在最外层修改版本号）。
+   * 读取页面之前记录版本号，读取之后调用 validate_version 校验，版本号没有变化并且是偶数，
+   * 说明读取的过程中没有人修改页面，读到的内容是一致的。
+   */
+  uint64_t read_version() const { return version_.load(memory_order_acquire); }
+  bool     validate_version(uint64_t version) const
+  {
+    atomic_thread_fence(memory_order_acquire);
+    return version_.load(memory_order_relaxed) == version;
+  }
+
   string to_string() const;
 
 private:
@@ -180,6 +193,9 @@ private:
   /// 在非并发编译时，加锁解锁动作将什么都不做
   common::RecursiveSharedMutex lock_;
 
+  atomic<uint64_t> version_{0};           ///< 页面版本号，参考 read_version
+  int              write_latch_depth_ = 0;  ///< 写锁递归加锁的次数，只有持有写锁的线程访问
+
   /// 使用一些手段来做测试，提前检测出头疼的死锁问题
   /// 如果编译时没有增加调试选项，这些代码什么都不做
   common::DebugMutex           debug_lock_;
@@ -130,7 +130,7 @@ public:
     if (i < 0) {
       i = std::numeric_limits<int64_t>::min() - i;
     }
-    if (OB_FAIL(append(s, i))) {
+    if (OB_FAIL(rc = append(s, i))) {
       LOG_WARN("append: append failed, i=%ld, x=%lf", i, x);
       return rc;
     }
@@ -178,12 +178,12 @@ public:
         LOG_WARN("orderedcode: string_or_infinity has non-zero string and non-zero infinity");
         return RC::INVALID_ARGUMENT;
       }
-      if (OB_FAIL(append(s, infinity{}))) {
+      if (OB_FAIL(rc = append(s, infinity{}))) {
         LOG_WARN("orderedcode: append infinity failed");
         return rc;
       }
     } else {
-      if (OB_FAIL(append(s, x.s))) {
+      if (OB_FAIL(rc = append(s, x.s))) {
         LOG_WARN("orderedcode: append string failed");
         return rc;
       }
@@ -379,9 +379,9 @@ public:
   static RC encode_without_rid(int64_t table_id, bytes &encoded_key)
   {
     RC rc = RC::SUCCESS;
-    if (OB_FAIL(OrderedCode::append(encoded_key, table_prefix))) {
+    if (OB_FAIL(rc = OrderedCode::append(encoded_key, table_prefix))) {
       LOG_WARN("append failed");
-    } else if (OB_FAIL(OrderedCode::append(encoded_key, table_id))) {
+    } else if (OB_FAIL(rc = OrderedCode::append(encoded_key, table_id))) {
       LOG_WARN("append failed");
     }
     return rc;
@@ -389,13 +389,13 @@ public:
   static RC encode(int64_t table_id, uint64_t rid, bytes &encoded_key)
   {
     RC rc = RC::SUCCESS;
-    if (OB_FAIL(OrderedCode::append(encoded_key, table_prefix))) {
+    if (OB_FAIL(rc = OrderedCode::append(encoded_key, table_prefix))) {
       LOG_WARN("append failed");
-    } else if (OB_FAIL(OrderedCode::append(encoded_key, table_id))) {
+    } else if (OB_FAIL(rc = OrderedCode::append(encoded_key, table_id))) {
       LOG_WARN("append failed");
-    } else if (OB_FAIL(OrderedCode::append(encoded_key, rowkey_prefix))) {
+    } else if (OB_FAIL(rc = OrderedCode::append(encoded_key, rowkey_prefix))) {
       LOG_WARN("append failed");
-    } else if (OB_FAIL(OrderedCode::append(encoded_key, rid))) {
+    } else if (OB_FAIL(rc = OrderedCode::append(encoded_key, rid))) {
       LOG_WARN("append failed");
     }
     return rc;
@@ -404,11 +404,51 @@ public:
   static RC encode_table_prefix(int64_t table_id, bytes &encoded_key)
   {
     RC rc = RC::SUCCESS;
-    if (OB_FAIL(OrderedCode::append(encoded_key, table_prefix))) {
+    if (OB_FAIL(rc = OrderedCode::append(encoded_key, table_prefix))) {
       LOG_WARN("append failed");
-    } else if (OB_FAIL(OrderedCode::append(encoded_key, table_id))) {
+    } else if (OB_FAIL(rc = OrderedCode::append(encoded_key, table_id))) {
       LOG_WARN("append failed");
-    } else if (OB_FAIL(OrderedCode::append(encoded_key, rowkey_prefix))) {
+    } else if (OB_FAIL(rc = OrderedCode::append(encoded_key, rowkey_prefix))) {
+      LOG_WARN("append failed");
+    }
+    return rc;
+  }
+
+  static RC encode_index_prefix(int64_t table_id, int64_t index_id, bytes &encoded_key)
+  {
+    RC rc = RC::SUCCESS;
+    if (OB_FAIL(rc = OrderedCode::append(encoded_key, table_prefix))) {
+      LOG_WARN("append failed");
+    } else if (OB_FAIL(rc = OrderedCode::append(encoded_key, table_id))) {
+      LOG_WARN("append failed");
+    } else if (OB_FAIL(rc = OrderedCode::append(encoded_key, index_prefix))) {
+      LOG_WARN("append failed");
+    } else if (OB_FAIL(rc = OrderedCode::append(encoded_key, index_id))) {
+      LOG_WARN("append failed");
+    }
+    return rc;
+  }
+
+  /**
+   * @brief 编码二级索引项的 key: (table_id, index_id, 索引键, rid)
+   * @details 编码后的 key 保持索引键的顺序，相同索引键的多条记录按 rid 排序。
+   * 多字段索引的索引键是各个字段的值依次编码，按字段的顺序逐个比较
+   */
+  static RC encode_index(
+      int64_t table_id, int64_t index_id, const vector<Value> &keys, uint64_t rid, bytes &encoded_key)
+  {
+    RC rc = RC::SUCCESS;
+    if (OB_FAIL(rc = encode_index_prefix(table_id, index_id, encoded_key))) {
+      LOG_WARN("append failed");
+      return rc;
+    }
+    for (const Value &key : keys) {
+      if (OB_FAIL(rc = encode_value(key, encoded_key))) {
+        LOG_WARN("append failed");
+        return rc;
+      }
+    }
+    if (OB_FAIL(rc = OrderedCode::append(encoded_key, rid))) {
       LOG_WARN("append failed");
     }
     return rc;
@@ -419,17 +459,18 @@ public:
     RC rc = RC::SUCCESS;
     switch (val.attr_type()) {
       case AttrType::INTS:
-        if (OB_FAIL(OrderedCode::append(dst, (int64_t)val.get_int()))) {
+      case AttrType::DATES:
+        if (OB_FAIL(rc = OrderedCode::append(dst, (int64_t)val.get_int()))) {
           LOG_WARN("append failed");
         }
         break;
       case AttrType::FLOATS:
-        if (OB_FAIL(OrderedCode::append(dst, (double)val.get_float()))) {
+        if (OB_FAIL(rc = OrderedCode::append(dst, (double)val.get_float()))) {
           LOG_WARN("append failed");
         }
         break;
       case AttrType::CHARS:
-        if (OB_FAIL(OrderedCode::append(dst, val.get_string()))) {
+        if (OB_FAIL(rc = OrderedCode::append(dst, val.get_string()))) {
           LOG_WARN("append failed");
         }
         break;
@@ -441,7 +482,7 @@ public:
   static RC encode_int(int64_t val, bytes &dst)
   {
     RC rc = RC::SUCCESS;
-    if (OB_FAIL(OrderedCode::append(dst, val))) {
+    if (OB_FAIL(rc = OrderedCode::append(dst, val))) {
       LOG_WARN("append failed");
     }
     return rc;
@@ -452,18 +493,40 @@ public:
     RC           rc = RC::SUCCESS;
     span<byte_t> sp(encoded_key);
     string       table_prefix;
-    if (OB_FAIL(OrderedCode::parse(sp, OrderedCode::increasing, table_prefix))) {
+    if (OB_FAIL(rc = OrderedCode::parse(sp, OrderedCode::increasing, table_prefix))) {
       LOG_WARN("parse failed");
       return rc;
-    } else if (OB_FAIL(OrderedCode::parse(sp, OrderedCode::increasing, table_id))) {
+    } else if (OB_FAIL(rc = OrderedCode::parse(sp, OrderedCode::increasing, table_id))) {
       LOG_WARN("parse failed");
       return rc;
     }
     return rc;
   }
 
+  static RC decode(bytes &encoded_key, int64_t &table_id, uint64_t &rid)
+  {
+    RC           rc = RC::SUCCESS;
+    span<byte_t> sp(encoded_key);
+    string       prefix;
+    if (OB_FAIL(rc = OrderedCode::parse(sp, OrderedCode::increasing, prefix))) {
+      LOG_WARN("parse failed");
+    } else if (OB_FAIL(rc = OrderedCode::parse(sp, OrderedCode::increasing, table_id))) {
+      LOG_WARN("parse failed");
+    } else if (OB_FAIL(rc = OrderedCode::parse(sp, OrderedCode::increasing, prefix))) {
+      LOG_WARN("parse failed");
+    } else if (prefix != rowkey_prefix) {
+      // 索引项等其它 key 不是记录
+      LOG_WARN("not a row key");
+      rc = RC::INVALID_ARGUMENT;
+    } else if (OB_FAIL(rc = OrderedCode::parse(sp, OrderedCode::increasing, rid))) {
+      LOG_WARN("parse failed");
+    }
+    return rc;
+  }
+
   static constexpr const char *table_prefix  = "t";
   static constexpr const char *rowkey_prefix = "r";
+  static constexpr const char *index_prefix  = "i";
 };
 
 // template<typename T>
@@ -82,6 +82,20 @@ void Column::init(const Value &value, size_t size)
   column_type_ = Type::CONSTANT_COLUMN;
 }
 
+void Column::init_dictionary(int attr_len, shared_ptr<StringDictionary> dictionary, size_t capacity)
+{
+  reset();
+  data_        = new char[capacity * sizeof(int32_t)];
+  memset(data_, 0, capacity * sizeof(int32_t));
+  count_       = 0;
+  capacity_    = capacity;
+  own_         = true;
+  attr_type_   = AttrType::CHARS;
+  attr_len_    = attr_len;
+  column_type_ = Type::DICTIONARY_COLUMN;
+  dictionary_  = std::move(dictionary);
+}
+
 void Column::reset()
 {
   if (vector_buffer_ != nullptr) {
@@ -90,12 +104,13 @@ void Column::reset()
   if (data_ != nullptr && own_) {
     delete[] data_;
   }
-  data_      = nullptr;
-  count_     = 0;
-  capacity_  = 0;
-  own_       = false;
-  attr_type_ = AttrType::UNDEFINED;
-  attr_len_  = -1;
+  data_       = nullptr;
+  count_      = 0;
+  capacity_   = 0;
+  own_        = false;
+  attr_type_  = AttrType::UNDEFINED;
+  attr_len_   = -1;
+  dictionary_ = nullptr;
 }
 
 RC Column::append_one(const char *data) { return append(data, 1); }
@@ -110,6 +125,17 @@ RC Column::append(const char *data, int count)
     LOG_WARN("append data to full column");
     return RC::INTERNAL;
   }
+  if (column_type_ == Type::DICTIONARY_COLUMN) {
+    // 字符串在结束符之后的内容不确定，编码时只使用结束符之前的部分
+    int32_t *codes = reinterpret_cast<int32_t *>(data_) + count_;
+    for (int i = 0; i < count; i++) {
+      const char *value = data + static_cast<size_t>(i) * attr_len_;
+      codes[i]          = dictionary_->add(value, strnlen(value, attr_len_));
+    }
+    count_ += count;
+    return RC::SUCCESS;
+  }
+
   // Using a larger integer type to avoid overflow
   size_t total_bytes = static_cast<size_t>(count) * static_cast<size_t>(attr_len_);
 
@@ -129,6 +155,13 @@ RC Column::append_value(const Value &value)
     return RC::INTERNAL;
   }
 
+  if (column_type_ == Type::DICTIONARY_COLUMN) {
+    const int len = std::min(value.length(), attr_len_);
+    reinterpret_cast<int32_t *>(data_)[count_] = dictionary_->add(value.data(), strnlen(value.data(), len));
+    count_ += 1;
+    return RC::SUCCESS;
+  }
+
   size_t total_bytes = std::min(value.length(), attr_len_);
   memcpy(data_ + count_ * attr_len_, value.data(), total_bytes);
   if (total_bytes < attr_len_)
@@ -154,9 +187,77 @@ Value Column::get_value(int index) const
   if (index >= count_ || index < 0) {
     return Value();
   }
+  if (column_type_ == Type::DICTIONARY_COLUMN) {
+    string_view str = dictionary_->get(codes()[index]);
+    Value       value;
+    value.set_string(str.data(), static_cast<int>(str.size()));
+    return value;
+  }
   return Value(attr_type_, &data_[index * attr_len_], attr_len_);
 }
 
+RC Column::append_selected(const Column &src, const vector<uint8_t> &select)
+{
+  if (!own_) {
+    LOG_WARN("append data to non-owned column");
+    return RC::INTERNAL;
+  }
+
+  const bool src_constant = src.column_type() == Type::CONSTANT_COLUMN;
+  const bool src_encoded  = src.column_type() == Type::DICTIONARY_COLUMN;
+  const bool same_codes   = src_encoded && column_type_ == Type::DICTIONARY_COLUMN && src.dictionary() == dictionary_;
+  if (!same_codes && (src_encoded || column_type_ == Type::DICTIONARY_COLUMN)) {
+    if (column_type_ == Type::DICTIONARY_COLUMN) {
+      // 使用不同字典的列之间只能逐个重新编码
+      RC rc = RC::SUCCESS;
+      for (int i = 0; i < src.count() && OB_SUCC(rc); i++) {
+        if (select[i] != 0) {
+          rc = append_value(src.get_value(i));
+        }
+      }
+      return rc;
+    }
+
+    // 解码成定长的字符串，结束符之后补0
+    const int32_t *codes = src.codes();
+    for (int i = 0; i < src.count(); i++) {
+      if (select[i] == 0) {
+        continue;
+      }
+      if (count_ >= capacity_) {
+        LOG_WARN("append data to full column");
+        return RC::INTERNAL;
+      }
+      string_view str  = src.dictionary()->get(codes[i]);
+      char       *dest = data_ + static_cast<size_t>(count_) * attr_len_;
+      const int   len  = std::min(static_cast<int>(str.size()), attr_len_);
+      memcpy(dest, str.data(), len);
+      memset(dest + len, 0, attr_len_ - len);
+      count_++;
+    }
+    return RC::SUCCESS;
+  }
+
+  const int len = slot_len();
+  if (src.slot_len() != len) {
+    LOG_WARN("column length mismatch. src=%d, dest=%d", src.slot_len(), len);
+    return RC::INTERNAL;
+  }
+  for (int i = 0; i < src.count(); i++) {
+    if (select[i] == 0) {
+      continue;
+    }
+    if (count_ >= capacity_) {
+      LOG_WARN("append data to full column");
+      return RC::INTERNAL;
+    }
+    const int index = src_constant ? 0 : i;
+    memcpy(data_ + static_cast<size_t>(count_) * len, src.data() + static_cast<size_t>(index) * len, len);
+    count_++;
+  }
+  return RC::SUCCESS;
+}
+
 void Column::reference(const Column &column)
 {
   if (this == &column) {
@@ -170,6 +271,7 @@ void Column::reference(const Column &column)
   this->own_      = false;
 
   this->column_type_ = column.column_type();
+  this->dictionary_  = column.dictionary();
   this->attr_type_   = column.attr_type();
   this->attr_len_    = column.attr_len();
 }
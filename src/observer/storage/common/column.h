@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 #include <string.h>
 
 #include "storage/field/field_meta.h"
+#include "storage/common/string_dictionary.h"
 #include "storage/common/vector_buffer.h"
 
 /**
@@ -24,8 +25,9 @@ class Column
 public:
   enum class Type
   {
-    NORMAL_COLUMN,   /// Normal column represents a list of fixed-length values
-    CONSTANT_COLUMN  /// Constant column represents a single value
+    NORMAL_COLUMN,     /// Normal column represents a list of fixed-length values
+    CONSTANT_COLUMN,   /// Constant column represents a single value
+    DICTIONARY_COLUMN  /// Dictionary column stores int32 codes of a StringDictionary instead of CHARS values
   };
 
   Column() = default;
@@ -38,8 +40,9 @@ public:
     attr_type_   = other.attr_type_;
     attr_len_    = other.attr_len_;
     column_type_ = other.column_type_;
-    data_        = new char[capacity_ * attr_len_];
-    memcpy(data_, other.data_, capacity_ * attr_len_);
+    dictionary_  = other.dictionary_;
+    data_        = new char[capacity_ * slot_len()];
+    memcpy(data_, other.data_, capacity_ * slot_len());
     vector_buffer_ = make_unique<VectorBuffer>();
   }
   Column(Column &&other)
@@ -51,6 +54,7 @@ public:
     attr_type_      = other.attr_type_;
     attr_len_       = other.attr_len_;
     column_type_    = other.column_type_;
+    dictionary_     = std::move(other.dictionary_);
     vector_buffer_  = std::move(other.vector_buffer_);
     other.data_     = nullptr;
     other.count_    = 0;
@@ -65,6 +69,13 @@ public:
   void init(AttrType attr_type, int attr_len, size_t size = DEFAULT_CAPACITY);
   void init(const Value &value, size_t size);
 
+  /**
+   * @brief 初始化成字典编码的字符串列
+   * @details 写入的字符串会被编码成 dictionary 中的编号，data() 中保存的是 int32_t 类型的编号，
+   * attr_len() 仍然是字符串的长度。多个列可以共享同一个字典，编号在这些列之间可以直接比较。
+   */
+  void init_dictionary(int attr_len, shared_ptr<StringDictionary> dictionary, size_t size = DEFAULT_CAPACITY);
+
   unique_ptr<Column> clone() const { return make_unique<Column>(*this); }
 
   virtual ~Column() { reset(); }
@@ -82,6 +93,12 @@ public:
    */
   RC append(const char *data, int count);
 
+  /**
+   * @brief 追加 src 中 select 不为0的行
+   * @details 两个列使用同一个字典时直接复制编号；src 是字典编码的列而当前列不是时，写入解码之后的字符串
+   */
+  RC append_selected(const Column &src, const vector<uint8_t> &select);
+
   /**
    * @brief 获取 index 位置的列值
    */
@@ -89,14 +106,14 @@ public:
 
   RC copy_to(void *dest, int start_rows, int insert_rows) const
   {
-    memcpy(dest, data_ + start_rows * attr_len_, insert_rows * attr_len_);
+    memcpy(dest, data_ + start_rows * slot_len(), insert_rows * slot_len());
     return RC::SUCCESS;
   }
 
   /**
    * @brief 获取列数据的实际大小（字节）
    */
-  int data_len() const { return count_ * attr_len_; }
+  int data_len() const { return count_ * slot_len(); }
 
   char *data() const { return data_; }
 
@@ -127,6 +144,18 @@ public:
   Type                    column_type() const { return column_type_; }
   static constexpr size_t DEFAULT_CAPACITY = 8192;
 
+  const shared_ptr<StringDictionary> &dictionary() const { return dictionary_; }
+
+  /// 字典编码的列中每一行的编号
+  const int32_t *codes() const { return reinterpret_cast<const int32_t *>(data_); }
+
+private:
+  /// data_ 中每个值占用的字节数
+  int slot_len() const
+  {
+    return column_type_ == Type::DICTIONARY_COLUMN ? static_cast<int>(sizeof(int32_t)) : attr_len_;
+  }
+
 private:
   char *data_ = nullptr;
   /// 当前列值数量
@@ -140,6 +169,7 @@ private:
   /// 列属性类型长度（目前只支持定长）
   int attr_len_ = -1;
   /// 列类型
-  Type                     column_type_   = Type::NORMAL_COLUMN;
-  unique_ptr<VectorBuffer> vector_buffer_ = nullptr;
+  Type                         column_type_   = Type::NORMAL_COLUMN;
+  shared_ptr<StringDictionary> dictionary_;  ///< 字典编码的列使用的字典
+  unique_ptr<VectorBuffer>     vector_buffer_ = nullptr;
 };
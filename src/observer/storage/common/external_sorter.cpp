@@ -0,0 +1,191 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/common/external_sorter.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/filesystem.h"
+#include "common/log/log.h"
+
+ExternalSorter::ExternalSorter(int item_size, Comparator comparator, size_t memory_budget, string temp_file_prefix)
+    : item_size_(item_size),
+      comparator_(std::move(comparator)),
+      memory_budget_(memory_budget),
+      temp_file_prefix_(std::move(temp_file_prefix))
+{}
+
+ExternalSorter::~ExternalSorter()
+{
+  for (unique_ptr<Run> &run : runs_) {
+    run->stream.close();
+    std::error_code ec;
+    filesystem::remove(run->file_name, ec);
+  }
+}
+
+RC ExternalSorter::add(const char *item)
+{
+  if (finished_) {
+    return RC::INTERNAL;
+  }
+
+  // 每条数据在内存中还需要一个排序用的指针
+  if (!buffer_.empty() && buffer_.size() / item_size_ * (item_size_ + sizeof(char *)) >= memory_budget_) {
+    RC rc = spill();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  buffer_.insert(buffer_.end(), item, item + item_size_);
+  count_++;
+  return RC::SUCCESS;
+}
+
+void ExternalSorter::sort_buffer()
+{
+  const size_t num = buffer_.size() / item_size_;
+  sorted_.resize(num);
+  for (size_t i = 0; i < num; i++) {
+    sorted_[i] = buffer_.data() + i * item_size_;
+  }
+  std::sort(sorted_.begin(), sorted_.end(), [this](const char *a, const char *b) { return comparator_(a, b) < 0; });
+}
+
+RC ExternalSorter::spill()
+{
+  sort_buffer();
+
+  auto run       = make_unique<Run>();
+  run->file_name = temp_file_prefix_ + "." + std::to_string(runs_.size());
+  run->item_size = item_size_;
+  run->remain    = static_cast<int64_t>(sorted_.size());
+
+  ofstream out(run->file_name, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    LOG_WARN("failed to create temp file for external sort. file=%s", run->file_name.c_str());
+    return RC::IOERR_OPEN;
+  }
+  // 先记录到 runs_ 中，出错时也能在析构时删掉临时文件
+  runs_.push_back(std::move(run));
+
+  for (const char *item : sorted_) {
+    out.write(item, item_size_);
+  }
+  out.close();
+  if (out.fail()) {
+    LOG_WARN("failed to write temp file for external sort. file=%s", runs_.back()->file_name.c_str());
+    return RC::IOERR_WRITE;
+  }
+
+  LOG_DEBUG("spill a run of external sort. file=%s, items=%ld", runs_.back()->file_name.c_str(), runs_.back()->remain);
+  buffer_.clear();
+  sorted_.clear();
+  return RC::SUCCESS;
+}
+
+RC ExternalSorter::fill(Run &run)
+{
+  const int num = static_cast<int>(std::min<int64_t>(run.remain, run.buffer.size() / item_size_));
+  run.stream.read(run.buffer.data(), static_cast<std::streamsize>(num) * item_size_);
+  if (!run.stream) {
+    LOG_WARN("failed to read temp file of external sort. file=%s", run.file_name.c_str());
+    return RC::IOERR_READ;
+  }
+  run.remain -= num;
+  run.size = num;
+  run.pos  = 0;
+  return RC::SUCCESS;
+}
+
+RC ExternalSorter::finish()
+{
+  if (finished_) {
+    return RC::SUCCESS;
+  }
+  finished_ = true;
+
+  if (runs_.empty()) {
+    sort_buffer();
+    sorted_pos_ = 0;
+    return RC::SUCCESS;
+  }
+
+  RC rc = RC::SUCCESS;
+  if (!buffer_.empty() && OB_FAIL(rc = spill())) {
+    return rc;
+  }
+  buffer_.shrink_to_fit();
+  sorted_.shrink_to_fit();
+
+  // 内存预算平均分给每个 run 做读缓存，每个 run 至少缓存一条数据
+  const size_t items_per_run = std::max<size_t>(1, memory_budget_ / runs_.size() / item_size_);
+  for (size_t i = 0; i < runs_.size(); i++) {
+    Run &run = *runs_[i];
+    run.stream.open(run.file_name, std::ios::binary);
+    if (!run.stream.is_open()) {
+      LOG_WARN("failed to open temp file of external sort. file=%s", run.file_name.c_str());
+      return RC::IOERR_OPEN;
+    }
+    run.buffer.resize(items_per_run * item_size_);
+    if (OB_FAIL(rc = fill(run))) {
+      return rc;
+    }
+    heap_.push_back(static_cast<int>(i));
+  }
+
+  std::make_heap(heap_.begin(), heap_.end(), [this](int a, int b) {
+    return comparator_(runs_[a]->current(), runs_[b]->current()) > 0;
+  });
+  LOG_INFO("external sort begin to merge. items=%ld, runs=%d", count_, run_num());
+  return RC::SUCCESS;
+}
+
+RC ExternalSorter::next(const char *&item)
+{
+  if (!finished_) {
+    return RC::INTERNAL;
+  }
+
+  if (runs_.empty()) {
+    if (sorted_pos_ >= sorted_.size()) {
+      return RC::RECORD_EOF;
+    }
+    item = sorted_[sorted_pos_++];
+    return RC::SUCCESS;
+  }
+
+  auto greater = [this](int a, int b) { return comparator_(runs_[a]->current(), runs_[b]->current()) > 0; };
+
+  // 上一次返回的数据还在 run 的缓存中，所以在这里才把它从堆中弹出
+  if (sorted_pos_ > 0 && !heap_.empty()) {
+    std::pop_heap(heap_.begin(), heap_.end(), greater);
+    Run &run = *runs_[heap_.back()];
+    run.pos++;
+    if (run.pos >= run.size && run.remain > 0) {
+      RC rc = fill(run);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+    if (run.pos < run.size) {
+      std::push_heap(heap_.begin(), heap_.end(), greater);
+    } else {
+      heap_.pop_back();
+    }
+  }
+
+  if (heap_.empty()) {
+    return RC::RECORD_EOF;
+  }
+
+  sorted_pos_++;
+  item = runs_[heap_.front()]->current();
+  return RC::SUCCESS;
+}
@@ -0,0 +1,112 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/fstream.h"
+#include "common/lang/functional.h"
+#include "common/lang/memory.h"
+#include "common/lang/string.h"
+#include "common/lang/vector.h"
+#include "common/sys/rc.h"
+
+/**
+ * @brief 定长数据的外部排序
+ * @details 数据先攒在内存中，超过内存预算时把这一批数据排好序写到一个临时文件中（称为一个 run），
+ * 所有数据都添加完成后，对所有的 run 做多路归并。如果数据量没有超过内存预算，就不会写临时文件。
+ * 使用方法：
+ * @code
+ * ExternalSorter sorter(item_size, comparator, memory_budget, temp_file_prefix);
+ * sorter.add(item); ...
+ * sorter.finish();
+ * while (OB_SUCC(rc = sorter.next(item))) { ... }
+ * @endcode
+ */
+class ExternalSorter
+{
+public:
+  /// 比较两条数据，返回值与 memcmp 一致
+  using Comparator = function<int(const char *, const char *)>;
+
+  /**
+   * @param item_size 每条数据的长度
+   * @param comparator 比较函数
+   * @param memory_budget 内存预算（字节），包括排序与归并时使用的缓存
+   * @param temp_file_prefix 临时文件的路径前缀，临时文件名为 prefix.<run 编号>
+   */
+  ExternalSorter(int item_size, Comparator comparator, size_t memory_budget, string temp_file_prefix);
+  ~ExternalSorter();
+
+  /**
+   * @brief 添加一条数据
+   */
+  RC add(const char *item);
+
+  /**
+   * @brief 所有数据添加完成，准备输出排序结果
+   */
+  RC finish();
+
+  /**
+   * @brief 按顺序返回下一条数据
+   * @details 返回的指针在下一次调用 next 之前有效
+   * @return 没有更多数据时返回 RECORD_EOF
+   */
+  RC next(const char *&item);
+
+  /// 添加的数据总数
+  int64_t count() const { return count_; }
+  /// 写到磁盘上的 run 个数
+  int run_num() const { return static_cast<int>(runs_.size()); }
+
+private:
+  /// 磁盘上的一个有序片段，归并时每个 run 都有一块读缓存
+  struct Run
+  {
+    string       file_name;
+    ifstream     stream;
+    int64_t      remain = 0;  ///< 文件中还没有读到缓存的数据条数
+    vector<char> buffer;
+    int          item_size = 0;
+    int          size      = 0;  ///< 缓存中的数据条数
+    int          pos       = 0;  ///< 缓存中的下一条数据
+
+    const char *current() const { return buffer.data() + static_cast<size_t>(pos) * item_size; }
+  };
+
+  /**
+   * @brief 对内存中的数据排序，结果保存在 sorted_ 中
+   */
+  void sort_buffer();
+
+  /**
+   * @brief 把内存中的数据排序后写到一个新的 run 文件
+   */
+  RC spill();
+
+  /**
+   * @brief 从磁盘上的 run 读取下一批数据到缓存中
+   */
+  RC fill(Run &run);
+
+  int        item_size_ = 0;
+  Comparator comparator_;
+  size_t     memory_budget_ = 0;
+  string     temp_file_prefix_;
+
+  int64_t              count_    = 0;
+  bool                 finished_ = false;
+  vector<char>         buffer_;  ///< 内存中还没有写到磁盘的数据
+  vector<const char *> sorted_;  ///< 排好序的 buffer_ 中的数据
+  size_t               sorted_pos_ = 0;
+
+  vector<unique_ptr<Run>> runs_;
+  vector<int>             heap_;  ///< 归并时使用的小顶堆，保存 run 的下标
+};
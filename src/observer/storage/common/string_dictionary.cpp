@@ -0,0 +1,39 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/common/string_dictionary.h"
+
+#include <cstring>
+
+int32_t StringDictionary::add(const char *data, int len)
+{
+  auto iter = codes_.find(string_view(data, len));
+  if (iter != codes_.end()) {
+    return iter->second;
+  }
+
+  // 空字符串不需要申请内存
+  char *copy = const_cast<char *>("");
+  if (len > 0) {
+    copy = arena_.Allocate(len);
+    memcpy(copy, data, len);
+  }
+
+  const int32_t code = size();
+  entries_.emplace_back(copy, len);
+  codes_.emplace(entries_.back(), code);
+  return code;
+}
+
+int32_t StringDictionary::find(const char *data, int len) const
+{
+  auto iter = codes_.find(string_view(data, len));
+  return iter == codes_.end() ? -1 : iter->second;
+}
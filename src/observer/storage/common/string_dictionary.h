@@ -0,0 +1,50 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/string_view.h"
+#include "common/lang/unordered_map.h"
+#include "common/lang/vector.h"
+#include "storage/common/arena_allocator.h"
+
+/**
+ * @brief 字符串字典，把字符串映射成从0开始连续的整数编号
+ * @details 字典编码的列（Column::Type::DICTIONARY_COLUMN）中保存的是编号，相同的字符串编号相同，
+ * 等值比较、哈希和分组都可以直接使用编号。字典只会增加不会删除，已经分配的编号一直有效。
+ * 不支持并发访问。
+ */
+class StringDictionary
+{
+public:
+  StringDictionary() = default;
+
+  StringDictionary(const StringDictionary &)            = delete;
+  StringDictionary &operator=(const StringDictionary &) = delete;
+
+  /**
+   * @brief 返回字符串的编号，字典中没有这个字符串时添加进去
+   */
+  int32_t add(const char *data, int len);
+
+  /**
+   * @brief 返回字符串的编号，字典中没有这个字符串时返回 -1
+   */
+  int32_t find(const char *data, int len) const;
+
+  string_view get(int32_t code) const { return entries_[code]; }
+
+  int32_t size() const { return static_cast<int32_t>(entries_.size()); }
+
+private:
+  Arena                               arena_;    ///< 字符串的内存
+  vector<string_view>                 entries_;  ///< 按编号保存的字符串
+  unordered_map<string_view, int32_t> codes_;
+};
@@ -14,6 +14,8 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "storage/index/bplus_tree.h"
+#include "common/lang/atomic.h"
+#include "common/lang/limits.h"
 #include "common/lang/lower_bound.h"
 #include "common/log/log.h"
 #include "common/global_context.h"
@@ -800,6 +802,18 @@ RC BplusTreeHandler::create(LogHandler &log_handler,
                             int attr_length, 
                             int internal_max_size /* = -1*/,
                             int leaf_max_size /* = -1 */)
+{
+  return this->create(log_handler, bpm, file_name, vector<AttrType>{attr_type}, vector<int>{attr_length},
+      internal_max_size, leaf_max_size);
+}
+
+RC BplusTreeHandler::create(LogHandler &log_handler,
+                            BufferPoolManager &bpm,
+                            const char *file_name,
+                            const vector<AttrType> &attr_types,
+                            const vector<int> &attr_lengths,
+                            int internal_max_size /* = -1*/,
+                            int leaf_max_size /* = -1 */)
 {
   RC rc = bpm.create_file(file_name);
   if (OB_FAIL(rc)) {
@@ -817,7 +831,7 @@ RC BplusTreeHandler::create(LogHandler &log_handler,
   }
   LOG_INFO("Successfully open index file %s.", file_name);
 
-  rc = this->create(log_handler, *bp, attr_type, attr_length, internal_max_size, leaf_max_size);
+  rc = this->create(log_handler, *bp, attr_types, attr_lengths, internal_max_size, leaf_max_size);
   if (OB_FAIL(rc)) {
     bpm.close_file(file_name);
     return rc;
@@ -834,6 +848,28 @@ RC BplusTreeHandler::create(LogHandler &log_handler,
             int internal_max_size /* = -1 */,
             int leaf_max_size /* = -1 */)
 {
+  return this->create(
+      log_handler, buffer_pool, vector<AttrType>{attr_type}, vector<int>{attr_length}, internal_max_size, leaf_max_size);
+}
+
+RC BplusTreeHandler::create(LogHandler &log_handler,
+            DiskBufferPool &buffer_pool,
+            const vector<AttrType> &attr_types,
+            const vector<int> &attr_lengths,
+            int internal_max_size /* = -1 */,
+            int leaf_max_size /* = -1 */)
+{
+  const int attr_num = static_cast<int>(attr_types.size());
+  if (attr_num <= 0 || attr_num > IndexFileHeader::MAX_ATTR_NUM || attr_lengths.size() != attr_types.size()) {
+    LOG_WARN("invalid attributes of bplus tree. attr num=%d", attr_num);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  int attr_length = 0;
+  for (int length : attr_lengths) {
+    attr_length += length;
+  }
+
   if (internal_max_size < 0) {
     internal_max_size = calc_internal_page_capacity(attr_length);
   }
@@ -866,7 +902,12 @@ RC BplusTreeHandler::create(LogHandler &log_handler,
   IndexFileHeader *file_header   = (IndexFileHeader *)pdata;
   file_header->attr_length       = attr_length;
   file_header->key_length        = attr_length + sizeof(RID);
-  file_header->attr_type         = attr_type;
+  file_header->attr_type         = attr_types[0];
+  file_header->attr_num          = attr_num;
+  for (int i = 0; i < attr_num; i++) {
+    file_header->attr_types[i]   = attr_types[i];
+    file_header->attr_lengths[i] = attr_lengths[i];
+  }
   file_header->internal_max_size = internal_max_size;
   file_header->leaf_max_size     = leaf_max_size;
   file_header->root_page         = BP_INVALID_PAGE_NUM;
@@ -886,8 +927,7 @@ RC BplusTreeHandler::create(LogHandler &log_handler,
     return RC::NOMEM;
   }
 
-  key_comparator_.init(file_header->attr_type, file_header->attr_length);
-  key_printer_.init(file_header->attr_type, file_header->attr_length);
+  init_key_comparator();
 
   /*
   虽然我们针对B+树记录了WAL，但是我们记录的都是逻辑日志，并没有记录某个页面如何修改的物理日志。
@@ -958,8 +998,7 @@ RC BplusTreeHandler::open(LogHandler &log_handler, DiskBufferPool &buffer_pool)
   // close old page_handle
   buffer_pool.unpin_page(frame);
 
-  key_comparator_.init(file_header_.attr_type, file_header_.attr_length);
-  key_printer_.init(file_header_.attr_type, file_header_.attr_length);
+  init_key_comparator();
   LOG_INFO("Successfully open index");
   return RC::SUCCESS;
 }
@@ -1202,6 +1241,14 @@ RC BplusTreeHandler::left_most_page(BplusTreeMiniTransaction &mtr, Frame *&frame
 RC BplusTreeHandler::find_leaf_internal(BplusTreeMiniTransaction &mtr, BplusTreeOperationType op,
     const function<PageNum(InternalIndexNodeHandler &)> &child_page_getter, Frame *&frame)
 {
+  if (optimistic_latch_) {
+    RC rc = optimistic_find_leaf(mtr, op, child_page_getter, frame);
+    if (rc != RC::LOCKED_NEED_WAIT) {
+      return rc;
+    }
+    LOG_TRACE("failed to find leaf optimistically, fall back to crabing protocol. op=%d", static_cast<int>(op));
+  }
+
   LatchMemo &latch_memo = mtr.latch_memo();
 
   // root locked
@@ -1237,6 +1284,110 @@ RC BplusTreeHandler::find_leaf_internal(BplusTreeMiniTransaction &mtr, BplusTree
   return RC::SUCCESS;
 }
 
+RC BplusTreeHandler::optimistic_find_leaf(BplusTreeMiniTransaction &mtr, BplusTreeOperationType op,
+    const function<PageNum(InternalIndexNodeHandler &)> &child_page_getter, Frame *&frame)
+{
+  LatchMemo          &latch_memo = mtr.latch_memo();
+  const LatchMemoType latch_type =
+      (op == BplusTreeOperationType::READ) ? LatchMemoType::SHARED : LatchMemoType::EXCLUSIVE;
+
+  // 不加 root_lock_，根节点的页号可能随时被修改
+  atomic_ref<PageNum> root_page(file_header_.root_page);
+
+  for (int i = 0; i < OPTIMISTIC_RETRY_TIMES; i++) {
+    latch_memo.release();  // 上一次冲突时留下的 pin
+
+    const PageNum root_page_num = root_page.load(memory_order_acquire);
+    if (root_page_num == BP_INVALID_PAGE_NUM) {
+      return RC::EMPTY;
+    }
+
+    RC rc = latch_memo.get_page(root_page_num, frame);
+    if (OB_FAIL(rc)) {
+      if (root_page.load(memory_order_acquire) != root_page_num) {
+        continue;  // 读到页号之后，根节点被释放了
+      }
+      LOG_WARN("failed to fetch root page. page id=%d, rc=%d:%s", root_page_num, rc, strrc(rc));
+      return rc;
+    }
+
+    uint64_t version = frame->read_version();
+    if ((version & 1) != 0 || root_page.load(memory_order_acquire) != root_page_num) {
+      continue;
+    }
+
+    Frame   *parent_frame   = nullptr;
+    uint64_t parent_version = 0;
+    bool     conflict       = false;
+    while (true) {
+      const bool is_leaf = reinterpret_cast<IndexNode *>(frame->data())->is_leaf;
+      if (!frame->validate_version(version)) {
+        conflict = true;
+        break;
+      }
+      if (is_leaf) {
+        break;
+      }
+
+      InternalIndexNodeHandler internal_node(mtr, file_header_, frame);
+      const PageNum            child_page_num = child_page_getter(internal_node);
+      if (!frame->validate_version(version)) {
+        conflict = true;
+        break;
+      }
+
+      Frame *child_frame = nullptr;
+      rc                 = latch_memo.get_page(child_page_num, child_frame);
+      if (OB_FAIL(rc)) {
+        if (!frame->validate_version(version)) {
+          conflict = true;  // 子节点在合并时被释放了
+          break;
+        }
+        LOG_WARN("Failed to load page page_num:%d. rc=%s", child_page_num, strrc(rc));
+        return rc;
+      }
+
+      // 读取子节点的版本号时父节点没有变化，说明这个子节点还挂在父节点下面
+      const uint64_t child_version = child_frame->read_version();
+      if ((child_version & 1) != 0 || !frame->validate_version(version)) {
+        conflict = true;
+        break;
+      }
+
+      parent_frame   = frame;
+      parent_version = version;
+      frame          = child_frame;
+      version        = child_version;
+    }
+    if (conflict) {
+      continue;
+    }
+
+    // 叶子节点加锁以后，父节点没有变化（或者它仍然是根节点），说明叶子节点没有被分裂或合并
+    const int leaf_memo_point = latch_memo.memo_point() - 1;
+    latch_memo.latch(frame, latch_type);
+    const bool valid = (parent_frame != nullptr) ? parent_frame->validate_version(parent_version)
+                                                 : root_page.load(memory_order_acquire) == frame->page_num();
+    if (!valid) {
+      continue;
+    }
+
+    if (op != BplusTreeOperationType::READ) {
+      IndexNodeHandler leaf_node(mtr, file_header_, frame);
+      if (!leaf_node.is_safe(op, parent_frame == nullptr /*is_root_node*/)) {
+        latch_memo.release();
+        return RC::LOCKED_NEED_WAIT;
+      }
+    }
+
+    latch_memo.release_to(leaf_memo_point);  // 只保留叶子节点的 pin 和锁
+    return RC::SUCCESS;
+  }
+
+  latch_memo.release();
+  return RC::LOCKED_NEED_WAIT;
+}
+
 RC BplusTreeHandler::crabing_protocal_fetch_page(
     BplusTreeMiniTransaction &mtr, BplusTreeOperationType op, PageNum page_num, bool is_root_node, Frame *&frame)
 {
@@ -1437,8 +1588,7 @@ RC BplusTreeHandler::recover_init_header_page(BplusTreeMiniTransaction &mtr, Fra
   header_dirty_ = false;
   frame->mark_dirty();
 
-  key_comparator_.init(file_header_.attr_type, file_header_.attr_length);
-  key_printer_.init(file_header_.attr_type, file_header_.attr_length);
+  init_key_comparator();
 
   return RC::SUCCESS;
 }
@@ -1451,7 +1601,8 @@ void BplusTreeHandler::update_root_page_num_locked(BplusTreeMiniTransaction &mtr
   IndexFileHeader *file_header = reinterpret_cast<IndexFileHeader *>(frame->data());
   mtr.logger().update_root_page(frame, root_page_num, file_header->root_page);
   file_header->root_page = root_page_num;
-  file_header_.root_page = root_page_num;
+  // 乐观查找叶子节点时不加 root_lock_ 读取根节点的页号
+  atomic_ref<PageNum>(file_header_.root_page).store(root_page_num, memory_order_release);
   header_dirty_          = true;
   frame->mark_dirty();
   LOG_DEBUG("set root page to %d", root_page_num);
@@ -1496,6 +1647,17 @@ MemPoolItem::item_unique_ptr BplusTreeHandler::make_key(const char *user_key, co
   return key;
 }
 
+void BplusTreeHandler::init_key_comparator()
+{
+  if (file_header_.is_multi_attr()) {
+    key_comparator_.init(file_header_.attr_num, file_header_.attr_types, file_header_.attr_lengths);
+    key_printer_.init(file_header_.attr_num, file_header_.attr_types, file_header_.attr_lengths);
+  } else {
+    key_comparator_.init(file_header_.attr_type, file_header_.attr_length);
+    key_printer_.init(file_header_.attr_type, file_header_.attr_length);
+  }
+}
+
 RC BplusTreeHandler::insert_entry(const char *user_key, const RID *rid)
 {
   if (user_key == nullptr || rid == nullptr) {
@@ -1543,6 +1705,242 @@ RC BplusTreeHandler::insert_entry(const char *user_key, const RID *rid)
   return RC::SUCCESS;
 }
 
+/**
+ * @brief 自底向上批量构建B+树
+ * @ingroup BPlusTree
+ * @details 每一层有多少个元素、多少个节点在开始构建前就已经确定了，元素平均分配到这一层的每个节点上，
+ * 所以每个节点的元素个数都在 [min_size, max_size] 之间。
+ * 内部节点的页面提前分配好，这样写子节点时就知道父节点的页面编号了。叶子节点一边填充一边写出，
+ * 任何时候每一层只有一个节点在内存中。
+ */
+class BplusTreeBulkLoader
+{
+public:
+  BplusTreeBulkLoader(BplusTreeHandler &tree_handler, int fill_factor)
+      : tree_handler_(tree_handler), header_(tree_handler.file_header_), fill_factor_(fill_factor)
+  {}
+
+  RC load(int64_t count, const function<RC(const char *&key)> &next_key);
+
+private:
+  /// 某一层节点的构建状态
+  struct Level
+  {
+    bool    is_leaf    = false;
+    int     item_size  = 0;
+    int64_t item_num   = 0;  ///< 这一层一共有多少个元素
+    int64_t node_num   = 0;  ///< 这一层一共有多少个节点
+    int64_t node_index = 0;  ///< 当前正在填充的节点
+    int     filled     = 0;  ///< 当前节点已经填充的元素个数
+
+    vector<PageNum> pages;                           ///< 预先分配的内部节点页面
+    PageNum         page_num = BP_INVALID_PAGE_NUM;  ///< 当前节点的页面
+    vector<char>    image;                           ///< 当前节点的内容
+    vector<char>    first_key;                       ///< 当前节点子树中最小的键值
+
+    int node_size() const { return static_cast<int>(item_num / node_num + (node_index < item_num % node_num ? 1 : 0)); }
+  };
+
+  /**
+   * @brief 计算一层需要多少个节点
+   * @details 节点按照填充因子填充，但是不能少于 min_size，否则后续删除数据时很快就会触发合并
+   */
+  int64_t node_num(int64_t item_num, int max_size) const;
+
+  RC allocate_page(PageNum &page_num);
+
+  /**
+   * @brief 向第 level 层的当前节点追加一个元素，节点填满后写出，并把它追加到上一层
+   */
+  RC append(size_t level, const char *key, const char *value);
+
+  /**
+   * @brief 把第 level 层当前节点的内容写到页面上，并记录页面镜像日志
+   */
+  RC write_node(size_t level);
+
+private:
+  BplusTreeHandler      &tree_handler_;
+  const IndexFileHeader &header_;
+  int                    fill_factor_ = 100;
+  vector<Level>          levels_;
+};
+
+int64_t BplusTreeBulkLoader::node_num(int64_t item_num, int max_size) const
+{
+  const int min_size = max(2, max_size - max_size / 2);
+  const int per_node = max(min_size, min(max_size * fill_factor_ / 100, max_size));
+
+  const int64_t node_num = (item_num + per_node - 1) / per_node;
+  return max<int64_t>(1, min(node_num, item_num / min_size));
+}
+
+RC BplusTreeBulkLoader::allocate_page(PageNum &page_num)
+{
+  DiskBufferPool &buffer_pool = tree_handler_.buffer_pool();
+
+  Frame *frame = nullptr;
+  RC     rc    = buffer_pool.allocate_page(&frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to allocate page while bulk loading. rc=%s", strrc(rc));
+    return rc;
+  }
+  page_num = frame->page_num();
+  buffer_pool.unpin_page(frame);
+  return rc;
+}
+
+RC BplusTreeBulkLoader::load(int64_t count, const function<RC(const char *&key)> &next_key)
+{
+  // 先确定每一层的节点个数。最上面一层只有一个节点，就是根节点
+  int64_t item_num = count;
+  while (levels_.empty() || levels_.back().node_num > 1) {
+    Level level;
+    level.is_leaf   = levels_.empty();
+    level.item_size = header_.key_length + (level.is_leaf ? sizeof(RID) : sizeof(PageNum));
+    level.item_num  = item_num;
+    level.node_num  = node_num(item_num, level.is_leaf ? header_.leaf_max_size : header_.internal_max_size);
+    level.image.resize(BP_PAGE_DATA_SIZE);
+    level.first_key.resize(header_.key_length);
+    levels_.push_back(std::move(level));
+    item_num = levels_.back().node_num;
+  }
+
+  RC rc = RC::SUCCESS;
+  for (size_t i = 1; i < levels_.size(); i++) {
+    Level &level = levels_[i];
+    level.pages.resize(level.node_num);
+    for (PageNum &page_num : level.pages) {
+      if (OB_FAIL(rc = allocate_page(page_num))) {
+        return rc;
+      }
+    }
+    level.page_num = level.pages[0];
+  }
+  if (OB_FAIL(rc = allocate_page(levels_[0].page_num))) {
+    return rc;
+  }
+
+  for (int64_t i = 0; i < count; i++) {
+    const char *key = nullptr;
+    if (OB_FAIL(rc = next_key(key))) {
+      LOG_WARN("failed to get next key while bulk loading. loaded=%ld, count=%ld, rc=%s", i, count, strrc(rc));
+      return rc == RC::RECORD_EOF ? RC::INTERNAL : rc;
+    }
+    if (OB_FAIL(rc = append(0, key, key + header_.attr_length))) {
+      return rc;
+    }
+  }
+
+  LOG_INFO("bulk load bplus tree done. count=%ld, height=%d, leaves=%ld, root page=%d",
+           count, static_cast<int>(levels_.size()), levels_[0].node_num, header_.root_page);
+  return rc;
+}
+
+RC BplusTreeBulkLoader::append(size_t level_index, const char *key, const char *value)
+{
+  Level &level = levels_[level_index];
+  if (level.node_index >= level.node_num) {
+    LOG_WARN("too many items while bulk loading. level=%d", static_cast<int>(level_index));
+    return RC::INTERNAL;
+  }
+
+  char *item = level.image.data() + (level.is_leaf ? LeafIndexNode::HEADER_SIZE : InternalIndexNode::HEADER_SIZE) +
+               static_cast<size_t>(level.filled) * level.item_size;
+  if (level.filled == 0) {
+    memcpy(level.first_key.data(), key, header_.key_length);
+  }
+  // 内部节点的第一个键值在查找时不会用到，但是与兄弟节点合并时会当作分隔键移动到兄弟节点上，所以也要填上
+  memcpy(item, key, header_.key_length);
+  memcpy(item + header_.key_length, value, level.item_size - header_.key_length);
+  level.filled++;
+
+  if (level.filled < level.node_size()) {
+    return RC::SUCCESS;
+  }
+
+  RC rc = write_node(level_index);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  if (level_index + 1 < levels_.size()) {
+    const PageNum page_num = level.page_num;
+    rc = append(level_index + 1, level.first_key.data(), reinterpret_cast<const char *>(&page_num));
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  level.node_index++;
+  level.filled = 0;
+  if (level.is_leaf) {
+    level.page_num = reinterpret_cast<LeafIndexNode *>(level.image.data())->next_brother;
+  } else if (level.node_index < level.node_num) {
+    level.page_num = level.pages[level.node_index];
+  }
+  return rc;
+}
+
+RC BplusTreeBulkLoader::write_node(size_t level_index)
+{
+  Level     &level   = levels_[level_index];
+  const bool is_root = level_index + 1 == levels_.size();
+
+  RC rc = RC::SUCCESS;
+
+  IndexNode *node = reinterpret_cast<IndexNode *>(level.image.data());
+  node->is_leaf   = level.is_leaf;
+  node->key_num   = level.filled;
+  node->parent    = is_root ? BP_INVALID_PAGE_NUM : levels_[level_index + 1].page_num;
+  int header_size = InternalIndexNode::HEADER_SIZE;
+  if (level.is_leaf) {
+    // 下一个叶子节点的页面在这里分配，因为当前节点要记录它的页面编号
+    PageNum next_page = BP_INVALID_PAGE_NUM;
+    if (level.node_index + 1 < level.node_num && OB_FAIL(rc = allocate_page(next_page))) {
+      return rc;
+    }
+    reinterpret_cast<LeafIndexNode *>(node)->next_brother = next_page;
+    header_size = LeafIndexNode::HEADER_SIZE;
+  }
+
+  BplusTreeMiniTransaction mtr(tree_handler_, &rc);
+
+  Frame *frame = nullptr;
+  if (OB_FAIL(rc = mtr.latch_memo().get_page(level.page_num, frame))) {
+    LOG_WARN("failed to get page while bulk loading. page num=%d, rc=%s", level.page_num, strrc(rc));
+    return rc;
+  }
+
+  span<const char> image(level.image.data(), header_size + static_cast<size_t>(level.filled) * level.item_size);
+  if (OB_FAIL(rc = mtr.logger().page_image(frame, image))) {
+    LOG_WARN("failed to log page image. page num=%d, rc=%s", level.page_num, strrc(rc));
+    return rc;
+  }
+  memcpy(frame->data(), image.data(), image.size());
+  frame->mark_dirty();
+
+  if (is_root) {
+    mtr.latch_memo().xlatch(&tree_handler_.root_lock_);
+    tree_handler_.update_root_page_num_locked(mtr, level.page_num);
+  }
+  return rc;
+}
+
+RC BplusTreeHandler::bulk_load(int64_t count, const function<RC(const char *&key)> &next_key, int fill_factor)
+{
+  if (!is_empty()) {
+    LOG_WARN("cannot bulk load a non-empty tree. root page=%d", file_header_.root_page);
+    return RC::INTERNAL;
+  }
+  if (count <= 0) {
+    return RC::SUCCESS;
+  }
+
+  BplusTreeBulkLoader loader(*this, fill_factor);
+  return loader.load(count, next_key);
+}
+
 RC BplusTreeHandler::get_entry(const char *user_key, int key_len, list<RID> &rids)
 {
   BplusTreeScanner scanner(*this);
@@ -1566,6 +1964,155 @@ RC BplusTreeHandler::get_entry(const char *user_key, int key_len, list<RID> &rid
   return rc;
 }
 
+RC BplusTreeHandler::get_entries(const char *user_keys, int key_num, vector<RID> &rids, vector<int> *offsets)
+{
+  rids.clear();
+  if (offsets != nullptr) {
+    offsets->clear();
+    offsets->reserve(key_num + 1);
+  }
+
+  MemPoolItem::item_unique_ptr pkey = mem_pool_item_->alloc_unique_ptr();
+  if (nullptr == pkey) {
+    LOG_WARN("Failed to alloc memory for key. size=%d", file_header_.key_length);
+    return RC::NOMEM;
+  }
+  char *key = static_cast<char *>(pkey.get());
+
+  const int             attr_length     = file_header_.attr_length;
+  const AttrComparator &attr_comparator = key_comparator_.attr_comparator();
+
+  BplusTreeMiniTransaction mtr(*this);
+  LatchMemo               &latch_memo = mtr.latch_memo();
+
+  Frame *frame = nullptr;  // 当前加着读锁的叶子节点
+  int    index = 0;        // 当前叶子节点中下一个要看的位置
+
+  // 从根节点查找 key 所在的叶子节点
+  auto descend = [&]() -> RC {
+    latch_memo.release();
+    frame = nullptr;
+    RC rc = find_leaf(mtr, BplusTreeOperationType::READ, key, frame);
+    if (OB_SUCC(rc)) {
+      LeafIndexNodeHandler leaf_node(mtr, file_header_, frame);
+      index = leaf_node.lookup(key_comparator_, key);
+    }
+    return rc;
+  };
+
+  // 移动到右边的兄弟节点。与 BplusTreeScanner::next_entry 一样，只能尝试加锁，否则可能与修改操作死锁
+  auto move_to_next = [&](PageNum next_page_num) -> bool {
+    const int memo_point = latch_memo.memo_point();
+    Frame    *next_frame = nullptr;
+    if (OB_FAIL(latch_memo.get_page(next_page_num, next_frame)) || !latch_memo.try_slatch(next_frame)) {
+      return false;
+    }
+    latch_memo.release_to(memo_point);
+    frame = next_frame;
+    index = 0;
+    return true;
+  };
+
+  auto after_leaf = [&](LeafIndexNodeHandler &leaf_node, const char *user_key) {
+    return leaf_node.size() == 0 || attr_comparator(user_key, leaf_node.key_at(leaf_node.size() - 1)) > 0;
+  };
+
+  RC  rc         = RC::SUCCESS;
+  int prev_begin = 0;  // 前一个不同键值的结果在 rids 中的范围
+  int prev_end   = 0;
+  for (int i = 0; i < key_num; i++) {
+    const char *user_key = user_keys + static_cast<size_t>(i) * attr_length;
+    const int   begin    = static_cast<int>(rids.size());
+    if (offsets != nullptr) {
+      offsets->push_back(begin);
+    }
+
+    const int order = (i > 0) ? attr_comparator(user_key, user_key - attr_length) : 1;
+    if (order == 0) {  // 与前一个键值相同，复用前一个键值的结果
+      for (int j = prev_begin; j < prev_end; j++) {
+        rids.push_back(rids[j]);
+      }
+      continue;
+    }
+    prev_begin = begin;
+
+    memcpy(key, user_key, attr_length);
+    memcpy(key + attr_length, RID::min(), sizeof(RID));
+
+    // 键值是递增的时候，先在当前叶子节点和它右边的兄弟节点中找
+    bool positioned = false;
+    if (frame != nullptr && order > 0) {
+      LeafIndexNodeHandler leaf_node(mtr, file_header_, frame);
+      if (!after_leaf(leaf_node, user_key)) {
+        index      = leaf_node.lookup(key_comparator_, key);
+        positioned = true;
+      } else if (leaf_node.next_page() == BP_INVALID_PAGE_NUM) {
+        index      = leaf_node.size();  // 已经是最后一个叶子节点，没有更大的键值了
+        positioned = true;
+      } else if (move_to_next(leaf_node.next_page())) {
+        LeafIndexNodeHandler next_node(mtr, file_header_, frame);
+        if (!after_leaf(next_node, user_key)) {
+          index      = next_node.lookup(key_comparator_, key);
+          positioned = true;
+        }
+      }
+    }
+
+    if (!positioned) {
+      rc = descend();
+      if (rc == RC::EMPTY) {
+        rc = RC::SUCCESS;
+        break;
+      } else if (OB_FAIL(rc)) {
+        LOG_WARN("failed to find leaf. rc=%s", strrc(rc));
+        return rc;
+      }
+    }
+
+    // 相同键值的条目可能跨越多个叶子节点
+    while (true) {
+      LeafIndexNodeHandler leaf_node(mtr, file_header_, frame);
+      for (; index < leaf_node.size() && attr_comparator(leaf_node.key_at(index), user_key) == 0; index++) {
+        RID rid;
+        memcpy(&rid, leaf_node.value_at(index), sizeof(rid));
+        rids.push_back(rid);
+      }
+      if (index < leaf_node.size() || leaf_node.next_page() == BP_INVALID_PAGE_NUM) {
+        break;
+      }
+
+      if (move_to_next(leaf_node.next_page())) {
+        continue;
+      }
+
+      // 兄弟节点正在被修改，从最后一个找到的条目之后重新查找
+      if (static_cast<int>(rids.size()) > begin) {
+        memcpy(key + attr_length, &rids.back(), sizeof(RID));
+      }
+      rc = descend();
+      if (rc == RC::EMPTY) {
+        rc = RC::SUCCESS;
+        break;
+      } else if (OB_FAIL(rc)) {
+        LOG_WARN("failed to find leaf. rc=%s", strrc(rc));
+        return rc;
+      }
+      LeafIndexNodeHandler resumed_node(mtr, file_header_, frame);
+      if (static_cast<int>(rids.size()) > begin && index < resumed_node.size() &&
+          key_comparator_(resumed_node.key_at(index), key) == 0) {
+        index++;
+      }
+    }
+    prev_end = static_cast<int>(rids.size());
+  }
+
+  if (offsets != nullptr) {
+    // 树是空的时候提前结束了，剩下的键值都没有对应的 RID
+    offsets->resize(key_num + 1, static_cast<int>(rids.size()));
+  }
+  return rc;
+}
+
 RC BplusTreeHandler::adjust_root(BplusTreeMiniTransaction &mtr, Frame *root_frame)
 {
   LatchMemo &latch_memo = mtr.latch_memo();
@@ -1840,6 +2387,23 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
 
   LatchMemo &latch_memo = mtr_.latch_memo();
 
+  // 多字段索引只给出了前缀字段时，没有给出的字段按照边界的开闭填充为最小值或最大值，
+  // 比如 a=1 and b>5 的左边界是 (1,5,+max) 并且不包含，右边界是 (1,+max) 包含
+  const IndexFileHeader &file_header = tree_handler_.file_header_;
+  vector<char>           left_prefix_key;
+  vector<char>           right_prefix_key;
+  if (file_header.is_multi_attr()) {
+    if (left_user_key != nullptr && left_len < file_header.attr_length) {
+      fill_prefix_key(left_user_key, left_len, !left_inclusive /*fill_max*/, left_prefix_key);
+      left_user_key = left_prefix_key.data();
+    }
+    if (right_user_key != nullptr && right_len < file_header.attr_length) {
+      fill_prefix_key(right_user_key, right_len, right_inclusive /*fill_max*/, right_prefix_key);
+      right_user_key = right_prefix_key.data();
+    }
+  }
+  const bool fix_chars_key = !file_header.is_multi_attr() && file_header.attr_type == AttrType::CHARS;
+
   // 校验输入的键值是否是合法范围
   if (left_user_key && right_user_key) {
     const auto &attr_comparator = tree_handler_.key_comparator_.attr_comparator();
@@ -1867,7 +2431,7 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
   } else {
 
     char *fixed_left_key = const_cast<char *>(left_user_key);
-    if (tree_handler_.file_header_.attr_type == AttrType::CHARS) {
+    if (fix_chars_key) {
       bool should_inclusive_after_fix = false;
       rc = fix_user_key(left_user_key, left_len, true /*greater*/, &fixed_left_key, &should_inclusive_after_fix);
       if (OB_FAIL(rc)) {
@@ -1934,7 +2498,7 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
 
     char *fixed_right_key          = const_cast<char *>(right_user_key);
     bool  should_include_after_fix = false;
-    if (tree_handler_.file_header_.attr_type == AttrType::CHARS) {
+    if (fix_chars_key) {
       rc = fix_user_key(right_user_key, right_len, false /*want_greater*/, &fixed_right_key, &should_include_after_fix);
       if (OB_FAIL(rc)) {
         LOG_WARN("failed to fix right user key. rc=%s", strrc(rc));
@@ -2037,6 +2601,16 @@ RC BplusTreeScanner::next_entry(RID &rid)
   return next_entry(rid);
 }
 
+RC BplusTreeScanner::next_entry(RID &rid, const char *&user_key)
+{
+  RC rc = next_entry(rid);
+  if (OB_SUCC(rc)) {
+    LeafIndexNodeHandler node(mtr_, tree_handler_.file_header_, current_frame_);
+    user_key = node.key_at(iter_index_);
+  }
+  return rc;
+}
+
 RC BplusTreeScanner::close()
 {
   inited_ = false;
@@ -2094,3 +2668,35 @@ RC BplusTreeScanner::fix_user_key(
   *fixed_key = key_buf;
   return RC::SUCCESS;
 }
+
+void BplusTreeScanner::fill_prefix_key(const char *user_key, int key_len, bool fill_max, vector<char> &key) const
+{
+  const IndexFileHeader &file_header = tree_handler_.file_header_;
+  key.assign(file_header.attr_length, 0);
+
+  int offset = 0;
+  for (int i = 0; i < file_header.attr_num; i++) {
+    const int length = file_header.attr_lengths[i];
+    char     *data   = key.data() + offset;
+    if (offset + length <= key_len) {
+      memcpy(data, user_key + offset, length);
+    } else {
+      switch (file_header.attr_types[i]) {
+        case AttrType::INTS:
+        case AttrType::DATES: {
+          int32_t value = fill_max ? INT32_MAX : INT32_MIN;
+          memcpy(data, &value, sizeof(value));
+        } break;
+        case AttrType::FLOATS: {
+          float value = fill_max ? numeric_limits<float>::infinity() : -numeric_limits<float>::infinity();
+          memcpy(data, &value, sizeof(value));
+        } break;
+        default: {
+          // 字符串按照字节比较，全0是最小值，全0xFF是最大值
+          memset(data, fill_max ? 0xFF : 0, length);
+        } break;
+      }
+    }
+    offset += length;
+  }
+}
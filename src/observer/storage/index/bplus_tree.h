@@ -23,6 +23,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/memory.h"
 #include "common/lang/sstream.h"
 #include "common/lang/functional.h"
+#include "common/lang/vector.h"
 #include "common/log/log.h"
 #include "sql/parser/parse_defs.h"
 #include "storage/buffer/disk_buffer_pool.h"
@@ -52,14 +53,21 @@ enum class BplusTreeOperationType
 /**
  * @brief 属性比较(BplusTree)
  * @ingroup BPlusTree
+ * @details 多字段索引的属性值由各个字段的值依次拼接而成，按照字段的顺序逐个比较
  */
 class AttrComparator
 {
 public:
-  void init(AttrType type, int length)
+  void init(AttrType type, int length) { init(1, &type, &length); }
+
+  void init(int attr_num, const AttrType attr_types[], const int attr_lengths[])
   {
-    attr_type_   = type;
-    attr_length_ = length;
+    attr_types_.assign(attr_types, attr_types + attr_num);
+    attr_lengths_.assign(attr_lengths, attr_lengths + attr_num);
+    attr_length_ = 0;
+    for (int i = 0; i < attr_num; i++) {
+      attr_length_ += attr_lengths[i];
+    }
   }
 
   int attr_length() const { return attr_length_; }
@@ -67,18 +75,27 @@ public:
   int operator()(const char *v1, const char *v2) const
   {
     // TODO: optimized the comparison
-    Value left;
-    left.set_type(attr_type_);
-    left.set_data(v1, attr_length_);
-    Value right;
-    right.set_type(attr_type_);
-    right.set_data(v2, attr_length_);
-    return DataType::type_instance(attr_type_)->compare(left, right);
+    for (size_t i = 0; i < attr_types_.size(); i++) {
+      Value left;
+      left.set_type(attr_types_[i]);
+      left.set_data(v1, attr_lengths_[i]);
+      Value right;
+      right.set_type(attr_types_[i]);
+      right.set_data(v2, attr_lengths_[i]);
+      int result = DataType::type_instance(attr_types_[i])->compare(left, right);
+      if (result != 0) {
+        return result;
+      }
+      v1 += attr_lengths_[i];
+      v2 += attr_lengths_[i];
+    }
+    return 0;
   }
 
 private:
-  AttrType attr_type_;
-  int      attr_length_;
+  vector<AttrType> attr_types_;
+  vector<int>      attr_lengths_;
+  int              attr_length_ = 0;
 };
 
 /**
@@ -90,6 +107,10 @@ class KeyComparator
 {
 public:
   void init(AttrType type, int length) { attr_comparator_.init(type, length); }
+  void init(int attr_num, const AttrType attr_types[], const int attr_lengths[])
+  {
+    attr_comparator_.init(attr_num, attr_types, attr_lengths);
+  }
 
   const AttrComparator &attr_comparator() const { return attr_comparator_; }
 
@@ -116,23 +137,38 @@ private:
 class AttrPrinter
 {
 public:
-  void init(AttrType type, int length)
+  void init(AttrType type, int length) { init(1, &type, &length); }
+
+  void init(int attr_num, const AttrType attr_types[], const int attr_lengths[])
   {
-    attr_type_   = type;
-    attr_length_ = length;
+    attr_types_.assign(attr_types, attr_types + attr_num);
+    attr_lengths_.assign(attr_lengths, attr_lengths + attr_num);
+    attr_length_ = 0;
+    for (int i = 0; i < attr_num; i++) {
+      attr_length_ += attr_lengths[i];
+    }
   }
 
   int attr_length() const { return attr_length_; }
 
   string operator()(const char *v) const
   {
-    Value value(attr_type_, const_cast<char *>(v), attr_length_);
-    return value.to_string();
+    string result;
+    for (size_t i = 0; i < attr_types_.size(); i++) {
+      if (i > 0) {
+        result += ",";
+      }
+      Value value(attr_types_[i], const_cast<char *>(v), attr_lengths_[i]);
+      result += value.to_string();
+      v += attr_lengths_[i];
+    }
+    return result;
   }
 
 private:
-  AttrType attr_type_;
-  int      attr_length_;
+  vector<AttrType> attr_types_;
+  vector<int>      attr_lengths_;
+  int              attr_length_ = 0;
 };
 
 /**
@@ -143,6 +179,10 @@ class KeyPrinter
 {
 public:
   void init(AttrType type, int length) { attr_printer_.init(type, length); }
+  void init(int attr_num, const AttrType attr_types[], const int attr_lengths[])
+  {
+    attr_printer_.init(attr_num, attr_types, attr_lengths);
+  }
 
   const AttrPrinter &attr_printer() const { return attr_printer_; }
 
@@ -164,21 +204,30 @@ private:
  * @brief the meta information of bplus tree
  * @ingroup BPlusTree
  * @details this is the first page of bplus tree.
- * only one field can be supported, can you extend it to multi-fields?
+ * 多字段索引的键值是各个字段的值依次拼接而成的，attr_length 是所有字段长度的和，
+ * attr_type 是第一个字段的类型，每个字段的类型和长度记录在 attr_types 和 attr_lengths 中。
  */
 struct IndexFileHeader
 {
+  static constexpr int MAX_ATTR_NUM = 8;  ///< 索引最多包含的字段个数
+
   IndexFileHeader()
   {
     memset(this, 0, sizeof(IndexFileHeader));
     root_page = BP_INVALID_PAGE_NUM;
   }
-  PageNum  root_page;          ///< 根节点在磁盘中的页号
-  int32_t  internal_max_size;  ///< 内部节点最大的键值对数
-  int32_t  leaf_max_size;      ///< 叶子节点最大的键值对数
-  int32_t  attr_length;        ///< 键值的长度
-  int32_t  key_length;         ///< attr length + sizeof(RID)
-  AttrType attr_type;          ///< 键值的类型
+  PageNum  root_page;                   ///< 根节点在磁盘中的页号
+  int32_t  internal_max_size;           ///< 内部节点最大的键值对数
+  int32_t  leaf_max_size;               ///< 叶子节点最大的键值对数
+  int32_t  attr_length;                 ///< 键值的长度
+  int32_t  key_length;                  ///< attr length + sizeof(RID)
+  AttrType attr_type;                   ///< 键值的类型
+  int32_t  attr_num;                    ///< 字段个数，为0时表示只有一个字段(旧版本的索引文件)
+  AttrType attr_types[MAX_ATTR_NUM];    ///< 每个字段的类型
+  int32_t  attr_lengths[MAX_ATTR_NUM];  ///< 每个字段的长度
+
+  /// 是否包含多个字段
+  bool is_multi_attr() const { return attr_num > 1; }
 
   const string to_string() const
   {
@@ -186,8 +235,15 @@ struct IndexFileHeader
 
     ss << "attr_length:" << attr_length << ","
        << "key_length:" << key_length << ","
-       << "attr_type:" << attr_type_to_string(attr_type) << ","
-       << "root_page:" << root_page << ","
+       << "attr_type:" << attr_type_to_string(attr_type) << ",";
+    if (is_multi_attr()) {
+      ss << "attrs:[";
+      for (int i = 0; i < attr_num; i++) {
+        ss << (i > 0 ? "," : "") << attr_type_to_string(attr_types[i]) << "(" << attr_lengths[i] << ")";
+      }
+      ss << "],";
+    }
+    ss << "root_page:" << root_page << ","
        << "internal_max_size:" << internal_max_size << ","
        << "leaf_max_size:" << leaf_max_size << ";";
 
@@ -464,6 +520,17 @@ public:
   RC create(LogHandler &log_handler, DiskBufferPool &buffer_pool, AttrType attr_type, int attr_length,
       int internal_max_size = -1, int leaf_max_size = -1);
 
+  /**
+   * @brief 创建一个多字段的B+树
+   * @details 键值是各个字段的值依次拼接而成的，按照字段的顺序逐个比较
+   * @param attr_types 每个字段的类型
+   * @param attr_lengths 每个字段的长度
+   */
+  RC create(LogHandler &log_handler, BufferPoolManager &bpm, const char *file_name, const vector<AttrType> &attr_types,
+      const vector<int> &attr_lengths, int internal_max_size = -1, int leaf_max_size = -1);
+  RC create(LogHandler &log_handler, DiskBufferPool &buffer_pool, const vector<AttrType> &attr_types,
+      const vector<int> &attr_lengths, int internal_max_size = -1, int leaf_max_size = -1);
+
   /**
    * @brief 打开一个B+树
    * @param log_handler 记录日志
@@ -493,6 +560,16 @@ public:
    */
   RC delete_entry(const char *user_key, const RID *rid);
 
+  /**
+   * @brief 自底向上批量构建B+树
+   * @details 只能在空树上调用。从左到右依次填满每一层的节点，每个节点按照 fill_factor 填充，最后设置根节点。
+   * 每个节点写完后就以页面镜像的形式记录日志并提交一个mini transaction，所以内存占用与数据量无关。
+   * @param count 键值的个数
+   * @param next_key 依次返回下一个键值（属性值 + RID，长度为 key_length），必须已经从小到大排好序并且没有重复
+   * @param fill_factor 节点的填充比例，百分比
+   */
+  RC bulk_load(int64_t count, const function<RC(const char *&key)> &next_key, int fill_factor);
+
   bool is_empty() const;
 
   /**
@@ -502,6 +579,17 @@ public:
    */
   RC get_entry(const char *user_key, int key_len, list<RID> &rids);
 
+  /**
+   * @brief 批量查找多个键值对应的 RID
+   * @details 键值按照从小到大的顺序排列时，下一个键值通常在当前叶子节点或者它右边的兄弟节点上，
+   * 这时不需要再从根节点向下查找。键值没有排序也能得到正确的结果，只是会多一些查找。
+   * @param user_keys 依次存放的键值，每个键值的长度都是 attr_length
+   * @param key_num 键值的个数
+   * @param[out] rids 所有键值对应的 RID，按照键值的顺序存放
+   * @param[out] offsets 可以为空。第 i 个键值的 RID 是 rids 中 [offsets[i], offsets[i+1]) 这一段
+   */
+  RC get_entries(const char *user_keys, int key_num, vector<RID> &rids, vector<int> *offsets = nullptr);
+
   RC sync();
 
   /**
@@ -511,9 +599,16 @@ public:
    */
   bool validate_tree();
 
+  /**
+   * @brief 是否先乐观地查找叶子节点，默认开启。参考 optimistic_find_leaf
+   */
+  void set_optimistic_latch(bool enable) { optimistic_latch_ = enable; }
+  bool optimistic_latch() const { return optimistic_latch_; }
+
 public:
   const IndexFileHeader &file_header() const { return file_header_; }
   DiskBufferPool        &buffer_pool() const { return *disk_buffer_pool_; }
+  const KeyComparator   &key_comparator() const { return key_comparator_; }
   LogHandler            &log_handler() const { return *log_handler_; }
 
 public:
@@ -568,6 +663,18 @@ protected:
   RC find_leaf_internal(BplusTreeMiniTransaction &mtr, BplusTreeOperationType op,
       const function<PageNum(InternalIndexNodeHandler &)> &child_page_getter, Frame *&frame);
 
+  /**
+   * @brief 乐观地查找叶子节点
+   * @details 从根节点向下查找时内部节点只 pin 不加锁，读取子节点页号前后校验页面的版本号，
+   * 版本号变化说明页面正在或者已经被修改，需要从根节点重新开始。
+   * 找到叶子节点后，按照操作类型对叶子节点加读锁或写锁，再校验父节点的版本号，确认叶子节点没有被分裂或合并。
+   * 写操作要求叶子节点是安全的（插入或删除后不会分裂或合并），否则放弃。
+   * 调用时 mtr 中不能持有其它页面。
+   * @return RC::LOCKED_NEED_WAIT 表示多次冲突或者叶子节点不安全，需要使用蟹行协议重新查找
+   */
+  RC optimistic_find_leaf(BplusTreeMiniTransaction &mtr, BplusTreeOperationType op,
+      const function<PageNum(InternalIndexNodeHandler &)> &child_page_getter, Frame *&frame);
+
   /**
    * @brief 使用crabing protocol 获取页面
    */
@@ -635,6 +742,11 @@ protected:
 private:
   common::MemPoolItem::item_unique_ptr make_key(const char *user_key, const RID &rid);
 
+  /**
+   * @brief 根据文件头中的字段信息初始化键值比较器和打印器
+   */
+  void init_key_comparator();
+
 protected:
   LogHandler     *log_handler_      = nullptr;  /// 日志处理器
   DiskBufferPool *disk_buffer_pool_ = nullptr;  /// 磁盘缓冲池
@@ -645,6 +757,10 @@ protected:
   // 这个锁可以使用递归读写锁，但是这里偷懒先不改
   common::SharedMutex root_lock_;
 
+  /// 乐观查找叶子节点时，冲突多少次之后改用蟹行协议
+  static constexpr int OPTIMISTIC_RETRY_TIMES = 3;
+  bool                 optimistic_latch_       = true;
+
   KeyComparator key_comparator_;
   KeyPrinter    key_printer_;
 
@@ -653,6 +769,7 @@ protected:
 private:
   friend class BplusTreeScanner;
   friend class BplusTreeTester;
+  friend class BplusTreeBulkLoader;
 };
 
 /**
@@ -689,6 +806,12 @@ public:
    */
   RC next_entry(RID &rid);
 
+  /**
+   * @brief 获取下一条记录，同时返回索引键
+   * @param user_key 指向叶子节点中的索引键，只在下一次调用 next_entry 之前有效
+   */
+  RC next_entry(RID &rid, const char *&user_key);
+
   /**
    * @brief 关闭当前扫描器
    * @details 可以不调用，在析构函数时会自动执行
@@ -701,6 +824,13 @@ private:
    */
   RC fix_user_key(const char *user_key, int key_len, bool want_greater, char **fixed_key, bool *should_inclusive);
 
+  /**
+   * 多字段索引可以只给出前面几个字段作为边界，没有给出的字段填充为最小值或最大值
+   * @param key_len user_key 的长度，是前面若干个字段长度的和
+   * @param fill_max 为 true 时填充最大值，否则填充最小值
+   */
+  void fill_prefix_key(const char *user_key, int key_len, bool fill_max, vector<char> &key) const;
+
   void fetch_item(RID &rid);
 
   /**
@@ -16,10 +16,13 @@ See the Mulan PSL v2 for more details. */
 #include "common/log/log.h"
 #include "storage/table/table.h"
 #include "storage/db/db.h"
+#include "storage/common/external_sorter.h"
+#include "storage/record/record_scanner.h"
 
 BplusTreeIndex::~BplusTreeIndex() noexcept { close(); }
 
-RC BplusTreeIndex::create(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta)
+RC BplusTreeIndex::create(
+    Table *table, const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas)
 {
   if (inited_) {
     LOG_WARN("Failed to create index due to the index has been created before. file_name:%s, index:%s, field:%s",
@@ -27,24 +30,33 @@ RC BplusTreeIndex::create(Table *table, const char *file_name, const IndexMeta &
     return RC::RECORD_OPENNED;
   }
 
-  Index::init(index_meta, field_meta);
+  Index::init(index_meta, field_metas);
+
+  vector<AttrType> attr_types;
+  vector<int>      attr_lengths;
+  for (const FieldMeta &field_meta : field_metas) {
+    attr_types.push_back(field_meta.type());
+    attr_lengths.push_back(field_meta.len());
+  }
 
   BufferPoolManager &bpm = table->db()->buffer_pool_manager();
-  RC rc = index_handler_.create(table->db()->log_handler(), bpm, file_name, field_meta.type(), field_meta.len());
+  RC rc = index_handler_.create(table->db()->log_handler(), bpm, file_name, attr_types, attr_lengths);
   if (RC::SUCCESS != rc) {
     LOG_WARN("Failed to create index_handler, file_name:%s, index:%s, field:%s, rc:%s",
         file_name, index_meta.name(), index_meta.field(), strrc(rc));
     return rc;
   }
 
-  inited_ = true;
-  table_  = table;
+  inited_    = true;
+  table_     = table;
+  file_name_ = file_name;
   LOG_INFO("Successfully create index, file_name:%s, index:%s, field:%s",
     file_name, index_meta.name(), index_meta.field());
   return RC::SUCCESS;
 }
 
-RC BplusTreeIndex::open(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta)
+RC BplusTreeIndex::open(
+    Table *table, const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas)
 {
   if (inited_) {
     LOG_WARN("Failed to open index due to the index has been initedd before. file_name:%s, index:%s, field:%s",
@@ -52,7 +64,7 @@ RC BplusTreeIndex::open(Table *table, const char *file_name, const IndexMeta &in
     return RC::RECORD_OPENNED;
   }
 
-  Index::init(index_meta, field_meta);
+  Index::init(index_meta, field_metas);
 
   BufferPoolManager &bpm = table->db()->buffer_pool_manager();
   RC rc = index_handler_.open(table->db()->log_handler(), bpm, file_name);
@@ -62,8 +74,9 @@ RC BplusTreeIndex::open(Table *table, const char *file_name, const IndexMeta &in
     return rc;
   }
 
-  inited_ = true;
-  table_  = table;
+  inited_    = true;
+  table_     = table;
+  file_name_ = file_name;
   LOG_INFO("Successfully open index, file_name:%s, index:%s, field:%s",
     file_name, index_meta.name(), index_meta.field());
   return RC::SUCCESS;
@@ -80,14 +93,76 @@ RC BplusTreeIndex::close()
   return RC::SUCCESS;
 }
 
+const char *BplusTreeIndex::make_key(const char *record, vector<char> &buffer) const
+{
+  if (field_metas_.size() == 1) {
+    return record + field_metas_[0].offset();
+  }
+
+  buffer.resize(index_handler_.file_header().attr_length);
+  char *key = buffer.data();
+  for (const FieldMeta &field_meta : field_metas_) {
+    memcpy(key, record + field_meta.offset(), field_meta.len());
+    key += field_meta.len();
+  }
+  return buffer.data();
+}
+
 RC BplusTreeIndex::insert_entry(const char *record, const RID *rid)
 {
-  return index_handler_.insert_entry(record + field_meta_.offset(), rid);
+  vector<char> buffer;
+  return index_handler_.insert_entry(make_key(record, buffer), rid);
 }
 
 RC BplusTreeIndex::delete_entry(const char *record, const RID *rid)
 {
-  return index_handler_.delete_entry(record + field_meta_.offset(), rid);
+  vector<char> buffer;
+  return index_handler_.delete_entry(make_key(record, buffer), rid);
+}
+
+RC BplusTreeIndex::bulk_load(RecordScanner &scanner, int fill_factor, size_t sort_memory)
+{
+  const IndexFileHeader &file_header = index_handler_.file_header();
+  const int              attr_length = file_header.attr_length;
+
+  // 排序的数据就是B+树叶子节点上的键值：属性值 + RID
+  const KeyComparator &key_comparator = index_handler_.key_comparator();
+  ExternalSorter       sorter(file_header.key_length,
+      [&key_comparator](const char *a, const char *b) { return key_comparator(a, b); },
+      sort_memory,
+      file_name_ + ".sort");
+
+  RC           rc = RC::SUCCESS;
+  Record       record;
+  vector<char> key(file_header.key_length);
+  vector<char> buffer;
+  while (OB_SUCC(rc = scanner.next(record))) {
+    memcpy(key.data(), make_key(record.data(), buffer), attr_length);
+    memcpy(key.data() + attr_length, &record.rid(), sizeof(RID));
+    if (OB_FAIL(rc = sorter.add(key.data()))) {
+      LOG_WARN("failed to add key into sorter. index=%s, rc=%s", index_meta_.name(), strrc(rc));
+      return rc;
+    }
+  }
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to scan records while bulk loading index. index=%s, rc=%s", index_meta_.name(), strrc(rc));
+    return rc;
+  }
+
+  if (OB_FAIL(rc = sorter.finish())) {
+    LOG_WARN("failed to sort keys while bulk loading index. index=%s, rc=%s", index_meta_.name(), strrc(rc));
+    return rc;
+  }
+
+  LOG_INFO("begin to bulk load index. index=%s, keys=%ld, sort runs=%d, fill factor=%d",
+           index_meta_.name(), sorter.count(), sorter.run_num(), fill_factor);
+  return index_handler_.bulk_load(
+      sorter.count(), [&sorter](const char *&key) { return sorter.next(key); }, fill_factor);
+}
+
+RC BplusTreeIndex::get_entries(const char *keys, int key_num, vector<RID> &rids, vector<int> *offsets)
+{
+  return index_handler_.get_entries(keys, key_num, rids, offsets);
 }
 
 IndexScanner *BplusTreeIndex::create_scanner(
@@ -118,6 +193,8 @@ RC BplusTreeIndexScanner::open(
 
 RC BplusTreeIndexScanner::next_entry(RID *rid) { return tree_scanner_.next_entry(*rid); }
 
+RC BplusTreeIndexScanner::next_entry(RID *rid, const char *&key) { return tree_scanner_.next_entry(*rid, key); }
+
 RC BplusTreeIndexScanner::destroy()
 {
   delete this;
@@ -17,6 +17,8 @@ See the Mulan PSL v2 for more details. */
 #include "storage/index/bplus_tree.h"
 #include "storage/index/index.h"
 
+class RecordScanner;
+
 /**
  * @brief B+树索引
  * @ingroup Index
@@ -27,13 +29,31 @@ public:
   BplusTreeIndex() = default;
   virtual ~BplusTreeIndex() noexcept;
 
-  RC create(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta) override;
-  RC open(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta) override;
+  RC create(
+      Table *table, const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas) override;
+  RC open(
+      Table *table, const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas) override;
   RC close();
 
   RC insert_entry(const char *record, const RID *rid) override;
   RC delete_entry(const char *record, const RID *rid) override;
 
+  /**
+   * @brief 使用表中已有的数据批量构建索引，只能在新创建的空索引上调用
+   * @details 先取出所有记录的 (键值, RID) 做外部排序，再自底向上构建B+树，比逐条插入快很多，
+   * 并且构建出来的节点是按照填充因子填满的。
+   * @param scanner 表的记录扫描器
+   * @param fill_factor 节点的填充比例，百分比
+   * @param sort_memory 外部排序可以使用的内存大小
+   */
+  RC bulk_load(RecordScanner &scanner, int fill_factor, size_t sort_memory);
+
+  /**
+   * @brief 批量查找多个索引键对应的 RID，适合 IN 列表和索引嵌套循环连接
+   * @details 参考 BplusTreeHandler::get_entries。keys 中依次存放 key_num 个完整的索引键
+   */
+  RC get_entries(const char *keys, int key_num, vector<RID> &rids, vector<int> *offsets = nullptr);
+
   /**
    * 扫描指定范围的数据
    */
@@ -42,9 +62,19 @@ public:
 
   RC sync() override;
 
+  bool support_index_only_scan() const override { return true; }
+
+private:
+  /**
+   * @brief 从记录中取出索引键
+   * @details 单字段索引直接返回字段在记录中的位置；多字段索引把各个字段的值依次拷贝到 buffer 中
+   */
+  const char *make_key(const char *record, vector<char> &buffer) const;
+
 private:
   bool             inited_ = false;
   Table           *table_  = nullptr;
+  string           file_name_;
   BplusTreeHandler index_handler_;
 };
 
@@ -59,6 +89,7 @@ public:
   ~BplusTreeIndexScanner() noexcept override;
 
   RC next_entry(RID *rid) override;
+  RC next_entry(RID *rid, const char *&key) override;
   RC destroy() override;
 
   RC open(const char *left_key, int left_len, bool left_inclusive, const char *right_key, int right_len,
@@ -90,6 +90,15 @@ RC BplusTreeLogger::set_parent_page(IndexNodeHandler &node_handler, PageNum page
   return append_log_entry(make_unique<SetParentPageLogEntryHandler>(node_handler.frame(), page_num, old_page_num));
 }
 
+RC BplusTreeLogger::page_image(Frame *frame, span<const char> image)
+{
+  if (!need_log_) {
+    return RC::SUCCESS;
+  }
+  span<const char> old_image(frame->data(), image.size());
+  return append_log_entry(make_unique<PageImageLogEntryHandler>(frame, image, old_image));
+}
+
 RC BplusTreeLogger::append_log_entry(unique_ptr<bplus_tree::LogEntryHandler> entry)
 {
   if (!need_log_) {
@@ -127,6 +127,14 @@ public:
    */
   RC set_parent_page(IndexNodeHandler &node_handler, PageNum page_num, PageNum old_page_num);
 
+  /**
+   * @brief 记录整个页面的镜像
+   * @details 必须在修改页面之前调用，会把页面上原来的数据记录下来用于回滚
+   * @param frame 页帧
+   * @param image 页面的新内容，从页面数据的起始位置开始
+   */
+  RC page_image(Frame *frame, span<const char> image);
+
   /**
    * @brief 提交。表示整个操作成功
    */
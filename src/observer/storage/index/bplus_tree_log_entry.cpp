@@ -34,6 +34,7 @@ string LogOperation::to_string() const
     case Type::INTERNAL_UPDATE_KEY: ss << "INTERNAL_UPDATE_KEY"; break;
     case Type::NODE_INSERT: ss << "NODE_INSERT"; break;
     case Type::NODE_REMOVE: ss << "NODE_REMOVE"; break;
+    case Type::PAGE_IMAGE: ss << "PAGE_IMAGE"; break;
     default: ss << "INVALID"; break;
   }
   return ss.str();
@@ -172,6 +173,10 @@ RC LogEntryHandler::from_buffer(
       rc = NormalOperationLogEntryHandler::deserialize(frame, operation, buffer, handler);
     } break;
 
+    case LogOperation::Type::PAGE_IMAGE: {
+      rc = PageImageLogEntryHandler::deserialize(frame, buffer, handler);
+    } break;
+
     default: {
       LOG_ERROR("unknown log operation. operation=%d:%s", operation.index(), operation.to_string().c_str());
       return RC::INTERNAL;
@@ -605,4 +610,65 @@ RC UpdateRootPageLogEntryHandler::redo(BplusTreeMiniTransaction &mtr, BplusTreeH
   return tree_handler.recover_update_root_page(mtr, root_page_num_);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// PageImageLogEntryHandler
+
+PageImageLogEntryHandler::PageImageLogEntryHandler(Frame *frame, span<const char> image, span<const char> old_image)
+    : NodeLogEntryHandler(LogOperation::Type::PAGE_IMAGE, frame),
+      image_(image.begin(), image.end()),
+      old_image_(old_image.begin(), old_image.end())
+{}
+
+RC PageImageLogEntryHandler::serialize_body(Serializer &buffer) const
+{
+  int     ret         = 0;
+  int32_t image_bytes = static_cast<int32_t>(image_.size());
+  if ((ret = buffer.write_int32(image_bytes)) < 0 || (ret = buffer.write(image_)) < 0) {
+    return RC::INTERNAL;
+  }
+  return RC::SUCCESS;
+}
+
+string PageImageLogEntryHandler::to_string() const
+{
+  stringstream ss;
+  ss << LogEntryHandler::to_string() << ", image_bytes=" << image_.size();
+  return ss.str();
+}
+
+RC PageImageLogEntryHandler::deserialize(Frame *frame, Deserializer &buffer, unique_ptr<LogEntryHandler> &handler)
+{
+  int     ret         = 0;
+  int32_t image_bytes = -1;
+  if ((ret = buffer.read_int32(image_bytes)) < 0 || image_bytes < 0 || image_bytes > BP_PAGE_DATA_SIZE) {
+    return RC::INTERNAL;
+  }
+
+  vector<char> image(image_bytes);
+  if ((ret = buffer.read(image)) < 0) {
+    return RC::INTERNAL;
+  }
+
+  vector<char> old_image(0);
+  handler = make_unique<PageImageLogEntryHandler>(frame, image, old_image);
+  return RC::SUCCESS;
+}
+
+RC PageImageLogEntryHandler::rollback(BplusTreeMiniTransaction &mtr, BplusTreeHandler &tree_handler)
+{
+  if (nullptr == frame()) {
+    return RC::INTERNAL;
+  }
+  memcpy(frame()->data(), old_image_.data(), old_image_.size());
+  frame()->mark_dirty();
+  return RC::SUCCESS;
+}
+
+RC PageImageLogEntryHandler::redo(BplusTreeMiniTransaction &mtr, BplusTreeHandler &tree_handler)
+{
+  memcpy(frame()->data(), image_.data(), image_.size());
+  frame()->mark_dirty();
+  return RC::SUCCESS;
+}
+
 }  // namespace bplus_tree
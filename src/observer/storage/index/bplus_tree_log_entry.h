@@ -50,6 +50,7 @@ public:
     INTERNAL_UPDATE_KEY,       /// 更新内部节点的key
     NODE_INSERT,               /// 在节点中间(也可能是末尾)插入一些元素
     NODE_REMOVE,               /// 在节点中间(也可能是末尾)删除一些元素
+    PAGE_IMAGE,                /// 整个页面的镜像，批量构建B+树时使用
 
     MAX_TYPE,
   };
@@ -376,4 +377,32 @@ private:
   vector<char> old_key_;
 };
 
+/**
+ * @brief 页面镜像日志处理类
+ * @ingroup CLog
+ * @details 批量构建B+树时，每个节点都是在内存中一次性填好的，直接记录整个节点的内容，而不是一个个元素的插入操作。
+ * 镜像只包含节点头和已经使用的元素，不包含页面末尾没有使用的空间。
+ */
+class PageImageLogEntryHandler : public NodeLogEntryHandler
+{
+public:
+  PageImageLogEntryHandler(Frame *frame, span<const char> image, span<const char> old_image);
+  virtual ~PageImageLogEntryHandler() = default;
+
+  RC serialize_body(common::Serializer &buffer) const override;
+  RC rollback(BplusTreeMiniTransaction &mtr, BplusTreeHandler &tree_handler) override;
+  RC redo(BplusTreeMiniTransaction &mtr, BplusTreeHandler &tree_handler) override;
+
+  string to_string() const override;
+
+  static RC deserialize(Frame *frame, common::Deserializer &buffer, unique_ptr<LogEntryHandler> &handler);
+
+  const char *image() const { return image_.data(); }
+  int32_t     image_bytes() const { return static_cast<int32_t>(image_.size()); }
+
+private:
+  vector<char> image_;
+  vector<char> old_image_;
+};
+
 }  // namespace bplus_tree
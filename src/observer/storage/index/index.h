@@ -23,6 +23,7 @@ See the Mulan PSL v2 for more details. */
 #include "storage/record/record_manager.h"
 
 class IndexScanner;
+class Trx;
 
 /**
  * @brief 索引
@@ -40,17 +41,28 @@ public:
   Index()          = default;
   virtual ~Index() = default;
 
-  virtual RC create(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta)
+  /**
+   * @brief 创建索引
+   * @param field_metas 索引的所有字段，与 index_meta 中字段的顺序一致
+   */
+  virtual RC create(
+      Table *table, const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas)
   {
     return RC::UNSUPPORTED;
   }
-  virtual RC open(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta)
+  virtual RC open(Table *table, const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas)
   {
     return RC::UNSUPPORTED;
   }
 
   virtual bool is_vector_index() { return false; }
 
+  /**
+   * @brief 扫描器能否在返回 RID 的同时返回索引键
+   * @details 支持的话，查询只用到索引字段时可以不回表，直接使用索引键中的数据
+   */
+  virtual bool support_index_only_scan() const { return false; }
+
   const IndexMeta &index_meta() const { return index_meta_; }
 
   /**
@@ -82,6 +94,16 @@ public:
   virtual IndexScanner *create_scanner(const char *left_key, int left_len, bool left_inclusive, const char *right_key,
       int right_len, bool right_inclusive) = 0;
 
+  /**
+   * @brief 在事务中创建一个索引数据的扫描器，能看到事务自己还没有提交的索引项
+   * @details 索引项不在事务中写入的索引（比如 B+ 树索引）不需要区分，直接使用 create_scanner
+   */
+  virtual IndexScanner *create_scanner_with_trx(Trx *trx, const char *left_key, int left_len, bool left_inclusive,
+      const char *right_key, int right_len, bool right_inclusive)
+  {
+    return create_scanner(left_key, left_len, left_inclusive, right_key, right_len, right_inclusive);
+  }
+
   /**
    * @brief 同步索引数据到磁盘
    *
@@ -89,11 +111,11 @@ public:
   virtual RC sync() = 0;
 
 protected:
-  RC init(const IndexMeta &index_meta, const FieldMeta &field_meta);
+  RC init(const IndexMeta &index_meta, const vector<FieldMeta> &field_metas);
 
 protected:
-  IndexMeta index_meta_;  ///< 索引的元数据
-  FieldMeta field_meta_;  ///< 当前实现仅考虑一个字段的索引
+  IndexMeta         index_meta_;   ///< 索引的元数据
+  vector<FieldMeta> field_metas_;  ///< 索引的字段，多字段索引的键值按照字段的顺序依次拼接
 };
 
 /**
@@ -112,4 +134,10 @@ public:
    */
   virtual RC next_entry(RID *rid) = 0;
   virtual RC destroy()            = 0;
+
+  /**
+   * 遍历元素数据，同时返回索引键。索引键只在下一次调用 next_entry 之前有效
+   * 需要索引支持 support_index_only_scan
+   */
+  virtual RC next_entry(RID *rid, const char *&key) { return RC::UNSUPPORTED; }
 };
@@ -21,23 +21,61 @@ See the Mulan PSL v2 for more details. */
 
 const static Json::StaticString FIELD_NAME("name");
 const static Json::StaticString FIELD_FIELD_NAME("field_name");
+const static Json::StaticString FIELD_FIELD_NAMES("field_names");
+const static Json::StaticString FIELD_TYPE("type");
+const static Json::StaticString FIELD_DISTANCE("distance");
+const static Json::StaticString FIELD_LISTS("lists");
+const static Json::StaticString FIELD_PROBES("probes");
 
-RC IndexMeta::init(const char *name, const FieldMeta &field)
+const static char *IVFFLAT_TYPE_NAME = "ivfflat";
+
+RC IndexMeta::init(const char *name, const vector<const FieldMeta *> &fields)
 {
   if (common::is_blank(name)) {
     LOG_ERROR("Failed to init index, name is empty.");
     return RC::INVALID_ARGUMENT;
   }
+  if (fields.empty()) {
+    LOG_ERROR("Failed to init index, no field. name=%s", name);
+    return RC::INVALID_ARGUMENT;
+  }
 
-  name_  = name;
-  field_ = field.name();
+  name_ = name;
+  fields_.clear();
+  for (const FieldMeta *field : fields) {
+    fields_.push_back(field->name());
+  }
+  type_ = IndexType::BPLUS_TREE;
   return RC::SUCCESS;
 }
 
+void IndexMeta::set_ivfflat_options(const IvfflatOptions &options)
+{
+  type_            = IndexType::IVFFLAT;
+  ivfflat_options_ = options;
+}
+
 void IndexMeta::to_json(Json::Value &json_value) const
 {
   json_value[FIELD_NAME]       = name_;
-  json_value[FIELD_FIELD_NAME] = field_;
+  json_value[FIELD_FIELD_NAME] = fields_[0];
+
+  // 单字段索引只记录 field_name，与旧版本的元数据格式保持一致
+  if (fields_.size() > 1) {
+    Json::Value fields_value;
+    for (const string &field : fields_) {
+      fields_value.append(field);
+    }
+    json_value[FIELD_FIELD_NAMES] = std::move(fields_value);
+  }
+
+  // B+树索引不记录类型，与旧版本的元数据格式保持一致
+  if (type_ == IndexType::IVFFLAT) {
+    json_value[FIELD_TYPE]     = IVFFLAT_TYPE_NAME;
+    json_value[FIELD_DISTANCE] = vector_distance_type_to_string(ivfflat_options_.distance);
+    json_value[FIELD_LISTS]    = ivfflat_options_.lists;
+    json_value[FIELD_PROBES]   = ivfflat_options_.probes;
+  }
 }
 
 RC IndexMeta::from_json(const TableMeta &table, const Json::Value &json_value, IndexMeta &index)
@@ -55,17 +93,88 @@ RC IndexMeta::from_json(const TableMeta &table, const Json::Value &json_value, I
     return RC::INTERNAL;
   }
 
-  const FieldMeta *field = table.field(field_value.asCString());
-  if (nullptr == field) {
-    LOG_ERROR("Deserialize index [%s]: no such field: %s", name_value.asCString(), field_value.asCString());
-    return RC::SCHEMA_FIELD_MISSING;
+  vector<const char *> field_names;
+  const Json::Value   &fields_value = json_value[FIELD_FIELD_NAMES];
+  if (fields_value.isArray() && !fields_value.empty()) {
+    for (const Json::Value &value : fields_value) {
+      if (!value.isString()) {
+        LOG_ERROR("Field name of index [%s] is not a string. json value=%s",
+            name_value.asCString(), value.toStyledString().c_str());
+        return RC::INTERNAL;
+      }
+      field_names.push_back(value.asCString());
+    }
+  } else {
+    field_names.push_back(field_value.asCString());
+  }
+
+  vector<const FieldMeta *> fields;
+  for (const char *field_name : field_names) {
+    const FieldMeta *field = table.field(field_name);
+    if (nullptr == field) {
+      LOG_ERROR("Deserialize index [%s]: no such field: %s", name_value.asCString(), field_name);
+      return RC::SCHEMA_FIELD_MISSING;
+    }
+    fields.push_back(field);
+  }
+
+  RC rc = index.init(name_value.asCString(), fields);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  const Json::Value &type_value = json_value[FIELD_TYPE];
+  if (type_value.isNull()) {
+    return RC::SUCCESS;
+  }
+  if (!type_value.isString() || 0 != strcasecmp(type_value.asCString(), IVFFLAT_TYPE_NAME)) {
+    LOG_ERROR("Unknown type of index [%s]. json value=%s", name_value.asCString(), type_value.toStyledString().c_str());
+    return RC::INTERNAL;
+  }
+
+  const Json::Value &distance_value = json_value[FIELD_DISTANCE];
+  const Json::Value &lists_value    = json_value[FIELD_LISTS];
+  const Json::Value &probes_value   = json_value[FIELD_PROBES];
+  IvfflatOptions     options;
+  if (!distance_value.isString() || !lists_value.isInt() || !probes_value.isInt() ||
+      OB_FAIL(vector_distance_type_from_string(distance_value.asCString(), options.distance))) {
+    LOG_ERROR("Invalid options of ivfflat index [%s]. json value=%s",
+        name_value.asCString(), json_value.toStyledString().c_str());
+    return RC::INTERNAL;
   }
+  options.lists  = lists_value.asInt();
+  options.probes = probes_value.asInt();
+  index.set_ivfflat_options(options);
+  return RC::SUCCESS;
+}
 
-  return index.init(name_value.asCString(), *field);
+RC IndexMeta::field_metas(const TableMeta &table, vector<FieldMeta> &field_metas) const
+{
+  field_metas.clear();
+  for (const string &field_name : fields_) {
+    const FieldMeta *field = table.field(field_name.c_str());
+    if (nullptr == field) {
+      LOG_ERROR("Found invalid index meta info which has a non-exists field. table=%s, index=%s, field=%s",
+                table.name(), name_.c_str(), field_name.c_str());
+      return RC::SCHEMA_FIELD_MISSING;
+    }
+    field_metas.push_back(*field);
+  }
+  return RC::SUCCESS;
 }
 
 const char *IndexMeta::name() const { return name_.c_str(); }
 
-const char *IndexMeta::field() const { return field_.c_str(); }
+const char *IndexMeta::field() const { return fields_.empty() ? "" : fields_[0].c_str(); }
 
-void IndexMeta::desc(ostream &os) const { os << "index name=" << name_ << ", field=" << field_; }
\ No newline at end of file
+void IndexMeta::desc(ostream &os) const
+{
+  os << "index name=" << name_ << ", field=";
+  for (size_t i = 0; i < fields_.size(); i++) {
+    os << (i > 0 ? "," : "") << fields_[i];
+  }
+  if (type_ == IndexType::IVFFLAT) {
+    os << ", type=" << IVFFLAT_TYPE_NAME << ", distance=" << vector_distance_type_to_string(ivfflat_options_.distance)
+       << ", lists=" << ivfflat_options_.lists << ", probes=" << ivfflat_options_.probes;
+  }
+}
\ No newline at end of file
@@ -16,6 +16,8 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/sys/rc.h"
 #include "common/lang/string.h"
+#include "common/lang/vector.h"
+#include "common/type/vector_distance.h"
 
 class TableMeta;
 class FieldMeta;
@@ -24,22 +26,61 @@ namespace Json {
 class Value;
 }  // namespace Json
 
+/**
+ * @brief 索引的类型
+ * @ingroup Index
+ */
+enum class IndexType
+{
+  BPLUS_TREE,  ///< B+树索引
+  IVFFLAT,     ///< IVFFlat 向量索引
+};
+
+/**
+ * @brief IVFFlat 向量索引的参数
+ * @ingroup Index
+ */
+struct IvfflatOptions
+{
+  VectorDistanceType distance = VectorDistanceType::L2;
+  int                lists    = 1;  ///< 聚类中心的个数，也就是倒排链表的个数
+  int                probes   = 1;  ///< 查询时扫描离查询向量最近的几个链表
+};
+
 /**
  * @brief 描述一个索引
  * @ingroup Index
- * @details 一个索引包含了表的哪些字段，索引的名称等。
- * 如果以后实现了多种类型的索引，还需要记录索引的类型，对应类型的一些元数据等
+ * @details 一个索引包含了表的哪些字段，索引的名称等。多字段索引的字段是有顺序的，
+ * 索引键按照字段的顺序依次比较。
+ * 向量索引还会记录距离类型、聚类个数等参数。
  */
 class IndexMeta
 {
 public:
   IndexMeta() = default;
 
-  RC init(const char *name, const FieldMeta &field);
+  RC init(const char *name, const vector<const FieldMeta *> &fields);
+
+  /**
+   * @brief 设置为 IVFFlat 向量索引
+   */
+  void set_ivfflat_options(const IvfflatOptions &options);
 
 public:
   const char *name() const;
+  /// 第一个字段的名字
   const char *field() const;
+  /// 所有字段的名字，按照索引键中的顺序
+  const vector<string> &fields() const { return fields_; }
+  int                   field_num() const { return static_cast<int>(fields_.size()); }
+
+  IndexType             type() const { return type_; }
+  const IvfflatOptions &ivfflat_options() const { return ivfflat_options_; }
+
+  /**
+   * @brief 按照索引键中的顺序，从表中找到索引的所有字段
+   */
+  RC field_metas(const TableMeta &table, vector<FieldMeta> &field_metas) const;
 
   void desc(ostream &os) const;
 
@@ -48,6 +89,8 @@ public:
   static RC from_json(const TableMeta &table, const Json::Value &json_value, IndexMeta &index);
 
 protected:
-  string name_;   // index's name
-  string field_;  // field's name
+  string         name_;                          // index's name
+  vector<string> fields_;                        // fields' name
+  IndexType      type_ = IndexType::BPLUS_TREE;  // index's type
+  IvfflatOptions ivfflat_options_;               // 仅 IVFFLAT 类型有效
 };
@@ -0,0 +1,652 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/index/ivfflat_index.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/cmath.h"
+#include "common/lang/limits.h"
+#include "common/lang/random.h"
+#include "common/log/log.h"
+#include "storage/db/db.h"
+#include "storage/record/record_scanner.h"
+#include "storage/table/table.h"
+
+/// 文件头所在的页面，也就是创建文件后分配的第一个页面
+static constexpr PageNum IVFFLAT_HEADER_PAGE = 1;
+
+/// 每个链表采样多少个向量用于训练
+static constexpr int TRAIN_SAMPLES_PER_LIST = 64;
+/// k-means 最多迭代的次数
+static constexpr int TRAIN_MAX_ITERATIONS = 16;
+/// 采样和初始化聚类中心使用固定的种子，同样的数据训练出同样的索引
+static constexpr unsigned int TRAIN_RANDOM_SEED = 20240101;
+
+IvfflatIndex::~IvfflatIndex() noexcept { close(); }
+
+RC IvfflatIndex::create(
+    Table *table, const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas)
+{
+  RC rc = create(table->db()->log_handler(), table->db()->buffer_pool_manager(), file_name, index_meta, field_metas);
+  if (OB_SUCC(rc)) {
+    table_ = table;
+  }
+  return rc;
+}
+
+RC IvfflatIndex::open(
+    Table *table, const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas)
+{
+  RC rc = open(table->db()->log_handler(), table->db()->buffer_pool_manager(), file_name, index_meta, field_metas);
+  if (OB_SUCC(rc)) {
+    table_ = table;
+  }
+  return rc;
+}
+
+RC IvfflatIndex::init_layout(const vector<FieldMeta> &field_metas)
+{
+  if (field_metas.size() != 1 || field_metas[0].type() != AttrType::VECTORS) {
+    LOG_WARN("ivfflat index can only be created on one vector field. field num=%d", static_cast<int>(field_metas.size()));
+    return RC::INVALID_ARGUMENT;
+  }
+
+  dim_ = field_metas[0].len() / static_cast<int>(sizeof(float));
+  if (dim_ <= 0 || list_meta_size() > BP_PAGE_DATA_SIZE || entries_per_list_page() <= 0) {
+    LOG_WARN("vector dimension is too large for ivfflat index. dim=%d", dim_);
+    return RC::UNSUPPORTED;
+  }
+  return RC::SUCCESS;
+}
+
+RC IvfflatIndex::create(LogHandler &log_handler, BufferPoolManager &bpm, const char *file_name,
+    const IndexMeta &index_meta, const vector<FieldMeta> &field_metas)
+{
+  if (inited_) {
+    LOG_WARN("Failed to create index due to the index has been created before. file_name:%s, index:%s",
+        file_name, index_meta.name());
+    return RC::RECORD_OPENNED;
+  }
+  if (index_meta.type() != IndexType::IVFFLAT) {
+    LOG_WARN("index meta is not an ivfflat index. index:%s", index_meta.name());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  Index::init(index_meta, field_metas);
+  RC rc = init_layout(field_metas);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  rc = bpm.create_file(file_name);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("Failed to create file. file name=%s, rc=%s", file_name, strrc(rc));
+    return rc;
+  }
+  rc = bpm.open_file(log_handler, file_name, disk_buffer_pool_);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("Failed to open file. file name=%s, rc=%s", file_name, strrc(rc));
+    return rc;
+  }
+
+  Frame *frame = nullptr;
+  rc           = disk_buffer_pool_->allocate_page(&frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("Failed to allocate header page of ivfflat index. file name=%s, rc=%s", file_name, strrc(rc));
+    bpm.close_file(file_name);
+    disk_buffer_pool_ = nullptr;
+    return rc;
+  }
+  ASSERT(frame->page_num() == IVFFLAT_HEADER_PAGE, "invalid header page of ivfflat index: %d", frame->page_num());
+
+  auto header          = reinterpret_cast<IvfflatFileHeader *>(frame->data());
+  header->dim          = dim_;
+  header->lists        = 0;
+  header->dir_page_num = 0;
+  frame->mark_dirty();
+  disk_buffer_pool_->unpin_page(frame);
+
+  inited_ = true;
+  LOG_INFO("Successfully create ivfflat index, file_name:%s, index:%s, field:%s, dim:%d",
+      file_name, index_meta.name(), index_meta.field(), dim_);
+  return RC::SUCCESS;
+}
+
+RC IvfflatIndex::open(LogHandler &log_handler, BufferPoolManager &bpm, const char *file_name,
+    const IndexMeta &index_meta, const vector<FieldMeta> &field_metas)
+{
+  if (inited_) {
+    LOG_WARN("Failed to open index due to the index has been initedd before. file_name:%s, index:%s",
+        file_name, index_meta.name());
+    return RC::RECORD_OPENNED;
+  }
+
+  Index::init(index_meta, field_metas);
+  RC rc = init_layout(field_metas);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  rc = bpm.open_file(log_handler, file_name, disk_buffer_pool_);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("Failed to open file. file name=%s, rc=%s", file_name, strrc(rc));
+    return rc;
+  }
+
+  Frame *frame = nullptr;
+  rc           = disk_buffer_pool_->get_this_page(IVFFLAT_HEADER_PAGE, &frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("Failed to get header page of ivfflat index. file name=%s, rc=%s", file_name, strrc(rc));
+    close();
+    return rc;
+  }
+
+  auto header = reinterpret_cast<const IvfflatFileHeader *>(frame->data());
+  if (header->dim != dim_) {
+    LOG_ERROR("dimension of ivfflat index mismatch. file name=%s, file dim=%d, field dim=%d",
+        file_name, header->dim, dim_);
+    disk_buffer_pool_->unpin_page(frame);
+    close();
+    return RC::INTERNAL;
+  }
+  const int list_num = header->lists;
+  dir_pages_.assign(header->dir_pages, header->dir_pages + header->dir_page_num);
+  disk_buffer_pool_->unpin_page(frame);
+  frame = nullptr;
+
+  // 目录常驻内存，查询时不需要再读目录页
+  list_metas_.resize(list_num);
+  centroids_.resize(static_cast<size_t>(list_num) * dim_);
+  for (int list = 0; list < list_num; list++) {
+    const int lists_per_page = lists_per_dir_page();
+    if (list % lists_per_page == 0) {
+      if (frame != nullptr) {
+        disk_buffer_pool_->unpin_page(frame);
+      }
+      rc = disk_buffer_pool_->get_this_page(dir_pages_[list / lists_per_page], &frame);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("Failed to get directory page of ivfflat index. file name=%s, rc=%s", file_name, strrc(rc));
+        frame = nullptr;
+        break;
+      }
+    }
+
+    const char *data = frame->data() + (list % lists_per_page) * list_meta_size();
+    memcpy(&list_metas_[list], data, sizeof(IvfflatListMeta));
+    memcpy(centroids_.data() + static_cast<size_t>(list) * dim_, data + sizeof(IvfflatListMeta), dim_ * sizeof(float));
+  }
+  if (frame != nullptr) {
+    disk_buffer_pool_->unpin_page(frame);
+  }
+  if (OB_FAIL(rc)) {
+    close();
+    return rc;
+  }
+
+  inited_ = true;
+  LOG_INFO("Successfully open ivfflat index, file_name:%s, index:%s, field:%s, dim:%d, lists:%d",
+      file_name, index_meta.name(), index_meta.field(), dim_, list_num);
+  return RC::SUCCESS;
+}
+
+RC IvfflatIndex::close()
+{
+  if (disk_buffer_pool_ != nullptr) {
+    LOG_INFO("Begin to close index, index:%s, field:%s", index_meta_.name(), index_meta_.field());
+    disk_buffer_pool_->close_file();
+    disk_buffer_pool_ = nullptr;
+  }
+  inited_ = false;
+  list_metas_.clear();
+  centroids_.clear();
+  dir_pages_.clear();
+  return RC::SUCCESS;
+}
+
+float IvfflatIndex::distance_key(const float *left, const float *right) const
+{
+  const VectorDistanceType type     = index_meta_.ivfflat_options().distance;
+  const float              distance = vector_distance(type, left, right, dim_);
+  return vector_distance_ascending(type) ? distance : -distance;
+}
+
+int IvfflatIndex::nearest_list(const float *vector) const
+{
+  const int list_num     = static_cast<int>(centroids_.size() / dim_);
+  int       nearest      = 0;
+  float     nearest_dist = numeric_limits<float>::max();
+  for (int list = 0; list < list_num; list++) {
+    float dist = distance_key(vector, centroid(list));
+    if (dist < nearest_dist) {
+      nearest      = list;
+      nearest_dist = dist;
+    }
+  }
+  return nearest;
+}
+
+RC IvfflatIndex::train(RecordScanner &scanner)
+{
+  lock_guard<common::SharedMutex> guard(lock_);
+  if (!list_metas_.empty()) {
+    LOG_WARN("ivfflat index has been trained. index:%s", index_meta_.name());
+    return RC::INTERNAL;
+  }
+
+  // 蓄水池采样，保证每个向量被选中的概率相同
+  const int     list_num    = index_meta_.ivfflat_options().lists;
+  const size_t  max_samples = static_cast<size_t>(list_num) * TRAIN_SAMPLES_PER_LIST;
+  const int     offset      = field_metas_[0].offset();
+  vector<float> samples;
+  size_t        sample_num = 0;
+  size_t        seen       = 0;
+  mt19937       random(TRAIN_RANDOM_SEED);
+
+  RC     rc = RC::SUCCESS;
+  Record record;
+  while (OB_SUCC(rc = scanner.next(record))) {
+    const float *vector = reinterpret_cast<const float *>(record.data() + offset);
+    if (sample_num < max_samples) {
+      samples.insert(samples.end(), vector, vector + dim_);
+      sample_num++;
+    } else {
+      size_t pos = uniform_int_distribution<size_t>(0, seen)(random);
+      if (pos < max_samples) {
+        memcpy(samples.data() + pos * dim_, vector, dim_ * sizeof(float));
+      }
+    }
+    seen++;
+  }
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to sample vectors for ivfflat index. index:%s, rc=%s", index_meta_.name(), strrc(rc));
+    return rc;
+  }
+
+  kmeans(samples, static_cast<int>(sample_num), list_num);
+  LOG_INFO("trained ivfflat index. index:%s, rows:%ld, samples:%ld, lists:%d",
+      index_meta_.name(), seen, sample_num, static_cast<int>(list_metas_.size()));
+  return write_directory();
+}
+
+void IvfflatIndex::kmeans(const vector<float> &samples, int sample_num, int list_num)
+{
+  list_num = max(1, min(list_num, sample_num));
+  centroids_.assign(static_cast<size_t>(list_num) * dim_, 0.0f);
+  list_metas_.assign(list_num, IvfflatListMeta{BP_INVALID_PAGE_NUM, 0});
+  if (sample_num == 0) {
+    return;
+  }
+
+  auto sample = [&](int i) { return samples.data() + static_cast<size_t>(i) * dim_; };
+  auto l2     = [&](const float *a, const float *b) {
+    float sum = 0;
+    for (int d = 0; d < dim_; d++) {
+      sum += (a[d] - b[d]) * (a[d] - b[d]);
+    }
+    return sum;
+  };
+
+  // k-means++ 初始化：离已有中心越远的向量越有可能被选为下一个中心
+  mt19937       random(TRAIN_RANDOM_SEED);
+  vector<float> min_dist(sample_num, numeric_limits<float>::max());
+  int           chosen = uniform_int_distribution<int>(0, sample_num - 1)(random);
+  for (int list = 0; list < list_num; list++) {
+    memcpy(centroids_.data() + static_cast<size_t>(list) * dim_, sample(chosen), dim_ * sizeof(float));
+
+    double total = 0;
+    for (int i = 0; i < sample_num; i++) {
+      min_dist[i] = min(min_dist[i], l2(sample(i), centroid(list)));
+      total += min_dist[i];
+    }
+
+    if (total <= 0) {
+      chosen = uniform_int_distribution<int>(0, sample_num - 1)(random);
+      continue;
+    }
+    double target = uniform_real_distribution<double>(0, total)(random);
+    for (chosen = 0; chosen < sample_num - 1; chosen++) {
+      target -= min_dist[chosen];
+      if (target <= 0) {
+        break;
+      }
+    }
+  }
+
+  // Lloyd 迭代。分配时使用索引的距离，和查询、插入时选择链表的方式保持一致
+  const bool     normalize = index_meta_.ivfflat_options().distance == VectorDistanceType::COSINE;
+  vector<int>    assignment(sample_num, -1);
+  vector<int>    counts(list_num);
+  vector<double> sums(static_cast<size_t>(list_num) * dim_);
+  for (int iteration = 0; iteration < TRAIN_MAX_ITERATIONS; iteration++) {
+    int changed = 0;
+    for (int i = 0; i < sample_num; i++) {
+      int list = nearest_list(sample(i));
+      if (list != assignment[i]) {
+        assignment[i] = list;
+        changed++;
+      }
+    }
+    if (changed == 0) {
+      break;
+    }
+
+    std::fill(counts.begin(), counts.end(), 0);
+    std::fill(sums.begin(), sums.end(), 0.0);
+    for (int i = 0; i < sample_num; i++) {
+      counts[assignment[i]]++;
+      double *sum = sums.data() + static_cast<size_t>(assignment[i]) * dim_;
+      for (int d = 0; d < dim_; d++) {
+        sum[d] += sample(i)[d];
+      }
+    }
+
+    for (int list = 0; list < list_num; list++) {
+      // 没有分到向量的中心保持不变
+      if (counts[list] == 0) {
+        continue;
+      }
+      float        *center = centroids_.data() + static_cast<size_t>(list) * dim_;
+      const double *sum    = sums.data() + static_cast<size_t>(list) * dim_;
+      double        norm   = 0;
+      for (int d = 0; d < dim_; d++) {
+        center[d] = static_cast<float>(sum[d] / counts[list]);
+        norm += center[d] * center[d];
+      }
+      if (normalize && norm > 0) {
+        norm = sqrt(norm);
+        for (int d = 0; d < dim_; d++) {
+          center[d] = static_cast<float>(center[d] / norm);
+        }
+      }
+    }
+  }
+}
+
+RC IvfflatIndex::write_directory()
+{
+  const int list_num       = static_cast<int>(list_metas_.size());
+  const int lists_per_page = lists_per_dir_page();
+  const int dir_page_num   = (list_num + lists_per_page - 1) / lists_per_page;
+  const int max_dir_pages  = static_cast<int>((BP_PAGE_DATA_SIZE - sizeof(IvfflatFileHeader)) / sizeof(PageNum));
+  if (dir_page_num > max_dir_pages) {
+    LOG_WARN("too many lists for ivfflat index. lists=%d, dim=%d", list_num, dim_);
+    return RC::UNSUPPORTED;
+  }
+
+  RC rc = RC::SUCCESS;
+  for (int i = 0; i < dir_page_num; i++) {
+    Frame *frame = nullptr;
+    rc           = disk_buffer_pool_->allocate_page(&frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to allocate directory page of ivfflat index. rc=%s", strrc(rc));
+      return rc;
+    }
+    dir_pages_.push_back(frame->page_num());
+    disk_buffer_pool_->unpin_page(frame);
+  }
+
+  for (int list = 0; list < list_num; list++) {
+    rc = write_list_meta(list);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  Frame *frame = nullptr;
+  rc           = disk_buffer_pool_->get_this_page(IVFFLAT_HEADER_PAGE, &frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get header page of ivfflat index. rc=%s", strrc(rc));
+    return rc;
+  }
+  auto header          = reinterpret_cast<IvfflatFileHeader *>(frame->data());
+  header->lists        = list_num;
+  header->dir_page_num = dir_page_num;
+  memcpy(header->dir_pages, dir_pages_.data(), dir_page_num * sizeof(PageNum));
+  frame->mark_dirty();
+  disk_buffer_pool_->unpin_page(frame);
+  return RC::SUCCESS;
+}
+
+RC IvfflatIndex::write_list_meta(int list)
+{
+  const int lists_per_page = lists_per_dir_page();
+  Frame    *frame          = nullptr;
+  RC        rc             = disk_buffer_pool_->get_this_page(dir_pages_[list / lists_per_page], &frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get directory page of ivfflat index. list=%d, rc=%s", list, strrc(rc));
+    return rc;
+  }
+
+  char *data = frame->data() + (list % lists_per_page) * list_meta_size();
+  memcpy(data, &list_metas_[list], sizeof(IvfflatListMeta));
+  memcpy(data + sizeof(IvfflatListMeta), centroid(list), dim_ * sizeof(float));
+  frame->mark_dirty();
+  disk_buffer_pool_->unpin_page(frame);
+  return RC::SUCCESS;
+}
+
+RC IvfflatIndex::insert_entry(const char *record, const RID *rid)
+{
+  const float *vector = reinterpret_cast<const float *>(record + field_metas_[0].offset());
+
+  lock_guard<common::SharedMutex> guard(lock_);
+  if (list_metas_.empty()) {
+    LOG_WARN("ivfflat index has not been trained. index:%s", index_meta_.name());
+    return RC::INTERNAL;
+  }
+
+  const int        list = nearest_list(vector);
+  IvfflatListMeta &meta = list_metas_[list];
+
+  // 优先写入链表的第一个页面，满了就分配新页面放到链表头
+  RC                     rc          = RC::SUCCESS;
+  Frame                 *frame       = nullptr;
+  IvfflatListPageHeader *page_header = nullptr;
+  if (meta.head_page != BP_INVALID_PAGE_NUM) {
+    rc = disk_buffer_pool_->get_this_page(meta.head_page, &frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get list page of ivfflat index. page=%d, rc=%s", meta.head_page, strrc(rc));
+      return rc;
+    }
+    page_header = reinterpret_cast<IvfflatListPageHeader *>(frame->data());
+    if (page_header->count >= entries_per_list_page()) {
+      disk_buffer_pool_->unpin_page(frame);
+      frame = nullptr;
+    }
+  }
+
+  if (frame == nullptr) {
+    rc = disk_buffer_pool_->allocate_page(&frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to allocate list page of ivfflat index. rc=%s", strrc(rc));
+      return rc;
+    }
+    page_header            = reinterpret_cast<IvfflatListPageHeader *>(frame->data());
+    page_header->next_page = meta.head_page;
+    page_header->count     = 0;
+    meta.head_page         = frame->page_num();
+  }
+
+  char *entry = frame->data() + sizeof(IvfflatListPageHeader) + page_header->count * entry_size();
+  memcpy(entry, rid, sizeof(RID));
+  memcpy(entry + sizeof(RID), vector, dim_ * sizeof(float));
+  page_header->count++;
+  frame->mark_dirty();
+  disk_buffer_pool_->unpin_page(frame);
+
+  meta.count++;
+  return write_list_meta(list);
+}
+
+RC IvfflatIndex::delete_entry(const char *record, const RID *rid)
+{
+  const float *vector = reinterpret_cast<const float *>(record + field_metas_[0].offset());
+
+  lock_guard<common::SharedMutex> guard(lock_);
+  if (list_metas_.empty()) {
+    return RC::RECORD_INVALID_KEY;
+  }
+
+  const int        list = nearest_list(vector);
+  IvfflatListMeta &meta = list_metas_[list];
+  if (meta.head_page == BP_INVALID_PAGE_NUM) {
+    return RC::RECORD_INVALID_KEY;
+  }
+
+  Frame *head_frame = nullptr;
+  RC     rc         = disk_buffer_pool_->get_this_page(meta.head_page, &head_frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get list page of ivfflat index. page=%d, rc=%s", meta.head_page, strrc(rc));
+    return rc;
+  }
+
+  // 找到要删除的元素
+  Frame *found_frame = nullptr;
+  char  *found_entry = nullptr;
+  Frame *frame       = head_frame;
+  while (found_entry == nullptr) {
+    auto page_header = reinterpret_cast<IvfflatListPageHeader *>(frame->data());
+    for (int i = 0; i < page_header->count; i++) {
+      char *entry = frame->data() + sizeof(IvfflatListPageHeader) + i * entry_size();
+      if (*reinterpret_cast<const RID *>(entry) == *rid) {
+        found_frame = frame;
+        found_entry = entry;
+        break;
+      }
+    }
+
+    const PageNum next_page = page_header->next_page;
+    if (found_entry != nullptr || next_page == BP_INVALID_PAGE_NUM) {
+      break;
+    }
+    if (frame != head_frame) {
+      disk_buffer_pool_->unpin_page(frame);
+    }
+    rc = disk_buffer_pool_->get_this_page(next_page, &frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get list page of ivfflat index. page=%d, rc=%s", next_page, strrc(rc));
+      disk_buffer_pool_->unpin_page(head_frame);
+      return rc;
+    }
+  }
+
+  if (found_entry == nullptr) {
+    if (frame != head_frame) {
+      disk_buffer_pool_->unpin_page(frame);
+    }
+    disk_buffer_pool_->unpin_page(head_frame);
+    return RC::RECORD_INVALID_KEY;
+  }
+
+  // 用链表头页面的最后一个元素填补空位，保证只有链表头页面是不满的
+  auto  head_header = reinterpret_cast<IvfflatListPageHeader *>(head_frame->data());
+  char *last_entry  = head_frame->data() + sizeof(IvfflatListPageHeader) + (head_header->count - 1) * entry_size();
+  if (last_entry != found_entry) {
+    memcpy(found_entry, last_entry, entry_size());
+    found_frame->mark_dirty();
+  }
+  head_header->count--;
+  head_frame->mark_dirty();
+  if (found_frame != head_frame) {
+    disk_buffer_pool_->unpin_page(found_frame);
+  }
+
+  const PageNum head_page = head_frame->page_num();
+  const bool    empty     = head_header->count == 0;
+  if (empty) {
+    meta.head_page = head_header->next_page;
+  }
+  disk_buffer_pool_->unpin_page(head_frame);
+  if (empty) {
+    rc = disk_buffer_pool_->dispose_page(head_page);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to dispose list page of ivfflat index. page=%d, rc=%s", head_page, strrc(rc));
+    }
+  }
+
+  meta.count--;
+  return write_list_meta(list);
+}
+
+RC IvfflatIndex::ann_search(const vector<float> &base_vector, size_t limit, vector<RID> &rids)
+{
+  rids.clear();
+  if (static_cast<int>(base_vector.size()) != dim_) {
+    LOG_WARN("dimension of query vector mismatch. query dim=%d, index dim=%d", static_cast<int>(base_vector.size()), dim_);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  shared_lock<common::SharedMutex> guard(lock_);
+  const int list_num = static_cast<int>(list_metas_.size());
+  if (limit == 0 || list_num == 0) {
+    return RC::SUCCESS;
+  }
+
+  // 选出离查询向量最近的 probes 个链表
+  const float          *query  = base_vector.data();
+  const int             probes = min(index_meta_.ivfflat_options().probes, list_num);
+  vector<pair<float, int>> list_dists;
+  list_dists.reserve(list_num);
+  for (int list = 0; list < list_num; list++) {
+    list_dists.emplace_back(distance_key(query, centroid(list)), list);
+  }
+  partial_sort(list_dists.begin(), list_dists.begin() + probes, list_dists.end());
+
+  // 大顶堆中保留当前最近的 limit 个向量，堆顶是其中最远的
+  using Candidate = pair<float, RID>;
+  auto less = [](const Candidate &a, const Candidate &b) { return a.first < b.first; };
+  vector<Candidate> heap;
+  heap.reserve(limit + 1);
+
+  RC rc = RC::SUCCESS;
+  for (int probe = 0; probe < probes && OB_SUCC(rc); probe++) {
+    PageNum page_num = list_metas_[list_dists[probe].second].head_page;
+    while (page_num != BP_INVALID_PAGE_NUM) {
+      Frame *frame = nullptr;
+      rc           = disk_buffer_pool_->get_this_page(page_num, &frame);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to get list page of ivfflat index. page=%d, rc=%s", page_num, strrc(rc));
+        break;
+      }
+
+      auto page_header = reinterpret_cast<const IvfflatListPageHeader *>(frame->data());
+      for (int i = 0; i < page_header->count; i++) {
+        const char  *entry  = frame->data() + sizeof(IvfflatListPageHeader) + i * entry_size();
+        const float *vector = reinterpret_cast<const float *>(entry + sizeof(RID));
+        const float  dist   = distance_key(query, vector);
+        if (heap.size() < limit) {
+          heap.emplace_back(dist, *reinterpret_cast<const RID *>(entry));
+          push_heap(heap.begin(), heap.end(), less);
+        } else if (dist < heap.front().first) {
+          pop_heap(heap.begin(), heap.end(), less);
+          heap.back() = Candidate(dist, *reinterpret_cast<const RID *>(entry));
+          push_heap(heap.begin(), heap.end(), less);
+        }
+      }
+      page_num = page_header->next_page;
+      disk_buffer_pool_->unpin_page(frame);
+    }
+  }
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  sort_heap(heap.begin(), heap.end(), less);
+  rids.reserve(heap.size());
+  for (const Candidate &candidate : heap) {
+    rids.push_back(candidate.second);
+  }
+  return RC::SUCCESS;
+}
+
+RC IvfflatIndex::sync()
+{
+  lock_guard<common::SharedMutex> guard(lock_);
+  return disk_buffer_pool_->flush_all_pages();
+}
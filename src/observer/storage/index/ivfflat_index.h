@@ -10,40 +10,142 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/lang/mutex.h"
+#include "storage/buffer/disk_buffer_pool.h"
 #include "storage/index/index.h"
 
+class LogHandler;
+class RecordScanner;
+
+/**
+ * @brief ivfflat 索引文件的文件头，保存在索引文件的第一个页面
+ * @ingroup Index
+ * @details 每个链表的元数据（链表头页面、元素个数和聚类中心）连续保存在若干个目录页中，
+ * 目录页的页号跟在文件头的后面。
+ */
+struct IvfflatFileHeader
+{
+  int32_t dim;           ///< 向量的维度
+  int32_t lists;         ///< 链表的个数，训练之前是0
+  int32_t dir_page_num;  ///< 目录页的个数
+  PageNum dir_pages[0];  ///< 目录页的页号
+};
+
+/**
+ * @brief 一个倒排链表的元数据，保存在目录页中，后面紧跟着 dim 个 float 表示聚类中心
+ * @ingroup Index
+ */
+struct IvfflatListMeta
+{
+  PageNum head_page;  ///< 链表的第一个页面，BP_INVALID_PAGE_NUM 表示链表为空
+  int32_t count;      ///< 链表中元素的个数
+};
+
+/**
+ * @brief 倒排链表页面的页头，后面是 count 个元素，每个元素是 RID 和向量
+ * @ingroup Index
+ * @details 新元素总是写到链表的第一个页面，满了就分配一个新页面作为链表头，
+ * 删除时用第一个页面的最后一个元素填补空位，所以只有第一个页面可能是不满的。
+ */
+struct IvfflatListPageHeader
+{
+  PageNum next_page;  ///< 链表中的下一个页面
+  int32_t count;      ///< 当前页面中元素的个数
+};
+
 /**
  * @brief ivfflat 向量索引
  * @ingroup Index
+ * @details 先用 k-means 把向量聚成 lists 个类，每个类对应一个倒排链表，向量放到离它最近的聚类中心的链表中。
+ * 查询时只扫描离查询向量最近的 probes 个链表，用精度换取速度。
+ * 聚类中心只在建索引时训练一次，之后插入的向量直接放到最近的链表中。
+ * 索引页面不记录 redo 日志，数据在 sync 时刷盘。
  */
 class IvfflatIndex : public Index
 {
 public:
-  IvfflatIndex(){};
-  virtual ~IvfflatIndex() noexcept {};
+  IvfflatIndex() = default;
+  virtual ~IvfflatIndex() noexcept;
 
-  RC create(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta)
-  {
-    return RC::UNIMPLEMENTED;
-  };
-  RC open(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta)
+  RC create(Table *table, const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas)
+      override;
+  RC open(Table *table, const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas)
+      override;
+
+  RC create(LogHandler &log_handler, BufferPoolManager &bpm, const char *file_name, const IndexMeta &index_meta,
+      const vector<FieldMeta> &field_metas);
+  RC open(LogHandler &log_handler, BufferPoolManager &bpm, const char *file_name, const IndexMeta &index_meta,
+      const vector<FieldMeta> &field_metas);
+  RC close();
+
+  bool is_vector_index() override { return true; }
+
+  /**
+   * @brief 从表中采样向量训练聚类中心
+   * @details 只能在插入数据之前调用一次。数据少于 lists 时，链表的个数就是数据的个数；没有数据时只有一个链表。
+   */
+  RC train(RecordScanner &scanner);
+
+  /**
+   * @brief 近似最近邻查询
+   * @param[out] rids 最近的 limit 个向量的 RID，由近及远排列
+   */
+  RC ann_search(const vector<float> &base_vector, size_t limit, vector<RID> &rids);
+
+  RC insert_entry(const char *record, const RID *rid) override;
+  RC delete_entry(const char *record, const RID *rid) override;
+
+  /**
+   * @brief 向量索引不支持范围扫描
+   */
+  IndexScanner *create_scanner(const char *left_key, int left_len, bool left_inclusive, const char *right_key,
+      int right_len, bool right_inclusive) override
   {
+    return nullptr;
+  }
+
+  RC sync() override;
 
-    return RC::UNIMPLEMENTED;
-  };
+  int dim() const { return dim_; }
+  int lists() const { return static_cast<int>(list_metas_.size()); }
+
+private:
+  /// 目录中一个链表占用的空间
+  int list_meta_size() const { return static_cast<int>(sizeof(IvfflatListMeta) + dim_ * sizeof(float)); }
+  /// 链表中一个元素占用的空间
+  int entry_size() const { return static_cast<int>(sizeof(RID) + dim_ * sizeof(float)); }
+  int lists_per_dir_page() const { return BP_PAGE_DATA_SIZE / list_meta_size(); }
+  int entries_per_list_page() const
+  {
+    return static_cast<int>((BP_PAGE_DATA_SIZE - sizeof(IvfflatListPageHeader)) / entry_size());
+  }
 
-  vector<RID> ann_search(const vector<float> &base_vector, size_t limit) { return vector<RID>(); }
+  const float *centroid(int list) const { return centroids_.data() + static_cast<size_t>(list) * dim_; }
 
-  RC close() { return RC::UNIMPLEMENTED; }
+  /**
+   * @brief 按照距离排序的键，越小越近
+   */
+  float distance_key(const float *left, const float *right) const;
 
-  RC insert_entry(const char *record, const RID *rid) override { return RC::UNIMPLEMENTED; };
-  RC delete_entry(const char *record, const RID *rid) override { return RC::UNIMPLEMENTED; };
+  /// 离向量最近的聚类中心
+  int nearest_list(const float *vector) const;
 
-  RC sync() override { return RC::UNIMPLEMENTED; };
+  RC init_layout(const vector<FieldMeta> &field_metas);
+  void kmeans(const vector<float> &samples, int sample_num, int list_num);
+  RC write_directory();
+  RC write_list_meta(int list);
 
 private:
-  bool   inited_ = false;
-  Table *table_  = nullptr;
-  int    lists_  = 1;
-  int    probes_ = 1;
+  bool            inited_           = false;
+  Table          *table_            = nullptr;
+  DiskBufferPool *disk_buffer_pool_ = nullptr;
+  int             dim_              = 0;
+
+  /// 训练之后不变
+  vector<float>   centroids_;
+  vector<PageNum> dir_pages_;
+
+  vector<IvfflatListMeta> list_metas_;
+
+  common::SharedMutex lock_;
 };
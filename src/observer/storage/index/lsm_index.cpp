@@ -0,0 +1,222 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/index/lsm_index.h"
+#include "common/log/log.h"
+#include "oblsm/include/ob_lsm_iterator.h"
+#include "oblsm/include/ob_lsm_transaction.h"
+#include "storage/common/codec.h"
+#include "storage/table/lsm_table_engine.h"
+
+using namespace oceanbase;
+
+RC LsmIndex::create(Table *table, const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas)
+{
+  return open(table, file_name, index_meta, field_metas);
+}
+
+RC LsmIndex::open(Table *table, const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas)
+{
+  for (const FieldMeta &field_meta : field_metas) {
+    switch (field_meta.type()) {
+      case AttrType::INTS:
+      case AttrType::FLOATS:
+      case AttrType::CHARS:
+      case AttrType::DATES: break;
+      default: {
+        LOG_WARN("unsupported index field type. index=%s, field=%s, type=%s",
+                 index_meta.name(), field_meta.name(), attr_type_to_string(field_meta.type()));
+        return RC::UNSUPPORTED;
+      }
+    }
+  }
+  return Index::init(index_meta, field_metas);
+}
+
+RC LsmIndex::make_entry(const char *record, uint64_t row_id, string &key, string &value) const
+{
+  vector<Value> field_values;
+  for (const FieldMeta &field_meta : field_metas_) {
+    field_values.emplace_back(field_meta.type(), const_cast<char *>(record + field_meta.offset()), field_meta.len());
+  }
+  bytes index_key;
+  bytes row_key;
+  RC    rc = RC::SUCCESS;
+  if (OB_FAIL(rc = Codec::encode_index(table_id_, index_id_, field_values, row_id, index_key))) {
+    LOG_WARN("failed to encode index key. index=%s, rc=%s", index_meta_.name(), strrc(rc));
+    return rc;
+  }
+  if (OB_FAIL(rc = Codec::encode(table_id_, row_id, row_key))) {
+    LOG_WARN("failed to encode row key. index=%s, rc=%s", index_meta_.name(), strrc(rc));
+    return rc;
+  }
+  key.assign((const char *)index_key.data(), index_key.size());
+  value.assign((const char *)row_key.data(), row_key.size());
+  return rc;
+}
+
+RC LsmIndex::insert_entry(const char *record, const RID *rid)
+{
+  string key;
+  string value;
+  RC     rc = make_entry(record, LsmTableEngine::row_id(*rid), key, value);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  return lsm_->put(key, value);
+}
+
+RC LsmIndex::delete_entry(const char *record, const RID *rid)
+{
+  string key;
+  string value;
+  RC     rc = make_entry(record, LsmTableEngine::row_id(*rid), key, value);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  return lsm_->remove(key);
+}
+
+RC LsmIndex::encode_bound(const char *key, int len, string &bound) const
+{
+  bytes encoded;
+  RC    rc = Codec::encode_index_prefix(table_id_, index_id_, encoded);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to encode index prefix. index=%s, rc=%s", index_meta_.name(), strrc(rc));
+    return rc;
+  }
+  if (key != nullptr && field_metas_.size() == 1) {
+    Value value(field_metas_[0].type(), const_cast<char *>(key), len);
+    if (OB_FAIL(rc = Codec::encode_value(value, encoded))) {
+      LOG_WARN("failed to encode index key. index=%s, rc=%s", index_meta_.name(), strrc(rc));
+      return rc;
+    }
+  } else if (key != nullptr) {
+    // 多字段索引的边界可以只包含前面几个字段，每个字段都占用字段定义的长度。
+    // 各个字段的编码是自定界的，所以前缀字段的编码也是完整索引键编码的前缀
+    for (int offset = 0, i = 0; i < static_cast<int>(field_metas_.size()) && offset < len; i++) {
+      const FieldMeta &field_meta = field_metas_[i];
+      Value value(field_meta.type(), const_cast<char *>(key + offset), std::min(field_meta.len(), len - offset));
+      if (OB_FAIL(rc = Codec::encode_value(value, encoded))) {
+        LOG_WARN("failed to encode index key. index=%s, rc=%s", index_meta_.name(), strrc(rc));
+        return rc;
+      }
+      offset += field_meta.len();
+    }
+  }
+  bound.assign((const char *)encoded.data(), encoded.size());
+  return rc;
+}
+
+IndexScanner *LsmIndex::create_scanner(
+    const char *left_key, int left_len, bool left_inclusive, const char *right_key, int right_len, bool right_inclusive)
+{
+  return create_scanner_with_trx(nullptr, left_key, left_len, left_inclusive, right_key, right_len, right_inclusive);
+}
+
+IndexScanner *LsmIndex::create_scanner_with_trx(Trx *trx, const char *left_key, int left_len, bool left_inclusive,
+    const char *right_key, int right_len, bool right_inclusive)
+{
+  string prefix;
+  string left_bound;
+  string right_bound;
+  if (OB_FAIL(encode_bound(nullptr, 0, prefix))) {
+    return nullptr;
+  }
+  if (left_key != nullptr && OB_FAIL(encode_bound(left_key, left_len, left_bound))) {
+    return nullptr;
+  }
+  if (right_key != nullptr && OB_FAIL(encode_bound(right_key, right_len, right_bound))) {
+    return nullptr;
+  }
+
+  // 索引项与记录在同一个事务中写入，事务中的扫描要能看到自己写入的索引项
+  ObLsmTransaction *txn           = LsmTableEngine::lsm_trx(trx);
+  ObLsmIterator    *lsm_iter      = txn == nullptr ? lsm_->new_iterator(ObLsmReadOptions())
+                                                   : txn->new_iterator(ObLsmReadOptions());
+  LsmIndexScanner  *index_scanner = new LsmIndexScanner(lsm_iter, table_id_);
+  RC rc = index_scanner->open(std::move(prefix), std::move(left_bound), left_inclusive, std::move(right_bound), right_inclusive);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open index scanner. index=%s, rc=%s", index_meta_.name(), strrc(rc));
+    delete index_scanner;
+    return nullptr;
+  }
+  return index_scanner;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+LsmIndexScanner::~LsmIndexScanner() noexcept
+{
+  delete iter_;
+  iter_ = nullptr;
+}
+
+RC LsmIndexScanner::open(string prefix, string left_bound, bool left_inclusive, string right_bound, bool right_inclusive)
+{
+  if (iter_ == nullptr) {
+    return RC::INTERNAL;
+  }
+
+  prefix_          = std::move(prefix);
+  right_bound_     = std::move(right_bound);
+  right_inclusive_ = right_inclusive;
+
+  if (left_bound.empty()) {
+    iter_->seek(prefix_);
+    return RC::SUCCESS;
+  }
+
+  // 索引键的编码不会是另一个索引键编码的前缀，所以以左边界为前缀的索引项就是索引键(或者多字段索引键的前缀)与左边界相等的索引项
+  iter_->seek(left_bound);
+  if (!left_inclusive) {
+    while (iter_->valid() && iter_->key().starts_with(left_bound)) {
+      iter_->next();
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC LsmIndexScanner::next_entry(RID *rid)
+{
+  if (!iter_->valid()) {
+    return RC::RECORD_EOF;
+  }
+
+  string_view key = iter_->key();
+  if (!key.starts_with(prefix_)) {
+    return RC::RECORD_EOF;
+  }
+  if (!right_bound_.empty()) {
+    int cmp = key.substr(0, right_bound_.size()).compare(right_bound_);
+    if (cmp > 0 || (cmp == 0 && !right_inclusive_)) {
+      return RC::RECORD_EOF;
+    }
+  }
+
+  string_view value = iter_->value();
+  bytes       row_key(value.begin(), value.end());
+  int64_t     table_id = 0;
+  uint64_t    row_id   = 0;
+  RC          rc       = Codec::decode(row_key, table_id, row_id);
+  if (OB_FAIL(rc) || table_id != table_id_) {
+    LOG_WARN("failed to decode row key of index entry. rc=%s", strrc(rc));
+    return OB_FAIL(rc) ? rc : RC::INTERNAL;
+  }
+
+  *rid = LsmTableEngine::make_rid(row_id);
+  iter_->next();
+  return RC::SUCCESS;
+}
+
+RC LsmIndexScanner::destroy()
+{
+  delete this;
+  return RC::SUCCESS;
+}
@@ -0,0 +1,107 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "storage/index/index.h"
+#include "oblsm/include/ob_lsm.h"
+
+/**
+ * @brief lsm-tree 上的二级索引
+ * @ingroup Index
+ * @details 每个索引项以 key-value 的形式保存在 oblsm 中，key 是 Codec::encode_index(table_id, index_id, 索引字段的值, row_id)，
+ * value 是对应记录的 key（即 Codec::encode(table_id, row_id)）。
+ * 索引项与记录由 LsmTableEngine 放在同一个写批次或同一个事务中写入，保证两者的原子性。
+ */
+class LsmIndex : public Index
+{
+public:
+  LsmIndex(oceanbase::ObLsm *lsm, int64_t table_id, int64_t index_id)
+      : lsm_(lsm), table_id_(table_id), index_id_(index_id)
+  {}
+  virtual ~LsmIndex() noexcept = default;
+
+  /**
+   * @brief 索引项直接保存在 oblsm 中，不需要单独的文件，file_name 会被忽略
+   */
+  RC create(
+      Table *table, const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas) override;
+  RC open(
+      Table *table, const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas) override;
+
+  /**
+   * @brief 生成一条记录对应的索引项
+   *
+   * @param record 记录的数据
+   * @param row_id 记录的 row_id
+   * @param[out] key 索引项的 key
+   * @param[out] value 索引项的 value，即记录的 key
+   */
+  RC make_entry(const char *record, uint64_t row_id, string &key, string &value) const;
+
+  RC insert_entry(const char *record, const RID *rid) override;
+  RC delete_entry(const char *record, const RID *rid) override;
+
+  IndexScanner *create_scanner(const char *left_key, int left_len, bool left_inclusive, const char *right_key,
+      int right_len, bool right_inclusive) override;
+  IndexScanner *create_scanner_with_trx(Trx *trx, const char *left_key, int left_len, bool left_inclusive,
+      const char *right_key, int right_len, bool right_inclusive) override;
+
+  /**
+   * @brief 索引项随 oblsm 的 WAL 一起持久化
+   */
+  RC sync() override { return RC::SUCCESS; }
+
+  int64_t index_id() const { return index_id_; }
+
+private:
+  /**
+   * @brief 编码 (table_id, index_id, 索引键)，作为扫描的边界
+   */
+  RC encode_bound(const char *key, int len, string &bound) const;
+
+private:
+  oceanbase::ObLsm *lsm_      = nullptr;
+  int64_t           table_id_ = 0;
+  int64_t           index_id_ = 0;
+};
+
+/**
+ * @brief lsm-tree 二级索引的扫描器
+ * @ingroup Index
+ * @details 使用 ObLsmIterator::seek 定位到左边界，然后按照 key 的顺序遍历到右边界
+ */
+class LsmIndexScanner : public IndexScanner
+{
+public:
+  LsmIndexScanner(oceanbase::ObLsmIterator *iter, int64_t table_id) : iter_(iter), table_id_(table_id) {}
+  ~LsmIndexScanner() noexcept override;
+
+  /**
+   * @brief 打开扫描器
+   *
+   * @param prefix 当前索引所有索引项的公共前缀
+   * @param left_bound 左边界，为空表示从头开始
+   * @param left_inclusive 是否包含左边界
+   * @param right_bound 右边界，为空表示一直扫描到索引的结尾
+   * @param right_inclusive 是否包含右边界
+   */
+  RC open(string prefix, string left_bound, bool left_inclusive, string right_bound, bool right_inclusive);
+
+  RC next_entry(RID *rid) override;
+  RC destroy() override;
+
+private:
+  oceanbase::ObLsmIterator *iter_     = nullptr;
+  int64_t                   table_id_ = 0;
+  string                    prefix_;
+  string                    right_bound_;
+  bool                      right_inclusive_ = true;
+};
@@ -26,7 +26,7 @@ RC HeapRecordScanner::open_scan()
   if (table_ == nullptr || table_->table_meta().storage_format() == StorageFormat::ROW_FORMAT) {
     record_page_handler_ = new RowRecordPageHandler();
   } else {
-    record_page_handler_ = new PaxRecordPageHandler();
+    record_page_handler_ = new PaxRecordPageHandler(table_->table_meta().storage_format());
   }
 
   return rc;
@@ -11,6 +11,7 @@ See the Mulan PSL v2 for more details. */
 #include "storage/record/lsm_record_scanner.h"
 #include "storage/common/codec.h"
 #include "storage/trx/lsm_mvcc_trx.h"
+#include "storage/table/lsm_table_engine.h"
 
 RC LsmRecordScanner::open_scan()
 {
@@ -19,19 +20,22 @@ RC LsmRecordScanner::open_scan()
     delete lsm_iter_;
     lsm_iter_ = nullptr;
   }
-  if (trx_->type() == TrxKit::Type::VACUOUS) {
+  if (trx_ == nullptr || trx_->type() == TrxKit::Type::VACUOUS) {
     lsm_iter_ = oblsm_->new_iterator(ObLsmReadOptions());
   } else if (trx_->type() == TrxKit::Type::LSM) {
     auto lsm_trx = dynamic_cast<LsmMvccTrx *>(trx_);
+    lsm_trx->start_if_need();
     lsm_iter_ = lsm_trx->get_trx()->new_iterator(ObLsmReadOptions());
   }
+  // 同一个表的索引项和记录在同一个 key 空间中，只遍历记录的前缀 ("t", table_id, "r")
   bytes encoded_key;
-  rc = Codec::encode_without_rid(table_->table_id(), encoded_key);
+  rc = Codec::encode_table_prefix(table_->table_id(), encoded_key);
   if (RC::SUCCESS != rc) {
-    LOG_WARN("failed to encode table id");
+    LOG_WARN("failed to encode table prefix");
     return rc;
   }
-  lsm_iter_->seek(string_view((char *)encoded_key.data(), encoded_key.size()));
+  table_prefix_.assign((char *)encoded_key.data(), encoded_key.size());
+  lsm_iter_->seek(table_prefix_);
   tuple_.set_schema(table_, table_->table_meta().field_metas());
   return rc;
 }
@@ -48,17 +52,19 @@ RC LsmRecordScanner::close_scan()
 
 RC LsmRecordScanner::next(Record &record)
 {
-  if (lsm_iter_->valid()) {
+  if (lsm_iter_->valid() && lsm_iter_->key().starts_with(table_prefix_)) {
     string_view lsm_value = lsm_iter_->value();
     string_view lsm_key = lsm_iter_->key();
     int64_t table_id = 0;
+    uint64_t row_id = 0;
     bytes lsm_key_bytes(lsm_key.begin(), lsm_key.end());
-    Codec::decode(lsm_key_bytes, table_id);
-    if (table_id != table_->table_id()) {
-      LOG_TRACE("table id not match, table id: %ld", table_->table_id());
-      return RC::RECORD_EOF;
+    RC rc = Codec::decode(lsm_key_bytes, table_id, row_id);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to decode lsm key. table id: %ld, rc=%s", table_->table_id(), strrc(rc));
+      return rc;
     }
     record.set_key(string(lsm_key));
+    record.set_rid(LsmTableEngine::make_rid(row_id));
     record.copy_data((char *)lsm_value.data(), lsm_value.length());
     lsm_iter_->next();
     return RC::SUCCESS;
@@ -45,6 +45,7 @@ private:
   ObLsm         *oblsm_    = nullptr;
   Trx           *trx_      = nullptr;
   ObLsmIterator *lsm_iter_ = nullptr;
+  string         table_prefix_;  ///< 表中记录的 key 的前缀
   RowTuple       tuple_;
   Record         record_;
 };
\ No newline at end of file
@@ -0,0 +1,271 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/record/pax_encoding.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/string_view.h"
+#include "common/lang/unordered_map.h"
+
+#include <climits>
+#include <cstring>
+
+#ifdef USE_SIMD
+#include "common/math/simd_util.h"
+#endif
+
+static int align4(int size) { return (size + 3) & ~3; }
+
+static int bit_width_of(uint32_t value) { return value == 0 ? 0 : 32 - __builtin_clz(value); }
+
+/// 按位压缩 rows 个值需要的空间，位数为 0 时不需要保存任何数据
+static int packed_size(int rows, int bit_width)
+{
+  return bit_width == 0 ? 0 : (rows * bit_width + 7) / 8 + PaxColumnCodec::PACK_PADDING;
+}
+
+/**
+ * @brief 第 i 个值保存在第 [i * bit_width, (i + 1) * bit_width) 位中，低位在前
+ * @details dst 需要预先清零
+ */
+static void pack_bits(const uint32_t *values, int rows, int bit_width, char *dst)
+{
+  if (bit_width == 0) {
+    return;
+  }
+  for (int i = 0; i < rows; i++) {
+    const int64_t bit = static_cast<int64_t>(i) * bit_width;
+    uint64_t      word;
+    memcpy(&word, dst + (bit >> 3), sizeof(word));
+    word |= static_cast<uint64_t>(values[i]) << (bit & 7);
+    memcpy(dst + (bit >> 3), &word, sizeof(word));
+  }
+}
+
+static void unpack_bits(const char *packed, int bit_width, int start, int count, uint32_t *dst)
+{
+  if (bit_width == 0) {
+    memset(dst, 0, sizeof(uint32_t) * count);
+    return;
+  }
+
+  const uint64_t mask = bit_width == 32 ? 0xFFFFFFFFULL : (1ULL << bit_width) - 1;
+  int            i    = 0;
+#ifdef USE_SIMD
+  // 不超过 25 位时，每个值都在从它所在字节开始的 4 个字节之内，可以用 gather 一次取 8 个值
+  if (bit_width <= 25) {
+    const __m256i lanes      = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i width_vec  = _mm256_set1_epi32(bit_width);
+    const __m256i mask_vec   = _mm256_set1_epi32(static_cast<int>(mask));
+    const __m256i seven      = _mm256_set1_epi32(7);
+    const int    *packed_int = reinterpret_cast<const int *>(packed);
+    for (; i + SIMD_WIDTH <= count; i += SIMD_WIDTH) {
+      __m256i index  = _mm256_add_epi32(_mm256_set1_epi32(start + i), lanes);
+      __m256i bits   = _mm256_mullo_epi32(index, width_vec);
+      __m256i words  = _mm256_i32gather_epi32(packed_int, _mm256_srli_epi32(bits, 3), 1);
+      __m256i values = _mm256_srlv_epi32(words, _mm256_and_si256(bits, seven));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_and_si256(values, mask_vec));
+    }
+  }
+#endif
+  for (; i < count; i++) {
+    const int64_t bit = static_cast<int64_t>(start + i) * bit_width;
+    uint64_t      word;
+    memcpy(&word, packed + (bit >> 3), sizeof(word));
+    dst[i] = static_cast<uint32_t>((word >> (bit & 7)) & mask);
+  }
+}
+
+void PaxColumnCodec::encode(
+    AttrType type, int attr_len, const char *values, int rows, EncodedColumnMeta &meta, vector<char> &payload,
+    bool plain /* = false */)
+{
+  memset(&meta, 0, sizeof(meta));
+  meta.attr_len = attr_len;
+
+  auto value_at = [values, attr_len](int row) { return values + static_cast<size_t>(row) * attr_len; };
+
+  const int plain_size = rows * attr_len;
+  if (plain) {
+    meta.encoding = static_cast<int32_t>(PaxEncoding::PLAIN);
+    meta.size     = plain_size;
+    payload.assign(values, values + plain_size);
+    return;
+  }
+
+  // 先计算各种编码之后的大小
+  int runs = rows > 0 ? 1 : 0;
+  for (int i = 1; i < rows; i++) {
+    if (memcmp(value_at(i), value_at(i - 1), attr_len) != 0) {
+      runs++;
+    }
+  }
+  const int rle_size = align4(runs * static_cast<int>(sizeof(uint16_t))) + runs * attr_len;
+
+  int     for_size  = INT_MAX;
+  int     for_width = 0;
+  int32_t min_value = 0;
+  if ((type == AttrType::INTS || type == AttrType::DATES) && attr_len == sizeof(int32_t) && rows > 0) {
+    int32_t max_value;
+    memcpy(&min_value, value_at(0), sizeof(int32_t));
+    max_value = min_value;
+    for (int i = 1; i < rows; i++) {
+      int32_t value;
+      memcpy(&value, value_at(i), sizeof(int32_t));
+      min_value = std::min(min_value, value);
+      max_value = std::max(max_value, value);
+    }
+    for_width = bit_width_of(static_cast<uint32_t>(static_cast<int64_t>(max_value) - min_value));
+    for_size  = packed_size(rows, for_width);
+  }
+
+  // 不同的值超过一半时字典编码没有什么收益，不再继续统计
+  unordered_map<string_view, uint32_t> dictionary;
+  vector<uint32_t>                     codes(rows);
+  vector<int>                          dictionary_rows;
+  int                                  dictionary_size = INT_MAX;
+  for (int i = 0; i < rows; i++) {
+    auto [iter, inserted] = dictionary.emplace(string_view(value_at(i), attr_len), dictionary_rows.size());
+    if (inserted) {
+      dictionary_rows.push_back(i);
+      if (static_cast<int>(dictionary_rows.size()) > rows / 2) {
+        break;
+      }
+    }
+    codes[i] = iter->second;
+  }
+  const int dictionary_width = bit_width_of(static_cast<uint32_t>(dictionary_rows.size()) - 1);
+  if (rows > 0 && static_cast<int>(dictionary_rows.size()) <= rows / 2) {
+    dictionary_size = align4(static_cast<int>(dictionary_rows.size()) * attr_len) + packed_size(rows, dictionary_width);
+  }
+
+  PaxEncoding encoding = PaxEncoding::PLAIN;
+  int         size     = plain_size;
+  if (for_size < size) {
+    encoding = PaxEncoding::FOR_BITPACK;
+    size     = for_size;
+  }
+  if (dictionary_size < size) {
+    encoding = PaxEncoding::DICTIONARY;
+    size     = dictionary_size;
+  }
+  if (rle_size < size) {
+    encoding = PaxEncoding::RLE;
+    size     = rle_size;
+  }
+
+  meta.encoding = static_cast<int32_t>(encoding);
+  meta.size     = size;
+  payload.assign(size, 0);
+  switch (encoding) {
+    case PaxEncoding::PLAIN: {
+      if (size > 0) {
+        memcpy(payload.data(), values, size);
+      }
+    } break;
+
+    case PaxEncoding::RLE: {
+      meta.value_count   = runs;
+      uint16_t *ends     = reinterpret_cast<uint16_t *>(payload.data());
+      char     *run_data = payload.data() + align4(runs * static_cast<int>(sizeof(uint16_t)));
+      int       run      = 0;
+      memcpy(run_data, value_at(0), attr_len);
+      for (int i = 1; i < rows; i++) {
+        if (memcmp(value_at(i), value_at(i - 1), attr_len) != 0) {
+          ends[run++] = static_cast<uint16_t>(i);
+          memcpy(run_data + static_cast<size_t>(run) * attr_len, value_at(i), attr_len);
+        }
+      }
+      ends[run] = static_cast<uint16_t>(rows);
+    } break;
+
+    case PaxEncoding::FOR_BITPACK: {
+      meta.bit_width = for_width;
+      meta.reference = min_value;
+      for (int i = 0; i < rows; i++) {
+        int32_t value;
+        memcpy(&value, value_at(i), sizeof(int32_t));
+        codes[i] = static_cast<uint32_t>(value) - static_cast<uint32_t>(min_value);
+      }
+      pack_bits(codes.data(), rows, for_width, payload.data());
+    } break;
+
+    case PaxEncoding::DICTIONARY: {
+      meta.bit_width   = dictionary_width;
+      meta.value_count = static_cast<int32_t>(dictionary_rows.size());
+      for (size_t code = 0; code < dictionary_rows.size(); code++) {
+        memcpy(payload.data() + code * attr_len, value_at(dictionary_rows[code]), attr_len);
+      }
+      const int codes_offset = align4(meta.value_count * attr_len);
+      pack_bits(codes.data(), rows, dictionary_width, payload.data() + codes_offset);
+    } break;
+  }
+}
+
+void PaxColumnCodec::decode_codes(
+    const EncodedColumnMeta &meta, const char *payload, int start, int count, uint32_t *dst)
+{
+  unpack_bits(payload + align4(meta.value_count * meta.attr_len), meta.bit_width, start, count, dst);
+}
+
+void PaxColumnCodec::decode(const EncodedColumnMeta &meta, const char *payload, int start, int count, char *dst)
+{
+  const int attr_len = meta.attr_len;
+  switch (static_cast<PaxEncoding>(meta.encoding)) {
+    case PaxEncoding::PLAIN: {
+      memcpy(dst, payload + static_cast<size_t>(start) * attr_len, static_cast<size_t>(count) * attr_len);
+    } break;
+
+    case PaxEncoding::RLE: {
+      const uint16_t *ends     = reinterpret_cast<const uint16_t *>(payload);
+      const char     *run_data = payload + align4(meta.value_count * static_cast<int>(sizeof(uint16_t)));
+      int             run      = std::upper_bound(ends, ends + meta.value_count, start) - ends;
+      for (int row = start, end = start + count; row < end; run++) {
+        const int   run_end = std::min(static_cast<int>(ends[run]), end);
+        const char *value   = run_data + static_cast<size_t>(run) * attr_len;
+        for (; row < run_end; row++, dst += attr_len) {
+          memcpy(dst, value, attr_len);
+        }
+      }
+    } break;
+
+    case PaxEncoding::FOR_BITPACK: {
+      // 对齐的时候直接解码到目标内存中，否则分批解码再复制
+      const uint32_t reference = static_cast<uint32_t>(meta.reference);
+      if (reinterpret_cast<uintptr_t>(dst) % alignof(uint32_t) == 0) {
+        uint32_t *values = reinterpret_cast<uint32_t *>(dst);
+        unpack_bits(payload, meta.bit_width, start, count, values);
+        for (int i = 0; i < count; i++) {
+          values[i] += reference;
+        }
+      } else {
+        uint32_t values[256];
+        for (int i = 0; i < count; i += 256) {
+          const int batch = std::min(256, count - i);
+          unpack_bits(payload, meta.bit_width, start + i, batch, values);
+          for (int j = 0; j < batch; j++) {
+            values[j] += reference;
+          }
+          memcpy(dst + static_cast<size_t>(i) * sizeof(uint32_t), values, batch * sizeof(uint32_t));
+        }
+      }
+    } break;
+
+    case PaxEncoding::DICTIONARY: {
+      uint32_t codes[256];
+      for (int i = 0; i < count; i += 256) {
+        const int batch = std::min(256, count - i);
+        decode_codes(meta, payload, start + i, batch, codes);
+        for (int j = 0; j < batch; j++, dst += attr_len) {
+          memcpy(dst, dictionary_value(meta, payload, codes[j]), attr_len);
+        }
+      }
+    } break;
+  }
+}
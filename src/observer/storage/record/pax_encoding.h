@@ -0,0 +1,99 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/lang/vector.h"
+#include "common/type/attr_type.h"
+
+/**
+ * @brief 压缩的 PAX 页面中一列数据的编码方式
+ * @ingroup RecordManager
+ */
+enum class PaxEncoding : int32_t
+{
+  PLAIN = 0,    ///< 不压缩，与未压缩页面中的格式相同
+  RLE,          ///< 连续相同的值只保存一次：uint16_t ends[runs] | values[runs]
+  FOR_BITPACK,  ///< 减去最小值之后按位压缩，只用于 4 字节的整数：packed bits
+  DICTIONARY,   ///< 页面内的字典加上按位压缩的编号：values[dict size] | packed codes
+};
+
+/**
+ * @brief 一列编码之后的数据的描述信息，保存在压缩的 PAX 页面中
+ * @ingroup RecordManager
+ */
+struct EncodedColumnMeta
+{
+  int32_t encoding;     ///< PaxEncoding
+  int32_t offset;       ///< 编码之后的数据在页面中的偏移
+  int32_t size;         ///< 编码之后的数据的大小
+  int32_t attr_len;     ///< 每个值的长度
+  int32_t bit_width;    ///< FOR_BITPACK/DICTIONARY 中每个值占用的位数
+  int32_t reference;    ///< FOR_BITPACK 的基准值，即最小值
+  int32_t value_count;  ///< RLE 中 run 的个数，DICTIONARY 中字典的大小
+  int32_t reserved;
+};
+
+/**
+ * @brief 压缩的 PAX 页面中的压缩信息，后面紧跟着每一列的 EncodedColumnMeta
+ * @ingroup RecordManager
+ */
+struct PaxCompressionHeader
+{
+  int32_t sealed_rows;    ///< 按列编码保存的记录数
+  int32_t max_capacity;   ///< 页面最多能容纳的记录数，bitmap 按照这个大小分配
+  int32_t plain_columns;  ///< 前面这些列（事务字段）总是使用 PLAIN 编码，提交、删除时可以原地修改
+  int32_t reserved;
+};
+
+/**
+ * @brief 压缩的 PAX 页面中列数据的编码和解码
+ * @ingroup RecordManager
+ * @details 编码时分别计算每种编码之后的大小，选择最小的一种。解码时直接写到调用者给出的内存中，
+ * 通常是 Column 的内存，不需要先解码到临时的缓存再复制。
+ */
+class PaxColumnCodec
+{
+public:
+  /**
+   * @brief 编码一列数据
+   * @param type 列的类型，只有 INTS 和 DATES 会使用 FOR_BITPACK
+   * @param values 连续存放的 rows 个值，每个值 attr_len 字节
+   * @param meta 返回编码方式等信息，offset 由调用者填写
+   * @param payload 返回编码之后的数据
+   * @param plain 为 true 时不压缩，总是使用 PLAIN 编码
+   */
+  static void encode(AttrType type, int attr_len, const char *values, int rows, EncodedColumnMeta &meta,
+      vector<char> &payload, bool plain = false);
+
+  /**
+   * @brief 解码 [start, start + count) 行的数据，写到 dst 中，每个值 attr_len 字节
+   */
+  static void decode(const EncodedColumnMeta &meta, const char *payload, int start, int count, char *dst);
+
+  /**
+   * @brief 解码 DICTIONARY 编码中 [start, start + count) 行的字典编号
+   */
+  static void decode_codes(const EncodedColumnMeta &meta, const char *payload, int start, int count, uint32_t *dst);
+
+  /**
+   * @brief DICTIONARY 编码中编号为 code 的值
+   */
+  static const char *dictionary_value(const EncodedColumnMeta &meta, const char *payload, int code)
+  {
+    return payload + static_cast<size_t>(code) * meta.attr_len;
+  }
+
+  /// 按位压缩的数据后面多留的字节，解码时可以一次读取 8 个字节而不越界
+  static constexpr int PACK_PADDING = 8;
+};
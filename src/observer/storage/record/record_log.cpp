@@ -85,8 +85,8 @@ RC RecordLogHandler::init(
   return rc;
 }
 
-// data is the column index in page
-RC RecordLogHandler::init_new_page(Frame *frame, PageNum page_num, span<const char> data)
+// data is the column index and zone maps in page
+RC RecordLogHandler::init_new_page(Frame *frame, PageNum page_num, int column_num, span<const char> data)
 {
   const int        log_payload_size = RecordLogHeader::SIZE + data.size();
   vector<char>     log_payload(log_payload_size);
@@ -96,7 +96,7 @@ RC RecordLogHandler::init_new_page(Frame *frame, PageNum page_num, span<const ch
   header->page_num        = page_num;
   header->record_size     = record_size_;
   header->storage_format  = static_cast<int>(storage_format_);
-  header->column_num      = data.size() / sizeof(int);
+  header->column_num      = column_num;
   if (data.size() > 0) {
     memcpy(log_payload.data() + RecordLogHeader::SIZE, data.data(), data.size());
   }
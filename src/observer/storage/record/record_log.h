@@ -97,9 +97,10 @@ public:
    * 或者页面在访问时会出现异常。
    * @param frame 页帧
    * @param page_num 页面编号
-   * @param data 页面数据目前主要是 `column index`
+   * @param column_num 页面中的列数，只有 PAX 格式的页面才有
+   * @param data 页面数据目前主要是 `column index` 和 `zone map`
    */
-  RC init_new_page(Frame *frame, PageNum page_num, span<const char> data);
+  RC init_new_page(Frame *frame, PageNum page_num, int column_num, span<const char> data);
 
   /**
    * @brief 插入一条记录
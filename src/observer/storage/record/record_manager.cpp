@@ -12,10 +12,12 @@ See the Mulan PSL v2 for more details. */
 // Created by Meiyi & Longda on 2021/4/13.
 //
 #include "storage/record/record_manager.h"
+#include "common/lang/algorithm.h"
 #include "common/log/log.h"
 #include "storage/common/condition_filter.h"
 #include "storage/trx/trx.h"
 #include "storage/clog/log_handler.h"
+#include "oblsm/include/ob_lsm_iterator.h"
 
 using namespace common;
 
@@ -25,7 +27,7 @@ RecordPageHandler   *RecordPageHandler::create(StorageFormat format)
   if (format == StorageFormat::ROW_FORMAT) {
     return new RowRecordPageHandler();
   } else {
-    return new PaxRecordPageHandler();
+    return new PaxRecordPageHandler(format);
   }
 }
 /**
@@ -42,13 +44,27 @@ int align8(int size) { return (size + 7) & ~7; }
  * @param page_size   页面的大小
  * @param record_size 记录的大小
  * @param fixed_size  除 PAGE_HEADER 外，页面中其余固定长度占用，目前为PAX存储格式中的
- *                    列偏移索引大小（column index）。
+ *                    列偏移索引（column index）和 zone map 的大小，参考 pax_fixed_size。
+ * @param bitmap_ratio 每条记录在 bitmap 中占用几位。压缩的页面能容纳更多的记录，需要预留更大的 bitmap
  */
-int page_record_capacity(int page_size, int record_size, int fixed_size)
+int page_record_capacity(int page_size, int record_size, int fixed_size, int bitmap_ratio = 1)
 {
   // (record_capacity * record_size) + record_capacity/8 + 1 <= (page_size - fix_size)
   // ==> record_capacity = ((page_size - fix_size) - 1) / (record_size + 0.125)
-  return (int)((page_size - PAGE_HEADER_SIZE - fixed_size - 1) / (record_size + 0.125));
+  return (int)((page_size - PAGE_HEADER_SIZE - fixed_size - 1) / (record_size + 0.125 * bitmap_ratio));
+}
+
+/**
+ * @brief PAX 格式页面中每一列都有一个列偏移索引和一个 zone map，行存格式的页面 column_num 为 0
+ * @details 压缩的 PAX 页面还有压缩信息和每一列的编码信息
+ */
+int pax_fixed_size(int column_num, bool compressed)
+{
+  int size = column_num * static_cast<int>(sizeof(int) + sizeof(ZoneMap));
+  if (compressed && column_num > 0) {
+    size += static_cast<int>(sizeof(PaxCompressionHeader) + column_num * sizeof(EncodedColumnMeta));
+  }
+  return size;
 }
 
 /**
@@ -174,25 +190,32 @@ RC RecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, LogHandler &l
 
   int column_num = 0;
   // only pax format need column index
-  if (table_meta != nullptr && storage_format_ == StorageFormat::PAX_FORMAT) {
+  if (table_meta != nullptr && storage_format_ != StorageFormat::ROW_FORMAT) {
     column_num = table_meta->field_num();
   }
+  const bool compressed   = storage_format_ == StorageFormat::PAX_COMPRESSED_FORMAT && column_num > 0;
+  const int  bitmap_ratio = compressed ? PaxRecordPageHandler::MAX_COMPRESSION_RATIO : 1;
   page_header_->record_num       = 0;
   page_header_->column_num       = column_num;
   page_header_->record_real_size = record_size;
   page_header_->record_size      = align8(record_size);
-  page_header_->record_capacity  = page_record_capacity(
-      BP_PAGE_DATA_SIZE, page_header_->record_size, column_num * sizeof(int) /* other fixed size*/);
-  page_header_->col_idx_offset = align8(PAGE_HEADER_SIZE + page_bitmap_size(page_header_->record_capacity));
-  page_header_->data_offset    = align8(PAGE_HEADER_SIZE + page_bitmap_size(page_header_->record_capacity)) +
-                              column_num * sizeof(int) /* column index*/;
+  page_header_->record_capacity  = page_record_capacity(BP_PAGE_DATA_SIZE,
+      page_header_->record_size,
+      pax_fixed_size(column_num, compressed) /* other fixed size*/,
+      bitmap_ratio);
+  // 压缩的页面按照最多能容纳的记录数分配 bitmap
+  const int max_capacity =
+      min(page_header_->record_capacity * bitmap_ratio, static_cast<int>(Column::DEFAULT_CAPACITY));
+  page_header_->col_idx_offset = align8(PAGE_HEADER_SIZE + page_bitmap_size(max_capacity));
+  page_header_->data_offset    = align8(PAGE_HEADER_SIZE + page_bitmap_size(max_capacity)) +
+                              pax_fixed_size(column_num, compressed) /* column index and zone maps*/;
   this->fix_record_capacity();
   ASSERT(page_header_->data_offset + page_header_->record_capacity * page_header_->record_size 
               <= BP_PAGE_DATA_SIZE, 
          "Record overflow the page size");
 
   bitmap_ = frame_->data() + PAGE_HEADER_SIZE;
-  memset(bitmap_, 0, page_bitmap_size(page_header_->record_capacity));
+  memset(bitmap_, 0, page_bitmap_size(max_capacity));
   // column_index[i] store the end offset of column `i` or the start offset of column `i+1`
 
   // 计算列偏移
@@ -206,7 +229,24 @@ RC RecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, LogHandler &l
     }
   }
 
-  rc = log_handler_.init_new_page(frame_, page_num, span((const char *)column_index, column_num * sizeof(int)));
+  // 列索引后面是每一列的 zone map
+  ZoneMap *zone_maps = reinterpret_cast<ZoneMap *>(column_index + column_num);
+  for (int i = 0; i < column_num; ++i) {
+    zone_maps[i].init(table_meta->field(i)->type(), table_meta->field(i)->len());
+  }
+
+  // 压缩的页面在 zone map 后面是压缩信息，新的页面没有编码的数据
+  if (compressed) {
+    auto *compression_header         = reinterpret_cast<PaxCompressionHeader *>(zone_maps + column_num);
+    compression_header->sealed_rows   = 0;
+    compression_header->max_capacity  = max_capacity;
+    compression_header->plain_columns = table_meta->sys_field_num();
+    compression_header->reserved      = 0;
+    memset(compression_header + 1, 0, column_num * sizeof(EncodedColumnMeta));
+  }
+
+  rc = log_handler_.init_new_page(
+      frame_, page_num, column_num, span((const char *)column_index, pax_fixed_size(column_num, compressed)));
   if (OB_FAIL(rc)) {
     LOG_ERROR("Failed to init empty page: write log failed. page_num:record_size %d:%d. rc=%s", 
               page_num, record_size, strrc(rc));
@@ -228,25 +268,30 @@ RC RecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, LogHandler &l
 
   (void)log_handler_.init(log_handler, buffer_pool.id(), record_size, storage_format_);
 
+  const bool compressed   = storage_format_ == StorageFormat::PAX_COMPRESSED_FORMAT && column_num > 0;
+  const int  bitmap_ratio = compressed ? PaxRecordPageHandler::MAX_COMPRESSION_RATIO : 1;
   page_header_->record_num       = 0;
   page_header_->column_num       = column_num;
   page_header_->record_real_size = record_size;
   page_header_->record_size      = align8(record_size);
-  page_header_->record_capacity =
-      page_record_capacity(BP_PAGE_DATA_SIZE, page_header_->record_size, page_header_->column_num * sizeof(int));
-  page_header_->col_idx_offset = align8(PAGE_HEADER_SIZE + page_bitmap_size(page_header_->record_capacity));
-  page_header_->data_offset    = align8(PAGE_HEADER_SIZE + page_bitmap_size(page_header_->record_capacity)) +
-                              column_num * sizeof(int) /* column index*/;
+  page_header_->record_capacity  = page_record_capacity(
+      BP_PAGE_DATA_SIZE, page_header_->record_size, pax_fixed_size(column_num, compressed), bitmap_ratio);
+  const int max_capacity =
+      min(page_header_->record_capacity * bitmap_ratio, static_cast<int>(Column::DEFAULT_CAPACITY));
+  page_header_->col_idx_offset = align8(PAGE_HEADER_SIZE + page_bitmap_size(max_capacity));
+  page_header_->data_offset    = align8(PAGE_HEADER_SIZE + page_bitmap_size(max_capacity)) +
+                              pax_fixed_size(column_num, compressed) /* column index and zone maps*/;
   this->fix_record_capacity();
   ASSERT(page_header_->data_offset + page_header_->record_capacity * page_header_->record_size 
               <= BP_PAGE_DATA_SIZE, 
          "Record overflow the page size");
 
   bitmap_ = frame_->data() + PAGE_HEADER_SIZE;
-  memset(bitmap_, 0, page_bitmap_size(page_header_->record_capacity));
+  memset(bitmap_, 0, page_bitmap_size(max_capacity));
   // column_index[i] store the end offset of column `i` the start offset of column `i+1`
+  // 日志中的列索引后面还有初始的 zone map 和压缩信息
   int *column_index = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
-  memcpy(column_index, col_idx_data, column_num * sizeof(int));
+  memcpy(column_index, col_idx_data, pax_fixed_size(column_num, compressed));
 
   if (OB_FAIL(rc)) {
     LOG_ERROR("Failed to init empty page: write log failed. page_num:record_size %d:%d. rc=%s", 
@@ -423,12 +468,37 @@ bool RecordPageHandler::is_full() const { return page_header_->record_num >= pag
 
 RC PaxRecordPageHandler::insert_record(const char *data, RID *rid)
 {
-  // your code here
-  // Todo:
-  // 1.参考RowRecordPageHandler::insert_record完成大体实现
-  // 2.将一行数据拆分成不同的列插入到不同偏移中
-  // 对应列的偏移可以参照RecordPageHandler::init_empty_page
-  return RC::UNIMPLEMENTED;
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
+         "cannot insert record into page while the page is readonly");
+
+  // 找到空闲位置，压缩的页面中编码保存的位置即使被删除了也不能再使用
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  int    index = bitmap.next_unsetted_bit(sealed_rows());
+  if (index == -1) {
+    LOG_WARN("Page is full, page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
+    return RC::RECORD_NOMEM;
+  }
+  bitmap.set_bit(index);
+  page_header_->record_num++;
+
+  // 日志中记录的是完整的行数据，回放时再按列拆分
+  RC rc = log_handler_.insert_record(frame_, RID(get_page_num(), index), data);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to insert record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+
+  write_record(index, data);
+  // 回放日志时也是调用 insert_record，重新编码的时机与正常运行时相同
+  seal_if_full();
+
+  frame_->mark_dirty();
+
+  if (rid) {
+    rid->page_num = get_page_num();
+    rid->slot_num = index;
+  }
+  return RC::SUCCESS;
 }
 
 RC PaxRecordPageHandler::insert_chunk(const Chunk &chunk, int start_row, int &insert_rows)
@@ -446,6 +516,21 @@ RC PaxRecordPageHandler::delete_record(const RID *rid)
   if (bitmap.get_bit(rid->slot_num)) {
     bitmap.clear_bit(rid->slot_num);
     page_header_->record_num--;
+    if (page_header_->record_num == 0) {
+      // 删除记录时不缩小 zone map 的范围，页面删空了才重新开始记录
+      ZoneMap *zone_maps = this->zone_maps();
+      for (int i = 0; i < page_header_->column_num; i++) {
+        zone_maps[i].clear();
+      }
+      // 压缩的页面删空之后恢复成没有编码数据的状态，编码的位置可以重新使用
+      if (sealed_rows() > 0) {
+        RC rc = rebuild(0 /*sealed_rows*/, 1 /*min_capacity*/, {});
+        if (OB_FAIL(rc)) {
+          LOG_ERROR("Failed to reset empty compressed page. page_num %d:%d. rc=%s",
+                    disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+        }
+      }
+    }
     frame_->mark_dirty();
 
     RC rc = log_handler_.delete_record(frame_, *rid);
@@ -461,28 +546,406 @@ RC PaxRecordPageHandler::delete_record(const RID *rid)
   }
 }
 
+RC PaxRecordPageHandler::recover_insert_record(const char *data, const RID &rid)
+{
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_WARN("slot_num illegal, slot_num(%d) > record_capacity(%d).", rid.slot_num, page_header_->record_capacity);
+    return RC::RECORD_INVALID_RID;
+  }
+
+  // 更新位图
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    bitmap.set_bit(rid.slot_num);
+    page_header_->record_num++;
+  }
+
+  // 恢复数据
+  if (rid.slot_num < sealed_rows()) {
+    RC rc = update_sealed_record(rid.slot_num, data);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  } else {
+    write_record(rid.slot_num, data);
+    seal_if_full();
+  }
+
+  frame_->mark_dirty();
+
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::update_record(const RID &rid, const char *data)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, "cannot update record from page while the page is readonly");
+
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, frame=%s, page_header=%s",
+              rid.slot_num, frame_->to_string().c_str(), page_header_->to_string().c_str());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  if (rid.slot_num < sealed_rows()) {
+    RC rc = update_sealed_record(rid.slot_num, data);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to update sealed record. page_num %d:%d, slot_num %d, rc=%s",
+               disk_buffer_pool_->file_desc(), frame_->page_num(), rid.slot_num, strrc(rc));
+      return rc;
+    }
+  } else {
+    write_record(rid.slot_num, data);
+  }
+  frame_->mark_dirty();
+
+  RC rc = log_handler_.update_record(frame_, rid, data);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to update record. page_num %d:%d. rc=%s", 
+              disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+  return RC::SUCCESS;
+}
+
 RC PaxRecordPageHandler::get_record(const RID &rid, Record &record)
 {
-  // your code here
-  // Todo:
-  // 1.参考RowRecordPageHandler::get_record完成大体实现
-  // 2.通过列的偏移拼接出完整的行数据
-  // 可以参照PaxRecordPageHandler::insert_record的实现
-  return RC::UNIMPLEMENTED;
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, frame=%s, page_header=%s",
+              rid.slot_num, frame_->to_string().c_str(), page_header_->to_string().c_str());
+    return RC::RECORD_INVALID_RID;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    LOG_ERROR("Invalid slot_num:%d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  // 列数据在页面中不是连续存放的，需要复制出来拼成一行
+  RC rc = record.new_record(page_header_->record_real_size);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  const bool sealed = rid.slot_num < sealed_rows();
+  int        offset = 0;
+  for (int col_id = 0; col_id < page_header_->column_num; col_id++) {
+    int len = get_field_len(col_id);
+    if (sealed) {
+      const EncodedColumnMeta &meta = encoded_column(col_id);
+      PaxColumnCodec::decode(meta, frame_->data() + meta.offset, rid.slot_num, 1, record.data() + offset);
+    } else {
+      memcpy(record.data() + offset, get_field_data(rid.slot_num, col_id), len);
+    }
+    offset += len;
+  }
+  record.set_rid(rid);
+  return RC::SUCCESS;
 }
 
 // TODO: specify the column_ids that chunk needed. currenly we get all columns
 RC PaxRecordPageHandler::get_chunk(Chunk &chunk)
 {
-  // your code here
-  // Todo:
-  // 参照PaxRecordPageHandler::get_record
-  // 一次性获得一个page的所有record
-  return RC::UNIMPLEMENTED;
+  Bitmap    bitmap(bitmap_, page_header_->record_capacity);
+  const int sealed = sealed_rows();
+  for (int i = 0; i < chunk.column_num(); i++) {
+    const int col_id = chunk.column_ids(i);
+    if (col_id < 0 || col_id >= page_header_->column_num) {
+      LOG_WARN("invalid column id. col_id=%d, column num=%d", col_id, page_header_->column_num);
+      return RC::INVALID_ARGUMENT;
+    }
+
+    Column &column = chunk.column(i);
+    if (column.attr_len() != get_field_len(col_id)) {
+      LOG_WARN("column length mismatch. col_id=%d, column len=%d, field len=%d",
+               col_id, column.attr_len(), get_field_len(col_id));
+      return RC::INVALID_ARGUMENT;
+    }
+
+    // 同一列的数据在页面中是连续的，连续的有效记录一次复制。编码保存的部分直接解码到 column 中
+    vector<int32_t> translation;
+    for (int slot = bitmap.next_setted_bit(0); slot != -1;) {
+      int end = slot + 1;
+      while (end < page_header_->record_capacity && bitmap.get_bit(end)) {
+        end++;
+      }
+      RC rc = RC::SUCCESS;
+      if (slot < sealed) {
+        const int sealed_end = min(end, sealed);
+        rc                   = append_sealed(column, col_id, slot, sealed_end - slot, translation);
+        slot                 = sealed_end;
+      }
+      if (OB_SUCC(rc) && slot < end) {
+        rc = column.append(get_field_data(slot, col_id), end - slot);
+      }
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to append column data. col_id=%d, rc=%s", col_id, strrc(rc));
+        return rc;
+      }
+      slot = end < page_header_->record_capacity ? bitmap.next_setted_bit(end) : -1;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+bool PaxRecordPageHandler::may_match(const vector<ZoneMapPredicate> &predicates)
+{
+  ZoneMap *zone_maps = this->zone_maps();
+  for (const ZoneMapPredicate &predicate : predicates) {
+    if (predicate.field_id >= 0 && predicate.field_id < page_header_->column_num &&
+        !predicate.may_match(zone_maps[predicate.field_id])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void PaxRecordPageHandler::write_record(SlotNum slot_num, const char *data)
+{
+  ZoneMap *zone_maps = this->zone_maps();
+  int      offset    = 0;
+  for (int col_id = 0; col_id < page_header_->column_num; col_id++) {
+    int len = get_field_len(col_id);
+    memcpy(get_field_data(slot_num, col_id), data + offset, len);
+    zone_maps[col_id].update(data + offset);
+    offset += len;
+  }
+}
+
+ZoneMap *PaxRecordPageHandler::zone_maps() const
+{
+  int *col_idx = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
+  return reinterpret_cast<ZoneMap *>(col_idx + page_header_->column_num);
+}
+
+PaxCompressionHeader *PaxRecordPageHandler::compression_header() const
+{
+  return reinterpret_cast<PaxCompressionHeader *>(zone_maps() + page_header_->column_num);
+}
+
+EncodedColumnMeta *PaxRecordPageHandler::encoded_columns() const
+{
+  return reinterpret_cast<EncodedColumnMeta *>(compression_header() + 1);
+}
+
+int PaxRecordPageHandler::sealed_rows() const
+{
+  return compressed() && page_header_->column_num > 0 ? compression_header()->sealed_rows : 0;
+}
+
+bool PaxRecordPageHandler::is_full() const
+{
+  if (!compressed()) {
+    return RecordPageHandler::is_full();
+  }
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  return bitmap.next_unsetted_bit(sealed_rows()) == -1;
+}
+
+void PaxRecordPageHandler::read_columns(vector<vector<char>> &columns)
+{
+  const int capacity = page_header_->record_capacity;
+  const int sealed   = sealed_rows();
+  columns.resize(page_header_->column_num);
+  for (int col_id = 0; col_id < page_header_->column_num; col_id++) {
+    const int     len    = get_field_len(col_id);
+    vector<char> &column = columns[col_id];
+    column.resize(static_cast<size_t>(capacity) * len);
+    if (sealed > 0) {
+      const EncodedColumnMeta &meta = encoded_column(col_id);
+      PaxColumnCodec::decode(meta, frame_->data() + meta.offset, 0, sealed, column.data());
+    }
+    memcpy(column.data() + static_cast<size_t>(sealed) * len, get_field_data(sealed, col_id),
+        static_cast<size_t>(capacity - sealed) * len);
+  }
+}
+
+RC PaxRecordPageHandler::rebuild(int sealed_rows, int min_capacity, const vector<vector<char>> &columns)
+{
+  const int                 column_num         = page_header_->column_num;
+  PaxCompressionHeader     *compression_header = this->compression_header();
+  const ZoneMap            *zone_maps          = this->zone_maps();
+  vector<int>               field_lens(column_num);
+  vector<EncodedColumnMeta> metas(column_num);
+  vector<vector<char>>      payloads(column_num);
+
+  int row_size = 0;
+  for (int col_id = 0; col_id < column_num; col_id++) {
+    field_lens[col_id] = get_field_len(col_id);
+    row_size += field_lens[col_id];
+  }
+
+  // 编码之后的数据紧跟在压缩信息后面，之后是未压缩的部分
+  const int encoded_offset = align8(reinterpret_cast<char *>(encoded_columns() + column_num) - frame_->data());
+  int       offset         = encoded_offset;
+  for (int col_id = 0; col_id < column_num; col_id++) {
+    const char *values = columns.empty() ? nullptr : columns[col_id].data();
+    PaxColumnCodec::encode(static_cast<AttrType>(zone_maps[col_id].attr_type),
+        field_lens[col_id], values, sealed_rows, metas[col_id], payloads[col_id],
+        col_id < compression_header->plain_columns);
+    metas[col_id].offset = offset;
+    offset               = align8(offset + metas[col_id].size);
+  }
+
+  const int raw_offset = offset;
+  const int raw_rows =
+      min((BP_PAGE_DATA_SIZE - raw_offset) / row_size, compression_header->max_capacity - sealed_rows);
+  if (raw_rows < 1 || sealed_rows + raw_rows < min_capacity) {
+    LOG_TRACE("no enough space to rebuild compressed page. sealed rows=%d, raw rows=%d, min capacity=%d",
+              sealed_rows, raw_rows, min_capacity);
+    return RC::RECORD_NOMEM;
+  }
+
+  // 新的位置可能与原来的数据重叠，先在临时内存中组织好再复制到页面中
+  vector<char> image(BP_PAGE_DATA_SIZE - encoded_offset, 0);
+  for (int col_id = 0; col_id < column_num; col_id++) {
+    if (metas[col_id].size > 0) {
+      memcpy(image.data() + metas[col_id].offset - encoded_offset, payloads[col_id].data(), metas[col_id].size);
+    }
+  }
+  const int copy_rows = columns.empty() ? 0 : min(page_header_->record_capacity, sealed_rows + raw_rows) - sealed_rows;
+  int       column_offset = raw_offset;
+  for (int col_id = 0; col_id < column_num; col_id++) {
+    const size_t len = field_lens[col_id];
+    if (copy_rows > 0) {
+      memcpy(image.data() + column_offset - encoded_offset, columns[col_id].data() + sealed_rows * len, copy_rows * len);
+    }
+    column_offset += raw_rows * len;
+  }
+  memcpy(frame_->data() + encoded_offset, image.data(), image.size());
+
+  compression_header->sealed_rows = sealed_rows;
+  memcpy(encoded_columns(), metas.data(), column_num * sizeof(EncodedColumnMeta));
+  int *col_idx = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
+  for (int col_id = 0, end = 0; col_id < column_num; col_id++) {
+    end += field_lens[col_id] * raw_rows;
+    col_idx[col_id] = end;
+  }
+  page_header_->data_offset     = raw_offset;
+  page_header_->record_capacity = sealed_rows + raw_rows;
+  return RC::SUCCESS;
+}
+
+void PaxRecordPageHandler::seal_if_full()
+{
+  if (!compressed() || !is_full()) {
+    return;
+  }
+
+  // 重新编码的代价与页面中的记录数成正比，至少要能多容纳 1/8 的记录才值得
+  const int capacity     = page_header_->record_capacity;
+  const int min_capacity = capacity + max(1, capacity / 8);
+  if (min_capacity > compression_header()->max_capacity) {
+    return;
+  }
+
+  vector<vector<char>> columns;
+  read_columns(columns);
+  RC rc = rebuild(capacity, min_capacity, columns);
+  if (OB_FAIL(rc)) {
+    LOG_TRACE("page is not compressible enough, keep it full. page_num %d:%d, capacity=%d",
+              disk_buffer_pool_->file_desc(), frame_->page_num(), capacity);
+  }
+}
+
+RC PaxRecordPageHandler::update_sealed_record(SlotNum slot_num, const char *data)
+{
+  // 只修改了 PLAIN 编码的列（比如事务提交时修改的事务字段）时直接原地修改，不需要重新编码
+  bool need_rebuild = false;
+  int  offset       = 0;
+  for (int col_id = 0; col_id < page_header_->column_num && !need_rebuild; col_id++) {
+    const int                len  = get_field_len(col_id);
+    const EncodedColumnMeta &meta = encoded_column(col_id);
+    if (static_cast<PaxEncoding>(meta.encoding) != PaxEncoding::PLAIN) {
+      vector<char> old_value(len);
+      PaxColumnCodec::decode(meta, frame_->data() + meta.offset, slot_num, 1, old_value.data());
+      need_rebuild = memcmp(old_value.data(), data + offset, len) != 0;
+    }
+    offset += len;
+  }
+
+  if (need_rebuild) {
+    vector<vector<char>> columns;
+    read_columns(columns);
+    offset = 0;
+    for (int col_id = 0; col_id < page_header_->column_num; col_id++) {
+      const int len = get_field_len(col_id);
+      memcpy(columns[col_id].data() + static_cast<size_t>(slot_num) * len, data + offset, len);
+      offset += len;
+    }
+
+    // 新的值可能让编码之后的数据变大，页面中放不下时更新失败
+    RC rc = rebuild(sealed_rows(), page_header_->record_capacity, columns);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  } else {
+    offset = 0;
+    for (int col_id = 0; col_id < page_header_->column_num; col_id++) {
+      const int                len  = get_field_len(col_id);
+      const EncodedColumnMeta &meta = encoded_column(col_id);
+      if (static_cast<PaxEncoding>(meta.encoding) == PaxEncoding::PLAIN) {
+        memcpy(frame_->data() + meta.offset + static_cast<size_t>(slot_num) * len, data + offset, len);
+      }
+      offset += len;
+    }
+  }
+
+  ZoneMap *zone_maps = this->zone_maps();
+  offset             = 0;
+  for (int col_id = 0; col_id < page_header_->column_num; col_id++) {
+    zone_maps[col_id].update(data + offset);
+    offset += get_field_len(col_id);
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::append_sealed(Column &column, int col_id, int start, int count, vector<int32_t> &translation)
+{
+  if (column.count() + count > column.capacity()) {
+    LOG_WARN("append data to full column");
+    return RC::INTERNAL;
+  }
+
+  const EncodedColumnMeta &meta    = encoded_column(col_id);
+  const char              *payload = frame_->data() + meta.offset;
+  if (column.column_type() == Column::Type::DICTIONARY_COLUMN) {
+    if (static_cast<PaxEncoding>(meta.encoding) != PaxEncoding::DICTIONARY) {
+      vector<char> values(static_cast<size_t>(count) * meta.attr_len);
+      PaxColumnCodec::decode(meta, payload, start, count, values.data());
+      return column.append(values.data(), count);
+    }
+
+    // 页面中的字典只需要加入 column 的字典一次，之后只转换编号
+    if (translation.empty()) {
+      translation.resize(meta.value_count);
+      for (int code = 0; code < meta.value_count; code++) {
+        const char *value = PaxColumnCodec::dictionary_value(meta, payload, code);
+        translation[code] = column.dictionary()->add(value, strnlen(value, meta.attr_len));
+      }
+    }
+    int32_t *codes = reinterpret_cast<int32_t *>(column.data()) + column.count();
+    PaxColumnCodec::decode_codes(meta, payload, start, count, reinterpret_cast<uint32_t *>(codes));
+    for (int i = 0; i < count; i++) {
+      codes[i] = translation[codes[i]];
+    }
+  } else {
+    PaxColumnCodec::decode(meta, payload, start, count, column.data() + column.data_len());
+  }
+  column.set_count(column.count() + count);
+  return RC::SUCCESS;
 }
 
 char *PaxRecordPageHandler::get_field_data(SlotNum slot_num, int col_id)
 {
+  // 列索引描述的是未压缩的部分，压缩的页面中需要跳过编码保存的记录
+  slot_num -= sealed_rows();
   int *col_idx = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
   if (col_id == 0) {
     return frame_->data() + page_header_->data_offset + (get_field_len(col_id) * slot_num);
@@ -493,11 +956,12 @@ char *PaxRecordPageHandler::get_field_data(SlotNum slot_num, int col_id)
 
 int PaxRecordPageHandler::get_field_len(int col_id)
 {
-  int *col_idx = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
+  int      *col_idx  = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
+  const int raw_rows = page_header_->record_capacity - sealed_rows();
   if (col_id == 0) {
-    return col_idx[col_id] / page_header_->record_capacity;
+    return col_idx[col_id] / raw_rows;
   } else {
-    return (col_idx[col_id] - col_idx[col_id - 1]) / page_header_->record_capacity;
+    return (col_idx[col_id] - col_idx[col_id - 1]) / raw_rows;
   }
 }
 
@@ -732,6 +1196,25 @@ RC RecordFileHandler::visit_record(const RID &rid, function<bool(Record &)> upda
   return rc;
 }
 
+void PageMorselQueue::init(PageNum start_page, PageNum end_page, int morsel_pages /* = DEFAULT_MORSEL_PAGES */)
+{
+  next_page_.store(start_page);
+  end_page_     = end_page;
+  morsel_pages_ = morsel_pages > 0 ? morsel_pages : DEFAULT_MORSEL_PAGES;
+}
+
+bool PageMorselQueue::next(PageNum &start_page, PageNum &end_page)
+{
+  PageNum start = next_page_.fetch_add(morsel_pages_);
+  if (start >= end_page_) {
+    return false;
+  }
+
+  start_page = start;
+  end_page   = min(start + morsel_pages_, end_page_);
+  return true;
+}
+
 ChunkFileScanner::~ChunkFileScanner() { close_scan(); }
 
 RC ChunkFileScanner::close_scan()
@@ -739,6 +1222,12 @@ RC ChunkFileScanner::close_scan()
   if (disk_buffer_pool_ != nullptr) {
     disk_buffer_pool_ = nullptr;
   }
+  morsels_ = nullptr;
+
+  if (lsm_iter_ != nullptr) {
+    delete lsm_iter_;
+    lsm_iter_ = nullptr;
+  }
 
   if (record_page_handler_ != nullptr) {
     record_page_handler_->cleanup();
@@ -767,17 +1256,112 @@ RC ChunkFileScanner::open_scan_chunk(
   if (table == nullptr || table->table_meta().storage_format() == StorageFormat::ROW_FORMAT) {
     record_page_handler_ = new RowRecordPageHandler();
   } else {
-    record_page_handler_ = new PaxRecordPageHandler();
+    record_page_handler_ = new PaxRecordPageHandler(table->table_meta().storage_format());
   }
 
   return rc;
 }
 
+RC ChunkFileScanner::open_scan_chunk(
+    Table *table, DiskBufferPool &buffer_pool, LogHandler &log_handler, ReadWriteMode mode, PageMorselQueue &morsels)
+{
+  RC rc = open_scan_chunk(table, buffer_pool, log_handler, mode);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  // 先领取第一个 morsel，之后每遍历完一个再领取下一个
+  morsels_ = &morsels;
+  if (!next_morsel()) {
+    // 页面已经被其它线程领取完了，这个 scanner 不会返回任何数据
+    bp_iterator_.init(buffer_pool, 1, 1);
+  }
+  return RC::SUCCESS;
+}
+
+bool ChunkFileScanner::next_morsel()
+{
+  PageNum start_page = 0;
+  PageNum end_page   = 0;
+  if (morsels_ == nullptr || !morsels_->next(start_page, end_page)) {
+    return false;
+  }
+
+  RC rc = bp_iterator_.init(*disk_buffer_pool_, start_page, end_page);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to init bp iterator. start page=%d, end page=%d, rc=%s", start_page, end_page, strrc(rc));
+    return false;
+  }
+  return true;
+}
+
+RC ChunkFileScanner::open_scan_chunk(Table *table, oceanbase::ObLsmIterator *lsm_iter, const string &table_prefix)
+{
+  close_scan();
+
+  table_            = table;
+  lsm_iter_         = lsm_iter;
+  lsm_table_prefix_ = table_prefix;
+  rw_mode_          = ReadWriteMode::READ_ONLY;
+  return RC::SUCCESS;
+}
+
+RC ChunkFileScanner::next_lsm_chunk(Chunk &chunk)
+{
+  const TableMeta         &table_meta = table_->table_meta();
+  vector<const FieldMeta *> fields(chunk.column_num(), nullptr);
+  for (int i = 0; i < chunk.column_num(); i++) {
+    for (int j = 0; j < table_meta.field_num(); j++) {
+      if (table_meta.field(j)->field_id() == chunk.column_ids(i)) {
+        fields[i] = table_meta.field(j);
+        break;
+      }
+    }
+    if (fields[i] == nullptr) {
+      LOG_WARN("no such field in table. table=%s, field id=%d", table_->name(), chunk.column_ids(i));
+      return RC::SCHEMA_FIELD_NOT_EXIST;
+    }
+  }
+
+  const int capacity = chunk.capacity();
+  int       rows     = 0;
+  for (; rows < capacity && lsm_iter_->valid(); lsm_iter_->next(), rows++) {
+    if (!lsm_iter_->key().starts_with(lsm_table_prefix_)) {
+      break;
+    }
+
+    string_view value = lsm_iter_->value();
+    if (static_cast<int>(value.size()) < table_meta.record_size()) {
+      LOG_WARN("invalid record size in lsm. table=%s, size=%lu", table_->name(), value.size());
+      return RC::INTERNAL;
+    }
+    for (int i = 0; i < chunk.column_num(); i++) {
+      RC rc = chunk.column(i).append_one(value.data() + fields[i]->offset());
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+  }
+  return rows > 0 ? RC::SUCCESS : RC::RECORD_EOF;
+}
+
 RC ChunkFileScanner::next_chunk(Chunk &chunk)
 {
   RC rc = RC::SUCCESS;
 
-  while (bp_iterator_.has_next()) {
+  if (lsm_iter_ != nullptr) {
+    return next_lsm_chunk(chunk);
+  }
+
+  while (true) {
+    if (!bp_iterator_.has_next()) {
+      // 并行扫描时当前 morsel 遍历完了，继续领取下一个
+      if (next_morsel()) {
+        continue;
+      }
+      break;
+    }
+
     PageNum page_num = bp_iterator_.next();
     record_page_handler_->cleanup();
     rc = record_page_handler_->init(*disk_buffer_pool_, *log_handler_, page_num, rw_mode_, table_->lob_handler());
@@ -785,8 +1369,14 @@ RC ChunkFileScanner::next_chunk(Chunk &chunk)
       LOG_WARN("failed to init record page handler. page_num=%d, rc=%s", page_num, strrc(rc));
       return rc;
     }
+    if (!zone_map_predicates_.empty() && !record_page_handler_->may_match(zone_map_predicates_)) {
+      continue;  // 页面中没有满足条件的记录
+    }
     rc = record_page_handler_->get_chunk(chunk);
     if (rc == RC::SUCCESS) {
+      if (chunk.rows() == 0) {
+        continue;  // 记录都被删除的页面
+      }
       return rc;
     } else if (rc == RC::RECORD_EOF) {
       break;
@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 //
 #pragma once
 
+#include "common/lang/atomic.h"
 #include "common/lang/bitmap.h"
 #include "common/lang/sstream.h"
 #include "storage/buffer/disk_buffer_pool.h"
@@ -21,6 +22,8 @@ See the Mulan PSL v2 for more details. */
 #include "storage/record/record.h"
 #include "storage/record/record_log.h"
 #include "storage/record/lob_handler.h"
+#include "storage/record/pax_encoding.h"
+#include "storage/record/zone_map.h"
 #include "common/types.h"
 
 class LogHandler;
@@ -30,6 +33,10 @@ class LogHandler;
 class Trx;
 class Table;
 
+namespace oceanbase {
+class ObLsmIterator;
+}
+
 /**
  * @brief 这里负责管理在一个文件上表记录(行)的组织/管理
  * @defgroup RecordManager
@@ -222,6 +229,12 @@ public:
    */
   virtual RC get_chunk(Chunk &chunk) { return RC::UNIMPLEMENTED; }
 
+  /**
+   * @brief 根据页面中的摘要信息判断页面中是否可能有满足所有条件的记录
+   * @details 返回 false 时可以跳过整个页面。只有 PaxRecordPageHandler 记录了 zone map。
+   */
+  virtual bool may_match(const vector<ZoneMapPredicate> &predicates) { return true; }
+
   /**
    * @brief 返回该记录页的页号
    */
@@ -230,7 +243,7 @@ public:
   /**
    * @brief 当前页面是否已经没有空闲位置插入新的记录
    */
-  bool is_full() const;
+  virtual bool is_full() const;
 
 protected:
   /**
@@ -309,16 +322,30 @@ public:
  * @ingroup RecordManager
  * @details PAX 格式实现，当前定长记录模式下每个页面的组织大概是这样的：
  * @code
- * | PageHeader | record allocate bitmap | column index  |
- * |------------|------------------------| ------------- |
- * | column1 | column2 | ..................... | columnN |
+ * | PageHeader | record allocate bitmap | column index  | zone maps |
+ * |------------|------------------------| ------------- | --------- |
+ * | column1 | column2 | ................................. | columnN |
  * @endcode
+ * zone map 记录了每一列数据的最小值和最大值，扫描时可以用来跳过不满足过滤条件的页面。
+ *
+ * 压缩的 PAX 格式（PAX_COMPRESSED_FORMAT）的页面在 zone maps 后面还有压缩信息，页面分成两部分：
+ * @code
+ * | PageHeader | record allocate bitmap | column index | zone maps | PaxCompressionHeader | EncodedColumnMeta[N] |
+ * |------------|------------------------|--------------|-----------|----------------------|----------------------|
+ * | encoded column1 | ... | encoded columnN | column1 | column2 | ... | columnN |
+ * @endcode
+ * [0, sealed_rows) 的记录按列编码保存，其余的记录与普通的 PAX 页面一样不压缩保存，column index 描述的是这一部分。
+ * 未压缩的部分写满时把整个页面重新编码（seal），腾出来的空间作为新的未压缩部分，页面可以容纳更多的记录。
+ * 删除只修改 bitmap。事务字段总是按照 PLAIN 编码保存，PLAIN 编码的列可以原地修改，事务提交和删除时
+ * 修改事务字段不需要重新编码；其它编码的列修改之后需要重新编码整个页面，页面放不下时更新失败。
+ *
  * 更多细节可参考：docs/design/miniob-pax-storage.md
  */
 class PaxRecordPageHandler : public RecordPageHandler
 {
 public:
-  PaxRecordPageHandler() : RecordPageHandler(StorageFormat::PAX_FORMAT) {}
+  PaxRecordPageHandler(StorageFormat storage_format = StorageFormat::PAX_FORMAT) : RecordPageHandler(storage_format)
+  {}
 
   /**
    * @brief 插入一条记录
@@ -332,8 +359,12 @@ public:
   // TODO: insert chunk only used in load_data
   virtual RC insert_chunk(const Chunk &chunk, int start_row, int &insert_rows) override;
 
+  virtual RC recover_insert_record(const char *data, const RID &rid) override;
+
   virtual RC delete_record(const RID *rid) override;
 
+  virtual RC update_record(const RID &rid, const char *data) override;
+
   /**
    * @brief 获取指定位置的记录数据
    *
@@ -350,7 +381,62 @@ public:
    */
   virtual RC get_chunk(Chunk &chunk) override;
 
+  virtual bool may_match(const vector<ZoneMapPredicate> &predicates) override;
+
+  /**
+   * @brief 压缩的页面中编码之后的记录所在的位置不能再插入新的记录，只看未压缩的部分
+   */
+  virtual bool is_full() const override;
+
+  /// 获取指定列的 zone map
+  const ZoneMap &zone_map(int col_id) { return zone_maps()[col_id]; }
+
+  /// 压缩的页面中按列编码保存的记录数，这些记录的 slot_num 在 [0, sealed_rows) 之间
+  int sealed_rows() const;
+
+  /// 获取压缩页面中指定列的编码信息
+  const EncodedColumnMeta &encoded_column(int col_id) const { return encoded_columns()[col_id]; }
+
+public:
+  /// 压缩的页面最多能容纳的记录数是未压缩时的多少倍，决定了 bitmap 的大小
+  static constexpr int MAX_COMPRESSION_RATIO = 4;
+
 private:
+  /// 把一行数据按列拆分，写到 slot_num 对应的各个列中，同时更新各列的 zone map
+  void write_record(SlotNum slot_num, const char *data);
+
+  /// zone map 紧跟在列索引后面
+  ZoneMap *zone_maps() const;
+
+  bool compressed() const { return storage_format_ == StorageFormat::PAX_COMPRESSED_FORMAT; }
+
+  /// 压缩信息紧跟在 zone map 后面
+  PaxCompressionHeader *compression_header() const;
+  EncodedColumnMeta    *encoded_columns() const;
+
+  /// 读出 [0, record_capacity) 所有位置上每一列的数据，包括已经删除的位置
+  void read_columns(vector<vector<char>> &columns);
+
+  /**
+   * @brief 重新组织压缩的页面
+   * @details 把 columns 中 [0, sealed_rows) 的记录编码保存，剩余的空间作为未压缩的部分，
+   * 原来 [sealed_rows, record_capacity) 位置上的数据复制到新的位置。
+   * @param min_capacity 新的页面至少要容纳的记录数，做不到时返回 RC::RECORD_NOMEM，页面不会被修改
+   */
+  RC rebuild(int sealed_rows, int min_capacity, const vector<vector<char>> &columns);
+
+  /// 未压缩的部分写满之后尝试重新编码，腾出空间
+  void seal_if_full();
+
+  /// 修改已经编码的记录，PLAIN 编码的列原地修改，其它编码的列有变化时需要重新编码整个页面
+  RC update_sealed_record(SlotNum slot_num, const char *data);
+
+  /**
+   * @brief 把编码保存的 [start, start + count) 行解码追加到 column 中
+   * @param translation 页面字典编号到 column 字典编号的映射，同一列第一次使用时生成
+   */
+  RC append_sealed(Column &column, int col_id, int start, int count, vector<int32_t> &translation);
+
   // get the field data by `slot_num` and `column id`
   char *get_field_data(SlotNum slot_num, int col_id);
 
@@ -427,6 +513,34 @@ private:
   LobFileHandler        *lob_handler_ = nullptr;
 };
 
+/**
+ * @brief 把一个文件的页面切分成若干个 morsel，供多个线程并发领取
+ * @ingroup RecordManager
+ * @details 每个 morsel 是页号连续的一段页面，线程扫描完一个 morsel 再领取下一个，
+ * 这样扫描快的线程会领取更多的 morsel，不会因为某个线程分到的数据多而拖慢整个查询。
+ */
+class PageMorselQueue
+{
+public:
+  static constexpr int DEFAULT_MORSEL_PAGES = 16;
+
+  /**
+   * @brief 初始化要切分的页面范围 [start_page, end_page)
+   */
+  void init(PageNum start_page, PageNum end_page, int morsel_pages = DEFAULT_MORSEL_PAGES);
+
+  /**
+   * @brief 领取下一个 morsel，可以被多个线程同时调用
+   * @return false 表示所有的页面都已经被领取
+   */
+  bool next(PageNum &start_page, PageNum &end_page);
+
+private:
+  atomic<PageNum> next_page_{0};
+  PageNum         end_page_     = 0;
+  int             morsel_pages_ = DEFAULT_MORSEL_PAGES;
+};
+
 /**
  * @brief 遍历某个文件中所有记录，每次返回一个 Chunk
  * @ingroup RecordManager
@@ -441,6 +555,21 @@ public:
   // TODO: not support filter and transaction
   RC open_scan_chunk(Table *table, DiskBufferPool &buffer_pool, LogHandler &log_handler, ReadWriteMode mode);
 
+  /**
+   * @brief 只遍历从 morsels 中领取到的页面
+   * @details 多个线程各自使用一个 ChunkFileScanner，共享同一个 morsels，合起来遍历所有的页面
+   */
+  RC open_scan_chunk(Table *table, DiskBufferPool &buffer_pool, LogHandler &log_handler, ReadWriteMode mode,
+      PageMorselQueue &morsels);
+
+  /**
+   * @brief 遍历 lsm-tree 中某张表的所有记录
+   * @details 直接把 key-value 解码到 Chunk 的各个列中，不经过 Record
+   * @param lsm_iter 已经定位到表的第一条记录的迭代器，由 ChunkFileScanner 负责释放
+   * @param table_prefix 表中所有记录的 key 的公共前缀，参考 Codec::encode_table_prefix
+   */
+  RC open_scan_chunk(Table *table, oceanbase::ObLsmIterator *lsm_iter, const string &table_prefix);
+
   /**
    * @brief 关闭一个文件扫描，释放相应的资源
    */
@@ -451,6 +580,12 @@ public:
    */
   RC next_chunk(Chunk &chunk);
 
+  /**
+   * @brief 设置下推的过滤条件，根据页面的 zone map 跳过不可能有满足条件记录的页面
+   * @details 这里只是减少需要处理的页面，返回的记录仍然需要再过滤
+   */
+  void set_zone_map_predicates(vector<ZoneMapPredicate> predicates) { zone_map_predicates_ = std::move(predicates); }
+
 private:
   Table *table_ = nullptr;  ///< 当前遍历的是哪张表。
 
@@ -460,4 +595,17 @@ private:
 
   BufferPoolIterator bp_iterator_;                    ///< 遍历buffer pool的所有页面
   RecordPageHandler *record_page_handler_ = nullptr;  ///< 处理文件某页面的记录
+
+  PageMorselQueue *morsels_ = nullptr;  ///< 并行扫描时从这里领取要遍历的页面
+
+  vector<ZoneMapPredicate> zone_map_predicates_;  ///< 用来跳过页面的过滤条件
+
+  oceanbase::ObLsmIterator *lsm_iter_ = nullptr;  ///< 遍历 lsm-tree 表时使用
+  string                    lsm_table_prefix_;
+
+private:
+  RC next_lsm_chunk(Chunk &chunk);
+
+  /// 当前 morsel 遍历完后领取下一个，返回 false 表示没有更多的页面
+  bool next_morsel();
 };
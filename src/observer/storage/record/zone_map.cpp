@@ -0,0 +1,89 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/record/zone_map.h"
+#include "common/defs.h"
+
+#include <algorithm>
+#include <cstring>
+
+bool ZoneMap::support(AttrType type, int attr_len)
+{
+  return (type == AttrType::INTS || type == AttrType::DATES || type == AttrType::FLOATS) &&
+         attr_len == static_cast<int>(sizeof(int32_t));
+}
+
+void ZoneMap::init(AttrType type, int attr_len)
+{
+  attr_type       = static_cast<int32_t>(support(type, attr_len) ? type : AttrType::UNDEFINED);
+  has_value       = 0;
+  min.int_value   = 0;
+  max.int_value   = 0;
+}
+
+void ZoneMap::update(const char *data)
+{
+  const AttrType type = static_cast<AttrType>(attr_type);
+  if (type == AttrType::UNDEFINED) {
+    return;
+  }
+
+  Bound value;
+  memcpy(&value, data, sizeof(value));
+  if (!has_value) {
+    min       = value;
+    max       = value;
+    has_value = 1;
+  } else if (type == AttrType::FLOATS) {
+    min.float_value = std::min(min.float_value, value.float_value);
+    max.float_value = std::max(max.float_value, value.float_value);
+  } else {
+    min.int_value = std::min(min.int_value, value.int_value);
+    max.int_value = std::max(max.int_value, value.int_value);
+  }
+}
+
+template <typename T>
+static bool may_match_range(CompOp comp, T min, T max, T value)
+{
+  switch (comp) {
+    case EQUAL_TO: return min <= value && value <= max;
+    case LESS_THAN: return min < value;
+    case LESS_EQUAL: return min <= value;
+    case GREAT_THAN: return max > value;
+    case GREAT_EQUAL: return max >= value;
+    case NOT_EQUAL: return !(min == value && max == value);
+    default: return true;
+  }
+}
+
+bool ZoneMapPredicate::may_match(const ZoneMap &zone_map) const
+{
+  const AttrType type = static_cast<AttrType>(zone_map.attr_type);
+  if (type == AttrType::UNDEFINED) {
+    return true;
+  }
+  if (!zone_map.has_value) {
+    return false;  // 页面中没有数据
+  }
+  if (value.attr_type() != type) {
+    return true;  // 向量化执行时只比较相同类型的值，这里不做类型转换
+  }
+
+  ZoneMap::Bound bound;
+  memcpy(&bound, value.data(), sizeof(bound));
+  if (type == AttrType::FLOATS) {
+    // 其它地方比较浮点数时可能允许 EPSILON 的误差，范围放宽一些
+    const float min = zone_map.min.float_value - static_cast<float>(EPSILON);
+    const float max = zone_map.max.float_value + static_cast<float>(EPSILON);
+    return comp == NOT_EQUAL || may_match_range(comp, min, max, bound.float_value);
+  }
+  return may_match_range(comp, zone_map.min.int_value, zone_map.max.int_value, bound.int_value);
+}
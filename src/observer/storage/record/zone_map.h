@@ -0,0 +1,67 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "common/value.h"
+#include "sql/parser/parse_defs.h"
+
+/**
+ * @brief PAX 页面中一列数据的摘要（zone map）
+ * @ingroup RecordManager
+ * @details 保存在页面中，记录页面中一列数据的最小值和最大值。扫描时根据下推的过滤条件判断整个页面是否可能有
+ * 满足条件的记录，不可能有的页面直接跳过，不需要把数据复制到 chunk 中。
+ * 目前只支持 4 字节的 INTS、DATES 和 FLOATS 列，其它类型的列不记录摘要，也不会用来跳过页面。
+ * 删除记录时不缩小范围（页面被删空时除外），页面中的数据总是在 [min, max] 之内，只是范围可能偏大。
+ * MiniOB 目前不支持 NULL，所以没有记录 NULL 的个数。
+ */
+struct ZoneMap
+{
+  union Bound
+  {
+    int32_t int_value;
+    float   float_value;
+  };
+
+  int32_t attr_type;  ///< 列的类型，不支持摘要的列是 AttrType::UNDEFINED
+  int32_t has_value;  ///< 页面中没有数据时 min/max 没有意义
+  Bound   min;
+  Bound   max;
+
+  /// 是否支持记录这个类型的列
+  static bool support(AttrType type, int attr_len);
+
+  void init(AttrType type, int attr_len);
+
+  /// 页面中的数据全部删除了，重新开始记录
+  void clear() { has_value = 0; }
+
+  /// 写入了一个新的值
+  void update(const char *data);
+};
+
+/**
+ * @brief 可以使用 zone map 判断的过滤条件：字段 op 常量
+ * @ingroup RecordManager
+ */
+struct ZoneMapPredicate
+{
+  int    field_id = -1;
+  CompOp comp     = NO_OP;
+  Value  value;
+
+  /**
+   * @brief 页面中是否可能有满足条件的记录
+   * @details 无法判断时返回 true
+   */
+  bool may_match(const ZoneMap &zone_map) const;
+};
@@ -12,8 +12,10 @@ See the Mulan PSL v2 for more details. */
 #include "storage/record/heap_record_scanner.h"
 #include "common/log/log.h"
 #include "storage/index/bplus_tree_index.h"
+#include "storage/index/ivfflat_index.h"
 #include "storage/common/meta_util.h"
 #include "storage/db/db.h"
+#include "session/session.h"
 
 
 HeapTableEngine::~HeapTableEngine()
@@ -122,102 +124,164 @@ RC HeapTableEngine::get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadW
   return rc;
 }
 
-RC HeapTableEngine::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name)
+RC HeapTableEngine::init_page_morsels(PageMorselQueue &morsels)
 {
-  if (common::is_blank(index_name) || nullptr == field_meta) {
+#ifdef CONCURRENCY
+  // 第一个页面是 buffer pool 的文件头
+  morsels.init(1, data_buffer_pool_->page_count());
+  return RC::SUCCESS;
+#else
+  // 没有开启 CONCURRENCY 时 buffer pool 和页面的锁都是空操作，不能多个线程同时访问
+  return RC::UNSUPPORTED;
+#endif
+}
+
+RC HeapTableEngine::get_chunk_scanner(
+    ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode, PageMorselQueue &morsels)
+{
+  RC rc = scanner.open_scan_chunk(table_, *data_buffer_pool_, db_->log_handler(), mode, morsels);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("failed to open scanner. rc=%s", strrc(rc));
+  }
+  return rc;
+}
+
+RC HeapTableEngine::create_index(Trx *trx, const vector<const FieldMeta *> &field_metas, const char *index_name)
+{
+  if (common::is_blank(index_name) || field_metas.empty()) {
     LOG_INFO("Invalid input arguments, table name is %s, index_name is blank or attribute_name is blank", table_meta_->name());
     return RC::INVALID_ARGUMENT;
   }
 
   IndexMeta new_index_meta;
 
-  RC rc = new_index_meta.init(index_name, *field_meta);
+  RC rc = new_index_meta.init(index_name, field_metas);
   if (rc != RC::SUCCESS) {
     LOG_INFO("Failed to init IndexMeta in table:%s, index_name:%s, field_name:%s", 
-             table_meta_->name(), index_name, field_meta->name());
+             table_meta_->name(), index_name, field_metas[0]->name());
     return rc;
   }
 
+  vector<FieldMeta> index_field_metas;
+  for (const FieldMeta *field_meta : field_metas) {
+    index_field_metas.push_back(*field_meta);
+  }
+
   // 创建索引相关数据
   BplusTreeIndex *index      = new BplusTreeIndex();
   string          index_file = table_index_file(db_->path().c_str(), table_meta_->name(), index_name);
 
-  rc = index->create(table_, index_file.c_str(), new_index_meta, *field_meta);
+  rc = index->create(table_, index_file.c_str(), new_index_meta, index_field_metas);
   if (rc != RC::SUCCESS) {
     delete index;
     LOG_ERROR("Failed to create bplus tree index. file name=%s, rc=%d:%s", index_file.c_str(), rc, strrc(rc));
     return rc;
   }
 
-  // 遍历当前的所有数据，插入这个索引
+  // 遍历当前的所有数据，排序后批量构建索引
   RecordScanner *scanner = nullptr;
   rc = get_record_scanner(scanner, trx, ReadWriteMode::READ_ONLY);
   if (rc != RC::SUCCESS) {
+    delete index;
     LOG_WARN("failed to create scanner while creating index. table=%s, index=%s, rc=%s", 
              table_meta_->name(), index_name, strrc(rc));
     return rc;
   }
 
-  Record record;
-  while (OB_SUCC(rc = scanner->next(record))) {
-    rc = index->insert_entry(record.data(), &record.rid());
-    if (rc != RC::SUCCESS) {
-      LOG_WARN("failed to insert record into index while creating index. table=%s, index=%s, rc=%s",
-               table_meta_->name(), index_name, strrc(rc));
-      return rc;
-    }
-  }
-  if (RC::RECORD_EOF == rc) {
-    rc = RC::SUCCESS;
-  } else {
-    LOG_WARN("failed to insert record into index while creating index. table=%s, index=%s, rc=%s",
-             table_meta_->name(), index_name, strrc(rc));
-    return rc;
-  }
+  Session *session     = Session::current_session();
+  int      fill_factor = session != nullptr ? session->index_fill_factor() : Session::DEFAULT_INDEX_FILL_FACTOR;
+  rc = index->bulk_load(*scanner, fill_factor, INDEX_BUILD_SORT_MEMORY);
   scanner->close_scan();
   delete scanner;
+  if (rc != RC::SUCCESS) {
+    delete index;
+    LOG_WARN("failed to build index. table=%s, index=%s, rc=%s", table_meta_->name(), index_name, strrc(rc));
+    return rc;
+  }
   LOG_INFO("inserted all records into new index. table=%s, index=%s", table_meta_->name(), index_name);
 
   indexes_.push_back(index);
 
-  /// 接下来将这个索引放到表的元数据中
-  TableMeta new_table_meta(*table_meta_);
-  rc = new_table_meta.add_index(new_index_meta);
+  rc = add_index_meta(db_->path().c_str(), new_index_meta);
   if (rc != RC::SUCCESS) {
-    LOG_ERROR("Failed to add index (%s) on table (%s). error=%d:%s", index_name, table_meta_->name(), rc, strrc(rc));
     return rc;
   }
 
-  /// 内存中有一份元数据，磁盘文件也有一份元数据。修改磁盘文件时，先创建一个临时文件，写入完成后再rename为正式文件
-  /// 这样可以防止文件内容不完整
-  // 创建元数据临时文件
-  string  tmp_file = table_meta_file(db_->path().c_str(), table_meta_->name()) + ".tmp";
-  fstream fs;
-  fs.open(tmp_file, ios_base::out | ios_base::binary | ios_base::trunc);
-  if (!fs.is_open()) {
-    LOG_ERROR("Failed to open file for write. file name=%s, errmsg=%s", tmp_file.c_str(), strerror(errno));
-    return RC::IOERR_OPEN;  // 创建索引中途出错，要做还原操作
+  LOG_INFO("Successfully added a new index (%s) on the table (%s)", index_name, table_meta_->name());
+  return rc;
+}
+
+RC HeapTableEngine::create_vector_index(
+    Trx *trx, const FieldMeta *field_meta, const char *index_name, const IvfflatOptions &options)
+{
+  if (common::is_blank(index_name) || field_meta == nullptr) {
+    LOG_INFO("Invalid input arguments, table name is %s, index_name is blank or attribute_name is blank", table_meta_->name());
+    return RC::INVALID_ARGUMENT;
   }
-  if (new_table_meta.serialize(fs) < 0) {
-    LOG_ERROR("Failed to dump new table meta to file: %s. sys err=%d:%s", tmp_file.c_str(), errno, strerror(errno));
-    return RC::IOERR_WRITE;
+
+  IndexMeta new_index_meta;
+
+  RC rc = new_index_meta.init(index_name, {field_meta});
+  if (rc != RC::SUCCESS) {
+    LOG_INFO("Failed to init IndexMeta in table:%s, index_name:%s, field_name:%s",
+             table_meta_->name(), index_name, field_meta->name());
+    return rc;
   }
-  fs.close();
+  new_index_meta.set_ivfflat_options(options);
 
-  // 覆盖原始元数据文件
-  string meta_file = table_meta_file(db_->path().c_str(), table_meta_->name());
+  IvfflatIndex *index      = new IvfflatIndex();
+  string        index_file = table_index_file(db_->path().c_str(), table_meta_->name(), index_name);
 
-  int ret = rename(tmp_file.c_str(), meta_file.c_str());
-  if (ret != 0) {
-    LOG_ERROR("Failed to rename tmp meta file (%s) to normal meta file (%s) while creating index (%s) on table (%s). "
-              "system error=%d:%s",
-              tmp_file.c_str(), meta_file.c_str(), index_name, table_meta_->name(), errno, strerror(errno));
-    return RC::IOERR_WRITE;
+  rc = index->create(table_, index_file.c_str(), new_index_meta, {*field_meta});
+  if (rc != RC::SUCCESS) {
+    delete index;
+    LOG_ERROR("Failed to create ivfflat index. file name=%s, rc=%d:%s", index_file.c_str(), rc, strrc(rc));
+    return rc;
   }
 
-  table_meta_->swap(new_table_meta);
+  // 第一遍扫描采样训练聚类中心，第二遍扫描把所有数据放入倒排链表
+  RecordScanner *scanner = nullptr;
+  rc = get_record_scanner(scanner, trx, ReadWriteMode::READ_ONLY);
+  if (OB_SUCC(rc)) {
+    rc = index->train(*scanner);
+    scanner->close_scan();
+    delete scanner;
+    scanner = nullptr;
+  }
 
-  LOG_INFO("Successfully added a new index (%s) on the table (%s)", index_name, table_meta_->name());
+  if (OB_SUCC(rc)) {
+    rc = get_record_scanner(scanner, trx, ReadWriteMode::READ_ONLY);
+  }
+  if (OB_SUCC(rc)) {
+    Record record;
+    while (OB_SUCC(rc = scanner->next(record))) {
+      rc = index->insert_entry(record.data(), &record.rid());
+      if (OB_FAIL(rc)) {
+        break;
+      }
+    }
+    if (rc == RC::RECORD_EOF) {
+      rc = RC::SUCCESS;
+    }
+    scanner->close_scan();
+    delete scanner;
+  }
+
+  if (OB_FAIL(rc)) {
+    delete index;
+    LOG_WARN("failed to build vector index. table=%s, index=%s, rc=%s", table_meta_->name(), index_name, strrc(rc));
+    return rc;
+  }
+  LOG_INFO("inserted all records into new vector index. table=%s, index=%s", table_meta_->name(), index_name);
+
+  indexes_.push_back(index);
+
+  rc = add_index_meta(db_->path().c_str(), new_index_meta);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  LOG_INFO("Successfully added a new vector index (%s) on the table (%s)", index_name, table_meta_->name());
   return rc;
 }
 
@@ -316,19 +380,22 @@ RC HeapTableEngine::open()
   const int index_num = table_meta_->index_num();
   for (int i = 0; i < index_num; i++) {
     const IndexMeta *index_meta = table_meta_->index(i);
-    const FieldMeta *field_meta = table_meta_->field(index_meta->field());
-    if (field_meta == nullptr) {
-      LOG_ERROR("Found invalid index meta info which has a non-exists field. table=%s, index=%s, field=%s",
-                table_meta_->name(), index_meta->name(), index_meta->field());
+    vector<FieldMeta> field_metas;
+    if (OB_FAIL(rc = index_meta->field_metas(*table_meta_, field_metas))) {
       // skip cleanup
       //  do all cleanup action in destructive Table function
       return RC::INTERNAL;
     }
 
-    BplusTreeIndex *index      = new BplusTreeIndex();
-    string          index_file = table_index_file(db_->path().c_str(), table_meta_->name(), index_meta->name());
+    Index *index = nullptr;
+    if (index_meta->type() == IndexType::IVFFLAT) {
+      index = new IvfflatIndex();
+    } else {
+      index = new BplusTreeIndex();
+    }
+    string index_file = table_index_file(db_->path().c_str(), table_meta_->name(), index_meta->name());
 
-    rc = index->open(table_, index_file.c_str(), *index_meta, *field_meta);
+    rc = index->open(table_, index_file.c_str(), *index_meta, field_metas);
     if (rc != RC::SUCCESS) {
       delete index;
       LOG_ERROR("Failed to open index. table=%s, index=%s, file=%s, rc=%s",
@@ -37,9 +37,13 @@ public:
   }
   RC get_record(const RID &rid, Record &record) override;
 
-  RC create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name) override;
+  RC create_index(Trx *trx, const vector<const FieldMeta *> &field_metas, const char *index_name) override;
+  RC create_vector_index(
+      Trx *trx, const FieldMeta *field_meta, const char *index_name, const IvfflatOptions &options) override;
   RC get_record_scanner(RecordScanner *&scanner, Trx *trx, ReadWriteMode mode) override;
   RC get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode) override;
+  RC init_page_morsels(PageMorselQueue &morsels) override;
+  RC get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode, PageMorselQueue &morsels) override;
   RC visit_record(const RID &rid, function<bool(Record &)> visitor) override;
   RC sync() override;
 
@@ -54,6 +58,8 @@ private:
   RC delete_entry_of_indexes(const char *record, const RID &rid, bool error_on_not_exists);
 
 private:
+  static constexpr size_t INDEX_BUILD_SORT_MEMORY = 64 * 1024 * 1024;  /// 创建索引时外部排序可以使用的内存
+
   DiskBufferPool    *data_buffer_pool_ = nullptr;  /// 数据文件关联的buffer pool
   RecordFileHandler *record_handler_   = nullptr;  /// 记录操作
   vector<Index *>    indexes_;
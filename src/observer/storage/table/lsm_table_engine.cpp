@@ -11,21 +11,215 @@ See the Mulan PSL v2 for more details. */
 #include "storage/table/lsm_table_engine.h"
 #include "storage/record/heap_record_scanner.h"
 #include "common/log/log.h"
-#include "storage/index/bplus_tree_index.h"
 #include "storage/common/meta_util.h"
 #include "storage/db/db.h"
 #include "storage/record/lsm_record_scanner.h"
 #include "storage/common/codec.h"
 #include "storage/trx/lsm_mvcc_trx.h"
 
-RC LsmTableEngine::insert_record(Record &record)
+LsmTableEngine::~LsmTableEngine()
+{
+  for (LsmIndex *index : indexes_) {
+    delete index;
+  }
+  indexes_.clear();
+}
+
+RC LsmTableEngine::assign_row_key(Record &record)
 {
-  RC rc = RC::SUCCESS;
-  // TODO: set auto increment id, and keep durability.
   // TODO: support set primary key as a part of lsm_key.
+  uint64_t id = inc_id_.fetch_add(1);
+  bytes    lsm_key;
+  RC       rc = Codec::encode(table_->table_id(), id, lsm_key);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to encode lsm key. table=%s, rc=%s", table_meta_->name(), strrc(rc));
+    return rc;
+  }
+  record.set_key(string((char *)lsm_key.data(), lsm_key.size()));
+  record.set_rid(make_rid(id));
+  return rc;
+}
+
+ObLsmTransaction *LsmTableEngine::lsm_trx(Trx *trx)
+{
+  if (trx == nullptr || trx->type() != TrxKit::Type::LSM) {
+    return nullptr;
+  }
+  auto lsm_mvcc_trx = static_cast<LsmMvccTrx *>(trx);
+  lsm_mvcc_trx->start_if_need();
+  return lsm_mvcc_trx->get_trx();
+}
+
+RC LsmTableEngine::make_index_entries(const char *record, uint64_t id, bool remove, vector<pair<string, string>> &kvs)
+{
+  RC rc = RC::SUCCESS;
+  for (LsmIndex *index : indexes_) {
+    string key;
+    string value;
+    if (OB_FAIL(rc = index->make_entry(record, id, key, value))) {
+      LOG_WARN("failed to make index entry. table=%s, index=%s, rc=%s",
+               table_meta_->name(), index->index_meta().name(), strrc(rc));
+      return rc;
+    }
+    if (remove) {
+      value.clear();
+    }
+    kvs.emplace_back(std::move(key), std::move(value));
+  }
+  return rc;
+}
+
+RC LsmTableEngine::write_batch(ObLsmTransaction *txn, const vector<pair<string, string>> &kvs)
+{
+  if (txn == nullptr) {
+    return lsm_->batch_put(kvs);
+  }
+
+  RC rc = RC::SUCCESS;
+  for (const auto &[key, value] : kvs) {
+    rc = value.empty() ? txn->remove(key) : txn->put(key, value);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  return rc;
+}
+
+RC LsmTableEngine::insert_record(Record &record) { return insert_record_with_trx(record, nullptr); }
+
+RC LsmTableEngine::insert_chunk(const Chunk &chunk)
+{
+  RC                           rc          = RC::SUCCESS;
+  const int                    record_size = table_meta_->record_size();
+  vector<pair<string, string>> kvs;
+  kvs.reserve(chunk.rows() * (1 + indexes_.size()));
+
+  vector<const FieldMeta *> fields(chunk.column_num(), nullptr);
+  for (int i = 0; i < chunk.column_num(); i++) {
+    for (int j = 0; j < table_meta_->field_num(); j++) {
+      if (table_meta_->field(j)->field_id() == chunk.column_ids(i)) {
+        fields[i] = table_meta_->field(j);
+        break;
+      }
+    }
+    if (fields[i] == nullptr) {
+      LOG_WARN("no such field in table. table=%s, field id=%d", table_meta_->name(), chunk.column_ids(i));
+      return RC::SCHEMA_FIELD_NOT_EXIST;
+    }
+  }
+
+  for (int row = 0; row < chunk.rows(); row++) {
+    Record record;
+    if (OB_FAIL(rc = assign_row_key(record))) {
+      return rc;
+    }
+    string value(record_size, 0);
+    for (int i = 0; i < chunk.column_num(); i++) {
+      const Column &column = chunk.column(i);
+      memcpy(value.data() + fields[i]->offset(), column.data() + row * column.attr_len(), fields[i]->len());
+    }
+    if (OB_FAIL(rc = make_index_entries(value.data(), row_id(record.rid()), false /*remove*/, kvs))) {
+      return rc;
+    }
+    kvs.emplace_back(record.key(), std::move(value));
+  }
+
+  rc = lsm_->batch_put(kvs);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Insert chunk failed. table name=%s, rc=%s", table_meta_->name(), strrc(rc));
+  }
+  return rc;
+}
+
+RC LsmTableEngine::delete_record(const Record &record) { return delete_record_with_trx(record, nullptr); }
+
+RC LsmTableEngine::insert_record_with_trx(Record &record, Trx *trx)
+{
+  RC rc = assign_row_key(record);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  vector<pair<string, string>> kvs;
+  if (OB_FAIL(rc = make_index_entries(record.data(), row_id(record.rid()), false /*remove*/, kvs))) {
+    return rc;
+  }
+  kvs.emplace_back(record.key(), string(record.data(), record.len()));
+  return write_batch(lsm_trx(trx), kvs);
+}
+
+RC LsmTableEngine::delete_record_with_trx(const Record &record, Trx *trx)
+{
+  vector<pair<string, string>> kvs;
+  RC rc = make_index_entries(record.data(), row_id(record.rid()), true /*remove*/, kvs);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  kvs.emplace_back(record.key(), string());
+  return write_batch(lsm_trx(trx), kvs);
+}
+
+RC LsmTableEngine::update_record_with_trx(const Record &old_record, const Record &new_record, Trx *trx)
+{
+  const uint64_t               id = row_id(old_record.rid());
+  vector<pair<string, string>> old_entries;
+  vector<pair<string, string>> kvs;
+  RC                           rc = RC::SUCCESS;
+  if (OB_FAIL(rc = make_index_entries(old_record.data(), id, true /*remove*/, old_entries)) ||
+      OB_FAIL(rc = make_index_entries(new_record.data(), id, false /*remove*/, kvs))) {
+    return rc;
+  }
+
+  // 索引键没有变化的索引项不需要删除
+  for (size_t i = 0; i < old_entries.size(); i++) {
+    if (old_entries[i].first != kvs[i].first) {
+      kvs.push_back(std::move(old_entries[i]));
+    }
+  }
+  kvs.emplace_back(old_record.key(), string(new_record.data(), new_record.len()));
+  return write_batch(lsm_trx(trx), kvs);
+}
+
+RC LsmTableEngine::get_record(const RID &rid, Record &record) { return get_record_with_trx(rid, record, nullptr); }
+
+RC LsmTableEngine::get_record_with_trx(const RID &rid, Record &record, Trx *trx)
+{
   bytes lsm_key;
-  Codec::encode(table_->table_id(), inc_id_.fetch_add(1), lsm_key);
-  rc = lsm_->put(string_view((char *)lsm_key.data(), lsm_key.size()), string_view(record.data(), record.len()));
+  RC    rc = Codec::encode(table_->table_id(), row_id(rid), lsm_key);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to encode lsm key. table=%s, rc=%s", table_meta_->name(), strrc(rc));
+    return rc;
+  }
+
+  string key((char *)lsm_key.data(), lsm_key.size());
+  string            value;
+  ObLsmTransaction *txn = lsm_trx(trx);
+  rc                    = txn == nullptr ? lsm_->get(key, &value) : txn->get(key, &value);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get record. rid=%s, table=%s, rc=%s", rid.to_string().c_str(), table_meta_->name(), strrc(rc));
+    return rc == RC::NOT_EXIST ? RC::RECORD_NOT_EXIST : rc;
+  }
+  record.set_key(key);
+  record.set_rid(rid);
+  record.copy_data(value.data(), value.size());
+  return rc;
+}
+
+RC LsmTableEngine::visit_record(const RID &rid, function<bool(Record &)> visitor)
+{
+  Record record;
+  RC     rc = get_record(rid, record);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  Record old_record;
+  old_record.copy_data(record.data(), record.len());
+  old_record.set_rid(rid);
+  old_record.set_key(record.key());
+  if (visitor(record)) {
+    rc = update_record_with_trx(old_record, record, nullptr);
+  }
   return rc;
 }
 
@@ -39,7 +233,208 @@ RC LsmTableEngine::get_record_scanner(RecordScanner *&scanner, Trx *trx, ReadWri
   return rc;
 }
 
+RC LsmTableEngine::get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode)
+{
+  bytes prefix;
+  RC    rc = Codec::encode_table_prefix(table_->table_id(), prefix);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to encode table prefix. table=%s, rc=%s", table_meta_->name(), strrc(rc));
+    return rc;
+  }
+
+  ObLsmTransaction *txn      = lsm_trx(trx);
+  ObLsmIterator    *lsm_iter = txn == nullptr ? lsm_->new_iterator(ObLsmReadOptions())
+                                              : txn->new_iterator(ObLsmReadOptions());
+  string            table_prefix((char *)prefix.data(), prefix.size());
+  lsm_iter->seek(table_prefix);
+  rc = scanner.open_scan_chunk(table_, lsm_iter, table_prefix);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("failed to open scanner. rc=%s", strrc(rc));
+  }
+  return rc;
+}
+
+RC LsmTableEngine::create_index(Trx *trx, const vector<const FieldMeta *> &field_metas, const char *index_name)
+{
+  if (common::is_blank(index_name) || field_metas.empty()) {
+    LOG_INFO("Invalid input arguments, table name is %s, index_name is blank or attribute_name is blank", table_meta_->name());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  IndexMeta new_index_meta;
+
+  RC rc = new_index_meta.init(index_name, field_metas);
+  if (rc != RC::SUCCESS) {
+    LOG_INFO("Failed to init IndexMeta in table:%s, index_name:%s, field_name:%s",
+             table_meta_->name(), index_name, field_metas[0]->name());
+    return rc;
+  }
+
+  vector<FieldMeta> index_field_metas;
+  for (const FieldMeta *field_meta : field_metas) {
+    index_field_metas.push_back(*field_meta);
+  }
+
+  // 索引在表元数据中的位置作为 index_id
+  unique_ptr<LsmIndex> index = make_unique<LsmIndex>(lsm_, table_->table_id(), table_meta_->index_num());
+  if (OB_FAIL(rc = index->create(table_, nullptr, new_index_meta, index_field_metas))) {
+    LOG_WARN("failed to create lsm index. table=%s, index=%s, rc=%s", table_meta_->name(), index_name, strrc(rc));
+    return rc;
+  }
+
+  // 遍历当前的所有数据，分批写入这个索引
+  bytes prefix;
+  if (OB_FAIL(rc = Codec::encode_table_prefix(table_->table_id(), prefix))) {
+    LOG_WARN("failed to encode table prefix. table=%s, rc=%s", table_meta_->name(), strrc(rc));
+    return rc;
+  }
+
+  static constexpr size_t      BATCH_SIZE = 1024;
+  string                       table_prefix((char *)prefix.data(), prefix.size());
+  ObLsmTransaction            *txn = lsm_trx(trx);
+  unique_ptr<ObLsmIterator>    lsm_iter(txn == nullptr ? lsm_->new_iterator(ObLsmReadOptions())
+                                                       : txn->new_iterator(ObLsmReadOptions()));
+  vector<pair<string, string>> kvs;
+  for (lsm_iter->seek(table_prefix); lsm_iter->valid() && lsm_iter->key().starts_with(table_prefix); lsm_iter->next()) {
+    string_view key = lsm_iter->key();
+    bytes       key_bytes(key.begin(), key.end());
+    int64_t     table_id = 0;
+    uint64_t    id       = 0;
+    string      entry_key;
+    string      entry_value;
+    if (OB_FAIL(rc = Codec::decode(key_bytes, table_id, id)) ||
+        OB_FAIL(rc = index->make_entry(lsm_iter->value().data(), id, entry_key, entry_value))) {
+      LOG_WARN("failed to make index entry while creating index. table=%s, index=%s, rc=%s",
+               table_meta_->name(), index_name, strrc(rc));
+      return rc;
+    }
+    kvs.emplace_back(std::move(entry_key), std::move(entry_value));
+    if (kvs.size() >= BATCH_SIZE) {
+      if (OB_FAIL(rc = write_batch(txn, kvs))) {
+        LOG_WARN("failed to insert index entries. table=%s, index=%s, rc=%s", table_meta_->name(), index_name, strrc(rc));
+        return rc;
+      }
+      kvs.clear();
+    }
+  }
+  if (OB_FAIL(rc = write_batch(txn, kvs))) {
+    LOG_WARN("failed to insert index entries. table=%s, index=%s, rc=%s", table_meta_->name(), index_name, strrc(rc));
+    return rc;
+  }
+  LOG_INFO("inserted all records into new index. table=%s, index=%s", table_meta_->name(), index_name);
+
+  indexes_.push_back(index.release());
+
+  rc = add_index_meta(db_->path().c_str(), new_index_meta);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  LOG_INFO("Successfully added a new index (%s) on the table (%s)", index_name, table_meta_->name());
+  return rc;
+}
+
+Index *LsmTableEngine::find_index(const char *index_name) const
+{
+  for (LsmIndex *index : indexes_) {
+    if (0 == strcmp(index->index_meta().name(), index_name)) {
+      return index;
+    }
+  }
+  return nullptr;
+}
+
+Index *LsmTableEngine::find_index_by_field(const char *field_name) const
+{
+  const IndexMeta *index_meta = table_meta_->find_index_by_field(field_name);
+  if (index_meta != nullptr) {
+    return this->find_index(index_meta->name());
+  }
+  return nullptr;
+}
+
+RC LsmTableEngine::init()
+{
+  // 行的 key 是 (table_id, "r", rid)，按 rid 递增排列，下一个 rid 是最大的 rid 加 1。
+  // 迭代器不支持反向遍历，这里按 rid 二分查找：seek 到 rid >= mid 的第一条记录，只要还在本表的前缀之内，
+  // 就说明存在不小于 mid 的 rid。最多 64 次 seek，打开表时不需要扫描所有的记录。
+  bytes prefix;
+  RC    rc = Codec::encode_table_prefix(table_->table_id(), prefix);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to encode table prefix. table=%s, rc=%s", table_meta_->name(), strrc(rc));
+    return rc;
+  }
+
+  string                    table_prefix((char *)prefix.data(), prefix.size());
+  unique_ptr<ObLsmIterator> lsm_iter(lsm_->new_iterator(ObLsmReadOptions()));
+  uint64_t                  found_id = 0;  // 已经确认存在的 rid（的下界）
+  bool                      has_row  = false;
+  auto seek_row = [&](uint64_t id, bool &found) -> RC {
+    bytes key;
+    RC    ret = Codec::encode(table_->table_id(), id, key);
+    if (OB_FAIL(ret)) {
+      return ret;
+    }
+    lsm_iter->seek(string_view((char *)key.data(), key.size()));
+    found = lsm_iter->valid() && lsm_iter->key().starts_with(table_prefix);
+    if (!found) {
+      return ret;
+    }
+    string_view row_key = lsm_iter->key();
+    bytes       key_bytes(row_key.begin(), row_key.end());
+    int64_t     table_id = 0;
+    return Codec::decode(key_bytes, table_id, found_id);
+  };
+
+  if (OB_FAIL(rc = seek_row(0, has_row))) {
+    LOG_WARN("failed to seek lsm key. table=%s, rc=%s", table_meta_->name(), strrc(rc));
+    return rc;
+  }
+  if (has_row) {
+    uint64_t low  = found_id;  // 存在 rid >= low 的记录
+    uint64_t high = UINT64_MAX;  // 不存在 rid > high 的记录
+    while (low < high) {
+      const uint64_t mid   = low + (high - low) / 2 + 1;
+      bool           found = false;
+      if (OB_FAIL(rc = seek_row(mid, found))) {
+        LOG_WARN("failed to seek lsm key. table=%s, rc=%s", table_meta_->name(), strrc(rc));
+        return rc;
+      }
+      if (found) {
+        low = found_id;
+      } else {
+        high = mid - 1;
+      }
+    }
+    found_id = low;
+  }
+  inc_id_.store(has_row ? found_id + 1 : 0);
+  return rc;
+}
+
 RC LsmTableEngine::open()
 {
-  return RC::UNIMPLEMENTED;
-}
\ No newline at end of file
+  RC rc = init();
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  const int index_num = table_meta_->index_num();
+  for (int i = 0; i < index_num; i++) {
+    const IndexMeta *index_meta = table_meta_->index(i);
+    vector<FieldMeta> field_metas;
+    if (OB_FAIL(rc = index_meta->field_metas(*table_meta_, field_metas))) {
+      return RC::INTERNAL;
+    }
+
+    LsmIndex *index = new LsmIndex(lsm_, table_->table_id(), i);
+    rc              = index->open(table_, nullptr, *index_meta, field_metas);
+    if (rc != RC::SUCCESS) {
+      delete index;
+      LOG_ERROR("Failed to open index. table=%s, index=%s, rc=%s", table_meta_->name(), index_meta->name(), strrc(rc));
+      return rc;
+    }
+    indexes_.push_back(index);
+  }
+  return rc;
+}
@@ -12,6 +12,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "storage/table/table_engine.h"
 #include "storage/index/index.h"
+#include "storage/index/lsm_index.h"
 #include "storage/record/record_manager.h"
 #include "storage/db/db.h"
 #include "oblsm/include/ob_lsm.h"
@@ -19,6 +20,9 @@ using namespace oceanbase;
 
 /**
  * @brief lsm table engine
+ * @details 每条记录以 key-value 的形式保存在 oblsm 中，key 是 Codec::encode(table_id, row_id)，value 是记录的数据。
+ * row_id 是表内自增的整数，同时也作为记录的 RID（page_num 为高 32 位，slot_num 为低 32 位）。
+ * 二级索引的索引项（参考 LsmIndex）与记录放在同一个写批次或同一个事务中写入。
  */
 class LsmTableEngine : public TableEngine
 {
@@ -26,33 +30,68 @@ public:
   LsmTableEngine(TableMeta *table_meta, Db *db, Table *table)
       : TableEngine(table_meta), db_(db), table_(table), lsm_(db->lsm())
   {}
-  ~LsmTableEngine() override = default;
+  ~LsmTableEngine() override;
 
   RC insert_record(Record &record) override;
-  RC insert_chunk(const Chunk &chunk) override { return RC::UNIMPLEMENTED; }
-  RC delete_record(const Record &record) override { return RC::UNIMPLEMENTED; }
-  RC insert_record_with_trx(Record &record, Trx *trx) override { return RC::UNIMPLEMENTED; }
-  RC delete_record_with_trx(const Record &record, Trx *trx) override { return RC::UNIMPLEMENTED; }
-  RC update_record_with_trx(const Record &old_record, const Record &new_record, Trx *trx) override
+  RC insert_chunk(const Chunk &chunk) override;
+  RC delete_record(const Record &record) override;
+  RC insert_record_with_trx(Record &record, Trx *trx) override;
+  RC delete_record_with_trx(const Record &record, Trx *trx) override;
+  RC update_record_with_trx(const Record &old_record, const Record &new_record, Trx *trx) override;
+  RC get_record(const RID &rid, Record &record) override;
+  RC get_record_with_trx(const RID &rid, Record &record, Trx *trx) override;
+
+  RC create_index(Trx *trx, const vector<const FieldMeta *> &field_metas, const char *index_name) override;
+  RC create_vector_index(
+      Trx *trx, const FieldMeta *field_meta, const char *index_name, const IvfflatOptions &options) override
   {
-    return RC::UNIMPLEMENTED;
+    return RC::UNSUPPORTED;
   }
-  RC get_record(const RID &rid, Record &record) override { return RC::UNIMPLEMENTED; }
-
-  RC create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name) override { return RC::UNIMPLEMENTED; }
   RC get_record_scanner(RecordScanner *&scanner, Trx *trx, ReadWriteMode mode) override;
-  RC get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode) override { return RC::UNIMPLEMENTED; }
-  RC visit_record(const RID &rid, function<bool(Record &)> visitor) override { return RC::UNIMPLEMENTED; }
-  // TODO:
+  RC get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode) override;
+  RC visit_record(const RID &rid, function<bool(Record &)> visitor) override;
   RC     sync() override { return RC::SUCCESS; }
-  Index *find_index(const char *index_name) const override { return nullptr; }
-  Index *find_index_by_field(const char *field_name) const override { return nullptr; }
+  Index *find_index(const char *index_name) const override;
+  Index *find_index_by_field(const char *field_name) const override;
   RC     open() override;
-  RC     init() override { return RC::UNIMPLEMENTED; }
+  RC     init() override;
+
+  static uint64_t row_id(const RID &rid)
+  {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(rid.page_num)) << 32) | static_cast<uint32_t>(rid.slot_num);
+  }
+  static RID make_rid(uint64_t row_id)
+  {
+    return RID{static_cast<PageNum>(row_id >> 32), static_cast<SlotNum>(row_id & 0xFFFFFFFF)};
+  }
+
+  /**
+   * @brief 获取 lsm-tree 上的事务，如果不是 lsm 事务返回 nullptr
+   */
+  static ObLsmTransaction *lsm_trx(Trx *trx);
+
+private:
+  /**
+   * @brief 为一条新记录分配 row_id，并设置记录的 key 和 RID
+   */
+  RC assign_row_key(Record &record);
+
+  /**
+   * @brief 生成一条记录在所有索引上的索引项
+   * @param remove 为 true 时生成删除索引项的 key-value（value 为空）
+   */
+  RC make_index_entries(const char *record, uint64_t id, bool remove, vector<pair<string, string>> &kvs);
+
+  /**
+   * @brief 原子地写入一批 key-value，value 为空表示删除
+   * @details 如果有 lsm 事务就写到事务中，否则作为一个批次写入 oblsm
+   */
+  RC write_batch(ObLsmTransaction *txn, const vector<pair<string, string>> &kvs);
 
 private:
-  Db              *db_;
-  Table           *table_;
-  ObLsm           *lsm_;
-  atomic<uint64_t> inc_id_{0};
-};
+  Db                *db_;
+  Table             *table_;
+  ObLsm             *lsm_;
+  vector<LsmIndex *> indexes_;
+  atomic<uint64_t>   inc_id_{0};
+};
\ No newline at end of file
@@ -206,6 +206,11 @@ RC Table::get_record(const RID &rid, Record &record)
   return engine_->get_record(rid, record);
 }
 
+RC Table::get_record_with_trx(const RID &rid, Record &record, Trx *trx)
+{
+  return engine_->get_record_with_trx(rid, record, trx);
+}
+
 const char *Table::name() const { return table_meta_.name(); }
 
 const TableMeta &Table::table_meta() const { return table_meta_; }
@@ -274,9 +279,22 @@ RC Table::get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode m
   return engine_->get_chunk_scanner(scanner, trx, mode);
 }
 
-RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name)
+RC Table::init_page_morsels(PageMorselQueue &morsels) { return engine_->init_page_morsels(morsels); }
+
+RC Table::get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode, PageMorselQueue &morsels)
+{
+  return engine_->get_chunk_scanner(scanner, trx, mode, morsels);
+}
+
+RC Table::create_index(Trx *trx, const vector<const FieldMeta *> &field_metas, const char *index_name)
+{
+  return engine_->create_index(trx, field_metas, index_name);
+}
+
+RC Table::create_vector_index(
+    Trx *trx, const FieldMeta *field_meta, const char *index_name, const IvfflatOptions &options)
 {
-  return engine_->create_index(trx, field_meta, index_name);
+  return engine_->create_vector_index(trx, field_meta, index_name, options);
 }
 
 RC Table::delete_record(const Record &record)
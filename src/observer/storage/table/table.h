@@ -28,6 +28,7 @@ class DiskBufferPool;
 class RecordFileHandler;
 class RecordScanner;
 class ChunkFileScanner;
+class PageMorselQueue;
 class ConditionFilter;
 class DefaultConditionFilter;
 class Index;
@@ -92,14 +93,23 @@ public:
   RC delete_record_with_trx(const Record &record, Trx *trx);
   RC update_record_with_trx(const Record &old_record, const Record &new_record, Trx *trx);
   RC get_record(const RID &rid, Record &record);
+  RC get_record_with_trx(const RID &rid, Record &record, Trx *trx);
 
   // TODO refactor
-  RC create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name);
+  RC create_index(Trx *trx, const vector<const FieldMeta *> &field_metas, const char *index_name);
+  RC create_vector_index(Trx *trx, const FieldMeta *field_meta, const char *index_name, const IvfflatOptions &options);
 
   RC get_record_scanner(RecordScanner *&scanner, Trx *trx, ReadWriteMode mode);
 
   RC get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode);
 
+  /**
+   * @brief 并行扫描。先用 init_page_morsels 切分页面，每个线程再各自获取一个只扫描领取到的页面的 scanner
+   * @details 存储引擎不支持并行扫描时返回 RC::UNSUPPORTED
+   */
+  RC init_page_morsels(PageMorselQueue &morsels);
+  RC get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode, PageMorselQueue &morsels);
+
   /**
    * @brief 可以在页面锁保护的情况下访问记录
    * @details 当前是在事务中访问记录，为了提供一个“原子性”的访问模式
@@ -21,6 +21,7 @@ class DiskBufferPool;
 class RecordFileHandler;
 class RecordScanner;
 class ChunkFileScanner;
+class PageMorselQueue;
 class ConditionFilter;
 class DefaultConditionFilter;
 class Index;
@@ -46,10 +47,29 @@ public:
   virtual RC update_record_with_trx(const Record &old_record, const Record &new_record, Trx *trx) = 0;
   virtual RC get_record(const RID &rid, Record &record)                                           = 0;
 
-  virtual RC     create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name) = 0;
+  /**
+   * @brief 在事务中读取一条记录，能看到事务自己还没有提交的修改
+   * @details 记录的可见性由事务自己判断的存储引擎（比如堆表）不需要区分，直接读取即可
+   */
+  virtual RC get_record_with_trx(const RID &rid, Record &record, Trx *trx) { return get_record(rid, record); }
+
+  virtual RC     create_index(Trx *trx, const vector<const FieldMeta *> &field_metas, const char *index_name) = 0;
+  virtual RC     create_vector_index(
+      Trx *trx, const FieldMeta *field_meta, const char *index_name, const IvfflatOptions &options) = 0;
   virtual RC     get_record_scanner(RecordScanner *&scanner, Trx *trx, ReadWriteMode mode)   = 0;
   virtual RC     get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode)  = 0;
   virtual RC     visit_record(const RID &rid, function<bool(Record &)> visitor)              = 0;
+
+  /**
+   * @brief 把表的数据页面切分成 morsel，多个线程分别使用 get_chunk_scanner 并行扫描
+   * @details 不支持并行扫描的存储引擎返回 RC::UNSUPPORTED，调用者应该退回到单线程扫描
+   */
+  virtual RC init_page_morsels(PageMorselQueue &morsels) { return RC::UNSUPPORTED; }
+  virtual RC get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode, PageMorselQueue &morsels)
+  {
+    return RC::UNSUPPORTED;
+  }
+
   virtual RC     sync()                                                                      = 0;
   virtual Index *find_index(const char *index_name) const                                    = 0;
   virtual Index *find_index_by_field(const char *field_name) const                           = 0;
@@ -57,6 +77,13 @@ public:
   // TODO: remove this function
   virtual RC init() = 0;
 
+protected:
+  /**
+   * @brief 将新的索引加入表的元数据，并持久化到元数据文件中
+   * @details 先写临时文件，再 rename 为正式文件，防止文件内容不完整
+   */
+  RC add_index_meta(const char *base_dir, const IndexMeta &index_meta);
+
 protected:
   TableMeta *table_meta_ = nullptr;
 };
@@ -55,17 +55,29 @@ RC LsmMvccTrx::start_if_need()
   return RC::SUCCESS;
 }
 
+/**
+ * 提交或回滚后释放 oblsm 的事务，下一条语句会以新的快照开始一个新的事务
+ */
 RC LsmMvccTrx::commit()
 {
   if (trx_ == nullptr) {
     return RC::SUCCESS;
   }
-  return trx_->commit();
+  RC rc = trx_->commit();
+  delete trx_;
+  trx_ = nullptr;
+  return rc;
 }
 
 RC LsmMvccTrx::rollback()
 {
-  return trx_->rollback();
+  if (trx_ == nullptr) {
+    return RC::SUCCESS;
+  }
+  RC rc = trx_->rollback();
+  delete trx_;
+  trx_ = nullptr;
+  return rc;
 }
 
 /**
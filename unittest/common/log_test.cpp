@@ -14,8 +14,13 @@ See the Mulan PSL v2 for more details. */
 
 #include "log_test.h"
 
+#include <unistd.h>
+
 #include "gtest/gtest.h"
 
+#include "common/lang/fstream.h"
+#include "common/lang/thread.h"
+#include "common/lang/vector.h"
 #include "common/log/log.h"
 
 using namespace common;
@@ -92,6 +97,53 @@ void testEnableTest()
 
 TEST(testEnableTest, CheckEnableTest) { testEnableTest(); }
 
+TEST(AsyncLogTest, MultiThreadTest)
+{
+  LogTest test;
+  test.init();
+
+  // 日志文件是追加写的，用进程号区分这次测试写的日志
+  const string marker     = "async log test pid:" + to_string(getpid()) + " ";
+  const int    thread_num = 4;
+  const int    line_num   = 2000;
+
+  vector<thread> threads;
+  for (int i = 0; i < thread_num; i++) {
+    threads.emplace_back([&marker, i]() {
+      for (int j = 0; j < line_num; j++) {
+        LOG_INFO("%sthread:%d line:%d", marker.c_str(), i, j);
+      }
+    });
+  }
+  for (thread &t : threads) {
+    t.join();
+  }
+
+  g_log->flush();
+
+  // 每个线程的日志都完整地写到了文件中，并且保持了打印的顺序
+  ifstream    ifs("test.log");
+  string      line;
+  vector<int> next_line(thread_num, 0);
+  while (getline(ifs, line)) {
+    size_t pos = line.find(marker);
+    if (pos == string::npos) {
+      continue;
+    }
+
+    int thread_index = -1;
+    int line_index   = -1;
+    ASSERT_EQ(sscanf(line.c_str() + pos + marker.size(), "thread:%d line:%d", &thread_index, &line_index), 2);
+    ASSERT_TRUE(thread_index >= 0 && thread_index < thread_num);
+    ASSERT_EQ(line_index, next_line[thread_index]);
+    next_line[thread_index]++;
+  }
+
+  for (int i = 0; i < thread_num; i++) {
+    ASSERT_EQ(next_line[i], line_num);
+  }
+}
+
 int main(int argc, char **argv)
 {
 
@@ -13,10 +13,26 @@ See the Mulan PSL v2 for more details. */
 #include "oblsm/table/ob_block.h"
 #include "oblsm/table/ob_block_builder.h"
 #include "oblsm/util/ob_comparator.h"
+#include "oblsm/util/ob_coding.h"
 
 using namespace oceanbase;
 
-TEST(block_test, DISABLED_block_builder_test_basic)
+static string internal_key(const string &user_key, uint64_t seq)
+{
+  string key(user_key);
+  put_numeric<uint64_t>(&key, seq);
+  return key;
+}
+
+static string lookup_key(const string &user_key, uint64_t seq)
+{
+  string key;
+  put_numeric<size_t>(&key, user_key.size() + sizeof(uint64_t));
+  key.append(internal_key(user_key, seq));
+  return key;
+}
+
+TEST(block_test, block_builder_test_basic)
 {
   ObBlockBuilder builder;
   ObDefaultComparator comparator;
@@ -33,7 +49,7 @@ TEST(block_test, DISABLED_block_builder_test_basic)
   ASSERT_EQ(block.size(), 4);
 }
 
-TEST(block_test, DISABLED_block_iterator_test_basic)
+TEST(block_test, block_iterator_test_basic)
 {
   ObBlockBuilder builder;
   ObDefaultComparator comparator;
@@ -48,7 +64,7 @@ TEST(block_test, DISABLED_block_iterator_test_basic)
   ObBlock block(&comparator);
   block.decode(string(block_contents.data(), block_contents.size()));
   ASSERT_EQ(block.size(), 4);
-  BlockIterator iter(&comparator, &block, block.size());
+  BlockIterator iter(&comparator, &block);
   iter.seek_to_first();
   ASSERT_TRUE(iter.valid());
   ASSERT_EQ(iter.key(), "key1");
@@ -59,6 +75,67 @@ TEST(block_test, DISABLED_block_iterator_test_basic)
   }
 }
 
+TEST(block_test, block_restart_and_seek)
+{
+  ObLsmOptions options;
+  options.block_size             = 64 * 1024;
+  options.block_restart_interval = 4;
+  ObBlockBuilder      builder(options);
+  ObDefaultComparator comparator;
+  const int           count = 1000;
+  for (int i = 0; i < count; i++) {
+    char user_key[32];
+    snprintf(user_key, sizeof(user_key), "common_prefix_key_%06d", i * 2);
+    ASSERT_EQ(builder.add(internal_key(user_key, i), "value" + to_string(i)), RC::SUCCESS);
+  }
+  string_view block_contents = builder.finish();
+  // keys share a long prefix, the compressed block must be much smaller than the raw keys
+  ASSERT_LT(block_contents.size(), count * (strlen("common_prefix_key_000000") + sizeof(uint64_t)));
+
+  ObBlock block(&comparator);
+  ASSERT_EQ(block.decode(string(block_contents.data(), block_contents.size())), RC::SUCCESS);
+  ASSERT_EQ(block.size(), count);
+
+  BlockIterator iter(&comparator, &block);
+  int           n = 0;
+  for (iter.seek_to_first(); iter.valid(); iter.next()) {
+    ASSERT_EQ(iter.value(), "value" + to_string(n));
+    n++;
+  }
+  ASSERT_EQ(n, count);
+
+  for (int i = 0; i < count * 2; i++) {
+    char user_key[32];
+    snprintf(user_key, sizeof(user_key), "common_prefix_key_%06d", i);
+    iter.seek(lookup_key(user_key, i));
+    // odd keys do not exist, seek lands on the next even key
+    int expect = (i + 1) / 2;
+    if (expect >= count) {
+      ASSERT_FALSE(iter.valid());
+      continue;
+    }
+    ASSERT_TRUE(iter.valid());
+    ASSERT_EQ(iter.value(), "value" + to_string(expect));
+  }
+
+  iter.seek_to_last();
+  ASSERT_TRUE(iter.valid());
+  ASSERT_EQ(iter.value(), "value" + to_string(count - 1));
+}
+
+TEST(block_test, block_builder_full)
+{
+  ObLsmOptions options;
+  options.block_size = 256;
+  ObBlockBuilder builder(options);
+  int            added = 0;
+  while (builder.add(internal_key("key" + to_string(added), added), "value") == RC::SUCCESS) {
+    added++;
+  }
+  ASSERT_GT(added, 0);
+  ASSERT_LE(builder.finish().size(), options.block_size);
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
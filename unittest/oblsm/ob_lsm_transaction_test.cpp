@@ -37,7 +37,7 @@ bool check_lsm_scan_result_by_value(ObLsmIterator* iter, const std::vector<std::
   return true;
 }
 
-TEST_F(ObLsmTransactionTest, DISABLED_oblsm_test_basic1)
+TEST_F(ObLsmTransactionTest, oblsm_test_basic1)
 { 
   db->put("key1", "value1");
   db->put("key2", "value2");
@@ -82,6 +82,44 @@ TEST_F(ObLsmTransactionTest, DISABLED_oblsm_test_basic1)
   delete txn3;
 }
 
+TEST_F(ObLsmTransactionTest, oblsm_test_seek_to_last)
+{
+  db->put("key1", "value1");
+  db->put("key3", "value3");
+
+  auto txn = db->begin_transaction();
+  auto iter = txn->new_iterator(ObLsmReadOptions());
+  iter->seek_to_last();
+  ASSERT_TRUE(iter->valid());
+  ASSERT_EQ(iter->key(), "key3");
+  delete iter;
+
+  // the key only in the transaction store is the last one
+  txn->put("key4", "value4");
+  iter = txn->new_iterator(ObLsmReadOptions());
+  iter->seek_to_last();
+  ASSERT_TRUE(iter->valid());
+  ASSERT_EQ(iter->value(), "value4");
+  delete iter;
+
+  // removed keys are skipped
+  txn->remove("key4");
+  txn->remove("key3");
+  iter = txn->new_iterator(ObLsmReadOptions());
+  iter->seek_to_last();
+  ASSERT_TRUE(iter->valid());
+  ASSERT_EQ(iter->key(), "key1");
+  delete iter;
+
+  txn->remove("key1");
+  iter = txn->new_iterator(ObLsmReadOptions());
+  iter->seek_to_last();
+  ASSERT_FALSE(iter->valid());
+  delete iter;
+
+  delete txn;
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
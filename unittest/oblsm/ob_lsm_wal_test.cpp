@@ -20,7 +20,7 @@ See the Mulan PSL v2 for more details. */
 
 using namespace oceanbase;
 
-TEST(wal, DISABLED_basic_test)
+TEST(wal, basic_test)
 {
   filesystem::remove_all("oblsm_tmp");
   filesystem::create_directory("oblsm_tmp");
@@ -53,7 +53,101 @@ TEST(wal, DISABLED_basic_test)
   EXPECT_EQ(p, count);
 }
 
-TEST(oblsm_wal_test, DISABLED_oblsm_recover_with_small_amount_of_data)
+TEST(wal, batch_test)
+{
+  filesystem::remove_all("oblsm_tmp");
+  filesystem::create_directory("oblsm_tmp");
+  auto rw_file = filesystem::path("oblsm_tmp") / "batch.wal";
+  WAL  wal;
+  EXPECT_EQ(wal.open(rw_file), RC::SUCCESS);
+
+  const int batch_count = 100;
+  const int batch_size  = 10;
+  for (int i = 0; i < batch_count; ++i) {
+    vector<string> keys;
+    vector<string> vals;
+    for (int j = 0; j < batch_size; ++j) {
+      keys.push_back("key" + std::to_string(i * batch_size + j));
+      vals.push_back("val" + std::to_string(i * batch_size + j));
+    }
+    WalBatch batch;
+    for (int j = 0; j < batch_size; ++j) {
+      batch.emplace_back(keys[j], vals[j]);
+    }
+    EXPECT_EQ(wal.put_batch(i * batch_size, batch), RC::SUCCESS);
+  }
+  EXPECT_EQ(wal.sync(), RC::SUCCESS);
+
+  // a torn record at the tail is ignored
+  string torn;
+  WAL::encode_batch(batch_count * batch_size, WalBatch{{"torn_key", "torn_val"}}, &torn);
+  EXPECT_EQ(wal.append(string_view(torn.data(), torn.size() - 3)), RC::SUCCESS);
+
+  std::vector<WalRecord> records;
+  EXPECT_EQ(wal.recover(rw_file, records), RC::SUCCESS);
+  ASSERT_EQ(records.size(), static_cast<size_t>(batch_count * batch_size));
+  for (size_t i = 0; i < records.size(); ++i) {
+    EXPECT_EQ(records[i].seq, i);
+    EXPECT_EQ(records[i].key, "key" + std::to_string(i));
+    EXPECT_EQ(records[i].val, "val" + std::to_string(i));
+  }
+}
+
+TEST(oblsm_wal_test, oblsm_batch_put_and_recover)
+{
+  filesystem::remove_all("oblsm_tmp");
+  filesystem::create_directory("oblsm_tmp");
+  ObLsmOptions options;
+  options.memtable_size      = 64 * 1024 * 1024;
+  options.force_sync_new_log = true;
+  ObLsm *lsm                 = nullptr;
+  ASSERT_EQ(ObLsm::open(options, "oblsm_tmp", &lsm), RC::SUCCESS);
+
+  const int                thread_count = 4;
+  const int                batch_count  = 50;
+  const int                batch_size   = 20;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_count; ++i) {
+    threads.emplace_back([i, lsm]() {
+      for (int j = 0; j < batch_count; ++j) {
+        vector<pair<string, string>> kvs;
+        for (int k = 0; k < batch_size; ++k) {
+          int seq = (i * batch_count + j) * batch_size + k;
+          kvs.emplace_back("key" + std::to_string(seq), "val" + std::to_string(seq));
+        }
+        EXPECT_EQ(lsm->batch_put(kvs), RC::SUCCESS);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  const int count = thread_count * batch_count * batch_size;
+  EXPECT_EQ(lsm->remove("key0"), RC::SUCCESS);
+  string value;
+  EXPECT_EQ(lsm->get("key0", &value), RC::NOT_EXIST);
+  delete lsm;
+
+  lsm = nullptr;
+  ASSERT_EQ(ObLsm::open(options, "oblsm_tmp", &lsm), RC::SUCCESS);
+  EXPECT_EQ(lsm->get("key1", &value), RC::SUCCESS);
+  EXPECT_EQ(value, "val1");
+  EXPECT_EQ(lsm->get("key0", &value), RC::NOT_EXIST);
+
+  auto iter = lsm->new_iterator(ObLsmReadOptions());
+  iter->seek_to_first();
+  int runner = 0;
+  while (iter->valid()) {
+    iter->next();
+    runner++;
+  }
+  EXPECT_EQ(count - 1, runner);
+  delete iter;
+  delete lsm;
+}
+
+TEST(oblsm_wal_test, oblsm_recover_with_small_amount_of_data)
 {
   filesystem::remove_all("oblsm_tmp");
   filesystem::create_directory("oblsm_tmp");
@@ -14,10 +14,11 @@ See the Mulan PSL v2 for more details. */
 #include "oblsm/util/ob_comparator.h"
 #include "oblsm/table/ob_sstable_builder.h"
 #include "oblsm/table/ob_sstable.h"
+#include "oblsm/util/ob_coding.h"
 
 using namespace oceanbase;
 
-TEST(table_test, DISABLED_table_test_basic)
+TEST(table_test, table_test_basic)
 {
   ObDefaultComparator comparator;
   shared_ptr<ObMemTable> table = make_shared<ObMemTable>();
@@ -32,14 +33,92 @@ TEST(table_test, DISABLED_table_test_basic)
   shared_ptr<ObSSTable> sst = tb.get_built_table();
   ObLsmIterator* sst_iter = sst->new_iterator();
   sst_iter->seek_to_first();
+  size_t n = 0;
   while(sst_iter->valid()) {
-    cout << sst_iter->key() << " " << sst_iter->value() << endl;
+    ASSERT_EQ(extract_user_key(sst_iter->key()), sst_iter->value());
     sst_iter->next();
+    n++;
   }
+  ASSERT_EQ(n, count);
   delete sst_iter;
+  sst->remove();
+}
+
+TEST(table_test, table_test_multi_block_seek)
+{
+  ObDefaultComparator comparator;
+  shared_ptr<ObMemTable> table = make_shared<ObMemTable>();
+  uint64_t seq = 0;
+  size_t count = 10000;
+  for (size_t i = 0; i < count; i++) {
+    char key[32];
+    snprintf(key, sizeof(key), "key%08lu", i);
+    table->put(seq++, key, key);
+  }
+  ObLsmOptions options;
+  options.block_size = 1024;
+  ObSSTableBuilder tb(&comparator, nullptr, options);
+  ASSERT_EQ(tb.build(table, "test_multi_block.sst", 1), RC::SUCCESS);
+  shared_ptr<ObSSTable> sst = tb.get_built_table();
+  ASSERT_GT(sst->block_count(), 1);
+  ASSERT_EQ(sst->size(), tb.file_size());
+
+  unique_ptr<ObLsmIterator> sst_iter(sst->new_iterator());
+  for (size_t i = 0; i < count; i += 7) {
+    char key[32];
+    snprintf(key, sizeof(key), "key%08lu", i);
+    string lookup_key;
+    put_numeric<size_t>(&lookup_key, strlen(key) + sizeof(uint64_t));
+    lookup_key.append(key);
+    put_numeric<uint64_t>(&lookup_key, seq);
+    sst_iter->seek(lookup_key);
+    ASSERT_TRUE(sst_iter->valid());
+    ASSERT_EQ(sst_iter->value(), key);
+  }
+  sst->remove();
 
 }
 
+TEST(table_test, table_test_compression)
+{
+  ObDefaultComparator comparator;
+  shared_ptr<ObMemTable> table = make_shared<ObMemTable>();
+  uint64_t seq = 0;
+  size_t count = 10000;
+  for (size_t i = 0; i < count; i++) {
+    char key[32];
+    snprintf(key, sizeof(key), "key%08lu", i);
+    table->put(seq++, key, string("value_") + key);
+  }
+
+  ObLsmOptions options;
+  ObSSTableBuilder raw_tb(&comparator, nullptr, options);
+  ASSERT_EQ(raw_tb.build(table, "test_raw.sst", 2), RC::SUCCESS);
+
+  options.compression = CompressionType::LZ;
+  ObLRUCache<uint64_t, shared_ptr<ObBlock>> cache(16);
+  ObSSTableBuilder tb(&comparator, &cache, options);
+  ASSERT_EQ(tb.build(table, "test_compressed.sst", 3), RC::SUCCESS);
+  ASSERT_LT(tb.file_size(), raw_tb.file_size());
+
+  shared_ptr<ObSSTable> sst = tb.get_built_table();
+  ASSERT_EQ(sst->block_meta(0).compression_, CompressionType::LZ);
+  for (int round = 0; round < 2; round++) {
+    unique_ptr<ObLsmIterator> sst_iter(sst->new_iterator());
+    size_t n = 0;
+    for (sst_iter->seek_to_first(); sst_iter->valid(); sst_iter->next()) {
+      char key[32];
+      snprintf(key, sizeof(key), "key%08lu", n);
+      ASSERT_EQ(extract_user_key(sst_iter->key()), key);
+      ASSERT_EQ(sst_iter->value(), string("value_") + key);
+      n++;
+    }
+    ASSERT_EQ(n, count);
+  }
+  ASSERT_TRUE(cache.contains((3UL << 32) | (sst->block_count() - 1)));
+  sst->remove();
+  raw_tb.get_built_table()->remove();
+}
 
 int main(int argc, char **argv)
 {
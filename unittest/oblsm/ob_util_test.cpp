@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 #include <filesystem>
 
 #include "oblsm/util/ob_comparator.h"
+#include "oblsm/util/ob_compression.h"
 #include "oblsm/util/ob_file_reader.h"
 #include "oblsm/util/ob_file_writer.h"
 #include "common/lang/filesystem.h"
@@ -49,6 +50,36 @@ TEST(util_test, DISABLED_rw_file) {
   remove("tmpfile");
 }
 
+TEST(util_test, compression_roundtrip)
+{
+  vector<string> inputs = {"", "a", "abcd", string(1000, 'x'), "abcabcabcabcabcabcabcabcabc"};
+  string         text;
+  for (int i = 0; i < 5000; i++) {
+    text.append("key" + to_string(i % 97) + "value" + to_string(i));
+  }
+  inputs.push_back(text);
+  string random_bytes;
+  for (int i = 0; i < 70000; i++) {
+    random_bytes.push_back(static_cast<char>(rand() & 0xff));
+  }
+  inputs.push_back(random_bytes);
+
+  for (int level : {1, 5, 9}) {
+    for (const string &input : inputs) {
+      string compressed;
+      string output;
+      ASSERT_EQ(ob_compress(CompressionType::LZ, level, input, &compressed), RC::SUCCESS);
+      ASSERT_EQ(ob_uncompress(CompressionType::LZ, compressed, &output), RC::SUCCESS);
+      ASSERT_EQ(output, input);
+    }
+  }
+
+  string compressed;
+  ASSERT_EQ(ob_compress(CompressionType::LZ, 1, text, &compressed), RC::SUCCESS);
+  ASSERT_LT(compressed.size(), text.size() / 2);
+  string output;
+  ASSERT_NE(ob_uncompress(CompressionType::LZ, compressed.substr(0, compressed.size() / 2), &output), RC::SUCCESS);
+}
 
 int main(int argc, char **argv)
 {
@@ -10,13 +10,15 @@ See the Mulan PSL v2 for more details. */
 
 #include <chrono>
 #include <iostream>
+#include <map>
+#include <set>
 
 #include "gtest/gtest.h"
 #include "sql/expr/aggregate_hash_table.h"
 
 using namespace std;
 
-TEST(AggregateHashTableTest, DISABLED_standard_hash_table)
+TEST(AggregateHashTableTest, standard_hash_table)
 {
   // single group by column, single aggregate column
   {
@@ -32,7 +34,7 @@ TEST(AggregateHashTableTest, DISABLED_standard_hash_table)
     group_chunk.add_column(std::move(column1), 0);
     aggr_chunk.add_column(std::move(column2), 1);
 
-    AggregateExpr             aggregate_expr(AggregateExpr::Type::SUM, nullptr);
+    AggregateExpr             aggregate_expr(AggregateExpr::Type::SUM, make_unique<ValueExpr>(Value(0)));
     std::vector<Expression *> aggregate_exprs;
     aggregate_exprs.push_back(&aggregate_expr);
     auto standard_hash_table = std::make_unique<StandardAggregateHashTable>(aggregate_exprs);
@@ -48,9 +50,14 @@ TEST(AggregateHashTableTest, DISABLED_standard_hash_table)
     ASSERT_EQ(rc, RC::SUCCESS);
     ASSERT_EQ(output_chunk.rows(), 8);
     for (int i = 0; i < 8; i++) {
-      std::cout << "column1: " << output_chunk.get_value(1, i).get_string() << " "
-                << "sum(column2)" << output_chunk.get_value(0, i).get_string() << std::endl;
+      int key = output_chunk.get_value(0, i).get_int();
+      int sum = 0;
+      for (int j = key; j < 1023; j += 8) {
+        sum += j;
+      }
+      ASSERT_EQ(output_chunk.get_value(1, i).get_int(), sum);
     }
+    ASSERT_EQ(scanner.next(output_chunk), RC::RECORD_EOF);
   }
   // mutiple group by columns, mutiple aggregate columns
   {
@@ -65,7 +72,9 @@ TEST(AggregateHashTableTest, DISABLED_standard_hash_table)
       float i_float  = i + 0.5;
       int   i_group2 = i % 8;
 
-      group1->append_one((char *)std::to_string(i % 8).c_str());
+      // 字符串结束符后面的内容不同，不影响分组
+      char str[4] = {static_cast<char>('0' + i % 8), 0, static_cast<char>('a' + i % 3), 'z'};
+      group1->append_one(str);
       group2->append_one((char *)&i_group2);
       aggr1->append_one((char *)&i_float);
       aggr2->append_one((char *)&i);
@@ -75,36 +84,151 @@ TEST(AggregateHashTableTest, DISABLED_standard_hash_table)
     aggr_chunk.add_column(std::move(aggr1), 0);
     aggr_chunk.add_column(std::move(aggr2), 1);
 
-    AggregateExpr             aggregate_expr(AggregateExpr::Type::SUM, nullptr);
+    AggregateExpr             sum_expr(AggregateExpr::Type::SUM, make_unique<ValueExpr>(Value(0.0f)));
+    AggregateExpr             avg_expr(AggregateExpr::Type::AVG, make_unique<ValueExpr>(Value(0)));
     std::vector<Expression *> aggregate_exprs;
-    aggregate_exprs.push_back(&aggregate_expr);
-    aggregate_exprs.push_back(&aggregate_expr);
+    aggregate_exprs.push_back(&sum_expr);
+    aggregate_exprs.push_back(&avg_expr);
     auto standard_hash_table = std::make_unique<StandardAggregateHashTable>(aggregate_exprs);
     RC   rc                  = standard_hash_table->add_chunk(group_chunk, aggr_chunk);
     ASSERT_EQ(rc, RC::SUCCESS);
+    rc = standard_hash_table->add_chunk(group_chunk, aggr_chunk);
+    ASSERT_EQ(rc, RC::SUCCESS);
+    ASSERT_EQ(standard_hash_table->size(), 8);
+
     Chunk output_chunk;
     output_chunk.add_column(
         make_unique<Column>(group_chunk.column(0).attr_type(), group_chunk.column(0).attr_len()), 0);
     output_chunk.add_column(
         make_unique<Column>(group_chunk.column(1).attr_type(), group_chunk.column(1).attr_len()), 1);
-    output_chunk.add_column(make_unique<Column>(aggr_chunk.column(0).attr_type(), aggr_chunk.column(0).attr_len()), 1);
-    output_chunk.add_column(make_unique<Column>(aggr_chunk.column(1).attr_type(), aggr_chunk.column(1).attr_len()), 2);
+    output_chunk.add_column(make_unique<Column>(AttrType::FLOATS, 4), 2);
+    output_chunk.add_column(make_unique<Column>(AttrType::FLOATS, 4), 3);
     StandardAggregateHashTable::Scanner scanner(standard_hash_table.get());
     scanner.open_scan();
     rc = scanner.next(output_chunk);
     ASSERT_EQ(rc, RC::SUCCESS);
     ASSERT_EQ(output_chunk.rows(), 8);
     for (int i = 0; i < 8; i++) {
-      std::cout << "group1: " << output_chunk.get_value(0, i).get_string() << " "
-                << "group2: " << output_chunk.get_value(1, i).get_string() << " "
-                << "sum(aggr1): " << output_chunk.get_value(2, i).get_string() << " "
-                << "sum(aggr2): " << output_chunk.get_value(3, i).get_string() << std::endl;
+      int key = output_chunk.get_value(1, i).get_int();
+      ASSERT_EQ(output_chunk.get_value(0, i).get_string(), std::to_string(key));
+      float sum   = 0;
+      int   count = 0;
+      for (int j = key; j < 1023; j += 8) {
+        sum += j + 0.5;
+        count++;
+      }
+      ASSERT_FLOAT_EQ(output_chunk.get_value(2, i).get_float(), sum * 2);
+      ASSERT_FLOAT_EQ(output_chunk.get_value(3, i).get_float(), (float)(sum - count * 0.5) / count);
+    }
+  }
+  // many groups, the hash table should grow
+  {
+    Chunk                   group_chunk;
+    Chunk                   aggr_chunk;
+    std::unique_ptr<Column> column1 = std::make_unique<Column>(AttrType::INTS, 4);
+    std::unique_ptr<Column> column2 = std::make_unique<Column>(AttrType::INTS, 4);
+    for (int i = 0; i < 8000; i++) {
+      int key = i / 2;
+      column1->append_one((char *)&key);
+      column2->append_one((char *)&i);
+    }
+    group_chunk.add_column(std::move(column1), 0);
+    aggr_chunk.add_column(std::move(column2), 0);
+
+    AggregateExpr             count_expr(AggregateExpr::Type::COUNT, make_unique<ValueExpr>(Value(1)));
+    std::vector<Expression *> aggregate_exprs;
+    aggregate_exprs.push_back(&count_expr);
+    StandardAggregateHashTable hash_table(aggregate_exprs);
+    ASSERT_EQ(hash_table.add_chunk(group_chunk, aggr_chunk), RC::SUCCESS);
+    ASSERT_EQ(hash_table.size(), 4000);
+
+    Chunk output_chunk;
+    output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4, 1000), 0);
+    output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4, 1000), 1);
+    StandardAggregateHashTable::Scanner scanner(&hash_table);
+    scanner.open_scan();
+    int rows = 0;
+    while (scanner.next(output_chunk) == RC::SUCCESS) {
+      for (int i = 0; i < output_chunk.rows(); i++) {
+        ASSERT_EQ(output_chunk.get_value(1, i).get_int(), 2);
+      }
+      rows += output_chunk.rows();
+      output_chunk.reset_data();
+    }
+    ASSERT_EQ(rows, 4000);
+  }
+}
+
+TEST(AggregateHashTableTest, dictionary_group_keys)
+{
+  // 两个哈希表的输入使用不同的字典，相同字符串的编号不同。普通的字符串列和字典编码的列可以写入同一个哈希表
+  const char *names[] = {"apple", "banana", "cherry", "", "durian"};
+  const int   name_num = sizeof(names) / sizeof(names[0]);
+
+  AggregateExpr             count_expr(AggregateExpr::Type::COUNT, make_unique<ValueExpr>(Value(1)));
+  std::vector<Expression *> aggregate_exprs;
+  aggregate_exprs.push_back(&count_expr);
+
+  vector<unique_ptr<StandardAggregateHashTable>> local_tables;
+  for (int table_idx = 0; table_idx < 2; table_idx++) {
+    auto hash_table = make_unique<StandardAggregateHashTable>(aggregate_exprs);
+    auto dictionary = make_shared<StringDictionary>();
+    for (int chunk_idx = 0; chunk_idx < 3; chunk_idx++) {
+      Chunk                   group_chunk;
+      Chunk                   aggr_chunk;
+      std::unique_ptr<Column> group = std::make_unique<Column>();
+      std::unique_ptr<Column> aggr  = std::make_unique<Column>(AttrType::INTS, 4);
+      if (chunk_idx < 2) {
+        group->init_dictionary(8, dictionary);
+      } else {
+        group->init(AttrType::CHARS, 8);
+      }
+      for (int i = 0; i < 100; i++) {
+        char str[8] = {0};
+        int  name   = table_idx == 0 ? i % name_num : name_num - 1 - i % name_num;
+        strncpy(str, names[name], sizeof(str));
+        group->append_one(str);
+        aggr->append_one((char *)&i);
+      }
+      ASSERT_EQ(group->column_type(), chunk_idx < 2 ? Column::Type::DICTIONARY_COLUMN : Column::Type::NORMAL_COLUMN);
+      group_chunk.add_column(std::move(group), 0);
+      aggr_chunk.add_column(std::move(aggr), 0);
+      ASSERT_EQ(hash_table->add_chunk(group_chunk, aggr_chunk), RC::SUCCESS);
+    }
+    ASSERT_EQ(hash_table->size(), name_num);
+    local_tables.emplace_back(std::move(hash_table));
+  }
+
+  const int        partition_num = 2;
+  map<string, int> counts;
+  for (int partition = 0; partition < partition_num; partition++) {
+    StandardAggregateHashTable hash_table(aggregate_exprs);
+    for (auto &local_table : local_tables) {
+      ASSERT_EQ(hash_table.merge(*local_table, partition, partition_num), RC::SUCCESS);
     }
+
+    Chunk output_chunk;
+    output_chunk.add_column(make_unique<Column>(AttrType::CHARS, 8), 0);
+    output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4), 1);
+    StandardAggregateHashTable::Scanner scanner(&hash_table);
+    scanner.open_scan();
+    while (scanner.next(output_chunk) == RC::SUCCESS) {
+      for (int i = 0; i < output_chunk.rows(); i++) {
+        string name = output_chunk.get_value(0, i).get_string();
+        ASSERT_EQ(counts.count(name), 0) << name;
+        counts[name] = output_chunk.get_value(1, i).get_int();
+      }
+      output_chunk.reset_data();
+    }
+  }
+
+  ASSERT_EQ(counts.size(), name_num);
+  for (const char *name : names) {
+    ASSERT_EQ(counts[name], 2 * 3 * 100 / name_num) << name;
   }
 }
 
-#ifdef USE_SIMD
-TEST(AggregateHashTableTest, DISABLED_linear_probing_hash_table)
+TEST(AggregateHashTableTest, linear_probing_hash_table)
 {
   // simple case
   {
@@ -120,22 +244,30 @@ TEST(AggregateHashTableTest, DISABLED_linear_probing_hash_table)
     group_chunk.add_column(std::move(column1), 0);
     aggr_chunk.add_column(std::move(column2), 1);
 
-    auto linear_probing_hash_table = std::make_unique<LinearProbingAggregateHashTable<int>>(AggregateExpr::Type::SUM);
+    AggregateExpr             aggregate_expr(AggregateExpr::Type::SUM, make_unique<ValueExpr>(Value(0)));
+    std::vector<Expression *> aggregate_exprs;
+    aggregate_exprs.push_back(&aggregate_expr);
+    auto linear_probing_hash_table = std::make_unique<LinearProbingAggregateHashTable>(aggregate_exprs);
     RC   rc                        = linear_probing_hash_table->add_chunk(group_chunk, aggr_chunk);
     ASSERT_EQ(rc, RC::SUCCESS);
     Chunk output_chunk;
     output_chunk.add_column(
         make_unique<Column>(group_chunk.column(0).attr_type(), group_chunk.column(0).attr_len()), 0);
     output_chunk.add_column(make_unique<Column>(aggr_chunk.column(0).attr_type(), aggr_chunk.column(0).attr_len()), 1);
-    LinearProbingAggregateHashTable<int>::Scanner scanner(linear_probing_hash_table.get());
+    LinearProbingAggregateHashTable::Scanner scanner(linear_probing_hash_table.get());
     scanner.open_scan();
     rc = scanner.next(output_chunk);
     ASSERT_EQ(rc, RC::SUCCESS);
     ASSERT_EQ(output_chunk.rows(), 8);
     for (int i = 0; i < 8; i++) {
-      std::cout << "column1: " << output_chunk.get_value(1, i).get_string() << " "
-                << "sum(column2)" << output_chunk.get_value(0, i).get_string() << std::endl;
+      int key = output_chunk.get_value(0, i).get_int();
+      int sum = 0;
+      for (int j = key; j < 1023; j += 8) {
+        sum += j;
+      }
+      ASSERT_EQ(output_chunk.get_value(1, i).get_int(), sum);
     }
+    ASSERT_EQ(scanner.next(output_chunk), RC::RECORD_EOF);
   }
 
   // hash conflict
@@ -158,15 +290,17 @@ TEST(AggregateHashTableTest, DISABLED_linear_probing_hash_table)
     group_chunk.add_column(std::move(column1), 0);
     aggr_chunk.add_column(std::move(column2), 1);
 
-    auto linear_probing_hash_table =
-        std::make_unique<LinearProbingAggregateHashTable<int>>(AggregateExpr::Type::SUM, 256);
-    RC rc = linear_probing_hash_table->add_chunk(group_chunk, aggr_chunk);
+    AggregateExpr             aggregate_expr(AggregateExpr::Type::SUM, make_unique<ValueExpr>(Value(0)));
+    std::vector<Expression *> aggregate_exprs;
+    aggregate_exprs.push_back(&aggregate_expr);
+    auto linear_probing_hash_table = std::make_unique<LinearProbingAggregateHashTable>(aggregate_exprs, 256);
+    RC   rc                        = linear_probing_hash_table->add_chunk(group_chunk, aggr_chunk);
     ASSERT_EQ(rc, RC::SUCCESS);
     Chunk output_chunk;
     output_chunk.add_column(
         make_unique<Column>(group_chunk.column(0).attr_type(), group_chunk.column(0).attr_len()), 0);
     output_chunk.add_column(make_unique<Column>(aggr_chunk.column(0).attr_type(), aggr_chunk.column(0).attr_len()), 1);
-    LinearProbingAggregateHashTable<int>::Scanner scanner(linear_probing_hash_table.get());
+    LinearProbingAggregateHashTable::Scanner scanner(linear_probing_hash_table.get());
     scanner.open_scan();
     rc = scanner.next(output_chunk);
     ASSERT_EQ(rc, RC::SUCCESS);
@@ -174,8 +308,132 @@ TEST(AggregateHashTableTest, DISABLED_linear_probing_hash_table)
     ASSERT_STREQ(output_chunk.get_value(1, 0).get_string().c_str(), "501");
     ASSERT_STREQ(output_chunk.get_value(1, 1).get_string().c_str(), "501");
   }
+
+  // mutiple group by columns, COUNT/MIN/MAX/AVG over int and float
+  {
+    Chunk                   group_chunk;
+    Chunk                   aggr_chunk;
+    std::unique_ptr<Column> group1 = std::make_unique<Column>(AttrType::CHARS, 4);
+    std::unique_ptr<Column> group2 = std::make_unique<Column>(AttrType::INTS, 4);
+    for (int i = 0; i < 1023; i++) {
+      int  i_group2 = i % 8;
+      char str[4]   = {static_cast<char>('0' + i % 8), 0, static_cast<char>('a' + i % 3), 'z'};
+      group1->append_one(str);
+      group2->append_one((char *)&i_group2);
+    }
+    group_chunk.add_column(std::move(group1), 0);
+    group_chunk.add_column(std::move(group2), 1);
+
+    vector<AggregateExpr::Type> types = {AggregateExpr::Type::COUNT,
+        AggregateExpr::Type::MIN,
+        AggregateExpr::Type::MAX,
+        AggregateExpr::Type::AVG,
+        AggregateExpr::Type::MIN,
+        AggregateExpr::Type::MAX,
+        AggregateExpr::Type::AVG};
+    vector<unique_ptr<AggregateExpr>> aggregate_holders;
+    std::vector<Expression *>         aggregate_exprs;
+    for (size_t i = 0; i < types.size(); i++) {
+      bool is_float = i >= 4;
+      aggregate_holders.push_back(make_unique<AggregateExpr>(
+          types[i], make_unique<ValueExpr>(is_float ? Value(0.0f) : Value(0))));
+      aggregate_exprs.push_back(aggregate_holders.back().get());
+
+      auto column = make_unique<Column>(is_float ? AttrType::FLOATS : AttrType::INTS, 4);
+      for (int row = 0; row < 1023; row++) {
+        int   i_value = row - 500;
+        float f_value = row - 500.5f;
+        column->append_one(is_float ? (char *)&f_value : (char *)&i_value);
+      }
+      aggr_chunk.add_column(std::move(column), 2 + i);
+    }
+
+    auto linear_probing_hash_table = std::make_unique<LinearProbingAggregateHashTable>(aggregate_exprs);
+    ASSERT_EQ(linear_probing_hash_table->add_chunk(group_chunk, aggr_chunk), RC::SUCCESS);
+    ASSERT_EQ(linear_probing_hash_table->size(), 8);
+
+    Chunk output_chunk;
+    output_chunk.add_column(make_unique<Column>(AttrType::CHARS, 4), 0);
+    output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4), 1);
+    output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4), 2);
+    output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4), 3);
+    output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4), 4);
+    output_chunk.add_column(make_unique<Column>(AttrType::FLOATS, 4), 5);
+    output_chunk.add_column(make_unique<Column>(AttrType::FLOATS, 4), 6);
+    output_chunk.add_column(make_unique<Column>(AttrType::FLOATS, 4), 7);
+    output_chunk.add_column(make_unique<Column>(AttrType::FLOATS, 4), 8);
+    LinearProbingAggregateHashTable::Scanner scanner(linear_probing_hash_table.get());
+    scanner.open_scan();
+    ASSERT_EQ(scanner.next(output_chunk), RC::SUCCESS);
+    ASSERT_EQ(output_chunk.rows(), 8);
+    for (int i = 0; i < 8; i++) {
+      int key = output_chunk.get_value(1, i).get_int();
+      ASSERT_EQ(output_chunk.get_value(0, i).get_string(), to_string(key));
+
+      int count = 0;
+      int sum   = 0;
+      for (int j = key; j < 1023; j += 8) {
+        count++;
+        sum += j - 500;
+      }
+      int last = key + (count - 1) * 8;
+      ASSERT_EQ(output_chunk.get_value(2, i).get_int(), count);
+      ASSERT_EQ(output_chunk.get_value(3, i).get_int(), key - 500);
+      ASSERT_EQ(output_chunk.get_value(4, i).get_int(), last - 500);
+      ASSERT_FLOAT_EQ(output_chunk.get_value(5, i).get_float(), static_cast<float>(sum) / count);
+      ASSERT_FLOAT_EQ(output_chunk.get_value(6, i).get_float(), key - 500.5f);
+      ASSERT_FLOAT_EQ(output_chunk.get_value(7, i).get_float(), last - 500.5f);
+      ASSERT_FLOAT_EQ(output_chunk.get_value(8, i).get_float(), static_cast<float>(sum) / count - 0.5f);
+    }
+    ASSERT_EQ(scanner.next(output_chunk), RC::RECORD_EOF);
+  }
+
+  // resize, many groups
+  {
+    AggregateExpr             aggregate_expr(AggregateExpr::Type::COUNT, make_unique<ValueExpr>(Value(0)));
+    std::vector<Expression *> aggregate_exprs;
+    aggregate_exprs.push_back(&aggregate_expr);
+    auto linear_probing_hash_table = std::make_unique<LinearProbingAggregateHashTable>(aggregate_exprs, 16);
+
+    for (int round = 0; round < 2; round++) {
+      for (int base = 0; base < 4000; base += 1000) {
+        Chunk                   group_chunk;
+        Chunk                   aggr_chunk;
+        std::unique_ptr<Column> column1 = std::make_unique<Column>(AttrType::INTS, 4);
+        std::unique_ptr<Column> column2 = std::make_unique<Column>(AttrType::INTS, 4);
+        for (int i = base; i < base + 1000; i++) {
+          column1->append_one((char *)&i);
+          column2->append_one((char *)&i);
+        }
+        group_chunk.add_column(std::move(column1), 0);
+        aggr_chunk.add_column(std::move(column2), 1);
+        ASSERT_EQ(linear_probing_hash_table->add_chunk(group_chunk, aggr_chunk), RC::SUCCESS);
+      }
+    }
+    ASSERT_EQ(linear_probing_hash_table->size(), 4000);
+    ASSERT_GE(linear_probing_hash_table->capacity(), 8000);
+
+    Chunk output_chunk;
+    output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4), 0);
+    output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4), 1);
+    LinearProbingAggregateHashTable::Scanner scanner(linear_probing_hash_table.get());
+    scanner.open_scan();
+    int      rows = 0;
+    set<int> keys;
+    while (scanner.next(output_chunk) == RC::SUCCESS) {
+      for (int i = 0; i < output_chunk.rows(); i++) {
+        keys.insert(output_chunk.get_value(0, i).get_int());
+        ASSERT_EQ(output_chunk.get_value(1, i).get_int(), 2);
+      }
+      rows += output_chunk.rows();
+      output_chunk.reset_data();
+    }
+    ASSERT_EQ(rows, 4000);
+    ASSERT_EQ(keys.size(), 4000);
+    ASSERT_EQ(*keys.begin(), 0);
+    ASSERT_EQ(*keys.rbegin(), 3999);
+  }
 }
-#endif
 
 int main(int argc, char **argv)
 {
@@ -227,6 +227,31 @@ TEST(BplusTreeLogEntry, internal_update_key_log_entry)
   ASSERT_EQ(0, memcmp(key.data(), entry2->key(), key.size()));
 }
 
+TEST(BplusTreeLogEntry, page_image_log_entry)
+{
+  Frame frame;
+  frame.set_page_num(100);
+  vector<char> image(1000);
+  for (size_t i = 0; i < image.size(); i++) {
+    image[i] = static_cast<char>(i);
+  }
+  vector<char>             old_image(image.size());
+  PageImageLogEntryHandler entry(&frame, image, old_image);
+
+  // test serializer and desirializer
+  Serializer serializer;
+  ASSERT_EQ(RC::SUCCESS, entry.serialize(serializer));
+
+  Deserializer                deserializer(serializer.data());
+  unique_ptr<LogEntryHandler> handler;
+  ASSERT_EQ(RC::SUCCESS, LogEntryHandler::from_buffer(deserializer, handler));
+
+  auto entry2 = dynamic_cast<PageImageLogEntryHandler *>(handler.get());
+  ASSERT_NE(nullptr, entry2);
+  ASSERT_EQ(image.size(), entry2->image_bytes());
+  ASSERT_EQ(0, memcmp(image.data(), entry2->image(), image.size()));
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
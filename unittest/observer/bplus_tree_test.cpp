@@ -22,8 +22,11 @@ See the Mulan PSL v2 for more details. */
 #include "sql/parser/parse_defs.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "storage/index/bplus_tree.h"
+#include "storage/common/external_sorter.h"
 #include "storage/clog/vacuous_log_handler.h"
 #include "storage/buffer/double_write_buffer.h"
+#include "common/lang/atomic.h"
+#include "common/lang/thread.h"
 #include "gtest/gtest.h"
 
 using namespace common;
@@ -793,6 +796,257 @@ TEST(test_bplus_tree, test_scanner)
   handler.close();
 }
 
+TEST(test_bplus_tree, test_multi_attr)
+{
+  LoggerFactory::init_default("test_multi_attr.log");
+
+  VacuousLogHandler log_handler;
+
+  filesystem::path test_directory("bplus_tree");
+  filesystem::path buffer_pool_file = test_directory / "multi_attr.btree";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(buffer_pool_file.c_str()));
+
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, buffer_pool_file.c_str(), buffer_pool));
+  ASSERT_NE(nullptr, buffer_pool);
+
+  // 键值是 (a int, b chars(4))
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS,
+      handler.create(log_handler, *buffer_pool, {AttrType::INTS, AttrType::CHARS}, {4, 4}, ORDER, ORDER));
+  ASSERT_EQ(8, handler.file_header().attr_length);
+
+  char key[8];
+  RID  rid;
+  for (int a = 9; a >= 0; a--) {
+    for (int b = 0; b < 10; b++) {
+      memset(key, 0, sizeof(key));
+      memcpy(key, &a, sizeof(a));
+      key[4]       = 'b';
+      key[5]       = '0' + b;
+      rid.page_num = a;
+      rid.slot_num = b;
+      ASSERT_EQ(RC::SUCCESS, handler.insert_entry(key, &rid));
+    }
+  }
+  ASSERT_TRUE(handler.validate_tree());
+
+  auto scan = [&handler](const char *left, int left_len, bool left_inclusive, const char *right, int right_len,
+                  bool right_inclusive) {
+    vector<int>      result;
+    BplusTreeScanner scanner(handler);
+    EXPECT_EQ(RC::SUCCESS, scanner.open(left, left_len, left_inclusive, right, right_len, right_inclusive));
+    RID rid;
+    while (RC::SUCCESS == scanner.next_entry(rid)) {
+      result.push_back(rid.page_num * 10 + rid.slot_num);
+    }
+    return result;
+  };
+
+  // a = 3
+  int  a = 3;
+  char prefix[4];
+  memcpy(prefix, &a, sizeof(a));
+  ASSERT_EQ(10UL, scan(prefix, 4, true, prefix, 4, true).size());
+
+  // a = 3 and b > 'b5'
+  memset(key, 0, sizeof(key));
+  memcpy(key, &a, sizeof(a));
+  key[4] = 'b';
+  key[5] = '5';
+  ASSERT_EQ(scan(key, 8, false, prefix, 4, true), (vector<int>{36, 37, 38, 39}));
+
+  // a = 3 and b <= 'b5'
+  ASSERT_EQ(scan(prefix, 4, true, key, 8, true), (vector<int>{30, 31, 32, 33, 34, 35}));
+
+  // a > 3 and a < 5
+  int  upper = 5;
+  char upper_prefix[4];
+  memcpy(upper_prefix, &upper, sizeof(upper));
+  ASSERT_EQ(10UL, scan(prefix, 4, false, upper_prefix, 4, false).size());
+
+  // 扫描时返回的索引键与插入时一致，并且按照键值有序
+  BplusTreeScanner scanner(handler);
+  ASSERT_EQ(RC::SUCCESS, scanner.open(nullptr, 0, false, nullptr, 0, false));
+  const char *user_key = nullptr;
+  int         count    = 0;
+  while (RC::SUCCESS == scanner.next_entry(rid, user_key)) {
+    int key_a = 0;
+    memcpy(&key_a, user_key, sizeof(key_a));
+    ASSERT_EQ(count / 10, key_a);
+    ASSERT_EQ(rid.page_num, key_a);
+    ASSERT_EQ('b', user_key[4]);
+    ASSERT_EQ('0' + rid.slot_num, user_key[5]);
+    count++;
+  }
+  ASSERT_EQ(100, count);
+  scanner.close();
+
+  handler.close();
+}
+
+TEST(test_bplus_tree, test_get_entries)
+{
+  LoggerFactory::init_default("test.log");
+
+  filesystem::path test_directory("bplus_tree");
+  filesystem::path buffer_pool_file = test_directory / "get_entries.btree";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  VacuousLogHandler log_handler;
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(buffer_pool_file.c_str()));
+
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, buffer_pool_file.c_str(), buffer_pool));
+
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(log_handler, *buffer_pool, AttrType::INTS, sizeof(int), ORDER, ORDER));
+
+  vector<RID> rids;
+  vector<int> offsets;
+  int         keys[] = {1, 2, 3};
+  ASSERT_EQ(RC::SUCCESS, handler.get_entries((const char *)keys, 3, rids, &offsets));
+  ASSERT_TRUE(rids.empty());
+  ASSERT_EQ(offsets, (vector<int>{0, 0, 0, 0}));
+
+  // 偶数键值，每个键值有 i % 7 个条目，这样相同键值的条目会跨越多个叶子节点
+  for (int i = 0; i < 200; i += 2) {
+    for (int j = 0; j < i % 7; j++) {
+      RID rid(i, j);
+      ASSERT_EQ(RC::SUCCESS, handler.insert_entry((const char *)&i, &rid));
+    }
+  }
+
+  auto check = [&handler](const vector<int> &probe_keys) {
+    vector<RID> rids;
+    vector<int> offsets;
+    ASSERT_EQ(RC::SUCCESS,
+        handler.get_entries((const char *)probe_keys.data(), static_cast<int>(probe_keys.size()), rids, &offsets));
+    ASSERT_EQ(probe_keys.size() + 1, offsets.size());
+    ASSERT_EQ(static_cast<int>(rids.size()), offsets.back());
+    for (size_t i = 0; i < probe_keys.size(); i++) {
+      list<RID> expected;
+      ASSERT_EQ(RC::SUCCESS, handler.get_entry((const char *)&probe_keys[i], sizeof(int), expected));
+      ASSERT_EQ(expected.size(), static_cast<size_t>(offsets[i + 1] - offsets[i])) << "key=" << probe_keys[i];
+      int index = offsets[i];
+      for (const RID &rid : expected) {
+        ASSERT_EQ(rid, rids[index++]);
+      }
+    }
+  };
+
+  vector<int> sorted_keys;
+  for (int i = -3; i < 210; i++) {
+    sorted_keys.push_back(i);
+  }
+  check(sorted_keys);
+  check({4, 4, 4, 10, 100, 100, 198, 500});
+  check({100, 4, 198, 4, -1, 56});
+  check({});
+
+  handler.close();
+}
+
+TEST(test_bplus_tree, test_bulk_load)
+{
+  LoggerFactory::init_default("test.log");
+
+  filesystem::path test_directory("bplus_tree");
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  VacuousLogHandler log_handler;
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+
+  for (int fill_factor : {50, 70, 100}) {
+    for (int num : {1, 2, 3, 5, 17, 1000}) {
+      SCOPED_TRACE("fill_factor=" + to_string(fill_factor) + ", num=" + to_string(num));
+      filesystem::path buffer_pool_file =
+          test_directory / ("bulk_load_" + to_string(fill_factor) + "_" + to_string(num) + ".btree");
+      ASSERT_EQ(RC::SUCCESS, bpm.create_file(buffer_pool_file.c_str()));
+
+      DiskBufferPool *buffer_pool = nullptr;
+      ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, buffer_pool_file.c_str(), buffer_pool));
+
+      BplusTreeHandler handler;
+      ASSERT_EQ(RC::SUCCESS, handler.create(log_handler, *buffer_pool, AttrType::INTS, sizeof(int), ORDER, ORDER));
+
+      // 每个键值重复两次，RID 不同。排序时只允许在内存中保存很少的数据，这样会产生很多个 run
+      const int      key_length     = handler.file_header().key_length;
+      const auto    &key_comparator = handler.key_comparator();
+      ExternalSorter sorter(key_length,
+          [&key_comparator](const char *a, const char *b) { return key_comparator(a, b); },
+          key_length * 7,
+          (test_directory / "bulk_load.sort").string());
+      vector<char> key(key_length);
+      for (int i = num - 1; i >= 0; i--) {
+        int value = i / 2;
+        RID rid(i, i);
+        memcpy(key.data(), &value, sizeof(value));
+        memcpy(key.data() + sizeof(value), &rid, sizeof(rid));
+        ASSERT_EQ(RC::SUCCESS, sorter.add(key.data()));
+      }
+      ASSERT_EQ(RC::SUCCESS, sorter.finish());
+      ASSERT_EQ(num, sorter.count());
+
+      ASSERT_EQ(RC::SUCCESS,
+          handler.bulk_load(sorter.count(), [&sorter](const char *&key) { return sorter.next(key); }, fill_factor));
+      ASSERT_TRUE(handler.validate_tree());
+
+      RID rid;
+      {
+        // 扫描器在析构时才会释放页面的锁
+        BplusTreeScanner scanner(handler);
+        ASSERT_EQ(RC::SUCCESS, scanner.open(nullptr, 0, true, nullptr, 0, true));
+        int count = 0;
+        RC  rc    = RC::SUCCESS;
+        while (OB_SUCC(rc = scanner.next_entry(rid))) {
+          ASSERT_EQ(count, rid.page_num);
+          count++;
+        }
+        ASSERT_EQ(RC::RECORD_EOF, rc);
+        ASSERT_EQ(num, count);
+      }
+
+      // 批量构建出来的树可以继续插入和删除
+      for (int i = num; i < num + 50; i++) {
+        int value = i / 2;
+        rid       = RID(i, i);
+        ASSERT_EQ(RC::SUCCESS, handler.insert_entry((const char *)&value, &rid));
+      }
+      ASSERT_TRUE(handler.validate_tree());
+      for (int i = 0; i < num + 50; i += 2) {
+        int value = i / 2;
+        rid       = RID(i, i);
+        ASSERT_EQ(RC::SUCCESS, handler.delete_entry((const char *)&value, &rid));
+      }
+      ASSERT_TRUE(handler.validate_tree());
+
+      list<RID> rids;
+      int       value = num / 4;
+      ASSERT_EQ(RC::SUCCESS, handler.get_entry((const char *)&value, sizeof(value), rids));
+      ASSERT_EQ(1UL, rids.size());
+      ASSERT_EQ(value * 2 + 1, rids.front().page_num);
+
+      // 非空的树不能再批量构建
+      ASSERT_NE(RC::SUCCESS, handler.bulk_load(1, [&key](const char *&k) { k = key.data(); return RC::SUCCESS; }, 100));
+
+      handler.close();
+    }
+  }
+}
+
 TEST(test_bplus_tree, test_bplus_tree_insert)
 {
   LoggerFactory::init_default("test.log");
@@ -826,6 +1080,140 @@ TEST(test_bplus_tree, test_bplus_tree_insert)
   handler = nullptr;
 }
 
+TEST(test_bplus_tree, test_bplus_tree_insert_pessimistic)
+{
+  LoggerFactory::init_default("test.log");
+
+  filesystem::path test_directory("bplus_tree");
+  filesystem::path buffer_pool_file = test_directory / "test_bplus_tree_insert_pessimistic.btree";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  VacuousLogHandler log_handler;
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(buffer_pool_file.c_str()));
+
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, buffer_pool_file.c_str(), buffer_pool));
+  ASSERT_NE(nullptr, buffer_pool);
+
+  // 只使用蟹行协议查找叶子节点
+  BplusTreeHandler *handler = new BplusTreeHandler();
+  handler->set_optimistic_latch(false);
+  ASSERT_EQ(RC::SUCCESS, handler->create(log_handler, *buffer_pool, AttrType::INTS, sizeof(int), ORDER, ORDER));
+
+  test_insert(handler);
+
+  test_get(handler);
+
+  test_delete(handler);
+
+  handler->close();
+  delete handler;
+  handler = nullptr;
+}
+
+#ifdef CONCURRENCY
+// 乐观查找叶子节点时，读线程与不断分裂、合并节点的写线程并发执行
+TEST(test_bplus_tree, test_bplus_tree_optimistic_concurrency)
+{
+  LoggerFactory::init_default("test.log", LOG_LEVEL_WARN);
+
+  filesystem::path test_directory("bplus_tree");
+  filesystem::path buffer_pool_file = test_directory / "test_bplus_tree_optimistic_concurrency.btree";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  VacuousLogHandler log_handler;
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(buffer_pool_file.c_str()));
+
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, buffer_pool_file.c_str(), buffer_pool));
+  ASSERT_NE(nullptr, buffer_pool);
+
+  BplusTreeHandler *handler = new BplusTreeHandler();
+  ASSERT_TRUE(handler->optimistic_latch());
+  ASSERT_EQ(RC::SUCCESS, handler->create(log_handler, *buffer_pool, AttrType::INTS, sizeof(int), ORDER, ORDER));
+
+  // 偶数的 key 一直存在，奇数的 key 由写线程反复插入、删除，节点很小，会不断地分裂和合并
+  const int key_num     = 2000;
+  const int writer_num  = 2;
+  const int reader_num  = 4;
+  const int write_round = 20;
+  auto      make_rid    = [](int key) { return RID(key, key + 1); };
+  for (int key = 0; key < key_num; key += 2) {
+    RID rid = make_rid(key);
+    ASSERT_EQ(RC::SUCCESS, handler->insert_entry((const char *)&key, &rid));
+  }
+
+  atomic<int>    errors(0);
+  atomic<int>    running_writers(writer_num);
+  vector<thread> threads;
+  for (int w = 0; w < writer_num; w++) {
+    threads.emplace_back([&, w]() {
+      for (int round = 0; round < write_round; round++) {
+        for (int key = 1 + 2 * w; key < key_num; key += 2 * writer_num) {
+          RID rid = make_rid(key);
+          if (handler->insert_entry((const char *)&key, &rid) != RC::SUCCESS) {
+            errors++;
+          }
+        }
+        for (int key = 1 + 2 * w; key < key_num; key += 2 * writer_num) {
+          RID rid = make_rid(key);
+          if (handler->delete_entry((const char *)&key, &rid) != RC::SUCCESS) {
+            errors++;
+          }
+        }
+      }
+      running_writers--;
+    });
+  }
+  for (int r = 0; r < reader_num; r++) {
+    threads.emplace_back([&, r]() {
+      int key = r;
+      while (running_writers.load() > 0) {
+        key = (key + 7) % key_num;
+        list<RID> rids;
+        RC        rc = handler->get_entry((const char *)&key, sizeof(key), rids);
+        if (rc == RC::LOCKED_NEED_WAIT) {
+          continue;  // 扫描到相邻的叶子节点时加锁冲突，由调用者重试
+        }
+        if (rc != RC::SUCCESS) {
+          errors++;
+          continue;
+        }
+        // 偶数的 key 一定能找到，奇数的 key 可能正在被插入或者删除
+        const bool stable = key % 2 == 0;
+        if ((stable && rids.size() != 1) || rids.size() > 1 ||
+            (!rids.empty() && (rids.front().page_num != key || rids.front().slot_num != key + 1))) {
+          errors++;
+        }
+      }
+    });
+  }
+  for (thread &t : threads) {
+    t.join();
+  }
+
+  ASSERT_EQ(errors.load(), 0);
+  ASSERT_TRUE(handler->validate_tree());
+  for (int key = 0; key < key_num; key++) {
+    list<RID> rids;
+    ASSERT_EQ(RC::SUCCESS, handler->get_entry((const char *)&key, sizeof(key), rids));
+    ASSERT_EQ(rids.size(), key % 2 == 0 ? 1 : 0);
+  }
+
+  handler->close();
+  delete handler;
+  handler = nullptr;
+}
+#endif  // CONCURRENCY
+
 int main(int argc, char **argv)
 {
 
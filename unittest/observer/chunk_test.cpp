@@ -60,6 +60,48 @@ TEST(ChunkTest, chunk_test)
   }
 }
 
+TEST(ChunkTest, dictionary_column)
+{
+  auto   dictionary = make_shared<StringDictionary>();
+  Column column;
+  column.init_dictionary(4, dictionary, 8);
+  const char *values[] = {"ab", "cd", "ab", "", "abcd", "cd"};
+  for (const char *value : values) {
+    char str[4] = {0};
+    memcpy(str, value, min<size_t>(strlen(value), sizeof(str)));
+    ASSERT_EQ(column.append_one(str), RC::SUCCESS);
+  }
+  ASSERT_EQ(column.append_value(Value("cd")), RC::SUCCESS);
+
+  // 相同的字符串编号相同
+  ASSERT_EQ(column.count(), 7);
+  ASSERT_EQ(dictionary->size(), 4);
+  ASSERT_EQ(column.codes()[0], column.codes()[2]);
+  ASSERT_EQ(column.codes()[1], column.codes()[6]);
+  ASSERT_EQ(dictionary->find("cd", 2), column.codes()[1]);
+  ASSERT_EQ(dictionary->find("xy", 2), -1);
+  for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+    ASSERT_EQ(column.get_value(i).get_string(), values[i]);
+  }
+
+  // 复制到普通的列时解码，复制到使用同一个字典的列时只复制编号
+  vector<uint8_t> select = {1, 0, 1, 1, 0, 1, 1};
+  Column          decoded(AttrType::CHARS, 4, 8);
+  Column          encoded;
+  encoded.init_dictionary(4, dictionary, 8);
+  ASSERT_EQ(decoded.append_selected(column, select), RC::SUCCESS);
+  ASSERT_EQ(encoded.append_selected(column, select), RC::SUCCESS);
+  ASSERT_EQ(decoded.column_type(), Column::Type::NORMAL_COLUMN);
+  ASSERT_EQ(decoded.count(), 5);
+  ASSERT_EQ(encoded.count(), 5);
+  const char *expected[] = {"ab", "ab", "", "cd", "cd"};
+  for (int i = 0; i < 5; i++) {
+    ASSERT_EQ(decoded.get_value(i).get_string(), expected[i]);
+    ASSERT_EQ(encoded.get_value(i).get_string(), expected[i]);
+  }
+  ASSERT_EQ(dictionary->size(), 4);
+}
+
 int main(int argc, char **argv)
 {
 
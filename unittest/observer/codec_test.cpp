@@ -29,6 +29,23 @@ TEST(CodecTest, codec_test)
 
 }
 
+TEST(CodecTest, encode_index_error)
+{
+  // NaN 无法编码，错误要一直返回给调用者
+  bytes       key;
+  const float nan_value = std::numeric_limits<float>::quiet_NaN();
+  ASSERT_EQ(RC::INVALID_ARGUMENT, Codec::encode_value(Value(nan_value), key));
+
+  key.clear();
+  ASSERT_EQ(RC::INVALID_ARGUMENT, Codec::encode_index(1, 2, {Value(1), Value(nan_value)}, 3, key));
+
+  key.clear();
+  ASSERT_EQ(RC::SUCCESS, Codec::encode_index(1, 2, {Value(1), Value(1.5f)}, 3, key));
+  bytes prefix;
+  ASSERT_EQ(RC::SUCCESS, Codec::encode_index_prefix(1, 2, prefix));
+  ASSERT_TRUE(string_view((char *)key.data(), key.size()).starts_with(string_view((char *)prefix.data(), prefix.size())));
+}
+
 int main(int argc, char **argv)
 {
 
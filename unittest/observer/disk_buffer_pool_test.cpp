@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include <filesystem>
+#include <thread>
 
 #include "gtest/gtest.h"
 #include "common/log/log.h"
@@ -105,6 +106,70 @@ TEST(DiskBufferPool, allocate_dispose)
   ASSERT_EQ(buffer_pool_manager.close_file(buffer_pool_filename.c_str()), RC::SUCCESS);
 }
 
+TEST(DiskBufferPool, frame_version)
+{
+  filesystem::path directory("buffer_pool");
+  filesystem::remove_all(directory);
+  filesystem::create_directories(directory);
+
+  filesystem::path buffer_pool_filename = directory / "frame_version.bp";
+
+  BufferPoolManager buffer_pool_manager;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool_manager.init(make_unique<VacuousDoubleWriteBuffer>()));
+  VacuousLogHandler log_handler;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool_manager.create_file(buffer_pool_filename.c_str()));
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool_manager.open_file(log_handler, buffer_pool_filename.c_str(), buffer_pool));
+  ASSERT_NE(buffer_pool, nullptr);
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+  ASSERT_NE(frame, nullptr);
+
+  // 读锁不修改版本号
+  const uint64_t version = frame->read_version();
+  ASSERT_EQ(version % 2, 0);
+  frame->read_latch();
+  frame->read_unlatch();
+  ASSERT_TRUE(frame->validate_version(version));
+
+  // 持有写锁时版本号是奇数，递归加锁只在最外层修改版本号
+  frame->write_latch();
+  ASSERT_EQ(frame->read_version() % 2, 1);
+  ASSERT_FALSE(frame->validate_version(version));
+  frame->write_latch();
+  frame->write_unlatch();
+  ASSERT_EQ(frame->read_version(), version + 1);
+  frame->write_unlatch();
+  ASSERT_EQ(frame->read_version(), version + 2);
+  ASSERT_FALSE(frame->validate_version(version));
+
+  // 调用者自己还 pin 着页面时，dispose_page 返回错误而不是一直等待，页面仍然可以正常使用
+  const PageNum page_num = frame->page_num();
+  ASSERT_EQ(RC::INTERNAL, buffer_pool->dispose_page(page_num));
+  ASSERT_EQ(frame->page_num(), page_num);
+  ASSERT_EQ(frame->pin_count(), 1);
+
+#ifdef CONCURRENCY
+  // 页面还被其他人 pin 着时，dispose_page 要等到对方 unpin 以后才释放页面
+  atomic<bool>  disposed(false);
+  thread        disposer([&]() {
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->dispose_page(page_num));
+    disposed = true;
+  });
+  this_thread::sleep_for(chrono::milliseconds(100));
+  ASSERT_FALSE(disposed.load());
+  ASSERT_EQ(buffer_pool->unpin_page(frame), RC::SUCCESS);
+  disposer.join();
+  ASSERT_TRUE(disposed.load());
+#else
+  ASSERT_EQ(buffer_pool->unpin_page(frame), RC::SUCCESS);
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->dispose_page(page_num));
+#endif
+
+  ASSERT_EQ(buffer_pool_manager.close_file(buffer_pool_filename.c_str()), RC::SUCCESS);
+}
+
 TEST(BufferPool, create)
 {
   filesystem::path test_directory("buffer_pool");
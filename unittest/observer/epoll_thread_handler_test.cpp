@@ -0,0 +1,236 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "gtest/gtest.h"
+
+#ifdef __linux__
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "common/lang/chrono.h"
+#include "net/communicator.h"
+#include "net/sql_task_handler.h"
+#include "net/thread_handler.h"
+#include "session/session.h"
+#include "sql/plan_cache/prepared_statement.h"
+
+#define private public
+#include "net/epoll_thread_handler.h"
+#undef private
+
+using namespace std;
+using namespace common;
+
+namespace {
+
+/// 慢请求执行的时间，远大于 reactor 请求被偷走的阈值
+constexpr auto SLOW_REQUEST_TIME = chrono::milliseconds(500);
+
+/**
+ * @brief 每次从连接上读取一个字节作为一个请求，不创建 SQL 任务
+ * @details 's' 表示一个执行时间很长的请求。对端关闭连接时返回错误，由线程模型关闭连接
+ */
+class TestCommunicator : public Communicator
+{
+public:
+  TestCommunicator(atomic<int> &destroyed) : destroyed_(destroyed) {}
+  ~TestCommunicator() override { destroyed_++; }
+
+  RC read_event(SessionEvent *&event) override
+  {
+    event = nullptr;
+
+    char    request = 0;
+    ssize_t n       = ::read(fd_, &request, 1);
+    if (n <= 0) {
+      return RC::IOERR_READ;
+    }
+
+    thread_id_ = this_thread::get_id();
+    if (request == 's') {
+      slow_running_ = true;
+      this_thread::sleep_for(SLOW_REQUEST_TIME);
+      slow_running_ = false;
+    } else if (slow_running_peer_ != nullptr) {
+      handled_while_slow_ = slow_running_peer_->slow_running_.load();
+    }
+    handled_++;
+    return RC::SUCCESS;
+  }
+
+  RC write_result(SessionEvent *event, bool &need_disconnect) override
+  {
+    need_disconnect = false;
+    return RC::SUCCESS;
+  }
+
+public:
+  atomic<int>       handled_{0};
+  atomic<bool>      slow_running_{false};
+  TestCommunicator *slow_running_peer_  = nullptr;  ///< 处理请求时检查这个连接上的慢请求是否还在执行
+  bool              handled_while_slow_ = false;
+  thread::id        thread_id_;
+
+private:
+  atomic<int> &destroyed_;
+};
+
+template <typename Pred>
+bool wait_until(Pred pred, chrono::milliseconds timeout = chrono::milliseconds(5000))
+{
+  auto deadline = chrono::steady_clock::now() + timeout;
+  while (!pred()) {
+    if (chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    this_thread::sleep_for(chrono::milliseconds(1));
+  }
+  return true;
+}
+
+}  // namespace
+
+class EpollThreadHandlerTest : public ::testing::Test
+{
+protected:
+  void SetUp() override { ASSERT_EQ(RC::SUCCESS, handler_.start()); }
+
+  void TearDown() override
+  {
+    handler_.stop();
+    handler_.await_stop();
+    for (int fd : client_fds_) {
+      close(fd);
+    }
+  }
+
+  /// 创建一个连接，返回服务端的 communicator，客户端的 fd 放到 client_fd 中
+  TestCommunicator *connect(int &client_fd)
+  {
+    int fds[2];
+    EXPECT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    client_fd = fds[1];
+    client_fds_.push_back(client_fd);
+
+    auto communicator = new TestCommunicator(destroyed_);
+    EXPECT_EQ(RC::SUCCESS, communicator->init(fds[0], make_unique<Session>(), "test"));
+    EXPECT_EQ(RC::SUCCESS, handler_.new_connection(communicator));
+    return communicator;
+  }
+
+  size_t connection_num()
+  {
+    lock_guard guard(handler_.lock_);
+    return handler_.connections_.size();
+  }
+
+protected:
+  EpollThreadHandler handler_;
+  atomic<int>        destroyed_{0};
+  vector<int>        client_fds_;
+};
+
+TEST_F(EpollThreadHandlerTest, rearm_after_request)
+{
+  int               client_fd    = -1;
+  TestCommunicator *communicator = connect(client_fd);
+
+  // 连接使用 EPOLLONESHOT 注册，每个请求处理完之后都需要重新注册才能收到下一个请求
+  for (int i = 1; i <= 100; i++) {
+    ASSERT_EQ(1, write(client_fd, "a", 1));
+    ASSERT_TRUE(wait_until([&]() { return communicator->handled_ == i; }));
+  }
+
+  // 一次到达多个请求时，剩余的数据在重新注册之后仍然可以触发事件
+  ASSERT_EQ(5, write(client_fd, "abcde", 5));
+  ASSERT_TRUE(wait_until([&]() { return communicator->handled_ == 105; }));
+
+  this_thread::sleep_for(chrono::milliseconds(50));
+  ASSERT_EQ(105, communicator->handled_);
+  ASSERT_EQ(1, connection_num());
+  ASSERT_EQ(0, destroyed_);
+}
+
+TEST_F(EpollThreadHandlerTest, steal_from_busy_reactor)
+{
+  // 连接按照轮询的方式分配，第一个连接和第 reactor_num + 1 个连接在同一个 reactor 上
+  const size_t reactor_num = handler_.reactors_.size();
+  ASSERT_GT(reactor_num, 0);
+
+  vector<TestCommunicator *> communicators;
+  vector<int>                client_fds(reactor_num + 1);
+  for (size_t i = 0; i <= reactor_num; i++) {
+    communicators.push_back(connect(client_fds[i]));
+  }
+  TestCommunicator *slow = communicators.front();
+  TestCommunicator *fast = communicators.back();
+  fast->slow_running_peer_ = slow;
+
+  ASSERT_EQ(1, write(client_fds.front(), "s", 1));
+  ASSERT_TRUE(wait_until([&]() { return slow->slow_running_.load(); }));
+
+  // reactor 被慢请求阻塞，同一个 reactor 上的请求由辅助线程偷走执行，不需要等慢请求结束
+  ASSERT_EQ(1, write(client_fds.back(), "a", 1));
+  ASSERT_TRUE(wait_until([&]() { return fast->handled_ == 1; }, SLOW_REQUEST_TIME));
+  ASSERT_TRUE(fast->handled_while_slow_);
+  ASSERT_NE(slow->thread_id_, fast->thread_id_);
+
+  // 被偷走的连接仍然由原来的 reactor 监听
+  ASSERT_TRUE(wait_until([&]() { return slow->handled_ == 1; }));
+  ASSERT_EQ(1, write(client_fds.back(), "b", 1));
+  ASSERT_TRUE(wait_until([&]() { return fast->handled_ == 2; }));
+  ASSERT_FALSE(fast->handled_while_slow_);
+  ASSERT_EQ(1, write(client_fds.front(), "a", 1));
+  ASSERT_TRUE(wait_until([&]() { return slow->handled_ == 2; }));
+}
+
+TEST_F(EpollThreadHandlerTest, close_connection)
+{
+  int               client_fd1    = -1;
+  int               client_fd2    = -1;
+  TestCommunicator *communicator1 = connect(client_fd1);
+  TestCommunicator *communicator2 = connect(client_fd2);
+  ASSERT_EQ(2, connection_num());
+
+  ASSERT_EQ(1, write(client_fd1, "a", 1));
+  ASSERT_TRUE(wait_until([&]() { return communicator1->handled_ == 1; }));
+
+  // 客户端关闭连接后，服务端读取失败，删除连接关联的数据并关闭 communicator
+  ASSERT_EQ(0, shutdown(client_fd1, SHUT_WR));
+  ASSERT_TRUE(wait_until([&]() { return destroyed_ == 1; }));
+  ASSERT_EQ(1, connection_num());
+
+  // 其它连接不受影响
+  ASSERT_EQ(1, write(client_fd2, "a", 1));
+  ASSERT_TRUE(wait_until([&]() { return communicator2->handled_ == 1; }));
+
+  // 服务端主动关闭
+  ASSERT_EQ(RC::SUCCESS, handler_.close_connection(communicator2));
+  ASSERT_EQ(2, destroyed_);
+  ASSERT_EQ(0, connection_num());
+
+  // 停止时还没有关闭的连接也会被清理
+  int client_fd3 = -1;
+  connect(client_fd3);
+  ASSERT_EQ(1, connection_num());
+  handler_.stop();
+  handler_.await_stop();
+  ASSERT_EQ(3, destroyed_);
+  ASSERT_EQ(0, connection_num());
+}
+
+#endif  // __linux__
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
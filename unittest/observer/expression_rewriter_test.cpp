@@ -0,0 +1,178 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "gtest/gtest.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/project_logical_operator.h"
+#include "sql/optimizer/constant_folding_rule.h"
+#include "sql/optimizer/expression_rewriter.h"
+#include "storage/field/field_meta.h"
+
+using namespace std;
+using namespace common;
+
+namespace {
+
+/// 表达式 a 使用的字段，不需要真正的表
+const FieldMeta field_a("a", AttrType::INTS, 0, 4, true, 0);
+
+unique_ptr<Expression> field() { return make_unique<FieldExpr>(nullptr, &field_a); }
+
+unique_ptr<Expression> value(int v) { return make_unique<ValueExpr>(Value(v)); }
+
+unique_ptr<Expression> arithmetic(
+    ArithmeticExpr::Type type, unique_ptr<Expression> left, unique_ptr<Expression> right, const char *name)
+{
+  auto expr = make_unique<ArithmeticExpr>(type, std::move(left), std::move(right));
+  expr->set_name(name);
+  return expr;
+}
+
+/// 把表达式放到投影算子中，使用 ExpressionRewriter 改写，返回改写之后的表达式
+unique_ptr<Expression> rewrite(unique_ptr<Expression> expr, bool &change_made)
+{
+  vector<unique_ptr<Expression>> expressions;
+  expressions.emplace_back(std::move(expr));
+  unique_ptr<LogicalOperator> oper = make_unique<ProjectLogicalOperator>(std::move(expressions));
+
+  ExpressionRewriter rewriter;
+  change_made = false;
+  EXPECT_EQ(RC::SUCCESS, rewriter.rewrite(oper, change_made));
+  EXPECT_EQ(1, oper->expressions().size());
+  return std::move(oper->expressions().front());
+}
+
+}  // namespace
+
+TEST(ConstantFoldingRule, fold_constant)
+{
+  ConstantFoldingRule rule;
+  bool                change_made = false;
+
+  // 1 + 2 * 3
+  unique_ptr<Expression> expr = arithmetic(ArithmeticExpr::Type::ADD,
+      value(1),
+      arithmetic(ArithmeticExpr::Type::MUL, value(2), value(3), "2*3"),
+      "1+2*3");
+  ASSERT_EQ(RC::SUCCESS, rule.rewrite(expr, change_made));
+  ASSERT_TRUE(change_made);
+  ASSERT_EQ(ExprType::VALUE, expr->type());
+  ASSERT_STREQ("1+2*3", expr->name());
+  Value result;
+  ASSERT_EQ(RC::SUCCESS, expr->try_get_value(result));
+  ASSERT_EQ(7, result.get_int());
+
+  // 不是算术运算或类型转换的表达式不处理
+  expr = value(5);
+  ASSERT_EQ(RC::SUCCESS, rule.rewrite(expr, change_made));
+  ASSERT_FALSE(change_made);
+
+  // 整个表达式不是常量时，规则本身不处理子表达式
+  expr = arithmetic(ArithmeticExpr::Type::ADD,
+      field(),
+      arithmetic(ArithmeticExpr::Type::MUL, value(2), value(3), "2*3"),
+      "a+2*3");
+  ASSERT_EQ(RC::SUCCESS, rule.rewrite(expr, change_made));
+  ASSERT_FALSE(change_made);
+  ASSERT_EQ(ExprType::ARITHMETIC, expr->type());
+}
+
+TEST(ConstantFoldingRule, fold_sub_expression)
+{
+  // a + 2 * 3 只折叠 2 * 3，保留名字
+  bool change_made = false;
+  unique_ptr<Expression> expr = rewrite(arithmetic(ArithmeticExpr::Type::ADD,
+                                            field(),
+                                            arithmetic(ArithmeticExpr::Type::MUL, value(2), value(3), "2*3"),
+                                            "a+2*3"),
+      change_made);
+  ASSERT_TRUE(change_made);
+  ASSERT_EQ(ExprType::ARITHMETIC, expr->type());
+  ASSERT_STREQ("a+2*3", expr->name());
+
+  auto arithmetic_expr = static_cast<ArithmeticExpr *>(expr.get());
+  ASSERT_EQ(ExprType::FIELD, arithmetic_expr->left()->type());
+  ASSERT_EQ(ExprType::VALUE, arithmetic_expr->right()->type());
+  ASSERT_STREQ("2*3", arithmetic_expr->right()->name());
+  Value result;
+  ASSERT_EQ(RC::SUCCESS, arithmetic_expr->right()->try_get_value(result));
+  ASSERT_EQ(6, result.get_int());
+
+  // 更深的嵌套：(a + (1 + 1)) * (4 - 1)
+  expr = rewrite(arithmetic(ArithmeticExpr::Type::MUL,
+                     arithmetic(ArithmeticExpr::Type::ADD,
+                         field(),
+                         arithmetic(ArithmeticExpr::Type::ADD, value(1), value(1), "1+1"),
+                         "a+(1+1)"),
+                     arithmetic(ArithmeticExpr::Type::SUB, value(4), value(1), "4-1"),
+                     "(a+(1+1))*(4-1)"),
+      change_made);
+  ASSERT_TRUE(change_made);
+  arithmetic_expr = static_cast<ArithmeticExpr *>(expr.get());
+  ASSERT_EQ(ExprType::ARITHMETIC, arithmetic_expr->left()->type());
+  ASSERT_EQ(ExprType::VALUE, static_cast<ArithmeticExpr *>(arithmetic_expr->left().get())->right()->type());
+  ASSERT_EQ(ExprType::VALUE, arithmetic_expr->right()->type());
+
+  // 没有可以折叠的部分
+  expr = rewrite(arithmetic(ArithmeticExpr::Type::ADD, field(), value(1), "a+1"), change_made);
+  ASSERT_FALSE(change_made);
+  ASSERT_EQ(ExprType::ARITHMETIC, expr->type());
+}
+
+TEST(ConstantFoldingRule, param_not_folded)
+{
+  ConstantFoldingRule rule;
+  bool                change_made = false;
+
+  // ? + 1 每次执行时的值不同
+  unique_ptr<Expression> expr =
+      arithmetic(ArithmeticExpr::Type::ADD, make_unique<ParamExpr>(0, AttrType::INTS), value(1), "?+1");
+  ASSERT_EQ(RC::SUCCESS, rule.rewrite(expr, change_made));
+  ASSERT_FALSE(change_made);
+
+  expr = rewrite(std::move(expr), change_made);
+  ASSERT_FALSE(change_made);
+  ASSERT_EQ(ExprType::ARITHMETIC, expr->type());
+  ASSERT_EQ(ExprType::PARAM, static_cast<ArithmeticExpr *>(expr.get())->left()->type());
+
+  // ? + 2 * 3 仍然可以折叠常量的部分
+  expr = rewrite(arithmetic(ArithmeticExpr::Type::ADD,
+                     make_unique<ParamExpr>(0, AttrType::INTS),
+                     arithmetic(ArithmeticExpr::Type::MUL, value(2), value(3), "2*3"),
+                     "?+2*3"),
+      change_made);
+  ASSERT_TRUE(change_made);
+  auto arithmetic_expr = static_cast<ArithmeticExpr *>(expr.get());
+  ASSERT_EQ(ExprType::PARAM, arithmetic_expr->left()->type());
+  ASSERT_EQ(ExprType::VALUE, arithmetic_expr->right()->type());
+}
+
+TEST(ConstantFoldingRule, computed_expression_not_folded)
+{
+  // pos 不是 -1 的表达式已经由下层算子计算好了，直接从元组中取值
+  unique_ptr<Expression> expr = arithmetic(ArithmeticExpr::Type::ADD, value(1), value(2), "1+2");
+  expr->set_pos(0);
+
+  ConstantFoldingRule rule;
+  bool                change_made = false;
+  ASSERT_EQ(RC::SUCCESS, rule.rewrite(expr, change_made));
+  ASSERT_FALSE(change_made);
+
+  expr = rewrite(std::move(expr), change_made);
+  ASSERT_FALSE(change_made);
+  ASSERT_EQ(ExprType::ARITHMETIC, expr->type());
+  ASSERT_EQ(0, expr->pos());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
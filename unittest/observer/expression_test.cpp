@@ -312,6 +312,111 @@ TEST(ComparisonExpr, comparison_expr_test)
   }
 }
 
+TEST(ArithmeticExpr, get_selected_column)
+{
+  const int               int_len = sizeof(int);
+  int                     count   = 100;
+  std::unique_ptr<Column> column1 = std::make_unique<Column>(AttrType::INTS, int_len, count);
+  std::unique_ptr<Column> column2 = std::make_unique<Column>(AttrType::FLOATS, int_len, count);
+  for (int i = 0; i < count; ++i) {
+    int   int_value   = i;
+    float float_value = i % 3;
+    column1->append_one((char *)&int_value);
+    column2->append_one((char *)&float_value);
+  }
+  Chunk chunk;
+  chunk.add_column(std::move(column1), 0);
+  chunk.add_column(std::move(column2), 1);
+  FieldMeta field_meta1("col1", AttrType::INTS, 0, int_len, true, 0);
+  FieldMeta field_meta2("col2", AttrType::FLOATS, 0, int_len, true, 1);
+  Field     field1(nullptr, &field_meta1);
+  Field     field2(nullptr, &field_meta2);
+
+  // INTS 和 FLOATS 混合计算，除数为 0 时与逐行计算的结果相同
+  ArithmeticExpr div_expr(
+      ArithmeticExpr::Type::DIV, std::make_unique<FieldExpr>(field1), std::make_unique<FieldExpr>(field2));
+  Column column;
+  ASSERT_EQ(div_expr.get_column(chunk, column), RC::SUCCESS);
+  ASSERT_EQ(column.attr_type(), AttrType::FLOATS);
+  for (int i = 0; i < count; ++i) {
+    ArithmeticExpr row_expr(ArithmeticExpr::Type::DIV,
+        std::make_unique<ValueExpr>(Value(i)),
+        std::make_unique<ValueExpr>(Value((float)(i % 3))));
+    Value          expect;
+    ASSERT_EQ(row_expr.try_get_value(expect), RC::SUCCESS);
+    EXPECT_FLOAT_EQ(column.get_value(i).get_float(), expect.get_float());
+  }
+
+  // 只计算选中的行
+  std::vector<uint8_t> select(count, 0);
+  select[7]  = 1;
+  select[50] = 1;
+  ArithmeticExpr sub_expr(
+      ArithmeticExpr::Type::SUB, std::make_unique<FieldExpr>(field1), std::make_unique<ValueExpr>(Value(10)));
+  Column selected_column;
+  ASSERT_EQ(sub_expr.get_selected_column(chunk, select, selected_column), RC::SUCCESS);
+  ASSERT_EQ(selected_column.count(), count);
+  ASSERT_EQ(selected_column.get_value(7).get_int(), -3);
+  ASSERT_EQ(selected_column.get_value(50).get_int(), 40);
+
+  // 一元运算
+  ArithmeticExpr negative_expr(ArithmeticExpr::Type::NEGATIVE, std::make_unique<FieldExpr>(field2), nullptr);
+  ASSERT_EQ(negative_expr.get_selected_column(chunk, select, selected_column), RC::SUCCESS);
+  EXPECT_FLOAT_EQ(selected_column.get_value(7).get_float(), -1.0f);
+  EXPECT_FLOAT_EQ(selected_column.get_value(50).get_float(), -2.0f);
+
+  // 类型转换
+  CastExpr cast_expr(std::make_unique<FieldExpr>(field1), AttrType::FLOATS);
+  ASSERT_EQ(cast_expr.get_column(chunk, column), RC::SUCCESS);
+  ASSERT_EQ(column.attr_type(), AttrType::FLOATS);
+  for (int i = 0; i < count; ++i) {
+    EXPECT_FLOAT_EQ(column.get_value(i).get_float(), (float)i);
+  }
+}
+
+TEST(ConjunctionExpr, eval_chunk)
+{
+  const int               int_len = sizeof(int);
+  int                     count   = 100;
+  std::unique_ptr<Column> column1 = std::make_unique<Column>(AttrType::INTS, int_len, count);
+  for (int i = 0; i < count; ++i) {
+    column1->append_one((char *)&i);
+  }
+  Chunk chunk;
+  chunk.add_column(std::move(column1), 0);
+  FieldMeta field_meta("col1", AttrType::INTS, 0, int_len, true, 0);
+  Field     field(nullptr, &field_meta);
+
+  // col1 < 10 OR col1 * 2 > 180
+  auto make_children = [&]() {
+    vector<unique_ptr<Expression>> children;
+    children.emplace_back(new ComparisonExpr(
+        CompOp::LESS_THAN, std::make_unique<FieldExpr>(field), std::make_unique<ValueExpr>(Value(10))));
+    children.emplace_back(new ComparisonExpr(CompOp::GREAT_THAN,
+        std::make_unique<ArithmeticExpr>(
+            ArithmeticExpr::Type::MUL, std::make_unique<FieldExpr>(field), std::make_unique<ValueExpr>(Value(2))),
+        std::make_unique<ValueExpr>(Value(180))));
+    return children;
+  };
+
+  vector<unique_ptr<Expression>> or_children = make_children();
+  ConjunctionExpr                or_expr(ConjunctionExpr::Type::OR, or_children);
+  std::vector<uint8_t>           select(count, 1);
+  select[95] = 0;
+  ASSERT_EQ(or_expr.eval(chunk, select), RC::SUCCESS);
+  for (int i = 0; i < count; ++i) {
+    ASSERT_EQ(select[i], (i < 10 || (i > 90 && i != 95)) ? 1 : 0);
+  }
+
+  vector<unique_ptr<Expression>> and_children = make_children();
+  ConjunctionExpr                and_expr(ConjunctionExpr::Type::AND, and_children);
+  select.assign(count, 1);
+  ASSERT_EQ(and_expr.eval(chunk, select), RC::SUCCESS);
+  for (int i = 0; i < count; ++i) {
+    ASSERT_EQ(select[i], 0);
+  }
+}
+
 TEST(AggregateExpr, aggregate_expr_test)
 {
   Value                  int_value(1);
@@ -0,0 +1,242 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <filesystem>
+#include <set>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "storage/db/db.h"
+#include "storage/table/table.h"
+#include "storage/trx/trx.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/aggregate_vec_physical_operator.h"
+#include "sql/operator/gather_vec_physical_operator.h"
+#include "sql/operator/table_scan_vec_physical_operator.h"
+
+using namespace std;
+using namespace common;
+
+/**
+ * @brief 计算时总是失败的表达式，用来检查 worker 中的错误能够返回给调用者
+ */
+class FailingExpr : public Expression
+{
+public:
+  unique_ptr<Expression> copy() const override { return make_unique<FailingExpr>(); }
+
+  RC get_value(const Tuple &tuple, Value &value) const override { return RC::INTERNAL; }
+  RC get_column(Chunk &chunk, Column &column) override { return RC::INTERNAL; }
+
+  ExprType type() const override { return ExprType::FIELD; }
+  AttrType value_type() const override { return AttrType::INTS; }
+};
+
+/**
+ * @brief 没有开启 CONCURRENCY 时堆表不支持并行扫描，gather 退回到单线程执行，结果应该完全一样
+ */
+class GatherVecPhysicalOperatorTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    filesystem::remove_all(test_directory_);
+    filesystem::create_directories(test_directory_);
+    db_ = make_unique<Db>();
+    ASSERT_EQ(RC::SUCCESS, db_->init("gather_db", test_directory_.c_str(), "vacuous", "vacuous", "heap"));
+
+    vector<AttrInfoSqlNode> attr_infos(2);
+    attr_infos[0].name   = "a";
+    attr_infos[0].type   = AttrType::INTS;
+    attr_infos[0].length = 4;
+    attr_infos[1].name   = "b";
+    attr_infos[1].type   = AttrType::INTS;
+    attr_infos[1].length = 4;
+    ASSERT_EQ(RC::SUCCESS, db_->create_table("t", attr_infos, {}, StorageFormat::PAX_FORMAT));
+    table_ = db_->find_table("t");
+    ASSERT_NE(table_, nullptr);
+
+    // 记录分布在很多页面中，保证每个 worker 都能领取到 morsel
+    trx_ = db_->trx_kit().create_trx(db_->log_handler());
+    for (int i = 0; i < record_num_; i++) {
+      Value values[2];
+      values[0].set_int(i);
+      values[1].set_int(i % 7);
+      Record record;
+      ASSERT_EQ(RC::SUCCESS, table_->make_record(2, values, record));
+      ASSERT_EQ(RC::SUCCESS, trx_->insert_record(table_, record));
+    }
+  }
+
+  void TearDown() override
+  {
+    db_->trx_kit().destroy_trx(trx_);
+    trx_   = nullptr;
+    table_ = nullptr;
+    db_.reset();
+    filesystem::remove_all(test_directory_);
+  }
+
+  unique_ptr<Expression> field_expr(const char *name) const
+  {
+    return make_unique<FieldExpr>(table_, table_->table_meta().field(name));
+  }
+
+  /// 扫描 t，a < limit 的过滤条件下推到扫描算子中。projected 为 true 时输出 (b, a)，否则输出扫描到的所有列
+  unique_ptr<GatherVecPhysicalOperator> create_gather(int parallel_degree, bool projected, int limit)
+  {
+    auto scan_oper = make_unique<TableScanVecPhysicalOperator>(table_, ReadWriteMode::READ_ONLY);
+    vector<unique_ptr<Expression>> predicates;
+    predicates.emplace_back(
+        make_unique<ComparisonExpr>(LESS_THAN, field_expr("a"), make_unique<ValueExpr>(Value(limit))));
+    scan_oper->set_predicates(std::move(predicates));
+
+    vector<unique_ptr<Expression>> expressions;
+    if (projected) {
+      expressions.emplace_back(field_expr("b"));
+      expressions.emplace_back(field_expr("a"));
+    }
+    auto gather = make_unique<GatherVecPhysicalOperator>(std::move(expressions), parallel_degree);
+    gather->add_child(std::move(scan_oper));
+    return gather;
+  }
+
+  /// 读取所有的行，统一按照 (a, b) 返回
+  RC collect(GatherVecPhysicalOperator &gather, bool projected, multiset<pair<int, int>> &rows)
+  {
+    const int a_index = projected ? 1 : table_->table_meta().field("a")->field_id();
+    const int b_index = projected ? 0 : table_->table_meta().field("b")->field_id();
+
+    rows.clear();
+    RC    rc = RC::SUCCESS;
+    Chunk chunk;
+    while (OB_SUCC(rc = gather.next(chunk))) {
+      for (int row = 0; row < chunk.rows(); row++) {
+        rows.emplace(chunk.get_value(a_index, row).get_int(), chunk.get_value(b_index, row).get_int());
+      }
+    }
+    return rc;
+  }
+
+protected:
+  const string test_directory_ = "gather_vec_test";
+  const int    record_num_     = 50000;
+
+  unique_ptr<Db> db_;
+  Table         *table_ = nullptr;
+  Trx           *trx_   = nullptr;
+};
+
+TEST_F(GatherVecPhysicalOperatorTest, same_rows_as_serial_scan)
+{
+  const int limit = record_num_ - 1000;
+  for (bool projected : {false, true}) {
+    // 不并行时就是普通的顺序扫描
+    multiset<pair<int, int>> expected;
+    auto                     serial = create_gather(1, projected, limit);
+    ASSERT_EQ(RC::SUCCESS, serial->open(trx_));
+    ASSERT_EQ(RC::RECORD_EOF, collect(*serial, projected, expected));
+    ASSERT_EQ(RC::SUCCESS, serial->close());
+    ASSERT_EQ(static_cast<size_t>(limit), expected.size());
+
+    for (int parallel_degree : {2, 4, 8}) {
+      auto gather = create_gather(parallel_degree, projected, limit);
+
+      // 同一个算子执行两次，第二次使用新的 morsel 队列
+      for (int i = 0; i < 2; i++) {
+        multiset<pair<int, int>> rows;
+        ASSERT_EQ(RC::SUCCESS, gather->open(trx_));
+        ASSERT_EQ(RC::RECORD_EOF, collect(*gather, projected, rows));
+        ASSERT_EQ(RC::SUCCESS, gather->close());
+        ASSERT_EQ(expected, rows);
+      }
+    }
+  }
+}
+
+TEST_F(GatherVecPhysicalOperatorTest, close_before_eof)
+{
+  for (int parallel_degree : {2, 4}) {
+    for (int i = 0; i < 20; i++) {
+      auto gather = create_gather(parallel_degree, i % 2 == 0, record_num_);
+      ASSERT_EQ(RC::SUCCESS, gather->open(trx_));
+
+      // 只读取一部分数据就关闭，此时 worker 可能正阻塞在满的队列上
+      Chunk chunk;
+      for (int k = 0; k < i % 3; k++) {
+        ASSERT_EQ(RC::SUCCESS, gather->next(chunk));
+        ASSERT_GT(chunk.rows(), 0);
+      }
+      ASSERT_EQ(RC::SUCCESS, gather->close());
+    }
+  }
+}
+
+TEST_F(GatherVecPhysicalOperatorTest, failing_expression)
+{
+  for (int parallel_degree : {1, 2, 4}) {
+    auto scan_oper = make_unique<TableScanVecPhysicalOperator>(table_, ReadWriteMode::READ_ONLY);
+
+    vector<unique_ptr<Expression>> expressions;
+    expressions.emplace_back(field_expr("a"));
+    expressions.emplace_back(make_unique<FailingExpr>());
+    GatherVecPhysicalOperator gather(std::move(expressions), parallel_degree);
+    gather.add_child(std::move(scan_oper));
+
+    ASSERT_EQ(RC::SUCCESS, gather.open(trx_));
+    RC    rc = RC::SUCCESS;
+    Chunk chunk;
+    while (OB_SUCC(rc = gather.next(chunk))) {}
+    ASSERT_EQ(RC::INTERNAL, rc);
+
+    // 出错之后再调用 next 仍然返回错误，而不是 EOF
+    ASSERT_EQ(RC::INTERNAL, gather.next(chunk));
+    ASSERT_EQ(RC::SUCCESS, gather.close());
+  }
+}
+
+TEST_F(GatherVecPhysicalOperatorTest, parallel_aggregate)
+{
+  // 并行聚合与 gather 一样通过 create_morsel_worker 创建扫描算子，过滤条件需要复制到每个 worker 中
+  const int limit = record_num_ / 2;
+  auto      sum   = [&](int parallel_degree) {
+    auto sum_expr = make_unique<AggregateExpr>(AggregateExpr::Type::SUM, field_expr("a"));
+    sum_expr->set_pos(0);
+
+    auto scan_oper = make_unique<TableScanVecPhysicalOperator>(table_, ReadWriteMode::READ_ONLY);
+    vector<unique_ptr<Expression>> predicates;
+    predicates.emplace_back(
+        make_unique<ComparisonExpr>(LESS_THAN, field_expr("a"), make_unique<ValueExpr>(Value(limit))));
+    scan_oper->set_predicates(std::move(predicates));
+
+    AggregateVecPhysicalOperator aggregate_oper({sum_expr.get()});
+    aggregate_oper.set_parallel_degree(parallel_degree);
+    aggregate_oper.add_child(std::move(scan_oper));
+
+    Chunk chunk;
+    EXPECT_EQ(RC::SUCCESS, aggregate_oper.open(trx_));
+    EXPECT_EQ(RC::SUCCESS, aggregate_oper.next(chunk));
+    int result = chunk.get_value(0, 0).get_int();
+    EXPECT_EQ(RC::SUCCESS, aggregate_oper.close());
+    return result;
+  };
+
+  const int expected = sum(1);
+  ASSERT_EQ(static_cast<int>(static_cast<int64_t>(limit) * (limit - 1) / 2), expected);
+  for (int parallel_degree : {2, 4, 8}) {
+    ASSERT_EQ(expected, sum(parallel_degree));
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,231 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2024/06/03.
+//
+
+#include "gtest/gtest.h"
+#include "sql/operator/hash_group_by_physical_operator.h"
+#include "sql/expr/expression.h"
+#include "sql/expr/tuple.h"
+#include "common/lang/map.h"
+#include <cmath>
+
+using namespace std;
+using namespace common;
+
+namespace {
+
+/**
+ * @brief 按照下标从元组中取值的表达式，用来代替需要绑定表的 FieldExpr
+ */
+class CellExpr : public Expression
+{
+public:
+  CellExpr(int index, AttrType attr_type) : index_(index), attr_type_(attr_type) {}
+
+  unique_ptr<Expression> copy() const override { return make_unique<CellExpr>(index_, attr_type_); }
+
+  RC get_value(const Tuple &tuple, Value &value) const override { return tuple.cell_at(index_, value); }
+
+  ExprType type() const override { return ExprType::FIELD; }
+  AttrType value_type() const override { return attr_type_; }
+
+private:
+  int      index_;
+  AttrType attr_type_;
+};
+
+/**
+ * @brief 依次输出给定行的子算子
+ */
+class RowsPhysicalOperator : public PhysicalOperator
+{
+public:
+  explicit RowsPhysicalOperator(const vector<vector<Value>> &rows) : rows_(rows) {}
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::CALC; }
+
+  RC open(Trx *) override
+  {
+    current_ = -1;
+    return RC::SUCCESS;
+  }
+
+  RC next() override
+  {
+    if (++current_ >= static_cast<int>(rows_.size())) {
+      return RC::RECORD_EOF;
+    }
+    tuple_.set_cells(rows_[current_]);
+    tuple_.set_names(vector<TupleCellSpec>(rows_[current_].size(), TupleCellSpec("c")));
+    return RC::SUCCESS;
+  }
+
+  RC close() override { return RC::SUCCESS; }
+
+  Tuple *current_tuple() override { return &tuple_; }
+
+private:
+  const vector<vector<Value>> &rows_;
+  int                          current_ = -1;
+  ValueListTuple               tuple_;
+};
+
+/**
+ * @brief 构造 select sum(c<sum_index>) from rows group by c<key_indexes>
+ */
+unique_ptr<HashGroupByPhysicalOperator> create_group_by(const vector<vector<Value>> &rows,
+    const vector<pair<int, AttrType>> &keys, int sum_index, unique_ptr<Expression> &sum_expr)
+{
+  vector<unique_ptr<Expression>> group_by_exprs;
+  for (const auto &[index, attr_type] : keys) {
+    group_by_exprs.emplace_back(make_unique<CellExpr>(index, attr_type));
+  }
+
+  sum_expr = make_unique<AggregateExpr>(
+      AggregateExpr::Type::SUM, make_unique<CellExpr>(sum_index, rows.front()[sum_index].attr_type()));
+  sum_expr->set_name("sum");
+
+  vector<Expression *> aggregate_exprs{sum_expr.get()};
+  auto oper = make_unique<HashGroupByPhysicalOperator>(std::move(group_by_exprs), std::move(aggregate_exprs));
+  oper->add_child(make_unique<RowsPhysicalOperator>(rows));
+  return oper;
+}
+
+/**
+ * @brief 读出所有分组，返回 分组第一行的 key 列 -> sum 的结果
+ */
+RC collect_groups(PhysicalOperator &oper, int key_index, map<string, Value> &groups)
+{
+  groups.clear();
+  RC rc = RC::SUCCESS;
+  while (OB_SUCC(rc = oper.next())) {
+    Tuple *tuple = oper.current_tuple();
+    if (nullptr == tuple) {
+      return RC::INTERNAL;
+    }
+
+    Value key;
+    Value sum;
+    if (OB_FAIL(rc = tuple->cell_at(key_index, key)) || OB_FAIL(rc = tuple->find_cell(TupleCellSpec("sum"), sum))) {
+      return rc;
+    }
+    if (!groups.emplace(key.to_string(), sum).second) {
+      return RC::INTERNAL;  // 同一个分组键输出了两次
+    }
+  }
+  return RC::RECORD_EOF == rc ? RC::SUCCESS : rc;
+}
+
+}  // namespace
+
+TEST(HashGroupByPhysicalOperator, many_groups)
+{
+  // 分组数量远超过默认的桶数量（1024），会触发多次扩容
+  const int group_num = 10000;
+  const int round_num = 3;
+
+  // 列：int 键, float 键, 字符串键, 求和的值
+  vector<vector<Value>> rows;
+  for (int round = 0; round < round_num; round++) {
+    for (int i = 0; i < group_num; i++) {
+      string str = "key_" + to_string(i);
+      rows.push_back({Value(i), Value(i * 0.5f), Value(str.c_str()), Value(i + round)});
+    }
+  }
+
+  unique_ptr<Expression> sum_expr;
+  auto oper = create_group_by(
+      rows, {{0, AttrType::INTS}, {1, AttrType::FLOATS}, {2, AttrType::CHARS}}, 3, sum_expr);
+
+  // 执行两次，确认重新 open 之后分组会重建
+  for (int i = 0; i < 2; i++) {
+    ASSERT_EQ(RC::SUCCESS, oper->open(nullptr));
+
+    map<string, Value> groups;
+    ASSERT_EQ(RC::SUCCESS, collect_groups(*oper, 2, groups));
+    ASSERT_EQ(static_cast<size_t>(group_num), groups.size());
+    for (int k = 0; k < group_num; k++) {
+      auto iter = groups.find("key_" + to_string(k));
+      ASSERT_NE(iter, groups.end());
+      ASSERT_EQ(k * round_num + (0 + 1 + 2), iter->second.get_int());
+    }
+
+    ASSERT_EQ(RC::SUCCESS, oper->close());
+  }
+}
+
+TEST(HashGroupByPhysicalOperator, single_key_types)
+{
+  const int group_num = 3000;
+
+  vector<vector<Value>> rows;
+  for (int i = 0; i < group_num * 2; i++) {
+    int    k   = i % group_num;
+    string str = "s" + to_string(k);
+    rows.push_back({Value(k), Value(k * 0.25f), Value(str.c_str()), Value(1)});
+  }
+
+  const vector<pair<int, AttrType>> keys = {{0, AttrType::INTS}, {1, AttrType::FLOATS}, {2, AttrType::CHARS}};
+  for (const auto &key : keys) {
+    unique_ptr<Expression> sum_expr;
+    auto oper = create_group_by(rows, {key}, 3, sum_expr);
+    ASSERT_EQ(RC::SUCCESS, oper->open(nullptr));
+
+    map<string, Value> groups;
+    ASSERT_EQ(RC::SUCCESS, collect_groups(*oper, key.first, groups));
+    ASSERT_EQ(static_cast<size_t>(group_num), groups.size());
+    for (const auto &[name, sum] : groups) {
+      ASSERT_EQ(2, sum.get_int());
+    }
+    ASSERT_EQ(RC::SUCCESS, oper->close());
+  }
+}
+
+TEST(HashGroupByPhysicalOperator, float_keys_exact)
+{
+  // 分组按照 float 的精确值划分：误差范围内但不相同的值是不同的分组，-0.0 与 0.0 是同一个分组
+  const float base = 1.0f;
+  const float near = nextafterf(base, 2.0f);
+  ASSERT_EQ(0, Value(base).compare(Value(near)));
+
+  vector<vector<Value>> rows = {
+      {Value(base), Value(1)},
+      {Value(near), Value(10)},
+      {Value(base), Value(100)},
+      {Value(0.0f), Value(1000)},
+      {Value(-0.0f), Value(10000)},
+  };
+
+  unique_ptr<Expression> sum_expr;
+  auto oper = create_group_by(rows, {{0, AttrType::FLOATS}}, 1, sum_expr);
+  ASSERT_EQ(RC::SUCCESS, oper->open(nullptr));
+
+  vector<int> sums;
+  RC          rc = RC::SUCCESS;
+  while (OB_SUCC(rc = oper->next())) {
+    Value sum;
+    ASSERT_EQ(RC::SUCCESS, oper->current_tuple()->find_cell(TupleCellSpec("sum"), sum));
+    sums.push_back(sum.get_int());
+  }
+  ASSERT_EQ(RC::RECORD_EOF, rc);
+  ASSERT_EQ(RC::SUCCESS, oper->close());
+
+  // 按照分组创建的顺序输出
+  ASSERT_EQ((vector<int>{101, 10, 11000}), sums);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
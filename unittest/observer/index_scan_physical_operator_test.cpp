@@ -0,0 +1,300 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <filesystem>
+#include <set>
+
+#include "gtest/gtest.h"
+#include "common/global_context.h"
+#include "session/session.h"
+#include "storage/db/db.h"
+#include "storage/default/default_handler.h"
+#include "storage/index/index.h"
+#include "storage/table/table.h"
+#include "storage/trx/trx.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/index_scan_physical_operator.h"
+#include "sql/operator/project_logical_operator.h"
+#include "sql/operator/table_get_logical_operator.h"
+#include "sql/operator/table_scan_physical_operator.h"
+#include "sql/optimizer/physical_plan_generator.h"
+#include "sql/plan_cache/prepared_statement.h"
+
+using namespace std;
+using namespace common;
+
+/**
+ * @brief 覆盖索引扫描直接从索引键中取数据，结果应该与回表的索引扫描、全表扫描完全一样
+ * @details 表 t(a int, b int, c char(8))，索引 idx_a(a) 和 idx_bc(b, c)
+ */
+class IndexScanPhysicalOperatorTest : public ::testing::Test
+{
+protected:
+  using Row = vector<string>;
+
+  void SetUp() override
+  {
+    filesystem::remove_all(test_directory_);
+    GCTX.handler_ = new DefaultHandler();
+    ASSERT_EQ(RC::SUCCESS, GCTX.handler_->init(test_directory_.c_str(), "vacuous", "vacuous", "heap"));
+    db_ = GCTX.handler_->find_db("sys");
+    ASSERT_NE(db_, nullptr);
+
+    vector<AttrInfoSqlNode> attr_infos(3);
+    attr_infos[0].name   = "a";
+    attr_infos[0].type   = AttrType::INTS;
+    attr_infos[0].length = 4;
+    attr_infos[1].name   = "b";
+    attr_infos[1].type   = AttrType::INTS;
+    attr_infos[1].length = 4;
+    attr_infos[2].name   = "c";
+    attr_infos[2].type   = AttrType::CHARS;
+    attr_infos[2].length = 8;
+    ASSERT_EQ(RC::SUCCESS, db_->create_table("t", attr_infos, {}));
+    table_ = db_->find_table("t");
+    ASSERT_NE(table_, nullptr);
+
+    const TableMeta &table_meta = table_->table_meta();
+    ASSERT_EQ(RC::SUCCESS, table_->create_index(nullptr, {table_meta.field("a")}, "idx_a"));
+    ASSERT_EQ(RC::SUCCESS, table_->create_index(nullptr, {table_meta.field("b"), table_meta.field("c")}, "idx_bc"));
+
+    // a 有很多重复的值，c 的长度不同，索引键中的字符串需要补齐
+    trx_ = db_->trx_kit().create_trx(db_->log_handler());
+    for (int i = 0; i < record_num_; i++) {
+      string c = "c" + to_string(i % 37);
+      Value  values[3];
+      values[0].set_int(i % 100);
+      values[1].set_int(record_num_ - i);
+      values[2].set_string(c.c_str());
+      Record record;
+      ASSERT_EQ(RC::SUCCESS, table_->make_record(3, values, record));
+      ASSERT_EQ(RC::SUCCESS, trx_->insert_record(table_, record));
+    }
+  }
+
+  void TearDown() override
+  {
+    db_->trx_kit().destroy_trx(trx_);
+    trx_   = nullptr;
+    table_ = nullptr;
+    db_    = nullptr;
+    GCTX.handler_->destroy();
+    delete GCTX.handler_;
+    GCTX.handler_ = nullptr;
+    filesystem::remove_all(test_directory_);
+  }
+
+  unique_ptr<Expression> field_expr(const char *name) const
+  {
+    return make_unique<FieldExpr>(table_, table_->table_meta().field(name));
+  }
+
+  unique_ptr<Expression> compare(CompOp comp, const char *field_name, const Value &value) const
+  {
+    return make_unique<ComparisonExpr>(comp, field_expr(field_name), make_unique<ValueExpr>(value));
+  }
+
+  /// 读取所有的行，每行按照 fields 的顺序取出字段的值
+  RC collect(PhysicalOperator &oper, const vector<string> &fields, multiset<Row> &rows)
+  {
+    rows.clear();
+    RC rc = RC::SUCCESS;
+    if (OB_FAIL(rc = oper.open(trx_))) {
+      return rc;
+    }
+    while (OB_SUCC(rc = oper.next())) {
+      Row row;
+      for (const string &field : fields) {
+        Value value;
+        if (OB_FAIL(rc = oper.current_tuple()->find_cell(TupleCellSpec(table_->name(), field.c_str()), value))) {
+          return rc;
+        }
+        row.push_back(value.to_string());
+      }
+      rows.insert(row);
+    }
+    if (rc != RC::RECORD_EOF) {
+      return rc;
+    }
+    return oper.close();
+  }
+
+  /// 使用 filters 过滤的全表扫描
+  multiset<Row> table_scan(const vector<string> &fields, vector<unique_ptr<Expression>> filters)
+  {
+    TableScanPhysicalOperator oper(table_, ReadWriteMode::READ_ONLY);
+    oper.set_predicates(std::move(filters));
+
+    multiset<Row> rows;
+    EXPECT_EQ(RC::SUCCESS, collect(oper, fields, rows));
+    return rows;
+  }
+
+  /// 在 index_name 上扫描 [left_key, right_key)，空的边界表示不限制。filters 是剩余的过滤条件
+  multiset<Row> index_scan(const char *index_name, bool index_only, const string &left_key, const string &right_key,
+      const vector<string> &fields, vector<unique_ptr<Expression>> filters)
+  {
+    Index *index = table_->find_index(index_name);
+    EXPECT_NE(index, nullptr);
+    IndexScanPhysicalOperator oper(table_,
+        index,
+        ReadWriteMode::READ_ONLY,
+        left_key.empty() ? nullptr : left_key.data(),
+        static_cast<int>(left_key.size()),
+        true,
+        right_key.empty() ? nullptr : right_key.data(),
+        static_cast<int>(right_key.size()),
+        false);
+    oper.set_predicates(std::move(filters));
+    oper.set_index_only(index_only);
+
+    // 执行两次，确认重新 open 之后仍然正确
+    multiset<Row> rows;
+    EXPECT_EQ(RC::SUCCESS, collect(oper, fields, rows));
+    multiset<Row> rescan_rows;
+    EXPECT_EQ(RC::SUCCESS, collect(oper, fields, rescan_rows));
+    EXPECT_EQ(rows, rescan_rows);
+    return rows;
+  }
+
+  static string int_key(int value) { return string(reinterpret_cast<const char *>(&value), sizeof(value)); }
+
+protected:
+  const string test_directory_ = "index_scan_test";
+  const int    record_num_     = 3000;
+
+  Db    *db_    = nullptr;
+  Table *table_ = nullptr;
+  Trx   *trx_   = nullptr;
+};
+
+TEST_F(IndexScanPhysicalOperatorTest, single_field_index)
+{
+  const vector<string> fields = {"a"};
+
+  auto filters = [&]() {
+    vector<unique_ptr<Expression>> exprs;
+    exprs.emplace_back(compare(GREAT_EQUAL, "a", Value(10)));
+    exprs.emplace_back(compare(LESS_THAN, "a", Value(20)));
+    return exprs;
+  };
+
+  const multiset<Row> expected = table_scan(fields, filters());
+  ASSERT_EQ(static_cast<size_t>(record_num_ / 10), expected.size());
+
+  for (bool index_only : {false, true}) {
+    ASSERT_EQ(expected, index_scan("idx_a", index_only, int_key(10), int_key(20), fields, filters()));
+  }
+}
+
+TEST_F(IndexScanPhysicalOperatorTest, multi_field_index)
+{
+  const vector<string> fields = {"b", "c"};
+
+  // b 上的范围条件转换成扫描区间，c 上的条件在扫描时过滤
+  auto filters = [&]() {
+    vector<unique_ptr<Expression>> exprs;
+    exprs.emplace_back(compare(GREAT_EQUAL, "b", Value(100)));
+    exprs.emplace_back(compare(LESS_THAN, "b", Value(2000)));
+    exprs.emplace_back(compare(EQUAL_TO, "c", Value("c5")));
+    return exprs;
+  };
+
+  const multiset<Row> expected = table_scan(fields, filters());
+  ASSERT_FALSE(expected.empty());
+  for (bool index_only : {false, true}) {
+    ASSERT_EQ(expected, index_scan("idx_bc", index_only, int_key(100), int_key(2000), fields, filters()));
+  }
+
+  // 不限制边界时扫描整个索引
+  const multiset<Row> all_rows = table_scan(fields, {});
+  ASSERT_EQ(static_cast<size_t>(record_num_), all_rows.size());
+  for (bool index_only : {false, true}) {
+    ASSERT_EQ(all_rows, index_scan("idx_bc", index_only, "", "", fields, {}));
+  }
+
+  // 覆盖索引扫描只能取到索引中的字段
+  Index                    *index = table_->find_index("idx_bc");
+  IndexScanPhysicalOperator oper(table_, index, ReadWriteMode::READ_ONLY, nullptr, 0, true, nullptr, 0, true);
+  oper.set_index_only(true);
+  ASSERT_EQ(RC::SUCCESS, oper.open(trx_));
+  ASSERT_EQ(RC::SUCCESS, oper.next());
+  Value value;
+  ASSERT_EQ(RC::NOTFOUND, oper.current_tuple()->find_cell(TupleCellSpec(table_->name(), "a"), value));
+  ASSERT_EQ(RC::SUCCESS, oper.close());
+}
+
+TEST_F(IndexScanPhysicalOperatorTest, plan_index_only)
+{
+  Session session;
+  session.set_current_db("sys");
+
+  // select <fields> from t where b >= 100 and b < 2000
+  auto create_plan = [&](const vector<string> &fields, unique_ptr<PhysicalOperator> &physical_oper) {
+    auto table_get_oper = make_unique<TableGetLogicalOperator>(table_, ReadWriteMode::READ_ONLY);
+    vector<unique_ptr<Expression>> predicates;
+    predicates.emplace_back(compare(GREAT_EQUAL, "b", Value(100)));
+    predicates.emplace_back(compare(LESS_THAN, "b", Value(2000)));
+    table_get_oper->set_predicates(std::move(predicates));
+
+    vector<unique_ptr<Expression>> expressions;
+    for (const string &field : fields) {
+      expressions.emplace_back(field_expr(field.c_str()));
+    }
+    ProjectLogicalOperator project_oper(std::move(expressions));
+    project_oper.add_child(std::move(table_get_oper));
+
+    PhysicalPlanGenerator generator;
+    return generator.create(project_oper, physical_oper, &session);
+  };
+
+  auto filters = [&]() {
+    vector<unique_ptr<Expression>> exprs;
+    exprs.emplace_back(compare(GREAT_EQUAL, "b", Value(100)));
+    exprs.emplace_back(compare(LESS_THAN, "b", Value(2000)));
+    return exprs;
+  };
+
+  // 投影的列都在 idx_bc 中时使用覆盖索引扫描，否则回表
+  for (const vector<string> &fields : {vector<string>{"c", "b"}, vector<string>{"b", "a"}}) {
+    const bool index_only = fields.back() != "a";
+
+    unique_ptr<PhysicalOperator> physical_oper;
+    ASSERT_EQ(RC::SUCCESS, create_plan(fields, physical_oper));
+    ASSERT_EQ(PhysicalOperatorType::PROJECT, physical_oper->type());
+    PhysicalOperator *scan_oper = physical_oper->children().front().get();
+    ASSERT_EQ(PhysicalOperatorType::INDEX_SCAN, scan_oper->type());
+    ASSERT_EQ(index_only, scan_oper->param().find("INDEX ONLY") != string::npos);
+
+    multiset<Row> rows;
+    ASSERT_EQ(RC::SUCCESS, physical_oper->open(trx_));
+    RC rc = RC::SUCCESS;
+    while (OB_SUCC(rc = physical_oper->next())) {
+      Row row;
+      for (int i = 0; i < static_cast<int>(fields.size()); i++) {
+        Value value;
+        ASSERT_EQ(RC::SUCCESS, physical_oper->current_tuple()->cell_at(i, value));
+        row.push_back(value.to_string());
+      }
+      rows.insert(row);
+    }
+    ASSERT_EQ(RC::RECORD_EOF, rc);
+    ASSERT_EQ(RC::SUCCESS, physical_oper->close());
+
+    ASSERT_EQ(static_cast<size_t>(1900), rows.size());
+    ASSERT_EQ(table_scan(fields, filters()), rows);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
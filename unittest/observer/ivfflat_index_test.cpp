@@ -0,0 +1,273 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "common/lang/algorithm.h"
+#include "common/lang/filesystem.h"
+#include "common/lang/memory.h"
+#include "common/log/log.h"
+#include "common/type/vector_distance.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/buffer/double_write_buffer.h"
+#include "storage/clog/vacuous_log_handler.h"
+#include "storage/index/ivfflat_index.h"
+#include "storage/record/record_scanner.h"
+#include "gtest/gtest.h"
+
+using namespace common;
+
+static constexpr int DIM = 4;
+
+/**
+ * @brief 从内存中的向量列表返回记录，用来训练索引
+ */
+class VectorRecordScanner : public RecordScanner
+{
+public:
+  VectorRecordScanner(vector<vector<float>> &vectors) : vectors_(vectors) {}
+
+  RC open_scan() override
+  {
+    pos_ = 0;
+    return RC::SUCCESS;
+  }
+  RC close_scan() override { return RC::SUCCESS; }
+
+  RC next(Record &record) override
+  {
+    if (pos_ >= vectors_.size()) {
+      return RC::RECORD_EOF;
+    }
+    record.set_data(reinterpret_cast<char *>(vectors_[pos_].data()), DIM * sizeof(float));
+    record.set_rid(static_cast<PageNum>(pos_), 0);
+    pos_++;
+    return RC::SUCCESS;
+  }
+
+private:
+  vector<vector<float>> &vectors_;
+  size_t                 pos_ = 0;
+};
+
+/// 4个簇，第 i 个簇的中心在 (10*i, 10*i, 10*i, 10*i) 附近，向量各不相同，向量的下标就是 RID 中的页号
+static vector<vector<float>> make_vectors(int num)
+{
+  vector<vector<float>> vectors;
+  for (int i = 0; i < num; i++) {
+    float base = static_cast<float>(i % 4) * 10;
+    float bias = static_cast<float>(i / 4) / 500;
+    vectors.push_back({base + bias, base - bias, base + bias / 2, base});
+  }
+  return vectors;
+}
+
+/// 暴力计算最近的 limit 个向量
+static vector<int> brute_force(
+    const vector<vector<float>> &vectors, const vector<float> &query, VectorDistanceType type, size_t limit)
+{
+  vector<pair<float, int>> distances;
+  for (size_t i = 0; i < vectors.size(); i++) {
+    float distance = vector_distance(type, vectors[i].data(), query.data(), DIM);
+    distances.emplace_back(vector_distance_ascending(type) ? distance : -distance, static_cast<int>(i));
+  }
+  sort(distances.begin(), distances.end());
+  vector<int> result;
+  for (size_t i = 0; i < limit && i < distances.size(); i++) {
+    result.push_back(distances[i].second);
+  }
+  return result;
+}
+
+static vector<int> to_ids(const vector<RID> &rids)
+{
+  vector<int> ids;
+  for (const RID &rid : rids) {
+    ids.push_back(rid.page_num);
+  }
+  return ids;
+}
+
+TEST(test_ivfflat_index, vector_distance)
+{
+  float zero[DIM]  = {0, 0, 0, 0};
+  float left[DIM]  = {3, 4, 0, 0};
+  float right[DIM] = {0, 0, 1, 2};
+
+  ASSERT_FLOAT_EQ(5, vector_distance(VectorDistanceType::L2, left, zero, DIM));
+  ASSERT_FLOAT_EQ(1, vector_distance(VectorDistanceType::COSINE, left, right, DIM));
+  ASSERT_FLOAT_EQ(0, vector_distance(VectorDistanceType::COSINE, left, left, DIM));
+  ASSERT_FLOAT_EQ(1, vector_distance(VectorDistanceType::COSINE, left, zero, DIM));
+  ASSERT_FLOAT_EQ(25, vector_distance(VectorDistanceType::INNER_PRODUCT, left, left, DIM));
+
+  // 长度不是8的倍数时，SIMD 版本需要处理剩下的部分
+  vector<float> a(13), b(13);
+  float         expect = 0;
+  for (int i = 0; i < 13; i++) {
+    a[i] = static_cast<float>(i);
+    b[i] = static_cast<float>(13 - i);
+    expect += a[i] * b[i];
+  }
+  ASSERT_FLOAT_EQ(expect, vector_distance(VectorDistanceType::INNER_PRODUCT, a.data(), b.data(), 13));
+
+  VectorDistanceType type;
+  ASSERT_EQ(RC::SUCCESS, vector_distance_type_from_string("cosine_distance", type));
+  ASSERT_EQ(VectorDistanceType::COSINE, type);
+  ASSERT_NE(RC::SUCCESS, vector_distance_type_from_string("manhattan", type));
+}
+
+TEST(test_ivfflat_index, search)
+{
+  LoggerFactory::init_default("test_ivfflat_index.log");
+
+  filesystem::path test_directory("ivfflat_index");
+  filesystem::path index_file = test_directory / "search.ivf";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  FieldMeta         field_meta("v", AttrType::VECTORS, 0, DIM * sizeof(float), true, 0);
+  vector<FieldMeta> field_metas{field_meta};
+  IndexMeta         index_meta;
+  ASSERT_EQ(RC::SUCCESS, index_meta.init("vi", {&field_meta}));
+  index_meta.set_ivfflat_options(IvfflatOptions{VectorDistanceType::L2, 4, 4});
+
+  // 数据足够多，每个链表都需要多个页面
+  vector<vector<float>> vectors = make_vectors(2000);
+  const vector<float>   query{21, 19, 20.5, 20};
+
+  VacuousLogHandler log_handler;
+  {
+    BufferPoolManager bpm;
+    ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+
+    IvfflatIndex index;
+    ASSERT_EQ(RC::SUCCESS, index.create(log_handler, bpm, index_file.c_str(), index_meta, field_metas));
+
+    VectorRecordScanner scanner(vectors);
+    ASSERT_EQ(RC::SUCCESS, scanner.open_scan());
+    ASSERT_EQ(RC::SUCCESS, index.train(scanner));
+    ASSERT_EQ(4, index.lists());
+    ASSERT_NE(RC::SUCCESS, index.train(scanner));
+
+    for (size_t i = 0; i < vectors.size(); i++) {
+      RID rid(static_cast<PageNum>(i), 0);
+      ASSERT_EQ(RC::SUCCESS, index.insert_entry(reinterpret_cast<const char *>(vectors[i].data()), &rid));
+    }
+
+    // 扫描所有链表时结果是精确的
+    vector<RID> rids;
+    ASSERT_EQ(RC::SUCCESS, index.ann_search(query, 10, rids));
+    ASSERT_EQ(brute_force(vectors, query, VectorDistanceType::L2, 10), to_ids(rids));
+
+    // 删除最近的几个向量后，它们不会再出现在结果中
+    for (int id : to_ids(rids)) {
+      if (id % 2 == 0) {
+        RID rid(id, 0);
+        ASSERT_EQ(RC::SUCCESS, index.delete_entry(reinterpret_cast<const char *>(vectors[id].data()), &rid));
+      }
+    }
+    RID missing(0, 1);
+    ASSERT_EQ(RC::RECORD_INVALID_KEY, index.delete_entry(reinterpret_cast<const char *>(vectors[0].data()), &missing));
+
+    vector<vector<float>> remaining;
+    vector<int>           remaining_ids;
+    for (size_t i = 0; i < vectors.size(); i++) {
+      if (find(rids.begin(), rids.end(), RID(static_cast<PageNum>(i), 0)) == rids.end() || i % 2 != 0) {
+        remaining.push_back(vectors[i]);
+        remaining_ids.push_back(static_cast<int>(i));
+      }
+    }
+    vector<int> expect;
+    for (int pos : brute_force(remaining, query, VectorDistanceType::L2, 10)) {
+      expect.push_back(remaining_ids[pos]);
+    }
+
+    rids.clear();
+    ASSERT_EQ(RC::SUCCESS, index.ann_search(query, 10, rids));
+    ASSERT_EQ(expect, to_ids(rids));
+
+    ASSERT_EQ(RC::SUCCESS, index.sync());
+    ASSERT_EQ(RC::SUCCESS, index.close());
+
+    // 重新打开后聚类中心和链表都还在
+    IvfflatIndex reopened;
+    ASSERT_EQ(RC::SUCCESS, reopened.open(log_handler, bpm, index_file.c_str(), index_meta, field_metas));
+    ASSERT_EQ(4, reopened.lists());
+
+    rids.clear();
+    ASSERT_EQ(RC::SUCCESS, reopened.ann_search(query, 10, rids));
+    ASSERT_EQ(expect, to_ids(rids));
+    ASSERT_EQ(RC::SUCCESS, reopened.close());
+  }
+
+  // 只扫描一个链表时，结果都来自离查询向量最近的簇
+  index_meta.set_ivfflat_options(IvfflatOptions{VectorDistanceType::L2, 4, 1});
+  filesystem::path probe_file = test_directory / "probe.ivf";
+  {
+    BufferPoolManager bpm;
+    ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+
+    IvfflatIndex index;
+    ASSERT_EQ(RC::SUCCESS, index.create(log_handler, bpm, probe_file.c_str(), index_meta, field_metas));
+    VectorRecordScanner scanner(vectors);
+    ASSERT_EQ(RC::SUCCESS, index.train(scanner));
+    for (size_t i = 0; i < vectors.size(); i++) {
+      RID rid(static_cast<PageNum>(i), 0);
+      ASSERT_EQ(RC::SUCCESS, index.insert_entry(reinterpret_cast<const char *>(vectors[i].data()), &rid));
+    }
+
+    vector<RID> rids;
+    ASSERT_EQ(RC::SUCCESS, index.ann_search(query, 1000, rids));
+    ASSERT_EQ(500UL, rids.size());
+    for (int id : to_ids(rids)) {
+      ASSERT_EQ(2, id % 4);
+    }
+    ASSERT_EQ(RC::SUCCESS, index.close());
+  }
+}
+
+TEST(test_ivfflat_index, empty)
+{
+  filesystem::path test_directory("ivfflat_index");
+  filesystem::path index_file = test_directory / "empty.ivf";
+  filesystem::create_directories(test_directory);
+  filesystem::remove(index_file);
+
+  FieldMeta         field_meta("v", AttrType::VECTORS, 0, DIM * sizeof(float), true, 0);
+  vector<FieldMeta> field_metas{field_meta};
+  IndexMeta         index_meta;
+  ASSERT_EQ(RC::SUCCESS, index_meta.init("vi", {&field_meta}));
+  index_meta.set_ivfflat_options(IvfflatOptions{VectorDistanceType::INNER_PRODUCT, 8, 2});
+
+  VacuousLogHandler log_handler;
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+
+  // 没有数据时只有一个链表，之后插入的数据都放到这个链表中
+  IvfflatIndex          index;
+  vector<vector<float>> no_vectors;
+  VectorRecordScanner   scanner(no_vectors);
+  ASSERT_EQ(RC::SUCCESS, index.create(log_handler, bpm, index_file.c_str(), index_meta, field_metas));
+  ASSERT_EQ(RC::SUCCESS, index.train(scanner));
+  ASSERT_EQ(1, index.lists());
+
+  vector<RID> rids;
+  ASSERT_EQ(RC::SUCCESS, index.ann_search({1, 1, 1, 1}, 3, rids));
+  ASSERT_TRUE(rids.empty());
+
+  vector<vector<float>> vectors = make_vectors(10);
+  for (size_t i = 0; i < vectors.size(); i++) {
+    RID rid(static_cast<PageNum>(i), 0);
+    ASSERT_EQ(RC::SUCCESS, index.insert_entry(reinterpret_cast<const char *>(vectors[i].data()), &rid));
+  }
+
+  // 内积越大越近
+  ASSERT_EQ(RC::SUCCESS, index.ann_search({1, 1, 1, 1}, 3, rids));
+  ASSERT_EQ(brute_force(vectors, {1, 1, 1, 1}, VectorDistanceType::INNER_PRODUCT, 3), to_ids(rids));
+  ASSERT_EQ(RC::SUCCESS, index.close());
+}
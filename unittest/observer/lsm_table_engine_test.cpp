@@ -0,0 +1,330 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <filesystem>
+
+#include "gtest/gtest.h"
+#include "storage/db/db.h"
+#include "storage/table/table.h"
+#include "storage/record/record.h"
+#include "storage/record/record_manager.h"
+#include "storage/record/record_scanner.h"
+#include "storage/common/chunk.h"
+#include "storage/trx/trx.h"
+#include "storage/index/index.h"
+
+using namespace std;
+using namespace common;
+
+class LsmTableEngineTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    filesystem::remove_all(test_directory_);
+    filesystem::create_directories(db_path_);
+    open_db();
+
+    vector<AttrInfoSqlNode> attr_infos;
+    for (int i = 0; i < field_num_; i++) {
+      AttrInfoSqlNode attr_info;
+      attr_info.name   = string("field_") + to_string(i);
+      attr_info.type   = AttrType::INTS;
+      attr_info.length = 4;
+      attr_infos.push_back(attr_info);
+    }
+    ASSERT_EQ(RC::SUCCESS, db_->create_table("lsm_table", attr_infos, {}));
+    table_ = db_->find_table("lsm_table");
+    ASSERT_NE(table_, nullptr);
+  }
+
+  void TearDown() override
+  {
+    db_.reset();
+    filesystem::remove_all(test_directory_);
+  }
+
+  void open_db()
+  {
+    db_ = make_unique<Db>();
+    ASSERT_EQ(RC::SUCCESS, db_->init("lsm_db", db_path_.c_str(), "lsm", "vacuous", "lsm"));
+  }
+
+  void make_record(int v, Record &record)
+  {
+    vector<Value> values(field_num_);
+    for (int i = 0; i < field_num_; i++) {
+      values[i].set_int(v + i);
+    }
+    ASSERT_EQ(RC::SUCCESS, table_->make_record(values.size(), values.data(), record));
+  }
+
+  /// 扫描整张表，返回第一个字段的所有值
+  vector<int> scan(Trx *trx)
+  {
+    vector<int>    result;
+    RecordScanner *scanner = nullptr;
+    EXPECT_EQ(RC::SUCCESS, table_->get_record_scanner(scanner, trx, ReadWriteMode::READ_ONLY));
+    Record record;
+    while (scanner->next(record) == RC::SUCCESS) {
+      int v;
+      memcpy(&v, record.data() + table_->table_meta().field(0)->offset(), sizeof(v));
+      result.push_back(v);
+    }
+    scanner->close_scan();
+    delete scanner;
+    return result;
+  }
+
+  /// 通过索引扫描 [left, right]，返回第一个字段的所有值。trx 不为空时在事务中扫描
+  vector<int> index_scan(Index *index, const Value *left, bool left_inclusive, const Value *right, bool right_inclusive,
+      Trx *trx = nullptr)
+  {
+    vector<int>   result;
+    IndexScanner *scanner = index->create_scanner_with_trx(trx,
+        left == nullptr ? nullptr : left->data(),
+        left == nullptr ? 0 : left->length(),
+        left_inclusive,
+        right == nullptr ? nullptr : right->data(),
+        right == nullptr ? 0 : right->length(),
+        right_inclusive);
+    EXPECT_NE(scanner, nullptr);
+    RID rid;
+    while (scanner->next_entry(&rid) == RC::SUCCESS) {
+      Record record;
+      EXPECT_EQ(RC::SUCCESS, table_->get_record_with_trx(rid, record, trx));
+      int v;
+      memcpy(&v, record.data() + table_->table_meta().field(0)->offset(), sizeof(v));
+      result.push_back(v);
+    }
+    scanner->destroy();
+    return result;
+  }
+
+  const int        field_num_ = 3;
+  filesystem::path test_directory_{"lsm_table_engine_test"};
+  filesystem::path db_path_ = test_directory_ / "lsm_db";
+  unique_ptr<Db>   db_;
+  Table           *table_ = nullptr;
+};
+
+TEST_F(LsmTableEngineTest, trx_insert_delete_update)
+{
+  TrxKit &trx_kit = db_->trx_kit();
+  Trx    *trx     = trx_kit.create_trx(db_->log_handler());
+  ASSERT_EQ(RC::SUCCESS, trx->start_if_need());
+
+  vector<Record> records(10);
+  for (int i = 0; i < 10; i++) {
+    make_record(i, records[i]);
+    ASSERT_EQ(RC::SUCCESS, trx->insert_record(table_, records[i]));
+  }
+
+  // the uncommitted changes are visible in the transaction only
+  Trx *other = trx_kit.create_trx(db_->log_handler());
+  ASSERT_EQ(RC::SUCCESS, other->start_if_need());
+  ASSERT_EQ(scan(trx).size(), 10UL);
+  ASSERT_EQ(scan(other).size(), 0UL);
+  ASSERT_EQ(RC::SUCCESS, other->rollback());
+
+  ASSERT_EQ(RC::SUCCESS, trx->delete_record(table_, records[3]));
+  Record new_record;
+  make_record(100, new_record);
+  ASSERT_EQ(RC::SUCCESS, trx->update_record(table_, records[5], new_record));
+  ASSERT_EQ(RC::SUCCESS, trx->commit());
+
+  vector<int> expected{0, 1, 2, 4, 100, 6, 7, 8, 9};
+  ASSERT_EQ(scan(trx), expected);
+
+  // get record by rid
+  Record record;
+  ASSERT_EQ(RC::SUCCESS, table_->get_record(records[7].rid(), record));
+  ASSERT_EQ(0, memcmp(record.data(), records[7].data(), records[7].len()));
+  ASSERT_NE(RC::SUCCESS, table_->get_record(records[3].rid(), record));
+
+  trx_kit.destroy_trx(trx);
+  trx_kit.destroy_trx(other);
+}
+
+TEST_F(LsmTableEngineTest, chunk_insert_and_scan)
+{
+  const int count = 3000;
+  Chunk     input;
+  for (int i = 0; i < table_->table_meta().field_num(); i++) {
+    const FieldMeta *field = table_->table_meta().field(i);
+    input.add_column(make_unique<Column>(*field, count), field->field_id());
+  }
+  for (int row = 0; row < count; row++) {
+    for (int i = 0; i < input.column_num(); i++) {
+      int v = row * 10 + i;
+      ASSERT_EQ(RC::SUCCESS, input.column(i).append_one(reinterpret_cast<char *>(&v)));
+    }
+  }
+  ASSERT_EQ(RC::SUCCESS, table_->insert_chunk(input));
+
+  Trx *trx = db_->trx_kit().create_trx(db_->log_handler());
+  ASSERT_EQ(RC::SUCCESS, trx->start_if_need());
+
+  ChunkFileScanner scanner;
+  ASSERT_EQ(RC::SUCCESS, table_->get_chunk_scanner(scanner, trx, ReadWriteMode::READ_ONLY));
+  Chunk output;
+  for (int i = 0; i < table_->table_meta().field_num(); i++) {
+    const FieldMeta *field = table_->table_meta().field(i);
+    output.add_column(make_unique<Column>(*field), field->field_id());
+  }
+  int rows = 0;
+  while (scanner.next_chunk(output) == RC::SUCCESS) {
+    ASSERT_LE(output.rows(), output.capacity());
+    for (int row = 0; row < output.rows(); row++, rows++) {
+      for (int i = 0; i < output.column_num(); i++) {
+        ASSERT_EQ(output.get_value(i, row).get_int(), rows * 10 + i);
+      }
+    }
+    output.reset_data();
+  }
+  ASSERT_EQ(rows, count);
+  scanner.close_scan();
+  db_->trx_kit().destroy_trx(trx);
+}
+
+TEST_F(LsmTableEngineTest, reopen)
+{
+  for (int i = 0; i < 5; i++) {
+    Record record;
+    make_record(i, record);
+    ASSERT_EQ(RC::SUCCESS, table_->insert_record(record));
+  }
+
+  db_.reset();
+  open_db();
+  table_ = db_->find_table("lsm_table");
+  ASSERT_NE(table_, nullptr);
+
+  // the row id must not be reused after reopen
+  Record record;
+  make_record(5, record);
+  ASSERT_EQ(RC::SUCCESS, table_->insert_record(record));
+  vector<int> expected{0, 1, 2, 3, 4, 5};
+  ASSERT_EQ(scan(nullptr), expected);
+}
+
+TEST_F(LsmTableEngineTest, secondary_index)
+{
+  // the rows inserted before the index is created are indexed while creating it
+  vector<Record> records(10);
+  for (int i = 0; i < 5; i++) {
+    make_record(i * 10, records[i]);
+    ASSERT_EQ(RC::SUCCESS, table_->insert_record(records[i]));
+  }
+
+  const FieldMeta *field = table_->table_meta().field("field_1");
+  ASSERT_EQ(RC::SUCCESS, table_->create_index(nullptr, {field}, "idx_field_1"));
+  Index *index = table_->find_index_by_field("field_1");
+  ASSERT_NE(index, nullptr);
+
+  Trx *trx = db_->trx_kit().create_trx(db_->log_handler());
+  ASSERT_EQ(RC::SUCCESS, trx->start_if_need());
+  for (int i = 5; i < 10; i++) {
+    make_record(i * 10, records[i]);
+    ASSERT_EQ(RC::SUCCESS, trx->insert_record(table_, records[i]));
+  }
+  ASSERT_EQ(RC::SUCCESS, trx->commit());
+
+  // field_1 = field_0 + 1
+  Value v31(31), v61(61), v62(62);
+  ASSERT_EQ(index_scan(index, &v31, true, &v31, true), vector<int>{30});
+  ASSERT_EQ(index_scan(index, &v31, true, &v61, true), (vector<int>{30, 40, 50, 60}));
+  ASSERT_EQ(index_scan(index, &v31, false, &v61, false), (vector<int>{40, 50}));
+  ASSERT_EQ(index_scan(index, &v62, true, nullptr, true), (vector<int>{70, 80, 90}));
+  ASSERT_EQ(index_scan(index, nullptr, true, &v31, false), (vector<int>{0, 10, 20}));
+
+  // the index entries share the key space with the rows but are not returned by a full table scan
+  ASSERT_EQ(scan(nullptr), (vector<int>{0, 10, 20, 30, 40, 50, 60, 70, 80, 90}));
+
+  // the index entries are maintained together with the rows
+  ASSERT_EQ(RC::SUCCESS, trx->start_if_need());
+  ASSERT_EQ(RC::SUCCESS, trx->delete_record(table_, records[3]));
+  Record new_record;
+  make_record(5, new_record);
+  ASSERT_EQ(RC::SUCCESS, trx->update_record(table_, records[9], new_record));
+  ASSERT_EQ(RC::SUCCESS, trx->commit());
+  ASSERT_EQ(index_scan(index, nullptr, true, &v31, true), (vector<int>{0, 5, 10, 20}));
+  ASSERT_EQ(index_scan(index, &v61, true, nullptr, true), (vector<int>{60, 70, 80}));
+
+  // delete the rows found by a full table scan, as DELETE does
+  ASSERT_EQ(RC::SUCCESS, trx->start_if_need());
+  RecordScanner *scanner = nullptr;
+  ASSERT_EQ(RC::SUCCESS, table_->get_record_scanner(scanner, trx, ReadWriteMode::READ_WRITE));
+  vector<Record> deleted;
+  Record         record;
+  while (scanner->next(record) == RC::SUCCESS) {
+    int v;
+    memcpy(&v, record.data() + table_->table_meta().field(0)->offset(), sizeof(v));
+    if (v == 30 || v == 5) {
+      deleted.push_back(record);
+    }
+  }
+  scanner->close_scan();
+  delete scanner;
+  ASSERT_EQ(deleted.size(), 1);
+  for (Record &r : deleted) {
+    ASSERT_EQ(RC::SUCCESS, trx->delete_record(table_, r));
+  }
+  ASSERT_EQ(RC::SUCCESS, trx->commit());
+  ASSERT_EQ(scan(nullptr), (vector<int>{0, 10, 20, 40, 50, 60, 70, 80}));
+  ASSERT_EQ(index_scan(index, nullptr, true, nullptr, true), (vector<int>{0, 10, 20, 40, 50, 60, 70, 80}));
+  db_->trx_kit().destroy_trx(trx);
+
+  // the index is still there after reopen
+  db_.reset();
+  open_db();
+  table_ = db_->find_table("lsm_table");
+  ASSERT_NE(table_, nullptr);
+  index = table_->find_index("idx_field_1");
+  ASSERT_NE(index, nullptr);
+  ASSERT_EQ(index_scan(index, nullptr, true, nullptr, true), (vector<int>{0, 10, 20, 40, 50, 60, 70, 80}));
+  ASSERT_EQ(scan(nullptr), (vector<int>{0, 10, 20, 40, 50, 60, 70, 80}));
+}
+
+TEST_F(LsmTableEngineTest, index_scan_in_trx)
+{
+  const FieldMeta *field = table_->table_meta().field("field_1");
+  ASSERT_EQ(RC::SUCCESS, table_->create_index(nullptr, {field}, "idx_field_1"));
+  Index *index = table_->find_index_by_field("field_1");
+  ASSERT_NE(index, nullptr);
+
+  vector<Record> records(5);
+  for (int i = 0; i < 3; i++) {
+    make_record(i * 10, records[i]);
+    ASSERT_EQ(RC::SUCCESS, table_->insert_record(records[i]));
+  }
+
+  Trx *trx = db_->trx_kit().create_trx(db_->log_handler());
+  ASSERT_EQ(RC::SUCCESS, trx->start_if_need());
+  for (int i = 3; i < 5; i++) {
+    make_record(i * 10, records[i]);
+    ASSERT_EQ(RC::SUCCESS, trx->insert_record(table_, records[i]));
+  }
+  ASSERT_EQ(RC::SUCCESS, trx->delete_record(table_, records[1]));
+
+  // the transaction sees its own uncommitted index entries and rows, others do not
+  ASSERT_EQ(index_scan(index, nullptr, true, nullptr, true, trx), (vector<int>{0, 20, 30, 40}));
+  ASSERT_EQ(index_scan(index, nullptr, true, nullptr, true), (vector<int>{0, 10, 20}));
+
+  Record record;
+  ASSERT_EQ(RC::SUCCESS, table_->get_record_with_trx(records[4].rid(), record, trx));
+  ASSERT_EQ(0, memcmp(record.data(), records[4].data(), records[4].len()));
+  ASSERT_NE(RC::SUCCESS, table_->get_record_with_trx(records[1].rid(), record, trx));
+  ASSERT_NE(RC::SUCCESS, table_->get_record(records[4].rid(), record));
+
+  ASSERT_EQ(RC::SUCCESS, trx->commit());
+  ASSERT_EQ(index_scan(index, nullptr, true, nullptr, true), (vector<int>{0, 20, 30, 40}));
+  db_->trx_kit().destroy_trx(trx);
+}
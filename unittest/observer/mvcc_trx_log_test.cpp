@@ -16,6 +16,7 @@ See the Mulan PSL v2 for more details. */
 #include <filesystem>
 #include <memory>
 #include <vector>
+#include <set>
 #include <string>
 
 #define private public
@@ -729,6 +730,115 @@ TEST(MvccTrxLog, wal_rollback_abnormal)
   db.reset();
 }
 
+TEST(MvccTrxLog, pax_compressed)
+{
+  /*
+  压缩的 PAX 表中，事务提交和删除时需要修改已经编码保存的记录中的事务字段。
+  一个事务中插入很多数据让页面多次重新编码，提交、删除之后检查可见的数据，再通过日志恢复后检查一次。
+  */
+  filesystem::path test_directory("mvcc_trx_log_test");
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  const char      *dbname           = "test_db";
+  const char      *dbname2          = "test_db2";
+  filesystem::path db_path          = test_directory / dbname;
+  filesystem::path db_path2         = test_directory / dbname2;
+  const char      *trx_kit_name     = "mvcc";
+  const char      *log_handler_name = "disk";
+  const char      *table_name       = "t";
+
+  filesystem::create_directories(db_path);
+  filesystem::create_directories(db_path2);
+
+  auto db = make_unique<Db>();
+  ASSERT_EQ(RC::SUCCESS, db->init(dbname, db_path.c_str(), trx_kit_name, log_handler_name));
+
+  vector<AttrInfoSqlNode> attr_infos(1);
+  attr_infos[0].name   = "id";
+  attr_infos[0].type   = AttrType::INTS;
+  attr_infos[0].length = 4;
+  ASSERT_EQ(RC::SUCCESS, db->create_table(table_name, attr_infos, {}, StorageFormat::PAX_COMPRESSED_FORMAT));
+  ASSERT_EQ(RC::SUCCESS, db->sync());
+
+  // 返回新的事务能看到的记录中 id 的值
+  auto visible_ids = [table_name](Db &db, vector<Record> *records) {
+    Table *table = db.find_table(table_name);
+    EXPECT_NE(table, nullptr);
+    Trx *trx = db.trx_kit().create_trx(db.log_handler());
+    trx->start_if_need();
+
+    const FieldMeta *field = table->table_meta().field("id");
+    set<int>         ids;
+    RecordScanner   *scanner = nullptr;
+    EXPECT_EQ(RC::SUCCESS, table->get_record_scanner(scanner, nullptr, ReadWriteMode::READ_ONLY));
+    Record record;
+    while (OB_SUCC(scanner->next(record))) {
+      if (OB_SUCC(trx->visit_record(table, record, ReadWriteMode::READ_ONLY))) {
+        int id = 0;
+        memcpy(&id, record.data() + field->offset(), sizeof(id));
+        ids.insert(id);
+        if (records != nullptr) {
+          records->push_back(record);
+        }
+      }
+    }
+    delete scanner;
+    db.trx_kit().destroy_trx(trx);
+    return ids;
+  };
+
+  Table *table = db->find_table(table_name);
+  ASSERT_NE(table, nullptr);
+
+  const int insert_num = 3000;
+  Trx      *trx        = db->trx_kit().create_trx(db->log_handler());
+  trx->start_if_need();
+  for (int i = 0; i < insert_num; i++) {
+    Value  value(i);
+    Record record;
+    ASSERT_EQ(RC::SUCCESS, table->make_record(1, &value, record));
+    ASSERT_EQ(RC::SUCCESS, trx->insert_record(table, record));
+  }
+  ASSERT_EQ(RC::SUCCESS, trx->commit());
+  db->trx_kit().destroy_trx(trx);
+
+  vector<Record> records;
+  ASSERT_EQ(static_cast<size_t>(insert_num), visible_ids(*db, &records).size());
+
+  DiskLogHandler &log_handler = static_cast<DiskLogHandler &>(db->log_handler());
+  LSN             current_lsn = log_handler.current_lsn();
+  ASSERT_EQ(RC::SUCCESS, log_handler.wait_lsn(current_lsn));
+
+  // copy all files from db to db2
+  filesystem::copy(db_path, db_path2, filesystem::copy_options::recursive);
+
+  auto db2 = make_unique<Db>();
+  ASSERT_EQ(RC::SUCCESS, db2->init(dbname2, db_path2.c_str(), trx_kit_name, log_handler_name));
+  ASSERT_EQ(visible_ids(*db, nullptr), visible_ids(*db2, nullptr));
+  db2.reset();
+
+  // 删除 id 是 3 的倍数的记录
+  set<int> expected_ids;
+  trx = db->trx_kit().create_trx(db->log_handler());
+  trx->start_if_need();
+  const int id_offset = table->table_meta().field("id")->offset();
+  for (Record &record : records) {
+    int id = 0;
+    memcpy(&id, record.data() + id_offset, sizeof(id));
+    if (id % 3 == 0) {
+      ASSERT_EQ(RC::SUCCESS, trx->delete_record(table, record));
+    } else {
+      expected_ids.insert(id);
+    }
+  }
+  ASSERT_EQ(RC::SUCCESS, trx->commit());
+  db->trx_kit().destroy_trx(trx);
+  ASSERT_EQ(expected_ids, visible_ids(*db, nullptr));
+
+  db.reset();
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,525 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <filesystem>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+#include "common/global_context.h"
+#include "common/type/date_type.h"
+#include "common/value.h"
+#include "net/mysql_communicator.h"
+#include "net/sql_task_handler.h"
+#include "session/session.h"
+#include "sql/plan_cache/prepared_statement.h"
+#include "storage/default/default_handler.h"
+
+using namespace std;
+using namespace common;
+
+namespace {
+
+/// 按照小端序追加整数
+template <typename T>
+void append_int(vector<char> &packet, T value)
+{
+  const char *data = reinterpret_cast<const char *>(&value);
+  packet.insert(packet.end(), data, data + sizeof(T));
+}
+
+void append_lenenc_string(vector<char> &packet, const string &value)
+{
+  packet.push_back(static_cast<char>(value.size()));
+  packet.insert(packet.end(), value.begin(), value.end());
+}
+
+RC decode(const vector<char> &packet, uint16_t type, Value &value)
+{
+  PacketReader reader(packet, 0);
+  return decode_binary_param(reader, type, value);
+}
+
+}  // namespace
+
+TEST(PacketReader, fetch)
+{
+  vector<char> packet;
+  append_int<int8_t>(packet, -1);
+  append_int<uint16_t>(packet, 0x1234);
+  append_int<int32_t>(packet, 123456789);
+  PacketReader reader(packet, 0);
+
+  int8_t   v1 = 0;
+  uint16_t v2 = 0;
+  int32_t  v4 = 0;
+  ASSERT_EQ(RC::SUCCESS, reader.fetch_int(v1));
+  ASSERT_EQ(RC::SUCCESS, reader.fetch_int(v2));
+  ASSERT_EQ(RC::SUCCESS, reader.fetch_int(v4));
+  ASSERT_EQ(-1, v1);
+  ASSERT_EQ(0x1234, v2);
+  ASSERT_EQ(123456789, v4);
+
+  // 读到包的末尾之后都返回错误
+  const char *data = nullptr;
+  ASSERT_EQ(RC::INVALID_ARGUMENT, reader.fetch_int(v1));
+  ASSERT_EQ(RC::INVALID_ARGUMENT, reader.fetch_fix_length(1, data));
+  ASSERT_EQ(RC::SUCCESS, reader.fetch_fix_length(0, data));
+  ASSERT_EQ(RC::INVALID_ARGUMENT, reader.fetch_fix_length(-1, data));
+
+  // 剩余的数据不够一个整数时不移动读取的位置
+  PacketReader short_reader(packet, 5);
+  ASSERT_EQ(RC::INVALID_ARGUMENT, short_reader.fetch_int(v4));
+  ASSERT_EQ(RC::SUCCESS, short_reader.fetch_int(v2));
+  ASSERT_EQ(static_cast<uint16_t>(123456789 >> 16), v2);
+}
+
+TEST(PacketReader, lenenc)
+{
+  struct Case
+  {
+    vector<unsigned char> bytes;
+    RC                    rc;
+    uint64_t              value;
+  };
+  const vector<Case> cases = {
+      {{0x00}, RC::SUCCESS, 0},
+      {{0xFA}, RC::SUCCESS, 250},
+      {{0xFC, 0x34, 0x12}, RC::SUCCESS, 0x1234},
+      {{0xFD, 0x56, 0x34, 0x12}, RC::SUCCESS, 0x123456},
+      {{0xFE, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08}, RC::SUCCESS, 0x0807060504030201ULL},
+      {{0xFB}, RC::INVALID_ARGUMENT, 0},  // NULL
+      {{0xFF}, RC::INVALID_ARGUMENT, 0},
+      {{0xFC, 0x34}, RC::INVALID_ARGUMENT, 0},
+      {{0xFD, 0x56, 0x34}, RC::INVALID_ARGUMENT, 0},
+      {{0xFE, 0x01, 0x02, 0x03}, RC::INVALID_ARGUMENT, 0},
+      {{}, RC::INVALID_ARGUMENT, 0},
+  };
+  for (const Case &c : cases) {
+    vector<char> packet(c.bytes.begin(), c.bytes.end());
+    PacketReader reader(packet, 0);
+    uint64_t     value = 0;
+    ASSERT_EQ(c.rc, reader.fetch_lenenc_int(value));
+    if (c.rc == RC::SUCCESS) {
+      ASSERT_EQ(c.value, value);
+    }
+  }
+
+  vector<char> packet;
+  append_lenenc_string(packet, "hello");
+  append_lenenc_string(packet, "");
+  packet.push_back(10);  // 长度超过了剩余的数据
+  packet.push_back('x');
+  PacketReader reader(packet, 0);
+  const char  *data = nullptr;
+  int          len  = -1;
+  ASSERT_EQ(RC::SUCCESS, reader.fetch_lenenc_string(data, len));
+  ASSERT_EQ("hello", string(data, len));
+  ASSERT_EQ(RC::SUCCESS, reader.fetch_lenenc_string(data, len));
+  ASSERT_EQ(0, len);
+  ASSERT_EQ(RC::INVALID_ARGUMENT, reader.fetch_lenenc_string(data, len));
+
+  // 长度远远超过包的大小
+  vector<char> huge = {static_cast<char>(0xFE), 0, 0, 0, 0, 0, 0, 0, 0x10};
+  PacketReader huge_reader(huge, 0);
+  ASSERT_EQ(RC::INVALID_ARGUMENT, huge_reader.fetch_lenenc_string(data, len));
+}
+
+TEST(DecodeBinaryParam, integers)
+{
+  const uint16_t unsigned_flag = 0x8000;
+
+  Value        value;
+  vector<char> packet;
+
+  append_int<int8_t>(packet, -2);
+  ASSERT_EQ(RC::SUCCESS, decode(packet, MYSQL_TYPE_TINY, value));
+  ASSERT_EQ(AttrType::INTS, value.attr_type());
+  ASSERT_EQ(-2, value.get_int());
+  ASSERT_EQ(RC::SUCCESS, decode(packet, MYSQL_TYPE_TINY | unsigned_flag, value));
+  ASSERT_EQ(254, value.get_int());
+
+  packet.clear();
+  append_int<int16_t>(packet, -300);
+  for (uint16_t type : {MYSQL_TYPE_SHORT, MYSQL_TYPE_YEAR}) {
+    ASSERT_EQ(RC::SUCCESS, decode(packet, type, value));
+    ASSERT_EQ(-300, value.get_int());
+  }
+  ASSERT_EQ(RC::SUCCESS, decode(packet, MYSQL_TYPE_SHORT | unsigned_flag, value));
+  ASSERT_EQ(65536 - 300, value.get_int());
+
+  packet.clear();
+  append_int<int32_t>(packet, -70000);
+  for (uint16_t type : {MYSQL_TYPE_LONG, MYSQL_TYPE_INT24}) {
+    ASSERT_EQ(RC::SUCCESS, decode(packet, type, value));
+    ASSERT_EQ(-70000, value.get_int());
+  }
+
+  // 8个字节的整数截断成4个字节
+  packet.clear();
+  append_int<int64_t>(packet, 123456789);
+  ASSERT_EQ(RC::SUCCESS, decode(packet, MYSQL_TYPE_LONGLONG, value));
+  ASSERT_EQ(123456789, value.get_int());
+
+  // 数据不完整
+  vector<char> truncated(3, 0);
+  ASSERT_EQ(RC::INVALID_ARGUMENT, decode(truncated, MYSQL_TYPE_LONG, value));
+  ASSERT_EQ(RC::INVALID_ARGUMENT, decode(truncated, MYSQL_TYPE_LONGLONG, value));
+  truncated.resize(1);
+  ASSERT_EQ(RC::INVALID_ARGUMENT, decode(truncated, MYSQL_TYPE_SHORT, value));
+  truncated.clear();
+  ASSERT_EQ(RC::INVALID_ARGUMENT, decode(truncated, MYSQL_TYPE_TINY, value));
+}
+
+TEST(DecodeBinaryParam, floats)
+{
+  Value        value;
+  vector<char> packet;
+  append_int<float>(packet, 1.5f);
+  ASSERT_EQ(RC::SUCCESS, decode(packet, MYSQL_TYPE_FLOAT, value));
+  ASSERT_EQ(AttrType::FLOATS, value.attr_type());
+  ASSERT_EQ(1.5f, value.get_float());
+
+  packet.clear();
+  append_int<double>(packet, -2.25);
+  ASSERT_EQ(RC::SUCCESS, decode(packet, MYSQL_TYPE_DOUBLE, value));
+  ASSERT_EQ(-2.25f, value.get_float());
+
+  packet.resize(7);
+  ASSERT_EQ(RC::INVALID_ARGUMENT, decode(packet, MYSQL_TYPE_DOUBLE, value));
+  packet.resize(3);
+  ASSERT_EQ(RC::INVALID_ARGUMENT, decode(packet, MYSQL_TYPE_FLOAT, value));
+}
+
+TEST(DecodeBinaryParam, dates)
+{
+  auto date_packet = [](uint8_t len, int year, int month, int day) {
+    vector<char> packet;
+    append_int<uint8_t>(packet, len);
+    append_int<uint16_t>(packet, year);
+    append_int<uint8_t>(packet, month);
+    append_int<uint8_t>(packet, day);
+    return packet;
+  };
+
+  Value value;
+  ASSERT_EQ(RC::SUCCESS, decode(date_packet(4, 2024, 2, 29), MYSQL_TYPE_DATE, value));
+  ASSERT_EQ(AttrType::DATES, value.attr_type());
+  ASSERT_EQ(DateType::date_to_days(2024, 2, 29), value.get_int());
+
+  // datetime 和 timestamp 的时间部分被忽略
+  vector<char> datetime = date_packet(7, 2023, 12, 31);
+  datetime.insert(datetime.end(), {23, 59, 58});
+  for (uint16_t type : {MYSQL_TYPE_DATETIME, MYSQL_TYPE_TIMESTAMP}) {
+    ASSERT_EQ(RC::SUCCESS, decode(datetime, type, value));
+    ASSERT_EQ(DateType::date_to_days(2023, 12, 31), value.get_int());
+  }
+  vector<char> with_micros = date_packet(11, 2000, 1, 1);
+  with_micros.insert(with_micros.end(), 7, 0);
+  ASSERT_EQ(RC::SUCCESS, decode(with_micros, MYSQL_TYPE_DATETIME, value));
+  ASSERT_EQ(DateType::date_to_days(2000, 1, 1), value.get_int());
+
+  // 长度为0表示全零的日期，不是合法的日期
+  ASSERT_EQ(RC::INVALID_ARGUMENT, decode(vector<char>{0}, MYSQL_TYPE_DATE, value));
+  ASSERT_EQ(RC::INVALID_ARGUMENT, decode(date_packet(4, 2023, 2, 29), MYSQL_TYPE_DATE, value));
+  ASSERT_EQ(RC::INVALID_ARGUMENT, decode(date_packet(4, 2023, 13, 1), MYSQL_TYPE_DATE, value));
+
+  // 长度标识与实际的数据不一致
+  ASSERT_EQ(RC::INVALID_ARGUMENT, decode(date_packet(7, 2023, 12, 31), MYSQL_TYPE_DATETIME, value));
+  vector<char> truncated = date_packet(4, 2024, 2, 29);
+  truncated.pop_back();
+  ASSERT_EQ(RC::INVALID_ARGUMENT, decode(truncated, MYSQL_TYPE_DATE, value));
+  ASSERT_EQ(RC::INVALID_ARGUMENT, decode(vector<char>{}, MYSQL_TYPE_DATE, value));
+}
+
+TEST(DecodeBinaryParam, strings)
+{
+  Value value;
+  for (uint16_t type : {MYSQL_TYPE_VARCHAR, MYSQL_TYPE_VAR_STRING, MYSQL_TYPE_STRING, MYSQL_TYPE_BLOB,
+           MYSQL_TYPE_NEWDECIMAL, MYSQL_TYPE_JSON}) {
+    vector<char> packet;
+    append_lenenc_string(packet, "abc");
+    ASSERT_EQ(RC::SUCCESS, decode(packet, type, value));
+    ASSERT_EQ(AttrType::CHARS, value.attr_type());
+    ASSERT_EQ("abc", value.get_string());
+
+    packet.clear();
+    append_lenenc_string(packet, "");
+    ASSERT_EQ(RC::SUCCESS, decode(packet, type, value));
+    ASSERT_EQ("", value.get_string());
+
+    packet.clear();
+    append_lenenc_string(packet, "abc");
+    packet.pop_back();
+    ASSERT_EQ(RC::INVALID_ARGUMENT, decode(packet, type, value));
+  }
+
+  // 不支持的类型
+  vector<char> packet(8, 0);
+  for (uint16_t type : {MYSQL_TYPE_NULL, MYSQL_TYPE_TIME, MYSQL_TYPE_BIT, MYSQL_TYPE_GEOMETRY}) {
+    ASSERT_EQ(RC::UNSUPPORTED, decode(packet, type, value));
+  }
+}
+
+/**
+ * @brief 通过 socketpair 模拟客户端，完整地执行预处理语句的创建、绑定参数和执行
+ */
+class MysqlCommunicatorTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    filesystem::remove_all(test_directory_);
+    GCTX.handler_ = new DefaultHandler();
+    ASSERT_EQ(RC::SUCCESS, GCTX.handler_->init(test_directory_.c_str(), "vacuous", "vacuous", "heap"));
+
+    int fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    client_fd_ = fds[1];
+
+    communicator_ = make_unique<MysqlCommunicator>();
+    ASSERT_EQ(RC::SUCCESS, communicator_->init(fds[0], make_unique<Session>(Session::default_session()), "test"));
+    ASSERT_EQ(1, receive().size());  // 握手包
+
+    // 回复握手包，服务端只读取 capabilities
+    vector<char> handshake_response(32, 0);
+    ASSERT_EQ(0, send_packet(1, handshake_response));
+    vector<vector<char>> packets = handle();
+    ASSERT_EQ(1, packets.size());
+    ASSERT_EQ(0x00, packets[0][0]);
+
+    for (const char *sql : {"create table t(id int, name char(8))",
+             "insert into t values(1, 'a')",
+             "insert into t values(2, 'b')",
+             "insert into t values(3, 'c')"}) {
+      packets = query(COM_QUERY_TYPE, sql);
+      ASSERT_FALSE(packets.empty());
+      ASSERT_EQ(0x00, packets[0][0]);
+    }
+  }
+
+  void TearDown() override
+  {
+    communicator_.reset();
+    close(client_fd_);
+    GCTX.handler_->destroy();
+    delete GCTX.handler_;
+    GCTX.handler_ = nullptr;
+    filesystem::remove_all(test_directory_);
+  }
+
+  int send_packet(int sequence_id, const vector<char> &payload)
+  {
+    vector<char> packet;
+    append_int<uint32_t>(packet, static_cast<uint32_t>(payload.size()) | (static_cast<uint32_t>(sequence_id) << 24));
+    packet.insert(packet.end(), payload.begin(), payload.end());
+    return write(client_fd_, packet.data(), packet.size()) == static_cast<ssize_t>(packet.size()) ? 0 : -1;
+  }
+
+  /// 读取服务端已经发送的所有数据包（不包括包头）
+  vector<vector<char>> receive()
+  {
+    vector<char> data;
+    char         buf[4096];
+    ssize_t      n = 0;
+    while ((n = recv(client_fd_, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+      data.insert(data.end(), buf, buf + n);
+    }
+
+    vector<vector<char>> packets;
+    for (size_t pos = 0; pos + 4 <= data.size();) {
+      uint32_t length = 0;
+      memcpy(&length, data.data() + pos, 3);
+      packets.emplace_back(data.begin() + pos + 4, data.begin() + pos + 4 + length);
+      pos += 4 + length;
+    }
+    return packets;
+  }
+
+  /// 服务端处理一个请求，返回回复的数据包
+  vector<vector<char>> handle()
+  {
+    EXPECT_EQ(RC::SUCCESS, task_handler_.handle_event(communicator_.get()));
+    return receive();
+  }
+
+  vector<vector<char>> query(int8_t command, const string &sql)
+  {
+    vector<char> payload{static_cast<char>(command)};
+    payload.insert(payload.end(), sql.begin(), sql.end());
+    EXPECT_EQ(0, send_packet(0, payload));
+    return handle();
+  }
+
+  /// 创建预处理语句，返回语句编号
+  int prepare(const string &sql, int column_count, int param_count)
+  {
+    vector<vector<char>> packets = query(COM_STMT_PREPARE_TYPE, sql);
+    EXPECT_FALSE(packets.empty());
+    EXPECT_EQ(0x00, packets[0][0]);
+
+    PacketReader reader(packets[0], 1);
+    int32_t      statement_id = -1;
+    int16_t      columns      = 0;
+    int16_t      params       = 0;
+    EXPECT_EQ(RC::SUCCESS, reader.fetch_int(statement_id));
+    EXPECT_EQ(RC::SUCCESS, reader.fetch_int(columns));
+    EXPECT_EQ(RC::SUCCESS, reader.fetch_int(params));
+    EXPECT_EQ(column_count, columns);
+    EXPECT_EQ(param_count, params);
+    return statement_id;
+  }
+
+  /// COM_STMT_EXECUTE 请求，types 为空时表示不重新绑定参数类型
+  vector<char> execute_packet(int statement_id, const vector<uint16_t> &types, const vector<char> &values)
+  {
+    vector<char> payload{static_cast<char>(COM_STMT_EXECUTE_TYPE)};
+    append_int<int32_t>(payload, statement_id);
+    append_int<int8_t>(payload, 0);   // flags
+    append_int<int32_t>(payload, 1);  // iteration count
+    append_int<int8_t>(payload, 0);   // null bitmap
+    append_int<int8_t>(payload, types.empty() ? 0 : 1);
+    for (uint16_t type : types) {
+      append_int<uint16_t>(payload, type);
+    }
+    payload.insert(payload.end(), values.begin(), values.end());
+    return payload;
+  }
+
+  /// 执行预处理语句，返回结果中的所有行，每行的值用 | 连接
+  vector<string> execute(const vector<char> &payload)
+  {
+    EXPECT_EQ(0, send_packet(0, payload));
+    vector<vector<char>> packets = handle();
+    EXPECT_FALSE(packets.empty());
+    if (packets.empty() || packets[0][0] == static_cast<char>(0xFF)) {
+      return {"error"};
+    }
+
+    // 列的个数 | 列定义 | EOF | 行 | EOF
+    PacketReader reader(packets[0], 0);
+    uint64_t     column_count = 0;
+    EXPECT_EQ(RC::SUCCESS, reader.fetch_lenenc_int(column_count));
+
+    vector<string> rows;
+    for (size_t i = column_count + 2; i + 1 < packets.size(); i++) {
+      const vector<char> &packet = packets[i];
+      EXPECT_EQ(0x00, packet[0]);
+      PacketReader row_reader(packet, 1 + static_cast<int>((column_count + 7 + 2) / 8));
+      string       row;
+      for (uint64_t col = 0; col < column_count; col++) {
+        const char *data = nullptr;
+        int         len  = 0;
+        EXPECT_EQ(RC::SUCCESS, row_reader.fetch_lenenc_string(data, len));
+        row += (col == 0 ? "" : "|") + string(data, len);
+      }
+      rows.push_back(row);
+    }
+    return rows;
+  }
+
+  static vector<char> int_value(int32_t value)
+  {
+    vector<char> values;
+    append_int<int32_t>(values, value);
+    return values;
+  }
+
+protected:
+  static constexpr int8_t COM_QUERY_TYPE        = 0x03;
+  static constexpr int8_t COM_STMT_PREPARE_TYPE = 0x16;
+  static constexpr int8_t COM_STMT_EXECUTE_TYPE = 0x17;
+  static constexpr int8_t COM_STMT_CLOSE_TYPE   = 0x19;
+
+  const string test_directory_ = "mysql_communicator_test";
+
+  int                           client_fd_ = -1;
+  unique_ptr<MysqlCommunicator> communicator_;
+  SqlTaskHandler                task_handler_;
+};
+
+TEST_F(MysqlCommunicatorTest, prepare_and_execute)
+{
+  const int statement_id = prepare("select id, name from t where id = ?", 2, 1);
+
+  PreparedStatement *statement = communicator_->session()->find_prepared_statement(statement_id);
+  ASSERT_NE(statement, nullptr);
+  PhysicalOperator *plan = statement->physical_operator().get();
+  ASSERT_NE(plan, nullptr);
+
+  // 第一次执行时绑定参数类型
+  ASSERT_EQ(vector<string>{"2|b"}, execute(execute_packet(statement_id, {MYSQL_TYPE_LONG}, int_value(2))));
+
+  // 之后的执行不再发送参数类型，使用新的参数值复用同一个执行计划
+  ASSERT_EQ(vector<string>{"3|c"}, execute(execute_packet(statement_id, {}, int_value(3))));
+  ASSERT_EQ(vector<string>{}, execute(execute_packet(statement_id, {}, int_value(4))));
+  ASSERT_EQ(statement, communicator_->session()->find_prepared_statement(statement_id));
+  ASSERT_EQ(plan, statement->physical_operator().get());
+
+  // 重新绑定成其它的类型
+  vector<char> tiny{1};
+  ASSERT_EQ(vector<string>{"1|a"}, execute(execute_packet(statement_id, {MYSQL_TYPE_TINY}, tiny)));
+  vector<char> longlong;
+  append_int<int64_t>(longlong, 2);
+  ASSERT_EQ(vector<string>{"2|b"}, execute(execute_packet(statement_id, {MYSQL_TYPE_LONGLONG}, longlong)));
+  ASSERT_EQ(plan, statement->physical_operator().get());
+
+  // 字符串参数
+  const int    name_statement_id = prepare("select id from t where name = ?", 1, 1);
+  vector<char> name;
+  append_lenenc_string(name, "c");
+  ASSERT_EQ(vector<string>{"3"}, execute(execute_packet(name_statement_id, {MYSQL_TYPE_VAR_STRING}, name)));
+  name.clear();
+  append_lenenc_string(name, "a");
+  ASSERT_EQ(vector<string>{"1"}, execute(execute_packet(name_statement_id, {}, name)));
+}
+
+TEST_F(MysqlCommunicatorTest, malformed_execute)
+{
+  const int statement_id = prepare("select id, name from t where id = ?", 2, 1);
+
+  // 参数类型还没有绑定
+  ASSERT_EQ(vector<string>{"error"}, execute(execute_packet(statement_id, {}, int_value(1))));
+
+  // 参数值不完整
+  vector<char> truncated = execute_packet(statement_id, {MYSQL_TYPE_LONG}, int_value(1));
+  truncated.pop_back();
+  ASSERT_EQ(vector<string>{"error"}, execute(truncated));
+
+  // 请求头不完整
+  vector<char> header{static_cast<char>(COM_STMT_EXECUTE_TYPE), 1, 0};
+  ASSERT_EQ(vector<string>{"error"}, execute(header));
+
+  // NULL 参数
+  vector<char> null_param = execute_packet(statement_id, {MYSQL_TYPE_LONG}, int_value(1));
+  null_param[10] = 1;
+  ASSERT_EQ(vector<string>{"error"}, execute(null_param));
+
+  // 不存在的语句
+  ASSERT_EQ(vector<string>{"error"}, execute(execute_packet(statement_id + 100, {MYSQL_TYPE_LONG}, int_value(1))));
+
+  // 出错之后连接仍然可以正常使用
+  ASSERT_EQ(vector<string>{"1|a"}, execute(execute_packet(statement_id, {MYSQL_TYPE_LONG}, int_value(1))));
+
+  // 释放之后不能再执行，释放不需要回复
+  vector<char> close_payload{static_cast<char>(COM_STMT_CLOSE_TYPE)};
+  append_int<int32_t>(close_payload, statement_id);
+  ASSERT_EQ(0, send_packet(0, close_payload));
+  ASSERT_TRUE(handle().empty());
+  ASSERT_EQ(nullptr, communicator_->session()->find_prepared_statement(statement_id));
+  ASSERT_EQ(vector<string>{"error"}, execute(execute_packet(statement_id, {MYSQL_TYPE_LONG}, int_value(1))));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
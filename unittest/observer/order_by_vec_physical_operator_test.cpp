@@ -0,0 +1,315 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <filesystem>
+#include <utility>
+
+#define private public
+#include "sql/operator/order_by_vec_physical_operator.h"
+#undef private
+
+#include "gtest/gtest.h"
+#include "storage/db/db.h"
+#include "storage/table/table.h"
+#include "storage/trx/trx.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/limit_logical_operator.h"
+#include "sql/operator/limit_vec_physical_operator.h"
+#include "sql/operator/order_by_logical_operator.h"
+#include "sql/operator/order_by_physical_operator.h"
+#include "sql/operator/table_get_logical_operator.h"
+#include "sql/operator/table_scan_physical_operator.h"
+#include "sql/operator/table_scan_vec_physical_operator.h"
+#include "sql/optimizer/physical_plan_generator.h"
+
+using namespace std;
+using namespace common;
+
+/**
+ * @brief 排序键 a 有很多重复的值，b 是插入的顺序，用来检查排序是否稳定
+ */
+class OrderByVecPhysicalOperatorTest : public ::testing::Test
+{
+protected:
+  using Row = pair<int, int>;  ///< (a, b)
+
+  void SetUp() override
+  {
+    filesystem::remove_all(test_directory_);
+    filesystem::create_directories(test_directory_);
+    db_ = make_unique<Db>();
+    ASSERT_EQ(RC::SUCCESS, db_->init("order_by_db", test_directory_.c_str(), "vacuous", "vacuous", "heap"));
+
+    vector<AttrInfoSqlNode> attr_infos(3);
+    attr_infos[0].name   = "a";
+    attr_infos[0].type   = AttrType::INTS;
+    attr_infos[0].length = 4;
+    attr_infos[1].name   = "b";
+    attr_infos[1].type   = AttrType::INTS;
+    attr_infos[1].length = 4;
+    attr_infos[2].name   = "c";
+    attr_infos[2].type   = AttrType::CHARS;
+    attr_infos[2].length = 8;
+    ASSERT_EQ(RC::SUCCESS, db_->create_table("t", attr_infos, {}, StorageFormat::PAX_FORMAT));
+    table_ = db_->find_table("t");
+    ASSERT_NE(table_, nullptr);
+
+    trx_ = db_->trx_kit().create_trx(db_->log_handler());
+    for (int i = 0; i < record_num_; i++) {
+      Value values[3];
+      values[0].set_int((i * 7919) % 37);
+      values[1].set_int(i);
+      values[2].set_string(("s" + to_string(i % 11)).c_str());
+      Record record;
+      ASSERT_EQ(RC::SUCCESS, table_->make_record(3, values, record));
+      ASSERT_EQ(RC::SUCCESS, trx_->insert_record(table_, record));
+    }
+
+    // 稳定排序的结果与下层算子输出的顺序有关，以扫描的顺序为准
+    TableScanVecPhysicalOperator scan_oper(table_, ReadWriteMode::READ_ONLY);
+    ASSERT_EQ(RC::SUCCESS, scan_oper.open(trx_));
+    ASSERT_EQ(RC::RECORD_EOF, collect(scan_oper, scan_rows_));
+    ASSERT_EQ(RC::SUCCESS, scan_oper.close());
+    ASSERT_EQ(static_cast<size_t>(record_num_), scan_rows_.size());
+  }
+
+  void TearDown() override
+  {
+    db_->trx_kit().destroy_trx(trx_);
+    trx_   = nullptr;
+    table_ = nullptr;
+    db_.reset();
+    filesystem::remove_all(test_directory_);
+  }
+
+  unique_ptr<Expression> field_expr(const char *name) const
+  {
+    return make_unique<FieldExpr>(table_, table_->table_meta().field(name));
+  }
+
+  /// 按照 a 稳定排序之后的前 limit 行，limit 小于 0 时返回所有行
+  vector<Row> expected_rows(bool ascending, int limit) const
+  {
+    vector<Row> rows = scan_rows_;
+    stable_sort(rows.begin(), rows.end(), [ascending](const Row &left, const Row &right) {
+      return ascending ? left.first < right.first : left.first > right.first;
+    });
+    if (limit >= 0 && static_cast<size_t>(limit) < rows.size()) {
+      rows.resize(limit);
+    }
+    return rows;
+  }
+
+  unique_ptr<OrderByVecPhysicalOperator> create_order_by(bool ascending, int limit, size_t sort_memory)
+  {
+    vector<unique_ptr<Expression>> expressions;
+    expressions.emplace_back(field_expr("a"));
+    auto order_by_oper = make_unique<OrderByVecPhysicalOperator>(std::move(expressions), vector<bool>{ascending}, sort_memory);
+    order_by_oper->set_limit(limit);
+    order_by_oper->add_child(make_unique<TableScanVecPhysicalOperator>(table_, ReadWriteMode::READ_ONLY));
+    return order_by_oper;
+  }
+
+  /// 读取向量化算子输出的所有行
+  RC collect(PhysicalOperator &oper, vector<Row> &rows) const
+  {
+    const int a_index = table_->table_meta().field("a")->field_id();
+    const int b_index = table_->table_meta().field("b")->field_id();
+
+    rows.clear();
+    RC    rc = RC::SUCCESS;
+    Chunk chunk;
+    while (OB_SUCC(rc = oper.next(chunk))) {
+      for (int row = 0; row < chunk.rows(); row++) {
+        rows.emplace_back(chunk.get_value(a_index, row).get_int(), chunk.get_value(b_index, row).get_int());
+      }
+    }
+    return rc;
+  }
+
+  /// 读取火山模型的算子输出的所有行
+  RC collect_tuples(PhysicalOperator &oper, vector<Row> &rows) const
+  {
+    const int a_index = table_->table_meta().field("a")->field_id();
+    const int b_index = table_->table_meta().field("b")->field_id();
+
+    rows.clear();
+    RC rc = RC::SUCCESS;
+    while (OB_SUCC(rc = oper.next())) {
+      Value a;
+      Value b;
+      Tuple *tuple = oper.current_tuple();
+      if (OB_FAIL(rc = tuple->cell_at(a_index, a)) || OB_FAIL(rc = tuple->cell_at(b_index, b))) {
+        return rc;
+      }
+      rows.emplace_back(a.get_int(), b.get_int());
+    }
+    return rc;
+  }
+
+protected:
+  const string test_directory_ = "order_by_vec_test";
+  const int    record_num_     = 10000;  ///< 超过一个 chunk 的容量，输出时需要多个 chunk
+  const size_t sort_memory_    = 4096;   ///< 很小的内存预算，只有 limit 很小时才使用堆，否则需要外部排序
+
+  unique_ptr<Db> db_;
+  Table         *table_ = nullptr;
+  Trx           *trx_   = nullptr;
+  vector<Row>    scan_rows_;
+};
+
+TEST_F(OrderByVecPhysicalOperatorTest, sort_and_limit)
+{
+  for (bool ascending : {true, false}) {
+    for (int limit : {-1, 0, 1, 100, 1000, 9000}) {
+      auto order_by_oper = create_order_by(ascending, limit, sort_memory_);
+
+      // 同一个算子执行两次，第二次重新排序
+      for (int i = 0; i < 2; i++) {
+        vector<Row> rows;
+        ASSERT_EQ(RC::SUCCESS, order_by_oper->open(trx_));
+        ASSERT_EQ(RC::RECORD_EOF, collect(*order_by_oper, rows));
+        ASSERT_EQ(expected_rows(ascending, limit), rows);
+
+        if (limit == 0) {
+          ASSERT_FALSE(order_by_oper->initialized_);
+        } else if (limit > 0 && limit <= 100) {
+          // limit 行数据可以放到内存中，使用 Top-N 的堆
+          ASSERT_TRUE(order_by_oper->top_n_);
+          ASSERT_EQ(static_cast<size_t>(limit), order_by_oper->heap_.size());
+        } else {
+          // 超过内存预算，排好序的数据写到临时文件中再归并
+          ASSERT_FALSE(order_by_oper->top_n_);
+          ASSERT_GT(order_by_oper->sorter_->run_num(), 1);
+        }
+        ASSERT_EQ(RC::SUCCESS, order_by_oper->close());
+      }
+    }
+  }
+}
+
+TEST_F(OrderByVecPhysicalOperatorTest, sort_in_memory)
+{
+  // 默认的内存预算下不需要写临时文件
+  for (int limit : {-1, 1, 9000}) {
+    auto        order_by_oper = create_order_by(true, limit, OrderByVecPhysicalOperator::DEFAULT_SORT_MEMORY);
+    vector<Row> rows;
+    ASSERT_EQ(RC::SUCCESS, order_by_oper->open(trx_));
+    ASSERT_EQ(RC::RECORD_EOF, collect(*order_by_oper, rows));
+    ASSERT_EQ(expected_rows(true, limit), rows);
+    ASSERT_EQ(limit > 0, order_by_oper->top_n_);
+    if (!order_by_oper->top_n_) {
+      ASSERT_EQ(0, order_by_oper->sorter_->run_num());
+    }
+    ASSERT_EQ(RC::SUCCESS, order_by_oper->close());
+  }
+}
+
+TEST_F(OrderByVecPhysicalOperatorTest, tuple_order_by)
+{
+  // 火山模型的排序算子设置了 limit 时也使用堆
+  for (bool ascending : {true, false}) {
+    for (int limit : {-1, 0, 1, 100, 9000}) {
+      vector<unique_ptr<Expression>> expressions;
+      expressions.emplace_back(field_expr("a"));
+      OrderByPhysicalOperator order_by_oper(std::move(expressions), {ascending});
+      order_by_oper.set_limit(limit);
+      order_by_oper.add_child(make_unique<TableScanPhysicalOperator>(table_, ReadWriteMode::READ_ONLY));
+
+      vector<Row> rows;
+      ASSERT_EQ(RC::SUCCESS, order_by_oper.open(trx_));
+      ASSERT_EQ(RC::RECORD_EOF, collect_tuples(order_by_oper, rows));
+      ASSERT_EQ(expected_rows(ascending, limit), rows);
+      ASSERT_EQ(RC::SUCCESS, order_by_oper.close());
+    }
+  }
+}
+
+TEST_F(OrderByVecPhysicalOperatorTest, limit_vec)
+{
+  for (int limit : {0, 1, 100, 9000, record_num_, record_num_ + 1}) {
+    LimitVecPhysicalOperator limit_oper(limit);
+    limit_oper.add_child(make_unique<TableScanVecPhysicalOperator>(table_, ReadWriteMode::READ_ONLY));
+
+    vector<Row> rows;
+    ASSERT_EQ(RC::SUCCESS, limit_oper.open(trx_));
+    ASSERT_EQ(RC::RECORD_EOF, collect(limit_oper, rows));
+    ASSERT_EQ(RC::SUCCESS, limit_oper.close());
+
+    vector<Row> expected(scan_rows_.begin(), scan_rows_.begin() + min(limit, record_num_));
+    ASSERT_EQ(expected, rows);
+  }
+}
+
+TEST_F(OrderByVecPhysicalOperatorTest, limit_into_order_by)
+{
+  const int limit = 10;
+
+  auto create_logical_plan = [&](bool with_order_by) {
+    unique_ptr<LogicalOperator> child = make_unique<TableGetLogicalOperator>(table_, ReadWriteMode::READ_ONLY);
+    if (with_order_by) {
+      vector<unique_ptr<Expression>> expressions;
+      expressions.emplace_back(field_expr("a"));
+      auto order_by_oper = make_unique<OrderByLogicalOperator>(std::move(expressions), vector<bool>{false});
+      order_by_oper->add_child(std::move(child));
+      child = std::move(order_by_oper);
+    }
+    auto limit_oper = make_unique<LimitLogicalOperator>(limit);
+    limit_oper->add_child(std::move(child));
+    return limit_oper;
+  };
+
+  PhysicalPlanGenerator generator;
+
+  // order by ... limit 由排序算子处理，不再需要 limit 算子
+  {
+    auto                         logical_oper = create_logical_plan(true);
+    unique_ptr<PhysicalOperator> physical_oper;
+    ASSERT_EQ(RC::SUCCESS, generator.create_vec(*logical_oper, physical_oper, nullptr));
+    ASSERT_EQ(PhysicalOperatorType::ORDER_BY_VEC, physical_oper->type());
+    ASSERT_EQ("limit=" + to_string(limit), physical_oper->param());
+
+    vector<Row> rows;
+    ASSERT_EQ(RC::SUCCESS, physical_oper->open(trx_));
+    ASSERT_EQ(RC::RECORD_EOF, collect(*physical_oper, rows));
+    ASSERT_EQ(RC::SUCCESS, physical_oper->close());
+    ASSERT_EQ(expected_rows(false, limit), rows);
+  }
+
+  // 火山模型的计划也一样
+  {
+    auto                         logical_oper = create_logical_plan(true);
+    unique_ptr<PhysicalOperator> physical_oper;
+    ASSERT_EQ(RC::SUCCESS, generator.create(*logical_oper, physical_oper, nullptr));
+    ASSERT_EQ(PhysicalOperatorType::ORDER_BY, physical_oper->type());
+    ASSERT_EQ("limit=" + to_string(limit), physical_oper->param());
+  }
+
+  // 没有排序时仍然使用 limit 算子
+  {
+    auto                         logical_oper = create_logical_plan(false);
+    unique_ptr<PhysicalOperator> physical_oper;
+    ASSERT_EQ(RC::SUCCESS, generator.create_vec(*logical_oper, physical_oper, nullptr));
+    ASSERT_EQ(PhysicalOperatorType::LIMIT_VEC, physical_oper->type());
+
+    vector<Row> rows;
+    ASSERT_EQ(RC::SUCCESS, physical_oper->open(trx_));
+    ASSERT_EQ(RC::RECORD_EOF, collect(*physical_oper, rows));
+    ASSERT_EQ(RC::SUCCESS, physical_oper->close());
+    ASSERT_EQ(vector<Row>(scan_rows_.begin(), scan_rows_.begin() + limit), rows);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
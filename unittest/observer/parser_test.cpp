@@ -64,6 +64,55 @@ TEST(ParserTest, DISABLED_group_by_test)
   }
 }
 
+TEST(ParserTest, param_test)
+{
+  {
+    ParsedSqlResult result;
+    const char     *sql = "select * from tab where a = ? and ? < b;";
+    ASSERT_EQ(parse(sql, &result), RC::SUCCESS);
+    ASSERT_EQ(result.sql_nodes().size(), 1);
+
+    ParsedSqlNode *sql_node = result.sql_nodes().front().get();
+    ASSERT_EQ(sql_node->flag, SCF_SELECT);
+    ASSERT_EQ(sql_node->param_count, 2);
+
+    // 条件列表是倒序保存的，占位符按照在SQL中出现的顺序编号
+    vector<ConditionSqlNode> &conditions = sql_node->selection.conditions;
+    ASSERT_EQ(conditions.size(), 2);
+    ASSERT_EQ(conditions[1].right_is_attr, 0);
+    ASSERT_TRUE(conditions[1].right_value.is_param());
+    ASSERT_EQ(conditions[1].right_value.param_index(), 0);
+    ASSERT_EQ(conditions[0].left_is_attr, 0);
+    ASSERT_TRUE(conditions[0].left_value.is_param());
+    ASSERT_EQ(conditions[0].left_value.param_index(), 1);
+  }
+  {
+    ParsedSqlResult result;
+    const char     *sql = "insert into tab values(?, 1, ?);";
+    ASSERT_EQ(parse(sql, &result), RC::SUCCESS);
+    ASSERT_EQ(result.sql_nodes().size(), 1);
+
+    ParsedSqlNode *sql_node = result.sql_nodes().front().get();
+    ASSERT_EQ(sql_node->flag, SCF_INSERT);
+    ASSERT_EQ(sql_node->param_count, 2);
+
+    vector<Value> &values = sql_node->insertion.values;
+    ASSERT_EQ(values.size(), 3);
+    ASSERT_TRUE(values[0].is_param());
+    ASSERT_EQ(values[0].param_index(), 0);
+    ASSERT_FALSE(values[1].is_param());
+    ASSERT_EQ(values[1].get_int(), 1);
+    ASSERT_TRUE(values[2].is_param());
+    ASSERT_EQ(values[2].param_index(), 1);
+  }
+  {
+    ParsedSqlResult result;
+    const char     *sql = "select * from tab where a = 1;";
+    ASSERT_EQ(parse(sql, &result), RC::SUCCESS);
+    ASSERT_EQ(result.sql_nodes().front()->param_count, 0);
+  }
+}
+
 int main(int argc, char **argv)
 {
 
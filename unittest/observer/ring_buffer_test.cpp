@@ -116,6 +116,46 @@ TEST(ring_buffer, test_buffer)
   EXPECT_EQ(buffer.forward(buffer_size), RC::SUCCESS);
 }
 
+TEST(ring_buffer, test_reserve)
+{
+  const int  buf_size = 15;
+  RingBuffer buffer(buf_size);
+
+  char *reserved = nullptr;
+  EXPECT_EQ(buffer.reserve(10, reserved), RC::SUCCESS);
+  memcpy(reserved, "0123456789", 10);
+  EXPECT_EQ(buffer.commit(8), RC::SUCCESS);
+  EXPECT_EQ(buffer.size(), 8);
+
+  // 尾部只剩下7个字节的连续空间
+  EXPECT_EQ(buffer.reserve(8, reserved), RC::FULL);
+  EXPECT_EQ(buffer.reserve(7, reserved), RC::SUCCESS);
+  memcpy(reserved, "abcdefg", 7);
+  EXPECT_EQ(buffer.commit(7), RC::SUCCESS);
+  EXPECT_EQ(buffer.remain(), 0);
+  EXPECT_EQ(buffer.reserve(1, reserved), RC::FULL);
+
+  EXPECT_EQ(buffer.forward(5), RC::SUCCESS);
+  EXPECT_EQ(buffer.reserve(5, reserved), RC::SUCCESS);
+  memcpy(reserved, "ABCDE", 5);
+  EXPECT_EQ(buffer.commit(5), RC::SUCCESS);
+
+  const char *first       = nullptr;
+  const char *second      = nullptr;
+  int32_t     first_size  = 0;
+  int32_t     second_size = 0;
+  buffer.buffers(first, first_size, second, second_size);
+  EXPECT_EQ(first_size, 10);
+  EXPECT_EQ(second_size, 5);
+  EXPECT_EQ(0, memcmp(first, "567abcdefg", 10));
+  EXPECT_EQ(0, memcmp(second, "ABCDE", 5));
+
+  // 缓存为空时从头开始写，可以使用全部空间
+  EXPECT_EQ(buffer.forward(15), RC::SUCCESS);
+  EXPECT_EQ(buffer.reserve(buf_size, reserved), RC::SUCCESS);
+  EXPECT_EQ(buffer.commit(buf_size + 1), RC::INVALID_ARGUMENT);
+}
+
 int main(int argc, char **argv)
 {
   // 分析gtest程序的命令行参数
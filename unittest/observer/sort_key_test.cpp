@@ -0,0 +1,97 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/expr/sort_key.h"
+#include "common/value.h"
+
+#include "gtest/gtest.h"
+
+using namespace std;
+
+static int sign(int value) { return value < 0 ? -1 : (value > 0 ? 1 : 0); }
+
+/// 变长编码与定长编码的比较结果都要与 Value::compare 一致
+static void check_order(const vector<Value> &values, int attr_len)
+{
+  for (bool ascending : {true, false}) {
+    for (const Value &left : values) {
+      for (const Value &right : values) {
+        int expected = sign(left.compare(right));
+        if (!ascending) {
+          expected = -expected;
+        }
+
+        string left_key, right_key;
+        ASSERT_EQ(RC::SUCCESS, SortKeyEncoder::append(left, ascending, left_key));
+        ASSERT_EQ(RC::SUCCESS, SortKeyEncoder::append(right, ascending, right_key));
+        EXPECT_EQ(expected, sign(left_key.compare(right_key))) << left.to_string() << " vs " << right.to_string();
+
+        const int    length = SortKeyEncoder::fixed_length(left.attr_type(), attr_len);
+        vector<char> left_data(attr_len, 0), right_data(attr_len, 0);
+        memcpy(left_data.data(), left.data(), min(left.length(), attr_len));
+        memcpy(right_data.data(), right.data(), min(right.length(), attr_len));
+        vector<char> left_fixed(length), right_fixed(length);
+        SortKeyEncoder::encode_fixed(left.attr_type(), left_data.data(), attr_len, ascending, left_fixed.data());
+        SortKeyEncoder::encode_fixed(right.attr_type(), right_data.data(), attr_len, ascending, right_fixed.data());
+        EXPECT_EQ(expected, sign(memcmp(left_fixed.data(), right_fixed.data(), length)))
+            << left.to_string() << " vs " << right.to_string();
+      }
+    }
+  }
+}
+
+TEST(SortKeyEncoder, ints)
+{
+  vector<Value> values;
+  for (int value : {INT32_MIN, -65536, -256, -1, 0, 1, 255, 256, 65536, INT32_MAX}) {
+    values.emplace_back(value);
+  }
+  check_order(values, sizeof(int));
+}
+
+TEST(SortKeyEncoder, floats)
+{
+  vector<Value> values;
+  for (float value : {-1e30f, -100.5f, -1.0f, -0.25f, 0.0f, -0.0f, 0.25f, 1.0f, 100.5f, 1e30f}) {
+    values.emplace_back(value);
+  }
+  check_order(values, sizeof(float));
+}
+
+TEST(SortKeyEncoder, chars)
+{
+  vector<Value> values;
+  for (const char *value : {"", "a", "aa", "ab", "abc", "b", "ba", "z", "\xff"}) {
+    values.emplace_back(value);
+  }
+  check_order(values, 4);
+}
+
+TEST(SortKeyEncoder, multiple_keys)
+{
+  // 第一个键相同的时候才比较第二个键，字符串的编码不能是另一个字符串编码的前缀
+  string key1, key2;
+  ASSERT_EQ(RC::SUCCESS, SortKeyEncoder::append(Value("ab"), true, key1));
+  ASSERT_EQ(RC::SUCCESS, SortKeyEncoder::append(Value(100), false, key1));
+  ASSERT_EQ(RC::SUCCESS, SortKeyEncoder::append(Value("abc"), true, key2));
+  ASSERT_EQ(RC::SUCCESS, SortKeyEncoder::append(Value(1), false, key2));
+  EXPECT_LT(key1, key2);
+
+  string key3;
+  ASSERT_EQ(RC::SUCCESS, SortKeyEncoder::append(Value("ab"), true, key3));
+  ASSERT_EQ(RC::SUCCESS, SortKeyEncoder::append(Value(1), false, key3));
+  EXPECT_LT(key1, key3);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}